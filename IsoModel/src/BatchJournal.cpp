@@ -0,0 +1,191 @@
+#include "BatchJournal.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+
+#include <boost/filesystem.hpp>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace openstudio {
+namespace isomodel {
+
+namespace {
+
+const std::string journalMagic = "# isomodel batch journal 1";
+
+// Flushes a file's buffers and waits for the data to reach the disk.
+void syncFile(std::FILE* file, const std::string& path)
+{
+#ifdef _WIN32
+  auto failed = std::fflush(file) != 0 || _commit(_fileno(file)) != 0;
+#else
+  auto failed = std::fflush(file) != 0 || fsync(fileno(file)) != 0;
+#endif
+  if (failed) {
+    throw std::runtime_error("Could not sync " + path);
+  }
+}
+
+const char* engineName(const BatchJob& job)
+{
+  return job.hourly ? "hourly" : "monthly";
+}
+
+// Splits an entry into its five fields. The error, the last, may be empty.
+bool parseEntry(const std::string& line, std::vector<std::string>& fields)
+{
+  fields.clear();
+  std::istringstream in(line);
+  std::string field;
+  while (std::getline(in, field, '\t')) {
+    fields.push_back(field);
+  }
+  if (!line.empty() && line.back() == '\t') {
+    fields.push_back(std::string());
+  }
+  if (fields.size() != 5 || fields[0].empty() || fields[1].empty()) {
+    return false;
+  }
+  return fields[0].find_first_not_of("0123456789") == std::string::npos &&
+         fields[1].find_first_not_of("0123456789") == std::string::npos;
+}
+
+} // namespace
+
+BatchJournal::BatchJournal(const std::string& path, double syncSeconds)
+  : m_path(path),
+    m_syncInterval(std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(syncSeconds))),
+    m_lastSync(std::chrono::steady_clock::now())
+{
+  auto fresh = !boost::filesystem::exists(path) || boost::filesystem::file_size(path) == 0;
+  if (!fresh) {
+    std::ifstream in(path, std::ios::binary);
+    std::string magic;
+    if (!std::getline(in, magic) || magic != journalMagic) {
+      throw std::runtime_error(path + " is not a batch journal");
+    }
+  }
+
+  m_file = std::fopen(path.c_str(), "ab");
+  if (!m_file) {
+    throw std::runtime_error("Could not open the journal " + path);
+  }
+  if (fresh) {
+    std::fputs((journalMagic + "\n").c_str(), m_file);
+    syncFile(m_file, m_path);
+  }
+}
+
+BatchJournal::~BatchJournal()
+{
+  try {
+    sync();
+  } catch (const std::exception&) {
+    // The entries are lost, which only means their jobs are rerun.
+  }
+  if (m_file) {
+    std::fclose(m_file);
+  }
+  if (m_outFile) {
+    std::fclose(m_outFile);
+  }
+}
+
+std::vector<std::string> BatchJournal::resume(const std::vector<BatchJob>& jobs)
+{
+  std::vector<std::string> errors;
+  std::uint64_t offset = 0;
+  std::uint64_t good = journalMagic.size() + 1;
+  {
+    std::ifstream in(m_path, std::ios::binary);
+    std::string line;
+    std::getline(in, line);
+    std::vector<std::string> fields;
+    // An entry without its newline, or that doesn't parse, was torn by a
+    // crash, and can only be the last.
+    while (std::getline(in, line) && !in.eof() && parseEntry(line, fields)) {
+      auto index = std::stoull(fields[0]);
+      if (index != errors.size()) {
+        break;
+      }
+      if (index >= jobs.size() || fields[3] != jobs[index].ismPath || fields[2] != engineName(jobs[index])) {
+        throw std::runtime_error("The journal " + m_path + " is for a different batch: its job " + fields[0] + " is " + fields[3] +
+                                 " (" + fields[2] + "). Delete it to start over.");
+      }
+      errors.push_back(fields[4]);
+      offset = std::stoull(fields[1]);
+      good += line.size() + 1;
+    }
+  }
+
+  // Cut off the torn tail with the journal closed, since not every platform
+  // lets a file open for appending be truncated, then carry on from there.
+  if (boost::filesystem::file_size(m_path) > good) {
+    std::fclose(m_file);
+    m_file = nullptr;
+    boost::filesystem::resize_file(m_path, good);
+    m_file = std::fopen(m_path.c_str(), "ab");
+    if (!m_file) {
+      throw std::runtime_error("Could not reopen the journal " + m_path);
+    }
+  }
+  m_offset = offset;
+  return errors;
+}
+
+void BatchJournal::setOutput(std::ostream& out, const std::string& path)
+{
+  if (m_outFile) {
+    std::fclose(m_outFile);
+  }
+  // Syncing any descriptor of a file syncs all of its data.
+  m_outFile = std::fopen(path.c_str(), "ab");
+  if (!m_outFile) {
+    throw std::runtime_error("Could not open " + path);
+  }
+  m_out = &out;
+}
+
+void BatchJournal::record(std::size_t index, const BatchJob& job, std::uint64_t offset, const std::string& error)
+{
+  auto cleaned = error;
+  std::replace_if(cleaned.begin(), cleaned.end(), [](char c) { return c == '\t' || c == '\n' || c == '\r'; }, ' ');
+  m_pending += std::to_string(index) + "\t" + std::to_string(offset) + "\t" + engineName(job) + "\t" + job.ismPath + "\t" + cleaned + "\n";
+  m_offset = offset;
+
+  if (std::chrono::steady_clock::now() - m_lastSync >= m_syncInterval) {
+    sync();
+  }
+}
+
+void BatchJournal::sync()
+{
+  if (m_pending.empty()) {
+    return;
+  }
+
+  if (m_out) {
+    m_out->flush();
+  }
+  if (m_outFile) {
+    syncFile(m_outFile, "the batch output");
+  }
+  if (std::fwrite(m_pending.data(), 1, m_pending.size(), m_file) != m_pending.size()) {
+    throw std::runtime_error("Could not write to the journal " + m_path);
+  }
+  syncFile(m_file, m_path);
+  m_pending.clear();
+  m_lastSync = std::chrono::steady_clock::now();
+  ++m_syncs;
+}
+
+} // isomodel
+} // openstudio
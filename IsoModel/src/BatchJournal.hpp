@@ -0,0 +1,95 @@
+#ifndef ISOMODEL_BATCH_JOURNAL_HPP
+#define ISOMODEL_BATCH_JOURNAL_HPP
+
+#include "BatchRunner.hpp"
+#include "ISOModelAPI.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace openstudio {
+namespace isomodel {
+
+/**
+ * An append-only record of the jobs of a batch that have been written to its
+ * output file, so that a batch that dies part way through can be resumed
+ * without redoing them. Jobs finish in job order, so the journal is a list of
+ * entries, one per finished job in order, each giving the job's .ism path,
+ * engine and error (if it failed) and the size of the output file once its
+ * rows were written. A line of tab-separated text per entry:
+ *
+ * index	offset	engine	path	error
+ *
+ * Entries are buffered and made durable together, at most once every
+ * syncSeconds: the output is flushed and synced to disk first, then the
+ * entries are appended to the journal and it is synced, so an entry on disk
+ * never covers output that isn't. A crash loses at most the jobs finished
+ * since the last sync, and a torn final entry is dropped on resume.
+ */
+class ISOMODEL_API BatchJournal
+{
+public:
+  /**
+   * Opens the journal at path, creating it if it doesn't exist. Throws
+   * std::runtime_error if it can't be opened or isn't a journal.
+   */
+  explicit BatchJournal(const std::string& path, double syncSeconds = 1.0);
+  ~BatchJournal();
+
+  BatchJournal(const BatchJournal&) = delete;
+  BatchJournal& operator=(const BatchJournal&) = delete;
+
+  /**
+   * Reads the journal's entries for jobs and returns the error of each job
+   * it records as finished (empty if the job succeeded), which are always
+   * the first jobs. Throws std::runtime_error if an entry names a different
+   * job than jobs does at its index. Jobs may have been added after the
+   * recorded ones since the journal was written.
+   */
+  std::vector<std::string> resume(const std::vector<BatchJob>& jobs);
+
+  /** The size of the output file once the recorded jobs' rows were written. */
+  std::uint64_t offset() const {
+    return m_offset;
+  }
+
+  /**
+   * Sets the output whose rows the entries cover: out is flushed and the file
+   * at path synced before entries are.
+   */
+  void setOutput(std::ostream& out, const std::string& path);
+
+  /**
+   * Records that job index finished, with the output now offset bytes long.
+   * Syncs if syncSeconds have passed since the last sync.
+   */
+  void record(std::size_t index, const BatchJob& job, std::uint64_t offset, const std::string& error);
+
+  /** Makes the output and the recorded entries durable. */
+  void sync();
+
+  /** The number of times the journal has been synced. */
+  std::size_t syncs() const {
+    return m_syncs;
+  }
+
+private:
+  std::string m_path;
+  std::chrono::steady_clock::duration m_syncInterval;
+  std::chrono::steady_clock::time_point m_lastSync;
+  std::FILE* m_file = nullptr;
+  std::ostream* m_out = nullptr;
+  std::FILE* m_outFile = nullptr;
+  std::string m_pending;
+  std::uint64_t m_offset = 0;
+  std::size_t m_syncs = 0;
+};
+
+} // isomodel
+} // openstudio
+#endif // ISOMODEL_BATCH_JOURNAL_HPP
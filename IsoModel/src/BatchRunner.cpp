@@ -0,0 +1,447 @@
+#include "BatchRunner.hpp"
+#include "BatchJournal.hpp"
+#include "Portfolio.hpp"
+#include "UserModel.hpp"
+#include "WorkStealingPool.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+
+#include <boost/filesystem.hpp>
+
+namespace openstudio {
+namespace isomodel {
+
+OrderedWriter::OrderedWriter(std::ostream& out, std::size_t first, Callback written)
+  : m_out(out), m_next(first), m_written(written)
+{
+}
+
+void OrderedWriter::write(std::size_t index, const std::string& text)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (index != m_next) {
+    m_pending[index] = text;
+    return;
+  }
+
+  m_out << text;
+  if (m_written) {
+    m_written(m_next, text);
+  }
+  ++m_next;
+  for (auto iter = m_pending.begin(); iter != m_pending.end() && iter->first == m_next; iter = m_pending.erase(iter)) {
+    m_out << iter->second;
+    if (m_written) {
+      m_written(m_next, iter->second);
+    }
+    ++m_next;
+  }
+}
+
+std::size_t OrderedWriter::next() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_next;
+}
+
+BatchRunner::BatchRunner(BatchSettings settings) : m_settings(settings), m_weatherCache(std::make_shared<WeatherCache>())
+{
+  if (m_settings.monthlyGrain == 0) {
+    m_settings.monthlyGrain = 1;
+  }
+}
+
+void BatchRunner::writeHeader(std::ostream& out)
+{
+  out << "File,Engine,Month,ElecHeat,ElecCool,ElecIntLights,ElecExtLights,ElecFans,ElecPump,ElecEquipInt,ElecEquipExt,ElectDHW,GasHeat,GasCool,GasEquip,GasDHW\n";
+}
+
+std::shared_ptr<UserModel> BatchRunner::load(const BatchJob& job, const std::shared_ptr<WeatherCache>& cache)
+{
+  // UserModel::load() reports missing files on stdout, which may be where the
+  // results are going, so check first.
+  if (!boost::filesystem::exists(job.ismPath)) {
+    throw std::runtime_error("ISO Model File Not Found");
+  }
+  if (!job.defaultsPath.empty() && !boost::filesystem::exists(job.defaultsPath)) {
+    throw std::runtime_error("Defaults File Not Found: " + job.defaultsPath);
+  }
+
+  auto umodel = std::make_shared<UserModel>();
+  umodel->setWeatherCache(cache);
+  if (job.defaultsPath.empty()) {
+    umodel->load(job.ismPath);
+  } else {
+    umodel->load(job.ismPath, job.defaultsPath);
+  }
+  if (!umodel->valid()) {
+    throw std::runtime_error("Invalid model");
+  }
+  return umodel;
+}
+
+std::string BatchRunner::formatRows(const BatchJob& job, std::vector<EndUses>& results)
+{
+  std::ostringstream rows;
+  rows << std::setprecision(10);
+  for (std::size_t month = 0; month < results.size(); ++month) {
+    rows << job.ismPath << "," << (job.hourly ? "hourly" : "monthly") << "," << month + 1;
+    for (int i = 0; i < 13; ++i) {
+#ifdef ISOMODEL_STANDALONE
+      rows << "," << results[month].getEndUse(i);
+#else
+      rows << "," << results[month].getEndUse(isoResultsEndUseTypes[i].first, isoResultsEndUseTypes[i].second);
+#endif
+    }
+    rows << "\n";
+  }
+  return rows.str();
+}
+
+std::vector<EndUses> BatchRunner::simulate(const BatchJob& job,
+                                           const UserModel& model,
+                                           const CancellationToken& cancellation,
+                                           ResultCache* resultCache)
+{
+  cancellation.throwIfCancelled();
+  std::vector<EndUses> results;
+  ModelHash key;
+  if (resultCache) {
+    key = model.stateHash(job.hourly ? "hourly" : "monthly");
+    if (resultCache->get(key, results)) {
+      return results;
+    }
+  }
+
+  if (!job.hourly) {
+    // Monthly runs take microseconds, so there's nothing to interrupt.
+    results = model.toMonthlyModel().simulate();
+  } else {
+    auto hourly = model.toHourlyModel();
+    hourly.setCancellation(cancellation);
+    results = hourly.simulate(true);
+  }
+  if (resultCache) {
+    resultCache->put(key, results);
+  }
+  return results;
+}
+
+std::string BatchRunner::simulate(const BatchJob& job) const
+{
+  m_settings.cancellation.throwIfCancelled();
+  auto umodel = load(job, m_weatherCache);
+  auto results = simulate(job, *umodel, m_settings.cancellation, m_settings.resultCache.get());
+  return formatRows(job, results);
+}
+
+BatchReport BatchRunner::run(const std::vector<BatchJob>& jobs, std::ostream& out)
+{
+  return run(jobs, 0, out, [this](const BatchJob& job) { return simulate(job); }, nullptr);
+}
+
+BatchReport BatchRunner::run(const std::vector<BatchJob>& jobs, const std::string& outputPath, const std::string& journalPath)
+{
+  BatchJournal journal(journalPath);
+  auto finished = journal.resume(jobs);
+  auto offset = journal.offset();
+
+  // Rows after the last entry belong to jobs that will be run again.
+  auto exists = boost::filesystem::exists(outputPath);
+  if (offset > 0 && (!exists || boost::filesystem::file_size(outputPath) < offset)) {
+    throw std::runtime_error(outputPath + " is shorter than the journal " + journalPath + " records. Delete the journal to start over.");
+  }
+  if (exists) {
+    boost::filesystem::resize_file(outputPath, offset);
+  }
+  std::ofstream out(outputPath, std::ios::binary | std::ios::app);
+  if (!out) {
+    throw std::runtime_error("Could not open " + outputPath);
+  }
+  if (offset == 0) {
+    std::ostringstream header;
+    writeHeader(header);
+    out << header.str();
+    offset = header.str().size();
+  }
+  journal.setOutput(out, outputPath);
+
+  auto recording = true;
+  auto report = run(jobs, finished.size(), out, [this](const BatchJob& job) { return simulate(job); },
+                    [&](std::size_t index, const std::string& rows, const std::string& error, bool cancelled) {
+                      // Entries must cover a prefix of the jobs, so stop at a
+                      // gap.
+                      recording = recording && !cancelled;
+                      if (recording) {
+                        offset += rows.size();
+                        journal.record(index, jobs[index], offset, error);
+                      }
+                    });
+  journal.sync();
+
+  report.resumed = finished.size();
+  report.succeeded += std::count(finished.begin(), finished.end(), std::string());
+  std::vector<std::pair<std::string, std::string> > failures;
+  for (std::size_t i = 0; i < finished.size(); ++i) {
+    if (!finished[i].empty()) {
+      failures.push_back(std::make_pair(jobs[i].ismPath, finished[i]));
+    }
+  }
+  report.failures.insert(report.failures.begin(), failures.begin(), failures.end());
+  return report;
+}
+
+BatchReport BatchRunner::run(const std::vector<BatchJob>& jobs, PortfolioRollup& rollup)
+{
+  auto simulateJob = [this, &rollup](const BatchJob& job) {
+    m_settings.cancellation.throwIfCancelled();
+    auto umodel = load(job, m_weatherCache);
+    std::vector<EndUses> results;
+    if (job.hourly && rollup.coincident()) {
+      auto hourly = umodel->toHourlyModel();
+      hourly.setCancellation(m_settings.cancellation);
+      results = hourly.simulate(false);
+    } else {
+      results = simulate(job, *umodel, m_settings.cancellation, m_settings.resultCache.get());
+    }
+    rollup.add(job, umodel->floorArea(), results);
+    return std::string();
+  };
+  // There are no rows to write.
+  std::ostream discard(nullptr);
+  return run(jobs, 0, discard, simulateJob, nullptr);
+}
+
+BatchReport BatchRunner::run(const std::vector<BatchJob>& jobs,
+                             std::size_t first,
+                             std::ostream& out,
+                             const std::function<std::string(const BatchJob&)>& simulateJob,
+                             const std::function<void(std::size_t, const std::string&, const std::string&, bool)>& written)
+{
+  auto start = std::chrono::steady_clock::now();
+  auto hitsBefore = m_settings.resultCache ? m_settings.resultCache->hits() : 0;
+
+  std::vector<std::string> errors(jobs.size());
+  std::vector<char> cancelled(jobs.size(), false);
+  OrderedWriter::Callback callback;
+  if (written) {
+    // A job's error is set before its rows are passed to the writer.
+    callback = [&written, &errors, &cancelled](std::size_t index, const std::string& rows) {
+      written(index, rows, errors[index], cancelled[index] != 0);
+    };
+  }
+  OrderedWriter writer(out, first, callback);
+  auto runJob = [&jobs, &simulateJob, &writer, &errors, &cancelled](std::size_t index) {
+    std::string rows;
+    try {
+      rows = simulateJob(jobs[index]);
+    } catch (const SimulationCancelled& e) {
+      errors[index] = e.what();
+      cancelled[index] = true;
+    } catch (const std::exception& e) {
+      errors[index] = e.what();
+    }
+    // Failed jobs still take their turn so the ones after them are written.
+    writer.write(index, rows);
+  };
+
+  // Hourly jobs first, one to a task, so they start on separate workers;
+  // then the monthly jobs in groups that the workers left idle at the end
+  // can steal.
+  std::vector<std::function<void()> > tasks;
+  std::vector<std::size_t> monthly;
+  for (std::size_t i = first; i < jobs.size(); ++i) {
+    if (jobs[i].hourly) {
+      tasks.push_back([runJob, i]() { runJob(i); });
+    } else {
+      monthly.push_back(i);
+    }
+  }
+  for (std::size_t first = 0; first < monthly.size(); first += m_settings.monthlyGrain) {
+    auto last = std::min(first + m_settings.monthlyGrain, monthly.size());
+    std::vector<std::size_t> group(monthly.begin() + first, monthly.begin() + last);
+    tasks.push_back([runJob, group]() {
+      for (auto i : group) {
+        runJob(i);
+      }
+    });
+  }
+
+  WorkStealingPool pool(m_settings.threads);
+  pool.run(tasks);
+  out.flush();
+
+  BatchReport report;
+  for (std::size_t i = first; i < jobs.size(); ++i) {
+    if (errors[i].empty()) {
+      ++report.succeeded;
+    } else {
+      report.failures.push_back(std::make_pair(jobs[i].ismPath, errors[i]));
+      report.cancelled += cancelled[i];
+    }
+  }
+  if (m_settings.resultCache) {
+    report.cacheHits = m_settings.resultCache->hits() - hitsBefore;
+  }
+  report.weatherFiles = m_weatherCache->size();
+  report.steals = pool.steals();
+  report.wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  return report;
+}
+
+namespace {
+
+bool hasWildcards(const std::string& path)
+{
+  return path.find_first_of("*?") != std::string::npos;
+}
+
+// Matches a file name against a pattern where * matches any run of
+// characters and ? any single character.
+bool wildcardMatch(const char* pattern, const char* name)
+{
+  for (; *pattern; ++pattern, ++name) {
+    if (*pattern == '*') {
+      for (auto rest = name;; ++rest) {
+        if (wildcardMatch(pattern + 1, rest)) {
+          return true;
+        }
+        if (!*rest) {
+          return false;
+        }
+      }
+    }
+    if (!*name || (*pattern != '?' && *pattern != *name)) {
+      return false;
+    }
+  }
+  return !*name;
+}
+
+std::vector<std::string> matchingFiles(const boost::filesystem::path& directory, const std::string& pattern)
+{
+  std::vector<std::string> matches;
+  if (!boost::filesystem::is_directory(directory)) {
+    return matches;
+  }
+  for (boost::filesystem::directory_iterator iter(directory), end; iter != end; ++iter) {
+    if (boost::filesystem::is_regular_file(iter->status()) &&
+        wildcardMatch(pattern.c_str(), iter->path().filename().string().c_str())) {
+      matches.push_back(iter->path().string());
+    }
+  }
+  std::sort(matches.begin(), matches.end());
+  return matches;
+}
+
+} // namespace
+
+std::vector<std::string> expandIsmPaths(const std::string& path)
+{
+  boost::filesystem::path p(path);
+  if (boost::filesystem::is_directory(p)) {
+    return matchingFiles(p, "*.ism");
+  }
+  if (hasWildcards(path)) {
+    auto directory = p.parent_path();
+    return matchingFiles(directory.empty() ? boost::filesystem::path(".") : directory, p.filename().string());
+  }
+  return std::vector<std::string>(1, path);
+}
+
+std::vector<BatchJob> readBatchManifest(std::istream& manifest, const std::string& baseDirectory, bool hourly)
+{
+  std::vector<BatchJob> jobs;
+  std::string line;
+  while (std::getline(manifest, line)) {
+    std::istringstream words(line);
+    std::string path, engine;
+    if (!(words >> path) || path[0] == '#') {
+      continue;
+    }
+
+    auto lineHourly = hourly;
+    auto count = 1.0;
+    std::map<std::string, std::string> groups;
+    std::string word;
+    for (auto first = true; words >> word; first = false) {
+      auto equals = word.find('=');
+      if (equals == std::string::npos) {
+        engine = word;
+        if (!first) {
+          throw std::invalid_argument("Expected key=value after the engine for " + path + " in batch manifest, not '" + word + "'");
+        } else if (engine == "hourly") {
+          lineHourly = true;
+        } else if (engine == "monthly") {
+          lineHourly = false;
+        } else {
+          throw std::invalid_argument("Unknown engine '" + engine + "' for " + path + " in batch manifest. Use 'monthly' or 'hourly'.");
+        }
+        continue;
+      }
+
+      auto key = word.substr(0, equals);
+      auto value = word.substr(equals + 1);
+      if (key != "count") {
+        groups[key] = value;
+        continue;
+      }
+      std::size_t end = 0;
+      try {
+        count = std::stod(value, &end);
+      } catch (const std::exception&) {
+        end = 0;
+      }
+      if (end == 0 || end != value.size() || !(count > 0)) {
+        throw std::invalid_argument("The count for " + path + " in batch manifest must be a positive number, not '" + value + "'");
+      }
+    }
+
+    boost::filesystem::path p(path);
+    if (p.is_relative() && !baseDirectory.empty()) {
+      p = boost::filesystem::path(baseDirectory) / p;
+    }
+    for (const auto& ismPath : expandIsmPaths(p.string())) {
+      BatchJob job;
+      job.ismPath = ismPath;
+      job.hourly = lineHourly;
+      job.count = count;
+      job.groups = groups;
+      jobs.push_back(job);
+    }
+  }
+  return jobs;
+}
+
+std::vector<BatchJob> batchJobs(const std::vector<std::string>& inputs, bool hourly)
+{
+  std::vector<BatchJob> jobs;
+  for (const auto& input : inputs) {
+    boost::filesystem::path p(input);
+    if (boost::filesystem::is_directory(p) || hasWildcards(input) || p.extension() == ".ism") {
+      for (const auto& ismPath : expandIsmPaths(input)) {
+        BatchJob job;
+        job.ismPath = ismPath;
+        job.hourly = hourly;
+        jobs.push_back(job);
+      }
+    } else {
+      std::ifstream manifest(input);
+      if (!manifest) {
+        throw std::invalid_argument("Could not open batch manifest " + input);
+      }
+      auto manifestJobs = readBatchManifest(manifest, p.parent_path().string(), hourly);
+      jobs.insert(jobs.end(), manifestJobs.begin(), manifestJobs.end());
+    }
+  }
+  return jobs;
+}
+
+} // isomodel
+} // openstudio
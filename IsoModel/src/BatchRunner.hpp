@@ -0,0 +1,211 @@
+#ifndef ISOMODEL_BATCH_RUNNER_HPP
+#define ISOMODEL_BATCH_RUNNER_HPP
+
+#include "Cancellation.hpp"
+#include "ISOModelAPI.hpp"
+#include "ResultCache.hpp"
+#include "WeatherCache.hpp"
+
+#include <cstddef>
+#include <functional>
+#include <iosfwd>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#ifdef ISOMODEL_STANDALONE
+#include "EndUses.hpp"
+#else
+#include "../utilities/data/EndUses.hpp"
+#endif
+
+namespace openstudio {
+namespace isomodel {
+
+class PortfolioRollup;
+class UserModel;
+
+// One building of a batch: an .ism file and the engine to simulate it with.
+struct BatchJob
+{
+  std::string ismPath;
+  std::string defaultsPath; // Optional defaults .ism file.
+  bool hourly = false; // Run the hourly model (results aggregated by month) instead of the monthly one.
+  // For portfolio totals: the number of buildings in the stock this one
+  // stands for, and its value of each of the portfolio's dimensions, such as
+  // type = office.
+  double count = 1.0;
+  std::map<std::string, std::string> groups;
+};
+
+// Settings for BatchRunner.
+struct BatchSettings
+{
+  // Worker threads, or 0 for one per hardware thread.
+  std::size_t threads = 0;
+  // Monthly jobs run this many to a task. A monthly run takes microseconds,
+  // about a thousandth of an hourly run, so grouping them keeps the cost of
+  // scheduling out of the way while still leaving enough tasks to balance.
+  std::size_t monthlyGrain = 64;
+  // Cancel to stop the run: hourly simulations in progress stop within a
+  // simulated day, and jobs not yet started are skipped.
+  CancellationToken cancellation;
+  // Results of earlier runs, looked up before simulating each building and
+  // added to after. Optional; may be shared with other runners and processes.
+  std::shared_ptr<ResultCache> resultCache;
+};
+
+// What happened during BatchRunner::run().
+struct BatchReport
+{
+  std::size_t succeeded = 0;
+  std::vector<std::pair<std::string, std::string> > failures; // (.ism path, error), in job order.
+  std::size_t cancelled = 0; // Failures that were stopped or skipped by a cancellation.
+  std::size_t resumed = 0; // Jobs a journal recorded as finished by an earlier run, which weren't rerun.
+  std::size_t cacheHits = 0; // Jobs whose results came from the settings' result cache.
+  std::size_t weatherFiles = 0; // Distinct weather files parsed.
+  std::size_t steals = 0; // Tasks run by a worker other than the one they were queued on.
+  double wallSeconds = 0.0;
+};
+
+/**
+ * Writes numbered pieces of text to a stream in index order, whatever order
+ * they arrive in. Pieces that arrive early are held until the ones before
+ * them are written. Safe to use from several threads.
+ */
+class ISOMODEL_API OrderedWriter
+{
+public:
+  // Called with each piece's index and text just after it is written, in
+  // index order and never concurrently.
+  typedef std::function<void(std::size_t, const std::string&)> Callback;
+
+  explicit OrderedWriter(std::ostream& out, std::size_t first = 0, Callback written = Callback());
+
+  void write(std::size_t index, const std::string& text);
+
+  /** The index of the next piece to be written. */
+  std::size_t next() const;
+
+private:
+  std::ostream& m_out;
+  mutable std::mutex m_mutex;
+  std::size_t m_next;
+  std::map<std::size_t, std::string> m_pending;
+  Callback m_written;
+};
+
+/**
+ * Simulates many buildings in one process. Jobs run on a WorkStealingPool,
+ * the hourly ones first since they take about a thousand times as long, and
+ * share parsed weather files through a WeatherCache. Each building's monthly
+ * results are written as CSV rows, in job order, through an OrderedWriter.
+ */
+class ISOMODEL_API BatchRunner
+{
+public:
+  explicit BatchRunner(BatchSettings settings = BatchSettings());
+
+  /** Writes the CSV header matching the rows run() writes. */
+  static void writeHeader(std::ostream& out);
+
+  /**
+   * Loads a job's building, sharing weather through cache if it isn't
+   * empty. Throws std::runtime_error if the building can't be loaded.
+   */
+  static std::shared_ptr<UserModel> load(const BatchJob& job, const std::shared_ptr<WeatherCache>& cache);
+
+  /**
+   * Simulates a loaded job's building, stopping with SimulationCancelled if
+   * cancellation is cancelled first. With a result cache, returns the stored
+   * results if the building has been simulated before, and stores them
+   * otherwise.
+   */
+  static std::vector<EndUses> simulate(const BatchJob& job,
+                                       const UserModel& model,
+                                       const CancellationToken& cancellation,
+                                       ResultCache* resultCache = nullptr);
+
+  /** Formats a job's monthly results as the rows run() writes. */
+  static std::string formatRows(const BatchJob& job, std::vector<EndUses>& results);
+
+  /**
+   * Runs the jobs and writes 12 rows per building (file, engine, month and
+   * the 13 end uses) to out. A building that fails to load or simulate is
+   * listed in the report's failures and has no rows. If the settings'
+   * cancellation is cancelled, the jobs still running stop early and the
+   * rest are skipped, and all of them are reported as failures; the rows of
+   * the jobs that finished are written as usual.
+   */
+  BatchReport run(const std::vector<BatchJob>& jobs, std::ostream& out);
+
+  /**
+   * Runs the jobs like run(), writing the header and rows to the file at
+   * outputPath and recording the finished jobs in a BatchJournal at
+   * journalPath. If the journal already records some of the jobs, as after
+   * a run that died part way through, the output is cut back to the end of
+   * their rows, and only the jobs after them are run and appended. Their
+   * earlier results count towards the report. The journal stops recording
+   * at the first cancelled job, so a cancelled run resumes from there.
+   * Throws std::runtime_error if the journal is for a different batch or the
+   * files can't be opened.
+   */
+  BatchReport run(const std::vector<BatchJob>& jobs, const std::string& outputPath, const std::string& journalPath);
+
+  /**
+   * Runs the jobs like run(), but instead of writing each building's rows,
+   * adds its results to rollup, weighted by its floor area and count. If the
+   * rollup is coincident, hourly jobs are simulated hour by hour, without
+   * the result cache, so their loads add to the portfolio's hourly load.
+   */
+  BatchReport run(const std::vector<BatchJob>& jobs, PortfolioRollup& rollup);
+
+  /** The weather shared by the runs. Kept between calls to run(). */
+  std::shared_ptr<WeatherCache> weatherCache() const {
+    return m_weatherCache;
+  }
+
+private:
+  std::string simulate(const BatchJob& job) const;
+  BatchReport run(const std::vector<BatchJob>& jobs,
+                  std::size_t first,
+                  std::ostream& out,
+                  const std::function<std::string(const BatchJob&)>& simulateJob,
+                  const std::function<void(std::size_t, const std::string&, const std::string&, bool)>& written);
+
+  BatchSettings m_settings;
+  std::shared_ptr<WeatherCache> m_weatherCache;
+};
+
+/**
+ * Returns the .ism files a path names: the path itself for a file, the
+ * files ending in .ism in a directory, or the files matching a file name
+ * containing the wildcards * and ?. Directories and wildcards are expanded in
+ * sorted order.
+ */
+ISOMODEL_API std::vector<std::string> expandIsmPaths(const std::string& path);
+
+/**
+ * Reads a batch manifest: one path per line, optionally followed by
+ * "monthly" or "hourly" to override the engine for that line and by
+ * key=value attributes for portfolio totals: count=N sets the jobs' count and
+ * any other key one of their groups. Each path is expanded with
+ * expandIsmPaths(), relative to baseDirectory. Blank lines and lines starting
+ * with # are skipped. Throws std::invalid_argument for an unknown engine or
+ * a count that isn't a positive number.
+ */
+ISOMODEL_API std::vector<BatchJob> readBatchManifest(std::istream& manifest, const std::string& baseDirectory, bool hourly);
+
+/**
+ * Turns command line inputs into jobs. Inputs that are directories, contain
+ * wildcards or end in .ism are expanded with expandIsmPaths(); anything else
+ * is read as a manifest.
+ */
+ISOMODEL_API std::vector<BatchJob> batchJobs(const std::vector<std::string>& inputs, bool hourly);
+
+} // isomodel
+} // openstudio
+#endif // ISOMODEL_BATCH_RUNNER_HPP
@@ -0,0 +1,92 @@
+#ifndef ISOMODEL_BOUNDED_QUEUE_HPP
+#define ISOMODEL_BOUNDED_QUEUE_HPP
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <utility>
+
+namespace openstudio {
+namespace isomodel {
+
+/**
+ * A first-in first-out queue between threads that holds at most a fixed
+ * number of items. push() waits while the queue is full, which slows a
+ * producer down to the pace of its consumers; pop() waits while it is empty.
+ * Once closed, pushes are refused and pops drain what is left.
+ */
+template<typename T>
+class BoundedQueue
+{
+public:
+  explicit BoundedQueue(std::size_t capacity) : m_capacity(std::max<std::size_t>(capacity, 1)), m_closed(false)
+  {
+  }
+
+  BoundedQueue(const BoundedQueue&) = delete;
+  BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+  /** Waits for room and adds item. Returns false, dropping item, if the queue is closed. */
+  bool push(T item)
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_notFull.wait(lock, [this]() { return m_closed || m_items.size() < m_capacity; });
+    if (m_closed) {
+      return false;
+    }
+    m_items.push_back(std::move(item));
+    lock.unlock();
+    m_notEmpty.notify_one();
+    return true;
+  }
+
+  /** Waits for an item and moves it into item. Returns false once the queue is closed and empty. */
+  bool pop(T& item)
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_notEmpty.wait(lock, [this]() { return m_closed || !m_items.empty(); });
+    if (m_items.empty()) {
+      return false;
+    }
+    item = std::move(m_items.front());
+    m_items.pop_front();
+    lock.unlock();
+    m_notFull.notify_one();
+    return true;
+  }
+
+  /** Refuses further pushes and wakes every waiting thread. */
+  void close()
+  {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_closed = true;
+    }
+    m_notEmpty.notify_all();
+    m_notFull.notify_all();
+  }
+
+  std::size_t size() const
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_items.size();
+  }
+
+  std::size_t capacity() const {
+    return m_capacity;
+  }
+
+private:
+  const std::size_t m_capacity;
+  bool m_closed;
+  std::deque<T> m_items;
+  mutable std::mutex m_mutex;
+  std::condition_variable m_notEmpty;
+  std::condition_variable m_notFull;
+};
+
+} // isomodel
+} // openstudio
+#endif // ISOMODEL_BOUNDED_QUEUE_HPP
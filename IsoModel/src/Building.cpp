@@ -3,13 +3,7 @@
 namespace openstudio {
 namespace isomodel {
 
-Building::Building(void)
-{
-}
-
-Building::~Building(void)
-{
-}
+template class ISOMODEL_API BasicBuilding<double>;
 
 } // isomodel
 } // openstudio
@@ -20,14 +20,33 @@
 #define ISOMODEL_BUILDING_HPP
 
 #include "ISOModelAPI.hpp"
+#include "Dual.hpp"
 
 namespace openstudio {
 namespace isomodel {
-class ISOMODEL_API Building
+template<typename T>
+class BasicBuilding
 {
 public:
-  Building(void);
-  ~Building(void);
+  BasicBuilding() {}
+
+  /** Converts the parameters from another scalar type. */
+  template<typename U>
+  explicit BasicBuilding(const BasicBuilding<U>& other) :
+      m_lightingOccupancySensor(other.m_lightingOccupancySensor),
+      m_constantIllumination(other.m_constantIllumination),
+      m_electricApplianceHeatGainOccupied(other.m_electricApplianceHeatGainOccupied),
+      m_electricApplianceHeatGainUnoccupied(other.m_electricApplianceHeatGainUnoccupied),
+      m_gasApplianceHeatGainOccupied(other.m_gasApplianceHeatGainOccupied),
+      m_gasApplianceHeatGainUnoccupied(other.m_gasApplianceHeatGainUnoccupied),
+      m_buildingEnergyManagement(other.m_buildingEnergyManagement),
+      m_externalEquipment(other.m_externalEquipment),
+      m_electricAppliancePowerFixedOccupied(other.m_electricAppliancePowerFixedOccupied),
+      m_electricAppliancePowerFixedUnoccupied(other.m_electricAppliancePowerFixedUnoccupied),
+      m_gasAppliancePowerFixedOccupied(other.m_gasAppliancePowerFixedOccupied),
+      m_gasAppliancePowerFixedUnoccupied(other.m_gasAppliancePowerFixedUnoccupied)
+  {
+  }
 
   /**
   * Lighting occupancy sensor dimming fraction (unitless).
@@ -35,11 +54,11 @@ public:
   * See iso 15193 Annex F/G for values.
   * XXX: Should this be in the Lighting class?
   */
-  double lightingOccupancySensor() const {
+  T lightingOccupancySensor() const {
     return m_lightingOccupancySensor;
   }
 
-  void setLightingOccupancySensor(double value) {
+  void setLightingOccupancySensor(T value) {
     m_lightingOccupancySensor = value;
   }
 
@@ -49,11 +68,11 @@ public:
   * See iso 15193 Annex F/G for values.
   * XXX: Should this be in the Lighting class?
   */
-  double constantIllumination() const {
+  T constantIllumination() const {
     return m_constantIllumination;
   }
 
-  void setConstantIllumination(double value) {
+  void setConstantIllumination(T value) {
     m_constantIllumination = value;
   }
 
@@ -61,11 +80,11 @@ public:
   * Electric appliance power density occupied (W/m2).
   * This value is used for both the electricity consumed and the heat produced by the appliances.
   */
-  double electricApplianceHeatGainOccupied() const {
+  T electricApplianceHeatGainOccupied() const {
     return m_electricApplianceHeatGainOccupied;
   }
 
-  void setElectricApplianceHeatGainOccupied(double value) {
+  void setElectricApplianceHeatGainOccupied(T value) {
     m_electricApplianceHeatGainOccupied = value;
   }
 
@@ -73,11 +92,11 @@ public:
   * Electric appliance power density unoccupied (W/m2).
   * This value is used for both the electricity consumed and the heat produced by the appliances.
   */
-  double electricApplianceHeatGainUnoccupied() const {
+  T electricApplianceHeatGainUnoccupied() const {
     return m_electricApplianceHeatGainUnoccupied;
   }
 
-  void setElectricApplianceHeatGainUnoccupied(double value) {
+  void setElectricApplianceHeatGainUnoccupied(T value) {
     m_electricApplianceHeatGainUnoccupied = value;
   }
 
@@ -85,11 +104,11 @@ public:
   * Gas appliance power density occupied (W/m2).
   * This value is used for both the energy consumed and the heat produced by the appliances.
   */
-  double gasApplianceHeatGainOccupied() const {
+  T gasApplianceHeatGainOccupied() const {
     return m_gasApplianceHeatGainOccupied;
   }
 
-  void setGasApplianceHeatGainOccupied(double value) {
+  void setGasApplianceHeatGainOccupied(T value) {
     m_gasApplianceHeatGainOccupied = value;
   }
 
@@ -97,11 +116,11 @@ public:
   * Gas appliance power density unoccupied (W/m2).
   * This value is used for both the energy consumed and the heat produced by the appliances.
   */
-  double gasApplianceHeatGainUnoccupied() const {
+  T gasApplianceHeatGainUnoccupied() const {
     return m_gasApplianceHeatGainUnoccupied;
   }
 
-  void setGasApplianceHeatGainUnoccupied(double value) {
+  void setGasApplianceHeatGainUnoccupied(T value) {
     m_gasApplianceHeatGainUnoccupied = value;
   }
 
@@ -109,11 +128,11 @@ public:
   * Building energy management type: none (0), simple (1) or advanced (2).
   * Used to adjust the heating and cooling set points in the monthly calculations.
   */
-  double buildingEnergyManagement() const {
+  T buildingEnergyManagement() const {
     return m_buildingEnergyManagement;
   }
 
-  void setBuildingEnergyManagement(double value) {
+  void setBuildingEnergyManagement(T value) {
     m_buildingEnergyManagement = value;
   }
 
@@ -121,11 +140,11 @@ public:
   * External equipment energy use (W).
   */
 
-  double externalEquipment() const {
+  T externalEquipment() const {
     return m_externalEquipment;
   }
 
-  void setExternalEquipment(double externalEquipment) {
+  void setExternalEquipment(T externalEquipment) {
     m_externalEquipment = externalEquipment;
   }
 
@@ -133,66 +152,72 @@ public:
   /**
   *
   */
-  double electricAppliancePowerFixedOccupied() const {
+  T electricAppliancePowerFixedOccupied() const {
     return m_electricAppliancePowerFixedOccupied;
   }
 
-  void setElectricAppliancePowerFixedOccupied(double electricAppliancePowerFixedOccupied) {
+  void setElectricAppliancePowerFixedOccupied(T electricAppliancePowerFixedOccupied) {
     m_electricAppliancePowerFixedOccupied = electricAppliancePowerFixedOccupied;
   }
 
   /**
   *
   */
-  double electricAppliancePowerFixedUnoccupied() const {
+  T electricAppliancePowerFixedUnoccupied() const {
     return m_electricAppliancePowerFixedUnoccupied;
   }
 
-  void setElectricAppliancePowerFixedUnoccupied(double electricAppliancePowerFixedUnoccupied) {
+  void setElectricAppliancePowerFixedUnoccupied(T electricAppliancePowerFixedUnoccupied) {
     m_electricAppliancePowerFixedUnoccupied = electricAppliancePowerFixedUnoccupied;
   }
 
   /**
   *
   */
-  double gasAppliancePowerFixedOccupied() const {
+  T gasAppliancePowerFixedOccupied() const {
     return m_gasAppliancePowerFixedOccupied;
   }
 
-  void setGasAppliancePowerFixedOccupied(double gasAppliancePowerFixedOccupied) {
+  void setGasAppliancePowerFixedOccupied(T gasAppliancePowerFixedOccupied) {
     m_gasAppliancePowerFixedOccupied = gasAppliancePowerFixedOccupied;
   }
 
   /**
   *
   */
-  double gasAppliancePowerFixedUnoccupied() const {
+  T gasAppliancePowerFixedUnoccupied() const {
     return m_gasAppliancePowerFixedUnoccupied;
   }
 
-  void setGasAppliancePowerFixedUnoccupied(double gasAppliancePowerFixedUnoccupied) {
+  void setGasAppliancePowerFixedUnoccupied(T gasAppliancePowerFixedUnoccupied) {
     m_gasAppliancePowerFixedUnoccupied = gasAppliancePowerFixedUnoccupied;
   }
 
 private:
-  double m_lightingOccupancySensor;
-  double m_constantIllumination;
-  double m_electricApplianceHeatGainOccupied;
-  double m_electricApplianceHeatGainUnoccupied;
-  double m_gasApplianceHeatGainOccupied;
-  double m_gasApplianceHeatGainUnoccupied;
-  double m_buildingEnergyManagement;
+  template<typename>
+  friend class BasicBuilding;
+
+  T m_lightingOccupancySensor;
+  T m_constantIllumination;
+  T m_electricApplianceHeatGainOccupied;
+  T m_electricApplianceHeatGainUnoccupied;
+  T m_gasApplianceHeatGainOccupied;
+  T m_gasApplianceHeatGainUnoccupied;
+  T m_buildingEnergyManagement;
 
   // Members with default values:
-  double m_externalEquipment = 0.0;
+  T m_externalEquipment = 0.0;
 
   // TODO: These properties aren't used by the simulations yet -BAA@2015-06-18
-  double m_electricAppliancePowerFixedOccupied;
-  double m_electricAppliancePowerFixedUnoccupied;
-  double m_gasAppliancePowerFixedOccupied;
-  double m_gasAppliancePowerFixedUnoccupied;
+  T m_electricAppliancePowerFixedOccupied = 0.0;
+  T m_electricAppliancePowerFixedUnoccupied = 0.0;
+  T m_gasAppliancePowerFixedOccupied = 0.0;
+  T m_gasAppliancePowerFixedUnoccupied = 0.0;
 };
 
+extern template class ISOMODEL_API BasicBuilding<double>;
+typedef BasicBuilding<double> Building;
+
 } // isomodel
 } // openstudio
 #endif // ISOMODEL_BUILDING_HPP
@@ -0,0 +1,613 @@
+#include "Calibration.hpp"
+#include "CounterRng.hpp"
+#include "WorkStealingPool.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <limits>
+#include <numeric>
+#include <ostream>
+#include <stdexcept>
+
+namespace openstudio {
+namespace isomodel {
+
+namespace {
+
+const double infinity = std::numeric_limits<double>::infinity();
+
+const double pi = 3.14159265358979323846;
+
+double seconds(std::chrono::steady_clock::time_point start)
+{
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Converts a point of the unit cube to property values.
+std::vector<double> scaled(const CalibrationSpec& spec, const std::vector<double>& point)
+{
+  std::vector<double> values(point.size());
+  for (std::size_t d = 0; d < point.size(); ++d) {
+    values[d] = spec.low[d] + point[d] * (spec.high[d] - spec.low[d]);
+  }
+  return values;
+}
+
+std::vector<double> clamped(std::vector<double> point)
+{
+  for (auto& x : point) {
+    x = std::min(1.0, std::max(0.0, x));
+  }
+  return point;
+}
+
+// a + scale * (a - b)
+std::vector<double> along(const std::vector<double>& a, const std::vector<double>& b, double scale)
+{
+  std::vector<double> point(a.size());
+  for (std::size_t d = 0; d < a.size(); ++d) {
+    point[d] = a[d] + scale * (a[d] - b[d]);
+  }
+  return clamped(point);
+}
+
+void addFuel(const std::vector<double>& measured, const std::vector<double>& simulated, double& cvRmse, double& nmbe,
+             double& objective)
+{
+  cvRmse = nmbe = 0.0;
+  if (measured.empty()) {
+    return;
+  }
+  if (simulated.size() != measured.size()) {
+    throw std::invalid_argument("Measured and simulated use must cover the same months");
+  }
+  auto n = static_cast<double>(measured.size());
+  auto mean = std::accumulate(measured.begin(), measured.end(), 0.0) / n;
+  if (mean == 0.0 || n < 2) {
+    return;
+  }
+  auto squares = 0.0, bias = 0.0;
+  for (std::size_t i = 0; i < measured.size(); ++i) {
+    auto error = measured[i] - simulated[i];
+    squares += error * error;
+    bias += error;
+  }
+  cvRmse = std::sqrt(squares / (n - 1)) / mean;
+  nmbe = bias / ((n - 1) * mean);
+  objective += cvRmse * cvRmse + nmbe * nmbe;
+}
+
+} // namespace
+
+CalibrationSpec CalibrationSpec::read(const std::string& path)
+{
+  try {
+    return read(Properties(path));
+  } catch (std::domain_error* e) {
+    // Properties throws pointers.
+    std::string message = e->what();
+    delete e;
+    throw std::invalid_argument(message);
+  }
+}
+
+CalibrationSpec CalibrationSpec::read(const Properties& props)
+{
+  CalibrationSpec spec;
+  for (auto key = props.keys_begin(); key != props.keys_end(); ++key) {
+    auto value = *props.getProperty(*key);
+    std::transform(value.begin(), value.end(), value.begin(), ::tolower);
+    if (*key == "method") {
+      if (value != "neldermead" && value != "mcmc") {
+        throw std::invalid_argument("Unknown calibration method '" + value + "'. Use neldermead or mcmc.");
+      }
+      spec.method = value;
+    } else if (*key == "engine") {
+      if (value != "monthly" && value != "hourly") {
+        throw std::invalid_argument("Unknown calibration engine '" + value + "'. Use monthly or hourly.");
+      }
+      spec.hourly = value == "hourly";
+    } else if (*key == "refine") {
+      if (value != "hourly" && value != "none") {
+        throw std::invalid_argument("Unknown calibration refinement '" + value + "'. Use hourly or none.");
+      }
+      spec.refineHourly = value == "hourly";
+    } else if (*key == "units") {
+      if (value != "kwh/m2" && value != "kwh") {
+        throw std::invalid_argument("Unknown calibration units '" + value + "'. Use kwh/m2 or kwh.");
+      }
+      spec.perArea = value == "kwh/m2";
+    } else if (*key == "iterations" || *key == "refineiterations" || *key == "chains" || *key == "seed" || *key == "threads") {
+      auto count = props.getPropertyAsInt(*key);
+      if (!count || *count < 0) {
+        throw std::invalid_argument("Calibration " + *key + " must be a non-negative integer");
+      }
+      if (*key == "iterations") {
+        spec.iterations = *count;
+      } else if (*key == "refineiterations") {
+        spec.refineIterations = *count;
+      } else if (*key == "chains") {
+        spec.chains = *count;
+      } else if (*key == "seed") {
+        spec.seed = *count;
+      } else {
+        spec.threads = *count;
+      }
+    } else if (*key == "tolerance" || *key == "step" || *key == "noise") {
+      auto number = props.getPropertyAsDouble(*key);
+      if (!number || !(*number > 0.0)) {
+        throw std::invalid_argument("Calibration " + *key + " must be a positive number");
+      }
+      if (*key == "tolerance") {
+        spec.tolerance = *number;
+      } else if (*key == "step") {
+        spec.step = *number;
+      } else {
+        spec.noise = *number;
+      }
+    } else if (*key == "electricity" || *key == "gas") {
+      auto& measured = *key == "electricity" ? spec.electricity : spec.gas;
+      if (!props.getPropertyAsDoubleVector(*key, measured) || measured.size() != 12) {
+        throw std::invalid_argument("Calibration " + *key + " must be 12 monthly values");
+      }
+    } else {
+      std::vector<double> range;
+      if (!props.getPropertyAsDoubleVector(*key, range) || range.size() != 2 || !(range[0] < range[1])) {
+        throw std::invalid_argument("Calibration property " + *key + " must be a range 'low, high'");
+      }
+      spec.properties.push_back(*key);
+      spec.low.push_back(range[0]);
+      spec.high.push_back(range[1]);
+    }
+  }
+  return spec;
+}
+
+FitStatistics FitStatistics::compute(const std::vector<double>& measuredElectricity, const std::vector<double>& measuredGas,
+                                     const std::vector<double>& simulatedElectricity, const std::vector<double>& simulatedGas)
+{
+  FitStatistics fit;
+  addFuel(measuredElectricity, simulatedElectricity, fit.electricityCvRmse, fit.electricityNmbe, fit.objective);
+  addFuel(measuredGas, simulatedGas, fit.gasCvRmse, fit.gasNmbe, fit.objective);
+  return fit;
+}
+
+void CalibrationResult::write(std::ostream& out) const
+{
+  out << std::setprecision(10);
+  out << "Method," << method << "\n";
+  out << "Converged," << (converged ? "true" : "false") << "\n";
+  out << "Evaluations," << evaluations << "\n";
+  out << "WallSeconds," << wallSeconds << "\n";
+  out << "SecondsPerIteration," << secondsPerIteration << "\n";
+  out << "ElectricityCvRmse," << fit.electricityCvRmse << "\n";
+  out << "ElectricityNmbe," << fit.electricityNmbe << "\n";
+  out << "GasCvRmse," << fit.gasCvRmse << "\n";
+  out << "GasNmbe," << fit.gasNmbe << "\n";
+  out << "Objective," << fit.objective << "\n\n";
+
+  if (posteriorMean.empty()) {
+    out << "Property,Value\n";
+    for (std::size_t i = 0; i < properties.size(); ++i) {
+      out << properties[i] << "," << values[i] << "\n";
+    }
+    out << "\nIteration,Engine,Objective,SimplexSize,Seconds\n";
+    for (const auto& iteration : history) {
+      out << iteration.iteration << "," << (iteration.hourly ? "hourly" : "monthly") << "," << iteration.objective << ","
+          << iteration.simplexSize << "," << iteration.seconds << "\n";
+    }
+  } else {
+    out << "Property,Value,PosteriorMean,PosteriorStdDev,RHat\n";
+    for (std::size_t i = 0; i < properties.size(); ++i) {
+      out << properties[i] << "," << values[i] << "," << posteriorMean[i] << "," << posteriorStdDev[i] << "," << rHat[i] << "\n";
+    }
+    out << "\nChain,AcceptanceRate\n";
+    for (std::size_t c = 0; c < acceptanceRates.size(); ++c) {
+      out << c << "," << acceptanceRates[c] << "\n";
+    }
+  }
+  out.flush();
+}
+
+Calibration::Calibration(const std::string& baseIsmPath, const std::string& defaultsPath) : m_sweep(baseIsmPath, defaultsPath)
+{
+  try {
+    m_base = defaultsPath.empty() ? Properties(baseIsmPath) : Properties(baseIsmPath, defaultsPath);
+  } catch (std::domain_error* e) {
+    std::string message = e->what();
+    delete e;
+    throw std::invalid_argument(message);
+  }
+}
+
+void Calibration::fuelTotals(const std::vector<EndUses>& months, std::vector<double>& electricity, std::vector<double>& gas)
+{
+  electricity.assign(months.size(), 0.0);
+  gas.assign(months.size(), 0.0);
+  for (std::size_t month = 0; month < months.size(); ++month) {
+    auto results = months[month];
+    for (int i = 0; i < 13; ++i) {
+#ifdef ISOMODEL_STANDALONE
+      auto value = results.getEndUse(i);
+#else
+      auto value = results.getEndUse(isoResultsEndUseTypes[i].first, isoResultsEndUseTypes[i].second);
+#endif
+      // The first nine end uses are electric, the rest gas.
+      (i < 9 ? electricity : gas)[month] += value;
+    }
+  }
+}
+
+FitStatistics Calibration::evaluate(const CalibrationSpec& spec, const std::vector<double>& values, bool hourly) const
+{
+  return evaluate(spec, values, hourly, nullptr);
+}
+
+FitStatistics Calibration::evaluate(const CalibrationSpec& spec,
+                                    const std::vector<double>& values,
+                                    bool hourly,
+                                    const CancellationToken* cancellation) const
+{
+  std::vector<double> electricity, gas;
+  fuelTotals(m_sweep.simulate(spec.properties, values, hourly, cancellation), electricity, gas);
+
+  if (!spec.perArea) {
+    auto floorArea = m_base.getPropertyAsDouble("floorarea");
+    auto fitted = std::find(spec.properties.begin(), spec.properties.end(), "floorarea");
+    if (fitted != spec.properties.end()) {
+      floorArea = values[fitted - spec.properties.begin()];
+    }
+    if (!floorArea) {
+      throw std::invalid_argument("Measured use in kWh needs the building's floorArea");
+    }
+    for (auto& x : electricity) {
+      x *= *floorArea;
+    }
+    for (auto& x : gas) {
+      x *= *floorArea;
+    }
+  }
+  return FitStatistics::compute(spec.electricity, spec.gas, electricity, gas);
+}
+
+std::vector<double> Calibration::startingPoint(const CalibrationSpec& spec) const
+{
+  std::vector<double> point;
+  for (std::size_t d = 0; d < spec.properties.size(); ++d) {
+    auto value = m_base.getPropertyAsDouble(spec.properties[d]);
+    if (value && *value >= spec.low[d] && *value <= spec.high[d]) {
+      point.push_back((*value - spec.low[d]) / (spec.high[d] - spec.low[d]));
+    } else {
+      point.push_back(0.5);
+    }
+  }
+  return point;
+}
+
+void Calibration::nelderMead(const CalibrationSpec& spec, bool hourly, std::size_t iterations, double step,
+                             std::vector<double>& point, CalibrationResult& result) const
+{
+  WorkStealingPool pool(spec.threads);
+  auto objectives = [&](const std::vector<std::vector<double> >& points) {
+    std::vector<double> values(points.size(), infinity);
+    std::vector<std::function<void()> > tasks;
+    for (std::size_t i = 0; i < points.size(); ++i) {
+      tasks.push_back([&, i]() {
+        try {
+          values[i] = evaluate(spec, scaled(spec, points[i]), hourly, &spec.cancellation).objective;
+        } catch (const std::exception&) {
+          // Candidates that fail to simulate are never taken.
+        }
+      });
+    }
+    pool.run(tasks);
+    result.evaluations += points.size();
+    return values;
+  };
+
+  // Work in the unit cube so one step suits every property.
+  auto k = point.size();
+  std::vector<std::vector<double> > simplex(1, point);
+  for (std::size_t d = 0; d < k; ++d) {
+    auto vertex = point;
+    vertex[d] += vertex[d] + step <= 1.0 ? step : -step;
+    simplex.push_back(clamped(vertex));
+  }
+  auto f = objectives(simplex);
+
+  result.converged = false;
+  for (std::size_t iteration = 0; iteration < iterations; ++iteration) {
+    if (spec.cancellation.cancelled()) {
+      // Candidates cancelled mid-run count as failed, so the simplex may
+      // hold some, but its best vertex is still a real fit.
+      result.cancelled = true;
+      break;
+    }
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<std::size_t> order(k + 1);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&f](std::size_t a, std::size_t b) { return f[a] < f[b]; });
+    std::vector<std::vector<double> > sortedSimplex;
+    std::vector<double> sortedF;
+    for (auto i : order) {
+      sortedSimplex.push_back(simplex[i]);
+      sortedF.push_back(f[i]);
+    }
+    simplex.swap(sortedSimplex);
+    f.swap(sortedF);
+
+    if (f[k] - f[0] <= spec.tolerance) {
+      result.converged = true;
+      break;
+    }
+
+    std::vector<double> centroid(k, 0.0);
+    for (std::size_t i = 0; i < k; ++i) {
+      for (std::size_t d = 0; d < k; ++d) {
+        centroid[d] += simplex[i][d] / k;
+      }
+    }
+    const auto& worst = simplex[k];
+    std::vector<std::vector<double> > candidates = { along(centroid, worst, 1.0), along(centroid, worst, 2.0),
+                                                     along(centroid, worst, 0.5), along(centroid, worst, -0.5) };
+    auto fc = objectives(candidates);
+    double reflected = fc[0], expanded = fc[1], outside = fc[2], inside = fc[3];
+
+    int take = -1;
+    if (reflected < f[0]) {
+      take = expanded < reflected ? 1 : 0;
+    } else if (reflected < f[k - 1]) {
+      take = 0;
+    } else if (reflected < f[k]) {
+      take = outside <= reflected ? 2 : -1;
+    } else {
+      take = inside < f[k] ? 3 : -1;
+    }
+
+    if (take >= 0) {
+      simplex[k] = candidates[take];
+      f[k] = fc[take];
+    } else {
+      // Shrink towards the best vertex.
+      std::vector<std::vector<double> > shrunk;
+      for (std::size_t i = 1; i <= k; ++i) {
+        shrunk.push_back(along(simplex[0], simplex[i], -0.5));
+      }
+      auto fs = objectives(shrunk);
+      for (std::size_t i = 1; i <= k; ++i) {
+        simplex[i] = shrunk[i - 1];
+        f[i] = fs[i - 1];
+      }
+    }
+
+    CalibrationIteration progress;
+    progress.iteration = result.history.size() + 1;
+    progress.hourly = hourly;
+    progress.objective = *std::min_element(f.begin(), f.end());
+    for (std::size_t i = 1; i <= k; ++i) {
+      for (std::size_t d = 0; d < k; ++d) {
+        progress.simplexSize = std::max(progress.simplexSize, std::abs(simplex[i][d] - simplex[0][d]));
+      }
+    }
+    progress.seconds = seconds(start);
+    result.history.push_back(progress);
+  }
+
+  point = simplex[std::min_element(f.begin(), f.end()) - f.begin()];
+}
+
+void Calibration::metropolis(const CalibrationSpec& spec, CalibrationResult& result) const
+{
+  if (spec.chains == 0) {
+    throw std::invalid_argument("MCMC calibration needs at least one chain");
+  }
+  auto k = spec.properties.size();
+  auto months = static_cast<double>(std::max(spec.electricity.size(), spec.gas.size()));
+
+  // With independent normal errors of noise times each fuel's mean, the log
+  // likelihood is -(n - 1) / (2 noise^2) times the sum of the squared CV(RMSE)s.
+  auto logPosterior = [&](const std::vector<double>& point, FitStatistics& fit) -> double {
+    for (auto x : point) {
+      if (x < 0.0 || x > 1.0) {
+        return -infinity;
+      }
+    }
+    try {
+      fit = evaluate(spec, scaled(spec, point), spec.hourly, &spec.cancellation);
+    } catch (const std::exception&) {
+      return -infinity;
+    }
+    auto squares = fit.electricityCvRmse * fit.electricityCvRmse + fit.gasCvRmse * fit.gasCvRmse;
+    return -(months - 1) * squares / (2 * spec.noise * spec.noise);
+  };
+
+  struct Chain
+  {
+    std::vector<std::vector<double> > samples;
+    std::size_t steps = 0;
+    std::size_t accepted = 0;
+    std::size_t evaluations = 0;
+    double bestLogPosterior = -infinity;
+    std::vector<double> best;
+    FitStatistics bestFit;
+    double seconds = 0;
+  };
+  std::vector<Chain> chains(spec.chains);
+  auto burnIn = spec.iterations / 2;
+
+  std::vector<std::function<void()> > tasks;
+  for (std::size_t c = 0; c < spec.chains; ++c) {
+    tasks.push_back([&, c]() {
+      auto start = std::chrono::steady_clock::now();
+      auto& chain = chains[c];
+      // Chain c draws from stream c: first its starting point, then 2k
+      // numbers for each proposal and one to accept or reject it.
+      CounterRng rng(spec.seed);
+      std::uint64_t counter = 0;
+      std::vector<double> point(k);
+      for (auto& x : point) {
+        x = rng.uniform(c, counter++);
+      }
+      FitStatistics fit;
+      auto current = logPosterior(point, fit);
+      ++chain.evaluations;
+      chain.best = point;
+      chain.bestLogPosterior = current;
+      chain.bestFit = fit;
+
+      for (std::size_t step = 0; step < spec.iterations; ++step) {
+        if (spec.cancellation.cancelled()) {
+          break;
+        }
+        ++chain.steps;
+        auto proposal = point;
+        for (auto& x : proposal) {
+          auto u1 = rng.uniform(c, counter++);
+          auto u2 = rng.uniform(c, counter++);
+          x += spec.step * std::sqrt(-2.0 * std::log(u1)) * std::cos(2.0 * pi * u2);
+        }
+        auto u = rng.uniform(c, counter++);
+
+        auto inside = std::all_of(proposal.begin(), proposal.end(), [](double x) { return x >= 0.0 && x <= 1.0; });
+        if (inside) {
+          FitStatistics proposedFit;
+          auto proposed = logPosterior(proposal, proposedFit);
+          ++chain.evaluations;
+          if (std::log(u) < proposed - current) {
+            point = proposal;
+            current = proposed;
+            ++chain.accepted;
+            if (current > chain.bestLogPosterior) {
+              chain.bestLogPosterior = current;
+              chain.best = point;
+              chain.bestFit = proposedFit;
+            }
+          }
+        }
+        if (step >= burnIn) {
+          chain.samples.push_back(scaled(spec, point));
+        }
+      }
+      chain.seconds = seconds(start);
+    });
+  }
+  WorkStealingPool pool(spec.threads);
+  pool.run(tasks);
+  result.cancelled = spec.cancellation.cancelled();
+
+  // Cancelled chains can stop at different steps. Keep the same number of
+  // samples from each, as the statistics below assume.
+  auto samples = chains[0].samples.size();
+  for (const auto& chain : chains) {
+    samples = std::min(samples, chain.samples.size());
+  }
+  for (auto& chain : chains) {
+    chain.samples.resize(samples);
+  }
+
+  auto bestChain = &chains[0];
+  for (auto& chain : chains) {
+    result.evaluations += chain.evaluations;
+    result.acceptanceRates.push_back(chain.steps ? static_cast<double>(chain.accepted) / chain.steps : 0.0);
+    result.secondsPerIteration += chain.seconds / std::max<std::size_t>(1, chain.steps) / chains.size();
+    if (chain.bestLogPosterior > bestChain->bestLogPosterior) {
+      bestChain = &chain;
+    }
+  }
+  result.values = scaled(spec, bestChain->best);
+  result.fit = bestChain->bestFit;
+
+  // Pooled posterior moments and the Gelman-Rubin statistic of each property.
+  auto kept = static_cast<double>(samples);
+  result.converged = !result.cancelled && chains.size() > 1 && kept > 1;
+  for (std::size_t d = 0; d < k; ++d) {
+    std::vector<double> means, variances;
+    for (const auto& chain : chains) {
+      auto mean = 0.0, squares = 0.0;
+      for (const auto& sample : chain.samples) {
+        mean += sample[d] / kept;
+      }
+      for (const auto& sample : chain.samples) {
+        squares += (sample[d] - mean) * (sample[d] - mean);
+      }
+      means.push_back(mean);
+      variances.push_back(kept > 1 ? squares / (kept - 1) : 0.0);
+    }
+
+    auto grandMean = std::accumulate(means.begin(), means.end(), 0.0) / means.size();
+    auto within = std::accumulate(variances.begin(), variances.end(), 0.0) / variances.size();
+    auto between = 0.0;
+    for (auto mean : means) {
+      between += (mean - grandMean) * (mean - grandMean);
+    }
+    between = means.size() > 1 ? kept * between / (means.size() - 1) : 0.0;
+    auto pooled = 0.0;
+    for (const auto& chain : chains) {
+      for (const auto& sample : chain.samples) {
+        pooled += (sample[d] - grandMean) * (sample[d] - grandMean);
+      }
+    }
+    auto count = kept * chains.size();
+    pooled = count > 1 ? pooled / (count - 1) : 0.0;
+
+    auto rHat = std::numeric_limits<double>::quiet_NaN();
+    if (chains.size() > 1 && kept > 1) {
+      auto estimate = (kept - 1) / kept * within + between / kept;
+      rHat = within > 0 ? std::sqrt(estimate / within) : (between > 0 ? infinity : 1.0);
+      result.converged = result.converged && rHat < 1.1;
+    }
+    result.posteriorMean.push_back(grandMean);
+    result.posteriorStdDev.push_back(std::sqrt(std::max(0.0, pooled)));
+    result.rHat.push_back(rHat);
+  }
+}
+
+CalibrationResult Calibration::run(const CalibrationSpec& spec) const
+{
+  if (spec.properties.empty()) {
+    throw std::invalid_argument("A calibration needs at least one property to fit");
+  }
+  if (spec.electricity.empty() && spec.gas.empty()) {
+    throw std::invalid_argument("A calibration needs measured electricity or gas use");
+  }
+  if (spec.low.size() != spec.properties.size() || spec.high.size() != spec.properties.size()) {
+    throw std::invalid_argument("Every calibration property needs a range");
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  CalibrationResult result;
+  result.method = spec.method;
+  result.properties = spec.properties;
+
+  if (spec.method == "mcmc") {
+    metropolis(spec, result);
+  } else if (spec.method == "neldermead") {
+    auto point = startingPoint(spec);
+    nelderMead(spec, spec.hourly, spec.iterations, spec.step, point, result);
+    auto hourly = spec.hourly;
+    if (spec.refineHourly && !spec.hourly) {
+      nelderMead(spec, true, spec.refineIterations, spec.step / 4, point, result);
+      hourly = true;
+    }
+    result.values = scaled(spec, point);
+    result.fit = evaluate(spec, result.values, hourly);
+    ++result.evaluations;
+    auto total = 0.0;
+    for (const auto& iteration : result.history) {
+      total += iteration.seconds;
+    }
+    result.secondsPerIteration = result.history.empty() ? 0.0 : total / result.history.size();
+  } else {
+    throw std::invalid_argument("Unknown calibration method '" + spec.method + "'");
+  }
+
+  result.wallSeconds = seconds(start);
+  return result;
+}
+
+} // isomodel
+} // openstudio
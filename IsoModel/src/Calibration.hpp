@@ -0,0 +1,177 @@
+#ifndef ISOMODEL_CALIBRATION_HPP
+#define ISOMODEL_CALIBRATION_HPP
+
+#include "Cancellation.hpp"
+#include "ISOModelAPI.hpp"
+#include "ParametricSweep.hpp"
+#include "Properties.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace openstudio {
+namespace isomodel {
+
+/**
+ * What a calibration fits and to what. Read from a file of key = value lines
+ * (the .ism format):
+ *
+ * electricity = 12 monthly values<br>
+ * gas = 12 monthly values<br>
+ * units = kwh<br>
+ * method = neldermead<br>
+ * coolingsystemcop = 2.5, 4<br>
+ * lightingpowerdensityoccupied = 5, 15
+ *
+ * electricity and gas are the metered use of each fuel, January first; either
+ * may be left out. units is "kwh/m2" (the default, the model's own units) or
+ * "kwh", which compares against the simulated use times the building's
+ * floorArea. method is "neldermead" or "mcmc". The keys engine ("monthly" or
+ * "hourly"), refine ("hourly" to polish a monthly Nelder-Mead fit with the
+ * hourly model), iterations, refineiterations, tolerance, step, chains,
+ * noise, seed and threads configure the methods as described below. Every
+ * other key names a scalar .ism property to fit and its range "low, high".
+ */
+struct ISOMODEL_API CalibrationSpec
+{
+  std::string method = "neldermead";
+  bool hourly = false; // Fit with the hourly model instead of the monthly one.
+  bool refineHourly = false; // After a monthly Nelder-Mead fit, continue it with the hourly model.
+  std::size_t iterations = 200; // Nelder-Mead iterations, or MCMC steps per chain.
+  std::size_t refineIterations = 50; // Nelder-Mead iterations of the hourly refinement.
+  double tolerance = 1e-8; // Nelder-Mead stops when the objectives of the simplex are this close.
+  double step = 0.2; // Initial simplex size or MCMC proposal size, as a fraction of each range.
+  std::size_t chains = 4; // MCMC chains.
+  double noise = 0.05; // MCMC measurement error, as a fraction of each fuel's mean monthly use.
+  std::uint64_t seed = 0; // For the MCMC starting points and proposals.
+  std::size_t threads = 0; // Worker threads, or 0 for one per hardware thread.
+  bool perArea = true; // The measured data is in kWh/m2 rather than kWh.
+  std::vector<double> electricity; // 12 measured values, or empty.
+  std::vector<double> gas; // 12 measured values, or empty.
+  std::vector<std::string> properties;
+  std::vector<double> low;
+  std::vector<double> high;
+  // Cancel to stop after the Nelder-Mead iteration or MCMC steps in
+  // progress. Hourly candidates stop within a simulated day.
+  CancellationToken cancellation;
+
+  /** Reads a spec from a file. Throws std::invalid_argument if it is malformed. */
+  static CalibrationSpec read(const std::string& path);
+
+  /** Reads a spec from parsed properties. Throws std::invalid_argument if it is malformed. */
+  static CalibrationSpec read(const Properties& props);
+};
+
+/**
+ * ASHRAE Guideline 14 goodness of fit of simulated to measured monthly use:
+ * the coefficient of variation of the root mean square error and the
+ * normalized mean bias error of each fuel, as fractions. The objective that
+ * calibration minimizes is the sum of their squares over the fuels that were
+ * measured.
+ */
+struct ISOMODEL_API FitStatistics
+{
+  double electricityCvRmse = 0;
+  double electricityNmbe = 0;
+  double gasCvRmse = 0;
+  double gasNmbe = 0;
+  double objective = 0;
+
+  /**
+   * Compares simulated to measured use. A fuel whose measured data is empty
+   * or sums to zero is left out.
+   */
+  static FitStatistics compute(const std::vector<double>& measuredElectricity, const std::vector<double>& measuredGas,
+                               const std::vector<double>& simulatedElectricity, const std::vector<double>& simulatedGas);
+};
+
+// Progress of one Nelder-Mead iteration.
+struct CalibrationIteration
+{
+  std::size_t iteration = 0;
+  bool hourly = false;
+  double objective = 0; // The best objective so far.
+  double simplexSize = 0; // The largest distance of a vertex from the best, as a fraction of the ranges.
+  double seconds = 0; // Wall time of the iteration.
+};
+
+// The outcome of a calibration.
+struct ISOMODEL_API CalibrationResult
+{
+  std::string method;
+  std::vector<std::string> properties;
+  std::vector<double> values; // The best fit found.
+  FitStatistics fit; // Of the best fit.
+  bool converged = false;
+  bool cancelled = false; // The run was cancelled, so the fit is the best found before then.
+  std::size_t evaluations = 0;
+  double wallSeconds = 0;
+  double secondsPerIteration = 0;
+  std::vector<CalibrationIteration> history; // Nelder-Mead only.
+
+  // MCMC only, from the second half of each chain.
+  std::vector<double> posteriorMean;
+  std::vector<double> posteriorStdDev;
+  std::vector<double> rHat; // Gelman-Rubin potential scale reduction, by property.
+  std::vector<double> acceptanceRates; // By chain.
+
+  /** Writes a CSV report: the summary, the fitted values and the convergence history. */
+  void write(std::ostream& out) const;
+};
+
+/**
+ * Fits properties of a building to metered monthly energy use. Candidates
+ * are built as variants of the base building (see ParametricSweep).
+ *
+ * The "neldermead" method minimizes FitStatistics::objective within the
+ * property ranges with a Nelder-Mead simplex that evaluates its candidates
+ * concurrently: the vertices of the starting and shrunk simplices, and the
+ * reflection, expansion and both contractions of each iteration, which are
+ * all computed before deciding which one to take. It starts from the base
+ * building's values, where they are within range.
+ *
+ * The "mcmc" method samples the posterior of the properties, with uniform
+ * priors over their ranges and independent normal measurement errors, with
+ * parallel random walk Metropolis chains started at random points. It
+ * reports posterior means and standard deviations, the Gelman-Rubin
+ * statistic and acceptance rates, and takes the most probable sample as the
+ * best fit. The chains use counter-based random streams, so a seed gives the
+ * same result for any number of threads.
+ *
+ * If spec.cancellation is cancelled, Nelder-Mead stops after the iteration in
+ * progress and the chains after their current step. The result describes
+ * what ran until then, and is never marked converged.
+ */
+class ISOMODEL_API Calibration
+{
+public:
+  explicit Calibration(const std::string& baseIsmPath, const std::string& defaultsPath = std::string());
+
+  CalibrationResult run(const CalibrationSpec& spec) const;
+
+  /** Simulates the base building with the spec's properties set to values and compares it to the measured data. */
+  FitStatistics evaluate(const CalibrationSpec& spec, const std::vector<double>& values, bool hourly) const;
+
+  /** Sums monthly results into electricity and gas use. */
+  static void fuelTotals(const std::vector<EndUses>& months, std::vector<double>& electricity, std::vector<double>& gas);
+
+private:
+  std::vector<double> startingPoint(const CalibrationSpec& spec) const;
+  FitStatistics evaluate(const CalibrationSpec& spec,
+                         const std::vector<double>& values,
+                         bool hourly,
+                         const CancellationToken* cancellation) const;
+  void nelderMead(const CalibrationSpec& spec, bool hourly, std::size_t iterations, double step, std::vector<double>& point,
+                  CalibrationResult& result) const;
+  void metropolis(const CalibrationSpec& spec, CalibrationResult& result) const;
+
+  ParametricSweep m_sweep;
+  Properties m_base;
+};
+
+} // isomodel
+} // openstudio
+#endif // ISOMODEL_CALIBRATION_HPP
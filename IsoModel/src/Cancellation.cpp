@@ -0,0 +1,70 @@
+#include "Cancellation.hpp"
+
+#include <chrono>
+#include <limits>
+#include <string>
+
+namespace openstudio {
+namespace isomodel {
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+std::string cancelledMessage(std::size_t completed, std::size_t total)
+{
+  if (completed == 0) {
+    return "Cancelled before starting";
+  }
+  return "Cancelled after " + std::to_string(completed) + " of " + std::to_string(total) + " hours";
+}
+
+} // namespace
+
+SimulationCancelled::SimulationCancelled(std::size_t completed, std::size_t total)
+  : std::runtime_error(cancelledMessage(completed, total)), m_completed(completed), m_total(total)
+{
+}
+
+CancellationToken::State::State() : cancelled(false), deadline(std::numeric_limits<long long>::max())
+{
+}
+
+CancellationToken::CancellationToken() : m_state(std::make_shared<State>())
+{
+}
+
+void CancellationToken::cancel() const
+{
+  m_state->cancelled.store(true, std::memory_order_relaxed);
+}
+
+void CancellationToken::cancelAfter(double seconds) const
+{
+  auto deadline = Clock::now() + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds));
+  m_state->deadline.store(deadline.time_since_epoch().count(), std::memory_order_relaxed);
+}
+
+bool CancellationToken::cancelled() const
+{
+  if (m_state->cancelled.load(std::memory_order_relaxed)) {
+    return true;
+  }
+  auto deadline = m_state->deadline.load(std::memory_order_relaxed);
+  if (deadline == std::numeric_limits<long long>::max() || Clock::now().time_since_epoch().count() < deadline) {
+    return false;
+  }
+  // Later polls needn't read the clock.
+  m_state->cancelled.store(true, std::memory_order_relaxed);
+  return true;
+}
+
+void CancellationToken::throwIfCancelled(std::size_t completed, std::size_t total) const
+{
+  if (cancelled()) {
+    throw SimulationCancelled(completed, total);
+  }
+}
+
+} // isomodel
+} // openstudio
@@ -0,0 +1,77 @@
+#ifndef ISOMODEL_CANCELLATION_HPP
+#define ISOMODEL_CANCELLATION_HPP
+
+#include "ISOModelAPI.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+
+namespace openstudio {
+namespace isomodel {
+
+/**
+ * Thrown when a run notices its CancellationToken has been cancelled. Carries
+ * how far the run got: completed of total hours, or 0 of 0 for a run that
+ * was cancelled before it started.
+ */
+class ISOMODEL_API SimulationCancelled : public std::runtime_error
+{
+public:
+  SimulationCancelled(std::size_t completed = 0, std::size_t total = 0);
+
+  std::size_t completed() const {
+    return m_completed;
+  }
+
+  std::size_t total() const {
+    return m_total;
+  }
+
+private:
+  std::size_t m_completed;
+  std::size_t m_total;
+};
+
+/**
+ * Asks long runs to stop early. Copies share their state, so a token handed
+ * to a run can be cancelled from another thread (or a signal handler) through
+ * any copy. A token is also cancelled once its deadline, if it has one,
+ * passes. Runs poll cancelled() at points where stopping is cheap and then
+ * throw SimulationCancelled, so cancellation takes effect within one polling
+ * interval rather than at once.
+ */
+class ISOMODEL_API CancellationToken
+{
+public:
+  CancellationToken();
+
+  /** Cancels the token and its copies. Lock-free, so safe in a signal handler. */
+  void cancel() const;
+
+  /** Cancels the token seconds from now, replacing any earlier deadline. */
+  void cancelAfter(double seconds) const;
+
+  /** Whether cancel() has been called or the deadline has passed. */
+  bool cancelled() const;
+
+  /** Throws SimulationCancelled(completed, total) if the token is cancelled. */
+  void throwIfCancelled(std::size_t completed = 0, std::size_t total = 0) const;
+
+private:
+  struct State
+  {
+    std::atomic<bool> cancelled;
+    // steady_clock ticks, or the largest value for no deadline.
+    std::atomic<long long> deadline;
+
+    State();
+  };
+
+  std::shared_ptr<State> m_state;
+};
+
+} // isomodel
+} // openstudio
+#endif // ISOMODEL_CANCELLATION_HPP
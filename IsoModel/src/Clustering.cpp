@@ -0,0 +1,130 @@
+#include "Clustering.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+
+namespace openstudio {
+namespace isomodel {
+
+std::vector<std::size_t> kMedoids(const std::vector<std::vector<double> >& points, std::size_t k, std::vector<std::size_t>* assignment)
+{
+  auto n = points.size();
+  if (k == 0 || k > n) {
+    throw std::invalid_argument("The number of clusters must be between 1 and the number of points");
+  }
+  auto dimensions = points[0].size();
+  for (const auto& point : points) {
+    if (point.size() != dimensions) {
+      throw std::invalid_argument("The points must all have the same number of coordinates");
+    }
+  }
+
+  std::vector<double> distance(n * n, 0.0);
+  for (std::size_t i = 0; i < n; ++i) {
+    for (std::size_t j = i + 1; j < n; ++j) {
+      auto sum = 0.0;
+      for (std::size_t d = 0; d < dimensions; ++d) {
+        auto difference = points[i][d] - points[j][d];
+        sum += difference * difference;
+      }
+      distance[i * n + j] = sum;
+      distance[j * n + i] = sum;
+    }
+  }
+  auto cost = [&](std::size_t i, std::size_t j) { return distance[i * n + j]; };
+
+  // BUILD: start from the most central point, then add the point that most
+  // reduces the total distance to the nearest medoid, k - 1 times.
+  std::vector<std::size_t> medoids;
+  std::vector<bool> isMedoid(n, false);
+  std::vector<double> nearest(n, std::numeric_limits<double>::infinity());
+  while (medoids.size() < k) {
+    auto best = n;
+    auto bestGain = -std::numeric_limits<double>::infinity();
+    for (std::size_t i = 0; i < n; ++i) {
+      if (isMedoid[i]) {
+        continue;
+      }
+      auto gain = 0.0;
+      for (std::size_t j = 0; j < n; ++j) {
+        // With no medoids yet, the gain is minus the point's total distance.
+        gain += medoids.empty() ? -cost(i, j) : std::max(nearest[j] - cost(i, j), 0.0);
+      }
+      if (gain > bestGain) {
+        best = i;
+        bestGain = gain;
+      }
+    }
+    medoids.push_back(best);
+    isMedoid[best] = true;
+    for (std::size_t j = 0; j < n; ++j) {
+      nearest[j] = std::min(nearest[j], cost(best, j));
+    }
+  }
+
+  // Alternate assigning the points and recentering the clusters.
+  std::vector<std::size_t> cluster(n);
+  for (auto iteration = 0; iteration < 100; ++iteration) {
+    for (std::size_t j = 0; j < n; ++j) {
+      auto best = 0;
+      for (std::size_t c = 0; c < k; ++c) {
+        if (medoids[c] == j) {
+          // A medoid stays in its own cluster even if it has a duplicate.
+          best = static_cast<int>(c);
+          break;
+        }
+        if (cost(medoids[c], j) < cost(medoids[best], j)) {
+          best = static_cast<int>(c);
+        }
+      }
+      cluster[j] = best;
+    }
+
+    std::vector<std::vector<std::size_t> > members(k);
+    for (std::size_t j = 0; j < n; ++j) {
+      members[cluster[j]].push_back(j);
+    }
+    auto changed = false;
+    for (std::size_t c = 0; c < k; ++c) {
+      auto best = medoids[c];
+      auto bestCost = std::numeric_limits<double>::infinity();
+      for (auto i : members[c]) {
+        auto total = 0.0;
+        for (auto j : members[c]) {
+          total += cost(i, j);
+        }
+        if (total < bestCost) {
+          best = i;
+          bestCost = total;
+        }
+      }
+      changed = changed || best != medoids[c];
+      medoids[c] = best;
+    }
+    if (!changed) {
+      break;
+    }
+  }
+
+  // Number the clusters in the order of their medoids.
+  std::vector<std::size_t> order(k);
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) { return medoids[a] < medoids[b]; });
+  std::vector<std::size_t> sorted(k), rank(k);
+  for (std::size_t c = 0; c < k; ++c) {
+    sorted[c] = medoids[order[c]];
+    rank[order[c]] = c;
+  }
+  if (assignment) {
+    assignment->resize(n);
+    for (std::size_t j = 0; j < n; ++j) {
+      (*assignment)[j] = rank[cluster[j]];
+    }
+  }
+  return sorted;
+}
+
+} // isomodel
+} // openstudio
@@ -0,0 +1,29 @@
+#ifndef ISOMODEL_CLUSTERING_HPP
+#define ISOMODEL_CLUSTERING_HPP
+
+#include "ISOModelAPI.hpp"
+
+#include <cstddef>
+#include <vector>
+
+namespace openstudio {
+namespace isomodel {
+
+/**
+ * Partitions points, which must all have the same number of coordinates, into
+ * k clusters around medoids: members of the clusters that minimize the sum of
+ * the squared Euclidean distances to the other members. The medoids are
+ * chosen greedily (the BUILD step of PAM) and then improved by alternately
+ * assigning each point to its nearest medoid and moving each medoid to the
+ * best member of its cluster, until nothing changes. The result is
+ * deterministic. Returns the indices of the medoids in increasing order and,
+ * if assignment is given, the index into them of each point's medoid. Throws
+ * std::invalid_argument unless 0 < k <= points.size().
+ */
+ISOMODEL_API std::vector<std::size_t> kMedoids(const std::vector<std::vector<double> >& points,
+                                               std::size_t k,
+                                               std::vector<std::size_t>* assignment = nullptr);
+
+} // isomodel
+} // openstudio
+#endif // ISOMODEL_CLUSTERING_HPP
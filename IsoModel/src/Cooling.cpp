@@ -3,13 +3,7 @@
 namespace openstudio {
 namespace isomodel {
 
-Cooling::Cooling(void)
-{
-}
-
-Cooling::~Cooling(void)
-{
-}
+template class ISOMODEL_API BasicCooling<double>;
 
 } // isomodel
 } // openstudio
@@ -20,67 +20,90 @@
 #define ISOMODEL_COOLING_HPP
 
 #include "ISOModelAPI.hpp"
+#include "Dual.hpp"
 
 namespace openstudio {
 namespace isomodel {
-class ISOMODEL_API Cooling
+template<typename T>
+class BasicCooling
 {
 public:
-  Cooling(void);
-  ~Cooling(void);
+  BasicCooling() {}
+
+  /** Converts the parameters from another scalar type. */
+  template<typename U>
+  explicit BasicCooling(const BasicCooling<U>& other) :
+      m_temperatureSetPointOccupied(other.m_temperatureSetPointOccupied),
+      m_temperatureSetPointUnoccupied(other.m_temperatureSetPointUnoccupied),
+      m_cop(other.m_cop),
+      m_partialLoadValue(other.m_partialLoadValue),
+      m_hvacLossFactor(other.m_hvacLossFactor),
+      m_pumpControlReduction(other.m_pumpControlReduction),
+      m_forcedAirCooling(other.m_forcedAirCooling),
+      m_T_cl_ctrl_flag(other.m_T_cl_ctrl_flag),
+      m_dT_supp_cl(other.m_dT_supp_cl),
+      m_DC_YesNo(other.m_DC_YesNo),
+      m_eta_DC_network(other.m_eta_DC_network),
+      m_eta_DC_COP(other.m_eta_DC_COP),
+      m_eta_DC_frac_abs(other.m_eta_DC_frac_abs),
+      m_eta_DC_COP_abs(other.m_eta_DC_COP_abs),
+      m_frac_DC_free(other.m_frac_DC_free),
+      m_E_pumps(other.m_E_pumps)
+  {
+  }
 
   /**
   * Cooling setpoint occupied (C).
   */
-  double temperatureSetPointOccupied() const {
+  T temperatureSetPointOccupied() const {
     return m_temperatureSetPointOccupied;
   }
   
-  void setTemperatureSetPointOccupied(double value) {
+  void setTemperatureSetPointOccupied(T value) {
     m_temperatureSetPointOccupied = value;
   }
 
   /**
   * Cooling setpoint unoccupied (C).
   */
-  double temperatureSetPointUnoccupied() const {
+  T temperatureSetPointUnoccupied() const {
     return m_temperatureSetPointUnoccupied;
   }
 
-  void setTemperatureSetPointUnoccupied(double value) {
+  void setTemperatureSetPointUnoccupied(T value) {
     m_temperatureSetPointUnoccupied = value;
   }
 
   /**
   * Coefficient of performance (W/W).
   */
-  double cop() const {
+  T cop() const {
     return m_cop;
   }
 
-  void setCop(double value) {
+  void setCop(T value) {
     m_cop = value;
   }
 
   /**
   * Cooling system IPLV (integrated part load value) to COP ratio (unitless).
   */
-  double partialLoadValue() const {
+  T partialLoadValue() const {
     return m_partialLoadValue;
   }
   
-  void setPartialLoadValue(double value) {
+  void setPartialLoadValue(T value) {
     m_partialLoadValue = value;
   }
 
   /**
   * Cooling HVAC loss factor, set based on EN 15243 (unitless).
   */
-  double hvacLossFactor() const {
+  T hvacLossFactor() const {
     return m_hvacLossFactor;
   }
 
-  void setHvacLossFactor(double value) {
+  void setHvacLossFactor(T value) {
     m_hvacLossFactor = value;
   }
 
@@ -88,11 +111,11 @@ public:
   * Cooling pump control reduction (pump control 0 = no pump, 0.5 = auto pump controls 
   * for more 50% of pumps, 1.0 = all other cases). See NEN 2914 9.4.3.
   */
-  double pumpControlReduction() const {
+  T pumpControlReduction() const {
     return m_pumpControlReduction;
   }
 
-  void setPumpControlReduction(double value) {
+  void setPumpControlReduction(T value) {
     m_pumpControlReduction = value;
   }
 
@@ -112,122 +135,128 @@ public:
   * Flag to signify if we have cooling and controls turned on or off. 
   * E.g., might be off for school in summer.
   */
-  double T_cl_ctrl_flag() const {
+  T T_cl_ctrl_flag() const {
     return m_T_cl_ctrl_flag;
   }
 
-  void setT_cl_ctrl_flag(double T_cl_ctrl_flag) {
+  void setT_cl_ctrl_flag(T T_cl_ctrl_flag) {
     m_T_cl_ctrl_flag = T_cl_ctrl_flag;
   }
 
   /**
   * Cooling temperature difference between room air and supply air (C).
   */
-  double dT_supp_cl() const {
+  T dT_supp_cl() const {
     return m_dT_supp_cl;
   }
 
-  void setDT_supp_cl(double dT_supp_cl) {
+  void setDT_supp_cl(T dT_supp_cl) {
     m_dT_supp_cl = dT_supp_cl;
   }
 
   /**
   * Building connected to district cooling (DC) (0=no, 1=yes).
   */
-  double DC_YesNo() const {
+  T DC_YesNo() const {
     return m_DC_YesNo;
   }
 
-  void setDC_YesNo(double DC_YesNo) {
+  void setDC_YesNo(T DC_YesNo) {
     m_DC_YesNo = DC_YesNo;
   }
 
   /**
   * Efficiency of DC network. Typical value 0l75-0l9 EN 15316-4-5
   */
-  double eta_DC_network() const {
+  T eta_DC_network() const {
     return m_eta_DC_network;
   }
 
-  void setEta_DC_network(double eta_DC_network) {
+  void setEta_DC_network(T eta_DC_network) {
     m_eta_DC_network = eta_DC_network;
   }
 
   /**
   * COP of DC electric chillers.
   */
-  double eta_DC_COP() const {
+  T eta_DC_COP() const {
     return m_eta_DC_COP;
   }
 
-  void setEta_DC_COP(double eta_DC_COP) {
+  void setEta_DC_COP(T eta_DC_COP) {
     m_eta_DC_COP = eta_DC_COP;
   }
 
   /**
   * Fraction of DC chillers that are absorption.
   */
-  double eta_DC_frac_abs() const {
+  T eta_DC_frac_abs() const {
     return m_eta_DC_frac_abs;
   }
 
-  void setEta_DC_frac_abs(double eta_DC_frac_abs) {
+  void setEta_DC_frac_abs(T eta_DC_frac_abs) {
     m_eta_DC_frac_abs = eta_DC_frac_abs;
   }
 
   /**
   * COP of DC absorption chillers.
   */
-  double eta_DC_COP_abs() const {
+  T eta_DC_COP_abs() const {
     return m_eta_DC_COP_abs;
   }
 
-  void setEta_DC_COP_abs(double eta_DC_COP_abs) {
+  void setEta_DC_COP_abs(T eta_DC_COP_abs) {
     m_eta_DC_COP_abs = eta_DC_COP_abs;
   }
 
   /**
   * Fraction of free heat source to absorption DC chillers (0 to 1).
   */
-  double frac_DC_free() const {
+  T frac_DC_free() const {
     return m_frac_DC_free;
   }
 
-  void setFrac_DC_free(double frac_DC_free) {
+  void setFrac_DC_free(T frac_DC_free) {
     m_frac_DC_free = frac_DC_free;
   }
 
   /**
   * Specific power of systems pumps and control systems (W/m2).
   */
-  double E_pumps() const {
+  T E_pumps() const {
     return m_E_pumps;
   }
 
-  void setE_pumps(double E_pumps) {
+  void setE_pumps(T E_pumps) {
     m_E_pumps = E_pumps;
   }
 
 private:
-  double m_temperatureSetPointOccupied;
-  double m_temperatureSetPointUnoccupied;
-  double m_cop;
-  double m_partialLoadValue;
-  double m_hvacLossFactor;
-  double m_pumpControlReduction;
+  template<typename>
+  friend class BasicCooling;
+
+  T m_temperatureSetPointOccupied;
+  T m_temperatureSetPointUnoccupied;
+  T m_cop;
+  T m_partialLoadValue;
+  T m_hvacLossFactor;
+  T m_pumpControlReduction;
   // Members with default values:
   bool m_forcedAirCooling = true;
-  double m_T_cl_ctrl_flag = 1;
-  double m_dT_supp_cl = 7.0;
-  double m_DC_YesNo = 0;
-  double m_eta_DC_network = 0.9;
-  double m_eta_DC_COP = 5.5;
-  double m_eta_DC_frac_abs = 0;
-  double m_eta_DC_COP_abs = 1;
-  double m_frac_DC_free = 0;
-  double m_E_pumps = 0.25;
+  T m_T_cl_ctrl_flag = 1;
+  T m_dT_supp_cl = 7.0;
+  T m_DC_YesNo = 0;
+  T m_eta_DC_network = 0.9;
+  T m_eta_DC_COP = 5.5;
+  T m_eta_DC_frac_abs = 0;
+  T m_eta_DC_COP_abs = 1;
+  T m_frac_DC_free = 0;
+  T m_E_pumps = 0.25;
 };
 
+extern template class ISOMODEL_API BasicCooling<double>;
+typedef BasicCooling<double> Cooling;
+
 } // isomodel
 } // openstudio
 #endif // ISOMODEL_COOLING_HPP
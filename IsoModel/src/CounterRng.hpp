@@ -0,0 +1,57 @@
+#ifndef ISOMODEL_COUNTER_RNG_HPP
+#define ISOMODEL_COUNTER_RNG_HPP
+
+#include <array>
+#include <cstdint>
+
+namespace openstudio {
+namespace isomodel {
+
+/**
+ * A counter-based random number generator (Philox4x32-10, Salmon et al.,
+ * "Parallel random numbers: as easy as 1, 2, 3", SC11). The numbers are a
+ * pure function of the seed, a stream number and a position in the stream,
+ * so there is no generator state to share between threads or to advance in
+ * order: any thread can draw number i of stream s directly and always gets
+ * the same value.
+ */
+class CounterRng
+{
+public:
+  explicit CounterRng(std::uint64_t seed) : m_key { { static_cast<std::uint32_t>(seed), static_cast<std::uint32_t>(seed >> 32) } }
+  {
+  }
+
+  /** Returns the four 32-bit words of block counter of stream. */
+  std::array<std::uint32_t, 4> block(std::uint64_t stream, std::uint64_t counter) const
+  {
+    std::array<std::uint32_t, 4> x = { { static_cast<std::uint32_t>(counter), static_cast<std::uint32_t>(counter >> 32),
+                                         static_cast<std::uint32_t>(stream), static_cast<std::uint32_t>(stream >> 32) } };
+    auto key = m_key;
+    for (int round = 0; round < 10; ++round) {
+      auto product0 = static_cast<std::uint64_t>(0xD2511F53u) * x[0];
+      auto product1 = static_cast<std::uint64_t>(0xCD9E8D57u) * x[2];
+      x = { { static_cast<std::uint32_t>(product1 >> 32) ^ x[1] ^ key[0], static_cast<std::uint32_t>(product1),
+              static_cast<std::uint32_t>(product0 >> 32) ^ x[3] ^ key[1], static_cast<std::uint32_t>(product0) } };
+      key[0] += 0x9E3779B9u;
+      key[1] += 0xBB67AE85u;
+    }
+    return x;
+  }
+
+  /** Returns number index of stream, uniform in the open interval (0, 1) with 53 random bits. */
+  double uniform(std::uint64_t stream, std::uint64_t index) const
+  {
+    auto words = block(stream, index / 2);
+    auto high = words[2 * (index % 2)] >> 5;
+    auto low = words[2 * (index % 2) + 1] >> 6;
+    return (high * 67108864.0 + low + 0.5) / 9007199254740992.0;
+  }
+
+private:
+  std::array<std::uint32_t, 2> m_key;
+};
+
+} // isomodel
+} // openstudio
+#endif // ISOMODEL_COUNTER_RNG_HPP
@@ -0,0 +1,182 @@
+#include "DesignOfExperiments.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+
+namespace openstudio {
+namespace isomodel {
+
+std::vector<std::vector<double> > fullFactorial(const std::vector<std::vector<double> >& levels)
+{
+  std::size_t points = levels.empty() ? 0 : 1;
+  for (const auto& dimension : levels) {
+    points *= dimension.size();
+  }
+
+  std::vector<std::vector<double> > design(points, std::vector<double>(levels.size()));
+  for (std::size_t i = 0; i < points; ++i) {
+    // Read the point's index as a mixed radix number, last dimension lowest.
+    auto rest = i;
+    for (std::size_t d = levels.size(); d-- > 0;) {
+      design[i][d] = levels[d][rest % levels[d].size()];
+      rest /= levels[d].size();
+    }
+  }
+  return design;
+}
+
+std::vector<std::vector<double> > latinHypercube(std::size_t samples, std::size_t dimensions, unsigned seed)
+{
+  std::mt19937 generator(seed);
+  std::uniform_real_distribution<double> uniform(0.0, 1.0);
+
+  std::vector<std::vector<double> > design(samples, std::vector<double>(dimensions));
+  std::vector<std::size_t> strata(samples);
+  for (std::size_t d = 0; d < dimensions; ++d) {
+    std::iota(strata.begin(), strata.end(), 0);
+    std::shuffle(strata.begin(), strata.end(), generator);
+    for (std::size_t i = 0; i < samples; ++i) {
+      design[i][d] = (strata[i] + uniform(generator)) / samples;
+    }
+  }
+  return design;
+}
+
+namespace {
+
+double radicalInverse(std::size_t index, unsigned base)
+{
+  auto result = 0.0;
+  auto digitValue = 1.0 / base;
+  for (; index > 0; index /= base, digitValue /= base) {
+    result += (index % base) * digitValue;
+  }
+  return result;
+}
+
+std::vector<unsigned> firstPrimes(std::size_t count)
+{
+  std::vector<unsigned> primes;
+  for (unsigned candidate = 2; primes.size() < count; ++candidate) {
+    auto isPrime = std::none_of(primes.begin(), primes.end(), [candidate](unsigned p) { return candidate % p == 0; });
+    if (isPrime) {
+      primes.push_back(candidate);
+    }
+  }
+  return primes;
+}
+
+// Joe and Kuo's direction numbers (new-joe-kuo-6.21201) for dimensions 2 and
+// up: the degree s and coefficients a of a primitive polynomial, and the
+// initial direction numbers m_1..m_s. Dimension 1 is the van der Corput
+// sequence.
+struct SobolPolynomial
+{
+  unsigned s;
+  unsigned a;
+  unsigned m[7];
+};
+
+const SobolPolynomial sobolPolynomials[] = {
+  { 1, 0, { 1 } },
+  { 2, 1, { 1, 3 } },
+  { 3, 1, { 1, 3, 1 } },
+  { 3, 2, { 1, 1, 1 } },
+  { 4, 1, { 1, 1, 3, 3 } },
+  { 4, 4, { 1, 3, 5, 13 } },
+  { 5, 2, { 1, 1, 5, 5, 17 } },
+  { 5, 4, { 1, 1, 5, 5, 5 } },
+  { 5, 7, { 1, 1, 7, 11, 19 } },
+  { 5, 11, { 1, 1, 5, 1, 1 } },
+  { 5, 13, { 1, 1, 1, 3, 11 } },
+  { 5, 14, { 1, 3, 5, 5, 31 } },
+  { 6, 1, { 1, 3, 3, 9, 7, 49 } },
+  { 6, 13, { 1, 1, 1, 15, 21, 21 } },
+  { 6, 16, { 1, 3, 1, 13, 27, 49 } },
+  { 6, 19, { 1, 1, 1, 15, 7, 5 } },
+  { 6, 22, { 1, 3, 1, 15, 13, 25 } },
+  { 6, 25, { 1, 1, 5, 5, 19, 61 } },
+  { 7, 1, { 1, 3, 7, 11, 23, 15, 103 } },
+  { 7, 4, { 1, 3, 7, 13, 13, 15, 69 } },
+};
+
+const unsigned sobolBits = 32;
+
+// Returns the direction numbers v_1..v_32 of a dimension, scaled by 2^32.
+std::vector<std::uint32_t> sobolDirections(std::size_t dimension)
+{
+  std::vector<std::uint32_t> v(sobolBits);
+  if (dimension == 0) {
+    for (unsigned i = 0; i < sobolBits; ++i) {
+      v[i] = std::uint32_t(1) << (sobolBits - 1 - i);
+    }
+    return v;
+  }
+
+  const auto& poly = sobolPolynomials[dimension - 1];
+  for (unsigned i = 0; i < sobolBits; ++i) {
+    if (i < poly.s) {
+      v[i] = poly.m[i] << (sobolBits - 1 - i);
+    } else {
+      // v_i = a_1 v_{i-1} ^ a_2 v_{i-2} ^ ... ^ v_{i-s} ^ (v_{i-s} >> s)
+      v[i] = v[i - poly.s] ^ (v[i - poly.s] >> poly.s);
+      for (unsigned k = 1; k < poly.s; ++k) {
+        if ((poly.a >> (poly.s - 1 - k)) & 1) {
+          v[i] ^= v[i - k];
+        }
+      }
+    }
+  }
+  return v;
+}
+
+} // namespace
+
+std::vector<std::vector<double> > haltonSequence(std::size_t samples, std::size_t dimensions)
+{
+  auto primes = firstPrimes(dimensions);
+  std::vector<std::vector<double> > design(samples, std::vector<double>(dimensions));
+  for (std::size_t i = 0; i < samples; ++i) {
+    for (std::size_t d = 0; d < dimensions; ++d) {
+      design[i][d] = radicalInverse(i + 1, primes[d]);
+    }
+  }
+  return design;
+}
+
+std::size_t maxSobolDimensions()
+{
+  return sizeof(sobolPolynomials) / sizeof(sobolPolynomials[0]) + 1;
+}
+
+std::vector<std::vector<double> > sobolSequence(std::size_t samples, std::size_t dimensions)
+{
+  if (dimensions > maxSobolDimensions()) {
+    throw std::invalid_argument("Sobol sequences are limited to " + std::to_string(maxSobolDimensions()) + " dimensions");
+  }
+
+  std::vector<std::vector<double> > design(samples, std::vector<double>(dimensions));
+  for (std::size_t d = 0; d < dimensions; ++d) {
+    auto v = sobolDirections(d);
+    // Gray code order: point i differs from point i - 1 by the direction
+    // number of the lowest zero bit of i - 1.
+    std::uint32_t x = 0;
+    for (std::size_t i = 0; i < samples; ++i) {
+      design[i][d] = x / 4294967296.0;
+      unsigned bit = 0;
+      for (auto rest = i; rest & 1; rest >>= 1) {
+        ++bit;
+      }
+      if (bit < sobolBits) {
+        x ^= v[bit];
+      }
+    }
+  }
+  return design;
+}
+
+} // isomodel
+} // openstudio
@@ -0,0 +1,48 @@
+#ifndef ISOMODEL_DESIGN_OF_EXPERIMENTS_HPP
+#define ISOMODEL_DESIGN_OF_EXPERIMENTS_HPP
+
+#include "ISOModelAPI.hpp"
+
+#include <cstddef>
+#include <vector>
+
+namespace openstudio {
+namespace isomodel {
+
+// Generators of design points for parametric sweeps. Each returns one row per
+// point. The sampling designs return points in the unit cube [0, 1)^dimensions,
+// to be scaled to each parameter's range.
+
+/**
+ * Every combination of the given levels, one list of levels per dimension.
+ * The last dimension varies fastest.
+ */
+ISOMODEL_API std::vector<std::vector<double> > fullFactorial(const std::vector<std::vector<double> >& levels);
+
+/**
+ * A Latin hypercube sample: each dimension's range is split into samples
+ * equal strata and each stratum holds exactly one point. The same seed gives
+ * the same design.
+ */
+ISOMODEL_API std::vector<std::vector<double> > latinHypercube(std::size_t samples, std::size_t dimensions, unsigned seed);
+
+/**
+ * The first samples points of the Halton sequence, using the first
+ * dimensions primes as bases. The sequence starts at index 1, skipping the
+ * origin.
+ */
+ISOMODEL_API std::vector<std::vector<double> > haltonSequence(std::size_t samples, std::size_t dimensions);
+
+/**
+ * The first samples points of the Sobol sequence, with Joe and Kuo's
+ * direction numbers. The sequence starts at the origin, so the first 2^k
+ * points put exactly one point in each of 2^k equal intervals of every
+ * dimension. Throws std::invalid_argument for more than maxSobolDimensions().
+ */
+ISOMODEL_API std::vector<std::vector<double> > sobolSequence(std::size_t samples, std::size_t dimensions);
+
+ISOMODEL_API std::size_t maxSobolDimensions();
+
+} // isomodel
+} // openstudio
+#endif // ISOMODEL_DESIGN_OF_EXPERIMENTS_HPP
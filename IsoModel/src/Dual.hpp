@@ -0,0 +1,255 @@
+#ifndef ISOMODEL_DUAL_HPP
+#define ISOMODEL_DUAL_HPP
+
+#ifdef ISOMODEL_STANDALONE
+#include "Vector.hpp"
+#include "Matrix.hpp"
+#else
+#include "../utilities/data/Vector.hpp"
+#include "../utilities/data/Matrix.hpp"
+#endif
+
+#include <cmath>
+#include <cstddef>
+
+namespace openstudio {
+namespace isomodel {
+
+// ublas containers of the scalar type the models are instantiated with.
+template<typename T>
+using BasicVector = boost::numeric::ublas::vector<T>;
+
+template<typename T>
+using BasicMatrix = boost::numeric::ublas::matrix<T>;
+
+/**
+ * A dual number for forward-mode automatic differentiation: a value together
+ * with its partial derivatives with respect to N independent variables.
+ *
+ * The parameter classes, Simulation and the models are templates on their
+ * scalar type. Instantiating them with Dual carries the derivatives of every
+ * intermediate value along with it, so one run gives the results and their
+ * derivatives with respect to up to N seeded parameters (see
+ * UserModel::gradient()).
+ *
+ * Comparisons only look at the value, so the branches the models take are the
+ * ones the plain double run takes. Doubles convert implicitly to constants
+ * (all partials zero). Use scalarValue() to get the double back.
+ */
+template<std::size_t N>
+class Dual
+{
+public:
+  static const std::size_t size = N;
+
+  Dual() : m_value(0.0) {
+    clearPartials();
+  }
+
+  Dual(double value) : m_value(value) {
+    clearPartials();
+  }
+
+  /** Returns an independent variable: value with a partial of 1 at index. */
+  static Dual variable(double value, std::size_t index) {
+    Dual result(value);
+    result.m_partials[index] = 1.0;
+    return result;
+  }
+
+  double value() const {
+    return m_value;
+  }
+
+  double partial(std::size_t index) const {
+    return m_partials[index];
+  }
+
+  Dual& operator+=(const Dual& rhs) {
+    m_value += rhs.m_value;
+    for (std::size_t i = 0; i < N; ++i) {
+      m_partials[i] += rhs.m_partials[i];
+    }
+    return *this;
+  }
+
+  Dual& operator-=(const Dual& rhs) {
+    m_value -= rhs.m_value;
+    for (std::size_t i = 0; i < N; ++i) {
+      m_partials[i] -= rhs.m_partials[i];
+    }
+    return *this;
+  }
+
+  Dual& operator*=(const Dual& rhs) {
+    for (std::size_t i = 0; i < N; ++i) {
+      m_partials[i] = m_partials[i] * rhs.m_value + m_value * rhs.m_partials[i];
+    }
+    m_value *= rhs.m_value;
+    return *this;
+  }
+
+  Dual& operator/=(const Dual& rhs) {
+    m_value /= rhs.m_value;
+    for (std::size_t i = 0; i < N; ++i) {
+      m_partials[i] = (m_partials[i] - m_value * rhs.m_partials[i]) / rhs.m_value;
+    }
+    return *this;
+  }
+
+  friend Dual operator+(const Dual& x) {
+    return x;
+  }
+
+  friend Dual operator-(const Dual& x) {
+    return x.scaled(-x.m_value, -1.0);
+  }
+
+  friend Dual operator+(Dual lhs, const Dual& rhs) {
+    return lhs += rhs;
+  }
+
+  friend Dual operator-(Dual lhs, const Dual& rhs) {
+    return lhs -= rhs;
+  }
+
+  friend Dual operator*(Dual lhs, const Dual& rhs) {
+    return lhs *= rhs;
+  }
+
+  friend Dual operator/(Dual lhs, const Dual& rhs) {
+    return lhs /= rhs;
+  }
+
+  friend bool operator==(const Dual& lhs, const Dual& rhs) {
+    return lhs.m_value == rhs.m_value;
+  }
+
+  friend bool operator!=(const Dual& lhs, const Dual& rhs) {
+    return lhs.m_value != rhs.m_value;
+  }
+
+  friend bool operator<(const Dual& lhs, const Dual& rhs) {
+    return lhs.m_value < rhs.m_value;
+  }
+
+  friend bool operator>(const Dual& lhs, const Dual& rhs) {
+    return lhs.m_value > rhs.m_value;
+  }
+
+  friend bool operator<=(const Dual& lhs, const Dual& rhs) {
+    return lhs.m_value <= rhs.m_value;
+  }
+
+  friend bool operator>=(const Dual& lhs, const Dual& rhs) {
+    return lhs.m_value >= rhs.m_value;
+  }
+
+  // Elementary functions, found by argument dependent lookup. Bring the std
+  // versions into scope (using std::pow etc.) so the same call compiles for
+  // double.
+  friend Dual pow(const Dual& x, double p) {
+    auto value = std::pow(x.m_value, p);
+    return x.scaled(value, x.m_value == 0.0 ? 0.0 : p * value / x.m_value);
+  }
+
+  friend Dual pow(const Dual& x, const Dual& p) {
+    return exp(p * log(x));
+  }
+
+  friend Dual pow(double x, const Dual& p) {
+    auto value = std::pow(x, p.m_value);
+    return p.scaled(value, value * std::log(x));
+  }
+
+  friend Dual exp(const Dual& x) {
+    auto value = std::exp(x.m_value);
+    return x.scaled(value, value);
+  }
+
+  friend Dual log(const Dual& x) {
+    return x.scaled(std::log(x.m_value), 1.0 / x.m_value);
+  }
+
+  friend Dual sqrt(const Dual& x) {
+    auto value = std::sqrt(x.m_value);
+    return x.scaled(value, value == 0.0 ? 0.0 : 0.5 / value);
+  }
+
+  friend Dual fabs(const Dual& x) {
+    return x.m_value < 0.0 ? -x : x;
+  }
+
+  friend Dual abs(const Dual& x) {
+    return fabs(x);
+  }
+
+private:
+  void clearPartials() {
+    for (std::size_t i = 0; i < N; ++i) {
+      m_partials[i] = 0.0;
+    }
+  }
+
+  // Returns f(x) given f(x) and f'(x), by the chain rule.
+  Dual scaled(double value, double derivative) const {
+    Dual result(value);
+    for (std::size_t i = 0; i < N; ++i) {
+      result.m_partials[i] = derivative * m_partials[i];
+    }
+    return result;
+  }
+
+  double m_value;
+  double m_partials[N];
+};
+
+template<std::size_t N>
+const std::size_t Dual<N>::size;
+
+// The dual number UserModel::gradient() runs the models with. The models
+// are explicitly instantiated for it, and each run differentiates the results
+// with respect to up to GradientDual::size parameters.
+typedef Dual<8> GradientDual;
+
+/** Returns the value of a scalar, without any derivatives. */
+inline double scalarValue(double x) {
+  return x;
+}
+
+template<std::size_t N>
+double scalarValue(const Dual<N>& x) {
+  return x.value();
+}
+
+inline const Vector& scalarValues(const Vector& vec) {
+  return vec;
+}
+
+template<std::size_t N>
+Vector scalarValues(const BasicVector<Dual<N> >& vec) {
+  Vector result(vec.size());
+  for (std::size_t i = 0; i < vec.size(); ++i) {
+    result[i] = vec[i].value();
+  }
+  return result;
+}
+
+inline const Matrix& scalarValues(const Matrix& mat) {
+  return mat;
+}
+
+template<std::size_t N>
+Matrix scalarValues(const BasicMatrix<Dual<N> >& mat) {
+  Matrix result(mat.size1(), mat.size2());
+  for (std::size_t i = 0; i < mat.size1(); ++i) {
+    for (std::size_t j = 0; j < mat.size2(); ++j) {
+      result(i, j) = mat(i, j).value();
+    }
+  }
+  return result;
+}
+
+} // isomodel
+} // openstudio
+#endif // ISOMODEL_DUAL_HPP
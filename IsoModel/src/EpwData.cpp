@@ -3,7 +3,7 @@
 namespace openstudio {
 namespace isomodel {
 
-EpwData::EpwData(void)
+EpwData::EpwData(void) : m_timezone(0), m_latitude(0.0), m_longitude(0.0)
 {
   m_data.resize(7);
 }
@@ -114,14 +114,14 @@ std::string EpwData::toISOData()
   return sstream.str();
 }
 
-void EpwData::loadData(int block_size, double* data)
+void EpwData::loadData(int block_size, const double* data)
 {
   // first 3 doubles are latitude, longitude, tz
   m_latitude = data[0];
   m_longitude = data[1];
   m_timezone = (int) data[2];
   // each block_size number of doubles is a column of data
-  double* ptr = data + 3;
+  const double* ptr = data + 3;
   for (int c = 0; c < 7; c++) {
     std::vector<double>& col = m_data[c];
     col.resize(8760);
@@ -130,6 +130,7 @@ void EpwData::loadData(int block_size, double* data)
       ++ptr;
     }
   }
+  hashContents();
 }
 
 void EpwData::loadData(std::string fn)
@@ -154,6 +155,21 @@ void EpwData::loadData(std::string fn)
     }
     myfile.close();
   }
+  hashContents();
+}
+
+void EpwData::hashContents()
+{
+  ModelHasher hasher;
+  hasher.add(m_latitude);
+  hasher.add(m_longitude);
+  hasher.add(static_cast<std::uint64_t>(m_timezone));
+  for (const auto& column : m_data) {
+    for (auto value : column) {
+      hasher.add(value);
+    }
+  }
+  m_contentHash = hasher.digest();
 }
 }
 }
@@ -20,6 +20,7 @@
 #define ISOMODEL_EPW_DATA_HPP
 
 #include "ISOModelAPI.hpp"
+#include "ModelHash.hpp"
 
 #include <iostream>
 #include <fstream>
@@ -52,6 +53,9 @@ protected:
   int m_timezone;
   double m_latitude, m_longitude;
   std::vector<std::vector<double> > m_data;
+  ModelHash m_contentHash;
+
+  void hashContents();
 
 public:
   EpwData(void);
@@ -60,7 +64,7 @@ public:
   // loads data from an array, each block_size
   // number of values are the values for a column
   // (e.g. dry bulb temp, etc.)
-  void loadData(int block_size, double* data);
+  void loadData(int block_size, const double* data);
   void loadData(std::string);
   std::string toISOData();
 
@@ -89,6 +93,14 @@ public:
     return m_data;
   }
 
+  /**
+   * A hash of the loaded position, time zone and hourly data, computed as
+   * they are loaded, which identifies the weather in model hashes.
+   */
+  ModelHash contentHash() const {
+    return m_contentHash;
+  }
+
 };
 
 }
@@ -3,13 +3,7 @@
 namespace openstudio {
 namespace isomodel {
 
-Heating::Heating(void)
-{
-}
-
-Heating::~Heating(void)
-{
-}
+template class ISOMODEL_API BasicHeating<double>;
 
 } // isomodel
 } // openstudio
@@ -20,67 +20,97 @@
 #define ISOMODEL_HEATING_HPP
 
 #include "ISOModelAPI.hpp"
+#include "Dual.hpp"
 
 namespace openstudio {
 namespace isomodel {
-class ISOMODEL_API Heating
+template<typename T>
+class BasicHeating
 {
 public:
-  Heating(void);
-  ~Heating(void);
+  BasicHeating() {}
+
+  /** Converts the parameters from another scalar type. */
+  template<typename U>
+  explicit BasicHeating(const BasicHeating<U>& other) :
+      m_temperatureSetPointOccupied(other.m_temperatureSetPointOccupied),
+      m_temperatureSetPointUnoccupied(other.m_temperatureSetPointUnoccupied),
+      m_hvacLossFactor(other.m_hvacLossFactor),
+      m_efficiency(other.m_efficiency),
+      m_energyType(other.m_energyType),
+      m_pumpControlReduction(other.m_pumpControlReduction),
+      m_hotWaterDemand(other.m_hotWaterDemand),
+      m_hotWaterDistributionEfficiency(other.m_hotWaterDistributionEfficiency),
+      m_hotWaterSystemEfficiency(other.m_hotWaterSystemEfficiency),
+      m_hotWaterEnergyType(other.m_hotWaterEnergyType),
+      m_hotcoldWasteFactor(other.m_hotcoldWasteFactor),
+      m_forcedAirHeating(other.m_forcedAirHeating),
+      m_dT_supp_ht(other.m_dT_supp_ht),
+      m_E_pumps(other.m_E_pumps),
+      m_T_ht_ctrl_flag(other.m_T_ht_ctrl_flag),
+      m_a_H0(other.m_a_H0),
+      m_tau_H0(other.m_tau_H0),
+      m_DH_YesNo(other.m_DH_YesNo),
+      m_eta_DH_network(other.m_eta_DH_network),
+      m_eta_DH_sys(other.m_eta_DH_sys),
+      m_frac_DH_free(other.m_frac_DH_free),
+      m_dhw_tset(other.m_dhw_tset),
+      m_dhw_tsupply(other.m_dhw_tsupply)
+  {
+  }
 
   /**
   * Heating setpoint occupied (C).
   */
-  double temperatureSetPointOccupied() const {
+  T temperatureSetPointOccupied() const {
     return m_temperatureSetPointOccupied;
   }
 
-  void setTemperatureSetPointOccupied(double value) {
+  void setTemperatureSetPointOccupied(T value) {
     m_temperatureSetPointOccupied = value;
   }
 
   /**
   * Heating setpoint unoccupied (C).
   */
-  double temperatureSetPointUnoccupied() const {
+  T temperatureSetPointUnoccupied() const {
     return m_temperatureSetPointUnoccupied;
   }
 
-  void setTemperatureSetPointUnoccupied(double value) {
+  void setTemperatureSetPointUnoccupied(T value) {
     m_temperatureSetPointUnoccupied = value;
   }
 
   /**
   * Heating HVAC loss factor, set based on EN 15243 (unitless).
   */
-  double hvacLossFactor() const {
+  T hvacLossFactor() const {
     return m_hvacLossFactor;
   }
 
-  void setHvacLossFactor(double value) {
+  void setHvacLossFactor(T value) {
     m_hvacLossFactor = value;
   }
 
   /**
   * Heating and cooling HVAC waste factor, set based on EN 15243 (unitless).
   */
-  double hotcoldWasteFactor() const {
+  T hotcoldWasteFactor() const {
     return m_hotcoldWasteFactor;
   }
 
-  void setHotcoldWasteFactor(double value) {
+  void setHotcoldWasteFactor(T value) {
     m_hotcoldWasteFactor = value;
   }
 
   /**
   * Heating system efficiency (unitless).
   */
-  double efficiency() const {
+  T efficiency() const {
     return m_efficiency;
   }
   
-  void setEfficiency(double value) {
+  void setEfficiency(T value) {
     m_efficiency = value;
   }
 
@@ -88,11 +118,11 @@ public:
   * Heating system energy type (electric: energyType() == 1, gas: energyType() != 1).
   * XXX TODO: this probably should be an enum.
   */
-  double energyType() const {
+  T energyType() const {
     return m_energyType;
   }
 
-  void setEnergyType(double value) {
+  void setEnergyType(T value) {
     m_energyType = value;
   }
 
@@ -100,22 +130,22 @@ public:
   * Heating pump control reduction (pump control 0 = no pump, 0.5 = auto pump controls 
   * for more 50% of pumps, 1.0 = all other cases). See NEN 2914 9.4.3.
   */
-  double pumpControlReduction() const {
+  T pumpControlReduction() const {
     return m_pumpControlReduction;
   }
 
-  void setPumpControlReduction(double value) {
+  void setPumpControlReduction(T value) {
     m_pumpControlReduction = value;
   }
 
   /**
   * Domestic hot water demand (m3/yr). Use 10 m3/yr/person as a default for offices.
   */
-  double hotWaterDemand() const {
+  T hotWaterDemand() const {
     return m_hotWaterDemand;
   }
 
-  void setHotWaterDemand(double value) {
+  void setHotWaterDemand(T value) {
     m_hotWaterDemand = value;
   }
 
@@ -123,22 +153,22 @@ public:
   * Domestic hot water distribution efficiency (all taps within 3m = 1, taps more 
   * than 3m = 0.8, circulation or unknown = 0.6, see NEN 2916 12.6). 
   */
-  double hotWaterDistributionEfficiency() const {
+  T hotWaterDistributionEfficiency() const {
     return m_hotWaterDistributionEfficiency;
   }
 
-  void setHotWaterDistributionEfficiency(double value) {
+  void setHotWaterDistributionEfficiency(T value) {
     m_hotWaterDistributionEfficiency = value;
   }
 
   /**
   * Domestic hot water system efficiency.
   */
-  double hotWaterSystemEfficiency() const {
+  T hotWaterSystemEfficiency() const {
     return m_hotWaterSystemEfficiency;
   }
 
-  void setHotWaterSystemEfficiency(double value) {
+  void setHotWaterSystemEfficiency(T value) {
     m_hotWaterSystemEfficiency = value;
   }
 
@@ -146,22 +176,22 @@ public:
   * Domestic hot water system energy type (electric: energyType() == 1, gas: energyType() != 1).
   * XXX TODO: this probably should be an enum.
   */
-  double hotWaterEnergyType() const {
+  T hotWaterEnergyType() const {
     return m_hotWaterEnergyType;
   }
 
-  void setHotWaterEnergyType(double value) {
+  void setHotWaterEnergyType(T value) {
     m_hotWaterEnergyType = value;
   }
 
   /**
   * Heating temperature difference between room air and supply air (C).
   */
-  double dT_supp_ht() const {
+  T dT_supp_ht() const {
     return m_dT_supp_ht;
   }
 
-  void setDT_supp_ht(double dT_supp_ht) {
+  void setDT_supp_ht(T dT_supp_ht) {
     m_dT_supp_ht = dT_supp_ht;
   }
 
@@ -180,11 +210,11 @@ public:
   /**
   * Specific power of systems pumps and control systems (W/m2).
   */
-  double E_pumps() const {
+  T E_pumps() const {
     return m_E_pumps;
   }
 
-  void setE_pumps(double E_pumps) {
+  void setE_pumps(T E_pumps) {
     m_E_pumps = E_pumps;
   }
 
@@ -192,132 +222,138 @@ public:
   * Flag to signify if we have heating and controls turned on or off. 
   * E.g., might be off for school in summer.
   */
-  double T_ht_ctrl_flag() const {
+  T T_ht_ctrl_flag() const {
     return m_T_ht_ctrl_flag;
   }
 
-  void setT_ht_ctrl_flag(double T_ht_ctrl_flag) {
+  void setT_ht_ctrl_flag(T T_ht_ctrl_flag) {
     m_T_ht_ctrl_flag = T_ht_ctrl_flag;
   }
 
   /**
   * Reference dimensionless parameter. (Used to set a_H, the building heating dimensionless constant).
   */
-  double a_H0() const {
+  T a_H0() const {
     return m_a_H0;
   }
 
-  void setA_H0(double a_H0) {
+  void setA_H0(T a_H0) {
     m_a_H0 = a_H0;
   }
 
   /**
   * Reference time constant. (Used to set a_H, the building heating dimensionless constant).
   */
-  double tau_H0() const {
+  T tau_H0() const {
     return m_tau_H0;
   }
 
-  void setTau_H0(double tau_H0) {
+  void setTau_H0(T tau_H0) {
     m_tau_H0 = tau_H0;
   }
 
   /**
   * Building connected to District Heating (DH) (0=no, 1=yes.  Assume DH is powered by natural gas).
   */
-  double DH_YesNo() const {
+  T DH_YesNo() const {
     return m_DH_YesNo;
   }
 
-  void setDH_YesNo(double DH_YesNo) {
+  void setDH_YesNo(T DH_YesNo) {
     m_DH_YesNo = DH_YesNo;
   }
 
   /**
   * Efficiency of DH network. Typical value 0l75-0l9 EN 15316-4-5
   */
-  double eta_DH_network() const {
+  T eta_DH_network() const {
     return m_eta_DH_network;
   }
 
-  void setEta_DH_network(double eta_DH_network) {
+  void setEta_DH_network(T eta_DH_network) {
     m_eta_DH_network = eta_DH_network;
   }
 
   /**
   * Efficiency of DH system.
   */
-  double eta_DH_sys() const {
+  T eta_DH_sys() const {
     return m_eta_DH_sys;
   }
 
-  void setEta_DH_sys(double eta_DH_sys) {
+  void setEta_DH_sys(T eta_DH_sys) {
     m_eta_DH_sys = eta_DH_sys;
   }
 
   /**
   * Fraction of free heat source to DH (0 to 1).
   */
-  double frac_DH_free() const {
+  T frac_DH_free() const {
     return m_frac_DH_free;
   }
 
-  void setFrac_DH_free(double frac_DH_free) {
+  void setFrac_DH_free(T frac_DH_free) {
     m_frac_DH_free = frac_DH_free;
   }
 
   /**
   * Water temp set point (C).
   */
-  double dhw_tset() const {
+  T dhw_tset() const {
     return m_dhw_tset;
   }
 
-  void setDhw_tset(double dhw_tset) {
+  void setDhw_tset(T dhw_tset) {
     m_dhw_tset = dhw_tset;
   }
 
   /**
   * Water initial temp (C).
   */
-  double dhw_tsupply() const {
+  T dhw_tsupply() const {
     return m_dhw_tsupply;
   }
 
-  void setDhw_tsupply(double dhw_tsupply) {
+  void setDhw_tsupply(T dhw_tsupply) {
     m_dhw_tsupply = dhw_tsupply;
   }
 
 private:
-  double m_temperatureSetPointOccupied;
-  double m_temperatureSetPointUnoccupied;
-  double m_hvacLossFactor;
-  double m_efficiency;
-  double m_energyType;
-  double m_pumpControlReduction;
-  double m_hotWaterDemand;
-  double m_hotWaterDistributionEfficiency;
-  double m_hotWaterSystemEfficiency;
-  double m_hotWaterEnergyType;
-  double m_hotcoldWasteFactor;
+  template<typename>
+  friend class BasicHeating;
+
+  T m_temperatureSetPointOccupied;
+  T m_temperatureSetPointUnoccupied;
+  T m_hvacLossFactor;
+  T m_efficiency;
+  T m_energyType;
+  T m_pumpControlReduction;
+  T m_hotWaterDemand;
+  T m_hotWaterDistributionEfficiency;
+  T m_hotWaterSystemEfficiency;
+  T m_hotWaterEnergyType;
+  T m_hotcoldWasteFactor;
   // Members with default values:
   bool m_forcedAirHeating = true;
-  double m_dT_supp_ht = 7.0;
+  T m_dT_supp_ht = 7.0;
   // Pumps:
-  double m_E_pumps = 0.25;
+  T m_E_pumps = 0.25;
   // Interior temp constants.
-  double m_T_ht_ctrl_flag = 1;
-  double m_a_H0 = 1;
-  double m_tau_H0 = 15;
-  double m_DH_YesNo = 0;
-  double m_eta_DH_network = 0.9;
-  double m_eta_DH_sys = 0.87;
-  double m_frac_DH_free = 0.000;
+  T m_T_ht_ctrl_flag = 1;
+  T m_a_H0 = 1;
+  T m_tau_H0 = 15;
+  T m_DH_YesNo = 0;
+  T m_eta_DH_network = 0.9;
+  T m_eta_DH_sys = 0.87;
+  T m_frac_DH_free = 0.000;
   // Heated water constants
-  double m_dhw_tset = 60;
-  double m_dhw_tsupply = 20;
+  T m_dhw_tset = 60;
+  T m_dhw_tsupply = 20;
 };
 
+extern template class ISOMODEL_API BasicHeating<double>;
+typedef BasicHeating<double> Heating;
+
 } // isomodel
 } // openstudio
 #endif // ISOMODEL_HEATING_HPP
@@ -14,73 +14,898 @@
 // SingleBldg.L50).
 
 #include "HourlyModel.hpp"
+#include "Clustering.hpp"
+#include "ThreadPool.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <future>
+#include <numeric>
+#include <stdexcept>
 
 namespace openstudio {
 namespace isomodel {
 
-//TODO This initializer list should be removed and these attributes included in the ism file. -BAA@2014-12-14
-// There are a bunch more similar constants that are initialized in HourlyModel::initialize().
-HourlyModel::HourlyModel() {}
-HourlyModel::~HourlyModel() {}
+namespace {
+// Configuration that is fixed for a whole run, tested by calculateHour() at
+// run time. This is the generic kernel.
+struct RuntimeHourFlags
+{
+  bool heating;
+  bool cooling;
+  bool exteriorLights;
+  bool affine;
+  bool tracing;
+
+  bool forcedAirHeating() const { return heating; }
+  bool forcedAirCooling() const { return cooling; }
+  bool exteriorLighting() const { return exteriorLights; }
+  bool affineSolver() const { return affine; }
+  bool traced() const { return tracing; }
+};
+
+// The same configuration as compile-time constants. calculateHour()
+// instantiated with these has the flag tests folded away. The specialized
+// kernels always use the affine solver.
+template<bool ForcedAirHeating, bool ForcedAirCooling, bool ExteriorLighting>
+struct FixedHourFlags
+{
+  bool forcedAirHeating() const { return ForcedAirHeating; }
+  bool forcedAirCooling() const { return ForcedAirCooling; }
+  bool exteriorLighting() const { return ExteriorLighting; }
+  bool affineSolver() const { return true; }
+  bool traced() const { return false; }
+};
+
+// The state carried from one hour to the next.
+struct ThermalState
+{
+  double TMT1;
+  double tiHeatCool;
+};
 
-std::vector<EndUses> HourlyModel::simulate(bool aggregateByMonth)
+// Replaces the schedule values that overrides sets.
+template<typename Schedules>
+void applyOverrides(const ScheduleOverrides& overrides, Schedules& schedules)
 {
-  populateSchedules();
+  if (overrides.ventilation) {
+    schedules.ventilation = *overrides.ventilation;
+  }
+  if (overrides.exteriorEquipment) {
+    schedules.exteriorEquipment = *overrides.exteriorEquipment;
+  }
+  if (overrides.interiorEquipment) {
+    schedules.interiorEquipment = *overrides.interiorEquipment;
+  }
+  if (overrides.exteriorLighting) {
+    schedules.exteriorLighting = *overrides.exteriorLighting;
+  }
+  if (overrides.interiorLighting) {
+    schedules.interiorLighting = *overrides.interiorLighting;
+  }
+  if (overrides.heatingSetpoint) {
+    schedules.heatingSetpoint = *overrides.heatingSetpoint;
+  }
+  if (overrides.coolingSetpoint) {
+    schedules.coolingSetpoint = *overrides.coolingSetpoint;
+  }
+}
 
-  printMatrix("Cooling Setpoint", (double*) fixedActualCoolingSetpoint, 24, 7);
-  printMatrix("Heating Setpoint", (double*) fixedActualHeatingSetpoint, 24, 7);
-  printMatrix("Exterior Equipment", (double*) fixedExteriorEquipmentSchedule, 24, 7);
-  printMatrix("Exterior Lighting", (double*) fixedExteriorLightingSchedule, 24, 7);
-  printMatrix("Interior Equipment", (double*) fixedInteriorEquipmentSchedule, 24, 7);
-  printMatrix("Interior Lighting", (double*) fixedInteriorLightingSchedule, 24, 7);
-  printMatrix("Ventilation", (double*) fixedVentilationSchedule, 24, 7);
+bool sameOverrides(const ScheduleOverrides& a, const ScheduleOverrides& b)
+{
+  return a.ventilation == b.ventilation && a.exteriorEquipment == b.exteriorEquipment
+         && a.interiorEquipment == b.interiorEquipment && a.exteriorLighting == b.exteriorLighting
+         && a.interiorLighting == b.interiorLighting && a.heatingSetpoint == b.heatingSetpoint
+         && a.coolingSetpoint == b.coolingSetpoint;
+}
+
+// Widens [first, last] to include the hours of overrides that are missing
+// from, or differ in, others.
+void changedOverrideHours(const std::map<int, ScheduleOverrides>& overrides,
+                          const std::map<int, ScheduleOverrides>& others,
+                          int& first,
+                          int& last)
+{
+  for (const auto& hour : overrides) {
+    if (hour.first < 0 || hour.first >= TIMESLICES) {
+      continue;
+    }
+    auto other = others.find(hour.first);
+    if (other == others.end() || !sameOverrides(hour.second, other->second)) {
+      first = std::min(first, hour.first);
+      last = std::max(last, hour.first);
+    }
+  }
+}
+
+// Clusters the days of the year of each day type (dayType, by day of the
+// week) by k-medoids on their temperature and horizontal irradiance profiles
+// and returns each day's medoid. The types share days medoids.
+std::vector<int> clusterDays(const HourlyInputs& inputs, const std::vector<int>& dayType, int dayTypes, int days)
+{
+  const int daysInYear = TIMESLICES / 24;
+  if (days < dayTypes) {
+    throw std::invalid_argument("There must be at least one representative day for each of the " + std::to_string(dayTypes)
+                                + " day types");
+  }
+
+  // Each day's temperature and horizontal irradiance profiles, normalized by
+  // their spread over the year so that they count alike.
+  auto spread = [](const std::vector<double>& values) {
+    auto mean = std::accumulate(values.begin(), values.end(), 0.0) / values.size();
+    auto sum = 0.0;
+    for (auto value : values) {
+      sum += (value - mean) * (value - mean);
+    }
+    auto deviation = std::sqrt(sum / values.size());
+    return deviation > 0.0 ? deviation : 1.0;
+  };
+  std::vector<double> irradiance(TIMESLICES);
+  for (auto i = 0; i < TIMESLICES; ++i) {
+    irradiance[i] = inputs.radiation[i][8];
+  }
+  auto temperatureSpread = spread(inputs.temperature);
+  auto irradianceSpread = spread(irradiance);
+
+  std::vector<std::vector<int> > typeDays(dayTypes);
+  std::vector<std::vector<std::vector<double> > > typeProfiles(dayTypes);
+  for (auto day = 0; day < daysInYear; ++day) {
+    auto type = dayType[inputs.frame.DayOfWeek[day * 24]];
+    std::vector<double> profile(48);
+    for (auto h = 0; h < 24; ++h) {
+      profile[h] = inputs.temperature[day * 24 + h] / temperatureSpread;
+      profile[24 + h] = irradiance[day * 24 + h] / irradianceSpread;
+    }
+    typeDays[type].push_back(day);
+    typeProfiles[type].push_back(profile);
+  }
+
+  // Share out the representative days: one per type, then each of the rest
+  // to the type with the most days per representative.
+  std::vector<int> shares(dayTypes, 1);
+  for (auto extra = days - dayTypes; extra > 0; --extra) {
+    auto best = 0;
+    for (auto type = 1; type < dayTypes; ++type) {
+      if (typeDays[type].size() * shares[best] > typeDays[best].size() * shares[type]) {
+        best = type;
+      }
+    }
+    ++shares[best];
+  }
+
+  std::vector<int> representative(daysInYear);
+  for (auto type = 0; type < dayTypes; ++type) {
+    std::vector<std::size_t> members;
+    auto medoids = kMedoids(typeProfiles[type], shares[type], &members);
+    for (std::size_t i = 0; i < members.size(); ++i) {
+      representative[typeDays[type][i]] = typeDays[type][medoids[members[i]]];
+    }
+  }
+  return representative;
+}
+
+// Calls f(to.x, from.x) for each of the results x.
+template<typename F>
+void forEachResult(HourResults<std::vector<double> >& to, const HourResults<std::vector<double> >& from, F f)
+{
+  f(to.Qneed_ht, from.Qneed_ht);
+  f(to.Qneed_cl, from.Qneed_cl);
+  f(to.Q_illum_tot, from.Q_illum_tot);
+  f(to.Q_illum_ext_tot, from.Q_illum_ext_tot);
+  f(to.Qfan_tot, from.Qfan_tot);
+  f(to.Qpump_tot, from.Qpump_tot);
+  f(to.phi_plug, from.phi_plug);
+  f(to.externalEquipmentEnergyWperm2, from.externalEquipmentEnergyWperm2);
+  f(to.Q_dhw, from.Q_dhw);
+}
+
+// The sum of all end uses in each of results, and of each end use over all
+// of them. EndUses::getEndUse() isn't const, so results is a copy.
+void sumEndUses(std::vector<EndUses> results, std::vector<double>& totals, std::vector<double>& byUse)
+{
+  totals.assign(results.size(), 0.0);
+  byUse.assign(13, 0.0);
+  for (std::size_t i = 0; i < results.size(); ++i) {
+    for (int j = 0; j < 13; ++j) {
+#ifdef ISOMODEL_STANDALONE
+      auto value = results[i].getEndUse(j);
+#else
+      auto value = results[i].getEndUse(isoResultsEndUseTypes[j].first, isoResultsEndUseTypes[j].second);
+#endif
+      totals[i] += value;
+      byUse[j] += value;
+    }
+  }
+}
+}
+
+template<typename T>
+std::vector<EndUses> BasicHourlyModel<T>::simulate(bool aggregateByMonth)
+{
+  HourlyInputs inputs;
+  prepare(inputs);
+
+  HourResults<std::vector<double>> rawResults;
+  resizeResults(rawResults);
+
+  auto TMT1 = 20.0;
+  auto tiHeatCool = 20.0;
+  calculateHours(inputs, 0, TIMESLICES, TMT1, tiHeatCool, rawResults, trace != nullptr);
+
+  return endUses(rawResults, aggregateByMonth);
+}
+
+template<typename T>
+std::vector<T> BasicHourlyModel<T>::annualEndUses()
+{
+  HourlyInputs inputs;
+  prepare(inputs);
+
+  HourResults<std::vector<T>> rawResults;
+  resizeResults(rawResults);
+
+  T TMT1 = 20.0;
+  T tiHeatCool = 20.0;
+  calculateHours(inputs, 0, TIMESLICES, TMT1, tiHeatCool, rawResults, false);
+
+  // The yearly totals, factored by the distribution efficiencies as in
+  // endUses().
+  auto total = [](const std::vector<T>& hourly) -> T {
+    return std::accumulate(hourly.begin(), hourly.end(), T(0.0)) / 1000.0;
+  };
+  auto Qneed_ht_yr = total(rawResults.Qneed_ht);
+  auto Qneed_cl_yr = total(rawResults.Qneed_cl);
+
+  auto f_dem_ht = std::max<T>(Qneed_ht_yr / (Qneed_cl_yr + Qneed_ht_yr), 0.1);
+  auto f_dem_cl = std::max<T>((1.0 - f_dem_ht), 0.1);
+
+  auto eta_dist_ht = 1.0 / (1.0 + heating.hvacLossFactor() + heating.hotcoldWasteFactor() / f_dem_ht);
+  auto eta_dist_cl = 1.0 / (1.0 + cooling.hvacLossFactor() + heating.hotcoldWasteFactor() / f_dem_cl);
+
+  T heatingEnergy = Qneed_ht_yr / eta_dist_ht / heating.efficiency();
+  auto electricHeating = heating.energyType() == 1;
+
+  std::vector<T> totals(13, T(0.0));
+  totals[0] = electricHeating ? heatingEnergy : T(0.0);
+  totals[1] = Qneed_cl_yr / eta_dist_cl / cooling.cop();
+  totals[2] = total(rawResults.Q_illum_tot);
+  totals[3] = total(rawResults.Q_illum_ext_tot);
+  totals[4] = total(rawResults.Qfan_tot);
+  totals[5] = total(rawResults.Qpump_tot);
+  totals[6] = total(rawResults.phi_plug);
+  totals[7] = total(rawResults.externalEquipmentEnergyWperm2);
+  totals[8] = total(rawResults.Q_dhw);
+  totals[9] = electricHeating ? T(0.0) : heatingEnergy;
+  return totals;
+}
+
+template<typename T>
+std::vector<EndUses> BasicHourlyModel<T>::simulateParareal(bool aggregateByMonth, const PararealSettings& settings, PararealReport* report)
+{
+  HourlyInputs inputs;
+  prepare(inputs);
+
+  auto start = std::chrono::steady_clock::now();
+  HourResults<std::vector<double>> rawResults;
+  resizeResults(rawResults);
+  HourResults<std::vector<double>> coarseResults;
+  resizeResults(coarseResults);
+
+  // One segment per month. Segment n covers hours [bounds[n], bounds[n + 1]).
+  std::vector<int> bounds(1, 0);
+  for (auto i = 1; i < TIMESLICES; ++i) {
+    if (inputs.frame.Month[i] != inputs.frame.Month[i - 1]) {
+      bounds.push_back(i);
+    }
+  }
+  bounds.push_back(TIMESLICES);
+  auto segments = bounds.size() - 1;
+
+  auto propagateCoarse = [&](std::size_t n, ThermalState state) {
+    auto firstHour = std::max(bounds[n], bounds[n + 1] - settings.coarseWindowHours);
+    calculateHours(inputs, firstHour, bounds[n + 1], state.TMT1, state.tiHeatCool, coarseResults, false);
+    return state;
+  };
+
+  // starts[n] is the estimated state at the start of segment n, and coarse[n]
+  // and fine[n] are the states the coarse and fine propagators reach at its
+  // end from starts[n].
+  std::vector<ThermalState> starts(segments + 1);
+  std::vector<ThermalState> coarse(segments);
+  std::vector<ThermalState> fine(segments);
+  std::vector<double> segmentSeconds(segments);
+  starts[0].TMT1 = 20.0;
+  starts[0].tiHeatCool = 20.0;
+  for (std::size_t n = 0; n < segments; ++n) {
+    coarse[n] = propagateCoarse(n, starts[n]);
+    starts[n + 1] = coarse[n];
+  }
+
+  PararealReport result;
+  ThreadPool pool(settings.threads);
+  for (;;) {
+    // After k sweeps the first k segments started from their exact states,
+    // so their fine solutions are final and only the rest need running.
+    std::size_t first = result.iterations;
+    std::vector<std::future<void>> sweep;
+    for (auto n = first; n < segments; ++n) {
+      sweep.push_back(pool.submit([&, n]() {
+        auto segmentStart = std::chrono::steady_clock::now();
+        fine[n] = starts[n];
+        calculateHours(inputs, bounds[n], bounds[n + 1], fine[n].TMT1, fine[n].tiHeatCool, rawResults, false);
+        segmentSeconds[n] = std::chrono::duration<double>(std::chrono::steady_clock::now() - segmentStart).count();
+      }));
+    }
+    for (auto& segment : sweep) {
+      segment.get();
+    }
+    ++result.iterations;
+    result.segmentRuns += static_cast<int>(segments - first);
+    result.sequentialSeconds = std::accumulate(segmentSeconds.begin(), segmentSeconds.end(), 0.0);
+
+    result.maxJump = 0.0;
+    for (auto n = first; n + 1 < segments; ++n) {
+      result.maxJump = std::max(result.maxJump, std::abs(fine[n].TMT1 - starts[n + 1].TMT1));
+      result.maxJump = std::max(result.maxJump, std::abs(fine[n].tiHeatCool - starts[n + 1].tiHeatCool));
+    }
+    if (result.maxJump <= settings.tolerance) {
+      result.converged = true;
+      break;
+    }
+    if (result.iterations >= settings.maxIterations || static_cast<std::size_t>(result.iterations) >= segments) {
+      break;
+    }
+
+    // The segment just run from its exact start hands the next one its exact
+    // state. The others get the Parareal correction:
+    // U[n + 1] = G(U[n]) + F(U_old[n]) - G(U_old[n]).
+    starts[first + 1] = fine[first];
+    for (auto n = first + 1; n < segments; ++n) {
+      auto predicted = propagateCoarse(n, starts[n]);
+      starts[n + 1].TMT1 = predicted.TMT1 + fine[n].TMT1 - coarse[n].TMT1;
+      starts[n + 1].tiHeatCool = predicted.tiHeatCool + fine[n].tiHeatCool - coarse[n].tiHeatCool;
+      coarse[n] = predicted;
+    }
+  }
+  result.wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  result.speedup = result.wallSeconds > 0.0 ? result.sequentialSeconds / result.wallSeconds : 0.0;
+  if (report) {
+    *report = result;
+  }
+
+  return endUses(rawResults, aggregateByMonth);
+}
+
+template<typename T>
+std::vector<EndUses> BasicHourlyModel<T>::simulateRepresentativeDays(bool aggregateByMonth,
+                                                                     const RepresentativeDaySettings& settings,
+                                                                     RepresentativeDayReport* report)
+{
+  const int daysInYear = TIMESLICES / 24;
+  if (settings.representatives.empty() && settings.days > daysInYear) {
+    throw std::invalid_argument("There can't be more representative days than days in the year");
+  }
+  if (!settings.representatives.empty()) {
+    if (settings.representatives.size() != static_cast<std::size_t>(daysInYear)) {
+      throw std::invalid_argument("The representatives must give one day for each day of the year");
+    }
+    for (auto day : settings.representatives) {
+      if (day < 0 || day >= daysInYear || settings.representatives[day] != day) {
+        throw std::invalid_argument("Each representative day must be in the year and represent itself");
+      }
+    }
+  }
+  if (settings.warmupDays < 0) {
+    throw std::invalid_argument("The warm-up can't be negative");
+  }
+
+  HourlyInputs inputs;
+  prepare(inputs);
+
+  auto start = std::chrono::steady_clock::now();
+  RepresentativeDayReport result;
+
+  // Group the days of the week whose schedules are all the same.
+  std::vector<int> dayType(7, -1);
+  for (auto d = 0; d < 7; ++d) {
+    for (auto e = 0; e < d && dayType[d] < 0; ++e) {
+      auto same = true;
+      for (auto h = 0; h < 24 && same; ++h) {
+        same = fixedVentilationSchedule[h][d] == fixedVentilationSchedule[h][e]
+               && fixedExteriorEquipmentSchedule[h][d] == fixedExteriorEquipmentSchedule[h][e]
+               && fixedInteriorEquipmentSchedule[h][d] == fixedInteriorEquipmentSchedule[h][e]
+               && fixedExteriorLightingSchedule[h][d] == fixedExteriorLightingSchedule[h][e]
+               && fixedInteriorLightingSchedule[h][d] == fixedInteriorLightingSchedule[h][e]
+               && fixedActualHeatingSetpoint[h][d] == fixedActualHeatingSetpoint[h][e]
+               && fixedActualCoolingSetpoint[h][d] == fixedActualCoolingSetpoint[h][e];
+      }
+      if (same) {
+        dayType[d] = dayType[e];
+      }
+    }
+    if (dayType[d] < 0) {
+      dayType[d] = result.dayTypes++;
+    }
+  }
+  std::vector<int> representative = settings.representatives;
+  if (representative.empty()) {
+    representative = clusterDays(inputs, dayType, result.dayTypes, settings.days);
+  }
+  for (auto day = 0; day < daysInYear; ++day) {
+    if (representative[day] == day) {
+      result.days.push_back(day);
+    }
+  }
+  result.weights.assign(result.days.size(), 0);
+  for (auto day = 0; day < daysInYear; ++day) {
+    ++result.weights[std::lower_bound(result.days.begin(), result.days.end(), representative[day]) - result.days.begin()];
+  }
+  result.representatives = representative;
+
+  // Simulate the representative days in the order of the year. Each starts
+  // from the end of the one before, warmed up over the days before it; where
+  // the warm-up reaches back to the previous one the run just continues.
+  HourResults<std::vector<double> > simulated;
+  resizeResults(simulated);
+  auto TMT1 = 20.0;
+  auto tiHeatCool = 20.0;
+  auto lastHour = 0;
+  for (auto day : result.days) {
+    auto firstHour = std::max((day - settings.warmupDays) * 24, lastHour);
+    calculateHours(inputs, firstHour, (day + 1) * 24, TMT1, tiHeatCool, simulated, false);
+    result.simulatedHours += (day + 1) * 24 - firstHour;
+    lastHour = (day + 1) * 24;
+  }
+
+  // Every day takes its representative's hours. The results are linear in
+  // the raw results, so by month it's enough to add up the days' sums.
+  HourResults<std::vector<double> > monthlyResults;
+  forEachResult(monthlyResults, simulated, [](std::vector<double>& to, const std::vector<double>&) { to.assign(12, 0.0); });
+  for (auto day = 0; day < daysInYear; ++day) {
+    auto from = representative[day] * 24;
+    auto month = inputs.frame.Month[day * 24] - 1;
+    forEachResult(monthlyResults, simulated, [=](std::vector<double>& to, const std::vector<double>& hours) {
+      to[month] = std::accumulate(hours.begin() + from, hours.begin() + from + 24, to[month]);
+    });
+  }
+  std::vector<EndUses> results;
+  if (aggregateByMonth) {
+    results = endUses(monthlyResults, false);
+  } else {
+    HourResults<std::vector<double> > rawResults;
+    resizeResults(rawResults);
+    for (auto day = 0; day < daysInYear; ++day) {
+      auto from = representative[day] * 24;
+      forEachResult(rawResults, simulated, [=](std::vector<double>& to, const std::vector<double>& hours) {
+        std::copy(hours.begin() + from, hours.begin() + from + 24, to.begin() + day * 24);
+      });
+    }
+    results = endUses(rawResults, false);
+  }
+  result.wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  result.hourSpeedup = result.simulatedHours > 0 ? static_cast<double>(TIMESLICES) / result.simulatedHours : 0.0;
+
+  if (settings.compare) {
+    auto fullStart = std::chrono::steady_clock::now();
+    HourResults<std::vector<double> > fullResults;
+    resizeResults(fullResults);
+    TMT1 = 20.0;
+    tiHeatCool = 20.0;
+    calculateHours(inputs, 0, TIMESLICES, TMT1, tiHeatCool, fullResults, false);
+    auto full = endUses(fullResults, true);
+    result.fullSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - fullStart).count();
+    result.speedup = result.wallSeconds > 0.0 ? result.fullSeconds / result.wallSeconds : 0.0;
+
+    std::vector<double> fullMonths, fullUses, months, uses;
+    sumEndUses(full, fullMonths, fullUses);
+    sumEndUses(aggregateByMonth ? results : endUses(monthlyResults, false), months, uses);
+    result.annualError.resize(13);
+    for (auto j = 0; j < 13; ++j) {
+      result.annualError[j] = uses[j] - fullUses[j];
+    }
+    auto fullTotal = std::accumulate(fullUses.begin(), fullUses.end(), 0.0);
+    auto total = std::accumulate(uses.begin(), uses.end(), 0.0);
+    result.totalError = fullTotal != 0.0 ? (total - fullTotal) / fullTotal : 0.0;
+    auto sum = 0.0;
+    for (auto month = 0; month < 12; ++month) {
+      auto error = months[month] - fullMonths[month];
+      sum += error * error;
+      if (fullMonths[month] != 0.0) {
+        result.maxMonthlyError = std::max(result.maxMonthlyError, std::abs(error / fullMonths[month]));
+      }
+    }
+    result.monthlyRmse = std::sqrt(sum / 12);
+    result.compared = true;
+  }
+
+  if (report) {
+    *report = result;
+  }
+  return results;
+}
+
+template<typename T>
+std::vector<EndUses> BasicHourlyModel<T>::simulate(bool aggregateByMonth, HourlyCheckpoints& checkpoints, int interval)
+{
+  if (interval <= 0) {
+    throw std::invalid_argument("The checkpoint interval must be positive");
+  }
+
+  auto inputs = std::make_shared<HourlyInputs>();
+  prepare(*inputs);
+
+  checkpoints.interval = interval;
+  checkpoints.inputs = inputs;
+  checkpoints.TMT1.assign((TIMESLICES + interval - 1) / interval, 0.0);
+  checkpoints.tiHeatCool.assign(checkpoints.TMT1.size(), 0.0);
+  resizeResults(checkpoints.results);
 
-  initialize();
-  TimeFrame frame;
   auto TMT1 = 20.0;
   auto tiHeatCool = 20.0;
-  std::vector<double> wind = epwData->data()[WSPD];
-  std::vector<double> temp = epwData->data()[DBT];
+  for (std::size_t k = 0; k < checkpoints.TMT1.size(); ++k) {
+    checkpoints.TMT1[k] = TMT1;
+    checkpoints.tiHeatCool[k] = tiHeatCool;
+    auto firstHour = static_cast<int>(k) * interval;
+    calculateHours(*inputs, firstHour, std::min(firstHour + interval, TIMESLICES), TMT1, tiHeatCool, checkpoints.results,
+                   trace != nullptr);
+  }
+  checkpoints.simulatedHours = TIMESLICES;
+
+  return endUses(checkpoints.results, aggregateByMonth);
+}
+
+template<typename T>
+std::vector<EndUses> BasicHourlyModel<T>::resimulate(bool aggregateByMonth,
+                                             HourlyCheckpoints& checkpoints,
+                                             int firstChangedHour,
+                                             int lastChangedHour,
+                                             double convergenceTolerance)
+{
+  if (!checkpoints.inputs || checkpoints.interval <= 0 || checkpoints.results.Qneed_ht.size() != TIMESLICES) {
+    throw std::invalid_argument("The checkpoints were not saved by HourlyModel::simulate()");
+  }
+  if (firstChangedHour < 0 || firstChangedHour > lastChangedHour || lastChangedHour >= TIMESLICES) {
+    throw std::out_of_range("The changed hours must be in the year");
+  }
+
+  prepareCoefficients();
+
+  auto interval = checkpoints.interval;
+  std::size_t k = firstChangedHour / interval;
+  auto TMT1 = checkpoints.TMT1[k];
+  auto tiHeatCool = checkpoints.tiHeatCool[k];
+  checkpoints.simulatedHours = 0;
+  for (; k < checkpoints.TMT1.size(); ++k) {
+    auto firstHour = static_cast<int>(k) * interval;
+    if (convergenceTolerance >= 0.0 && firstHour > lastChangedHour
+        && std::abs(TMT1 - checkpoints.TMT1[k]) <= convergenceTolerance
+        && std::abs(tiHeatCool - checkpoints.tiHeatCool[k]) <= convergenceTolerance) {
+      // Back on the saved trajectory. The rest of the saved run still holds.
+      break;
+    }
+    checkpoints.TMT1[k] = TMT1;
+    checkpoints.tiHeatCool[k] = tiHeatCool;
+    auto lastHour = std::min(firstHour + interval, TIMESLICES);
+    calculateHours(*checkpoints.inputs, firstHour, lastHour, TMT1, tiHeatCool, checkpoints.results, trace != nullptr);
+    checkpoints.simulatedHours += lastHour - firstHour;
+  }
+
+  return endUses(checkpoints.results, aggregateByMonth);
+}
+
+template<typename T>
+std::vector<EndUses> BasicHourlyModel<T>::resimulate(bool aggregateByMonth,
+                                             HourlyCheckpoints& checkpoints,
+                                             std::shared_ptr<const HourlyInputs> inputs,
+                                             double convergenceTolerance)
+{
+  if (!checkpoints.inputs) {
+    throw std::invalid_argument("The checkpoints were not saved by HourlyModel::simulate()");
+  }
+  if (!inputs || inputs->wind.size() != TIMESLICES || inputs->temperature.size() != TIMESLICES
+      || inputs->radiation.size() != TIMESLICES) {
+    throw std::invalid_argument("The inputs must have every hour of the year");
+  }
+
+  const auto& saved = *checkpoints.inputs;
+  auto firstChangedHour = TIMESLICES;
+  auto lastChangedHour = -1;
+  for (auto i = 0; i < TIMESLICES; ++i) {
+    if (inputs->wind[i] != saved.wind[i] || inputs->temperature[i] != saved.temperature[i]
+        || inputs->radiation[i] != saved.radiation[i] || inputs->frame.Hour[i] != saved.frame.Hour[i]
+        || inputs->frame.DayOfWeek[i] != saved.frame.DayOfWeek[i]) {
+      firstChangedHour = std::min(firstChangedHour, i);
+      lastChangedHour = i;
+    }
+  }
+  changedOverrideHours(inputs->scheduleOverrides, saved.scheduleOverrides, firstChangedHour, lastChangedHour);
+  changedOverrideHours(saved.scheduleOverrides, inputs->scheduleOverrides, firstChangedHour, lastChangedHour);
+
+  checkpoints.inputs = inputs;
+  if (lastChangedHour < 0) {
+    // Nothing changed, so the saved results still hold.
+    prepareCoefficients();
+    checkpoints.simulatedHours = 0;
+    return endUses(checkpoints.results, aggregateByMonth);
+  }
+  return resimulate(aggregateByMonth, checkpoints, firstChangedHour, lastChangedHour, convergenceTolerance);
+}
 
-  SolarRadiation pos(&frame, epwData.get());
-  pos.Calculate();
-  std::vector<std::vector<double> > radiation = pos.eglobe(); // Radiation for 8 directions (N, NE, E, etc.).
+template<typename T>
+void BasicHourlyModel<T>::prepareSteps()
+{
+  prepareCoefficients();
+  stepKernel = kernel(trace != nullptr);
+  stepState = HourlyState();
+}
+
+template<typename T>
+HourEndUses BasicHourlyModel<T>::step(const HourInput& input)
+{
+  HourEndUses hourEndUses;
+  stepBranches(input, nullptr, nullptr, &stepState, &hourEndUses, 1);
+  return hourEndUses;
+}
+
+template<typename T>
+void BasicHourlyModel<T>::stepBranches(const HourInput& input,
+                               const double* heatingSetpoints,
+                               const double* coolingSetpoints,
+                               HourlyState* states,
+                               HourEndUses* results,
+                               std::size_t branches)
+{
+  if (branches == 0) {
+    return;
+  }
+  // The branches share the hour's schedules, which can depend on the hour.
+  for (std::size_t k = 1; k < branches; ++k) {
+    if (states[k].hours != states[0].hours) {
+      throw std::invalid_argument("The branches must all be at the same hour");
+    }
+  }
+
+  auto hourSchedules = schedules(states[0].hours + 1, input.hourOfDay, input.dayOfWeek);
+  applyOverrides(input, hourSchedules);
+
+  switch (stepKernel) {
+  case -1: {
+    RuntimeHourFlags flags = { heating.forcedAirHeating(), cooling.forcedAirCooling(), lights.exteriorEnergy() != 0.0, useAffineSolver,
+                               trace != nullptr };
+    stepLanes(input, hourSchedules, heatingSetpoints, coolingSetpoints, states, results, branches, flags);
+    break;
+  }
+  case 0:
+    stepLanes(input, hourSchedules, heatingSetpoints, coolingSetpoints, states, results, branches, FixedHourFlags<false, false, false>());
+    break;
+  case 1:
+    stepLanes(input, hourSchedules, heatingSetpoints, coolingSetpoints, states, results, branches, FixedHourFlags<false, false, true>());
+    break;
+  case 2:
+    stepLanes(input, hourSchedules, heatingSetpoints, coolingSetpoints, states, results, branches, FixedHourFlags<false, true, false>());
+    break;
+  case 3:
+    stepLanes(input, hourSchedules, heatingSetpoints, coolingSetpoints, states, results, branches, FixedHourFlags<false, true, true>());
+    break;
+  case 4:
+    stepLanes(input, hourSchedules, heatingSetpoints, coolingSetpoints, states, results, branches, FixedHourFlags<true, false, false>());
+    break;
+  case 5:
+    stepLanes(input, hourSchedules, heatingSetpoints, coolingSetpoints, states, results, branches, FixedHourFlags<true, false, true>());
+    break;
+  case 6:
+    stepLanes(input, hourSchedules, heatingSetpoints, coolingSetpoints, states, results, branches, FixedHourFlags<true, true, false>());
+    break;
+  default:
+    stepLanes(input, hourSchedules, heatingSetpoints, coolingSetpoints, states, results, branches, FixedHourFlags<true, true, true>());
+    break;
+  }
+}
+
+template<typename T>
+template<typename Flags>
+void BasicHourlyModel<T>::stepLanes(const HourInput& input,
+                            const HourSchedules& hourSchedules,
+                            const double* heatingSetpoints,
+                            const double* coolingSetpoints,
+                            HourlyState* states,
+                            HourEndUses* results,
+                            std::size_t branches,
+                            const Flags& flags)
+{
+  HourGains gains;
+  HourResults<double> sharedResults;
+  calculateGains(hourSchedules, input.windMps, input.temperature, input.solarRadiation, gains, sharedResults, flags);
+
+  for (std::size_t k = 0; k < branches; ++k) {
+    auto& state = states[k];
+    auto hourResults = sharedResults;
+    calculateState(state.hours + 1,
+                   gains,
+                   heatingSetpoints ? heatingSetpoints[k] : hourSchedules.heatingSetpoint,
+                   coolingSetpoints ? coolingSetpoints[k] : hourSchedules.coolingSetpoint,
+                   input.windMps,
+                   input.temperature,
+                   state.TMT1,
+                   state.tiHeatCool,
+                   hourResults,
+                   flags);
+    accumulateHour(hourResults, state, results[k]);
+  }
+}
+
+template<typename T>
+void BasicHourlyModel<T>::accumulateHour(const HourResults<double>& hourResults, HourlyState& state, HourEndUses& hourEndUses)
+{
+  ++state.hours;
+  state.heatingNeed += hourResults.Qneed_ht;
+  state.coolingNeed += hourResults.Qneed_cl;
+
+  // The distribution efficiencies as in endUses(), but from the needs so far
+  // rather than the yearly totals.
+  auto totalNeed = state.heatingNeed + state.coolingNeed;
+  auto f_dem_ht = totalNeed > 0.0 ? std::max(state.heatingNeed / totalNeed, 0.1) : 0.5;
+  auto f_dem_cl = std::max((1.0 - f_dem_ht), 0.1);
+  auto eta_dist_ht = 1.0 / (1.0 + heating.hvacLossFactor() + heating.hotcoldWasteFactor() / f_dem_ht);
+  auto eta_dist_cl = 1.0 / (1.0 + cooling.hvacLossFactor() + heating.hotcoldWasteFactor() / f_dem_cl);
+  auto heatingEnergy = hourResults.Qneed_ht / eta_dist_ht / heating.efficiency();
+  auto electricHeating = heating.energyType() == 1;
+
+  // Convert to EUI in kWh/m^2, in the order of the standalone EndUses.
+  hourEndUses.values[0] = electricHeating ? heatingEnergy / 1000.0 : 0.0;
+  hourEndUses.values[1] = hourResults.Qneed_cl / eta_dist_cl / cooling.cop() / 1000.0;
+  hourEndUses.values[2] = hourResults.Q_illum_tot / 1000.0;
+  hourEndUses.values[3] = hourResults.Q_illum_ext_tot / 1000.0;
+  hourEndUses.values[4] = hourResults.Qfan_tot / 1000.0;
+  hourEndUses.values[5] = hourResults.Qpump_tot / 1000.0;
+  hourEndUses.values[6] = hourResults.phi_plug / 1000.0;
+  hourEndUses.values[7] = hourResults.externalEquipmentEnergyWperm2 / 1000.0;
+  hourEndUses.values[8] = hourResults.Q_dhw / 1000.0;
+  hourEndUses.values[9] = electricHeating ? 0.0 : heatingEnergy / 1000.0;
+  hourEndUses.values[10] = 0.0;
+  hourEndUses.values[11] = 0.0;
+  hourEndUses.values[12] = 0.0;
+
+  for (auto i = 0; i != 13; ++i) {
+    state.totals.values[i] += hourEndUses.values[i];
+  }
+}
+
+template<typename T>
+void BasicHourlyModel<T>::prepare(HourlyInputs& inputs)
+{
+  prepareCoefficients();
+
+  if (trace) {
+    traceSchedule("Cooling Setpoint", fixedActualCoolingSetpoint);
+    traceSchedule("Heating Setpoint", fixedActualHeatingSetpoint);
+    traceSchedule("Exterior Equipment", fixedExteriorEquipmentSchedule);
+    traceSchedule("Exterior Lighting", fixedExteriorLightingSchedule);
+    traceSchedule("Interior Equipment", fixedInteriorEquipmentSchedule);
+    traceSchedule("Interior Lighting", fixedInteriorLightingSchedule);
+    traceSchedule("Ventilation", fixedVentilationSchedule);
+  }
+
+  inputs.wind = epwData->data()[WSPD];
+  inputs.temperature = epwData->data()[DBT];
+
+  if (wallIrradiance) {
+    if (wallIrradiance->size() != TIMESLICES) {
+      throw std::invalid_argument("The wall irradiance must have a row for every hour of the year");
+    }
+    inputs.radiation = *wallIrradiance;
+  } else {
+    SolarRadiation pos(&inputs.frame, epwData.get());
+    pos.calculateSurfaceSolarRadiation();
+    inputs.radiation = pos.eglobe(); // Radiation for 8 directions (N, NE, E, etc.).
+  }
   // Add the roof radiation (9th direction). EGH is global horizontal radiation.
   // TODO BAA@2015-02-25: There ought to be a more efficient way of setting up the radiation.
-  for (auto i = 0; i != radiation.size(); ++i) {
-    radiation[i].push_back(epwData->data()[EGH][i]);
+  for (auto i = 0; i != inputs.radiation.size(); ++i) {
+    inputs.radiation[i].push_back(epwData->data()[EGH][i]);
   }
+}
 
-  HourResults<double> tempHourResults;
-  HourResults<std::vector<double>> rawResults;
+template<typename T>
+void BasicHourlyModel<T>::prepareCoefficients()
+{
+  populateSchedules();
+  initialize();
+}
 
-  for (auto i = 0; i < TIMESLICES; ++i) {
-    auto month = frame.Month[i];
-    auto hourOfDay = frame.Hour[i];
-    auto dayOfWeek = frame.DayOfWeek[i];
-    
-    calculateHour(i + 1, //hourOfYear
-                  month, //month
-                  dayOfWeek, //dayOfWeek
-                  hourOfDay, //hourOfDay
-                  wind[i], //windMps
-                  temp[i], //temperature
-                  radiation[i],
-                  TMT1, //TMT1
-                  tiHeatCool, //tiHeatCool
-                  tempHourResults);
-    // Store each result type in its own vector.
-    rawResults.Qneed_ht.push_back(tempHourResults.Qneed_ht);
-    rawResults.Qneed_cl.push_back(tempHourResults.Qneed_cl);
-    rawResults.Q_illum_tot.push_back(tempHourResults.Q_illum_tot);
-    rawResults.Q_illum_ext_tot.push_back(tempHourResults.Q_illum_ext_tot);
-    rawResults.Qfan_tot.push_back(tempHourResults.Qfan_tot);
-    rawResults.Qpump_tot.push_back(tempHourResults.Qpump_tot);
-    rawResults.phi_plug.push_back(tempHourResults.phi_plug);
-    rawResults.externalEquipmentEnergyWperm2.push_back(tempHourResults.externalEquipmentEnergyWperm2);
-    rawResults.Q_dhw.push_back(tempHourResults.Q_dhw);
+template<typename T>
+void BasicHourlyModel<T>::traceSchedule(const char* name, const T (&schedule)[24][7])
+{
+  double values[24][7];
+  for (auto h = 0; h != 24; ++h) {
+    for (auto d = 0; d != 7; ++d) {
+      values[h][d] = scalarValue(schedule[h][d]);
+    }
+  }
+  trace->record(name, &values[0][0], 24, 7);
+}
+
+template<typename T>
+void BasicHourlyModel<T>::resizeResults(HourResults<std::vector<T> >& rawResults)
+{
+  rawResults.Qneed_ht.assign(TIMESLICES, 0.0);
+  rawResults.Qneed_cl.assign(TIMESLICES, 0.0);
+  rawResults.Q_illum_tot.assign(TIMESLICES, 0.0);
+  rawResults.Q_illum_ext_tot.assign(TIMESLICES, 0.0);
+  rawResults.Qfan_tot.assign(TIMESLICES, 0.0);
+  rawResults.Qpump_tot.assign(TIMESLICES, 0.0);
+  rawResults.phi_plug.assign(TIMESLICES, 0.0);
+  rawResults.externalEquipmentEnergyWperm2.assign(TIMESLICES, 0.0);
+  rawResults.Q_dhw.assign(TIMESLICES, 0.0);
+}
+
+template<typename T>
+void BasicHourlyModel<T>::calculateHours(const HourlyInputs& inputs,
+                                 int firstHour,
+                                 int lastHour,
+                                 T& TMT1,
+                                 T& tiHeatCool,
+                                 HourResults<std::vector<T> >& rawResults,
+                                 bool traced)
+{
+  switch (kernel(traced)) {
+  case -1: {
+    RuntimeHourFlags flags = { heating.forcedAirHeating(), cooling.forcedAirCooling(), lights.exteriorEnergy() != 0.0, useAffineSolver,
+                               traced };
+    calculateHours(inputs, firstHour, lastHour, TMT1, tiHeatCool, rawResults, flags);
+    break;
+  }
+  case 0:
+    calculateHours(inputs, firstHour, lastHour, TMT1, tiHeatCool, rawResults, FixedHourFlags<false, false, false>());
+    break;
+  case 1:
+    calculateHours(inputs, firstHour, lastHour, TMT1, tiHeatCool, rawResults, FixedHourFlags<false, false, true>());
+    break;
+  case 2:
+    calculateHours(inputs, firstHour, lastHour, TMT1, tiHeatCool, rawResults, FixedHourFlags<false, true, false>());
+    break;
+  case 3:
+    calculateHours(inputs, firstHour, lastHour, TMT1, tiHeatCool, rawResults, FixedHourFlags<false, true, true>());
+    break;
+  case 4:
+    calculateHours(inputs, firstHour, lastHour, TMT1, tiHeatCool, rawResults, FixedHourFlags<true, false, false>());
+    break;
+  case 5:
+    calculateHours(inputs, firstHour, lastHour, TMT1, tiHeatCool, rawResults, FixedHourFlags<true, false, true>());
+    break;
+  case 6:
+    calculateHours(inputs, firstHour, lastHour, TMT1, tiHeatCool, rawResults, FixedHourFlags<true, true, false>());
+    break;
+  default:
+    calculateHours(inputs, firstHour, lastHour, TMT1, tiHeatCool, rawResults, FixedHourFlags<true, true, true>());
+    break;
   }
+}
+
+template<typename T>
+void BasicHourlyModel<T>::setCancellation(const CancellationToken& token, int interval)
+{
+  if (interval <= 0) {
+    throw std::invalid_argument("The cancellation interval must be positive");
+  }
+  cancellation = token;
+  cancellationInterval = interval;
+}
+
+template<typename T>
+int BasicHourlyModel<T>::kernel(bool traced) const
+{
+  // The configuration flags don't change during a run, so select the kernel
+  // once.
+  if (!useSpecializedKernels || !useAffineSolver || traced) {
+    return -1;
+  }
+  return (heating.forcedAirHeating() ? 4 : 0) + (cooling.forcedAirCooling() ? 2 : 0) + (lights.exteriorEnergy() != 0.0 ? 1 : 0);
+}
 
+template<typename T>
+std::vector<EndUses> BasicHourlyModel<T>::endUses(const HourResults<std::vector<double> >& rawResults, bool aggregateByMonth)
+{
   // Factor the raw need results by the distribution efficiencies.
   auto a_ht_loss = heating.hvacLossFactor();
   auto a_cl_loss = cooling.hvacLossFactor();
@@ -145,7 +970,7 @@ std::vector<EndUses> HourlyModel::simulate(bool aggregateByMonth)
     }
   }
 
-  auto numberOfResults = aggregateByMonth ? 12 : 8760;
+  auto numberOfResults = aggregateByMonth ? 12 : static_cast<int>(rawResults.Qneed_ht.size());
 
   std::vector<EndUses> allResults;
   for (auto i = 0; i < numberOfResults; ++i) {
@@ -186,16 +1011,57 @@ std::vector<EndUses> HourlyModel::simulate(bool aggregateByMonth)
   return allResults;
 }
 
-void HourlyModel::calculateHour(int hourOfYear,
-                              int month,
-                              int dayOfWeek,
-                              int hourOfDay,
-                              double windMps,
-                              double temperature,
-                              const std::vector<double>& solarRadiation,
-                              double& TMT1,
-                              double& tiHeatCool,
-                              HourResults<double>& results)
+template<typename T>
+template<typename Flags>
+void BasicHourlyModel<T>::calculateHours(const HourlyInputs& inputs,
+                                 int firstHour,
+                                 int lastHour,
+                                 T& TMT1,
+                                 T& tiHeatCool,
+                                 HourResults<std::vector<T> >& rawResults,
+                                 const Flags& flags)
+{
+  HourResults<T> tempHourResults;
+
+  auto untilPoll = 0;
+  auto overrides = inputs.scheduleOverrides.lower_bound(firstHour);
+  for (auto i = firstHour; i < lastHour; ++i) {
+    if (untilPoll-- == 0) {
+      cancellation.throwIfCancelled(i, TIMESLICES);
+      untilPoll = cancellationInterval - 1;
+    }
+    auto hourOfDay = inputs.frame.Hour[i];
+    auto dayOfWeek = inputs.frame.DayOfWeek[i];
+    auto hourSchedules = schedules(i + 1, hourOfDay, dayOfWeek);
+    if (overrides != inputs.scheduleOverrides.end() && overrides->first == i) {
+      applyOverrides(overrides->second, hourSchedules);
+      ++overrides;
+    }
+    
+    calculateHour(i + 1, //hourOfYear
+                  hourSchedules,
+                  inputs.wind[i], //windMps
+                  inputs.temperature[i], //temperature
+                  inputs.radiation[i].data(),
+                  TMT1, //TMT1
+                  tiHeatCool, //tiHeatCool
+                  tempHourResults,
+                  flags);
+    // Store each result type in its own vector.
+    rawResults.Qneed_ht[i] = tempHourResults.Qneed_ht;
+    rawResults.Qneed_cl[i] = tempHourResults.Qneed_cl;
+    rawResults.Q_illum_tot[i] = tempHourResults.Q_illum_tot;
+    rawResults.Q_illum_ext_tot[i] = tempHourResults.Q_illum_ext_tot;
+    rawResults.Qfan_tot[i] = tempHourResults.Qfan_tot;
+    rawResults.Qpump_tot[i] = tempHourResults.Qpump_tot;
+    rawResults.phi_plug[i] = tempHourResults.phi_plug;
+    rawResults.externalEquipmentEnergyWperm2[i] = tempHourResults.externalEquipmentEnergyWperm2;
+    rawResults.Q_dhw[i] = tempHourResults.Q_dhw;
+  }
+}
+
+template<typename T>
+typename BasicHourlyModel<T>::HourSchedules BasicHourlyModel<T>::schedules(int hourOfYear, int hourOfDay, int dayOfWeek)
 {
   // scheduleOffset appears to perhaps be supposed to convert a 0 to 6, Sunday to Saturday range into a 1 to 7, Monday to Sunday 
   // range, but because dayOfWeek is a 1-7 range, it does nothing. BAA@2015-04-15.
@@ -204,14 +1070,51 @@ void HourlyModel::calculateHour(int hourOfYear,
 
   // Extract schedules to a function so that we can populate them based on
   // timeslice instead of fixed schedules.
+  HourSchedules result;
+  result.ventilation = ventilationSchedule(hourOfYear, hourOfDay, scheduleOffset);
+  result.exteriorEquipment = exteriorEquipmentSchedule(hourOfYear, hourOfDay, scheduleOffset);
+  result.interiorEquipment = interiorEquipmentSchedule(hourOfYear, hourOfDay, scheduleOffset);
+  result.exteriorLighting = exteriorLightingSchedule(hourOfYear, hourOfDay, scheduleOffset);
+  result.interiorLighting = interiorLightingSchedule(hourOfYear, hourOfDay, scheduleOffset);
+  result.heatingSetpoint = heatingSetpointSchedule(hourOfYear, hourOfDay, scheduleOffset);
+  result.coolingSetpoint = coolingSetpointSchedule(hourOfYear, hourOfDay, scheduleOffset);
+  return result;
+}
+
+template<typename T>
+template<typename Flags>
+void BasicHourlyModel<T>::calculateHour(int hourOfYear,
+                                const HourSchedules& schedules,
+                                double windMps,
+                                double temperature,
+                                const double* solarRadiation,
+                                T& TMT1,
+                                T& tiHeatCool,
+                                HourResults<T>& results,
+                                const Flags& flags)
+{
+  HourGains gains;
+  calculateGains(schedules, windMps, temperature, solarRadiation, gains, results, flags);
+  calculateState(hourOfYear, gains, schedules.heatingSetpoint, schedules.coolingSetpoint, windMps, temperature, TMT1, tiHeatCool,
+                 results, flags);
+}
+
+template<typename T>
+template<typename Flags>
+void BasicHourlyModel<T>::calculateGains(const HourSchedules& schedules,
+                                 double windMps,
+                                 double temperature,
+                                 const double* solarRadiation,
+                                 HourGains& gains,
+                                 HourResults<T>& results,
+                                 const Flags& flags)
+{
   // Convert ventilation from L/s to m^3/h and divide by floor area.
-  auto ventExhaustM3phpm2 = ventilationSchedule(hourOfYear, hourOfDay, scheduleOffset) * 3.6 / structure.floorArea(); 
-  auto externalEquipmentPower = exteriorEquipmentSchedule(hourOfYear, hourOfDay, scheduleOffset);
-  auto interiorEquipmentPowerDensity = interiorEquipmentSchedule(hourOfYear, hourOfDay, scheduleOffset); 
-  auto exteriorLightingEnabled = exteriorLightingSchedule(hourOfYear, hourOfDay, scheduleOffset); 
-  auto interiorLightingPowerDensity = interiorLightingSchedule(hourOfYear, hourOfDay, scheduleOffset);
-  auto actualHeatingSetpoint = heatingSetpointSchedule(hourOfYear, hourOfDay, scheduleOffset);
-  auto actualCoolingSetpoint = coolingSetpointSchedule(hourOfYear, hourOfDay, scheduleOffset);
+  auto ventExhaustM3phpm2 = schedules.ventilation * 3.6 / structure.floorArea(); 
+  auto externalEquipmentPower = schedules.exteriorEquipment;
+  auto interiorEquipmentPowerDensity = schedules.interiorEquipment; 
+  auto exteriorLightingEnabled = schedules.exteriorLighting; 
+  auto interiorLightingPowerDensity = schedules.interiorLighting;
 
   results.externalEquipmentEnergyWperm2 = externalEquipmentPower / structure.floorArea();
 
@@ -219,14 +1122,17 @@ void HourlyModel::calculateHour(int hourOfYear,
   // Monthly name: phi_plug_occ and phi_plug_unocc.
   results.phi_plug = interiorEquipmentPowerDensity;
 
-  std::vector<double> lightingContribution;
+  // Summed in direction order so the result matches accumulating a vector of
+  // the contributions.
+  using std::pow;
+
+  T lightingLevel = 0.0;
   for (auto i = 0; i != 9; ++i) {
-    lightingContribution.push_back(53 / areaNaturallyLightedRatio * solarRadiation[i]
-        * (naturalLightRatio[i] + shadingUsePerWPerM2 * naturalLightShadeRatioReduction[i] * std::min(structure.irradianceForMaxShadingUse(), solarRadiation[i])));
+    lightingLevel += 53 / areaNaturallyLightedRatio * solarRadiation[i]
+        * (naturalLightRatio[i] + shadingUsePerWPerM2 * naturalLightShadeRatioReduction[i] * std::min<T>(structure.irradianceForMaxShadingUse(), solarRadiation[i]));
   }
 
-  auto lightingLevel = std::accumulate(std::begin(lightingContribution), std::end(lightingContribution), 0.0);
-  auto electricForNaturalLightArea = std::max(0.0, maxRatioElectricLighting * (1 - lightingLevel / elightNatural));
+  auto electricForNaturalLightArea = std::max<T>(0.0, maxRatioElectricLighting * (1 - lightingLevel / elightNatural));
   auto electricForTotalLightArea = electricForNaturalLightArea * areaNaturallyLightedRatio
          + (1 - areaNaturallyLightedRatio) * maxRatioElectricLighting;
 
@@ -246,23 +1152,15 @@ void HourlyModel::calculateHour(int hourOfYear,
   // \Phi_{sol,k}, ISO 13790 11.3.2 eq. 43. 
   // Note: method of calculating A_{sol,k} with movable shading differs from
   // the method in the standard.
-  std::vector<double> solarHeatGain;
+  // \Phi_{sol}, ISO 13790 11.2.2 eq. 41.
+  T qSolarHeatGain = 0.0;
   for (auto i = 0; i != 9; ++i) {
-    solarHeatGain.push_back(
-      solarRadiation[i] * (solarRatio[i] + solarShadeRatioReduction[i] * shadingUsePerWPerM2 * std::min(solarRadiation[i], structure.irradianceForMaxShadingUse())));
+    qSolarHeatGain +=
+      solarRadiation[i] * (solarRatio[i] + solarShadeRatioReduction[i] * shadingUsePerWPerM2 * std::min<T>(solarRadiation[i], structure.irradianceForMaxShadingUse()));
   }
-
-  // \Phi_{sol}, ISO 13790 11.2.2 eq. 41.
-  auto qSolarHeatGain = std::accumulate(std::begin(solarHeatGain), std::end(solarHeatGain), 0.0);
   // \Phi_{ia}, ISO 13790 C.2 eq. C.1. 
   // (Note that solarPair = 0 and intPair = 0.5).
   auto phii = simSettings.phiSolFractionToAirNode() * qSolarHeatGain + simSettings.phiIntFractionToAirNode() * phi_int;
-  // \Phi_{ia10}, ISO 13790 C.4.2. 
-  // Used to calculate \theta_{air,ac} when available heating or cooling power
-  // is insufficient to achieve the setpoint. Adding 10 is equivalent to
-  // applying 10 W/m^2 to the building because all the values in this
-  // implementation are expressed per area (so as to get final results in EUI).
-  auto phii10 = phii + 10;
   
   // Ventilation from wind. ISO 15242.
   auto qSupplyBySystem = ventExhaustM3phpm2 * windImpactSupplyRatio;
@@ -270,12 +1168,75 @@ void HourlyModel::calculateHour(int hourOfYear,
   auto tAfterExchange = (1 - ventilation.heatRecoveryEfficiency()) * temperature + ventilation.heatRecoveryEfficiency() * 20;
   auto tSuppliedAir = std::max(ventilation.ventPreheatDegC(), tAfterExchange);
   // ISO 15242 6.7.1 Step 1.
-  auto qWind = 0.0769 * q4Pa * std::pow((ventilation.dCp() * windMps * windMps), 0.667);
-  auto qStackPrevIntTemp = 0.0146 * q4Pa * std::pow((0.5 * windImpactHz * (std::max(0.00001, fabs(temperature - tiHeatCool)))), 0.667);
+  auto qWind = 0.0769 * q4Pa * pow((ventilation.dCp() * windMps * windMps), 0.667);
+
+  // \Phi_{st}, ISO 13790 C.2 eq. C.3 
+  // In generalized form from Georgia Tech spreadsheet.
+  auto phisPhi0 = prsSolar * qSolarHeatGain + prsInterior * phi_int;
+  // \Phi_{m}, ISO 13790 C.2 eq. C.2.
+  // In generalized form from Georgia Tech spreadsheet.
+  auto phimPhi0 = prmSolar * qSolarHeatGain + prmInterior * phi_int;
+
+  if (!flags.exteriorLighting()) {
+    results.Q_illum_ext_tot = 0; // No exterior lights at all.
+  } else if (solarRadiation[8] > 0) { // Check roof radiation to see if sun is up.
+    results.Q_illum_ext_tot = 0; // No exterior lights during the day.
+  } else {
+    results.Q_illum_ext_tot = lights.exteriorEnergy() * exteriorLightingEnabled / structure.floorArea();
+    //ExcelFunctions.printOut("CS156",exteriorLightingEnergyWperm2,0.0539503346043362);
+  }
+
+  results.Q_dhw = 0; //TODO no DHW calculations
+
+  gains.ventExhaustM3phpm2 = ventExhaustM3phpm2;
+  gains.phi_int = phi_int;
+  gains.qSolarHeatGain = qSolarHeatGain;
+  gains.phii = phii;
+  gains.qSupplyBySystem = qSupplyBySystem;
+  gains.exhaustSupply = exhaustSupply;
+  gains.tSuppliedAir = tSuppliedAir;
+  gains.qWind = qWind;
+  gains.phisPhi0 = phisPhi0;
+  gains.phimPhi0 = phimPhi0;
+}
+
+template<typename T>
+template<typename Flags>
+void BasicHourlyModel<T>::calculateState(int hourOfYear,
+                                 const HourGains& gains,
+                                 T actualHeatingSetpoint,
+                                 T actualCoolingSetpoint,
+                                 double windMps,
+                                 double temperature,
+                                 T& TMT1,
+                                 T& tiHeatCool,
+                                 HourResults<T>& results,
+                                 const Flags& flags)
+{
+  using std::pow;
+
+  auto ventExhaustM3phpm2 = gains.ventExhaustM3phpm2;
+  auto phi_int = gains.phi_int;
+  auto qSolarHeatGain = gains.qSolarHeatGain;
+  auto phii = gains.phii;
+  // \Phi_{ia10}, ISO 13790 C.4.2. 
+  // Used to calculate \theta_{air,ac} when available heating or cooling power
+  // is insufficient to achieve the setpoint. Adding 10 is equivalent to
+  // applying 10 W/m^2 to the building because all the values in this
+  // implementation are expressed per area (so as to get final results in EUI).
+  auto phii10 = phii + 10;
+  auto qSupplyBySystem = gains.qSupplyBySystem;
+  auto exhaustSupply = gains.exhaustSupply;
+  auto tSuppliedAir = gains.tSuppliedAir;
+  auto qWind = gains.qWind;
+  auto phisPhi0 = gains.phisPhi0;
+  auto phimPhi0 = gains.phimPhi0;
+
+  auto qStackPrevIntTemp = 0.0146 * q4Pa * pow((0.5 * windImpactHz * (std::max<T>(0.00001, fabs(temperature - tiHeatCool)))), 0.667);
   // ISO 15242 6.7.1 Step 2.
-  auto qExfiltration = std::max(0.0,
+  auto qExfiltration = std::max<T>(0.0,
       std::max(qStackPrevIntTemp, qWind) - fabs(exhaustSupply) * (0.5 * qStackPrevIntTemp + 0.667 * (qWind) / (qStackPrevIntTemp + qWind)));
-  auto qEnvelope = std::max(0.0, exhaustSupply) + qExfiltration;
+  auto qEnvelope = std::max<T>(0.0, exhaustSupply) + qExfiltration;
   // ISO 15242 6.7.2.
   auto qEnteringTotal = qEnvelope + qSupplyBySystem;
 
@@ -296,44 +1257,88 @@ void HourlyModel::calculateHour(int hourOfYear,
   // heating or cooling power is available to get the temp between the heating
   // and cooling setpoints.
 
-  // \Phi_{st}, ISO 13790 C.2 eq. C.3 
-  // In generalized form from Georgia Tech spreadsheet.
-  auto phisPhi0 = prsSolar * qSolarHeatGain + prsInterior * phi_int;
-  // \Phi_{m}, ISO 13790 C.2 eq. C.2.
-  // In generalized form from Georgia Tech spreadsheet.
-  auto phimPhi0 = prmSolar * qSolarHeatGain + prmInterior * phi_int;
   // H_{tr,3}, ISO 13790 C.3 eq. C.9.
   auto h3 = 1 / (1 / h2 + 1 / H_ms);
-  // \Phi_{mtot}, ISO 13790 C.3 eq. C.5.
-  auto phimTotalPhi10 = phimPhi0 + hem * temperature
-       + h3 * (phisPhi0 + hwindowWperkm2 * temperature + h1 * (phii10 / hei + tEnteringAndSupplied)) / h2;
-  auto phimTotalPhi0 = phimPhi0 + hem * temperature
-       + h3 * (phisPhi0 + hwindowWperkm2 * temperature + h1 * (phii / hei + tEnteringAndSupplied)) / h2;
-      // \theta_{m,t10}, ISO 13790 C.3 eq. C.4.
-  auto tmt1Phi10 = (TMT1 * (Cm / 3.6 - 0.5 * (h3 + hem)) + phimTotalPhi10) / (Cm / 3.6 + 0.5 * (h3 + hem));
-  auto tmPhi10 = 0.5 * (TMT1 + tmt1Phi10);
-  auto tsPhi10 = (H_ms * tmPhi10 + phisPhi0 + hwindowWperkm2 * temperature + h1 * (tEnteringAndSupplied + phii10 / hei))
-       / (H_ms + hwindowWperkm2 + h1);
-  //ExcelFunctions.printOut("BA156",tsPhi10,19.8762155145252);
-  auto tiPhi10 = (H_tris * tsPhi10 + hei * tEnteringAndSupplied + phii10) / (H_tris + hei);
-  // \theta_{m,t}, ISO 13790 C.3 eq. C.4.
-  auto tmt1Phi0 = (TMT1 * (Cm / 3.6 - 0.5 * (h3 + hem)) + phimTotalPhi0) / (Cm / 3.6 + 0.5 * (h3 + hem));
-  auto tmPhi0 = 0.5 * (TMT1 + tmt1Phi0);
-  auto tsPhi0 = (H_ms * tmPhi0 + phisPhi0 + hwindowWperkm2 * temperature + h1 * (tEnteringAndSupplied + phii / hei)) / (H_ms + hwindowWperkm2 + h1);
-  auto tiPhi0 = (H_tris * tsPhi0 + hei * tEnteringAndSupplied + phii) / (H_tris + hei);
-  auto phiCooling = 10 * (actualCoolingSetpoint - tiPhi0) / (tiPhi10 - tiPhi0);
-  auto phiHeating = 10 * (actualHeatingSetpoint - tiPhi0) / (tiPhi10 - tiPhi0);
-  auto phiActual = std::max(0.0, phiHeating) + std::min(phiCooling, 0.0);
-  results.Qneed_cl = std::max(0.0, -phiActual); // Raw need. Not adjusted for efficiency.
-  results.Qneed_ht = std::max(0.0, phiActual); // Raw need. Not adjusted for efficiency.
+  // Denominator and old-state part of \theta_{m,t}, ISO 13790 C.3 eq. C.4.
+  auto tmtDenominator = Cm / 3.6 + 0.5 * (h3 + hem);
+  auto tmtCarried = TMT1 * (Cm / 3.6 - 0.5 * (h3 + hem));
+
+  T tiPhi0, tiPhi10, phiActual;
+  // This hour's \theta_{m,t} and \theta_{air}, which become next hour's
+  // TMT1 and tiHeatCool.
+  T tmtHeatCool, tiHeatCoolNext;
+  if (flags.affineSolver()) {
+    // Every node temperature is affine in the heating/cooling power delivered
+    // to the air node, so solve the free-floating state once along with the
+    // slopes of \theta_{m,t} and \theta_{air} and get the \Phi = 10 and
+    // actual-power states from those rather than repeating eqs. C.4-C.11.
+    // \Phi_{mtot}, ISO 13790 C.3 eq. C.5.
+    auto phimTotalPhi0 = phimPhi0 + hem * temperature
+         + h3 * (phisPhi0 + hwindowWperkm2 * temperature + h1 * (phii / hei + tEnteringAndSupplied)) / h2;
+    // \theta_{m,t}, ISO 13790 C.3 eq. C.4.
+    auto tmt1Phi0 = (tmtCarried + phimTotalPhi0) / tmtDenominator;
+    auto tmPhi0 = 0.5 * (TMT1 + tmt1Phi0);
+    auto tsPhi0 = (H_ms * tmPhi0 + phisPhi0 + hwindowWperkm2 * temperature + h1 * (tEnteringAndSupplied + phii / hei)) / (H_ms + hwindowWperkm2 + h1);
+    tiPhi0 = (H_tris * tsPhi0 + hei * tEnteringAndSupplied + phii) / (H_tris + hei);
+    // Derivatives with respect to the power delivered to the air node of
+    // eqs. C.5/C.4, C.10 and C.11.
+    auto dtmt = h3 * h1 / (hei * h2) / tmtDenominator;
+    auto dts = (H_ms * 0.5 * dtmt + h1 / hei) / (H_ms + hwindowWperkm2 + h1);
+    auto dti = (H_tris * dts + 1) / (H_tris + hei);
+    tiPhi10 = tiPhi0 + 10 * dti;
+    auto phiCooling = (actualCoolingSetpoint - tiPhi0) / dti;
+    auto phiHeating = (actualHeatingSetpoint - tiPhi0) / dti;
+    phiActual = std::max<T>(0.0, phiHeating) + std::min<T>(phiCooling, 0.0);
+    tmtHeatCool = tmt1Phi0 + phiActual * dtmt;
+    tiHeatCoolNext = tiPhi0 + phiActual * dti;
+  } else {
+    // Reference formulation: evaluate the full chain for \Phi = 0, for
+    // \Phi = 10 and for the actual power.
+    // \Phi_{mtot}, ISO 13790 C.3 eq. C.5.
+    auto phimTotalPhi10 = phimPhi0 + hem * temperature
+         + h3 * (phisPhi0 + hwindowWperkm2 * temperature + h1 * (phii10 / hei + tEnteringAndSupplied)) / h2;
+    auto phimTotalPhi0 = phimPhi0 + hem * temperature
+         + h3 * (phisPhi0 + hwindowWperkm2 * temperature + h1 * (phii / hei + tEnteringAndSupplied)) / h2;
+        // \theta_{m,t10}, ISO 13790 C.3 eq. C.4.
+    auto tmt1Phi10 = (tmtCarried + phimTotalPhi10) / tmtDenominator;
+    auto tmPhi10 = 0.5 * (TMT1 + tmt1Phi10);
+    auto tsPhi10 = (H_ms * tmPhi10 + phisPhi0 + hwindowWperkm2 * temperature + h1 * (tEnteringAndSupplied + phii10 / hei))
+         / (H_ms + hwindowWperkm2 + h1);
+    //ExcelFunctions.printOut("BA156",tsPhi10,19.8762155145252);
+    tiPhi10 = (H_tris * tsPhi10 + hei * tEnteringAndSupplied + phii10) / (H_tris + hei);
+    // \theta_{m,t}, ISO 13790 C.3 eq. C.4.
+    auto tmt1Phi0 = (tmtCarried + phimTotalPhi0) / tmtDenominator;
+    auto tmPhi0 = 0.5 * (TMT1 + tmt1Phi0);
+    auto tsPhi0 = (H_ms * tmPhi0 + phisPhi0 + hwindowWperkm2 * temperature + h1 * (tEnteringAndSupplied + phii / hei)) / (H_ms + hwindowWperkm2 + h1);
+    tiPhi0 = (H_tris * tsPhi0 + hei * tEnteringAndSupplied + phii) / (H_tris + hei);
+    auto phiCooling = 10 * (actualCoolingSetpoint - tiPhi0) / (tiPhi10 - tiPhi0);
+    auto phiHeating = 10 * (actualHeatingSetpoint - tiPhi0) / (tiPhi10 - tiPhi0);
+    phiActual = std::max<T>(0.0, phiHeating) + std::min<T>(phiCooling, 0.0);
+
+    auto phiiHeatCool = phiActual + phii;
+    // \Phi_{mtot} ISO 13790 C.3 eq. C.5
+    auto phimHeatCoolTotal = phimPhi0 + hem * temperature
+         + h3 * (phisPhi0 + hwindowWperkm2 * temperature + h1 * (phiiHeatCool / hei + tEnteringAndSupplied)) / h2;
+    // \theta_{m,t}, ISO 13790 C.3 eq. C.4.
+    tmtHeatCool = (tmtCarried + phimHeatCoolTotal) / tmtDenominator;
+    // \theta_{m}, ISO 13790 C.3 eq. C.9.
+    auto tmHeatCool = 0.5 * (tmtHeatCool + TMT1);
+    // \theta_{s}, ISO 13790 C.3 eq. C.10.
+    auto tsHeatCool = (H_ms * tmHeatCool + phisPhi0 + hwindowWperkm2 * temperature + h1 * (tEnteringAndSupplied + phiiHeatCool / hei))
+                      / (H_ms + hwindowWperkm2 + h1);
+    // \theta_{air}, ISO 13790, C.3 eq. C.11.
+    tiHeatCoolNext = (H_tris * tsHeatCool + hei * tEnteringAndSupplied + phiiHeatCool) / (H_tris + hei);
+  }
+  results.Qneed_cl = std::max<T>(0.0, -phiActual); // Raw need. Not adjusted for efficiency.
+  results.Qneed_ht = std::max<T>(0.0, phiActual); // Raw need. Not adjusted for efficiency.
   
   // Fan power
   auto T_sup_ht = heating.temperatureSetPointOccupied() + heating.dT_supp_ht(); //%hot air supply temp  - assume supply air is 7C hotter than room
   auto T_sup_cl = cooling.temperatureSetPointOccupied() - cooling.dT_supp_cl(); //%cool air supply temp - assume 7C lower than room
 
   // XXX In the unlikely event that (T_sup_ht - TMT1) * n_rhoC_a was equal to -DBL_MIN, would this divide by zero? - BAA@2015-02-18.
-  auto Vair_ht = heating.forcedAirHeating() ? results.Qneed_ht / (((T_sup_ht - tiHeatCool) * phys.rhoCpAir()*277.777778) + DBL_MIN) : 0.0;
-  auto Vair_cl = cooling.forcedAirCooling() ? results.Qneed_cl / (((tiHeatCool - T_sup_cl) * phys.rhoCpAir()*277.777778) + DBL_MIN) : 0.0;
+  auto Vair_ht = flags.forcedAirHeating() ? results.Qneed_ht / (((T_sup_ht - tiHeatCool) * phys.rhoCpAir()*277.777778) + DBL_MIN) : 0.0;
+  auto Vair_cl = flags.forcedAirCooling() ? results.Qneed_cl / (((tiHeatCool - T_sup_cl) * phys.rhoCpAir()*277.777778) + DBL_MIN) : 0.0;
 
   auto Vair_tot = std::max((Vair_ht + Vair_cl), ventExhaustM3phpm2);
 
@@ -351,39 +1356,35 @@ void HourlyModel::calculateHour(int hourOfYear,
     results.Qpump_tot = 0.0;
   }
 
-  if (solarRadiation[8] > 0) { // Check roof radiation to see if sun is up.
-    results.Q_illum_ext_tot = 0; // No exterior lights during the day.
-  } else {
-    results.Q_illum_ext_tot = lights.exteriorEnergy() * exteriorLightingEnabled / structure.floorArea();
-    //ExcelFunctions.printOut("CS156",exteriorLightingEnergyWperm2,0.0539503346043362);
-  }
-
-  results.Q_dhw = 0; //TODO no DHW calculations
-
   // Update tiHeatCool & TMT1 for next hour. tiHeatCool and TMT1 are passed by
   // reference to the function, allowing this information to pass from hour to
   // hour.
-  auto phiiHeatCool = phiActual + phii;
-  // \Phi_{mtot} ISO 13790 C.3 eq. C.5
-  auto phimHeatCoolTotal = phimPhi0 + hem * temperature
-       + h3 * (phisPhi0 + hwindowWperkm2 * temperature + h1 * (phiiHeatCool / hei + tEnteringAndSupplied)) / h2;
-  // Set tmt to this hour's \theta_{m,t-1}.
-  auto tmt = TMT1;
-  // \theta_{m,t}, ISO 13790 C.3 eq. C.4.
-  // Set TMT1 to next hour's \theta_{m,t-1} (this hour's \theta_{m,t}).
-  TMT1 = (TMT1 * (Cm / 3.6 - 0.5 * (h3 + hem)) + phimHeatCoolTotal) / (Cm / 3.6 + 0.5 * (h3 + hem));
-  // \theta_{m}, ISO 13790 C.3 eq. C.9.
-  auto tmHeatCool = 0.5 * (TMT1 + tmt);
-  // \theta_{s}, ISO 13790 C.3 eq. C.10.
-  auto tsHeatCool = (H_ms * tmHeatCool + phisPhi0 + hwindowWperkm2 * temperature + h1 * (tEnteringAndSupplied + phiiHeatCool / hei))
-                    / (H_ms + hwindowWperkm2 + h1);
-  // \theta_{air}, ISO 13790, C.3 eq. C.11.
-  tiHeatCool = (H_tris * tsHeatCool + hei * tEnteringAndSupplied + phiiHeatCool) / (H_tris + hei);
-
+  TMT1 = tmtHeatCool;
+  tiHeatCool = tiHeatCoolNext;
+
+  if (flags.traced()) {
+    trace->record("hourOfYear", hourOfYear);
+    trace->record("temperature", temperature);
+    trace->record("windMps", windMps);
+    trace->record("phi_int", scalarValue(phi_int));
+    trace->record("qSolarHeatGain", scalarValue(qSolarHeatGain));
+    trace->record("phii", scalarValue(phii));
+    trace->record("hei", scalarValue(hei));
+    trace->record("h1", scalarValue(h1));
+    trace->record("h2", scalarValue(h2));
+    trace->record("h3", scalarValue(h3));
+    trace->record("tEnteringAndSupplied", scalarValue(tEnteringAndSupplied));
+    trace->record("tiPhi0", scalarValue(tiPhi0));
+    trace->record("tiPhi10", scalarValue(tiPhi10));
+    trace->record("phiActual", scalarValue(phiActual));
+    trace->record("TMT1", scalarValue(TMT1));
+    trace->record("ti", scalarValue(tiHeatCool));
+  }
 }
 
 
-void HourlyModel::initialize()
+template<typename T>
+void BasicHourlyModel<T>::initialize()
 {
 
   // TODO BAA@2014-12-22: This is still pretty rough and needs ought to be confirmed to be working correctly.
@@ -404,7 +1405,7 @@ void HourlyModel::initialize()
     elightNatural = lights.manualSwitchLux();
   }
 
-  areaNaturallyLighted = std::max(0.0001, lights.naturallyLightedArea());
+  areaNaturallyLighted = std::max<T>(0.0001, lights.naturallyLightedArea());
   areaNaturallyLightedRatio = areaNaturallyLighted / structure.floorArea();
 
   for (auto i = 0; i != 9; ++i) {
@@ -418,13 +1419,13 @@ void HourlyModel::initialize()
                           structure.windowNormalIncidenceSolarEnergyTransmittance()[i],
                           i);
 
-    nlaWMovableShading.push_back(nlams[i] / structure.floorArea());
-    naturalLightRatio.push_back(nla[i] / structure.floorArea());
-    naturalLightShadeRatioReduction.push_back(nlaWMovableShading[i] - naturalLightRatio[i]);
+    nlaWMovableShading[i] = nlams[i] / structure.floorArea();
+    naturalLightRatio[i] = nla[i] / structure.floorArea();
+    naturalLightShadeRatioReduction[i] = nlaWMovableShading[i] - naturalLightRatio[i];
 
-    saWMovableShading.push_back(sams[i] / structure.floorArea());
-    solarRatio.push_back(sa[i] / structure.floorArea());
-    solarShadeRatioReduction.push_back(saWMovableShading[i] - solarRatio[i]);
+    saWMovableShading[i] = sams[i] / structure.floorArea();
+    solarRatio[i] = sa[i] / structure.floorArea();
+    solarShadeRatioReduction[i] = saWMovableShading[i] - solarRatio[i];
   }
 
   shadingUsePerWPerM2 = structure.shadingFactorAtMaxUse() / structure.irradianceForMaxShadingUse();
@@ -433,7 +1434,7 @@ void HourlyModel::initialize()
   // Total air leakage at 4Pa in m3/hr. ISO 15242 Annex D Table D.1.
   auto buildingv8 = 0.19 * (ventilation.n50() * (structure.floorArea() * structure.buildingHeight()));
   // Air leakage per area at 4Pa (m3/hr/m2).
-  q4Pa = std::max(0.000001, buildingv8 / structure.floorArea());
+  q4Pa = std::max<T>(0.000001, buildingv8 / structure.floorArea());
 
   // ISO 13790 12.2.2: h_ms is fixed at 9.1 W/(m^2*K).
   h_ms = simSettings.hci() + simSettings.hri() * 1.2; 
@@ -462,8 +1463,8 @@ void HourlyModel::initialize()
     Am = 2.5;
   }
 
-  auto hWind = 0.0;
-  auto hWall = 0.0;
+  T hWind = 0.0;
+  T hWall = 0.0;
 
   for (auto i = 0; i != 9; ++i) {
     hWind += hWindow[i];
@@ -488,21 +1489,22 @@ void HourlyModel::initialize()
   // ISO 13790 12.2.2 eq. 64
   H_ms = h_ms * Am;
 
-  hOpaqueWperkm2 = std::max(hWall / structure.floorArea(), 0.000001);
+  hOpaqueWperkm2 = std::max<T>(hWall / structure.floorArea(), 0.000001);
 
   // ISO 13790 12.2.2 eq. 63
   hem = 1 / (1 / hOpaqueWperkm2 - 1 / H_ms);
 
-  windImpactHz = std::max(0.1, ventilation.hzone());
-  windImpactSupplyRatio = std::max(0.00001, ventilation.fanControlFactor()); //TODO ventSupplyExhaustRatio = SingleBuilding.P40 ?
+  windImpactHz = std::max<T>(0.1, ventilation.hzone());
+  windImpactSupplyRatio = std::max<T>(0.00001, ventilation.fanControlFactor()); //TODO ventSupplyExhaustRatio = SingleBuilding.P40 ?
 }
 
-void HourlyModel::populateSchedules()
+template<typename T>
+void BasicHourlyModel<T>::populateSchedules()
 {
-  auto dayStart = (int) pop.daysStart();
-  auto dayEnd = (int) pop.daysEnd();
-  auto hourStart = (int) pop.hoursStart();
-  auto hourEnd = (int) pop.hoursEnd();
+  auto dayStart = static_cast<int>(scalarValue(pop.daysStart()));
+  auto dayEnd = static_cast<int>(scalarValue(pop.daysEnd()));
+  auto hourStart = static_cast<int>(scalarValue(pop.hoursStart()));
+  auto hourEnd = static_cast<int>(scalarValue(pop.hoursEnd()));
 
   bool hoccupied, doccupied, popoccupied;
   for (auto h = 0; h < 24; ++h) {
@@ -530,17 +1532,18 @@ void HourlyModel::populateSchedules()
   }
 }
 
-void HourlyModel::structureCalculations(double SHGC,
-                           double wallAreaM2,
-                           double windowAreaM2,
-                           double wallUValue,
-                           double windowUValue,
-                           double wallSolarAbsorption,
-                           double solarFactorWith,
-                           double solarFactorWithout,
+template<typename T>
+void BasicHourlyModel<T>::structureCalculations(T SHGC,
+                           T wallAreaM2,
+                           T windowAreaM2,
+                           T wallUValue,
+                           T windowUValue,
+                           T wallSolarAbsorption,
+                           T solarFactorWith,
+                           T solarFactorWithout,
                            int direction)
 {
-  double WindowT = SHGC / 0.87;
+  T WindowT = SHGC / 0.87;
   nlams[direction] = windowAreaM2 * WindowT; // Natural lighted area movable shade.
   nla[direction] = windowAreaM2 * WindowT; // Natural lighted area.
   sams[direction] = wallAreaM2 * (wallSolarAbsorption * wallUValue * structure.R_se()) + windowAreaM2 * solarFactorWith;
@@ -549,27 +1552,8 @@ void HourlyModel::structureCalculations(double SHGC,
   hWindow[direction] = windowAreaM2 * windowUValue;
 }
 
-// TODO BAA@2015-01-28 Is there a better place to keep these debug functions?
-void printMatrix(const char* matName, double* mat, unsigned int dim1, unsigned int dim2)
-{
-  if(DEBUG_ISO_MODEL_SIMULATION)
-  {
-    std::cout << matName << "(" << dim1 << ", " << dim2 << "): " << std::endl << "\t";
-    for (unsigned int j = 0; j < dim2; j++) {
-      std::cout << "," << j;
-    }
-    std::cout << std::endl;
-    for (unsigned int i = 0; i < dim1; ++i) {
-      std::cout << "\t" << i;
-      for (unsigned int j = 0; j < dim2; j++) {
-        std::cout << "," << mat[i * dim2 + j];
-      }
-      std::cout << std::endl;
-    }
-  }
-}
-
-std::vector<double> HourlyModel::sumHoursByMonth(const std::vector<double>& hourlyData)
+template<typename T>
+std::vector<double> BasicHourlyModel<T>::sumHoursByMonth(const std::vector<double>& hourlyData)
 {
   std::vector<double> monthlyData(12);
   std::vector<int> monthsInHours = { 0, 744, 1416, 2160, 2880, 3624, 4344, 5088, 5832, 6552, 7296, 8016, 8760 };
@@ -594,5 +1578,8 @@ std::vector<double> HourlyModel::sumHoursByMonth(const std::vector<double>& hour
 // const int HourlyModel::SOUTHWEST = 7;
 // const int HourlyModel::ROOF = 8;
 
+
+template class ISOMODEL_API BasicHourlyModel<double>;
+template std::vector<GradientDual> BasicHourlyModel<GradientDual>::annualEndUses();
 }
 }
@@ -8,6 +8,7 @@
 #ifndef ISOMODEL_HOURLYMODEL_HPP
 #define ISOMODEL_HOURLYMODEL_HPP
 
+#include "Cancellation.hpp"
 #include "ISOModelAPI.hpp"
 
 #include "ISOResults.hpp"
@@ -15,6 +16,7 @@
 #include "TimeFrame.hpp"
 #include "MonthlyModel.hpp"
 
+#include <cstddef>
 #include <memory>
 #include <map>
 #include <string>
@@ -25,6 +27,8 @@
 #include <iterator>
 #include <map>
 
+#include <boost/optional.hpp>
+
 #ifdef ISOMODEL_STANDALONE
 #include "EndUses.hpp"
 #include "Vector.hpp"
@@ -51,14 +55,170 @@ struct HourResults
   T Q_dhw;
 };
 
-class ISOMODEL_API HourlyModel : public Simulation
+// Values that replace a model's weekly schedules for one hour.
+struct ScheduleOverrides
+{
+  boost::optional<double> ventilation; // Supply rate (L/s).
+  boost::optional<double> exteriorEquipment; // W.
+  boost::optional<double> interiorEquipment; // W/m2.
+  boost::optional<double> exteriorLighting; // Fraction on.
+  boost::optional<double> interiorLighting; // W/m2.
+  boost::optional<double> heatingSetpoint; // C.
+  boost::optional<double> coolingSetpoint; // C.
+};
+
+// Calendar, weather and schedule inputs to the hour loop for a whole year.
+struct HourlyInputs
+{
+  TimeFrame frame;
+  std::vector<double> wind;
+  std::vector<double> temperature;
+  std::vector<std::vector<double> > radiation; // For each hour, the 8 wall directions then the roof.
+  // Overrides of the weekly schedules for particular hours (0 based), e.g. a
+  // summer-only setpoint change. Empty unless a caller adds some.
+  std::map<int, ScheduleOverrides> scheduleOverrides;
+};
+
+// The thermal state and results of an hourly run, saved so that
+// HourlyModel::resimulate() can rerun only the hours affected by a change.
+struct HourlyCheckpoints
+{
+  int interval = 168; // Hours between checkpoints.
+  // The state (TMT1, tiHeatCool) at the start of hour k * interval.
+  std::vector<double> TMT1;
+  std::vector<double> tiHeatCool;
+  // The raw results of every hour.
+  HourResults<std::vector<double> > results;
+  // The weather and schedule overrides the run used. Pass an edited copy to
+  // resimulate() to rerun a change to them.
+  std::shared_ptr<const HourlyInputs> inputs;
+  // Hours calculated by the run that last updated the checkpoints.
+  int simulatedHours = 0;
+};
+
+// One hour of inputs to HourlyModel::step(). The inherited overrides
+// replace the model's weekly schedules for this hour.
+struct HourInput : ScheduleOverrides
+{
+  int hourOfDay = 0; // 0 to 23.
+  int dayOfWeek = 0; // 0 to 6, as in TimeFrame::DayOfWeek.
+  double temperature = 0.0; // Outdoor dry bulb temperature (C).
+  double windMps = 0.0;
+  // Irradiance (W/m2) on the N, NE, E, SE, S, SW, W and NW walls and the roof.
+  double solarRadiation[9] = {};
+};
+
+// One hour's end uses (kWh/m2) from HourlyModel::step(), indexed like the
+// standalone EndUses.
+struct HourEndUses
+{
+  double values[13] = {};
+
+  double getEndUse(int use) const {
+    return values[use];
+  }
+};
+
+// The state HourlyModel::step() carries from one hour to the next. It's a
+// small value, so forecasts can branch from it by copying.
+struct HourlyState
+{
+  double TMT1 = 20.0; // \theta_{m,t} (C).
+  double tiHeatCool = 20.0; // \theta_{air} (C).
+  // Raw heating and cooling needs (Wh/m2) so far. Their ratio sets the
+  // distribution efficiencies.
+  double heatingNeed = 0.0;
+  double coolingNeed = 0.0;
+  int hours = 0; // Hours stepped.
+  HourEndUses totals; // End uses (kWh/m2) since the state was created or forked.
+
+  /** Returns a copy to branch a forecast from, with the end use totals cleared. */
+  HourlyState fork() const {
+    HourlyState branch = *this;
+    branch.totals = HourEndUses();
+    return branch;
+  }
+};
+
+// Settings for HourlyModel::simulateParareal().
+struct PararealSettings
+{
+  // Worker threads for the fine sweeps, or 0 for one per hardware thread.
+  std::size_t threads = 0;
+  // Maximum number of fine sweeps. With one segment per month the boundary
+  // states are exact after 12, so the default always converges.
+  int maxIterations = 12;
+  // Largest jump (C) allowed in TMT1 or tiHeatCool where one segment's fine
+  // solution meets the next segment's starting state.
+  double tolerance = 1e-4;
+  // Hours the coarse propagator runs at the end of each segment.
+  int coarseWindowHours = 72;
+};
+
+// What happened during HourlyModel::simulateParareal().
+struct PararealReport
+{
+  int iterations = 0; // Fine sweeps run.
+  int segmentRuns = 0; // Segments run over all the fine sweeps.
+  bool converged = false;
+  double maxJump = 0.0; // Largest boundary jump (C) in the last fine sweep.
+  double wallSeconds = 0.0; // Time spent in the hour loops, excluding preparing the inputs.
+  double sequentialSeconds = 0.0; // Sum of the latest time of each segment.
+  double speedup = 0.0; // sequentialSeconds / wallSeconds.
+};
+
+// Settings for HourlyModel::simulateRepresentativeDays().
+struct RepresentativeDaySettings
+{
+  // Representative days to simulate, shared out between the day types. At
+  // least one per day type.
+  int days = 16;
+  // Days simulated before each representative day, from the end state of the
+  // one before it, to settle the building's thermal state.
+  int warmupDays = 1;
+  // Also run the full year with simulate() and report the error.
+  bool compare = false;
+  // For each day of the year (0 to 364), the day that represents it, e.g. a
+  // previous report's representatives, to skip the clustering. The weather
+  // and schedules decide the clusters, so a sweep over other parameters can
+  // cluster once. Replaces days if set.
+  std::vector<int> representatives;
+};
+
+// What happened during HourlyModel::simulateRepresentativeDays().
+struct RepresentativeDayReport
+{
+  std::vector<int> days; // The representative days (0 to 364), in the order of the year.
+  std::vector<int> weights; // The number of days of the year each stands for.
+  std::vector<int> representatives; // For each day of the year, the day that represents it.
+  int dayTypes = 0; // Groups of days of the week with the same schedules.
+  int simulatedHours = 0; // Including the warm-up.
+  double hourSpeedup = 0.0; // TIMESLICES / simulatedHours.
+  double wallSeconds = 0.0; // Time spent clustering, simulating and reconstructing, excluding preparing the inputs.
+
+  // Filled in if settings.compare is set.
+  bool compared = false;
+  double fullSeconds = 0.0; // Time the full year took, likewise.
+  double speedup = 0.0; // fullSeconds / wallSeconds.
+  std::vector<double> annualError; // Approximate minus full yearly total (kWh/m2) of each end use.
+  double totalError = 0.0; // Relative error of the yearly total of all end uses.
+  double monthlyRmse = 0.0; // RMS error (kWh/m2) of each month's total of all end uses.
+  double maxMonthlyError = 0.0; // Largest relative error of a month's total of all end uses.
+};
+
+/**
+ * The ISO 13790 simple hourly method. T is the scalar type of the parameters
+ * and calculations (see BasicSimulation). The weather stays double.
+ */
+template<typename T>
+class BasicHourlyModel : public BasicSimulation<T>
 {
 public:
   /**
    * Creates an empty HourlyModel. Generally, the HourlyModel should be created using the UserModel::toHourlyModel() method.
    */
-  HourlyModel();
-  virtual ~HourlyModel();
+  BasicHourlyModel() {}
+  virtual ~BasicHourlyModel() {}
 
   /** 
    * Calculates the building's hourly EUI using the "simple hourly method"
@@ -71,6 +231,204 @@ public:
    */
   std::vector<EndUses> simulate(bool aggregateByMonth = false);
 
+  /**
+   * Runs the same calculations as simulate() and returns the yearly total of
+   * each end use (kWh/m2), in the order of the standalone EndUses. Unlike
+   * simulate(), this works for any scalar type, which is how
+   * UserModel::gradient() differentiates the results. Tracing is ignored.
+   */
+  std::vector<T> annualEndUses();
+
+  /**
+   * Gives the same results as simulate() and saves the thermal state every
+   * interval hours, along with the raw results of every hour, in checkpoints.
+   */
+  std::vector<EndUses> simulate(bool aggregateByMonth, HourlyCheckpoints& checkpoints, int interval = 168);
+
+  /**
+   * Reruns the simulation saved in checkpoints after a change that only
+   * affects hours firstChangedHour to lastChangedHour (0 based, inclusive),
+   * such as a change to the weather or schedule overrides in
+   * checkpoints.inputs. Parameter changes
+   * apply to the whole year, so pass 0 and TIMESLICES - 1 after one. The run
+   * resumes from the last checkpoint at or before firstChangedHour and reuses
+   * the saved results of the earlier hours. If convergenceTolerance is not
+   * negative, it also stops at the first checkpoint after lastChangedHour
+   * where the state is within convergenceTolerance (C) of the saved state,
+   * and reuses the saved results from there to the end of the year. The
+   * checkpoints are updated to describe the new run, so changes can be
+   * chained.
+   */
+  std::vector<EndUses> resimulate(bool aggregateByMonth,
+                                  HourlyCheckpoints& checkpoints,
+                                  int firstChangedHour,
+                                  int lastChangedHour = TIMESLICES - 1,
+                                  double convergenceTolerance = -1.0);
+
+  /**
+   * Reruns the simulation saved in checkpoints with new inputs, typically an
+   * edited copy of checkpoints.inputs, from the first hour where their
+   * weather or schedule overrides differ from the saved inputs, so a
+   * late-year change only reruns the late hours. Otherwise as resimulate()
+   * above, with the changed hours found by comparing the inputs.
+   */
+  std::vector<EndUses> resimulate(bool aggregateByMonth,
+                                  HourlyCheckpoints& checkpoints,
+                                  std::shared_ptr<const HourlyInputs> inputs,
+                                  double convergenceTolerance = -1.0);
+
+  /**
+   * Prepares the model to be run an hour at a time with step(), for example
+   * from live data: populates the schedules, initializes the coefficients,
+   * selects the kernel and resets the state. Call it again after changing
+   * the parameters.
+   */
+  void prepareSteps();
+
+  /**
+   * Calculates one hour from input, advances the state and returns the
+   * hour's end uses. Doesn't allocate and doesn't need a weather file. The
+   * distribution efficiencies come from the heating and cooling needs
+   * accumulated in the state rather than the yearly totals simulate() uses,
+   * so seed those with a previous year's needs to reproduce simulate().
+   */
+  HourEndUses step(const HourInput& input);
+
+  /**
+   * Steps a batch of branches, e.g. states forked for model predictive
+   * control, through the same hour. All branches share input's weather and
+   * schedules, so the gains are calculated once for the batch, but each
+   * branch's thermal state is still solved on its own, one after another:
+   * K branches cost about K times two thirds of a step() (about 180 ns a
+   * branch against 290 ns for step() in the benchmark), not one step().
+   * Branch k has the state states[k] and the setpoints heatingSetpoints[k]
+   * and coolingSetpoints[k] (or those of input if the array is null), and
+   * gets the end uses results[k]. Doesn't use or change the model's state.
+   * Throws std::invalid_argument unless the states have all stepped the same
+   * number of hours.
+   */
+  void stepBranches(const HourInput& input,
+                    const double* heatingSetpoints,
+                    const double* coolingSetpoints,
+                    HourlyState* states,
+                    HourEndUses* results,
+                    std::size_t branches);
+
+  const HourlyState& state() const {
+    return stepState;
+  }
+
+  void setState(const HourlyState& value) {
+    stepState = value;
+  }
+
+  /**
+   * Gives the same results as simulate(), to within settings.tolerance, using
+   * the Parareal method to spread the year over several threads. The year is
+   * split into one segment per month. A coarse propagator estimates the
+   * thermal state (TMT1, tiHeatCool) at the start of each segment, the full
+   * hourly calculation is then run for all the segments in parallel, and the
+   * estimates are corrected until the end of each segment meets the start of
+   * the next. Each sweep settles one more segment for good, so later sweeps
+   * only rerun the segments after it. The coarse propagator runs the hourly
+   * calculation over just the last settings.coarseWindowHours of a segment,
+   * which is cheap and accurate because the building forgets its starting
+   * state within a few days.
+   * Tracing is ignored. If report is given it receives the number of
+   * iterations and the speedup over running the segments one after another.
+   */
+  std::vector<EndUses> simulateParareal(bool aggregateByMonth = false,
+                                        const PararealSettings& settings = PararealSettings(),
+                                        PararealReport* report = nullptr);
+
+  /**
+   * Approximates simulate() by simulating a few representative days of the
+   * year, for early design sweeps where a 10 to 30 times faster run is worth
+   * a few percent of error. The days of the week are grouped into day types
+   * with the same weekly schedules, and the days of each type are clustered
+   * by k-medoids on their hourly dry bulb temperature and horizontal
+   * irradiance profiles, each normalized by its spread over the year. Each
+   * type gets a share of settings.days in proportion to its number of days.
+   * The medoids are simulated in the order of the year, each after
+   * settings.warmupDays of its own days before it, starting from where the
+   * previous one ended. Every day of the year then takes its representative's
+   * raw hourly results, which are factored by the distribution efficiencies
+   * as in simulate(), so the hourly results are approximate too. Day types
+   * come from the weekly schedules, so models whose schedules vary through
+   * the year are approximated less well. Tracing is ignored. If report is
+   * given it receives the clusters, the hours simulated and, if
+   * settings.compare is set, the error against simulate(). Throws
+   * std::invalid_argument if settings.days is fewer than the day types or
+   * more than the days of the year, or settings.representatives is malformed.
+   */
+  std::vector<EndUses> simulateRepresentativeDays(bool aggregateByMonth = false,
+                                                  const RepresentativeDaySettings& settings = RepresentativeDaySettings(),
+                                                  RepresentativeDayReport* report = nullptr);
+
+  /**
+   * Selects whether simulate() runs an hourly kernel specialized at compile
+   * time for the run's configuration flags (forced air heating and cooling,
+   * exterior lighting), which is the default, or the generic kernel that tests
+   * the flags every hour. Both give bit-for-bit identical results. The generic
+   * kernel is always used while a trace is attached or the reference solver is
+   * selected.
+   */
+  void setSpecializedKernels(bool value) {
+    useSpecializedKernels = value;
+  }
+
+  bool specializedKernels() const {
+    return useSpecializedKernels;
+  }
+
+  /**
+   * Selects how each hour's 5R1C node temperatures are solved. The affine
+   * solver (the default) solves the free-floating state once together with
+   * its slope with respect to the heating/cooling power and gets the actual
+   * state in closed form. The reference solver evaluates the full ISO 13790
+   * C.3 chain for 0 W/m2, 10 W/m2 and the actual power, as the standard
+   * describes. The two agree to rounding error.
+   */
+  void setAffineSolver(bool value) {
+    useAffineSolver = value;
+  }
+
+  bool affineSolver() const {
+    return useAffineSolver;
+  }
+
+  /**
+   * Sets the hourly irradiance on the 8 walls (W/m2, a row per hour with the
+   * directions in the order of SolarRadiation) to use instead of calculating
+   * it from the weather file, e.g. one taken from an IrradianceCache for a
+   * rotated building. Pass an empty pointer to calculate it (the default).
+   */
+  void setWallIrradiance(std::shared_ptr<const std::vector<std::vector<double> > > value) {
+    wallIrradiance = value;
+  }
+
+  /**
+   * Makes the simulations poll token every interval hours and throw
+   * SimulationCancelled, with the number of hours completed, once it is
+   * cancelled. Polling costs an atomic load (and a clock read if the token
+   * has a deadline), so the default of once a simulated day is free in
+   * practice. Copies of the model share the token.
+   */
+  void setCancellation(const CancellationToken& token, int interval = 24);
+
+protected:
+  using BasicSimulation<T>::pop;
+  using BasicSimulation<T>::lights;
+  using BasicSimulation<T>::building;
+  using BasicSimulation<T>::structure;
+  using BasicSimulation<T>::heating;
+  using BasicSimulation<T>::cooling;
+  using BasicSimulation<T>::ventilation;
+  using BasicSimulation<T>::epwData;
+  using BasicSimulation<T>::phys;
+  using BasicSimulation<T>::simSettings;
+  using BasicSimulation<T>::trace;
+
 private:
   /**
    * Populates the ventilation, fan, exterior equipment, interior equipment,
@@ -81,6 +439,115 @@ private:
 
   void initialize();
 
+  /**
+   * Populates the schedules, initializes the coefficients and prepares the
+   * weather inputs for a run.
+   */
+  void prepare(HourlyInputs& inputs);
+
+  /** Populates the schedules and initializes the coefficients. */
+  void prepareCoefficients();
+
+  /** Records one of the weekly schedules in the trace. */
+  void traceSchedule(const char* name, const T (&schedule)[24][7]);
+
+  /**
+   * Returns the kernel for the run's configuration flags: -1 for the generic
+   * kernel or the FixedHourFlags bits (heating 4, cooling 2, exterior
+   * lighting 1) for a specialized one.
+   */
+  int kernel(bool traced) const;
+
+  // The schedule values for one hour.
+  struct HourSchedules
+  {
+    T ventilation;
+    T exteriorEquipment;
+    T interiorEquipment;
+    T exteriorLighting;
+    T interiorLighting;
+    T heatingSetpoint;
+    T coolingSetpoint;
+  };
+
+  /** Looks up the schedules for an hour. */
+  HourSchedules schedules(int hourOfYear, int hourOfDay, int dayOfWeek);
+
+  // The parts of an hour's calculation that don't depend on the thermal state
+  // or the setpoints.
+  struct HourGains
+  {
+    T ventExhaustM3phpm2;
+    T phi_int; // \Phi_{int}.
+    T qSolarHeatGain; // \Phi_{sol}.
+    T phii; // \Phi_{ia}.
+    T qSupplyBySystem;
+    T exhaustSupply;
+    T tSuppliedAir;
+    T qWind;
+    T phisPhi0; // \Phi_{st}.
+    T phimPhi0; // \Phi_{m}.
+  };
+
+  /**
+   * The body of stepBranches() for one kernel: calculates the shared gains
+   * once and the state for each branch.
+   */
+  template<typename Flags>
+  void stepLanes(const HourInput& input,
+                 const HourSchedules& hourSchedules,
+                 const double* heatingSetpoints,
+                 const double* coolingSetpoints,
+                 HourlyState* states,
+                 HourEndUses* results,
+                 std::size_t branches,
+                 const Flags& flags);
+
+  /**
+   * Adds an hour's raw results to state and converts them to end uses with
+   * the distribution efficiencies from the needs so far.
+   */
+  void accumulateHour(const HourResults<double>& hourResults, HourlyState& state, HourEndUses& hourEndUses);
+
+  /** Sizes each of the result vectors to hold every hour of the year. */
+  void resizeResults(HourResults<std::vector<T> >& rawResults);
+
+  /**
+   * Runs calculateHour() for hours [firstHour, lastHour), starting from and
+   * updating the thermal state in TMT1 and tiHeatCool, and stores each hour's
+   * results in rawResults. Selects the kernel for the run's configuration
+   * flags (see setSpecializedKernels()).
+   */
+  void calculateHours(const HourlyInputs& inputs,
+                      int firstHour,
+                      int lastHour,
+                      T& TMT1,
+                      T& tiHeatCool,
+                      HourResults<std::vector<T> >& rawResults,
+                      bool traced);
+
+  /**
+   * The hour loop for one kernel. Flags supplies the configuration that is
+   * fixed for the whole run, either as run-time values or as compile-time
+   * constants (see HourlyModel.cpp).
+   */
+  template<typename Flags>
+  void calculateHours(const HourlyInputs& inputs,
+                      int firstHour,
+                      int lastHour,
+                      T& TMT1,
+                      T& tiHeatCool,
+                      HourResults<std::vector<T> >& rawResults,
+                      const Flags& flags);
+
+  /**
+   * Factors the raw hourly needs by the distribution efficiencies and
+   * converts them into end uses, optionally summed by month. Without
+   * aggregateByMonth the raw results may be for any periods, e.g. sums by
+   * month, as the efficiencies only depend on their totals.
+   */
+  std::vector<EndUses> endUses(const HourResults<std::vector<double> >& rawResults, bool aggregateByMonth);
+
   /**
    * Calculates the energy use for one hour and sets the state for the next
    * hour. The hourly calculations largely correspond to those described by the
@@ -88,62 +555,93 @@ private:
    * implementation describes everything in terms of EUI (i.e., per area). Any
    * discrepency in units where this code uses "units per area" while the
    * standard just uses "units" is likely due to this difference.
+   * solarRadiation holds the 8 wall directions followed by the roof.
    */
+  template<typename Flags>
   void calculateHour(int hourOfYear,
-                     int month,
-                     int dayOfWeek,
-                     int hourOfDay,
+                     const HourSchedules& schedules,
                      double windMps,
                      double temperature,
-                     const std::vector<double>& solarRadiation,
-                     double& TMT1,
-                     double& tiHeatCool,
-                     HourResults<double>& results);
-
-  void structureCalculations(double SHGC,
-                             double wallAreaM2,
-                             double windowAreaM2,
-                             double wallUValue,
-                             double windowUValue,
-                             double wallSolarAbsorption,
-                             double solarFactorWith,
-                             double solarFactorWithout,
+                     const double* solarRadiation,
+                     T& TMT1,
+                     T& tiHeatCool,
+                     HourResults<T>& results,
+                     const Flags& flags);
+
+  /**
+   * The first part of calculateHour(): the gains, ventilation and results
+   * that don't depend on the thermal state or the setpoints.
+   */
+  template<typename Flags>
+  void calculateGains(const HourSchedules& schedules,
+                      double windMps,
+                      double temperature,
+                      const double* solarRadiation,
+                      HourGains& gains,
+                      HourResults<T>& results,
+                      const Flags& flags);
+
+  /**
+   * The second part of calculateHour(): solves the 5R1C network for the
+   * heating/cooling need and the next state, and the results that depend on
+   * them.
+   */
+  template<typename Flags>
+  void calculateState(int hourOfYear,
+                      const HourGains& gains,
+                      T actualHeatingSetpoint,
+                      T actualCoolingSetpoint,
+                      double windMps,
+                      double temperature,
+                      T& TMT1,
+                      T& tiHeatCool,
+                      HourResults<T>& results,
+                      const Flags& flags);
+
+  void structureCalculations(T SHGC,
+                             T wallAreaM2,
+                             T windowAreaM2,
+                             T wallUValue,
+                             T windowUValue,
+                             T wallSolarAbsorption,
+                             T solarFactorWith,
+                             T solarFactorWithout,
                              int direction);
 
   std::vector<double> sumHoursByMonth(const std::vector<double>& hourlyData);
 
   /** Returns the ventilation schedule. */
-  virtual double ventilationSchedule(int hourOfYear, int hourOfDay, int scheduleOffset) {
+  virtual T ventilationSchedule(int hourOfYear, int hourOfDay, int scheduleOffset) {
     return fixedVentilationSchedule[(int) hourOfDay][(int) scheduleOffset];
   }
 
   /** Returns the exterior equipment schedule. */
-  virtual double exteriorEquipmentSchedule(int hourOfYear, int hourOfDay, int scheduleOffset) {
+  virtual T exteriorEquipmentSchedule(int hourOfYear, int hourOfDay, int scheduleOffset) {
     return fixedExteriorEquipmentSchedule[(int) hourOfDay][(int) scheduleOffset];
   }
 
   /** Returns the interior equipment schedule. */
-  virtual double interiorEquipmentSchedule(int hourOfYear, int hourOfDay, int scheduleOffset) {
+  virtual T interiorEquipmentSchedule(int hourOfYear, int hourOfDay, int scheduleOffset) {
     return fixedInteriorEquipmentSchedule[(int) hourOfDay][(int) scheduleOffset];
   }
 
   /** Returns the exterior lighting schedule. */
-  virtual double exteriorLightingSchedule(int hourOfYear, int hourOfDay, int scheduleOffset) {
+  virtual T exteriorLightingSchedule(int hourOfYear, int hourOfDay, int scheduleOffset) {
     return fixedExteriorLightingSchedule[(int) hourOfDay][(int) scheduleOffset];
   }
 
   /** Returns the interior lighting schedule. */
-  virtual double interiorLightingSchedule(int hourOfYear, int hourOfDay, int scheduleOffset) {
+  virtual T interiorLightingSchedule(int hourOfYear, int hourOfDay, int scheduleOffset) {
     return fixedInteriorLightingSchedule[(int) hourOfDay][(int) scheduleOffset];
   }
 
   /** Returns the heating setpoint schedule. */
-  virtual double heatingSetpointSchedule(int hourOfYear, int hourOfDay, int scheduleOffset) {
+  virtual T heatingSetpointSchedule(int hourOfYear, int hourOfDay, int scheduleOffset) {
     return fixedActualHeatingSetpoint[(int) hourOfDay][(int) scheduleOffset];
   }
 
   /** Returns the cooling setpoint schedule. */
-  virtual double coolingSetpointSchedule(int hourOfYear, int hourOfDay, int scheduleOffset) {
+  virtual T coolingSetpointSchedule(int hourOfYear, int hourOfDay, int scheduleOffset) {
     return fixedActualCoolingSetpoint[(int) hourOfDay][(int) scheduleOffset];
   }
 
@@ -156,87 +654,103 @@ private:
 
   // Lighting controls.
   // Used to determine the amount of electric light used.
-  double maxRatioElectricLighting; // Ratio of electric light used due to lighting controls.
-  double elightNatural; // Target lux level in naturally lit area.
+  T maxRatioElectricLighting; // Ratio of electric light used due to lighting controls.
+  T elightNatural; // Target lux level in naturally lit area.
 
   // Ventilation from wind. ISO 15242
-  double windImpactSupplyRatio; //I119
-  double q4Pa; // ISO 15242 Q_{4Pa}. XXX infiltrationM3PerHourAt4Pa ???
-  double windImpactHz; // ISO 15242 H_{z}. H119
+  T windImpactSupplyRatio; //I119
+  T q4Pa; // ISO 15242 Q_{4Pa}. XXX infiltrationM3PerHourAt4Pa ???
+  T windImpactHz; // ISO 15242 H_{z}. H119
 
   // Thermal Mass
-  double Am; // A_{m}. XXX: effectiveMassAreaM2
-  double Cm; // C_{m}. XXX: internalHeatCapacityJPerK 
+  T Am; // A_{m}. XXX: effectiveMassAreaM2
+  T Cm; // C_{m}. XXX: internalHeatCapacityJPerK 
 
   // Movable shading.
   // These variables are used to model movable shading. ISO 13790 does it
   // by switching between g_{gl} and g_{gl+sh}. The method here allows varying
   // degrees of shading rather than just on or off.
-  double shadingUsePerWPerM2; // K146. The shading factor per unit irradiance. XXX: shadingUsePerWPerM2
+  T shadingUsePerWPerM2; // K146. The shading factor per unit irradiance. XXX: shadingUsePerWPerM2
 
-  double areaNaturallyLighted;
-  double areaNaturallyLightedRatio;
+  T areaNaturallyLighted;
+  T areaNaturallyLightedRatio;
   
-  std::vector<double> nlaWMovableShading;
-  std::vector<double> naturalLightRatio;
-  std::vector<double> naturalLightShadeRatioReduction;
+  T nlaWMovableShading[9];
+  T naturalLightRatio[9];
+  T naturalLightShadeRatioReduction[9];
 
-  std::vector<double> saWMovableShading;
-  std::vector<double> solarRatio;
-  std::vector<double> solarShadeRatioReduction;
+  T saWMovableShading[9];
+  T solarRatio[9];
+  T solarShadeRatioReduction[9];
 
   // Fan power constants.
 
   // Wind constants.
-  double hzone; // Not totally clear what this is. Something wind related.
+  T hzone; // Not totally clear what this is. Something wind related.
 
   // Pump constants.
 
 
   // Heat transfer coefficients.
-  double h_ms; // h_{ms} Heat transfer coefficient, mass(m) to surface(s).
-  double h_is; // h_{is} Heat transfer coefficient, air(s) to surface(s).
+  T h_ms; // h_{ms} Heat transfer coefficient, mass(m) to surface(s).
+  T h_is; // h_{is} Heat transfer coefficient, air(s) to surface(s).
 
-  double H_tris; // H_{tr,is}. Coupling conductance from air(i) to surface(s).
-  double hwindowWperkm2; // H_{tr,w}.
+  T H_tris; // H_{tr,is}. Coupling conductance from air(i) to surface(s).
+  T hwindowWperkm2; // H_{tr,w}.
 
   // \Phi_{st} and \Phi_{m} are calculated differently than in ISO 13790 to
   // allow variation in the values that factor the amount of interior and solar
   // heat gain that heats the air. These variables are used in those
   // calculations.
-  double prs; // Constant part of \Phi_{st}.
-  double prsInterior; // Interior part of \Phi_{st}.
-  double prsSolar; // Solar part of \Phi_{st}.
-  double prm; // Constant part of \Phi_{m}.
-  double prmInterior; // Interior part of \Phi_{m}.
-  double prmSolar; // Solar part of \Phi_{m}.
+  T prs; // Constant part of \Phi_{st}.
+  T prsInterior; // Interior part of \Phi_{st}.
+  T prsSolar; // Solar part of \Phi_{st}.
+  T prm; // Constant part of \Phi_{m}.
+  T prmInterior; // Interior part of \Phi_{m}.
+  T prmSolar; // Solar part of \Phi_{m}.
 
-  double H_ms; // H_{ms}
-  double hOpaqueWperkm2; // H_{op}
-  double hem; // H_{em}
+  T H_ms; // H_{ms}
+  T hOpaqueWperkm2; // H_{op}
+  T hem; // H_{em}
 
   // TODO: I don't think this is used. Confirm and delete it. BAA@2015-08-04.
   // static const int NORTH, NORTHEAST, EAST, SOUTHEAST, SOUTH, SOUTHWEST, WEST, NORTHWEST, ROOF;
 
   // Calculated surface values
-  double nlams[9];
-  double nla[9];
-  double sams[9]; // ISO13790 11.3.4
-  double sa[9]; // ISO13790 11.3.4
-  double htot[9];
-  double hWindow[9];
-
-  double fixedVentilationSchedule[24][7];
-  double fixedExteriorEquipmentSchedule[24][7];
-  double fixedInteriorEquipmentSchedule[24][7];
-  double fixedExteriorLightingSchedule[24][7];
-  double fixedInteriorLightingSchedule[24][7];
-  double fixedActualHeatingSetpoint[24][7];
-  double fixedActualCoolingSetpoint[24][7];
+  T nlams[9];
+  T nla[9];
+  T sams[9]; // ISO13790 11.3.4
+  T sa[9]; // ISO13790 11.3.4
+  T htot[9];
+  T hWindow[9];
+
+  T fixedVentilationSchedule[24][7];
+  T fixedExteriorEquipmentSchedule[24][7];
+  T fixedInteriorEquipmentSchedule[24][7];
+  T fixedExteriorLightingSchedule[24][7];
+  T fixedInteriorLightingSchedule[24][7];
+  T fixedActualHeatingSetpoint[24][7];
+  T fixedActualCoolingSetpoint[24][7];
+
+  bool useSpecializedKernels = true;
+  bool useAffineSolver = true;
+
+  // The kernel and state used by step().
+  int stepKernel = -1;
+  HourlyState stepState;
+
+  // Overrides the wall irradiance calculated from the weather, if set.
+  std::shared_ptr<const std::vector<std::vector<double> > > wallIrradiance;
+
+  CancellationToken cancellation;
+  int cancellationInterval = 24;
 
   // XXX Unused variables.
   double provisionalCFlowad = 1; // Appears to be unused. Calculation.S106
 };
+
+extern template class ISOMODEL_API BasicHourlyModel<double>;
+typedef BasicHourlyModel<double> HourlyModel;
 }
 }
 #endif /* ISOMODEL_HOURLYMODEL_HPP */
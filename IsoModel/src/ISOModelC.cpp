@@ -0,0 +1,365 @@
+#include "ISOModelC.h"
+#include "SolarRadiation.hpp"
+#include "TimeFrame.hpp"
+#include "UserModel.hpp"
+#include "WorkStealingPool.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using openstudio::EndUses;
+using openstudio::isomodel::SolarRadiation;
+using openstudio::isomodel::TimeFrame;
+using openstudio::isomodel::UserModel;
+using openstudio::isomodel::WorkStealingPool;
+
+struct isomodel_model
+{
+  UserModel model;
+
+  // The hourly solar radiation on the walls, calculated on the first hourly
+  // simulation and shared with clones, since no parameter changes it.
+  mutable std::mutex irradianceMutex;
+  mutable std::shared_ptr<const std::vector<std::vector<double> > > irradiance;
+};
+
+namespace {
+
+thread_local std::string lastError;
+
+struct Parameter
+{
+  const char* name;
+  double (*get)(UserModel& model);
+  void (*set)(UserModel& model, double value);
+};
+
+// The scalar .ism properties that can be set by id. An id is an index into
+// this table, so new entries go at the end.
+const Parameter parameterTable[] = {
+  { "terrainclass", [](UserModel& m) { return m.terrainClass(); }, [](UserModel& m, double v) { m.setTerrainClass(v); } },
+  { "buildingheight", [](UserModel& m) { return m.buildingHeight(); }, [](UserModel& m, double v) { m.setBuildingHeight(v); } },
+  { "floorarea", [](UserModel& m) { return m.floorArea(); }, [](UserModel& m, double v) { m.setFloorArea(v); } },
+  { "occupancydayfirst", [](UserModel& m) { return m.buildingOccupancyFrom(); }, [](UserModel& m, double v) { m.setBuildingOccupancyFrom(v); } },
+  { "occupancydaylast", [](UserModel& m) { return m.buildingOccupancyTo(); }, [](UserModel& m, double v) { m.setBuildingOccupancyTo(v); } },
+  { "occupancyhourfirst", [](UserModel& m) { return m.equivFullLoadOccupancyFrom(); }, [](UserModel& m, double v) { m.setEquivFullLoadOccupancyFrom(v); } },
+  { "occupancyhourlast", [](UserModel& m) { return m.equivFullLoadOccupancyTo(); }, [](UserModel& m, double v) { m.setEquivFullLoadOccupancyTo(v); } },
+  { "peopledensityoccupied", [](UserModel& m) { return m.peopleDensityOccupied(); }, [](UserModel& m, double v) { m.setPeopleDensityOccupied(v); } },
+  { "peopledensityunoccupied", [](UserModel& m) { return m.peopleDensityUnoccupied(); }, [](UserModel& m, double v) { m.setPeopleDensityUnoccupied(v); } },
+  { "lightingpowerdensityoccupied", [](UserModel& m) { return m.lightingPowerIntensityOccupied(); }, [](UserModel& m, double v) { m.setLightingPowerIntensityOccupied(v); } },
+  { "lightingpowerdensityunoccupied", [](UserModel& m) { return m.lightingPowerIntensityUnoccupied(); }, [](UserModel& m, double v) { m.setLightingPowerIntensityUnoccupied(v); } },
+  { "electricappliancepowerdensityoccupied", [](UserModel& m) { return m.elecPowerAppliancesOccupied(); }, [](UserModel& m, double v) { m.setElecPowerAppliancesOccupied(v); } },
+  { "electricappliancepowerdensityunoccupied", [](UserModel& m) { return m.elecPowerAppliancesUnoccupied(); }, [](UserModel& m, double v) { m.setElecPowerAppliancesUnoccupied(v); } },
+  { "gasappliancepowerdensityoccupied", [](UserModel& m) { return m.gasPowerAppliancesOccupied(); }, [](UserModel& m, double v) { m.setGasPowerAppliancesOccupied(v); } },
+  { "gasappliancepowerdensityunoccupied", [](UserModel& m) { return m.gasPowerAppliancesUnoccupied(); }, [](UserModel& m, double v) { m.setGasPowerAppliancesUnoccupied(v); } },
+  { "exteriorlightingpower", [](UserModel& m) { return m.exteriorLightingPower(); }, [](UserModel& m, double v) { m.setExteriorLightingPower(v); } },
+  { "hvacwastefactor", [](UserModel& m) { return m.hvacWasteFactor(); }, [](UserModel& m, double v) { m.setHvacWasteFactor(v); } },
+  { "hvacheatinglossfactor", [](UserModel& m) { return m.hvacHeatingLossFactor(); }, [](UserModel& m, double v) { m.setHvacHeatingLossFactor(v); } },
+  { "hvaccoolinglossfactor", [](UserModel& m) { return m.hvacCoolingLossFactor(); }, [](UserModel& m, double v) { m.setHvacCoolingLossFactor(v); } },
+  { "daylightsensordimmingfraction", [](UserModel& m) { return m.daylightSensorSystem(); }, [](UserModel& m, double v) { m.setDaylightSensorSystem(v); } },
+  { "lightingoccupancysensordimmingfraction", [](UserModel& m) { return m.lightingOccupancySensorSystem(); }, [](UserModel& m, double v) { m.setLightingOccupancySensorSystem(v); } },
+  { "constantilluminationcontrolmultiplier", [](UserModel& m) { return m.constantIlluminationControl(); }, [](UserModel& m, double v) { m.setConstantIlluminationControl(v); } },
+  { "coolingsystemcop", [](UserModel& m) { return m.coolingSystemCOP(); }, [](UserModel& m, double v) { m.setCoolingSystemCOP(v); } },
+  { "coolingsystemiplvtocopratio", [](UserModel& m) { return m.coolingSystemIPLVToCOPRatio(); }, [](UserModel& m, double v) { m.setCoolingSystemIPLVToCOPRatio(v); } },
+  { "heatingsystemefficiency", [](UserModel& m) { return m.heatingSystemEfficiency(); }, [](UserModel& m, double v) { m.setHeatingSystemEfficiency(v); } },
+  { "ventilationintakerateoccupied", [](UserModel& m) { return m.freshAirFlowRate(); }, [](UserModel& m, double v) { m.setFreshAirFlowRate(v); } },
+  { "ventilationexhaustrateoccupied", [](UserModel& m) { return m.supplyExhaustRate(); }, [](UserModel& m, double v) { m.setSupplyExhaustRate(v); } },
+  { "heatrecovery", [](UserModel& m) { return m.heatRecovery(); }, [](UserModel& m, double v) { m.setHeatRecovery(v); } },
+  { "exhaustairrecirculation", [](UserModel& m) { return m.exhaustAirRecirclation(); }, [](UserModel& m, double v) { m.setExhaustAirRecirclation(v); } },
+  { "infiltrationrateoccupied", [](UserModel& m) { return m.buildingAirLeakage(); }, [](UserModel& m, double v) { m.setBuildingAirLeakage(v); } },
+  { "dhwdemand", [](UserModel& m) { return m.dhwDemand(); }, [](UserModel& m, double v) { m.setDhwDemand(v); } },
+  { "dhwsystemefficiency", [](UserModel& m) { return m.dhwEfficiency(); }, [](UserModel& m, double v) { m.setDhwEfficiency(v); } },
+  { "dhwdistributionefficiency", [](UserModel& m) { return m.dhwDistributionEfficiency(); }, [](UserModel& m, double v) { m.setDhwDistributionEfficiency(v); } },
+  { "interiorheatcapacity", [](UserModel& m) { return m.interiorHeatCapacity(); }, [](UserModel& m, double v) { m.setInteriorHeatCapacity(v); } },
+  { "exteriorheatcapacity", [](UserModel& m) { return m.exteriorHeatCapacity(); }, [](UserModel& m, double v) { m.setExteriorHeatCapacity(v); } },
+  { "heatingpumpcontrol", [](UserModel& m) { return m.heatingPumpControl(); }, [](UserModel& m, double v) { m.setHeatingPumpControl(v); } },
+  { "coolingpumpcontrol", [](UserModel& m) { return m.coolingPumpControl(); }, [](UserModel& m, double v) { m.setCoolingPumpControl(v); } },
+  { "heatgainperperson", [](UserModel& m) { return m.heatGainPerPerson(); }, [](UserModel& m, double v) { m.setHeatGainPerPerson(v); } },
+  { "specificfanpower", [](UserModel& m) { return m.specificFanPower(); }, [](UserModel& m, double v) { m.setSpecificFanPower(v); } },
+  { "fanflowcontrolfactor", [](UserModel& m) { return m.fanFlowControlFactor(); }, [](UserModel& m, double v) { m.setFanFlowControlFactor(v); } },
+  { "coolingsetpointoccupied", [](UserModel& m) { return m.coolingOccupiedSetpoint(); }, [](UserModel& m, double v) { m.setCoolingOccupiedSetpoint(v); } },
+  { "coolingsetpointunoccupied", [](UserModel& m) { return m.coolingUnoccupiedSetpoint(); }, [](UserModel& m, double v) { m.setCoolingUnoccupiedSetpoint(v); } },
+  { "heatingsetpointoccupied", [](UserModel& m) { return m.heatingOccupiedSetpoint(); }, [](UserModel& m, double v) { m.setHeatingOccupiedSetpoint(v); } },
+  { "heatingsetpointunoccupied", [](UserModel& m) { return m.heatingUnoccupiedSetpoint(); }, [](UserModel& m, double v) { m.setHeatingUnoccupiedSetpoint(v); } },
+  { "ventilationintakerateunoccupied", [](UserModel& m) { return m.ventilationIntakeRateUnoccupied(); }, [](UserModel& m, double v) { m.setVentilationIntakeRateUnoccupied(v); } },
+  { "ventilationexhaustrateunoccupied", [](UserModel& m) { return m.ventilationExhaustRateUnoccupied(); }, [](UserModel& m, double v) { m.setVentilationExhaustRateUnoccupied(v); } },
+  { "infiltrationrateunoccupied", [](UserModel& m) { return m.infiltrationRateUnoccupied(); }, [](UserModel& m, double v) { m.setInfiltrationRateUnoccupied(v); } },
+  { "lightingpowerfixedoccupied", [](UserModel& m) { return m.lightingPowerFixedOccupied(); }, [](UserModel& m, double v) { m.setLightingPowerFixedOccupied(v); } },
+  { "lightingpowerfixedunoccupied", [](UserModel& m) { return m.lightingPowerFixedUnoccupied(); }, [](UserModel& m, double v) { m.setLightingPowerFixedUnoccupied(v); } },
+  { "electricappliancepowerfixedoccupied", [](UserModel& m) { return m.electricAppliancePowerFixedOccupied(); }, [](UserModel& m, double v) { m.setElectricAppliancePowerFixedOccupied(v); } },
+  { "electricappliancepowerfixedunoccupied", [](UserModel& m) { return m.electricAppliancePowerFixedUnoccupied(); }, [](UserModel& m, double v) { m.setElectricAppliancePowerFixedUnoccupied(v); } },
+  { "gasappliancepowerfixedoccupied", [](UserModel& m) { return m.gasAppliancePowerFixedOccupied(); }, [](UserModel& m, double v) { m.setGasAppliancePowerFixedOccupied(v); } },
+  { "gasappliancepowerfixedunoccupied", [](UserModel& m) { return m.gasAppliancePowerFixedUnoccupied(); }, [](UserModel& m, double v) { m.setGasAppliancePowerFixedUnoccupied(v); } },
+};
+
+const int parameterCount = static_cast<int>(sizeof(parameterTable) / sizeof(parameterTable[0]));
+
+double endUse(EndUses& month, int i)
+{
+#ifdef ISOMODEL_STANDALONE
+  return month.getEndUse(i);
+#else
+  return month.getEndUse(isoResultsEndUseTypes[i].first, isoResultsEndUseTypes[i].second);
+#endif
+}
+
+// Runs f, turning exceptions into return codes and the thread's last error.
+int guarded(const std::function<void()>& f)
+{
+  try {
+    f();
+    return ISOMODEL_OK;
+  } catch (std::domain_error* e) {
+    // Properties throws pointers.
+    lastError = e->what();
+    delete e;
+  } catch (const std::invalid_argument& e) {
+    lastError = e.what();
+    return ISOMODEL_ERROR_ARGUMENT;
+  } catch (const std::exception& e) {
+    lastError = e.what();
+  } catch (...) {
+    lastError = "Unknown error";
+  }
+  return ISOMODEL_ERROR_SIMULATION;
+}
+
+void checkIds(const int* ids, size_t count)
+{
+  if (count > 0 && ids == nullptr) {
+    throw std::invalid_argument("ids is NULL");
+  }
+  for (size_t i = 0; i < count; ++i) {
+    if (ids[i] < 0 || ids[i] >= parameterCount) {
+      throw std::invalid_argument("Unknown parameter id " + std::to_string(ids[i]));
+    }
+  }
+}
+
+void checkEngine(int engine)
+{
+  if (isomodel_result_size(engine) == 0) {
+    throw std::invalid_argument("Unknown engine " + std::to_string(engine));
+  }
+}
+
+std::shared_ptr<const std::vector<std::vector<double> > > wallIrradiance(const isomodel_model& handle)
+{
+  std::lock_guard<std::mutex> lock(handle.irradianceMutex);
+  if (!handle.irradiance) {
+    // The same calculation as HourlyModel does for each run.
+    TimeFrame frame;
+    SolarRadiation solar(&frame, handle.model.epwData().get());
+    solar.calculateSurfaceSolarRadiation();
+    handle.irradiance = std::make_shared<const std::vector<std::vector<double> > >(solar.eglobe());
+  }
+  return handle.irradiance;
+}
+
+// Simulates model, a variant of handle's, into results.
+void simulate(const isomodel_model& handle, const UserModel& model, int engine, double* results)
+{
+  std::vector<EndUses> endUses;
+  if (engine == ISOMODEL_ENGINE_MONTHLY) {
+    endUses = model.toMonthlyModel().simulate();
+  } else {
+    auto hourly = model.toHourlyModel();
+    hourly.setWallIrradiance(wallIrradiance(handle));
+    endUses = hourly.simulate(engine == ISOMODEL_ENGINE_HOURLY);
+  }
+  if (endUses.size() * ISOMODEL_END_USES != isomodel_result_size(engine)) {
+    throw std::runtime_error("The simulation returned " + std::to_string(endUses.size()) + " periods");
+  }
+  for (auto& period : endUses) {
+    for (int i = 0; i < ISOMODEL_END_USES; ++i) {
+      *results++ = endUse(period, i);
+    }
+  }
+}
+
+} // namespace
+
+extern "C" {
+
+int isomodel_abi_version(void)
+{
+  return ISOMODEL_ABI_VERSION;
+}
+
+const char* isomodel_last_error(void)
+{
+  return lastError.c_str();
+}
+
+int isomodel_parameter_count(void)
+{
+  return parameterCount;
+}
+
+const char* isomodel_parameter_name(int id)
+{
+  return id >= 0 && id < parameterCount ? parameterTable[id].name : nullptr;
+}
+
+int isomodel_parameter_id(const char* name)
+{
+  if (name == nullptr) {
+    return -1;
+  }
+  std::string key(name);
+  std::transform(key.begin(), key.end(), key.begin(), ::tolower);
+  for (int id = 0; id < parameterCount; ++id) {
+    if (key == parameterTable[id].name) {
+      return id;
+    }
+  }
+  return -1;
+}
+
+size_t isomodel_result_size(int engine)
+{
+  switch (engine) {
+  case ISOMODEL_ENGINE_MONTHLY:
+  case ISOMODEL_ENGINE_HOURLY:
+    return ISOMODEL_MONTHS * ISOMODEL_END_USES;
+  case ISOMODEL_ENGINE_HOURLY_BY_HOUR:
+    return ISOMODEL_HOURS * ISOMODEL_END_USES;
+  default:
+    return 0;
+  }
+}
+
+isomodel_model* isomodel_model_create(const char* ism_path, const char* defaults_path)
+{
+  std::unique_ptr<isomodel_model> handle;
+  auto status = guarded([&]() {
+    if (ism_path == nullptr) {
+      throw std::invalid_argument("ism_path is NULL");
+    }
+    handle.reset(new isomodel_model());
+    if (defaults_path == nullptr) {
+      handle->model.load(ism_path);
+    } else {
+      handle->model.load(ism_path, defaults_path);
+    }
+    if (!handle->model.valid()) {
+      throw std::runtime_error("Could not load " + std::string(ism_path));
+    }
+  });
+  return status == ISOMODEL_OK ? handle.release() : nullptr;
+}
+
+isomodel_model* isomodel_model_clone(const isomodel_model* model)
+{
+  std::unique_ptr<isomodel_model> handle;
+  auto status = guarded([&]() {
+    if (model == nullptr) {
+      throw std::invalid_argument("model is NULL");
+    }
+    handle.reset(new isomodel_model());
+    handle->model = model->model;
+    std::lock_guard<std::mutex> lock(model->irradianceMutex);
+    handle->irradiance = model->irradiance;
+  });
+  return status == ISOMODEL_OK ? handle.release() : nullptr;
+}
+
+void isomodel_model_destroy(isomodel_model* model)
+{
+  delete model;
+}
+
+int isomodel_set_parameters(isomodel_model* model, const int* ids, const double* values, size_t count)
+{
+  return guarded([&]() {
+    if (model == nullptr || (count > 0 && values == nullptr)) {
+      throw std::invalid_argument("model or values is NULL");
+    }
+    checkIds(ids, count);
+    for (size_t i = 0; i < count; ++i) {
+      parameterTable[ids[i]].set(model->model, values[i]);
+    }
+  });
+}
+
+int isomodel_get_parameters(isomodel_model* model, const int* ids, double* values, size_t count)
+{
+  return guarded([&]() {
+    if (model == nullptr || (count > 0 && values == nullptr)) {
+      throw std::invalid_argument("model or values is NULL");
+    }
+    checkIds(ids, count);
+    for (size_t i = 0; i < count; ++i) {
+      values[i] = parameterTable[ids[i]].get(model->model);
+    }
+  });
+}
+
+int isomodel_simulate(const isomodel_model* model, int engine, double* results)
+{
+  return guarded([&]() {
+    if (model == nullptr || results == nullptr) {
+      throw std::invalid_argument("model or results is NULL");
+    }
+    checkEngine(engine);
+    simulate(*model, model->model, engine, results);
+  });
+}
+
+int isomodel_simulate_batch(const isomodel_model* model, int engine, const int* ids, size_t id_count,
+                            const double* rows, size_t row_count, double* results, int* statuses,
+                            size_t threads)
+{
+  auto status = guarded([&]() {
+    if (model == nullptr || (row_count > 0 && results == nullptr) || (row_count > 0 && id_count > 0 && rows == nullptr)) {
+      throw std::invalid_argument("model, rows or results is NULL");
+    }
+    checkEngine(engine);
+    checkIds(ids, id_count);
+  });
+  if (status != ISOMODEL_OK) {
+    return status;
+  }
+
+  auto size = isomodel_result_size(engine);
+  std::vector<int> codes(row_count, ISOMODEL_OK);
+  std::vector<std::string> errors(row_count);
+  std::vector<std::function<void()> > tasks;
+  for (size_t r = 0; r < row_count; ++r) {
+    tasks.push_back([&, r]() {
+      codes[r] = guarded([&]() {
+        auto variant = model->model;
+        for (size_t j = 0; j < id_count; ++j) {
+          parameterTable[ids[j]].set(variant, rows[r * id_count + j]);
+        }
+        simulate(*model, variant, engine, results + r * size);
+      });
+      if (codes[r] != ISOMODEL_OK) {
+        errors[r] = lastError;
+        std::fill(results + r * size, results + (r + 1) * size, std::numeric_limits<double>::quiet_NaN());
+      }
+    });
+  }
+  WorkStealingPool pool(threads);
+  pool.run(tasks);
+
+  if (statuses != nullptr) {
+    std::copy(codes.begin(), codes.end(), statuses);
+  }
+  for (size_t r = 0; r < row_count; ++r) {
+    if (codes[r] != ISOMODEL_OK) {
+      lastError = "Row " + std::to_string(r) + ": " + errors[r];
+      return codes[r];
+    }
+  }
+  return ISOMODEL_OK;
+}
+
+} // extern "C"
@@ -0,0 +1,108 @@
+#ifndef ISOMODEL_C_H
+#define ISOMODEL_C_H
+
+/*
+ * A C interface to the ISO model for embedding it in other languages
+ * (Python's ctypes or cffi, Julia's ccall, Ruby's FFI) without going through
+ * C++ classes or per-call marshalling.
+ *
+ * A model is loaded once from an .ism file, and its scalar parameters are
+ * then changed in bulk by id. Simulations write their results into buffers
+ * the caller owns: for each month or hour, the 13 end uses (kWh/m2) in the
+ * order ElecHeat, ElecCool, ElecIntLights, ElecExtLights, ElecFans,
+ * ElecPump, ElecEquipInt, ElecEquipExt, ElecDHW, GasHeat, GasCool, GasEquip,
+ * GasDHW. isomodel_simulate_batch runs many parameter rows into one
+ * contiguous buffer, so the buffer can be a numpy array or Julia matrix.
+ *
+ * Functions returning int return ISOMODEL_OK or an error code, and
+ * isomodel_last_error() then describes the error. A model may be used by one
+ * thread at a time, except that isomodel_simulate_batch and
+ * isomodel_model_clone may be called on the same model concurrently.
+ *
+ * Parameter ids are stable: new parameters are only ever appended, and
+ * ISOMODEL_ABI_VERSION changes if a signature or layout here does.
+ */
+
+#include "ISOModelAPI.hpp"
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ISOMODEL_ABI_VERSION 1
+
+#define ISOMODEL_END_USES 13
+#define ISOMODEL_MONTHS 12
+#define ISOMODEL_HOURS 8760
+
+/* Return codes. */
+#define ISOMODEL_OK 0
+#define ISOMODEL_ERROR_ARGUMENT 1
+#define ISOMODEL_ERROR_SIMULATION 2
+
+/* Engines, and what each writes per simulation. */
+#define ISOMODEL_ENGINE_MONTHLY 0 /* The monthly model: 12 x 13 doubles. */
+#define ISOMODEL_ENGINE_HOURLY 1 /* The hourly model summed by month: 12 x 13 doubles. */
+#define ISOMODEL_ENGINE_HOURLY_BY_HOUR 2 /* The hourly model: 8760 x 13 doubles. */
+
+typedef struct isomodel_model isomodel_model;
+
+/* The ISOMODEL_ABI_VERSION the library was built with. */
+ISOMODEL_API int isomodel_abi_version(void);
+
+/* The last error on the calling thread, or "" if there was none. */
+ISOMODEL_API const char* isomodel_last_error(void);
+
+/* The number of parameters; ids run from 0 to this minus one. */
+ISOMODEL_API int isomodel_parameter_count(void);
+
+/* The .ism property name of a parameter, in lower case, or NULL if id is out of range. */
+ISOMODEL_API const char* isomodel_parameter_name(int id);
+
+/* The id of the parameter with the given .ism property name (in any case), or -1 if there is none. */
+ISOMODEL_API int isomodel_parameter_id(const char* name);
+
+/* The number of doubles one simulation with the given engine writes, or 0 if engine is unknown. */
+ISOMODEL_API size_t isomodel_result_size(int engine);
+
+/*
+ * Loads a model from an .ism file and, if defaults_path isn't NULL, a
+ * defaults file, along with its weather file. Returns NULL on error.
+ */
+ISOMODEL_API isomodel_model* isomodel_model_create(const char* ism_path, const char* defaults_path);
+
+/* An independent copy of a model, sharing its weather. Returns NULL on error. */
+ISOMODEL_API isomodel_model* isomodel_model_clone(const isomodel_model* model);
+
+/* Frees a model. Does nothing if model is NULL. */
+ISOMODEL_API void isomodel_model_destroy(isomodel_model* model);
+
+/* Sets count parameters, values[i] to parameter ids[i]. Sets none if an id is out of range. */
+ISOMODEL_API int isomodel_set_parameters(isomodel_model* model, const int* ids, const double* values, size_t count);
+
+/* Reads count parameters, parameter ids[i] into values[i]. */
+ISOMODEL_API int isomodel_get_parameters(isomodel_model* model, const int* ids, double* values, size_t count);
+
+/* Simulates the model, writing isomodel_result_size(engine) doubles to results. */
+ISOMODEL_API int isomodel_simulate(const isomodel_model* model, int engine, double* results);
+
+/*
+ * Simulates row_count variants of the model on the given number of threads,
+ * or one per hardware thread if threads is 0. Variant r has the model's
+ * parameters with ids[j] set to rows[r * id_count + j], and writes its
+ * results to results + r * isomodel_result_size(engine). The model itself
+ * isn't changed. If statuses isn't NULL, statuses[r] gets the return code of
+ * variant r, and the results of a failed variant are NaN. Returns ISOMODEL_OK
+ * if every variant succeeded, or else the error of the first that failed.
+ */
+ISOMODEL_API int isomodel_simulate_batch(const isomodel_model* model, int engine, const int* ids, size_t id_count,
+                                         const double* rows, size_t row_count, double* results, int* statuses,
+                                         size_t threads);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ISOMODEL_C_H */
@@ -0,0 +1,104 @@
+#include "IrradianceCache.hpp"
+#include "SolarRadiation.hpp"
+#include "TimeFrame.hpp"
+
+#include <cmath>
+#include <stdexcept>
+
+namespace openstudio {
+namespace isomodel {
+
+namespace {
+
+// The azimuths of the walls in degrees, in the order of SolarRadiation's surfaces.
+const double wallAzimuths[NUM_SURFACES] = { 0, -45, -90, -135, 180, 135, 90, 45 };
+
+} // namespace
+
+IrradianceCache::IrradianceCache(EpwData& weather, double binDegrees) : m_binDegrees(binDegrees)
+{
+  auto count = binDegrees > 0 ? std::floor(360.0 / binDegrees + 0.5) : 0.0;
+  if (count < 1 || std::fabs(count * binDegrees - 360.0) > 1e-9) {
+    throw std::invalid_argument("The azimuth bin width must divide 360 degrees");
+  }
+  auto bins = static_cast<std::size_t>(count);
+
+  // Bins past south-north are given as negative (east) azimuths, like the walls.
+  std::vector<double> azimuths;
+  for (std::size_t b = 0; b < bins; ++b) {
+    auto degrees = b * binDegrees;
+    if (degrees > 180) {
+      degrees -= 360;
+    }
+    azimuths.push_back(degrees * PI / 180.0);
+  }
+
+  TimeFrame frame;
+  SolarRadiation solar(&frame, &weather);
+  m_hourly = solar.calculateSurfaceSolarRadiation(azimuths);
+
+  // Monthly means, accumulated in the same order as SolarRadiation::calculateAverages().
+  m_monthly.assign(MONTHS, std::vector<double>(bins, 0.0));
+  std::vector<int> hours(MONTHS, 0);
+  for (int i = 0; i < TIMESLICES; ++i) {
+    auto month = frame.Month[i] - 1;
+    ++hours[month];
+    for (std::size_t b = 0; b < bins; ++b) {
+      m_monthly[month][b] += m_hourly[i][b];
+    }
+  }
+  for (int m = 0; m < MONTHS; ++m) {
+    for (std::size_t b = 0; b < bins; ++b) {
+      m_monthly[m][b] /= hours[m];
+    }
+  }
+}
+
+void IrradianceCache::interpolation(double azimuth, std::size_t& lower, std::size_t& upper, double& fraction) const
+{
+  auto wrapped = std::fmod(azimuth, 360.0);
+  if (wrapped < 0) {
+    wrapped += 360.0;
+  }
+  auto position = wrapped / m_binDegrees;
+  auto below = std::floor(position);
+  fraction = position - below;
+  lower = static_cast<std::size_t>(below) % bins();
+  upper = (lower + 1) % bins();
+}
+
+std::vector<std::vector<double> > IrradianceCache::hourly(double rotation) const
+{
+  std::size_t lower[NUM_SURFACES], upper[NUM_SURFACES];
+  double fraction[NUM_SURFACES];
+  for (int s = 0; s < NUM_SURFACES; ++s) {
+    interpolation(wallAzimuths[s] + rotation, lower[s], upper[s], fraction[s]);
+  }
+
+  std::vector<std::vector<double> > result(m_hourly.size(), std::vector<double>(NUM_SURFACES));
+  for (std::size_t i = 0; i < m_hourly.size(); ++i) {
+    const auto& row = m_hourly[i];
+    for (int s = 0; s < NUM_SURFACES; ++s) {
+      result[i][s] = fraction[s] == 0.0 ? row[lower[s]] : row[lower[s]] + fraction[s] * (row[upper[s]] - row[lower[s]]);
+    }
+  }
+  return result;
+}
+
+Matrix IrradianceCache::monthly(double rotation) const
+{
+  Matrix result(MONTHS, NUM_SURFACES);
+  for (int s = 0; s < NUM_SURFACES; ++s) {
+    std::size_t lower, upper;
+    double fraction;
+    interpolation(wallAzimuths[s] + rotation, lower, upper, fraction);
+    for (int m = 0; m < MONTHS; ++m) {
+      const auto& row = m_monthly[m];
+      result(m, s) = fraction == 0.0 ? row[lower] : row[lower] + fraction * (row[upper] - row[lower]);
+    }
+  }
+  return result;
+}
+
+} // isomodel
+} // openstudio
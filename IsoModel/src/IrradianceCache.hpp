@@ -0,0 +1,66 @@
+#ifndef ISOMODEL_IRRADIANCE_CACHE_HPP
+#define ISOMODEL_IRRADIANCE_CACHE_HPP
+
+#include "ISOModelAPI.hpp"
+
+#include <cstddef>
+#include <vector>
+
+#ifdef ISOMODEL_STANDALONE
+#include "Matrix.hpp"
+#else
+#include "../utilities/data/Matrix.hpp"
+#endif
+
+namespace openstudio {
+namespace isomodel {
+
+class EpwData;
+
+/**
+ * The solar irradiance on vertical surfaces facing every few degrees of
+ * azimuth, computed once from a weather file so that the irradiance on the
+ * walls of the building turned to any orientation can be interpolated from it
+ * instead of being recomputed for each orientation.
+ *
+ * Azimuths and rotations are in degrees in the convention of SolarRadiation:
+ * south is 0 and west is 90. A positive rotation turns the building
+ * clockwise seen from above, so after a rotation of 90 the wall that faced
+ * south faces west. The irradiance is interpolated linearly between the two
+ * nearest bins; at the bins it is exactly what SolarRadiation computes.
+ */
+class ISOMODEL_API IrradianceCache
+{
+public:
+  /**
+   * Computes the hourly and monthly mean irradiance on a surface facing each
+   * multiple of binDegrees, which must divide 360.
+   */
+  explicit IrradianceCache(EpwData& weather, double binDegrees = 5.0);
+
+  double binDegrees() const {
+    return m_binDegrees;
+  }
+
+  std::size_t bins() const {
+    return m_monthly.empty() ? 0 : m_monthly[0].size();
+  }
+
+  /** Returns the irradiance (W/m2) on the 8 walls, a row per hour, like SolarRadiation::eglobe(). */
+  std::vector<std::vector<double> > hourly(double rotation) const;
+
+  /** Returns the monthly mean irradiance (W/m2) on the 8 walls, laid out like WeatherData::msolar(). */
+  Matrix monthly(double rotation) const;
+
+private:
+  // The bins either side of azimuth and the weight of the upper one.
+  void interpolation(double azimuth, std::size_t& lower, std::size_t& upper, double& fraction) const;
+
+  double m_binDegrees;
+  std::vector<std::vector<double> > m_hourly; // By hour, then bin.
+  std::vector<std::vector<double> > m_monthly; // By month, then bin.
+};
+
+} // isomodel
+} // openstudio
+#endif // ISOMODEL_IRRADIANCE_CACHE_HPP
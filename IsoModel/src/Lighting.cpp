@@ -3,13 +3,7 @@
 namespace openstudio {
 namespace isomodel {
 
-Lighting::Lighting(void)
-{
-}
-
-Lighting::~Lighting(void)
-{
-}
+template class ISOMODEL_API BasicLighting<double>;
 
 } // isomodel
 } // openstudio
@@ -20,34 +20,61 @@
 #define ISOMODEL_LIGHTING_HPP
 
 #include "ISOModelAPI.hpp"
+#include "Dual.hpp"
 
 namespace openstudio {
 namespace isomodel {
-class ISOMODEL_API Lighting
+template<typename T>
+class BasicLighting
 {
 public:
-  Lighting(void);
-  ~Lighting(void);
+  BasicLighting() {}
+
+  /** Converts the parameters from another scalar type. */
+  template<typename U>
+  explicit BasicLighting(const BasicLighting<U>& other) :
+      m_powerDensityOccupied(other.m_powerDensityOccupied),
+      m_powerDensityUnoccupied(other.m_powerDensityUnoccupied),
+      m_dimmingFraction(other.m_dimmingFraction),
+      m_exteriorEnergy(other.m_exteriorEnergy),
+      m_n_day_start(other.m_n_day_start),
+      m_n_day_end(other.m_n_day_end),
+      m_n_weeks(other.m_n_weeks),
+      m_elecInternalGains(other.m_elecInternalGains),
+      m_permLightPowerDensity(other.m_permLightPowerDensity),
+      m_presenceSensorAd(other.m_presenceSensorAd),
+      m_automaticAd(other.m_automaticAd),
+      m_presenceAutoAd(other.m_presenceAutoAd),
+      m_manualSwitchAd(other.m_manualSwitchAd),
+      m_presenceSensorLux(other.m_presenceSensorLux),
+      m_automaticLux(other.m_automaticLux),
+      m_presenceAutoLux(other.m_presenceAutoLux),
+      m_manualSwitchLux(other.m_manualSwitchLux),
+      m_naturallyLightedArea(other.m_naturallyLightedArea),
+      m_lightingPowerFixedOccupied(other.m_lightingPowerFixedOccupied),
+      m_lightingPowerFixedUnoccupied(other.m_lightingPowerFixedUnoccupied)
+  {
+  }
 
   /**
   * Lighting power density occupied (W/m2).
   */
-  double powerDensityOccupied() const {
+  T powerDensityOccupied() const {
     return m_powerDensityOccupied;
   }
 
-  void setPowerDensityOccupied(double value) {
+  void setPowerDensityOccupied(T value) {
     m_powerDensityOccupied = value;
   }
 
   /**
   * Lighting power density unoccupied (W/m2).
   */
-  double powerDensityUnoccupied() const {
+  T powerDensityUnoccupied() const {
     return m_powerDensityUnoccupied;
   }
 
-  void setPowerDensityUnoccupied(double value) {
+  void setPowerDensityUnoccupied(T value) {
     m_powerDensityUnoccupied = value;
   }
 
@@ -56,66 +83,66 @@ public:
   * Illum controls are set to 1 if there is no control.
   * See iso 15193 Annex F/G for values.
   */
-  double dimmingFraction() const {
+  T dimmingFraction() const {
     return m_dimmingFraction;
   }
 
-  void setDimmingFraction(double value) {
+  void setDimmingFraction(T value) {
     m_dimmingFraction = value;
   }
 
   /**
   * Exterior lighting power (W).
   */
-  double exteriorEnergy() const {
+  T exteriorEnergy() const {
     return m_exteriorEnergy;
   }
 
-  void setExteriorEnergy(double value) {
+  void setExteriorEnergy(T value) {
     m_exteriorEnergy = value;
   }
 
   /**
   * Sunrise (24-hour time). Defaults to 7.0.
   */
-  double n_day_start() const {
+  T n_day_start() const {
     return m_n_day_start;
   }
 
-  void setN_day_start(double n_day_start) {
+  void setN_day_start(T n_day_start) {
     m_n_day_start = n_day_start;
   }
 
   /**
   * Sunset (24-hour time). Defaults to 18.0.
   */
-  double n_day_end() const {
+  T n_day_end() const {
     return m_n_day_end;
   }
 
-  void setN_day_end(double n_day_end) {
+  void setN_day_end(T n_day_end) {
     m_n_day_end = n_day_end;
   }
 
   /**
   * Number of occupied weeks for lighting purposes.
   */
-  double n_weeks() const {
+  T n_weeks() const {
     return m_n_weeks;
   }
 
-  void setN_weeks(double n_weeks) {
+  void setN_weeks(T n_weeks) {
     m_n_weeks = n_weeks;
   }
 
   /**
   * Electric internal gains. XXX: This appears to be a ratio/factor but I'm not sure - BAA@2015-06-08.
   */
-  double elecInternalGains() const {
+  T elecInternalGains() const {
     return m_elecInternalGains;
   }
 
-  void setElecInternalGains(double electInternalGains) {
+  void setElecInternalGains(T electInternalGains) {
     m_elecInternalGains = electInternalGains;
   }
 
@@ -123,110 +150,110 @@ public:
   * Permanent lighting power density (W/m2). Lighting that is always on regardless of occupancy
   * (e.g. emergency lights).
   */
-  double permLightPowerDensity() const {
+  T permLightPowerDensity() const {
     return m_permLightPowerDensity;
   }
 
-  void setPermLightPowerDensity(double permLightPowerDensity) {
+  void setPermLightPowerDensity(T permLightPowerDensity) {
     m_permLightPowerDensity = permLightPowerDensity;
   }
 
   /**
   * Occupancy based lighting controls use adjustment factors.
   */
-  double presenceSensorAd() const {
+  T presenceSensorAd() const {
     return m_presenceSensorAd;
   }
 
-  void setPresenceSensorAd(double presenceSensorAd) {
+  void setPresenceSensorAd(T presenceSensorAd) {
     m_presenceSensorAd = presenceSensorAd;
   }
 
   /**
   * Occupancy based lighting controls use adjustment factors.
   */
-  double automaticAd() const {
+  T automaticAd() const {
     return m_automaticAd;
   }
 
-  void setAutomaticAd(double automaticAd) {
+  void setAutomaticAd(T automaticAd) {
     m_automaticAd = automaticAd;
   }
 
   /**
   * Occupancy based lighting controls use adjustment factors.
   */
-  double presenceAutoAd() const {
+  T presenceAutoAd() const {
     return m_presenceAutoAd;
   }
 
-  void setPresenceAutoAd(double presenceAutoAd) {
+  void setPresenceAutoAd(T presenceAutoAd) {
     m_presenceAutoAd = presenceAutoAd;
   }
 
   /**
   * Occupancy based lighting controls use adjustment factors.
   */
-  double manualSwitchAd() const {
+  T manualSwitchAd() const {
     return m_manualSwitchAd;
   }
 
-  void setManualSwitchAd(double manualSwitchAd) {
+  void setManualSwitchAd(T manualSwitchAd) {
     m_manualSwitchAd = manualSwitchAd;
   }
 
   /**
   * Daylight based lighting control target lux levels.
   */
-  double presenceSensorLux() const {
+  T presenceSensorLux() const {
     return m_presenceSensorLux;
   }
 
-  void setPresenceSensorLux(double presenceSensorLux) {
+  void setPresenceSensorLux(T presenceSensorLux) {
     m_presenceSensorLux = presenceSensorLux;
   }
 
   /**
   * Daylight based lighting control target lux levels.
   */
-  double automaticLux() const {
+  T automaticLux() const {
     return m_automaticLux;
   }
 
-  void setAutomaticLux(double automaticLux) {
+  void setAutomaticLux(T automaticLux) {
     m_automaticLux = automaticLux;
   }
 
   /**
   * Daylight based lighting control target lux levels.
   */
-  double presenceAutoLux() const {
+  T presenceAutoLux() const {
     return m_presenceAutoLux;
   }
 
-  void setPresenceAutoLux(double presenceAutoLux) {
+  void setPresenceAutoLux(T presenceAutoLux) {
     m_presenceAutoLux = presenceAutoLux;
   }
 
   /**
   * Daylight based lighting control target lux levels.
   */
-  double manualSwitchLux() const {
+  T manualSwitchLux() const {
     return m_manualSwitchLux;
   }
 
-  void setManualSwitchLux(double manualSwitchLux) {
+  void setManualSwitchLux(T manualSwitchLux) {
     m_manualSwitchLux = manualSwitchLux;
   }
 
   /**
   * Area that utlizes natural lighting (m2).
   */
-  double naturallyLightedArea() const {
+  T naturallyLightedArea() const {
     return m_naturallyLightedArea;
   }
 
-  void setNaturallyLightedArea(double naturallyLightedArea) {
+  void setNaturallyLightedArea(T naturallyLightedArea) {
     m_naturallyLightedArea = naturallyLightedArea;
   }
 
@@ -234,53 +261,59 @@ public:
   /**
   *
   */
-  double lightingPowerFixedOccupied() const {
+  T lightingPowerFixedOccupied() const {
     return m_lightingPowerFixedOccupied;
   }
 
-  void setLightingPowerFixedOccupied(double lightingPowerFixedOccupied) {
+  void setLightingPowerFixedOccupied(T lightingPowerFixedOccupied) {
     m_lightingPowerFixedOccupied = lightingPowerFixedOccupied;
   }
 
   /**
   *
   */
-  double lightingPowerFixedUnoccupied() const {
+  T lightingPowerFixedUnoccupied() const {
     return m_lightingPowerFixedUnoccupied;
   }
 
-  void setLightingPowerFixedUnoccupied(double lightingPowerFixedUnoccupied) {
+  void setLightingPowerFixedUnoccupied(T lightingPowerFixedUnoccupied) {
     m_lightingPowerFixedUnoccupied = lightingPowerFixedUnoccupied;
   }
 
 private:
-  double m_powerDensityOccupied;
-  double m_powerDensityUnoccupied;
-  double m_dimmingFraction;
-  double m_exteriorEnergy;
+  template<typename>
+  friend class BasicLighting;
+
+  T m_powerDensityOccupied;
+  T m_powerDensityUnoccupied;
+  T m_dimmingFraction;
+  T m_exteriorEnergy;
   // Members with default values:
-  double m_n_day_start = 7.0; // TODO: sunrise shouldn't be the same every month.
-  double m_n_day_end = 18.0; // TODO: sunrise shouldbe be the same every month.
-  double m_n_weeks = 50.0;
-  double m_elecInternalGains = 1.0;
-  double m_permLightPowerDensity = 0.0;
+  T m_n_day_start = 7.0; // TODO: sunrise shouldn't be the same every month.
+  T m_n_day_end = 18.0; // TODO: sunrise shouldbe be the same every month.
+  T m_n_weeks = 50.0;
+  T m_elecInternalGains = 1.0;
+  T m_permLightPowerDensity = 0.0;
   // Automatic lighting control defaults:
-  double m_presenceSensorAd = 0.6;
-  double m_automaticAd = 0.8;
-  double m_presenceAutoAd = 0.6;
-  double m_manualSwitchAd = 1;
-  double m_presenceSensorLux = 500.0;
-  double m_automaticLux = 300.0;
-  double m_presenceAutoLux = 300.0;
-  double m_manualSwitchLux = 500.0;
+  T m_presenceSensorAd = 0.6;
+  T m_automaticAd = 0.8;
+  T m_presenceAutoAd = 0.6;
+  T m_manualSwitchAd = 1;
+  T m_presenceSensorLux = 500.0;
+  T m_automaticLux = 300.0;
+  T m_presenceAutoLux = 300.0;
+  T m_manualSwitchLux = 500.0;
   // Daylighting
-  double m_naturallyLightedArea = 0.0;
+  T m_naturallyLightedArea = 0.0;
 
   // TODO: These properties aren't used by the simulations yet -BAA@2015-06-18
-  double m_lightingPowerFixedOccupied;
-  double m_lightingPowerFixedUnoccupied;
+  T m_lightingPowerFixedOccupied = 0.0;
+  T m_lightingPowerFixedUnoccupied = 0.0;
 };
 
+extern template class ISOMODEL_API BasicLighting<double>;
+typedef BasicLighting<double> Lighting;
+
 } // isomodel
 } // openstudio
 #endif // ISOMODEL_LIGHTING_HPP
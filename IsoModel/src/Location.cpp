@@ -3,13 +3,7 @@
 namespace openstudio {
 namespace isomodel {
 
-Location::Location(void)
-{
-}
-
-Location::~Location(void)
-{
-}
+template class ISOMODEL_API BasicLocation<double>;
 
 } // isomodel
 } // openstudio
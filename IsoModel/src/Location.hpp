@@ -20,26 +20,35 @@
 #define ISOMODEL_LOCATION_HPP
 
 #include "ISOModelAPI.hpp"
+#include "Dual.hpp"
 
 #include "WeatherData.hpp"
 
 namespace openstudio {
 namespace isomodel {
 
-class ISOMODEL_API Location
+template<typename T>
+class BasicLocation
 {
 public:
-  Location(void);
-  ~Location(void);
+  BasicLocation() {}
+
+  /** Converts the parameters from another scalar type. */
+  template<typename U>
+  explicit BasicLocation(const BasicLocation<U>& other) :
+      m_terrain(other.m_terrain),
+      m_weather(other.m_weather)
+  {
+  }
 
   /**
   * Terrain class (urban/city = 0.8, suburban/some shielding = 0.9, country/open = 1.0).
   */
-  double terrain() const {
+  T terrain() const {
     return m_terrain;
   }
   
-  void setTerrain(double value) {
+  void setTerrain(T value) {
     m_terrain = value;
   }
 
@@ -55,10 +64,16 @@ public:
   }
 
 private:
-  double m_terrain;
+  template<typename>
+  friend class BasicLocation;
+
+  T m_terrain;
   std::shared_ptr<WeatherData> m_weather;
 };
 
+extern template class ISOMODEL_API BasicLocation<double>;
+typedef BasicLocation<double> Location;
+
 } // isomodel
 } // openstudio
 #endif // ISOMODEL_LOCATION_HPP
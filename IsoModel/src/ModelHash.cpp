@@ -0,0 +1,71 @@
+#include "ModelHash.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+
+namespace openstudio {
+namespace isomodel {
+
+namespace {
+
+std::uint64_t mix(std::uint64_t x)
+{
+  x ^= x >> 30;
+  x *= 0xBF58476D1CE4E5B9ull;
+  x ^= x >> 27;
+  x *= 0x94D049BB133111EBull;
+  x ^= x >> 31;
+  return x;
+}
+
+} // namespace
+
+std::string ModelHash::toString() const
+{
+  char text[33];
+  std::snprintf(text, sizeof(text), "%016llx%016llx", static_cast<unsigned long long>(high), static_cast<unsigned long long>(low));
+  return text;
+}
+
+void ModelHasher::add(std::uint64_t word)
+{
+  m_high = mix(m_high ^ word);
+  m_low = mix(m_low + word + 0x9E3779B97F4A7C15ull);
+  ++m_words;
+}
+
+void ModelHasher::add(double value)
+{
+  if (value == 0.0) {
+    value = 0.0;
+  } else if (std::isnan(value)) {
+    value = std::numeric_limits<double>::quiet_NaN();
+  }
+  std::uint64_t word;
+  std::memcpy(&word, &value, sizeof(word));
+  add(word);
+}
+
+void ModelHasher::add(const std::string& text)
+{
+  add(static_cast<std::uint64_t>(text.size()));
+  for (std::size_t i = 0; i < text.size(); i += 8) {
+    std::uint64_t word = 0;
+    std::memcpy(&word, text.data() + i, std::min<std::size_t>(8, text.size() - i));
+    add(word);
+  }
+}
+
+ModelHash ModelHasher::digest() const
+{
+  ModelHash hash;
+  hash.high = mix(m_high ^ m_words);
+  hash.low = mix(m_low + m_high);
+  return hash;
+}
+
+} // isomodel
+} // openstudio
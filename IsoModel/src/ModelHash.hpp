@@ -0,0 +1,55 @@
+#ifndef ISOMODEL_MODEL_HASH_HPP
+#define ISOMODEL_MODEL_HASH_HPP
+
+#include "ISOModelAPI.hpp"
+
+#include <cstdint>
+#include <string>
+
+namespace openstudio {
+namespace isomodel {
+
+/** A 128-bit digest of a model's parameters, weather and engine. */
+struct ModelHash
+{
+  std::uint64_t high = 0;
+  std::uint64_t low = 0;
+
+  /** The 32 lowercase hex digits of the digest, high word first. */
+  std::string toString() const;
+
+  bool operator==(const ModelHash& other) const {
+    return high == other.high && low == other.low;
+  }
+
+  bool operator!=(const ModelHash& other) const {
+    return !(*this == other);
+  }
+};
+
+/**
+ * Hashes a sequence of values into a ModelHash. The two 64-bit lanes are
+ * seeded and combined differently and each word is run through the
+ * SplitMix64 finalizer, so the digest is fast and well mixed but not
+ * cryptographic: it is for recognizing models, not for security. Doubles
+ * are hashed by value, with -0 the same as 0 and every NaN the same, so
+ * models that compare equal hash equal however their values were computed.
+ */
+class ISOMODEL_API ModelHasher
+{
+public:
+  void add(std::uint64_t word);
+  void add(double value);
+  void add(const std::string& text);
+
+  ModelHash digest() const;
+
+private:
+  std::uint64_t m_high = 0x243F6A8885A308D3ull;
+  std::uint64_t m_low = 0x13198A2E03707344ull;
+  std::uint64_t m_words = 0;
+};
+
+} // isomodel
+} // openstudio
+#endif // ISOMODEL_MODEL_HASH_HPP
@@ -0,0 +1,342 @@
+#include "MonteCarlo.hpp"
+#include "CounterRng.hpp"
+#include "WorkStealingPool.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+
+#include <boost/algorithm/string/trim.hpp>
+#include <boost/tokenizer.hpp>
+
+namespace openstudio {
+namespace isomodel {
+
+namespace {
+
+const char* const endUseNames[] = { "ElecHeat", "ElecCool", "ElecIntLights", "ElecExtLights", "ElecFans", "ElecPump", "ElecEquipInt",
+                                    "ElecEquipExt", "ElectDHW", "GasHeat", "GasCool", "GasEquip", "GasDHW" };
+
+const double pi = 3.14159265358979323846;
+
+double standardNormal(double u1, double u2)
+{
+  // Box-Muller.
+  return std::sqrt(-2.0 * std::log(u1)) * std::cos(2.0 * pi * u2);
+}
+
+std::string periodName(int period)
+{
+  return period < 12 ? std::to_string(period + 1) : std::string("Year");
+}
+
+} // namespace
+
+UncertainParameter UncertainParameter::parse(const std::string& property, const std::string& declaration)
+{
+  UncertainParameter parameter;
+  parameter.property = property;
+
+  boost::tokenizer<boost::escaped_list_separator<char> > tokens(declaration);
+  for (auto token : tokens) {
+    boost::algorithm::trim(token);
+    if (parameter.distribution.empty()) {
+      parameter.distribution = token;
+      continue;
+    }
+    try {
+      parameter.parameters.push_back(std::stod(token));
+    } catch (const std::exception&) {
+      throw std::invalid_argument("Distribution parameter '" + token + "' of " + property + " is not a number");
+    }
+  }
+
+  const auto& name = parameter.distribution;
+  const auto& p = parameter.parameters;
+  std::size_t expected;
+  bool valid;
+  if (name == "normal" || name == "lognormal") {
+    expected = 2;
+    valid = p.size() == expected && p[1] >= 0.0;
+  } else if (name == "uniform") {
+    expected = 2;
+    valid = p.size() == expected && p[0] <= p[1];
+  } else if (name == "triangular") {
+    expected = 3;
+    valid = p.size() == expected && p[0] <= p[1] && p[1] <= p[2] && p[0] < p[2];
+  } else {
+    throw std::invalid_argument("Unknown distribution '" + name + "' for " + property +
+                                ". Use normal, uniform, triangular or lognormal.");
+  }
+  if (!valid) {
+    throw std::invalid_argument("Invalid " + name + " distribution for " + property + ": expected " + std::to_string(expected) +
+                                " parameters in order");
+  }
+  return parameter;
+}
+
+double UncertainParameter::sample(double u1, double u2) const
+{
+  const auto& p = parameters;
+  if (distribution == "normal") {
+    return p[0] + p[1] * standardNormal(u1, u2);
+  } else if (distribution == "lognormal") {
+    return std::exp(p[0] + p[1] * standardNormal(u1, u2));
+  } else if (distribution == "uniform") {
+    return p[0] + u1 * (p[1] - p[0]);
+  } else {
+    // Inverse of the triangular distribution's CDF.
+    auto low = p[0], mode = p[1], high = p[2];
+    if (u1 < (mode - low) / (high - low)) {
+      return low + std::sqrt(u1 * (high - low) * (mode - low));
+    }
+    return high - std::sqrt((1.0 - u1) * (high - low) * (high - mode));
+  }
+}
+
+MonteCarloSpec MonteCarloSpec::read(const std::string& path)
+{
+  try {
+    return read(Properties(path));
+  } catch (std::domain_error* e) {
+    // Properties throws pointers.
+    std::string message = e->what();
+    delete e;
+    throw std::invalid_argument(message);
+  }
+}
+
+MonteCarloSpec MonteCarloSpec::read(const Properties& props)
+{
+  MonteCarloSpec spec;
+  for (auto key = props.keys_begin(); key != props.keys_end(); ++key) {
+    if (*key == "samples" || *key == "seed" || *key == "threads" || *key == "chunk" || *key == "bins") {
+      auto value = props.getPropertyAsInt(*key);
+      if (!value || *value < 0) {
+        throw std::invalid_argument("Monte Carlo " + *key + " must be a non-negative integer");
+      }
+      auto count = static_cast<std::size_t>(*value);
+      if (*key == "samples") {
+        spec.samples = count;
+      } else if (*key == "seed") {
+        spec.seed = count;
+      } else if (*key == "threads") {
+        spec.threads = count;
+      } else if (*key == "chunk") {
+        spec.chunk = count;
+      } else {
+        spec.bins = count;
+      }
+    } else if (*key == "engine") {
+      auto engine = *props.getProperty(*key);
+      if (engine != "monthly" && engine != "hourly") {
+        throw std::invalid_argument("Unknown Monte Carlo engine '" + engine + "'. Use monthly or hourly.");
+      }
+      spec.hourly = engine == "hourly";
+    } else if (*key == "quantiles") {
+      if (!props.getPropertyAsDoubleVector(*key, spec.quantiles)) {
+        throw std::invalid_argument("Monte Carlo quantiles must be a list of probabilities");
+      }
+      for (auto probability : spec.quantiles) {
+        if (!(probability >= 0.0 && probability <= 1.0)) {
+          throw std::invalid_argument("Monte Carlo quantiles must be between 0 and 1");
+        }
+      }
+    } else {
+      spec.parameters.push_back(UncertainParameter::parse(*key, *props.getProperty(*key)));
+    }
+  }
+
+  if (spec.chunk == 0 || spec.bins == 0) {
+    throw std::invalid_argument("Monte Carlo chunk and bins must be positive");
+  }
+  return spec;
+}
+
+std::vector<double> MonteCarloSpec::sample(std::size_t index) const
+{
+  // Each sample is its own stream and each parameter uses two numbers of it.
+  CounterRng rng(seed);
+  std::vector<double> values;
+  for (std::size_t d = 0; d < parameters.size(); ++d) {
+    values.push_back(parameters[d].sample(rng.uniform(index, 2 * d), rng.uniform(index, 2 * d + 1)));
+  }
+  return values;
+}
+
+MonteCarloResults::MonteCarloResults(const MonteCarloSpec& spec) : m_quantiles(spec.quantiles)
+{
+  OutputStatistics output;
+  for (auto probability : spec.quantiles) {
+    output.quantiles.push_back(P2Quantile(probability));
+  }
+  m_outputs.assign(13 * periods, output);
+}
+
+const OutputStatistics& MonteCarloResults::statistics(int endUse, int period) const
+{
+  return m_outputs.at(endUse * periods + period);
+}
+
+OutputStatistics& MonteCarloResults::statistics(int endUse, int period)
+{
+  return m_outputs.at(endUse * periods + period);
+}
+
+std::size_t MonteCarloResults::samples() const
+{
+  return m_outputs.empty() ? 0 : m_outputs[0].stats.count();
+}
+
+void MonteCarloResults::addFailure(const std::string& error)
+{
+  if (m_failures++ == 0) {
+    m_firstError = error;
+  }
+}
+
+void MonteCarloResults::writeSummary(std::ostream& out) const
+{
+  out << "EndUse,Period,Count,Mean,StdDev,Min,Max";
+  for (auto probability : m_quantiles) {
+    out << ",P" << probability * 100;
+  }
+  out << "\n" << std::setprecision(10);
+
+  for (int endUse = 0; endUse < 13; ++endUse) {
+    for (int period = 0; period < periods; ++period) {
+      const auto& output = statistics(endUse, period);
+      out << endUseNames[endUse] << "," << periodName(period) << "," << output.stats.count() << "," << output.stats.mean() << ","
+          << output.stats.standardDeviation() << "," << output.stats.min() << "," << output.stats.max();
+      for (const auto& quantile : output.quantiles) {
+        out << "," << quantile.value();
+      }
+      out << "\n";
+    }
+  }
+  out.flush();
+}
+
+void MonteCarloResults::writeHistograms(std::ostream& out) const
+{
+  out << "EndUse,Period,Low,High,Count\n" << std::setprecision(10);
+  for (int endUse = 0; endUse < 13; ++endUse) {
+    for (int period = 0; period < periods; ++period) {
+      const auto& histogram = statistics(endUse, period).histogram;
+      auto prefix = std::string(endUseNames[endUse]) + "," + periodName(period) + ",";
+      out << prefix << "," << histogram.low() << "," << histogram.underflow() << "\n";
+      for (std::size_t bin = 0; bin < histogram.bins(); ++bin) {
+        out << prefix << histogram.binLow(bin) << "," << histogram.binLow(bin + 1) << "," << histogram.counts()[bin] << "\n";
+      }
+      out << prefix << histogram.high() << ",," << histogram.overflow() << "\n";
+    }
+  }
+  out.flush();
+}
+
+MonteCarlo::MonteCarlo(const std::string& baseIsmPath, const std::string& defaultsPath) : m_sweep(baseIsmPath, defaultsPath)
+{
+}
+
+MonteCarloResults MonteCarlo::run(const MonteCarloSpec& spec) const
+{
+  if (spec.chunk == 0) {
+    throw std::invalid_argument("Monte Carlo chunk must be positive");
+  }
+
+  std::vector<std::string> properties;
+  for (const auto& parameter : spec.parameters) {
+    properties.push_back(parameter.property);
+  }
+
+  MonteCarloResults results(spec);
+  WorkStealingPool pool(spec.threads);
+  bool histogramsSet = false;
+
+  // Each slot holds the 13 end uses by 13 periods of one sample of the
+  // chunk, or is empty if the sample failed.
+  std::vector<std::vector<double> > outputs;
+  std::vector<std::string> errors;
+  std::vector<char> cancelled;
+  for (std::size_t first = 0; first < spec.samples && !results.cancelled(); first += spec.chunk) {
+    auto size = std::min(spec.chunk, spec.samples - first);
+    outputs.assign(size, std::vector<double>());
+    errors.assign(size, std::string());
+    cancelled.assign(size, false);
+
+    std::vector<std::function<void()> > tasks;
+    for (std::size_t i = 0; i < size; ++i) {
+      tasks.push_back([&, i]() {
+        try {
+          auto months = m_sweep.simulate(properties, spec.sample(first + i), spec.hourly, &spec.cancellation);
+          std::vector<double> output(13 * MonteCarloResults::periods, 0.0);
+          for (int month = 0; month < 12; ++month) {
+            for (int endUse = 0; endUse < 13; ++endUse) {
+#ifdef ISOMODEL_STANDALONE
+              auto value = months[month].getEndUse(endUse);
+#else
+              auto value = months[month].getEndUse(isoResultsEndUseTypes[endUse].first, isoResultsEndUseTypes[endUse].second);
+#endif
+              output[endUse * MonteCarloResults::periods + month] = value;
+              output[endUse * MonteCarloResults::periods + 12] += value;
+            }
+          }
+          outputs[i] = std::move(output);
+        } catch (const SimulationCancelled&) {
+          cancelled[i] = true;
+        } catch (const std::exception& e) {
+          errors[i] = e.what();
+        }
+      });
+    }
+    pool.run(tasks);
+    results.setCancelled(spec.cancellation.cancelled());
+
+    if (!histogramsSet) {
+      // Size each histogram to the spread of the first chunk.
+      for (std::size_t j = 0; j < 13 * MonteCarloResults::periods; ++j) {
+        auto low = 0.0, high = 0.0;
+        bool any = false;
+        for (const auto& output : outputs) {
+          if (!output.empty()) {
+            low = any ? std::min(low, output[j]) : output[j];
+            high = any ? std::max(high, output[j]) : output[j];
+            any = true;
+          }
+        }
+        if (!any) {
+          break;
+        }
+        auto pad = high > low ? (high - low) / 2 : std::max(std::abs(low) * 0.01, 1e-9);
+        results.statistics(static_cast<int>(j / MonteCarloResults::periods), static_cast<int>(j % MonteCarloResults::periods))
+          .histogram = Histogram(low - pad, high + pad, spec.bins);
+        histogramsSet = true;
+      }
+    }
+
+    for (std::size_t i = 0; i < size; ++i) {
+      if (cancelled[i]) {
+        continue;
+      }
+      if (outputs[i].empty()) {
+        results.addFailure(errors[i]);
+        continue;
+      }
+      for (std::size_t j = 0; j < outputs[i].size(); ++j) {
+        auto& output = results.statistics(static_cast<int>(j / MonteCarloResults::periods), static_cast<int>(j % MonteCarloResults::periods));
+        output.stats.add(outputs[i][j]);
+        for (auto& quantile : output.quantiles) {
+          quantile.add(outputs[i][j]);
+        }
+        output.histogram.add(outputs[i][j]);
+      }
+    }
+  }
+  return results;
+}
+
+} // isomodel
+} // openstudio
@@ -0,0 +1,175 @@
+#ifndef ISOMODEL_MONTE_CARLO_HPP
+#define ISOMODEL_MONTE_CARLO_HPP
+
+#include "ISOModelAPI.hpp"
+#include "OnlineStatistics.hpp"
+#include "ParametricSweep.hpp"
+#include "Properties.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace openstudio {
+namespace isomodel {
+
+/**
+ * An .ism property whose value is uncertain, and the distribution it is drawn
+ * from. The distributions and their parameters are:
+ *
+ * normal: mean, standard deviation<br>
+ * uniform: low, high<br>
+ * triangular: low, mode, high<br>
+ * lognormal: mean and standard deviation of the value's logarithm
+ */
+struct ISOMODEL_API UncertainParameter
+{
+  std::string property;
+  std::string distribution;
+  std::vector<double> parameters;
+
+  /**
+   * Parses a declaration such as "normal, 10, 1". Throws
+   * std::invalid_argument for unknown distributions or invalid parameters.
+   */
+  static UncertainParameter parse(const std::string& property, const std::string& declaration);
+
+  /** Transforms two independent uniform numbers in (0, 1) into a draw from the distribution. */
+  double sample(double u1, double u2) const;
+};
+
+/**
+ * What a Monte Carlo run draws and how. Read from a file of key = value lines
+ * (the .ism format):
+ *
+ * samples = 1000<br>
+ * seed = 42<br>
+ * lightingpowerdensityoccupied = normal, 10, 1<br>
+ * coolingsystemcop = triangular, 2.5, 3, 4
+ *
+ * The keys samples, seed, engine ("monthly" or "hourly"), threads, chunk,
+ * bins and quantiles (a list of probabilities) configure the run. Every other
+ * key names a scalar .ism property and declares its distribution.
+ */
+struct ISOMODEL_API MonteCarloSpec
+{
+  std::size_t samples = 0;
+  std::uint64_t seed = 0;
+  bool hourly = false; // Run the hourly model instead of the monthly one.
+  std::size_t threads = 0; // Worker threads, or 0 for one per hardware thread.
+  std::size_t chunk = 256; // Samples evaluated before their results are reduced.
+  std::size_t bins = 20; // Histogram bins per output.
+  std::vector<double> quantiles = { 0.05, 0.5, 0.95 };
+  std::vector<UncertainParameter> parameters;
+  // Cancel to stop the run after the samples in progress. Hourly samples stop
+  // within a simulated day.
+  CancellationToken cancellation;
+
+  /** Reads a spec from a file. Throws std::invalid_argument if it is malformed. */
+  static MonteCarloSpec read(const std::string& path);
+
+  /** Reads a spec from parsed properties. Throws std::invalid_argument if it is malformed. */
+  static MonteCarloSpec read(const Properties& props);
+
+  /**
+   * Returns the property values of sample index. Sample i always gets the
+   * same values for a given seed, whichever thread draws it.
+   */
+  std::vector<double> sample(std::size_t index) const;
+};
+
+// Everything kept about one output of a Monte Carlo run.
+struct OutputStatistics
+{
+  RunningStats stats;
+  std::vector<P2Quantile> quantiles; // In the order of MonteCarloSpec::quantiles.
+  Histogram histogram;
+};
+
+/**
+ * The reduced outputs of a Monte Carlo run: statistics of each of the 13 end
+ * uses for each month and for the year. Only these summaries are kept, never
+ * the individual samples.
+ */
+class ISOMODEL_API MonteCarloResults
+{
+public:
+  static const int periods = 13; // The 12 months, then the year.
+
+  MonteCarloResults() = default;
+  explicit MonteCarloResults(const MonteCarloSpec& spec);
+
+  /** The statistics of endUse (0 to 12) for period (0 to 11 for the months, 12 for the year). */
+  const OutputStatistics& statistics(int endUse, int period) const;
+  OutputStatistics& statistics(int endUse, int period);
+
+  /** The number of samples that ran successfully. */
+  std::size_t samples() const;
+
+  std::size_t failures() const {
+    return m_failures;
+  }
+  /** The error of the first sample that failed. */
+  const std::string& firstError() const {
+    return m_firstError;
+  }
+  void addFailure(const std::string& error);
+
+  /** Whether the run was cancelled, so the statistics cover only the samples that finished first. */
+  bool cancelled() const {
+    return m_cancelled;
+  }
+  void setCancelled(bool value) {
+    m_cancelled = value;
+  }
+
+  /**
+   * Writes a CSV row per end use and period: the count, mean, standard
+   * deviation, minimum, maximum and the quantiles.
+   */
+  void writeSummary(std::ostream& out) const;
+
+  /** Writes a CSV row per end use, period and histogram bin with the bin's range and count. */
+  void writeHistograms(std::ostream& out) const;
+
+private:
+  std::vector<double> m_quantiles;
+  std::vector<OutputStatistics> m_outputs;
+  std::size_t m_failures = 0;
+  std::string m_firstError;
+  bool m_cancelled = false;
+};
+
+/**
+ * Propagates uncertainty in a building's properties to its energy use. Draws
+ * samples of the uncertain properties, runs each as a variant of the base
+ * building (see ParametricSweep) in parallel, and reduces the results as they
+ * arrive, so memory use depends on the chunk size rather than the number of
+ * samples.
+ */
+class ISOMODEL_API MonteCarlo
+{
+public:
+  explicit MonteCarlo(const std::string& baseIsmPath, const std::string& defaultsPath = std::string());
+
+  /**
+   * Runs spec.samples samples. The samples are evaluated spec.chunk at a time
+   * and reduced in sample order, so the results are the same for any number
+   * of threads. Samples that fail to run are counted and skipped. The
+   * histogram ranges are set from the first chunk, widened by half its range
+   * on each side; later values outside them are counted as under- or
+   * overflow. If spec.cancellation is cancelled, the run stops and returns
+   * the statistics of the samples that finished; cancelled samples are not
+   * counted as failures.
+   */
+  MonteCarloResults run(const MonteCarloSpec& spec) const;
+
+private:
+  ParametricSweep m_sweep;
+};
+
+} // isomodel
+} // openstudio
+#endif // ISOMODEL_MONTE_CARLO_HPP
@@ -23,41 +23,11 @@
 namespace openstudio {
 namespace isomodel {
 
-//Utility Functions -- breaks when you attempt to move into the .hpp
-void printVector(const char* vecName, Vector vec)
-{
-  if (DEBUG_ISO_MODEL_SIMULATION) {
-    std::cout << vecName << "(" << vec.size() << ") = [";
-    if (vec.size() > 0) {
-      std::cout << vec[0];
-      for (unsigned int i = 1; i < vec.size(); i++) {
-        std::cout << ", " << vec[i];
-      }
-    }
-    std::cout << "]" << std::endl;
-  }
-}
-void printMatrix(const char* matName, Matrix mat)
-{
-  if (DEBUG_ISO_MODEL_SIMULATION) {
-    std::cout << matName << "(" << mat.size1() << ", " << mat.size2() << "): " << std::endl << "\t";
-    for (unsigned int j = 0; j < mat.size2(); j++) {
-      std::cout << "," << j;
-    }
-    std::cout << std::endl;
-    for (unsigned int i = 0; i < mat.size1(); i++) {
-      std::cout << "\t" << i;
-      for (unsigned int j = 0; j < mat.size2(); j++) {
-        std::cout << "," << mat(i, j);
-      }
-      std::cout << std::endl;
-    }
-  }
-}
 /**
  * Initializes a vector to the specified value
  */
-void vectorInit(Vector& vec, double val)
+template<typename T>
+void vectorInit(BasicVector<T>& vec, double val)
 {
   for (unsigned int i = 0; i < vec.size(); i++) {
     vec[i] = val;
@@ -66,14 +36,16 @@ void vectorInit(Vector& vec, double val)
 /**
  * Initializes a vector to 0
  */
-void zero(Vector& vec)
+template<typename T>
+void zero(BasicVector<T>& vec)
 {
   vectorInit(vec, 0);
 }
 /**
  * Initializes a vector to 1
  */
-void one(Vector& vec)
+template<typename T>
+void one(BasicVector<T>& vec)
 {
   vectorInit(vec, 1);
 }
@@ -89,6 +61,21 @@ Vector prod(const Matrix& m, const Vector& v)
 {
   return boost::numeric::ublas::prod(m, v);
 }
+/// matrix-vector product for other scalar types
+template<typename T>
+BasicVector<T> prod(const BasicMatrix<T>& m, const BasicVector<T>& v)
+{
+  BasicVector<T> vp(m.size1());
+  for (unsigned int i = 0; i < m.size1(); i++) {
+    T s = 0;
+    for (unsigned int j = 0; j < m.size2(); j++) {
+      s += m(i, j) * v[j];
+    }
+    vp[i] = s;
+  }
+  return vp;
+}
+
 /// array-scalar product
 Vector mult(const double* v1, const double s1, int size)
 {
@@ -286,44 +273,40 @@ const double EECALC_NUM_HOURS = 24;
 const double EECALC_WEEKDAY_START = 7;
 const double kWh2MJ = 3.6f;
 
-// TODO: All member variables initialized in the constructor should eventually be initialized
-// by the .ism file or a default initialization of some sort.
-MonthlyModel::MonthlyModel() {}
-MonthlyModel::~MonthlyModel() {}
-
 //Solver functions
-void MonthlyModel::scheduleAndOccupancy(Vector& weekdayOccupiedMegaseconds, Vector& weekdayUnoccupiedMegaseconds, Vector& weekendOccupiedMegaseconds,
-    Vector& weekendUnoccupiedMegaseconds, Vector& clockHourOccupied, Vector& clockHourUnoccupied, double& frac_hrs_wk_day,
-    double& hoursUnoccupiedPerDay, double& hoursOccupiedPerDay, double& frac_hrs_wk_nt, double& frac_hrs_wke_tot) const
+template<typename T>
+void BasicMonthlyModel<T>::scheduleAndOccupancy(Vector& weekdayOccupiedMegaseconds, Vector& weekdayUnoccupiedMegaseconds, Vector& weekendOccupiedMegaseconds,
+    Vector& weekendUnoccupiedMegaseconds, Vector& clockHourOccupied, Vector& clockHourUnoccupied, T& frac_hrs_wk_day,
+    T& hoursUnoccupiedPerDay, T& hoursOccupiedPerDay, T& frac_hrs_wk_nt, T& frac_hrs_wke_tot) const
 {
   hoursOccupiedPerDay = pop.hoursEnd() - pop.hoursStart();
   if (hoursOccupiedPerDay < 0) {
     hoursOccupiedPerDay += 24;
   }
-  double daysOccupiedPerWeek = pop.daysEnd() - pop.daysStart() + 1;
+  T daysOccupiedPerWeek = pop.daysEnd() - pop.daysStart() + 1;
   if (daysOccupiedPerWeek < 0) {
     daysOccupiedPerWeek += 7;
   }
 
-  double hoursOccupiedDuringWeek = hoursOccupiedPerDay * daysOccupiedPerWeek;
+  T hoursOccupiedDuringWeek = hoursOccupiedPerDay * daysOccupiedPerWeek;
   frac_hrs_wk_day = hoursOccupiedDuringWeek / hoursInWeek;
 
   hoursUnoccupiedPerDay = 24 - hoursOccupiedPerDay;
-  double hoursUnoccupiedDuringWeek = (daysOccupiedPerWeek - 1) * hoursUnoccupiedPerDay;
+  T hoursUnoccupiedDuringWeek = (daysOccupiedPerWeek - 1) * hoursUnoccupiedPerDay;
   frac_hrs_wk_nt = hoursUnoccupiedDuringWeek / hoursInWeek;
 
-  double occupationDensity = pop.densityOccupied();
-  double unoccupiedDensity = pop.densityUnoccupied();
-  double densityRatio = occupationDensity / unoccupiedDensity;
+  T occupationDensity = pop.densityOccupied();
+  T unoccupiedDensity = pop.densityUnoccupied();
+  T densityRatio = occupationDensity / unoccupiedDensity;
 
-  double totalWeekendHours = hoursInWeek - hoursOccupiedDuringWeek - hoursUnoccupiedDuringWeek;
+  T totalWeekendHours = hoursInWeek - hoursOccupiedDuringWeek - hoursUnoccupiedDuringWeek;
   frac_hrs_wke_tot = totalWeekendHours / hoursInWeek;
 
-  double weekendHoursOccupied = (7 - daysOccupiedPerWeek) * hoursOccupiedPerDay;
-  double frac_hrs_wke_day = weekendHoursOccupied / hoursInWeek;
+  T weekendHoursOccupied = (7 - daysOccupiedPerWeek) * hoursOccupiedPerDay;
+  T frac_hrs_wke_day = weekendHoursOccupied / hoursInWeek;
 
-  double weekendHoursUnoccupied = totalWeekendHours - weekendHoursOccupied;
-  double frac_hrs_wke_nt = weekendHoursUnoccupied / hoursInWeek;
+  T weekendHoursUnoccupied = totalWeekendHours - weekendHoursOccupied;
+  T frac_hrs_wke_nt = weekendHoursUnoccupied / hoursInWeek;
 
   for (int m = 0; m < EECALC_NUM_MONTHS; m++) {
     weekdayOccupiedMegaseconds[m] = megasecondsInMonth[m] * frac_hrs_wk_day;
@@ -346,7 +329,8 @@ void MonthlyModel::scheduleAndOccupancy(Vector& weekdayOccupiedMegaseconds, Vect
  * Breaks down the solar radiation and temperature data into day, night,
  * weekday and weekend vectors, as appropriate.
  */
-void MonthlyModel::solarRadiationBreakdown(const Vector& weekdayOccupiedMegaseconds, const Vector& weekdayUnoccupiedMegaseconds,
+template<typename T>
+void BasicMonthlyModel<T>::solarRadiationBreakdown(const Vector& weekdayOccupiedMegaseconds, const Vector& weekdayUnoccupiedMegaseconds,
     const Vector& weekendOccupiedMegaseconds, const Vector& weekendUnoccupiedMegaseconds, const Vector& clockHourOccupied,
     const Vector& clockHourUnoccupied, Vector& v_hrs_sun_down_mo, Vector& frac_Pgh_wk_nt, Vector& frac_Pgh_wke_day, Vector& frac_Pgh_wke_nt,
     Vector& v_Tdbt_nt, Vector& v_Tdbt_Day) const
@@ -432,18 +416,19 @@ void MonthlyModel::solarRadiationBreakdown(const Vector& weekdayOccupiedMegaseco
 /**
  * Compute lighting energy use as per prEN 15193:2006.
  */
-void MonthlyModel::lightingEnergyUse(const Vector& v_hrs_sun_down_mo, double& Q_illum_occ, double& Q_illum_unocc, double& Q_illum_tot_yr,
+template<typename T>
+void BasicMonthlyModel<T>::lightingEnergyUse(const Vector& v_hrs_sun_down_mo, T& Q_illum_occ, T& Q_illum_unocc, T& Q_illum_tot_yr,
     Vector& v_Q_illum_tot, Vector& v_Q_illum_ext_tot) const
 {
-  double lpd_occ = lights.powerDensityOccupied();
-  double lpd_unocc = lights.powerDensityUnoccupied();
+  T lpd_occ = lights.powerDensityOccupied();
+  T lpd_unocc = lights.powerDensityUnoccupied();
 
   // Daylight sensor dimming fraction.
-  double F_D = lights.dimmingFraction();
+  T F_D = lights.dimmingFraction();
   // Occupancy sensor control fraction.
-  double F_O = building.lightingOccupancySensor();
+  T F_O = building.lightingOccupancySensor();
   // Constant illimance control fraction.
-  double F_C = building.constantIllumination();
+  T F_C = building.constantIllumination();
 
   // TODO: The following assumes day starts at hour 7 and ends at hour 19
   // and 2 weeks per year are considered completely unoccupied for lighting
@@ -451,22 +436,22 @@ void MonthlyModel::lightingEnergyUse(const Vector& v_hrs_sun_down_mo, double& Q_
   // average sunup and sundown times.
 
   // Lighting operational hours during the daytime.
-  double hoursOccupied = std::min(lights.n_day_end(), pop.hoursEnd()) - std::max(pop.hoursStart(), lights.n_day_start());
+  T hoursOccupied = std::min(lights.n_day_end(), pop.hoursEnd()) - std::max(pop.hoursStart(), lights.n_day_start());
   if (hoursOccupied < 0) {
     hoursOccupied += 24;
   }
-  double daysOccupied = pop.daysEnd() - pop.daysStart() + 1;
+  T daysOccupied = pop.daysEnd() - pop.daysStart() + 1;
   if (daysOccupied < 0) {
     daysOccupied += 7;
   }
-  double t_lt_D = hoursOccupied * daysOccupied * lights.n_weeks();
+  T t_lt_D = hoursOccupied * daysOccupied * lights.n_weeks();
 
   // Lighting operational hours during the nighttime.
-  hoursOccupied = std::max(lights.n_day_start() - pop.hoursStart(), 0.0) + std::max(pop.hoursEnd() - lights.n_day_end(), 0.0);
-  double t_lt_N = hoursOccupied * daysOccupied * lights.n_weeks();
+  hoursOccupied = std::max<T>(lights.n_day_start() - pop.hoursStart(), 0.0) + std::max<T>(pop.hoursEnd() - lights.n_day_end(), 0.0);
+  T t_lt_N = hoursOccupied * daysOccupied * lights.n_weeks();
 
   // Unoccupied hours.
-  double t_unocc = hoursInYear - t_lt_D - t_lt_N;
+  T t_unocc = hoursInYear - t_lt_D - t_lt_N;
 
   // Total lighting energy for occupied times (kWh).
   Q_illum_occ = structure.floorArea() * lpd_occ * F_C * F_O * (t_lt_D * F_D + t_lt_N) / 1000.0;
@@ -484,8 +469,9 @@ void MonthlyModel::lightingEnergyUse(const Vector& v_hrs_sun_down_mo, double& Q_
 /**
  * Compute envelope parameters as per ISO 13790 8.3.
  */
-void MonthlyModel::envelopCalculations(Vector& v_win_A, Vector& v_wall_emiss, Vector& v_wall_alpha_sc, Vector& v_wall_U, Vector& v_wall_A,
-    double& H_tr) const
+template<typename T>
+void BasicMonthlyModel<T>::envelopCalculations(Vector& v_win_A, Vector& v_wall_emiss, Vector& v_wall_alpha_sc, Vector& v_wall_U, Vector& v_wall_A,
+    T& H_tr) const
 {
   // TODO: Copying the various structure values to new variables (e.g. v_wall_A) is not necessary. BAA@2015-07-13.
   v_wall_A = structure.wallArea();
@@ -499,13 +485,13 @@ void MonthlyModel::envelopCalculations(Vector& v_win_A, Vector& v_wall_emiss, Ve
   // Compute direct transmission heat transfer coefficient to exterior in as per ISO 13790 8.3.1 (W/K).
   // Ignore linear and point thermal bridges for now.
   // TODO: Implement thermal bridges. BAA@2015-07-13.
-  double H_D = sum(v_env_UA);
+  T H_D = sum(v_env_UA);
 
   // For now, also ignore heat transfer to ground (minimal in large buildings), unconditioned spaces, and adjacent buildings.
   // TODO: Implement ground, unconditioned, and adjacent above heat transfer coefficients. BAA@2015-07-13.
-  double H_g = 0;
-  double H_U = 0;
-  double H_A = 0;
+  T H_g = 0;
+  T H_U = 0;
+  T H_A = 0;
 
   // Total transmission heat transfer coefficient. ISO 13790 8.3.1 eq. 17.
   H_tr = H_D + H_g + H_U + H_A;
@@ -517,7 +503,8 @@ void MonthlyModel::envelopCalculations(Vector& v_win_A, Vector& v_wall_emiss, Ve
 /*
  * Compute window solar gain per ISO 13790 11.3.
  */
-void MonthlyModel::windowSolarGain(const Vector& v_win_A, const Vector& v_wall_emiss, const Vector& v_wall_alpha_sc, const Vector& v_wall_U,
+template<typename T>
+void BasicMonthlyModel<T>::windowSolarGain(const Vector& v_win_A, const Vector& v_wall_emiss, const Vector& v_wall_alpha_sc, const Vector& v_wall_U,
     const Vector& v_wall_A, Vector& v_wall_A_sol, Vector& v_win_hr, Vector& v_wall_R_sc, Vector& v_win_A_sol) const
 {
   // TODO: The solar heat gain could be improved
@@ -547,7 +534,7 @@ void MonthlyModel::windowSolarGain(const Vector& v_win_A, const Vector& v_wall_e
     // Assign SDF based on pulldown value of 1, 2 or 3.
     // TODO: This needs to be clarified in the .ism file as it's not obvious that the
     // window SDF is a magic number rather than the actual value. BAA@2015-07-13 BAA@2015-07-143
-    v_win_SDF[i] = n_win_SDF_table[((int) structure.windowShadingDevice()[i]) - 1];
+    v_win_SDF[i] = n_win_SDF_table[static_cast<int>(scalarValue(structure.windowShadingDevice()[i])) - 1];
     // Set the SDF fractions which include heat transfer - set at 100% for now.
     v_win_SDF_frac[i] = 1.0;
   }
@@ -581,7 +568,8 @@ void MonthlyModel::windowSolarGain(const Vector& v_win_A, const Vector& v_wall_e
 /**
  * Calculate solar heat gain. ISO 13790 11.3.2.
  */
-void MonthlyModel::solarHeatGain(const Vector& v_win_A_sol, const Vector& v_wall_R_sc, const Vector& v_wall_U, const Vector& v_wall_A,
+template<typename T>
+void BasicMonthlyModel<T>::solarHeatGain(const Vector& v_win_A_sol, const Vector& v_wall_R_sc, const Vector& v_wall_U, const Vector& v_wall_A,
     const Vector& v_win_hr, const Vector& v_wall_A_sol, Vector& v_E_sol) const
 {
   // EN ISO 13790 11.3.2 eq. 43.
@@ -613,7 +601,7 @@ void MonthlyModel::solarHeatGain(const Vector& v_win_A_sol, const Vector& v_wall
     }
     m_I_sol(r, m_I_sol.size2() - 1) = location.weather()->mEgh()[r];
   }
-  printMatrix("m_I_sol", m_I_sol);
+  traceMatrix("m_I_sol", m_I_sol);
 
   // Compute the total solar heat gain for the glazing area.
   Vector v_win_phi_sol(12);
@@ -658,13 +646,13 @@ void MonthlyModel::solarHeatGain(const Vector& v_win_A_sol, const Vector& v_wall
     v_wall_phi_sol[i] = sum(temp);
   }
 
-  printVector("v_wall_phi_r", v_wall_phi_r);
-  printVector("v_win_phi_sol", v_win_phi_sol);
-  printVector("v_wall_phi_sol", v_wall_phi_sol);
+  traceVector("v_wall_phi_r", v_wall_phi_r);
+  traceVector("v_win_phi_sol", v_win_phi_sol);
+  traceVector("v_wall_phi_sol", v_wall_phi_sol);
 
   // Total envelope solar heat gain (W).
   Vector v_phi_sol = sum(v_win_phi_sol, v_wall_phi_sol);
-  printVector("v_phi_sol", v_phi_sol);
+  traceVector("v_phi_sol", v_phi_sol);
 
   // Total envelope solar heat gain (MJ).
   v_E_sol = mult(v_phi_sol, megasecondsInMonth);
@@ -673,22 +661,23 @@ void MonthlyModel::solarHeatGain(const Vector& v_win_A_sol, const Vector& v_wall
 /**
  * Compute internal heat gains and losses.
  */
-void MonthlyModel::heatGainsAndLosses(double frac_hrs_wk_day, double Q_illum_occ, double Q_illum_unocc, double Q_illum_tot_yr, double& phi_int_avg,
-    double& phi_plug_avg, double& phi_illum_avg, double& phi_int_wke_nt, double& phi_int_wke_day, double& phi_int_wk_nt) const
+template<typename T>
+void BasicMonthlyModel<T>::heatGainsAndLosses(T frac_hrs_wk_day, T Q_illum_occ, T Q_illum_unocc, T Q_illum_tot_yr, T& phi_int_avg,
+    T& phi_plug_avg, T& phi_illum_avg, T& phi_int_wke_nt, T& phi_int_wke_day, T& phi_int_wk_nt) const
 {
   // Internal heat gains from people (W/m2).
-  double phi_int_occ = pop.heatGainPerPerson() / pop.densityOccupied();
-  double phi_int_unocc = pop.heatGainPerPerson() / pop.densityUnoccupied();
+  T phi_int_occ = pop.heatGainPerPerson() / pop.densityOccupied();
+  T phi_int_unocc = pop.heatGainPerPerson() / pop.densityUnoccupied();
   phi_int_avg = frac_hrs_wk_day * phi_int_occ + (1 - frac_hrs_wk_day) * phi_int_unocc;
 
   // Internal heat gain from appliances (W/m2).
-  double phi_plug_occ = building.electricApplianceHeatGainOccupied() + building.gasApplianceHeatGainOccupied();
-  double phi_plug_unocc = building.electricApplianceHeatGainUnoccupied() + building.gasApplianceHeatGainUnoccupied();
+  T phi_plug_occ = building.electricApplianceHeatGainOccupied() + building.gasApplianceHeatGainOccupied();
+  T phi_plug_unocc = building.electricApplianceHeatGainUnoccupied() + building.gasApplianceHeatGainUnoccupied();
   phi_plug_avg = phi_plug_occ * frac_hrs_wk_day + phi_plug_unocc * (1 - frac_hrs_wk_day);
 
   // Internal heat gain from illumination (W/m2).
-  double phi_illum_occ = Q_illum_occ / structure.floorArea() / hoursInYear / frac_hrs_wk_day * 1000;
-  double phi_illum_unocc = Q_illum_unocc / structure.floorArea() / hoursInYear / (1 - frac_hrs_wk_day) * 1000;
+  T phi_illum_occ = Q_illum_occ / structure.floorArea() / hoursInYear / frac_hrs_wk_day * 1000;
+  T phi_illum_unocc = Q_illum_unocc / structure.floorArea() / hoursInYear / (1 - frac_hrs_wk_day) * 1000;
   phi_illum_avg = Q_illum_tot_yr / structure.floorArea() / hoursInYear * 1000;
 
 
@@ -708,16 +697,17 @@ void MonthlyModel::heatGainsAndLosses(double frac_hrs_wk_day, double Q_illum_occ
 /**
  * Compute total internal heat gain in W.
  */
-void MonthlyModel::internalHeatGain(double phi_int_avg, double phi_plug_avg, double phi_illum_avg, double& phi_I_tot) const
+template<typename T>
+void BasicMonthlyModel<T>::internalHeatGain(T phi_int_avg, T phi_plug_avg, T phi_illum_avg, T& phi_I_tot) const
 {
   // Total occupant internal heat gain per year (W).
-  double phi_I_occ = phi_int_avg * structure.floorArea();
+  T phi_I_occ = phi_int_avg * structure.floorArea();
 
   // Total appliance internal heat gain per year (W).
-  double phi_I_app = phi_plug_avg * structure.floorArea();
+  T phi_I_app = phi_plug_avg * structure.floorArea();
 
   // Total lighting internal heat gain per year (W).
-  double phi_I_lt = phi_illum_avg * structure.floorArea();
+  T phi_I_lt = phi_illum_avg * structure.floorArea();
 
   // Total internal heat gain (W).
   phi_I_tot = phi_I_occ + phi_I_app + phi_I_lt;
@@ -726,7 +716,8 @@ void MonthlyModel::internalHeatGain(double phi_int_avg, double phi_plug_avg, dou
 /**
  * Compute unoccupied heat gain.
  */
-void MonthlyModel::unoccupiedHeatGain(double phi_int_wk_nt, double phi_int_wke_day, double phi_int_wke_nt, const Vector& weekdayUnoccupiedMegaseconds,
+template<typename T>
+void BasicMonthlyModel<T>::unoccupiedHeatGain(T phi_int_wk_nt, T phi_int_wke_day, T phi_int_wke_nt, const Vector& weekdayUnoccupiedMegaseconds,
     const Vector& weekendOccupiedMegaseconds, const Vector& weekendUnoccupiedMegaseconds, const Vector& frac_Pgh_wk_nt,
     const Vector& frac_Pgh_wke_day, const Vector& frac_Pgh_wke_nt, const Vector& v_E_sol, Vector& v_P_tot_wke_day, Vector& v_P_tot_wk_nt,
     Vector& v_P_tot_wke_nt) const
@@ -735,17 +726,17 @@ void MonthlyModel::unoccupiedHeatGain(double phi_int_wk_nt, double phi_int_wke_d
   Vector v_W_int_wk_nt = mult(weekdayUnoccupiedMegaseconds, phi_int_wk_nt * structure.floorArea());
   Vector v_W_int_wke_day = mult(weekendOccupiedMegaseconds, phi_int_wke_day * structure.floorArea());
   Vector v_W_int_wke_nt = mult(weekendUnoccupiedMegaseconds, phi_int_wke_nt * structure.floorArea());
-  printVector("v_W_int_wk_nt", v_W_int_wk_nt);
-  printVector("v_W_int_wke_day", v_W_int_wke_day);
-  printVector("v_W_int_wke_nt", v_W_int_wke_nt);
+  traceVector("v_W_int_wk_nt", v_W_int_wk_nt);
+  traceVector("v_W_int_wke_day", v_W_int_wke_day);
+  traceVector("v_W_int_wke_nt", v_W_int_wke_nt);
 
   // Solar heat gain for unoccupied times (MJ).
   Vector v_W_sol_wk_nt = mult(v_E_sol, frac_Pgh_wk_nt);
   Vector v_W_sol_wke_day = mult(v_E_sol, frac_Pgh_wke_day);
   Vector v_W_sol_wke_nt = mult(v_E_sol, frac_Pgh_wke_nt);
-  printVector("v_W_sol_wk_nt", v_W_sol_wk_nt);
-  printVector("v_W_sol_wke_day", v_W_sol_wke_day);
-  printVector("v_W_sol_wke_nt", v_W_sol_wke_nt);
+  traceVector("v_W_sol_wk_nt", v_W_sol_wk_nt);
+  traceVector("v_W_sol_wke_day", v_W_sol_wke_day);
+  traceVector("v_W_sol_wke_nt", v_W_sol_wke_nt);
 
   // Total heat gain for unoccupied times (MJ).
   v_P_tot_wk_nt = div(sum(v_W_int_wk_nt, v_W_sol_wk_nt), weekdayUnoccupiedMegaseconds);
@@ -756,16 +747,17 @@ void MonthlyModel::unoccupiedHeatGain(double phi_int_wk_nt, double phi_int_wke_d
 /*
  * Calculate interior temp.
  */
-void MonthlyModel::interiorTemp(const Vector& v_wall_A, const Vector& v_P_tot_wke_day, const Vector& v_P_tot_wk_nt, const Vector& v_P_tot_wke_nt,
-    const Vector& v_Tdbt_nt, const Vector& v_Tdbt_day, double H_tr, double hoursUnoccupiedPerDay, double hoursOccupiedPerDay, double frac_hrs_wk_day, double frac_hrs_wk_nt,
-    double frac_hrs_wke_tot, Vector& v_Th_avg, Vector& v_Tc_avg, double& tau) const
+template<typename T>
+void BasicMonthlyModel<T>::interiorTemp(const Vector& v_wall_A, const Vector& v_P_tot_wke_day, const Vector& v_P_tot_wk_nt, const Vector& v_P_tot_wke_nt,
+    const Vector& v_Tdbt_nt, const Vector& v_Tdbt_day, T H_tr, T hoursUnoccupiedPerDay, T hoursOccupiedPerDay, T frac_hrs_wk_day, T frac_hrs_wk_nt,
+    T frac_hrs_wke_tot, Vector& v_Th_avg, Vector& v_Tc_avg, T& tau) const
 {
   // Set the temp differential from the interior heating/cooling setpoint
   // based on the BEM type. An advanced BEM has the effect of reducing the
   // effective heating temp and raising the effective cooling temp during
   // times of control (i.e. during occupancy).
-  double T_adj = 0;
-  switch ((int) building.buildingEnergyManagement()) {
+  T T_adj = 0;
+  switch (static_cast<int>(scalarValue(building.buildingEnergyManagement()))) {
   case 1:
     T_adj = 0.0;
     break;
@@ -777,19 +769,17 @@ void MonthlyModel::interiorTemp(const Vector& v_wall_A, const Vector& v_P_tot_wk
     break;
   }
 
-  if (DEBUG_ISO_MODEL_SIMULATION) {
-    std::cout << "BEM: " << building.buildingEnergyManagement() << ", " << ((int) building.buildingEnergyManagement()) << std::endl;
-    std::cout << "T_adj: " << T_adj << std::endl;
-  }
+  traceValue("buildingEnergyManagement", building.buildingEnergyManagement());
+  traceValue("T_adj", T_adj);
 
   // Adjust the heating set points.
-  double ht_tset_ctrl = heating.temperatureSetPointOccupied() - T_adj;
-  double cl_tset_ctrl = cooling.temperatureSetPointOccupied() + T_adj;
+  T ht_tset_ctrl = heating.temperatureSetPointOccupied() - T_adj;
+  T cl_tset_ctrl = cooling.temperatureSetPointOccupied() + T_adj;
 
   // During unoccupied times, we use a setback temp and even if we have a BEM
   // it has no effect.
-  double ht_tset_unocc = heating.temperatureSetPointUnoccupied();
-  double cl_tset_unocc = cooling.temperatureSetPointUnoccupied();
+  T ht_tset_unocc = heating.temperatureSetPointUnoccupied();
+  T cl_tset_unocc = cooling.temperatureSetPointUnoccupied();
 
   Vector v_ht_tset_ctrl(12);
   Vector v_cl_tset_ctrl(12);
@@ -800,22 +790,20 @@ void MonthlyModel::interiorTemp(const Vector& v_wall_A, const Vector& v_P_tot_wk
     v_ht_tset_ctrl[i] = ht_tset_ctrl;
   }
 
-  if (DEBUG_ISO_MODEL_SIMULATION) {
-    printVector("v_cl_tset_ctrl", v_cl_tset_ctrl);
-    printVector("v_ht_tset_ctrl", v_ht_tset_ctrl);
-  }
+  traceVector("v_cl_tset_ctrl", v_cl_tset_ctrl);
+  traceVector("v_ht_tset_ctrl", v_ht_tset_ctrl);
 
   // Interior heat capacity (J/k).
-  double Cm_int = structure.interiorHeatCapacity() * structure.floorArea();
+  T Cm_int = structure.interiorHeatCapacity() * structure.floorArea();
 
   // Envelope heat capacity (J/k).
-  double Cm_env = structure.wallHeatCapacity() * sum(v_wall_A);
+  T Cm_env = structure.wallHeatCapacity() * sum(v_wall_A);
 
   // Total heat capacity (J/k).
-  double Cm = Cm_int + Cm_env;
+  T Cm = Cm_int + Cm_env;
 
   // Total heat transfer coefficient.
-  double H_tot = H_tr + ventilation.H_ve();
+  T H_tot = H_tr + ventilation.H_ve();
 
   // Building time constant in hours as pwer ISO 13790 12.2.1.3 eq. 62.
   tau = Cm / H_tot / 3600.0;
@@ -856,21 +844,17 @@ void MonthlyModel::interiorTemp(const Vector& v_wall_A, const Vector& v_P_tot_wk
       M_Te(i, 1) = M_Te(i, 3) = v_Tdbt_day[i];
   }
 
-  if (DEBUG_ISO_MODEL_SIMULATION) {
-    printMatrix("M_dT", M_dT);
-    printMatrix("M_Te", M_Te);
-    printVector("v_ti", v_ti);
-  }
+  traceMatrix("M_dT", M_dT);
+  traceMatrix("M_Te", M_Te);
+  traceVector("v_ti", v_ti);
 
   Vector v_Th_wke_avg(v_ht_tset_ctrl);
   Vector v_Th_wk_day(v_ht_tset_ctrl);
   Vector v_Th_wk_nt(v_ht_tset_ctrl);
 
-  if (DEBUG_ISO_MODEL_SIMULATION) {
-    printVector("v_Th_wke_avg", v_Th_wke_avg);
-    printVector("v_Th_wk_day", v_Th_wk_day);
-    printVector("v_Th_wk_nt", v_Th_wk_nt);
-  }
+  traceVector("v_Th_wke_avg", v_Th_wke_avg);
+  traceVector("v_Th_wk_day", v_Th_wk_day);
+  traceVector("v_Th_wk_nt", v_Th_wk_nt);
 
   // Compute the change in temp from setback to another heating temp in unoccupied times
   if (heating.T_ht_ctrl_flag() == 1) { // If the HVAC heating controls are turned on.
@@ -882,15 +866,8 @@ void MonthlyModel::interiorTemp(const Vector& v_wall_A, const Vector& v_P_tot_wk
       }
     }
 
-    if (DEBUG_ISO_MODEL_SIMULATION) {
-      printMatrix("M_Ta", M_Ta);
-      printVector("v_Tstart", v_Tstart);
-    }
-
-    if (DEBUG_ISO_MODEL_SIMULATION) {
-        printVector("v_cl_tset_ctrl", v_cl_tset_ctrl);
-        printVector("v_ht_tset_ctrl", v_ht_tset_ctrl);
-    }
+    traceMatrix("M_Ta", M_Ta);
+    traceVector("v_Tstart", v_Tstart);
 
     // Find the exponential Temp decay after any changes in heating temp setpoint and put
     // in the matrix M_Ta with columns being the different time segments.
@@ -902,9 +879,7 @@ void MonthlyModel::interiorTemp(const Vector& v_wall_A, const Vector& v_P_tot_wk
       M_Taa(j, 0) = v_ht_tset_ctrl[j];
     }
 
-    if (DEBUG_ISO_MODEL_SIMULATION) {
-      printMatrix("M_Taa", M_Taa);
-    }
+    traceMatrix("M_Taa", M_Taa);
 
     for (unsigned int i = 1; i < M_Taa.size2(); i++) {
       for (unsigned int j = 0; j < M_Taa.size1(); j++) {
@@ -912,9 +887,7 @@ void MonthlyModel::interiorTemp(const Vector& v_wall_A, const Vector& v_P_tot_wk
       }
     }
 
-    if (DEBUG_ISO_MODEL_SIMULATION) {
-         printMatrix("M_Taa", M_Taa);
-    }
+    traceMatrix("M_Taa", M_Taa);
 
     Matrix M_Tb(12, 5);
 
@@ -923,12 +896,12 @@ void MonthlyModel::interiorTemp(const Vector& v_wall_A, const Vector& v_P_tot_wk
     // Loop through wk nt to wke day to wke nt to wke day to wke nt.
     for (unsigned int i = 0; i < M_Tb.size2(); i++) {
       for (unsigned int j = 0; j < M_Tb.size1(); j++) {
-        double v_T_avg = tau / v_ti(i) * (M_Taa(j, i) - M_Te(j, i) - M_dT(j, i)) * (1 - exp(-1 * v_ti(i) / tau)) + M_Te(j, i) + M_dT(j, i);
+        T v_T_avg = tau / v_ti(i) * (M_Taa(j, i) - M_Te(j, i) - M_dT(j, i)) * (1 - exp(-1 * v_ti(i) / tau)) + M_Te(j, i) + M_dT(j, i);
         M_Tb(j, i) = std::max(v_T_avg, ht_tset_unocc);
       }
     }
     for (unsigned int i = 0; i < v_Th_wke_avg.size(); i++) {
-      double sum = 0;
+      T sum = 0;
       for (unsigned int j = 0; j < M_Tb.size2(); j++) {
         sum += M_Tb(i, j);
       }
@@ -938,11 +911,9 @@ void MonthlyModel::interiorTemp(const Vector& v_wall_A, const Vector& v_P_tot_wk
       v_Th_wk_nt[j] = M_Tb(j, 1);
     }
 
-    if (DEBUG_ISO_MODEL_SIMULATION) {
-        printMatrix("M_Tb", M_Tb);
-        printVector("v_Th_wke_avg", v_Th_wke_avg);
-        printVector("v_Th_wk_nt", v_Th_wk_nt);
-      }
+    traceMatrix("M_Tb", M_Tb);
+    traceVector("v_Th_wke_avg", v_Th_wke_avg);
+    traceVector("v_Th_wk_nt", v_Th_wk_nt);
   }
 
   // Default for if cooling is turned off.
@@ -974,30 +945,24 @@ void MonthlyModel::interiorTemp(const Vector& v_wall_A, const Vector& v_P_tot_wk
       }
     }
 
-    if (DEBUG_ISO_MODEL_SIMULATION) {
-            printMatrix("M_Tcc", M_Tcc);
-    }
+    traceMatrix("M_Tcc", M_Tcc);
 
     // For each time period, find the average temp given the exponential decay.
     Matrix M_Td(12, 5);
 
     for (unsigned int i = 0; i < M_Td.size2(); i++) {
       for (unsigned int j = 0; j < M_Td.size1(); j++) {
-        double v_T_avg = tau / v_ti(i) * (M_Tcc(j, i) - M_Te(j, i) - M_dT(j, i)) * (1 - exp(-1 * v_ti(i) / tau)) + M_Te(j, i) + M_dT(j, i);
-        if (DEBUG_ISO_MODEL_SIMULATION) {
-          std::cout << "v_T_avg = " << v_T_avg << std::endl;
-        }
+        T v_T_avg = tau / v_ti(i) * (M_Tcc(j, i) - M_Te(j, i) - M_dT(j, i)) * (1 - exp(-1 * v_ti(i) / tau)) + M_Te(j, i) + M_dT(j, i);
+        traceValue("v_T_avg", v_T_avg);
         M_Td(j, i) = std::max(v_T_avg, cl_tset_unocc);
       }
     }
 
 
-    if (DEBUG_ISO_MODEL_SIMULATION) {
-        printMatrix("M_Td", M_Td);
-    }
+    traceMatrix("M_Td", M_Td);
 
     for (unsigned int i = 0; i < v_Th_wke_avg.size(); i++) {
-      double sum = 0;
+      T sum = 0;
       for (unsigned int j = 0; j < M_Td.size2(); j++) {
         sum += M_Td(i, j);
       }
@@ -1008,20 +973,16 @@ void MonthlyModel::interiorTemp(const Vector& v_wall_A, const Vector& v_P_tot_wk
     }
   }
 
-  if (DEBUG_ISO_MODEL_SIMULATION) {
-     printVector("v_Tc_wk_day", v_Tc_wk_day);
-     printVector("v_Tc_wk_nt", v_Tc_wk_nt);
-     printVector("v_Tc_wke_avg", v_Tc_wke_avg);
-   }
+  traceVector("v_Tc_wk_day", v_Tc_wk_day);
+  traceVector("v_Tc_wk_nt", v_Tc_wk_nt);
+  traceVector("v_Tc_wke_avg", v_Tc_wke_avg);
 
   // Find the average temp for the whole week from the fractions of each period.
   Vector v_Th_wk_avg = sum(sum(mult(v_Th_wk_day, frac_hrs_wk_day), mult(v_Th_wk_nt, frac_hrs_wk_nt)), mult(v_Th_wke_avg, frac_hrs_wke_tot));
   Vector v_Tc_wk_avg = sum(sum(mult(v_Tc_wk_day, frac_hrs_wk_day), mult(v_Tc_wk_nt, frac_hrs_wk_nt)), mult(v_Tc_wke_avg, frac_hrs_wke_tot));
 
-  if (DEBUG_ISO_MODEL_SIMULATION) {
-    printVector("v_Tc_wk_avg", v_Tc_wk_avg);
-    printVector("v_Th_wk_avg", v_Th_wk_avg);
-  }
+  traceVector("v_Tc_wk_avg", v_Tc_wk_avg);
+  traceVector("v_Th_wk_avg", v_Th_wk_avg);
 
   // The final avg for monthly energy computations is the lesser of the avg
   // computed above and the heating set control.
@@ -1035,29 +996,30 @@ void MonthlyModel::interiorTemp(const Vector& v_wall_A, const Vector& v_P_tot_wk
  * Calculate required energy for mechanical ventilation based on source EN ISO 13789
  * C.3, C.5 and EN 15242:2007 6.7 and EN ISO 13790 Sec 9.2.
  */
-void MonthlyModel::ventilationCalc(const Vector& v_Th_avg, const Vector& v_Tc_avg, double frac_hrs_wk_day, Vector& v_Hve_ht, Vector& v_Hve_cl) const
+template<typename T>
+void BasicMonthlyModel<T>::ventilationCalc(const Vector& v_Th_avg, const Vector& v_Tc_avg, T frac_hrs_wk_day, Vector& v_Hve_ht, Vector& v_Hve_cl) const
 {
   // Ventilation Zone Height (m) with a minimum of 0.1 m.
-  double vent_zone_height = std::max(0.1, structure.buildingHeight());
+  T vent_zone_height = std::max<T>(0.1, structure.buildingHeight());
 
   // Vent supply rate m3/h/m2 (input is in in L/s).
-  double qv_supp = ventilation.supplyRate() / structure.floorArea() / 3.6;
+  T qv_supp = ventilation.supplyRate() / structure.floorArea() / 3.6;
 
   // Vent exhaust rate m3/h/m2, negative indicates out of building.
-  double qv_ext = -(qv_supp - ventilation.supplyDifference() / structure.floorArea() / 3.6);
+  T qv_ext = -(qv_supp - ventilation.supplyDifference() / structure.floorArea() / 3.6);
 
   // Combustion appliance ventilation rate - not implemented yet but will be impt for restaurants.
-  double qv_comb = 0;
+  T qv_comb = 0;
 
   // Difference between air intake and air exhaust including combustion exhaust.
-  double qv_diff = qv_supp + qv_ext + qv_comb;
+  T qv_diff = qv_supp + qv_ext + qv_comb;
 
-  double vent_ht_recov = ventilation.heatRecoveryEfficiency();
+  T vent_ht_recov = ventilation.heatRecoveryEfficiency();
 
-  double vent_outdoor_frac = 1 - ventilation.exhaustAirRecirculated();
+  T vent_outdoor_frac = 1 - ventilation.exhaustAirRecirculated();
 
   // Infilatration source EN 15242:2007 Sec 6.7 direct method
-  double tot_env_A = sum(structure.wallArea()) + sum(structure.windowArea());
+  T tot_env_A = sum(structure.wallArea()) + sum(structure.windowArea());
 
   // Infiltration data from:
   // Tamura, (1976), Studies on exterior wall air tightness and air infiltration of tall buildings, ASHRAE Transactions, 82(1), 122-134.
@@ -1065,68 +1027,72 @@ void MonthlyModel::ventilationCalc(const Vector& v_Th_avg, const Vector& v_Tc_av
   // Emmerich, (2005), Investigation of the Impact of Commercial Building Envelope Airtightness on HVAC Energy Use.
 
   // Infiltration rate in m3/h/m2 @ 75 Pa based on wall area.
-  double v_Q75pa = structure.infiltrationRate();
+  T v_Q75pa = structure.infiltrationRate();
 
   // Convert infiltration to Q@4Pa in m3/h /m2 based on floor area.
-  // double v_Q4pa = v_Q75pa * tot_env_A / structure.floorArea() * (std::pow((4.0 / 75.0), ventilation.p_exp()));
-  double v_Q4pa = v_Q75pa;
+  // T v_Q4pa = v_Q75pa * tot_env_A / structure.floorArea() * (std::pow((4.0 / 75.0), ventilation.p_exp()));
+  T v_Q4pa = v_Q75pa;
 
   // Effective stack height.
-  double h_stack = ventilation.zone_frac() * vent_zone_height;
+  T h_stack = ventilation.zone_frac() * vent_zone_height;
+
+  // Monthly weather, converted to the scalar type.
+  Vector mdbt = location.weather()->mdbt();
+  Vector mwind = location.weather()->mwind();
 
-  Vector dbtDiff = dif(location.weather()->mdbt(), v_Th_avg);
-  printVector("dbtDiff", dbtDiff);
+  Vector dbtDiff = dif(mdbt, v_Th_avg);
+  traceVector("dbtDiff", dbtDiff);
   Vector dbtDiffAbs = abs(dbtDiff);
-  printVector("dbtDiffAbs", dbtDiffAbs);
+  traceVector("dbtDiffAbs", dbtDiffAbs);
   Vector dbtHStack = mult(dbtDiffAbs, h_stack);
-  printVector("dbtHstack", dbtHStack);
+  traceVector("dbtHstack", dbtHStack);
   Vector dbtPowered = pow(dbtHStack, ventilation.stack_exp());
-  printVector("dbtPowered", dbtPowered);
+  traceVector("dbtPowered", dbtPowered);
   Vector dbtMultQ4 = mult(dbtPowered, ventilation.stack_coeff() * v_Q4pa);
-  printVector("dbtMultQ4", dbtMultQ4);
+  traceVector("dbtMultQ4", dbtMultQ4);
 
   // Calculate the infiltration from stack effect pressure difference for heating from EN 15242: sec 6.7.1 (m3/h/m2).
   Vector v_qv_stack_ht = maximum(dbtMultQ4, 0.001);
 
   // Recalculate for cooling.
-  dbtDiff = dif(location.weather()->mdbt(), v_Tc_avg);
-  printVector("dbtDiff", dbtDiff);
+  dbtDiff = dif(mdbt, v_Tc_avg);
+  traceVector("dbtDiff", dbtDiff);
   dbtDiffAbs = abs(dbtDiff);
-  printVector("dbtDiffAbs", dbtDiffAbs);
+  traceVector("dbtDiffAbs", dbtDiffAbs);
   dbtHStack = mult(dbtDiffAbs, h_stack);
-  printVector("dbtHstack", dbtHStack);
+  traceVector("dbtHstack", dbtHStack);
   dbtPowered = pow(dbtHStack, ventilation.stack_exp());
-  printVector("dbtPowered", dbtPowered);
+  traceVector("dbtPowered", dbtPowered);
   dbtMultQ4 = mult(dbtPowered, ventilation.stack_coeff() * v_Q4pa);
-  printVector("dbtMultQ4", dbtMultQ4);
+  traceVector("dbtMultQ4", dbtMultQ4);
 
   // Calculate the infiltration from stack effect pressure difference for cooling from EN 15242: sec 6.7.1 (m3/h/m2).
   Vector v_qv_stack_cl = maximum(dbtMultQ4, 0.001);
-  printVector("v_qv_stack_ht", v_qv_stack_ht);
-  printVector("v_qv_stack_cl", v_qv_stack_cl);
+  traceVector("v_qv_stack_ht", v_qv_stack_ht);
+  traceVector("v_qv_stack_cl", v_qv_stack_cl);
 
-  Vector v_qv_wind_ht = mult(mult(pow(mult(mult(location.weather()->mwind(), location.weather()->mwind()), ventilation.dCp() * location.terrain()),
+  Vector v_qv_wind_ht = mult(mult(pow(mult(mult(mwind, mwind), ventilation.dCp() * location.terrain()),
                              ventilation.wind_exp()), v_Q4pa), ventilation.wind_coeff());
-  Vector v_qv_wind_cl = mult(mult(pow(mult(mult(location.weather()->mwind(), location.weather()->mwind()), ventilation.dCp() * location.terrain()),
+  Vector v_qv_wind_cl = mult(mult(pow(mult(mult(mwind, mwind), ventilation.dCp() * location.terrain()),
                              ventilation.wind_exp()), v_Q4pa), ventilation.wind_coeff());
-  printVector("v_qv_wind_ht", v_qv_wind_ht);
-  printVector("v_qv_wind_cl", v_qv_wind_cl);
+  traceVector("v_qv_wind_ht", v_qv_wind_ht);
+  traceVector("v_qv_wind_cl", v_qv_wind_cl);
 
   Vector v_qv_ht_max = maximum(v_qv_stack_ht, v_qv_wind_ht);
   Vector v_qv_cl_max = maximum(v_qv_stack_cl, v_qv_wind_cl);
-  printVector("v_qv_ht_max", v_qv_ht_max);
-  printVector("v_qv_cl_max", v_qv_cl_max);
+  traceVector("v_qv_ht_max", v_qv_ht_max);
+  traceVector("v_qv_cl_max", v_qv_cl_max);
 
   double n_sw_coeff = 0.14;
   Vector v_qv_sw_ht = sum(v_qv_ht_max, div(mult(mult(v_qv_stack_ht, v_qv_wind_ht), n_sw_coeff), v_Q4pa)); // m3/h/m2
   Vector v_qv_sw_cl = sum(v_qv_cl_max, div(mult(mult(v_qv_stack_cl, v_qv_wind_cl), n_sw_coeff), v_Q4pa)); // m3/h/m2
-  printVector("v_qv_sw_ht", v_qv_sw_ht);
-  printVector("v_qv_sw_cl", v_qv_sw_cl);
+  traceVector("v_qv_sw_ht", v_qv_sw_ht);
+  traceVector("v_qv_sw_cl", v_qv_sw_cl);
 
-  Vector v_qv_inf_ht = sum(v_qv_sw_ht, std::max(0.0, -qv_diff)); // m3/h/m2
-  Vector v_qv_inf_cl = sum(v_qv_sw_cl, std::max(0.0, -qv_diff)); // m3/h/m2
-  printVector("v_qv_inf_ht", v_qv_inf_ht);
-  printVector("v_qv_inf_cl", v_qv_inf_cl);
+  Vector v_qv_inf_ht = sum(v_qv_sw_ht, std::max<T>(0.0, -qv_diff)); // m3/h/m2
+  Vector v_qv_inf_cl = sum(v_qv_sw_cl, std::max<T>(0.0, -qv_diff)); // m3/h/m2
+  traceVector("v_qv_inf_ht", v_qv_inf_ht);
+  traceVector("v_qv_inf_cl", v_qv_inf_cl);
 
   // TODO: Figure out what the comment below is refering to. I don't want to delete it just yet
   // because connecting the code to the sources of the equations is important. BAA@2015-07-14.
@@ -1141,7 +1107,7 @@ void MonthlyModel::ventilationCalc(const Vector& v_Th_avg, const Vector& v_Tc_av
   // Set vent_rate_flag=0 if ventilation rate is constant, 1 if we assume vent off in unoccopied times or
   // 2 if we assume ventilation rate is dropped proportionally to population
   // set to 1 to mimic the behavior of the original spreadsheet.
-  double vent_op_frac;
+  T vent_op_frac;
   switch (ventilation.vent_rate_flag()) {
   case 0:
     vent_op_frac = 1;
@@ -1154,7 +1120,7 @@ void MonthlyModel::ventilationCalc(const Vector& v_Th_avg, const Vector& v_Tc_av
     break;
   }
 
-  double initVal = ventilation.ventType() == 3 ? 0 : (vent_op_frac * qv_supp * vent_outdoor_frac * (1 - vent_ht_recov));
+  T initVal = ventilation.ventType() == 3 ? 0 : (vent_op_frac * qv_supp * vent_outdoor_frac * (1 - vent_ht_recov));
   Vector v_qv_mve_ht(12, initVal);
   Vector v_qv_mve_cl(12, initVal);
 
@@ -1162,8 +1128,8 @@ void MonthlyModel::ventilationCalc(const Vector& v_Th_avg, const Vector& v_Tc_av
   Vector v_qve_ht = sum(v_qv_inf_ht, v_qv_mve_ht);
   // Total air flow in m3/s when cooling.
   Vector v_qve_cl = sum(v_qv_inf_cl, v_qv_mve_cl);
-  printVector("v_qve_ht", v_qve_ht);
-  printVector("v_qve_cl", v_qve_cl);
+  traceVector("v_qve_ht", v_qve_ht);
+  traceVector("v_qve_cl", v_qve_cl);
 
   // Hve heating (W/K/m2).
   v_Hve_ht = div(mult(v_qve_ht, phys.rhoCpAir()*1000000), 3600.0); // Multiply rhoCpAir by 1000000 to convert from MJ to W.
@@ -1174,9 +1140,10 @@ void MonthlyModel::ventilationCalc(const Vector& v_Th_avg, const Vector& v_Tc_av
 /**
  * Compute monthly heating and cooling demand.
  */
-void MonthlyModel::heatingAndCooling(const Vector& v_E_sol, const Vector& v_Th_avg, const Vector& v_Hve_ht, const Vector& v_Tc_avg,
-    const Vector& v_Hve_cl, double tau, double H_tr, double phi_I_tot, double frac_hrs_wk_day, Vector& v_Qfan_tot, Vector& v_Qneed_ht,
-    Vector& v_Qneed_cl, double& Qneed_ht_yr, double& Qneed_cl_yr) const
+template<typename T>
+void BasicMonthlyModel<T>::heatingAndCooling(const Vector& v_E_sol, const Vector& v_Th_avg, const Vector& v_Hve_ht, const Vector& v_Tc_avg,
+    const Vector& v_Hve_cl, T tau, T H_tr, T phi_I_tot, T frac_hrs_wk_day, Vector& v_Qfan_tot, Vector& v_Qneed_ht,
+    Vector& v_Qneed_cl, T& Qneed_ht_yr, T& Qneed_cl_yr) const
 {
   // Convert internal heat gains from W to MJ.
   Vector temp = mult(megasecondsInMonth, phi_I_tot, 12);
@@ -1184,26 +1151,31 @@ void MonthlyModel::heatingAndCooling(const Vector& v_E_sol, const Vector& v_Th_a
   // Total internal + solar heat gains (MJ).
   Vector v_tot_mo_ht_gain = sum(temp, v_E_sol);
 
+  // Monthly dry bulb temperature, converted to the scalar type.
+  Vector mdbt = location.weather()->mdbt();
+
   // Building heating dimensionless constant.
-  double a_H = heating.a_H0() + tau / heating.tau_H0();
+  T a_H = heating.a_H0() + tau / heating.tau_H0();
 
   // Heat transfer (loss) by transmission, heating (MJ).
-  Vector v_QT_ht = mult(mult(dif(v_Th_avg, location.weather()->mdbt()), megasecondsInMonth), H_tr);
+  Vector v_QT_ht = mult(mult(dif(v_Th_avg, mdbt), megasecondsInMonth), H_tr);
   // Heat transfer (loss) by ventilation, heating (MJ).
-  Vector v_QV_ht = mult(mult(mult(v_Hve_ht, structure.floorArea()), dif(v_Th_avg, location.weather()->mdbt())), megasecondsInMonth);
+  Vector v_QV_ht = mult(mult(mult(v_Hve_ht, structure.floorArea()), dif(v_Th_avg, mdbt)), megasecondsInMonth);
   // Total heat transfer (loss) (MJ). ISO 13790 7.2.1.3 eq. 7.
   Vector v_Qtot_ht = sum(v_QT_ht, v_QV_ht);
 
   // Compute the ratio of heat gain to heat loss.
   Vector v_gamma_H_ht = div(v_tot_mo_ht_gain, sum(v_Qtot_ht, DBL_MIN)); // Add DBL_MIN to avoid divide by zero.
 
+  using std::pow;
+
   // Heating utilization factor.
   Vector v_eta_g_H(12);
 
   // For each month, set the check the heat gain ratio and set the heating utlization factor accordingly.
   for (unsigned int i = 0; i < v_eta_g_H.size(); i++) {
     v_eta_g_H[i] =
-        v_gamma_H_ht(i) > 0 ? (1 - std::pow(v_gamma_H_ht[i], a_H)) / (1 - std::pow(v_gamma_H_ht[i], (a_H + 1))) : 1 / (v_gamma_H_ht(i) + DBL_MIN);
+        v_gamma_H_ht(i) > 0 ? (1 - pow(v_gamma_H_ht[i], a_H)) / (1 - pow(v_gamma_H_ht[i], (a_H + 1))) : 1 / (v_gamma_H_ht(i) + DBL_MIN);
   }
 
   // Total heating need (MJ).
@@ -1211,9 +1183,9 @@ void MonthlyModel::heatingAndCooling(const Vector& v_E_sol, const Vector& v_Th_a
   Qneed_ht_yr = sum(v_Qneed_ht);
 
   // Heat transfer (loss) by transmission, cooling (MJ).
-  Vector v_QT_cl = mult(mult(dif(v_Tc_avg, location.weather()->mdbt()), H_tr), megasecondsInMonth);
+  Vector v_QT_cl = mult(mult(dif(v_Tc_avg, mdbt), H_tr), megasecondsInMonth);
   // Heat transfer (loss) by ventilation, cooling (MJ).
-  Vector v_QV_cl = mult(mult(mult(v_Hve_cl, structure.floorArea()), dif(v_Tc_avg, location.weather()->mdbt())), megasecondsInMonth);
+  Vector v_QV_cl = mult(mult(mult(v_Hve_cl, structure.floorArea()), dif(v_Tc_avg, mdbt)), megasecondsInMonth);
   // Total heat transfer (loss), cooling (MJ). ISO 13790 7.2.1.3 eq. 7.
   Vector v_Qtot_cl = sum(v_QT_cl, v_QV_cl);
 
@@ -1223,48 +1195,42 @@ void MonthlyModel::heatingAndCooling(const Vector& v_E_sol, const Vector& v_Th_a
   // Compute the cooling gain utilization factor eta_g_cl
   Vector v_eta_g_CL(12);
   for (unsigned int i = 0; i < v_eta_g_CL.size(); i++) {
-    if (DEBUG_ISO_MODEL_SIMULATION) {
-      double numer = (1.0 - std::pow(v_gamma_H_cl[i], a_H));
-      double denom = (1.0 - std::pow(v_gamma_H_cl[i], (a_H + 1.0)));
-      std::cout << numer << " = 1.0 - " << v_gamma_H_cl[i] << "^" << a_H << std::endl;
-      std::cout << denom << " = 1.0 - " << v_gamma_H_cl[i] << "^" << (a_H + 1.0) << std::endl;
-    }
-    v_eta_g_CL[i] = v_gamma_H_cl(i) > 0.0 ? (1.0 - std::pow(v_gamma_H_cl[i], a_H)) / (1.0 - std::pow(v_gamma_H_cl[i], (a_H + 1.0))) : 1.0;
+    v_eta_g_CL[i] = v_gamma_H_cl(i) > 0.0 ? (1.0 - pow(v_gamma_H_cl[i], a_H)) / (1.0 - pow(v_gamma_H_cl[i], (a_H + 1.0))) : 1.0;
   }
+  traceVector("v_gamma_H_cl", v_gamma_H_cl);
+  traceVector("v_eta_g_CL", v_eta_g_CL);
 
   // Total cooling need (MJ).
   v_Qneed_cl = dif(v_tot_mo_ht_gain, mult(v_eta_g_CL, v_Qtot_cl));
   Qneed_cl_yr = sum(v_Qneed_cl);
 
   // Hot air supply temperature (C).
-  double T_sup_ht = heating.temperatureSetPointOccupied() + heating.dT_supp_ht();
+  T T_sup_ht = heating.temperatureSetPointOccupied() + heating.dT_supp_ht();
   // Cool air supply temperature (C).
-  double T_sup_cl = cooling.temperatureSetPointOccupied() - cooling.dT_supp_cl();
+  T T_sup_cl = cooling.temperatureSetPointOccupied() - cooling.dT_supp_cl();
 
   // Volume of air moved for heating (m3).
   Vector v_Vair_ht = div(v_Qneed_ht, sum(mult(dif(T_sup_ht, v_Th_avg), phys.rhoCpAir()), DBL_MIN));
   // Volume of air moved for cooling (m3).
   Vector v_Vair_cl = div(v_Qneed_cl, sum(mult(dif(v_Tc_avg, T_sup_cl), phys.rhoCpAir()), DBL_MIN));
 
-  printVector("v_Vair_ht", v_Vair_ht);
-  printVector("v_Vair_cl", v_Vair_cl);
+  traceVector("v_Vair_ht", v_Vair_ht);
+  traceVector("v_Vair_cl", v_Vair_cl);
 
   // Total air flow (m3).
   // Multiply by 1000000 to convert megaseconds to seconds.
   // Divide by 1000 to convert liters to m3.
   Vector v_Vair_tot = maximum(sum(v_Vair_ht, v_Vair_cl), div(mult(megasecondsInMonth, ventilation.supplyRate() * frac_hrs_wk_day * 1000000.0, 12), 1000));
-  printVector("v_Vair_tot", v_Vair_tot);
+  traceVector("v_Vair_tot", v_Vair_tot);
 
   // Fan power (MJ)
   // ventilation.fanPower is in W/L/s is also J/L which is also kJ/m3. Divide by 1000 for MJ/m3 to get fanEnergy in MJ.
   Vector fanEnergy = mult(v_Vair_tot, ventilation.fanPower() * ventilation.fanControlFactor() / 1000.0);
-  printVector("fanEnergy", fanEnergy);
+  traceVector("fanEnergy", fanEnergy);
 
-  if (DEBUG_ISO_MODEL_SIMULATION) {
-    std::cout << "ventilation.fanPower() = " << ventilation.fanPower() << std::endl;
-    std::cout << "ventilation.fanControlFactor() = " << ventilation.fanControlFactor() << std::endl;
-    std::cout << "structure.floorArea() = " << structure.floorArea() << std::endl;
-  }
+  traceValue("fanPower", ventilation.fanPower());
+  traceValue("fanControlFactor", ventilation.fanControlFactor());
+  traceValue("floorArea", structure.floorArea());
 
   // Calculate fan EUI (kWh/m2).
   v_Qfan_tot = div(div(fanEnergy, structure.floorArea()), 3.6);
@@ -1273,7 +1239,8 @@ void MonthlyModel::heatingAndCooling(const Vector& v_E_sol, const Vector& v_Th_a
 /**
  * HVAC systems calculations.
  */
-void MonthlyModel::hvac(const Vector& v_Qneed_ht, const Vector& v_Qneed_cl, double Qneed_ht_yr, double Qneed_cl_yr, Vector& v_Qelec_ht, Vector& v_Qgas_ht,
+template<typename T>
+void BasicMonthlyModel<T>::hvac(const Vector& v_Qneed_ht, const Vector& v_Qneed_cl, T Qneed_ht_yr, T Qneed_cl_yr, Vector& v_Qelec_ht, Vector& v_Qgas_ht,
     Vector& v_Qcl_elec_tot, Vector& v_Qcl_gas_tot) const
 {
   // TODO: Implement (or remove) all the district heating/cooling stuff that is currently commented out. BAA@2015-07-15.
@@ -1298,30 +1265,30 @@ void MonthlyModel::hvac(const Vector& v_Qneed_ht, const Vector& v_Qneed_cl, doub
   // From EN 15243-2007 Annex E.
   // HVAC system info table from EN 15243:2007 Table E1.
   // The integrated energy efficiency ratio (IEER) is the effective average COP for the system.
-  double IEER = cooling.cop() * cooling.partialLoadValue();
+  T IEER = cooling.cop() * cooling.partialLoadValue();
 
   // Copy over the HVAC loss/waste factors into local variables with names
   // that match the equations better
-  double f_waste = heating.hotcoldWasteFactor();
-  double a_ht_loss = heating.hvacLossFactor();
-  double a_cl_loss = cooling.hvacLossFactor();
+  T f_waste = heating.hotcoldWasteFactor();
+  T a_ht_loss = heating.hvacLossFactor();
+  T a_cl_loss = cooling.hvacLossFactor();
 
   // Fraction of yearly heating demand with regard to total heating + cooling demand.
-  double f_dem_ht = std::max(Qneed_ht_yr / (Qneed_cl_yr + Qneed_ht_yr), 0.1);
+  T f_dem_ht = std::max<T>(Qneed_ht_yr / (Qneed_cl_yr + Qneed_ht_yr), 0.1);
   // Fraction of yearly cooling demand.
-  double f_dem_cl = std::max((1.0 - f_dem_ht), 0.1);
+  T f_dem_cl = std::max<T>((1.0 - f_dem_ht), 0.1);
 
   // Overall distribution efficiency for heating.
-  double eta_dist_ht = 1.0 / (1.0 + a_ht_loss + f_waste / f_dem_ht);
+  T eta_dist_ht = 1.0 / (1.0 + a_ht_loss + f_waste / f_dem_ht);
   // Overall distrubtion efficiency for cooling.
-  double eta_dist_cl = 1.0 / (1.0 + a_cl_loss + f_waste / f_dem_cl);
+  T eta_dist_cl = 1.0 / (1.0 + a_cl_loss + f_waste / f_dem_cl);
 
   // Losses from HVAC distributuion, heating.
   Vector v_Qloss_ht_dist = div(mult(v_Qneed_ht, (1 - eta_dist_ht)), eta_dist_ht);
   // Losses from HVAC distributuion, cooling.
   Vector v_Qloss_cl_dist = div(mult(v_Qneed_cl, (1 - eta_dist_cl)), eta_dist_cl);
-  printVector("v_Qloss_ht_dist", v_Qloss_ht_dist);
-  printVector("v_Qloss_cl_dist", v_Qloss_cl_dist);
+  traceVector("v_Qloss_ht_dist", v_Qloss_ht_dist);
+  traceVector("v_Qloss_cl_dist", v_Qloss_cl_dist);
 
   Vector v_Qht_sys(12, 0.0);
   Vector v_Qht_DH(12, 0.0);
@@ -1339,10 +1306,10 @@ void MonthlyModel::hvac(const Vector& v_Qneed_ht, const Vector& v_Qneed_cl, doub
   } else {
     v_Qcl_sys = div(sum(v_Qloss_cl_dist, v_Qneed_cl), IEER + DBL_MIN);
   }
-  printVector("v_Qht_sys", v_Qht_sys);
-  printVector("v_Qht_DH", v_Qht_DH);
-  printVector("v_Qcl_sys", v_Qcl_sys);
-  printVector("v_Qcool_DC", v_Qcool_DC);
+  traceVector("v_Qht_sys", v_Qht_sys);
+  traceVector("v_Qht_DH", v_Qht_DH);
+  traceVector("v_Qcl_sys", v_Qcl_sys);
+  traceVector("v_Qcool_DC", v_Qcool_DC);
 
   // From original matlab code. Preserved for future implementation of district heating/cooling. BAA@2015-07-15.
   /*
@@ -1366,15 +1333,15 @@ void MonthlyModel::hvac(const Vector& v_Qneed_ht, const Vector& v_Qneed_cl, doub
    */
   Vector v_Qcl_DC_elec = div(mult(v_Qcool_DC, 1 - cooling.eta_DC_frac_abs()), cooling.eta_DC_COP() * cooling.eta_DC_network());
   Vector v_Qcl_DC_abs = div(mult(v_Qcool_DC, 1 - cooling.frac_DC_free()), cooling.eta_DC_COP_abs());
-  printVector("v_Qcl_DC_elec", v_Qcl_DC_elec);
-  printVector("v_Qcl_DC_abs", v_Qcl_DC_abs);
+  traceVector("v_Qcl_DC_elec", v_Qcl_DC_elec);
+  traceVector("v_Qcl_DC_abs", v_Qcl_DC_abs);
 
   Vector v_Qht_DH_total = div(mult(v_Qht_DH, 1 - heating.frac_DH_free()), heating.eta_DH_sys() * heating.eta_DH_network());
   v_Qcl_elec_tot = sum(v_Qcl_sys, v_Qcl_DC_elec);
   v_Qcl_gas_tot = v_Qcl_DC_abs;
-  printVector("v_Qht_DH_total", v_Qht_DH_total);
-  printVector("v_Qcl_elec_tot", v_Qcl_elec_tot);
-  printVector("v_Qcl_gas_tot", v_Qcl_gas_tot);
+  traceVector("v_Qht_DH_total", v_Qht_DH_total);
+  traceVector("v_Qcl_elec_tot", v_Qcl_elec_tot);
+  traceVector("v_Qcl_gas_tot", v_Qcl_gas_tot);
 
   //Vector v_Qelec_ht,v_Qgas_ht;
 
@@ -1386,8 +1353,8 @@ void MonthlyModel::hvac(const Vector& v_Qneed_ht, const Vector& v_Qneed_cl, doub
     zero(v_Qelec_ht);
     v_Qgas_ht = sum(v_Qht_sys, v_Qht_DH_total);
   }
-  printVector("v_Qelec_ht", v_Qelec_ht);
-  printVector("v_Qgas_ht", v_Qgas_ht);
+  traceVector("v_Qelec_ht", v_Qelec_ht);
+  traceVector("v_Qgas_ht", v_Qgas_ht);
 
   // From original matlab code. Preserved for future implementation of district heating/cooling. BAA@2015-07-15.
   /*
@@ -1413,7 +1380,8 @@ void MonthlyModel::hvac(const Vector& v_Qneed_ht, const Vector& v_Qneed_cl, doub
  * Calculate energy for pumps used in the heating/cooling systems.
  * References: EPA NR 6.9.7.1 and 6.9.7.2, EN 15243.
  */
-void MonthlyModel::pump(const Vector& v_Qneed_ht, const Vector& v_Qneed_cl, double Qneed_ht_yr, double Qneed_cl_yr, Vector& v_Q_pump_tot) const
+template<typename T>
+void BasicMonthlyModel<T>::pump(const Vector& v_Qneed_ht, const Vector& v_Qneed_cl, T Qneed_ht_yr, T Qneed_cl_yr, Vector& v_Q_pump_tot) const
 {
   // TODO: The current implementation is wrong. It either needs to be revised to be more like the hourly implementation where the pump energy
   // is multiplied by the amount of time the pumps are actually on or heating.E_pumps()/cooling.E_pumps() needs to be expressed in terms of the
@@ -1423,32 +1391,32 @@ void MonthlyModel::pump(const Vector& v_Qneed_ht, const Vector& v_Qneed_cl, doub
   // Total annual pump energy for heating systems if the pumps are running continuously.
   // NOTE: This assumption (that the annual pump energy is equal to the energy of the pumps running continuosly) is the source of the
   // problems in the pump results. BAA@2015-07-15.
-  double Q_pumps_yr_ht = sum(mult(megasecondsInMonth, heating.E_pumps(), 12));
+  T Q_pumps_yr_ht = sum(mult(megasecondsInMonth, heating.E_pumps(), 12));
   // Total annual pump energy for cooling systems if the pumps are running continuously.
-  double Q_pumps_yr_cl = sum(mult(megasecondsInMonth, cooling.E_pumps(), 12));
+  T Q_pumps_yr_cl = sum(mult(megasecondsInMonth, cooling.E_pumps(), 12));
 
   // Fraction of time the system is in heating mode each month.
   Vector v_frac_ht_mode = div(v_Qneed_ht, sum(v_Qneed_ht, v_Qneed_cl));
   // Total heating energy fraction.
-  double frac_ht_total = sum(v_frac_ht_mode);
+  T frac_ht_total = sum(v_frac_ht_mode);
   // Total yearly pump energy.
-  double Q_pumps_ht = Q_pumps_yr_ht * heating.pumpControlReduction() * structure.floorArea();
+  T Q_pumps_ht = Q_pumps_yr_ht * heating.pumpControlReduction() * structure.floorArea();
   // Distribute the total annual pump energy between the 12 months proportional to the distribution of the heating
   Vector v_Q_pumps_ht = div(mult(v_frac_ht_mode, Q_pumps_ht), frac_ht_total);
 
   // Fraction of time the system is in cooling mode each month.
   Vector v_frac_cl_mode = div(v_Qneed_cl, sum(v_Qneed_ht, v_Qneed_cl));
   // Total cooling energy fraction.
-  double frac_cl_total = sum(v_frac_cl_mode);
+  T frac_cl_total = sum(v_frac_cl_mode);
   // Total yearly pump energy.
-  double Q_pumps_cl = Q_pumps_yr_cl * cooling.pumpControlReduction() * structure.floorArea();
+  T Q_pumps_cl = Q_pumps_yr_cl * cooling.pumpControlReduction() * structure.floorArea();
   // Distribute the total annual pump energy between the 12 months proportional to the distribution of the cooling.
   Vector v_Q_pumps_cl = div(mult(v_frac_cl_mode, Q_pumps_cl), frac_cl_total);
 
   // Total pump operational factor.
   Vector v_frac_tot = div(sum(v_Qneed_ht, v_Qneed_cl), Qneed_ht_yr + Qneed_cl_yr);
-  double frac_total = sum(v_frac_tot);
-  double Q_pumps_tot = Q_pumps_ht + Q_pumps_cl;
+  T frac_total = sum(v_frac_tot);
+  T Q_pumps_tot = Q_pumps_ht + Q_pumps_cl;
 
   if (Q_pumps_ht == 0 || Q_pumps_cl == 0) {
     // If there is just heating or just cooling, use the individual heating or cooling pump energy vector.
@@ -1463,7 +1431,8 @@ void MonthlyModel::pump(const Vector& v_Qneed_ht, const Vector& v_Qneed_cl, doub
  * Energy Generation
  * NOT INCLUDED YET
  */
-void MonthlyModel::energyGeneration() const
+template<typename T>
+void BasicMonthlyModel<T>::energyGeneration() const
 {
 }
 
@@ -1471,14 +1440,15 @@ void MonthlyModel::energyGeneration() const
  * Calculate domestic hot water (DHW).
  * References: NEN 2916 12.2
  */
-void MonthlyModel::heatedWater(Vector& v_Q_dhw_elec, Vector& v_Q_dhw_gas) const
+template<typename T>
+void BasicMonthlyModel<T>::heatedWater(Vector& v_Q_dhw_elec, Vector& v_Q_dhw_gas) const
 {
   // Energy from solar energy hot water collectors - not included yet
   Vector v_Q_dhw_solar(12);
   zero(v_Q_dhw_solar);
 
   // Total annual energy demand required for heating DHW (MJ/yr).
-  double Q_dhw_yr = heating.hotWaterDemand() * (heating.dhw_tset() - heating.dhw_tsupply()) * phys.rhoCpWater();
+  T Q_dhw_yr = heating.hotWaterDemand() * (heating.dhw_tset() - heating.dhw_tsupply()) * phys.rhoCpWater();
 
   Vector v_MonthlyDemand = mult(daysInMonth, Q_dhw_yr, 12);
   Vector v_frac_MonthlyDemand_yr = div(v_MonthlyDemand, daysInYear);
@@ -1492,12 +1462,12 @@ void MonthlyModel::heatedWater(Vector& v_Q_dhw_elec, Vector& v_Q_dhw_gas) const
   // Vector of zeroes for fuel type that is unused.
   Vector Z(v_Q_dhw_need.size(), 0.0);
 
-  printVector("v_MonthlyDemand", v_MonthlyDemand);
-  printVector("v_frac_MonthlyDemand_yr", v_frac_MonthlyDemand_yr);
-  printVector("v_Qe_demand", v_Qe_demand);
-  printVector("v_Q_dhw_demand", v_Q_dhw_demand);
-  printVector("v_Q_dhw_need", v_Q_dhw_need);
-  printVector("Z", Z);
+  traceVector("v_MonthlyDemand", v_MonthlyDemand);
+  traceVector("v_frac_MonthlyDemand_yr", v_frac_MonthlyDemand_yr);
+  traceVector("v_Qe_demand", v_Qe_demand);
+  traceVector("v_Q_dhw_demand", v_Q_dhw_demand);
+  traceVector("v_Q_dhw_need", v_Q_dhw_need);
+  traceVector("Z", Z);
 
   if (heating.hotWaterEnergyType() == 1) {
     v_Q_dhw_elec = v_Q_dhw_need;
@@ -1506,11 +1476,58 @@ void MonthlyModel::heatedWater(Vector& v_Q_dhw_elec, Vector& v_Q_dhw_gas) const
     v_Q_dhw_gas = v_Q_dhw_need;
     v_Q_dhw_elec = Z;
   }
-  printVector("v_Q_dhw_gas", v_Q_dhw_gas);
-  printVector("v_Q_dhw_elec", v_Q_dhw_elec);
+  traceVector("v_Q_dhw_gas", v_Q_dhw_gas);
+  traceVector("v_Q_dhw_elec", v_Q_dhw_elec);
+}
+
+template<typename T>
+std::vector<EndUses> BasicMonthlyModel<T>::simulate() const
+{
+  auto endUses = monthlyEndUses();
+
+  std::vector<EndUses> allResults;
+  EndUses results[12];
+  for (int i = 0; i < 12; i++) {
+
+#ifdef ISOMODEL_STANDALONE
+    for (int euse = 0; euse < 13; euse++) {
+      results[i].addEndUse(euse, endUses[euse][i]);
+    }
+#else
+    results[i].addEndUse(endUses[0][i], EndUseFuelType::Electricity, EndUseCategoryType::Heating);
+    results[i].addEndUse(endUses[1][i], EndUseFuelType::Electricity, EndUseCategoryType::Cooling);
+    results[i].addEndUse(endUses[2][i], EndUseFuelType::Electricity, EndUseCategoryType::InteriorLights);
+    results[i].addEndUse(endUses[3][i], EndUseFuelType::Electricity, EndUseCategoryType::ExteriorLights);
+    results[i].addEndUse(endUses[4][i], EndUseFuelType::Electricity, EndUseCategoryType::Fans);
+    results[i].addEndUse(endUses[5][i], EndUseFuelType::Electricity, EndUseCategoryType::Pumps);
+    results[i].addEndUse(endUses[6][i], EndUseFuelType::Electricity, EndUseCategoryType::InteriorEquipment);
+    results[i].addEndUse(endUses[7][i], EndUseFuelType::Electricity, EndUseCategoryType::ExteriorEquipment);
+    results[i].addEndUse(endUses[8][i], EndUseFuelType::Electricity, EndUseCategoryType::WaterSystems);
+
+    results[i].addEndUse(endUses[9][i], EndUseFuelType::Gas, EndUseCategoryType::Heating);
+    results[i].addEndUse(endUses[10][i], EndUseFuelType::Gas, EndUseCategoryType::Cooling);
+    results[i].addEndUse(endUses[11][i], EndUseFuelType::Gas, EndUseCategoryType::InteriorEquipment);
+    results[i].addEndUse(endUses[12][i], EndUseFuelType::Gas, EndUseCategoryType::WaterSystems);
+#endif
+    allResults.push_back(results[i]);
+  }
+  return allResults;
+}
+
+template<typename T>
+std::vector<T> BasicMonthlyModel<T>::annualEndUses() const
+{
+  auto endUses = monthlyEndUses();
+
+  std::vector<T> totals;
+  for (const auto& endUse : endUses) {
+    totals.push_back(sum(endUse));
+  }
+  return totals;
 }
 
-std::vector<EndUses> MonthlyModel::simulate() const
+template<typename T>
+std::vector<typename BasicMonthlyModel<T>::Vector> BasicMonthlyModel<T>::monthlyEndUses() const
 {
   Vector weekdayOccupiedMegaseconds(12);
   Vector weekdayUnoccupiedMegaseconds(12);
@@ -1518,11 +1535,11 @@ std::vector<EndUses> MonthlyModel::simulate() const
   Vector weekendUnoccupiedMegaseconds(12);
   Vector clockHourOccupied(24);
   Vector clockHourUnoccupied(24);
-  double frac_hrs_wk_day = 0;
-  double hoursUnoccupiedPerDay = 0;
-  double hoursOccupiedPerDay = 0;
-  double frac_hrs_wk_nt = 0;
-  double frac_hrs_wke_tot = 0;
+  T frac_hrs_wk_day = 0;
+  T hoursUnoccupiedPerDay = 0;
+  T hoursOccupiedPerDay = 0;
+  T frac_hrs_wk_nt = 0;
+  T frac_hrs_wke_tot = 0;
 
   //Solor Radiation Breakdown Results
   Vector v_hrs_sun_down_mo(12), v_Tdbt_nt, v_Tdbt_day;
@@ -1532,22 +1549,22 @@ std::vector<EndUses> MonthlyModel::simulate() const
 
   Vector v_wall_A_sol, v_win_hr, v_wall_R_sc, v_win_A_sol;
 
-  double Q_illum_occ, Q_illum_unocc, Q_illum_tot_yr;
+  T Q_illum_occ, Q_illum_unocc, Q_illum_tot_yr;
 
-  double phi_int_avg, phi_plug_avg, phi_illum_avg;
+  T phi_int_avg, phi_plug_avg, phi_illum_avg;
 
-  double phi_int_wk_nt, phi_int_wke_day, phi_int_wke_nt;
+  T phi_int_wk_nt, phi_int_wke_day, phi_int_wke_nt;
   Vector v_E_sol;
 
-  double H_tr;
+  T H_tr;
   Vector v_P_tot_wke_day, v_P_tot_wk_nt, v_P_tot_wke_nt;
 
   Vector v_Th_avg(12), v_Tc_avg(12);
 
-  double phi_I_tot, tau;
+  T phi_I_tot, tau;
   Vector v_Hve_ht, v_Hve_cl;
 
-  double Qneed_ht_yr, Qneed_cl_yr;
+  T Qneed_ht_yr, Qneed_cl_yr;
   Vector v_Qneed_ht, v_Qneed_cl;
 
   Vector v_Qelec_ht, v_Qcl_elec_tot, v_Q_illum_tot, v_Q_illum_ext_tot, v_Qfan_tot, v_Q_pump_tot, v_Q_dhw_elec, v_Qgas_ht, v_Qcl_gas_tot, v_Q_dhw_gas;
@@ -1556,187 +1573,113 @@ std::vector<EndUses> MonthlyModel::simulate() const
 
   //openstudio::isomodel::loadDefaults(monthlyModel);
 
-  if (DEBUG_ISO_MODEL_SIMULATION)
-    std::cout << std::endl << "scheduleAndOccupancy: " << std::endl;
   scheduleAndOccupancy(weekdayOccupiedMegaseconds, weekdayUnoccupiedMegaseconds, weekendOccupiedMegaseconds, weekendUnoccupiedMegaseconds,
       clockHourOccupied, clockHourUnoccupied, frac_hrs_wk_day, hoursUnoccupiedPerDay, hoursOccupiedPerDay, frac_hrs_wk_nt, frac_hrs_wke_tot);
 
-  if (DEBUG_ISO_MODEL_SIMULATION) {
-    std::cout << "frac_hrs_wk_day: " << frac_hrs_wk_day << std::endl;
-    std::cout << "hoursUnoccupiedPerDay: " << hoursUnoccupiedPerDay << std::endl;
-    std::cout << "hoursOccupiedPerDay: " << hoursOccupiedPerDay << std::endl;
-    std::cout << "frac_hrs_wk_nt: " << frac_hrs_wk_nt << std::endl;
-    std::cout << "frac_hrs_wke_tot: " << frac_hrs_wke_tot << std::endl;
-
-    printVector("weekdayOccupiedMegaseconds", weekdayOccupiedMegaseconds);
-    printVector("weekdayUnoccupiedMegaseconds", weekdayUnoccupiedMegaseconds);
-    printVector("weekendOccupiedMegaseconds", weekendOccupiedMegaseconds);
-    printVector("weekendUnoccupiedMegaseconds", weekendUnoccupiedMegaseconds);
-    printVector("clockHourOccupied", clockHourOccupied);
-    printVector("clockHourUnoccupied", clockHourUnoccupied);
-
-    std::cout << std::endl << "solarRadiationBreakdown: " << std::endl;
-  }
+  traceValue("frac_hrs_wk_day", frac_hrs_wk_day);
+  traceValue("hoursUnoccupiedPerDay", hoursUnoccupiedPerDay);
+  traceValue("hoursOccupiedPerDay", hoursOccupiedPerDay);
+  traceValue("frac_hrs_wk_nt", frac_hrs_wk_nt);
+  traceValue("frac_hrs_wke_tot", frac_hrs_wke_tot);
+
+  traceVector("weekdayOccupiedMegaseconds", weekdayOccupiedMegaseconds);
+  traceVector("weekdayUnoccupiedMegaseconds", weekdayUnoccupiedMegaseconds);
+  traceVector("weekendOccupiedMegaseconds", weekendOccupiedMegaseconds);
+  traceVector("weekendUnoccupiedMegaseconds", weekendUnoccupiedMegaseconds);
+  traceVector("clockHourOccupied", clockHourOccupied);
+  traceVector("clockHourUnoccupied", clockHourUnoccupied);
   solarRadiationBreakdown(weekdayOccupiedMegaseconds, weekdayUnoccupiedMegaseconds, weekendOccupiedMegaseconds, weekendUnoccupiedMegaseconds,
       clockHourOccupied, clockHourUnoccupied, v_hrs_sun_down_mo, frac_Pgh_wk_nt, frac_Pgh_wke_day, frac_Pgh_wke_nt, v_Tdbt_nt, v_Tdbt_day);
 
-  if (DEBUG_ISO_MODEL_SIMULATION) {
-    printVector("v_hrs_sun_down_mo", v_hrs_sun_down_mo);
-    printVector("frac_Pgh_wk_nt", frac_Pgh_wk_nt);
-    printVector("frac_Pgh_wke_day", frac_Pgh_wke_day);
-    printVector("frac_Pgh_wke_nt", frac_Pgh_wke_nt);
-    printVector("v_Tdbt_nt", v_Tdbt_nt);
-    printVector("v_Tdbt_day", v_Tdbt_day);
-
-    std::cout << std::endl << "lightingEnergyUse: " << std::endl;
-  }
+  traceVector("v_hrs_sun_down_mo", v_hrs_sun_down_mo);
+  traceVector("frac_Pgh_wk_nt", frac_Pgh_wk_nt);
+  traceVector("frac_Pgh_wke_day", frac_Pgh_wke_day);
+  traceVector("frac_Pgh_wke_nt", frac_Pgh_wke_nt);
+  traceVector("v_Tdbt_nt", v_Tdbt_nt);
+  traceVector("v_Tdbt_day", v_Tdbt_day);
   lightingEnergyUse(v_hrs_sun_down_mo, Q_illum_occ, Q_illum_unocc, Q_illum_tot_yr, v_Q_illum_tot, v_Q_illum_ext_tot);
-  if (DEBUG_ISO_MODEL_SIMULATION) {
-    std::cout << "Q_illum_occ: " << Q_illum_occ << std::endl;
-    std::cout << "Q_illum_unocc: " << Q_illum_unocc << std::endl;
-    std::cout << "Q_illum_unocc: " << Q_illum_unocc << std::endl;
-    printVector("v_Q_illum_tot", v_Q_illum_tot);
-    printVector("v_Q_illum_ext_tot", v_Q_illum_ext_tot);
-
-    std::cout << std::endl << "envelopCalculations: " << std::endl;/*
-     v_wall_A = structure.wallArea();
-     v_win_A = structure.windowArea();
-     v_wall_U = structure.wallUniform();
-     Vector v_win_U = structure.windowUniform();*/
-    printVector("structure.wallArea()", structure.wallArea());
-    printVector("structure.windowArea()", structure.windowArea());
-    printVector("structure.wallUniform()", structure.wallUniform());
-    printVector("structure.windowUniform()", structure.windowUniform());
-  }
+  traceValue("Q_illum_occ", Q_illum_occ);
+  traceValue("Q_illum_unocc", Q_illum_unocc);
+  traceValue("Q_illum_tot_yr", Q_illum_tot_yr);
+  traceVector("v_Q_illum_tot", v_Q_illum_tot);
+  traceVector("v_Q_illum_ext_tot", v_Q_illum_ext_tot);
+  traceVector("structure.wallArea", structure.wallArea());
+  traceVector("structure.windowArea", structure.windowArea());
+  traceVector("structure.wallUniform", structure.wallUniform());
+  traceVector("structure.windowUniform", structure.windowUniform());
   envelopCalculations(v_win_A, v_wall_emiss, v_wall_alpha_sc, v_wall_U, v_wall_A, H_tr);
-  if (DEBUG_ISO_MODEL_SIMULATION) {
-    std::cout << "H_tr: " << H_tr << std::endl;
-    printVector("v_win_A", v_win_A);
-    printVector("v_wall_emiss", v_wall_emiss);
-    printVector("v_wall_alpha_sc", v_wall_alpha_sc);
-    printVector("v_wall_U", v_wall_U);
-    printVector("v_wall_A", v_wall_A);
-
-    std::cout << std::endl << "windowSolarGain: " << std::endl;
-  }
+  traceValue("H_tr", H_tr);
+  traceVector("v_win_A", v_win_A);
+  traceVector("v_wall_emiss", v_wall_emiss);
+  traceVector("v_wall_alpha_sc", v_wall_alpha_sc);
+  traceVector("v_wall_U", v_wall_U);
+  traceVector("v_wall_A", v_wall_A);
   windowSolarGain(v_win_A, v_wall_emiss, v_wall_alpha_sc, v_wall_U, v_wall_A, v_wall_A_sol, v_win_hr, v_wall_R_sc, v_win_A_sol);
 
-  if (DEBUG_ISO_MODEL_SIMULATION) {
-    printVector("v_wall_A_sol", v_wall_A_sol);
-    printVector("v_win_hr", v_win_hr);
-    printVector("v_wall_R_sc", v_wall_R_sc);
-    printVector("v_win_A_sol", v_win_A_sol);
-
-    std::cout << std::endl << "solarHeatGain: " << std::endl;
-  }
+  traceVector("v_wall_A_sol", v_wall_A_sol);
+  traceVector("v_win_hr", v_win_hr);
+  traceVector("v_wall_R_sc", v_wall_R_sc);
+  traceVector("v_win_A_sol", v_win_A_sol);
   solarHeatGain(v_win_A_sol, v_wall_R_sc, v_wall_U, v_wall_A, v_win_hr, v_wall_A_sol, v_E_sol);
 
-  if (DEBUG_ISO_MODEL_SIMULATION) {
-    printVector("v_E_sol", v_E_sol);
-
-    std::cout << std::endl << "heatGainsAndLosses: " << std::endl;
-  }
+  traceVector("v_E_sol", v_E_sol);
   heatGainsAndLosses(frac_hrs_wk_day, Q_illum_occ, Q_illum_unocc, Q_illum_tot_yr, phi_int_avg, phi_plug_avg, phi_illum_avg, phi_int_wke_nt,
       phi_int_wke_day, phi_int_wk_nt);
-  if (DEBUG_ISO_MODEL_SIMULATION) {
-    std::cout << "phi_int_avg: " << phi_int_avg << std::endl;
-    std::cout << "phi_plug_avg: " << phi_plug_avg << std::endl;
-    std::cout << "phi_illum_avg: " << phi_illum_avg << std::endl;
-    std::cout << "phi_int_wke_nt: " << phi_int_wke_nt << std::endl;
-    std::cout << "phi_int_wke_day: " << phi_int_wke_day << std::endl;
-    std::cout << "phi_int_wk_nt: " << phi_int_wk_nt << std::endl;
-
-    std::cout << std::endl << "internalHeatGain: " << std::endl;
-  }
+  traceValue("phi_int_avg", phi_int_avg);
+  traceValue("phi_plug_avg", phi_plug_avg);
+  traceValue("phi_illum_avg", phi_illum_avg);
+  traceValue("phi_int_wke_nt", phi_int_wke_nt);
+  traceValue("phi_int_wke_day", phi_int_wke_day);
+  traceValue("phi_int_wk_nt", phi_int_wk_nt);
   internalHeatGain(phi_int_avg, phi_plug_avg, phi_illum_avg, phi_I_tot);
-  if (DEBUG_ISO_MODEL_SIMULATION) {
-    std::cout << "phi_I_tot: " << phi_I_tot << std::endl;
-
-    std::cout << std::endl << "unoccupiedHeatGain: " << std::endl;
-  }
+  traceValue("phi_I_tot", phi_I_tot);
   unoccupiedHeatGain(phi_int_wk_nt, phi_int_wke_day, phi_int_wke_nt, weekdayUnoccupiedMegaseconds, weekendOccupiedMegaseconds,
       weekendUnoccupiedMegaseconds, frac_Pgh_wk_nt, frac_Pgh_wke_day, frac_Pgh_wke_nt, v_E_sol, v_P_tot_wke_day, v_P_tot_wk_nt, v_P_tot_wke_nt);
-  if (DEBUG_ISO_MODEL_SIMULATION) {
-    printVector("v_P_tot_wke_day", v_P_tot_wke_day);
-    printVector("v_P_tot_wk_nt", v_P_tot_wk_nt);
-    printVector("v_P_tot_wke_nt", v_P_tot_wke_nt);
-
-    std::cout << std::endl << "interiorTemp: " << std::endl;
-  }
+  traceVector("v_P_tot_wke_day", v_P_tot_wke_day);
+  traceVector("v_P_tot_wk_nt", v_P_tot_wk_nt);
+  traceVector("v_P_tot_wke_nt", v_P_tot_wke_nt);
   interiorTemp(v_wall_A, v_P_tot_wke_day, v_P_tot_wk_nt, v_P_tot_wke_nt, v_Tdbt_nt, v_Tdbt_day, H_tr, hoursUnoccupiedPerDay, hoursOccupiedPerDay, frac_hrs_wk_day,
       frac_hrs_wk_nt, frac_hrs_wke_tot, v_Th_avg, v_Tc_avg, tau);
-  if (DEBUG_ISO_MODEL_SIMULATION) {
-    std::cout << "tau: " << tau << std::endl;
-    printVector("v_Th_avg", v_Th_avg);
-    printVector("v_Tc_avg", v_Tc_avg);
-
-    std::cout << std::endl << "ventilationCalc: " << std::endl;
-  }
+  traceValue("tau", tau);
+  traceVector("v_Th_avg", v_Th_avg);
+  traceVector("v_Tc_avg", v_Tc_avg);
   ventilationCalc(v_Th_avg, v_Tc_avg, frac_hrs_wk_day, v_Hve_ht, v_Hve_cl);
-  if (DEBUG_ISO_MODEL_SIMULATION) {
-    printVector("v_Hve_ht", v_Hve_ht);
-    printVector("v_Hve_cl", v_Hve_cl);
-
-    std::cout << std::endl << "heatingAndCooling: " << std::endl;
-  }
+  traceVector("v_Hve_ht", v_Hve_ht);
+  traceVector("v_Hve_cl", v_Hve_cl);
   heatingAndCooling(v_E_sol, v_Th_avg, v_Hve_ht, v_Tc_avg, v_Hve_cl, tau, H_tr, phi_I_tot, frac_hrs_wk_day, v_Qfan_tot, v_Qneed_ht, v_Qneed_cl,
       Qneed_ht_yr, Qneed_cl_yr);
-  if (DEBUG_ISO_MODEL_SIMULATION) {
-    std::cout << "Qneed_ht_yr: " << Qneed_ht_yr << std::endl;
-    std::cout << "Qneed_cl_yr: " << Qneed_cl_yr << std::endl;
-    printVector("v_Qfan_tot", v_Qfan_tot);
-
-    std::cout << std::endl << "hvac: " << std::endl;
-  }
+  traceValue("Qneed_ht_yr", Qneed_ht_yr);
+  traceValue("Qneed_cl_yr", Qneed_cl_yr);
+  traceVector("v_Qfan_tot", v_Qfan_tot);
   hvac(v_Qneed_ht, v_Qneed_cl, Qneed_ht_yr, Qneed_cl_yr, v_Qelec_ht, v_Qgas_ht, v_Qcl_elec_tot, v_Qcl_gas_tot);
-  if (DEBUG_ISO_MODEL_SIMULATION) {
-    printVector("v_Qelec_ht", v_Qelec_ht);
-    printVector("v_Qgas_ht", v_Qgas_ht);
-    printVector("v_Qcl_elec_tot", v_Qcl_elec_tot);
-    printVector("v_Qcl_gas_tot", v_Qcl_gas_tot);
-
-    std::cout << std::endl << "pump: " << std::endl;
-  }
   pump(v_Qneed_ht, v_Qneed_cl, Qneed_ht_yr, Qneed_cl_yr, v_Q_pump_tot);
-  if (DEBUG_ISO_MODEL_SIMULATION) {
-    printVector("v_Q_pump_tot", v_Q_pump_tot);
-
-    std::cout << std::endl << "energyGeneration: " << std::endl;
-  }
+  traceVector("v_Q_pump_tot", v_Q_pump_tot);
   energyGeneration();
-  if (DEBUG_ISO_MODEL_SIMULATION) {
-    std::cout << std::endl << "heatedWater: " << std::endl;
-  }
   heatedWater(v_Q_dhw_elec, v_Q_dhw_gas);
-  if (DEBUG_ISO_MODEL_SIMULATION) {
-    printVector("v_Q_dhw_elec", v_Q_dhw_elec);
-    printVector("v_Q_dhw_gas", v_Q_dhw_gas);
-  }
 
   return outputGeneration(v_Qelec_ht, v_Qcl_elec_tot, v_Q_illum_tot, v_Q_illum_ext_tot, v_Qfan_tot, v_Q_pump_tot, v_Q_dhw_elec, v_Qgas_ht,
       v_Qcl_gas_tot, v_Q_dhw_gas, frac_hrs_wk_day);
 }
-std::vector<EndUses> MonthlyModel::outputGeneration(const Vector& v_Qelec_ht, const Vector& v_Qcl_elec_tot, const Vector& v_Q_illum_tot,
+template<typename T>
+std::vector<typename BasicMonthlyModel<T>::Vector> BasicMonthlyModel<T>::outputGeneration(const Vector& v_Qelec_ht, const Vector& v_Qcl_elec_tot, const Vector& v_Q_illum_tot,
     const Vector& v_Q_illum_ext_tot, const Vector& v_Qfan_tot, const Vector& v_Q_pump_tot, const Vector& v_Q_dhw_elec, const Vector& v_Qgas_ht,
-    const Vector& v_Qcl_gas_tot, const Vector& v_Q_dhw_gas, double frac_hrs_wk_day) const
+    const Vector& v_Qcl_gas_tot, const Vector& v_Q_dhw_gas, T frac_hrs_wk_day) const
 {
-  std::vector<EndUses> allResults;
-
   // TODO: Move the plug load calcs to a separate function. BAA@2015-07-15
 
   // Average electric plug loads (W/m2).
-  double E_plug_elec = building.electricApplianceHeatGainOccupied() * frac_hrs_wk_day
+  T E_plug_elec = building.electricApplianceHeatGainOccupied() * frac_hrs_wk_day
       + building.electricApplianceHeatGainUnoccupied() * (1.0 - frac_hrs_wk_day);
   // Average gas plug loads (W/m2).
-  double E_plug_gas = building.gasApplianceHeatGainOccupied() * frac_hrs_wk_day
+  T E_plug_gas = building.gasApplianceHeatGainOccupied() * frac_hrs_wk_day
       + building.gasApplianceHeatGainUnoccupied() * (1.0 - frac_hrs_wk_day);
 
   // Electric plug load (kWh/m2).
   Vector v_Q_plug_elec = div(mult(hoursInMonth, E_plug_elec, 12), 1000.0);
   // Gas plug load (kWh/m2).
   Vector v_Q_plug_gas = div(mult(hoursInMonth, E_plug_gas, 12), 1000.0);
-  printVector("v_Q_plug_elec", v_Q_plug_elec);
-  printVector("v_Q_plug_gas", v_Q_plug_gas);
+  traceVector("v_Q_plug_elec", v_Q_plug_elec);
+  traceVector("v_Q_plug_gas", v_Q_plug_gas);
 
   // Electric loads (kWh/m2).
   Vector Eelec_ht = div(div(v_Qelec_ht, structure.floorArea()), kWh2MJ); // Total monthly electric usage for heating.
@@ -1748,13 +1691,9 @@ std::vector<EndUses> MonthlyModel::outputGeneration(const Vector& v_Qelec_ht, co
   Vector Eelec_plug = v_Q_plug_elec; // Total monthly elec usage for elec plugloads.
   Vector Eelec_dhw = div(v_Q_dhw_elec, structure.floorArea());
 
-  if (DEBUG_ISO_MODEL_SIMULATION) {
-      printVector("v_Qcl_elec_tot", v_Qcl_elec_tot);
-      printVector("v_Q_pump_tot", v_Q_pump_tot);
-      printVector("Eelec_cl", Eelec_cl);
-      printVector("Eelec_pump", Eelec_pump);
-      std::cout << "floorArea: " << structure.floorArea() << std::endl;
-    }
+  traceVector("Eelec_cl", Eelec_cl);
+  traceVector("Eelec_pump", Eelec_pump);
+  traceValue("floorArea", structure.floorArea());
 
   // Gas loads (kWh/m2).
   Vector Egas_ht = div(div(v_Qgas_ht, structure.floorArea()), kWh2MJ); // Total monthly gas usage for heating.
@@ -1762,42 +1701,20 @@ std::vector<EndUses> MonthlyModel::outputGeneration(const Vector& v_Qelec_ht, co
   Vector Egas_plug = v_Q_plug_gas; // Total monthly gas plugloads.
   Vector Egas_dhw = div(v_Q_dhw_gas, structure.floorArea()); // Total monthly dhw gas plugloads.
 
-  EndUses results[12];
-  for (int i = 0; i < 12; i++) {
-
-#ifdef ISOMODEL_STANDALONE
-    int euse = 0;
-    results[i].addEndUse(euse++, Eelec_ht[i]);
-    results[i].addEndUse(euse++, Eelec_cl[i]);
-    results[i].addEndUse(euse++, Eelec_int_lt[i]);
-    results[i].addEndUse(euse++, Eelec_ext_lt[i]);
-    results[i].addEndUse(euse++, Eelec_fan[i]);
-    results[i].addEndUse(euse++, Eelec_pump[i]);
-    results[i].addEndUse(euse++, Eelec_plug[i]);
-    results[i].addEndUse(euse++, 0); // Exterior Equipment
-    results[i].addEndUse(euse++, Eelec_dhw[i]);
-    results[i].addEndUse(euse++, Egas_ht[i]);
-    results[i].addEndUse(euse++, Egas_cl[i]);
-    results[i].addEndUse(euse++, Egas_plug[i]);
-    results[i].addEndUse(euse++, Egas_dhw[i]);
-#else
-    results[i].addEndUse(Eelec_ht[i], EndUseFuelType::Electricity, EndUseCategoryType::Heating);
-    results[i].addEndUse(Eelec_cl[i], EndUseFuelType::Electricity, EndUseCategoryType::Cooling);
-    results[i].addEndUse(Eelec_int_lt[i], EndUseFuelType::Electricity, EndUseCategoryType::InteriorLights);
-    results[i].addEndUse(Eelec_ext_lt[i], EndUseFuelType::Electricity, EndUseCategoryType::ExteriorLights);
-    results[i].addEndUse(Eelec_fan[i], EndUseFuelType::Electricity, EndUseCategoryType::Fans);
-    results[i].addEndUse(Eelec_pump[i], EndUseFuelType::Electricity, EndUseCategoryType::Pumps);
-    results[i].addEndUse(Eelec_plug[i], EndUseFuelType::Electricity, EndUseCategoryType::InteriorEquipment);
-    results[i].addEndUse(0, EndUseFuelType::Electricity, EndUseCategoryType::ExteriorEquipment);
-    results[i].addEndUse(Eelec_dhw[i], EndUseFuelType::Electricity, EndUseCategoryType::WaterSystems);
-
-    results[i].addEndUse(Egas_ht[i], EndUseFuelType::Gas, EndUseCategoryType::Heating);
-    results[i].addEndUse(Egas_cl[i], EndUseFuelType::Gas, EndUseCategoryType::Cooling);
-    results[i].addEndUse(Egas_plug[i], EndUseFuelType::Gas, EndUseCategoryType::InteriorEquipment);
-    results[i].addEndUse(Egas_dhw[i], EndUseFuelType::Gas, EndUseCategoryType::WaterSystems);
-#endif
-    allResults.push_back(results[i]);
-  }
+  std::vector<Vector> allResults;
+  allResults.push_back(Eelec_ht);
+  allResults.push_back(Eelec_cl);
+  allResults.push_back(Eelec_int_lt);
+  allResults.push_back(Eelec_ext_lt);
+  allResults.push_back(Eelec_fan);
+  allResults.push_back(Eelec_pump);
+  allResults.push_back(Eelec_plug);
+  allResults.push_back(Vector(12, 0.0)); // Exterior Equipment
+  allResults.push_back(Eelec_dhw);
+  allResults.push_back(Egas_ht);
+  allResults.push_back(Egas_cl);
+  allResults.push_back(Egas_plug);
+  allResults.push_back(Egas_dhw);
   return allResults;
 
   // TODO: Why is this here? It is after the function returns... BAA@2015-07-15.
@@ -1813,12 +1730,15 @@ std::vector<EndUses> MonthlyModel::outputGeneration(const Vector& v_Qelec_ht, co
   Vector Etot_dhw = sum(v_Q_dhw_elec, v_Q_plug_elec);
 
   // Find the total annual energy use.
-  double yrSum = 0;
+  T yrSum = 0;
   Vector monthly(Etot_ht.size());
   for (unsigned int i = 0; i < Etot_ht.size(); i++) {
     monthly[i] = Etot_ht[i] + Etot_cl[i] + Etot_int_lt[i] + Etot_ext_lt[i] + Etot_fan[i] + Etot_pump[i] + Etot_plug[i] + Etot_dhw[i];
     yrSum += monthly[i];
   }
 }
+
+template class ISOMODEL_API BasicMonthlyModel<double>;
+template std::vector<GradientDual> BasicMonthlyModel<GradientDual>::annualEndUses() const;
 } // isomodel
 } // openstudio
@@ -34,7 +34,10 @@
 #include "../utilities/data/Matrix.hpp"
 #endif
 
+#include <algorithm>
+#include <cmath>
 #include <memory>
+#include <vector>
 
 #include "Simulation.hpp"
 
@@ -50,13 +53,6 @@ namespace isomodel {
 #define DBL_MIN    2.2250738585072014E-308
 #endif
 
-//flag to turn on debug printing of many intermediate variables to stdout
-#define DEBUG_ISO_MODEL_SIMULATION false
-
-ISOMODEL_API void printVector(const char* vecName, Vector vec);
-ISOMODEL_API void printMatrix(const char* matName, Matrix mat);
-ISOMODEL_API void printMatrix(const char* matName, double* mat, unsigned int dim1, unsigned int dim2);
-
 ISOMODEL_API Vector mult(const double* v1, const double s1, int size);
 ISOMODEL_API Vector mult(const Vector& v1, const double s1);
 ISOMODEL_API Vector mult(const Vector& v1, const double* v2);
@@ -80,14 +76,210 @@ ISOMODEL_API double minimum(const Vector& v1);
 ISOMODEL_API Vector abs(const Vector& v1);
 ISOMODEL_API Vector pow(const Vector& v1, const double xp);
 
-class ISOMODEL_API MonthlyModel : public Simulation
+// Templates of the helpers above for vectors of other scalar types. The
+// scalar arguments have their own type, so plain doubles mix with vectors of
+// dual numbers. Overload resolution still picks the functions above for
+// Vector and double.
+template<typename T>
+BasicVector<T> mult(const double* v1, const T s1, int size)
+{
+  BasicVector<T> vp(size);
+  for (int i = 0; i < size; i++) {
+    vp[i] = v1[i] * s1;
+  }
+  return vp;
+}
+
+template<typename T, typename S>
+BasicVector<T> mult(const BasicVector<T>& v1, const S s1)
+{
+  BasicVector<T> vp(v1.size());
+  for (unsigned int i = 0; i < v1.size(); i++) {
+    vp[i] = v1[i] * s1;
+  }
+  return vp;
+}
+
+template<typename T>
+BasicVector<T> mult(const BasicVector<T>& v1, const double* v2)
+{
+  BasicVector<T> vp(v1.size());
+  for (unsigned int i = 0; i < v1.size(); i++) {
+    vp[i] = v1[i] * v2[i];
+  }
+  return vp;
+}
+
+template<typename T>
+BasicVector<T> mult(const BasicVector<T>& v1, const BasicVector<T>& v2)
+{
+  BasicVector<T> vp(v1.size());
+  for (unsigned int i = 0; i < v1.size(); i++) {
+    vp[i] = v1[i] * v2[i];
+  }
+  return vp;
+}
+
+template<typename T, typename S>
+BasicVector<T> div(const BasicVector<T>& v1, const S s1)
+{
+  BasicVector<T> vp(v1.size());
+  for (unsigned int i = 0; i < v1.size(); i++) {
+    if (s1 == 0)
+      vp[i] = DBL_MAX;
+    else
+      vp[i] = v1[i] / s1;
+  }
+  return vp;
+}
+
+template<typename T, typename S>
+BasicVector<T> div(const S s1, const BasicVector<T>& v1)
+{
+  BasicVector<T> vp(v1.size());
+  for (unsigned int i = 0; i < v1.size(); i++) {
+    if (v1[i] == 0)
+      vp[i] = DBL_MAX;
+    else
+      vp[i] = s1 / v1[i];
+  }
+  return vp;
+}
+
+template<typename T>
+BasicVector<T> div(const BasicVector<T>& v1, const BasicVector<T>& v2)
+{
+  BasicVector<T> vp(v1.size());
+  for (unsigned int i = 0; i < v1.size(); i++) {
+    if (v2[i] == 0)
+      vp[i] = DBL_MAX;
+    else
+      vp[i] = v1[i] / v2[i];
+  }
+  return vp;
+}
+
+template<typename T>
+BasicVector<T> sum(const BasicVector<T>& v1, const BasicVector<T>& v2)
+{
+  BasicVector<T> vs(v1.size());
+  for (unsigned int i = 0; i < v1.size(); i++) {
+    vs[i] = v1[i] + v2[i];
+  }
+  return vs;
+}
+
+template<typename T>
+T sum(const BasicVector<T>& v1)
+{
+  T s = 0;
+  for (unsigned int i = 0; i < v1.size(); i++) {
+    s += v1[i];
+  }
+  return s;
+}
+
+template<typename T, typename S>
+BasicVector<T> sum(const BasicVector<T>& v1, const S v2)
+{
+  BasicVector<T> vs(v1.size());
+  for (unsigned int i = 0; i < v1.size(); i++) {
+    vs[i] = v1[i] + v2;
+  }
+  return vs;
+}
+
+template<typename T>
+BasicVector<T> dif(const BasicVector<T>& v1, const BasicVector<T>& v2)
+{
+  BasicVector<T> vd(v1.size());
+  for (unsigned int i = 0; i < v1.size(); i++) {
+    vd[i] = v1[i] - v2[i];
+  }
+  return vd;
+}
+
+template<typename T, typename S>
+BasicVector<T> dif(const BasicVector<T>& v1, const S v2)
+{
+  BasicVector<T> vd(v1.size());
+  for (unsigned int i = 0; i < v1.size(); i++) {
+    vd[i] = v1[i] - v2;
+  }
+  return vd;
+}
+
+template<typename T, typename S>
+BasicVector<T> dif(const S v1, const BasicVector<T>& v2)
 {
+  BasicVector<T> vd(v2.size());
+  for (unsigned int i = 0; i < v2.size(); i++) {
+    vd[i] = v1 - v2[i];
+  }
+  return vd;
+}
+
+template<typename T>
+BasicVector<T> maximum(const BasicVector<T>& v1, const BasicVector<T>& v2)
+{
+  BasicVector<T> vx(v1.size());
+  for (unsigned int i = 0; i < v1.size(); i++) {
+    vx[i] = std::max(v1[i], v2[i]);
+  }
+  return vx;
+}
+
+template<typename T, typename S>
+BasicVector<T> maximum(const BasicVector<T>& v1, const S val)
+{
+  BasicVector<T> vx(v1.size());
+  for (unsigned int i = 0; i < v1.size(); i++) {
+    vx[i] = std::max<T>(v1[i], val);
+  }
+  return vx;
+}
+
+template<typename T>
+BasicVector<T> abs(const BasicVector<T>& v1)
+{
+  using std::fabs;
+  BasicVector<T> va(v1.size());
+  for (unsigned int i = 0; i < v1.size(); i++) {
+    va[i] = fabs(v1[i]);
+  }
+  return va;
+}
+
+template<typename T, typename S>
+BasicVector<T> pow(const BasicVector<T>& v1, const S xp)
+{
+  using std::pow;
+  BasicVector<T> va(v1.size());
+  for (unsigned int i = 0; i < v1.size(); i++) {
+    va[i] = pow(v1[i], xp);
+  }
+  return va;
+}
+
+/**
+ * The ISO 13790 monthly method. T is the scalar type of the parameters and
+ * calculations (see BasicSimulation).
+ */
+template<typename T>
+class BasicMonthlyModel : public BasicSimulation<T>
+{
+  // Vectors and matrices of the scalar type. These hide openstudio::Vector
+  // and openstudio::Matrix in the calculations, so the weather data (which
+  // is always double) is converted where it enters them.
+  typedef BasicVector<T> Vector;
+  typedef BasicMatrix<T> Matrix;
+
 public:
   /**
    * Creates an empty MonthlyModel. Generally, the MonthlyModel should be created using the UserModel::toMonthlyModel() method.
    */
-  MonthlyModel();
-  virtual ~MonthlyModel();
+  BasicMonthlyModel() {}
+  virtual ~BasicMonthlyModel() {}
 
   /**
    * Runs the ISO Model cacluations using the ISO 13790 monthly method for the given set of input parameters.
@@ -95,20 +287,42 @@ public:
    */
   std::vector<EndUses> simulate() const;
 
+  /**
+   * Runs the same calculations as simulate() and returns the yearly total of
+   * each end use (kWh/m2), in the order of the standalone EndUses. Unlike
+   * simulate(), this works for any scalar type, which is how
+   * UserModel::gradient() differentiates the results.
+   */
+  std::vector<T> annualEndUses() const;
+
+protected:
+  using BasicSimulation<T>::pop;
+  using BasicSimulation<T>::location;
+  using BasicSimulation<T>::lights;
+  using BasicSimulation<T>::building;
+  using BasicSimulation<T>::structure;
+  using BasicSimulation<T>::heating;
+  using BasicSimulation<T>::cooling;
+  using BasicSimulation<T>::ventilation;
+  using BasicSimulation<T>::phys;
+  using BasicSimulation<T>::traceValue;
+  using BasicSimulation<T>::traceVector;
+  using BasicSimulation<T>::traceMatrix;
+
 private:
   // Simulation functions.
   void scheduleAndOccupancy(Vector& weekdayOccupiedMegaseconds, Vector& weekdayUnoccupiedMegaseconds, Vector& weekendOccupiedMegaseconds,
-      Vector& weekendUnoccupiedMegaseconds, Vector& clockHourOccupied, Vector& clockHourUnoccupied, double& frac_hrs_wk_day,
-      double& hoursUnoccupiedPerDay, double& hoursOccupiedPerDay, double& frac_hrs_wk_nt, double& frac_hrs_wke_tot) const;
+      Vector& weekendUnoccupiedMegaseconds, Vector& clockHourOccupied, Vector& clockHourUnoccupied, T& frac_hrs_wk_day,
+      T& hoursUnoccupiedPerDay, T& hoursOccupiedPerDay, T& frac_hrs_wk_nt, T& frac_hrs_wke_tot) const;
 
   void solarRadiationBreakdown(const Vector& weekdayOccupiedMegaseconds, const Vector& weekdayUnoccupiedMegaseconds,
       const Vector& weekendOccupiedMegaseconds, const Vector& weekendUnoccupiedMegaseconds, const Vector& clockHourOccupied,
       const Vector& clockHourUnoccupied, Vector& v_hrs_sun_down_mo, Vector& frac_Pgh_wk_nt, Vector& frac_Pgh_wke_day, Vector& frac_Pgh_wke_nt,
       Vector& v_Tdbt_nt, Vector& v_Tdbt_Day) const;
-  void lightingEnergyUse(const Vector& v_hrs_sun_down_mo, double& Q_illum_occ, double& Q_illum_unocc, double& Q_illum_tot_yr, Vector& v_Q_illum_tot,
+  void lightingEnergyUse(const Vector& v_hrs_sun_down_mo, T& Q_illum_occ, T& Q_illum_unocc, T& Q_illum_tot_yr, Vector& v_Q_illum_tot,
       Vector& v_Q_illum_ext_tot) const;
 
-  void envelopCalculations(Vector& v_win_A, Vector& v_wall_emiss, Vector& v_wall_alpha_sc, Vector& v_wall_U, Vector& v_wall_A, double& H_tr) const;
+  void envelopCalculations(Vector& v_win_A, Vector& v_wall_emiss, Vector& v_wall_alpha_sc, Vector& v_wall_U, Vector& v_wall_A, T& H_tr) const;
 
   void windowSolarGain(const Vector& v_win_A, const Vector& v_wall_emiss, const Vector& v_wall_alpha_sc, const Vector& v_wall_U, const Vector& v_wall_A,
       Vector& v_wall_A_sol, Vector& v_win_hr, Vector& v_wall_R_sc, Vector& v_win_A_sol) const;
@@ -116,42 +330,51 @@ private:
   void solarHeatGain(const Vector& v_win_A_sol, const Vector& v_wall_R_sc, const Vector& v_wall_U, const Vector& v_wall_A, const Vector& v_win_hr,
       const Vector& v_wall_A_sol, Vector& v_E_sol) const;
 
-  void heatGainsAndLosses(double frac_hrs_wk_day, double Q_illum_occ, double Q_illum_unocc, double Q_illum_tot_yr, double& phi_int_avg,
-      double& phi_plug_avg, double& phi_illum_avg, double& phi_int_wke_nt, double& phi_int_wke_day, double& phi_int_wk_nt) const;
+  void heatGainsAndLosses(T frac_hrs_wk_day, T Q_illum_occ, T Q_illum_unocc, T Q_illum_tot_yr, T& phi_int_avg,
+      T& phi_plug_avg, T& phi_illum_avg, T& phi_int_wke_nt, T& phi_int_wke_day, T& phi_int_wk_nt) const;
 
-  void internalHeatGain(double phi_int_avg, double phi_plug_avg, double phi_illum_avg, double& phi_I_tot) const;
+  void internalHeatGain(T phi_int_avg, T phi_plug_avg, T phi_illum_avg, T& phi_I_tot) const;
 
-  void unoccupiedHeatGain(double phi_int_wk_nt, double phi_int_wke_day, double phi_int_wke_nt, const Vector& weekdayUnoccupiedMegaseconds,
+  void unoccupiedHeatGain(T phi_int_wk_nt, T phi_int_wke_day, T phi_int_wke_nt, const Vector& weekdayUnoccupiedMegaseconds,
       const Vector& weekendOccupiedMegaseconds, const Vector& weekendUnoccupiedMegaseconds, const Vector& frac_Pgh_wk_nt,
       const Vector& frac_Pgh_wke_day, const Vector& frac_Pgh_wke_nt, const Vector& v_E_sol, Vector& v_P_tot_wke_day, Vector& v_P_tot_wk_nt,
       Vector& v_P_tot_wke_nt) const;
   
   void interiorTemp(const Vector& v_wall_A, const Vector& v_P_tot_wke_day, const Vector& v_P_tot_wk_nt, const Vector& v_P_tot_wke_nt,
-      const Vector& v_Tdbt_nt, const Vector& v_Tdbt_day, double H_tr, double hoursUnoccupiedPerDay, double hoursOccupiedPerDay, double frac_hrs_wk_day, double frac_hrs_wk_nt,
-      double frac_hrs_wke_tot, Vector& v_Th_avg, Vector& v_Tc_avg, double& tau) const;
+      const Vector& v_Tdbt_nt, const Vector& v_Tdbt_day, T H_tr, T hoursUnoccupiedPerDay, T hoursOccupiedPerDay, T frac_hrs_wk_day, T frac_hrs_wk_nt,
+      T frac_hrs_wke_tot, Vector& v_Th_avg, Vector& v_Tc_avg, T& tau) const;
 
-  void ventilationCalc(const Vector& v_Th_avg, const Vector& v_Tc_avg, double frac_hrs_wk_day, Vector& v_Hve_ht, Vector& v_Hve_cl) const;
+  void ventilationCalc(const Vector& v_Th_avg, const Vector& v_Tc_avg, T frac_hrs_wk_day, Vector& v_Hve_ht, Vector& v_Hve_cl) const;
 
-  void heatingAndCooling(const Vector& v_E_sol, const Vector& v_Th_avg, const Vector& v_Hve_ht, const Vector& v_Tc_avg, const Vector& v_Hve_cl, double tau,
-      double H_tr, double phi_I_tot, double frac_hrs_wk_day, Vector& v_Qfan_tot, Vector& v_Qneed_ht, Vector& v_Qneed_cl, double& Qneed_ht_yr,
-      double& Qneed_cl_yr) const;
+  void heatingAndCooling(const Vector& v_E_sol, const Vector& v_Th_avg, const Vector& v_Hve_ht, const Vector& v_Tc_avg, const Vector& v_Hve_cl, T tau,
+      T H_tr, T phi_I_tot, T frac_hrs_wk_day, Vector& v_Qfan_tot, Vector& v_Qneed_ht, Vector& v_Qneed_cl, T& Qneed_ht_yr,
+      T& Qneed_cl_yr) const;
 
-  void hvac(const Vector& v_Qneed_ht, const Vector& v_Qneed_cl, double Qneed_ht_yr, double Qneed_cl_yr, Vector& v_Qelec_ht, Vector& v_Qgas_ht,
+  void hvac(const Vector& v_Qneed_ht, const Vector& v_Qneed_cl, T Qneed_ht_yr, T Qneed_cl_yr, Vector& v_Qelec_ht, Vector& v_Qgas_ht,
       Vector& v_Qcl_elec_tot, Vector& v_Qcl_gas_tot) const;
-  void pump(const Vector& v_Qneed_ht, const Vector& v_Qneed_cl, double Qneed_ht_yr, double Qneed_cl_yr, Vector& v_Q_pump_tot) const;
+  void pump(const Vector& v_Qneed_ht, const Vector& v_Qneed_cl, T Qneed_ht_yr, T Qneed_cl_yr, Vector& v_Q_pump_tot) const;
 
   void energyGeneration() const;
 
   void heatedWater(Vector& v_Q_dhw_elec, Vector& v_Q_dhw_gas) const;
 
-  std::vector<EndUses> outputGeneration(const Vector& v_Qelec_ht, const Vector& v_Qcl_elec_tot, const Vector& v_Q_illum_tot, const Vector& v_Q_illum_ext_tot,
+  /**
+   * Runs the calculations and returns the monthly values (kWh/m2) of each end
+   * use, in the order of the standalone EndUses.
+   */
+  std::vector<Vector> monthlyEndUses() const;
+
+  std::vector<Vector> outputGeneration(const Vector& v_Qelec_ht, const Vector& v_Qcl_elec_tot, const Vector& v_Q_illum_tot, const Vector& v_Q_illum_ext_tot,
       const Vector& v_Qfan_tot, const Vector& v_Q_pump_tot, const Vector& v_Q_dhw_elec, const Vector& v_Qgas_ht, const Vector& v_Qcl_gas_tot,
-      const Vector& v_Q_dhw_gas, double frac_hrs_wk_day) const;
+      const Vector& v_Q_dhw_gas, T frac_hrs_wk_day) const;
 
 #ifdef _OPENSTUDIOS
   REGISTER_LOGGER("openstudio.isomodel.MonthlyModel");
 #endif
 };
+
+extern template class ISOMODEL_API BasicMonthlyModel<double>;
+typedef BasicMonthlyModel<double> MonthlyModel;
 } // isomodel
 } // openstudio
 
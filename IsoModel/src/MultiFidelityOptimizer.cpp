@@ -0,0 +1,540 @@
+#include "MultiFidelityOptimizer.hpp"
+#include "WorkStealingPool.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <iomanip>
+#include <limits>
+#include <numeric>
+#include <ostream>
+#include <stdexcept>
+
+namespace openstudio {
+namespace isomodel {
+
+namespace {
+
+const double infinity = std::numeric_limits<double>::infinity();
+
+const char* const endUseNames[] = { "ElecHeat", "ElecCool", "ElecIntLights", "ElecExtLights", "ElecFans", "ElecPump", "ElecEquipInt",
+                                    "ElecEquipExt", "ElectDHW", "GasHeat", "GasCool", "GasEquip", "GasDHW" };
+
+const std::size_t endUses = 13;
+const std::size_t values = 12 * endUses; // A year of monthly end uses, [month * endUses + end use].
+
+std::string lowercase(std::string value)
+{
+  std::transform(value.begin(), value.end(), value.begin(), ::tolower);
+  return value;
+}
+
+// One candidate and what is known of it.
+struct Candidate
+{
+  std::vector<double> values; // Property values.
+  std::vector<double> unit; // The values as a point of the unit cube of the ranges.
+  std::vector<double> monthly; // Monthly end uses from each engine, empty until run.
+  std::vector<double> hourly;
+  bool failed = false;
+  bool paired = false; // Run with both engines.
+  std::size_t region = 0;
+  double monthlyObjective = 0;
+  double hourlyObjective = 0;
+};
+
+// The pairs' summed monthly and hourly end uses, from which a correction is
+// made.
+struct PairSums
+{
+  std::vector<double> monthly = std::vector<double>(values, 0.0);
+  std::vector<double> hourly = std::vector<double>(values, 0.0);
+  double pairs = 0;
+
+  void add(const Candidate& candidate, double sign)
+  {
+    for (std::size_t i = 0; i < values; ++i) {
+      monthly[i] += sign * candidate.monthly[i];
+      hourly[i] += sign * candidate.hourly[i];
+    }
+    pairs += sign;
+  }
+
+  // The corrected objective of monthly results. Near-zero sums left by
+  // removing a pair count as zero.
+  double corrected(const std::vector<double>& results, const std::vector<double>& weights) const
+  {
+    auto objective = 0.0;
+    for (std::size_t i = 0; i < values; ++i) {
+      auto weight = weights[i % endUses];
+      if (weight == 0.0) {
+        continue;
+      }
+      auto scale = std::abs(monthly[i]) + std::abs(hourly[i]);
+      if (std::abs(monthly[i]) > 1e-12 * scale) {
+        objective += weight * results[i] * hourly[i] / monthly[i];
+      } else {
+        objective += weight * (results[i] + (hourly[i] - monthly[i]) / pairs);
+      }
+    }
+    return objective;
+  }
+};
+
+std::vector<double> flatten(const std::vector<EndUses>& months)
+{
+  if (months.size() != 12) {
+    throw std::runtime_error("Expected 12 months of results");
+  }
+  std::vector<double> flat(values);
+  for (std::size_t month = 0; month < 12; ++month) {
+    auto results = months[month];
+    for (std::size_t i = 0; i < endUses; ++i) {
+#ifdef ISOMODEL_STANDALONE
+      flat[month * endUses + i] = results.getEndUse(i);
+#else
+      flat[month * endUses + i] = results.getEndUse(isoResultsEndUseTypes[i].first, isoResultsEndUseTypes[i].second);
+#endif
+    }
+  }
+  return flat;
+}
+
+double objectiveOf(const std::vector<double>& results, const std::vector<double>& weights)
+{
+  auto objective = 0.0;
+  for (std::size_t i = 0; i < values; ++i) {
+    objective += weights[i % endUses] * results[i];
+  }
+  return objective;
+}
+
+double squaredDistance(const std::vector<double>& a, const std::vector<double>& b)
+{
+  auto distance = 0.0;
+  for (std::size_t d = 0; d < a.size(); ++d) {
+    distance += (a[d] - b[d]) * (a[d] - b[d]);
+  }
+  return distance;
+}
+
+double relative(double error, double reference)
+{
+  return reference != 0.0 ? error / std::abs(reference) : error;
+}
+
+} // namespace
+
+OptimizationSpec OptimizationSpec::read(const std::string& path)
+{
+  try {
+    return read(Properties(path));
+  } catch (std::domain_error* e) {
+    // Properties throws pointers.
+    std::string message = e->what();
+    delete e;
+    throw std::invalid_argument(message);
+  }
+}
+
+OptimizationSpec OptimizationSpec::read(const Properties& props)
+{
+  OptimizationSpec spec;
+  Properties candidates;
+  for (auto key = props.keys_begin(); key != props.keys_end(); ++key) {
+    if (*key == "objective") {
+      spec.objective = lowercase(*props.getProperty(*key));
+      spec.objectiveWeights();
+    } else if (*key == "pairs" || *key == "regions" || *key == "batch" || *key == "maxhourly") {
+      auto value = props.getPropertyAsInt(*key);
+      if (!value || *value < 0) {
+        throw std::invalid_argument("Optimization " + *key + " must be a non-negative integer");
+      }
+      if (*key == "pairs") {
+        spec.pairs = static_cast<std::size_t>(*value);
+      } else if (*key == "regions") {
+        spec.regions = static_cast<std::size_t>(*value);
+      } else if (*key == "batch") {
+        spec.batch = static_cast<std::size_t>(*value);
+      } else {
+        spec.maxHourly = static_cast<std::size_t>(*value);
+      }
+    } else if (*key == "confidence") {
+      auto value = props.getPropertyAsDouble(*key);
+      if (!value || !(*value >= 0.0)) {
+        throw std::invalid_argument("Optimization confidence must be a non-negative number");
+      }
+      spec.confidence = *value;
+    } else if (*key == "verify") {
+      auto value = lowercase(*props.getProperty(*key));
+      if (value != "true" && value != "false") {
+        throw std::invalid_argument("Optimization verify must be true or false");
+      }
+      spec.verify = value == "true";
+    } else if (*key == "engine") {
+      throw std::invalid_argument("An optimization chooses the engine for each candidate; remove the engine key");
+    } else {
+      candidates.putProperty(*key, *props.getProperty(*key));
+    }
+  }
+  spec.candidates = SweepSpec::read(candidates);
+  return spec;
+}
+
+std::vector<double> OptimizationSpec::objectiveWeights() const
+{
+  std::vector<double> weights(endUses, 0.0);
+  if (objective == "total" || objective == "electricity" || objective == "gas") {
+    // The first nine end uses are electric, the rest gas.
+    for (std::size_t i = 0; i < endUses; ++i) {
+      weights[i] = objective == "total" || (objective == "electricity") == (i < 9) ? 1.0 : 0.0;
+    }
+    return weights;
+  }
+  for (std::size_t i = 0; i < endUses; ++i) {
+    if (lowercase(endUseNames[i]) == lowercase(objective)) {
+      weights[i] = 1.0;
+      return weights;
+    }
+  }
+  throw std::invalid_argument("Unknown optimization objective '" + objective + "'. Use total, electricity, gas or an end use.");
+}
+
+void OptimizationResult::write(std::ostream& out) const
+{
+  out << std::setprecision(10);
+  out << "Objective," << objective << "\n";
+  out << "Candidates," << candidates << "\n";
+  out << "Failures," << failures << "\n";
+  out << "MonthlyRuns," << monthlyRuns << "\n";
+  out << "HourlyRuns," << hourlyRuns << "\n";
+  out << "PairedRuns," << pairedRuns << "\n";
+  out << "PromotedRuns," << promotedRuns << "\n";
+  out << "Rounds," << rounds << "\n";
+  out << "HourlyRunsAvoided," << hourlyRunsAvoided << "\n";
+  out << "WallSeconds," << wallSeconds << "\n";
+  out << "Cancelled," << (cancelled ? "true" : "false") << "\n";
+  out << "HourlyObjective," << hourlyObjective << "\n";
+  out << "MonthlyObjective," << monthlyObjective << "\n";
+  out << "PredictedObjective," << predictedObjective << "\n";
+  out << "ObjectiveError," << objectiveError << "\n";
+  out << "CorrectionRmse," << correctionRmse << "\n";
+  if (verified) {
+    out << "VerificationFailures," << verificationFailures << "\n";
+    out << "TrueObjective," << trueObjective << "\n";
+    out << "OptimalityGap," << optimalityGap << "\n";
+    out << "MonthlyRmse," << monthlyRmse << "\n";
+    out << "CorrectedRmse," << correctedRmse << "\n";
+  }
+
+  out << "\nProperty,Value" << (verified ? ",TrueValue" : "") << "\n";
+  for (std::size_t i = 0; i < properties.size(); ++i) {
+    out << properties[i] << "," << values[i];
+    if (verified) {
+      out << "," << trueValues[i];
+    }
+    out << "\n";
+  }
+
+  out << "\nRegion,Candidates,Pairs,MeanCorrection";
+  for (const auto& property : properties) {
+    out << "," << property;
+  }
+  out << "\n";
+  for (std::size_t r = 0; r < regions.size(); ++r) {
+    out << r << "," << regions[r].candidates << "," << regions[r].pairs << "," << regions[r].meanCorrection;
+    for (auto value : regions[r].centre) {
+      out << "," << value;
+    }
+    out << "\n";
+  }
+  out.flush();
+}
+
+MultiFidelityOptimizer::MultiFidelityOptimizer(const std::string& baseIsmPath, const std::string& defaultsPath) :
+    m_sweep(baseIsmPath, defaultsPath)
+{
+}
+
+OptimizationResult MultiFidelityOptimizer::run(const OptimizationSpec& spec) const
+{
+  const auto& sweep = spec.candidates;
+  if (sweep.properties.empty()) {
+    throw std::invalid_argument("An optimization needs at least one property to vary");
+  }
+  if (sweep.hourly) {
+    throw std::invalid_argument("An optimization chooses the engine for each candidate; its candidates can't be hourly");
+  }
+  if (spec.pairs < 2 || spec.regions == 0 || spec.batch == 0) {
+    throw std::invalid_argument("An optimization needs at least 2 pairs, 1 region and a batch of 1");
+  }
+  auto weights = spec.objectiveWeights();
+
+  auto start = std::chrono::steady_clock::now();
+  OptimizationResult result;
+  result.objective = spec.objective;
+  result.properties = sweep.properties;
+
+  std::vector<Candidate> candidates;
+  for (auto& variant : sweep.variants()) {
+    Candidate candidate;
+    candidate.values = variant;
+    for (std::size_t d = 0; d < variant.size(); ++d) {
+      auto range = std::minmax_element(sweep.values[d].begin(), sweep.values[d].end());
+      auto width = *range.second - *range.first;
+      candidate.unit.push_back(width > 0.0 ? (variant[d] - *range.first) / width : 0.0);
+    }
+    candidates.push_back(candidate);
+  }
+  if (candidates.empty()) {
+    throw std::invalid_argument("An optimization needs at least one candidate");
+  }
+  result.candidates = candidates.size();
+
+  WorkStealingPool pool(sweep.threads);
+  auto simulate = [&](const std::vector<std::size_t>& chosen, bool hourly) {
+    std::vector<std::function<void()> > tasks;
+    for (auto i : chosen) {
+      tasks.push_back([&, i]() {
+        auto& candidate = candidates[i];
+        try {
+          auto results = flatten(m_sweep.simulate(sweep.properties, candidate.values, hourly, &sweep.cancellation));
+          (hourly ? candidate.hourlyObjective : candidate.monthlyObjective) = objectiveOf(results, weights);
+          (hourly ? candidate.hourly : candidate.monthly) = std::move(results);
+        } catch (const std::exception&) {
+          // Failed candidates are never paired or taken.
+          candidate.failed = true;
+        }
+      });
+    }
+    pool.run(tasks);
+  };
+
+  // Screen every candidate with the monthly model.
+  std::vector<std::size_t> screened, all(candidates.size());
+  std::iota(all.begin(), all.end(), 0);
+  simulate(all, false);
+  result.monthlyRuns = candidates.size();
+  for (auto i : all) {
+    if (!candidates[i].failed) {
+      screened.push_back(i);
+    }
+  }
+  if (screened.empty()) {
+    throw std::runtime_error("No candidate could be run with the monthly model");
+  }
+
+  // Pair the candidate with the best monthly objective, then each candidate
+  // farthest from those paired so far.
+  std::vector<std::size_t> pairs;
+  std::vector<double> nearest(candidates.size(), infinity);
+  auto next = *std::min_element(screened.begin(), screened.end(), [&candidates](std::size_t a, std::size_t b) {
+    return candidates[a].monthlyObjective < candidates[b].monthlyObjective;
+  });
+  auto wanted = std::min(spec.pairs, screened.size());
+  if (spec.maxHourly) {
+    wanted = std::min(wanted, spec.maxHourly);
+  }
+  while (pairs.size() < wanted) {
+    pairs.push_back(next);
+    candidates[next].paired = true;
+    auto farthest = -1.0;
+    for (auto i : screened) {
+      nearest[i] = std::min(nearest[i], squaredDistance(candidates[i].unit, candidates[next].unit));
+      if (!candidates[i].paired && nearest[i] > farthest) {
+        farthest = nearest[i];
+        next = i;
+      }
+    }
+  }
+  simulate(pairs, true);
+  result.hourlyRuns = result.pairedRuns = pairs.size();
+
+  // The regions grow from the first pairs that ran, in the order they were
+  // picked, which spreads them out.
+  std::vector<std::size_t> centres;
+  for (auto i : pairs) {
+    if (!candidates[i].failed && centres.size() < spec.regions) {
+      centres.push_back(i);
+    }
+  }
+  if (centres.empty()) {
+    throw std::runtime_error("No candidate could be run with the hourly model");
+  }
+  for (auto i : screened) {
+    auto& candidate = candidates[i];
+    auto closest = infinity;
+    for (std::size_t r = 0; r < centres.size(); ++r) {
+      auto distance = squaredDistance(candidate.unit, candidates[centres[r]].unit);
+      if (distance < closest) {
+        closest = distance;
+        candidate.region = r;
+      }
+    }
+  }
+
+  std::vector<PairSums> regionSums;
+  PairSums globalSums;
+  auto isPair = [&candidates](std::size_t i) { return candidates[i].paired && !candidates[i].failed; };
+  auto sumPairs = [&]() {
+    regionSums.assign(centres.size(), PairSums());
+    globalSums = PairSums();
+    for (auto i : screened) {
+      if (isPair(i)) {
+        regionSums[candidates[i].region].add(candidates[i], 1.0);
+        globalSums.add(candidates[i], 1.0);
+      }
+    }
+  };
+  // The corrected objective of a pair, from the other pairs: those of its
+  // region if there are any, or else all of them.
+  auto leaveOneOut = [&](std::size_t i) {
+    auto sums = regionSums[candidates[i].region].pairs > 1 ? regionSums[candidates[i].region] : globalSums;
+    sums.add(candidates[i], -1.0);
+    return sums.pairs > 0 ? sums.corrected(candidates[i].monthly, weights) : infinity;
+  };
+  auto predict = [&](std::size_t i) {
+    const auto& sums = regionSums[candidates[i].region].pairs > 0 ? regionSums[candidates[i].region] : globalSums;
+    return sums.corrected(candidates[i].monthly, weights);
+  };
+  auto correctionError = [&]() {
+    auto squares = 0.0;
+    std::size_t count = 0;
+    for (auto i : screened) {
+      if (isPair(i)) {
+        auto error = leaveOneOut(i) - candidates[i].hourlyObjective;
+        squares += error * error;
+        ++count;
+      }
+    }
+    return count ? std::sqrt(squares / count) : infinity;
+  };
+  auto bestPair = [&]() {
+    std::size_t best = candidates.size();
+    for (auto i : screened) {
+      if (isPair(i) && (best == candidates.size() || candidates[i].hourlyObjective < candidates[best].hourlyObjective)) {
+        best = i;
+      }
+    }
+    return best;
+  };
+
+  // Promote candidates while one could beat the best hourly objective.
+  while (!sweep.cancellation.cancelled() && (!spec.maxHourly || result.hourlyRuns < spec.maxHourly)) {
+    sumPairs();
+    auto margin = spec.confidence > 0.0 ? spec.confidence * correctionError() : 0.0;
+    auto best = candidates[bestPair()].hourlyObjective;
+
+    std::vector<std::pair<double, std::size_t> > promising;
+    for (auto i : screened) {
+      if (!candidates[i].paired) {
+        auto predicted = predict(i);
+        if (predicted - margin < best) {
+          promising.push_back(std::make_pair(predicted, i));
+        }
+      }
+    }
+    if (promising.empty()) {
+      break;
+    }
+    auto count = std::min(promising.size(), spec.batch);
+    if (spec.maxHourly) {
+      count = std::min(count, spec.maxHourly - result.hourlyRuns);
+    }
+    std::partial_sort(promising.begin(), promising.begin() + count, promising.end());
+    std::vector<std::size_t> promoted;
+    for (std::size_t p = 0; p < count; ++p) {
+      promoted.push_back(promising[p].second);
+      candidates[promising[p].second].paired = true;
+    }
+    simulate(promoted, true);
+    result.hourlyRuns += count;
+    result.promotedRuns += count;
+    ++result.rounds;
+  }
+
+  sumPairs();
+  auto best = bestPair();
+  if (best == candidates.size()) {
+    throw std::runtime_error("No candidate could be run with the hourly model");
+  }
+  result.values = candidates[best].values;
+  result.hourlyObjective = candidates[best].hourlyObjective;
+  result.monthlyObjective = candidates[best].monthlyObjective;
+  result.predictedObjective = leaveOneOut(best);
+  result.objectiveError = relative(result.predictedObjective - result.hourlyObjective, result.hourlyObjective);
+  result.correctionRmse = correctionError();
+  result.hourlyRunsAvoided = 1.0 - static_cast<double>(result.hourlyRuns) / candidates.size();
+
+  for (std::size_t r = 0; r < centres.size(); ++r) {
+    OptimizationRegion region;
+    region.centre = candidates[centres[r]].values;
+    result.regions.push_back(region);
+  }
+  for (auto i : screened) {
+    auto& region = result.regions[candidates[i].region];
+    ++region.candidates;
+    if (isPair(i)) {
+      ++region.pairs;
+      region.meanCorrection += candidates[i].hourlyObjective - candidates[i].monthlyObjective;
+    }
+  }
+  for (auto& region : result.regions) {
+    region.meanCorrection /= std::max<std::size_t>(1, region.pairs);
+  }
+
+  for (const auto& candidate : candidates) {
+    result.failures += candidate.failed ? 1 : 0;
+  }
+
+  if (spec.verify && !sweep.cancellation.cancelled()) {
+    std::vector<std::size_t> rest;
+    std::vector<double> predicted(candidates.size(), 0.0);
+    for (auto i : screened) {
+      if (!candidates[i].paired) {
+        rest.push_back(i);
+        predicted[i] = predict(i);
+      }
+    }
+    simulate(rest, true);
+    for (auto i : rest) {
+      result.verificationFailures += candidates[i].failed ? 1 : 0;
+    }
+
+    auto trueBest = best;
+    auto monthlySquares = 0.0, correctedSquares = 0.0;
+    std::size_t compared = 0, checked = 0;
+    for (auto i : screened) {
+      const auto& candidate = candidates[i];
+      if (candidate.failed) {
+        continue;
+      }
+      ++compared;
+      if (candidate.hourlyObjective < candidates[trueBest].hourlyObjective) {
+        trueBest = i;
+      }
+      auto error = candidate.monthlyObjective - candidate.hourlyObjective;
+      monthlySquares += error * error;
+      if (!candidate.paired) {
+        error = predicted[i] - candidate.hourlyObjective;
+        correctedSquares += error * error;
+        ++checked;
+      }
+    }
+    result.verified = true;
+    result.trueValues = candidates[trueBest].values;
+    result.trueObjective = candidates[trueBest].hourlyObjective;
+    result.optimalityGap = relative(result.hourlyObjective - result.trueObjective, result.trueObjective);
+    result.monthlyRmse = std::sqrt(monthlySquares / std::max<std::size_t>(1, compared));
+    result.correctedRmse = std::sqrt(correctedSquares / std::max<std::size_t>(1, checked));
+  }
+
+  result.cancelled = sweep.cancellation.cancelled();
+  result.wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  return result;
+}
+
+} // isomodel
+} // openstudio
@@ -0,0 +1,137 @@
+#ifndef ISOMODEL_MULTI_FIDELITY_OPTIMIZER_HPP
+#define ISOMODEL_MULTI_FIDELITY_OPTIMIZER_HPP
+
+#include "ISOModelAPI.hpp"
+#include "ParametricSweep.hpp"
+#include "Properties.hpp"
+
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace openstudio {
+namespace isomodel {
+
+/**
+ * What a multi-fidelity optimization searches and for what. Read from a file
+ * in the SweepSpec format, which gives the candidates: the method ("lhs",
+ * "sobol", "halton" or "factorial"), samples, seed, threads and the range
+ * "low, high" (or levels) of each property. Further keys configure the
+ * search:
+ *
+ * objective = total<br>
+ * pairs = 16<br>
+ * regions = 4<br>
+ * confidence = 2<br>
+ * batch = 4<br>
+ * maxhourly = 0<br>
+ * verify = false
+ *
+ * objective is the annual use to minimize, in kWh/m2: "total", "electricity",
+ * "gas" or one end use, such as "ElecCool". The engine key isn't allowed,
+ * since the search chooses the engine for each candidate.
+ */
+struct ISOMODEL_API OptimizationSpec
+{
+  SweepSpec candidates;
+  std::string objective = "total";
+  std::size_t pairs = 16; // Candidates run with both engines to learn the correction.
+  std::size_t regions = 4; // Regions of the parameter space with their own correction.
+  double confidence = 2.0; // How many correction errors above the best hourly objective a candidate may be and still be promoted.
+  std::size_t batch = 4; // Candidates promoted to the hourly model at a time.
+  std::size_t maxHourly = 0; // The most hourly runs, or 0 for no limit.
+  bool verify = false; // Also run every candidate hourly, to measure how good the search was.
+
+  /** Reads a spec from a file. Throws std::invalid_argument if it is malformed. */
+  static OptimizationSpec read(const std::string& path);
+
+  /** Reads a spec from parsed properties. Throws std::invalid_argument if it is malformed. */
+  static OptimizationSpec read(const Properties& props);
+
+  /** The weight of each of the 13 end uses in the objective. */
+  std::vector<double> objectiveWeights() const;
+};
+
+// The correction learned in one region of the parameter space.
+struct OptimizationRegion
+{
+  std::vector<double> centre; // Property values of the paired candidate the region grew from.
+  std::size_t candidates = 0;
+  std::size_t pairs = 0; // Candidates in the region run with both engines.
+  double meanCorrection = 0; // The average hourly minus monthly objective of the pairs.
+};
+
+// The outcome of a multi-fidelity optimization.
+struct ISOMODEL_API OptimizationResult
+{
+  std::string objective;
+  std::vector<std::string> properties;
+  std::vector<double> values; // The best candidate run with the hourly model.
+  double hourlyObjective = 0; // Its hourly objective.
+  double monthlyObjective = 0; // Its monthly objective, uncorrected.
+  double predictedObjective = 0; // Its corrected monthly objective, from the other pairs.
+  double objectiveError = 0; // predictedObjective - hourlyObjective, as a fraction of hourlyObjective.
+  double correctionRmse = 0; // Leave-one-out error of the corrected objective over the pairs.
+
+  std::size_t candidates = 0;
+  std::size_t failures = 0; // Candidates that failed with either engine in the search.
+  std::size_t monthlyRuns = 0;
+  std::size_t hourlyRuns = 0; // Pairs and promotions, not counting verification.
+  std::size_t pairedRuns = 0;
+  std::size_t promotedRuns = 0;
+  std::size_t rounds = 0; // Rounds of promotion.
+  double hourlyRunsAvoided = 0; // The fraction of candidates never run with the hourly model.
+  double wallSeconds = 0;
+  bool cancelled = false;
+  std::vector<OptimizationRegion> regions;
+
+  // With verify, from every candidate run with the hourly model.
+  bool verified = false;
+  std::size_t verificationFailures = 0; // Candidates that failed only in the verification runs.
+  std::vector<double> trueValues; // The best candidate.
+  double trueObjective = 0; // Its hourly objective.
+  double optimalityGap = 0; // hourlyObjective - trueObjective, as a fraction of trueObjective.
+  double monthlyRmse = 0; // Of the uncorrected monthly objective over the candidates.
+  double correctedRmse = 0; // Of the corrected monthly objective over the candidates not paired.
+
+  /** Writes a CSV report: the summary, the best candidate and the regions. */
+  void write(std::ostream& out) const;
+};
+
+/**
+ * Searches candidates of a base building (see ParametricSweep) for the lowest
+ * hourly objective while running as few of them as it can with the hourly
+ * model.
+ *
+ * Every candidate is screened with the monthly model. A spread of them, each
+ * as far from those picked before as it can be, are also run hourly, pairing
+ * monthly and hourly results as standalone's --compare does. The first
+ * regions of these pairs are the centres of the regions, and each candidate
+ * belongs to the region of the nearest centre (in the unit cube of the
+ * property ranges). A region's correction scales each month's end use by its
+ * pairs' ratio of hourly to monthly use, or shifts it by their mean
+ * difference where the monthly use is zero.
+ *
+ * Then candidates are promoted, batch at a time in order of their corrected
+ * objective, while one could still beat the best hourly objective: while its
+ * corrected objective is less than confidence leave-one-out errors of the
+ * correction above the best. Promoted candidates join the pairs, refining
+ * the correction and its error, until no candidate is left that could win or
+ * maxhourly runs have been made. Failed candidates are left out, and
+ * cancelling candidates.cancellation fails the runs not yet finished.
+ */
+class ISOMODEL_API MultiFidelityOptimizer
+{
+public:
+  explicit MultiFidelityOptimizer(const std::string& baseIsmPath, const std::string& defaultsPath = std::string());
+
+  OptimizationResult run(const OptimizationSpec& spec) const;
+
+private:
+  ParametricSweep m_sweep;
+};
+
+} // isomodel
+} // openstudio
+#endif // ISOMODEL_MULTI_FIDELITY_OPTIMIZER_HPP
@@ -0,0 +1,150 @@
+#include "OnlineStatistics.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace openstudio {
+namespace isomodel {
+
+void RunningStats::add(double x)
+{
+  if (m_count == 0) {
+    m_min = m_max = x;
+  } else {
+    m_min = std::min(m_min, x);
+    m_max = std::max(m_max, x);
+  }
+  ++m_count;
+  auto delta = x - m_mean;
+  m_mean += delta / m_count;
+  m_m2 += delta * (x - m_mean);
+}
+
+double RunningStats::variance() const
+{
+  return m_count > 1 ? m_m2 / (m_count - 1) : 0.0;
+}
+
+double RunningStats::standardDeviation() const
+{
+  return std::sqrt(variance());
+}
+
+P2Quantile::P2Quantile(double probability) : m_probability(probability)
+{
+  if (!(probability >= 0.0 && probability <= 1.0)) {
+    throw std::invalid_argument("Quantile probabilities must be between 0 and 1");
+  }
+  auto p = probability;
+  const double desired[5] = { 1, 1 + 2 * p, 1 + 4 * p, 3 + 2 * p, 5 };
+  const double increments[5] = { 0, p / 2, p, (1 + p) / 2, 1 };
+  for (int i = 0; i < 5; ++i) {
+    m_heights[i] = 0;
+    m_positions[i] = i + 1;
+    m_desired[i] = desired[i];
+    m_increments[i] = increments[i];
+  }
+}
+
+void P2Quantile::add(double x)
+{
+  if (m_count < 5) {
+    m_heights[m_count++] = x;
+    if (m_count == 5) {
+      std::sort(m_heights, m_heights + 5);
+    }
+    return;
+  }
+
+  // Find the cell holding x, stretching the end markers if it lies outside them.
+  int cell;
+  if (x < m_heights[0]) {
+    m_heights[0] = x;
+    cell = 0;
+  } else if (x >= m_heights[4]) {
+    m_heights[4] = x;
+    cell = 3;
+  } else {
+    cell = 0;
+    while (x >= m_heights[cell + 1]) {
+      ++cell;
+    }
+  }
+
+  for (int i = cell + 1; i < 5; ++i) {
+    m_positions[i] += 1;
+  }
+  for (int i = 0; i < 5; ++i) {
+    m_desired[i] += m_increments[i];
+  }
+  ++m_count;
+
+  // Move the middle markers towards their desired positions, by parabolic
+  // interpolation if that keeps the heights in order and linearly otherwise.
+  auto& h = m_heights;
+  auto& n = m_positions;
+  for (int i = 1; i < 4; ++i) {
+    auto d = m_desired[i] - n[i];
+    if ((d >= 1 && n[i + 1] - n[i] > 1) || (d <= -1 && n[i - 1] - n[i] < -1)) {
+      int s = d > 0 ? 1 : -1;
+      auto parabolic = h[i] + s / (n[i + 1] - n[i - 1]) *
+                                ((n[i] - n[i - 1] + s) * (h[i + 1] - h[i]) / (n[i + 1] - n[i]) +
+                                 (n[i + 1] - n[i] - s) * (h[i] - h[i - 1]) / (n[i] - n[i - 1]));
+      if (h[i - 1] < parabolic && parabolic < h[i + 1]) {
+        h[i] = parabolic;
+      } else {
+        h[i] += s * (h[i + s] - h[i]) / (n[i + s] - n[i]);
+      }
+      n[i] += s;
+    }
+  }
+}
+
+double P2Quantile::value() const
+{
+  if (m_count >= 5) {
+    return m_heights[2];
+  }
+  if (m_count == 0) {
+    return 0.0;
+  }
+
+  // Interpolate between the few values seen so far.
+  double sorted[5];
+  std::copy(m_heights, m_heights + m_count, sorted);
+  std::sort(sorted, sorted + m_count);
+  auto position = m_probability * (m_count - 1);
+  auto below = static_cast<std::size_t>(position);
+  if (below + 1 >= m_count) {
+    return sorted[m_count - 1];
+  }
+  return sorted[below] + (position - below) * (sorted[below + 1] - sorted[below]);
+}
+
+Histogram::Histogram(double low, double high, std::size_t bins) : m_low(low), m_high(high), m_counts(bins, 0)
+{
+  if (bins == 0 || !(high > low)) {
+    throw std::invalid_argument("A histogram needs at least one bin and a range with high > low");
+  }
+}
+
+void Histogram::add(double x)
+{
+  if (m_counts.empty() || x < m_low) {
+    ++m_underflow;
+  } else if (x > m_high) {
+    ++m_overflow;
+  } else {
+    auto bin = static_cast<std::size_t>((x - m_low) / (m_high - m_low) * m_counts.size());
+    ++m_counts[std::min(bin, m_counts.size() - 1)];
+  }
+}
+
+double Histogram::binLow(std::size_t i) const
+{
+  return m_low + (m_high - m_low) * i / m_counts.size();
+}
+
+} // isomodel
+} // openstudio
@@ -0,0 +1,122 @@
+#ifndef ISOMODEL_ONLINE_STATISTICS_HPP
+#define ISOMODEL_ONLINE_STATISTICS_HPP
+
+#include "ISOModelAPI.hpp"
+
+#include <cstddef>
+#include <vector>
+
+namespace openstudio {
+namespace isomodel {
+
+// Summaries of a stream of values that are updated one value at a time and
+// use a fixed amount of memory however many values they see.
+
+/**
+ * Count, mean, variance, minimum and maximum, with Welford's update so the
+ * variance stays accurate when the mean is large compared to the spread.
+ */
+class ISOMODEL_API RunningStats
+{
+public:
+  void add(double x);
+
+  std::size_t count() const {
+    return m_count;
+  }
+  double mean() const {
+    return m_mean;
+  }
+  /** The sample variance, or 0 for fewer than two values. */
+  double variance() const;
+  double standardDeviation() const;
+  double min() const {
+    return m_min;
+  }
+  double max() const {
+    return m_max;
+  }
+
+private:
+  std::size_t m_count = 0;
+  double m_mean = 0;
+  double m_m2 = 0;
+  double m_min = 0;
+  double m_max = 0;
+};
+
+/**
+ * An estimate of one quantile with the P-squared algorithm (Jain and
+ * Chlamtac, 1985), which tracks five markers instead of storing the values.
+ * Exact for the first five values.
+ */
+class ISOMODEL_API P2Quantile
+{
+public:
+  /** Estimates the quantile with the given probability, between 0 and 1. */
+  explicit P2Quantile(double probability);
+
+  void add(double x);
+
+  double probability() const {
+    return m_probability;
+  }
+  std::size_t count() const {
+    return m_count;
+  }
+  /** The current estimate, or 0 if no values have been added. */
+  double value() const;
+
+private:
+  double m_probability;
+  std::size_t m_count = 0;
+  double m_heights[5];
+  double m_positions[5];
+  double m_desired[5];
+  double m_increments[5];
+};
+
+/**
+ * Counts of values in equal bins over a fixed range, plus the number of
+ * values below and above it.
+ */
+class ISOMODEL_API Histogram
+{
+public:
+  Histogram() = default;
+  Histogram(double low, double high, std::size_t bins);
+
+  void add(double x);
+
+  double low() const {
+    return m_low;
+  }
+  double high() const {
+    return m_high;
+  }
+  std::size_t bins() const {
+    return m_counts.size();
+  }
+  /** The lower edge of bin i. */
+  double binLow(std::size_t i) const;
+  const std::vector<std::size_t>& counts() const {
+    return m_counts;
+  }
+  std::size_t underflow() const {
+    return m_underflow;
+  }
+  std::size_t overflow() const {
+    return m_overflow;
+  }
+
+private:
+  double m_low = 0;
+  double m_high = 0;
+  std::vector<std::size_t> m_counts;
+  std::size_t m_underflow = 0;
+  std::size_t m_overflow = 0;
+};
+
+} // isomodel
+} // openstudio
+#endif // ISOMODEL_ONLINE_STATISTICS_HPP
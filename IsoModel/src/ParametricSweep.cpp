@@ -0,0 +1,295 @@
+#include "ParametricSweep.hpp"
+#include "DesignOfExperiments.hpp"
+#include "UserModel.hpp"
+#include "WorkStealingPool.hpp"
+
+#include <iomanip>
+#include <mutex>
+#include <numeric>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+
+namespace openstudio {
+namespace isomodel {
+
+namespace {
+
+// Splits name[index], one value of a nine-value property, into name and
+// index. Returns false for a plain name.
+bool splitIndexedProperty(const std::string& key, std::string& name, std::size_t& index)
+{
+  auto open = key.find('[');
+  if (open == std::string::npos || open == 0 || key.size() != open + 3 || key[open + 2] != ']' ||
+      key[open + 1] < '0' || key[open + 1] > '8') {
+    return false;
+  }
+  name = key.substr(0, open);
+  index = static_cast<std::size_t>(key[open + 1] - '0');
+  return true;
+}
+
+// Throws std::invalid_argument unless key names a scalar .ism property or one
+// value of a nine-value one.
+void checkSweepProperty(const std::string& key)
+{
+  const auto& names = UserModel::propertyNames();
+  std::string name;
+  std::size_t index;
+  if (splitIndexedProperty(key, name, index)) {
+    auto found = names.find(name);
+    if (found == names.end() || found->second != 9) {
+      throw std::invalid_argument("Sweep property " + key + " isn't one value of a nine-value .ism property");
+    }
+    return;
+  }
+  auto found = names.find(key);
+  if (found == names.end()) {
+    throw std::invalid_argument("Unknown sweep property " + key + ": it isn't an .ism property");
+  }
+  if (found->second == 9) {
+    throw std::invalid_argument("Sweep property " + key + " has 9 values; vary one of them with " + key + "[0] (N) to " +
+                                key + "[8] (Roof)");
+  }
+}
+
+} // namespace
+
+SweepSpec SweepSpec::read(const std::string& path)
+{
+  try {
+    return read(Properties(path));
+  } catch (std::domain_error* e) {
+    // Properties throws pointers.
+    std::string message = e->what();
+    delete e;
+    throw std::invalid_argument(message);
+  }
+}
+
+SweepSpec SweepSpec::read(const Properties& props)
+{
+  SweepSpec spec;
+  for (auto key = props.keys_begin(); key != props.keys_end(); ++key) {
+    if (*key == "method") {
+      spec.method = *props.getProperty(*key);
+      if (spec.method != "factorial" && spec.method != "lhs" && spec.method != "sobol" && spec.method != "halton") {
+        throw std::invalid_argument("Unknown sweep method '" + spec.method + "'. Use factorial, lhs, sobol or halton.");
+      }
+    } else if (*key == "samples" || *key == "seed" || *key == "threads") {
+      auto value = props.getPropertyAsInt(*key);
+      if (!value || *value < 0) {
+        throw std::invalid_argument("Sweep " + *key + " must be a non-negative integer");
+      }
+      if (*key == "samples") {
+        spec.samples = static_cast<std::size_t>(*value);
+      } else if (*key == "seed") {
+        spec.seed = static_cast<unsigned>(*value);
+      } else {
+        spec.threads = static_cast<std::size_t>(*value);
+      }
+    } else if (*key == "engine") {
+      auto engine = *props.getProperty(*key);
+      if (engine != "monthly" && engine != "hourly") {
+        throw std::invalid_argument("Unknown sweep engine '" + engine + "'. Use monthly or hourly.");
+      }
+      spec.hourly = engine == "hourly";
+    } else {
+      checkSweepProperty(*key);
+      std::vector<double> values;
+      if (!props.getPropertyAsDoubleVector(*key, values) || values.empty()) {
+        throw std::invalid_argument("Sweep property " + *key + " must be a list of numbers");
+      }
+      spec.properties.push_back(*key);
+      spec.values.push_back(values);
+    }
+  }
+
+  if (spec.method != "factorial") {
+    for (std::size_t i = 0; i < spec.properties.size(); ++i) {
+      if (spec.values[i].size() != 2) {
+        throw std::invalid_argument("Sweep property " + spec.properties[i] + " must be a range 'low, high' for the " +
+                                    spec.method + " method");
+      }
+    }
+  }
+  return spec;
+}
+
+std::vector<std::vector<double> > SweepSpec::variants() const
+{
+  if (method == "factorial") {
+    return fullFactorial(values);
+  }
+
+  std::vector<std::vector<double> > unit;
+  if (method == "lhs") {
+    unit = latinHypercube(samples, properties.size(), seed);
+  } else if (method == "sobol") {
+    unit = sobolSequence(samples, properties.size());
+  } else if (method == "halton") {
+    unit = haltonSequence(samples, properties.size());
+  } else {
+    throw std::invalid_argument("Unknown sweep method '" + method + "'");
+  }
+
+  for (auto& point : unit) {
+    for (std::size_t d = 0; d < point.size(); ++d) {
+      point[d] = values[d][0] + point[d] * (values[d][1] - values[d][0]);
+    }
+  }
+  return unit;
+}
+
+ParametricSweep::ParametricSweep(const std::string& baseIsmPath, const std::string& defaultsPath) :
+    m_baseIsmPath(baseIsmPath), m_weatherCache(std::make_shared<WeatherCache>())
+{
+  try {
+    m_base = defaultsPath.empty() ? Properties(baseIsmPath) : Properties(baseIsmPath, defaultsPath);
+  } catch (std::domain_error* e) {
+    std::string message = e->what();
+    delete e;
+    throw std::invalid_argument(message);
+  }
+}
+
+std::vector<EndUses> ParametricSweep::simulate(const std::vector<std::string>& properties,
+                                               const std::vector<double>& values,
+                                               bool hourly,
+                                               const CancellationToken* cancellation) const
+{
+  if (cancellation) {
+    cancellation->throwIfCancelled();
+  }
+
+  auto props = m_base;
+  for (std::size_t i = 0; i < properties.size(); ++i) {
+    // Properties::putProperty(key, double) keeps only six decimal places.
+    std::ostringstream value;
+    value << std::setprecision(17);
+    std::string name;
+    std::size_t index;
+    if (splitIndexedProperty(properties[i], name, index)) {
+      std::vector<double> current;
+      if (!props.getPropertyAsDoubleVector(name, current) || current.size() != 9) {
+        throw std::invalid_argument("Property " + name + " must have 9 values to vary " + properties[i]);
+      }
+      current[index] = values[i];
+      for (std::size_t j = 0; j < current.size(); ++j) {
+        value << (j ? ", " : "") << current[j];
+      }
+      props.putProperty(name, value.str());
+    } else {
+      value << values[i];
+      props.putProperty(properties[i], value.str());
+    }
+  }
+
+  UserModel umodel;
+  umodel.setWeatherCache(m_weatherCache);
+  umodel.loadProperties(props, m_baseIsmPath);
+  if (!umodel.valid()) {
+    throw std::runtime_error("Invalid model");
+  }
+
+  if (!hourly) {
+    return umodel.toMonthlyModel().simulate();
+  }
+  auto model = umodel.toHourlyModel();
+  if (cancellation) {
+    model.setCancellation(*cancellation);
+  }
+  return model.simulate(true);
+}
+
+std::vector<double> ParametricSweep::evaluate(const std::vector<std::string>& properties,
+                                              const std::vector<double>& values,
+                                              bool hourly,
+                                              const CancellationToken* cancellation) const
+{
+  auto results = simulate(properties, values, hourly, cancellation);
+  std::vector<double> totals(13, 0.0);
+  for (auto& month : results) {
+    for (int i = 0; i < 13; ++i) {
+#ifdef ISOMODEL_STANDALONE
+      totals[i] += month.getEndUse(i);
+#else
+      totals[i] += month.getEndUse(isoResultsEndUseTypes[i].first, isoResultsEndUseTypes[i].second);
+#endif
+    }
+  }
+  return totals;
+}
+
+void ParametricSweep::run(const SweepSpec& spec, const std::function<void(const SweepResult&)>& sink) const
+{
+  auto variants = spec.variants();
+
+  // Finished results wait here until the ones before them are passed on.
+  std::mutex mutex;
+  std::vector<SweepResult> pending(variants.size());
+  std::vector<bool> finished(variants.size(), false);
+  std::size_t next = 0;
+
+  std::vector<std::function<void()> > tasks;
+  for (std::size_t i = 0; i < variants.size(); ++i) {
+    tasks.push_back([&, i]() {
+      SweepResult result;
+      result.variant = i;
+      result.parameters = variants[i];
+      try {
+        result.endUses = evaluate(spec.properties, variants[i], spec.hourly, &spec.cancellation);
+      } catch (const std::exception& e) {
+        result.error = e.what();
+      }
+
+      std::lock_guard<std::mutex> lock(mutex);
+      pending[i] = std::move(result);
+      finished[i] = true;
+      for (; next < variants.size() && finished[next]; ++next) {
+        sink(pending[next]);
+        pending[next] = SweepResult();
+      }
+    });
+  }
+
+  WorkStealingPool pool(spec.threads);
+  pool.run(tasks);
+}
+
+std::vector<SweepResult> ParametricSweep::run(const SweepSpec& spec) const
+{
+  std::vector<SweepResult> results;
+  run(spec, [&results](const SweepResult& result) { results.push_back(result); });
+  return results;
+}
+
+void ParametricSweep::run(const SweepSpec& spec, std::ostream& out) const
+{
+  out << "Variant";
+  for (const auto& property : spec.properties) {
+    out << "," << property;
+  }
+  out << ",ElecHeat,ElecCool,ElecIntLights,ElecExtLights,ElecFans,ElecPump,ElecEquipInt,ElecEquipExt,ElectDHW,GasHeat,GasCool,GasEquip,GasDHW,Total,Error\n";
+
+  run(spec, [&out](const SweepResult& result) {
+    std::ostringstream row;
+    row << std::setprecision(10) << result.variant;
+    for (auto value : result.parameters) {
+      row << "," << value;
+    }
+    if (result.error.empty()) {
+      for (auto endUse : result.endUses) {
+        row << "," << endUse;
+      }
+      row << "," << std::accumulate(result.endUses.begin(), result.endUses.end(), 0.0) << ",";
+    } else {
+      row << std::string(14, ',') << ",\"" << result.error << "\"";
+    }
+    out << row.str() << "\n";
+  });
+  out.flush();
+}
+
+} // isomodel
+} // openstudio
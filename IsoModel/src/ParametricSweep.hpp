@@ -0,0 +1,130 @@
+#ifndef ISOMODEL_PARAMETRIC_SWEEP_HPP
+#define ISOMODEL_PARAMETRIC_SWEEP_HPP
+
+#include "Cancellation.hpp"
+#include "ISOModelAPI.hpp"
+#include "Properties.hpp"
+#include "WeatherCache.hpp"
+
+#include <cstddef>
+#include <functional>
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <vector>
+
+#ifdef ISOMODEL_STANDALONE
+#include "EndUses.hpp"
+#else
+#include "../utilities/data/EndUses.hpp"
+#endif
+
+namespace openstudio {
+namespace isomodel {
+
+/**
+ * What a parametric sweep varies and how. Read from a file of key = value
+ * lines (the .ism format):
+ *
+ * method = lhs<br>
+ * samples = 100<br>
+ * lightingpowerdensityoccupied = 5, 15<br>
+ * coolingsystemcop = 2.5, 4
+ *
+ * The keys method ("factorial", "lhs", "sobol" or "halton"), samples, seed,
+ * engine ("monthly" or "hourly") and threads configure the sweep. Every other
+ * key names an .ism property to vary. For the sampling methods its value is
+ * the range "low, high"; for factorial it is the list of levels. Properties
+ * are varied in alphabetical order. A nine-value property such as wallU is
+ * varied one value at a time, as wallU[0] (N) to wallU[8] (Roof) in the .ism
+ * order N, NE, E, SE, S, SW, W, NW, Roof. A key that isn't an .ism property
+ * is rejected, so a misspelt one can't give identical variants.
+ */
+struct ISOMODEL_API SweepSpec
+{
+  std::string method = "lhs";
+  std::size_t samples = 0; // Number of variants, for the sampling methods.
+  unsigned seed = 0; // For lhs.
+  bool hourly = false; // Run the hourly model (annual totals) instead of the monthly one.
+  std::size_t threads = 0; // Worker threads, or 0 for one per hardware thread.
+  std::vector<std::string> properties;
+  std::vector<std::vector<double> > values; // Levels or {low, high}, one list per property.
+  // Cancel to stop the sweep: hourly variants in progress stop within a
+  // simulated day, and the variants not yet started are skipped.
+  CancellationToken cancellation;
+
+  /** Reads a spec from a file. Throws std::invalid_argument if it is malformed. */
+  static SweepSpec read(const std::string& path);
+
+  /** Reads a spec from parsed properties. Throws std::invalid_argument if it is malformed. */
+  static SweepSpec read(const Properties& props);
+
+  /** Returns the parameter vector of each variant, one value per property. */
+  std::vector<std::vector<double> > variants() const;
+};
+
+// One evaluated variant of a sweep.
+struct SweepResult
+{
+  std::size_t variant = 0;
+  std::vector<double> parameters; // The values of SweepSpec::properties.
+  std::vector<double> endUses; // Annual totals of the 13 end uses (kWh/m2), empty if the variant failed.
+  std::string error; // Why the variant failed, if it did.
+};
+
+/**
+ * Runs variants of a base building. Variants are built by overriding
+ * properties of the base .ism file in memory and loading a UserModel from
+ * them, so no .ism files are written. The variants run in parallel on a
+ * WorkStealingPool and share the base building's weather through a
+ * WeatherCache.
+ */
+class ISOMODEL_API ParametricSweep
+{
+public:
+  explicit ParametricSweep(const std::string& baseIsmPath, const std::string& defaultsPath = std::string());
+
+  /**
+   * Runs every variant of spec and calls sink with each result, in variant
+   * order, as soon as it and the variants before it have finished. Calls to
+   * sink are never concurrent. Variants stopped or skipped by
+   * spec.cancellation are passed on with the SimulationCancelled error.
+   */
+  void run(const SweepSpec& spec, const std::function<void(const SweepResult&)>& sink) const;
+
+  /** Runs every variant of spec and returns the results in variant order. */
+  std::vector<SweepResult> run(const SweepSpec& spec) const;
+
+  /**
+   * Runs every variant of spec and streams a CSV row per variant to out: the
+   * variant number, the property values, the 13 annual end uses and their
+   * total, or the error for a failed variant.
+   */
+  void run(const SweepSpec& spec, std::ostream& out) const;
+
+  /**
+   * Runs one variant of the base building and returns its monthly results.
+   * Throws if it fails to load, or SimulationCancelled if cancellation is
+   * given and cancelled before or during the run. Safe to call from several
+   * threads.
+   */
+  std::vector<EndUses> simulate(const std::vector<std::string>& properties,
+                                const std::vector<double>& values,
+                                bool hourly,
+                                const CancellationToken* cancellation = nullptr) const;
+
+  /** Runs one variant of the base building and returns the annual totals of the 13 end uses. */
+  std::vector<double> evaluate(const std::vector<std::string>& properties,
+                               const std::vector<double>& values,
+                               bool hourly,
+                               const CancellationToken* cancellation = nullptr) const;
+
+private:
+  std::string m_baseIsmPath;
+  Properties m_base;
+  std::shared_ptr<WeatherCache> m_weatherCache;
+};
+
+} // isomodel
+} // openstudio
+#endif // ISOMODEL_PARAMETRIC_SWEEP_HPP
@@ -3,13 +3,7 @@
 namespace openstudio {
 namespace isomodel {
 
-PhysicalQuantities::PhysicalQuantities(void)
-{
-}
-
-PhysicalQuantities::~PhysicalQuantities(void)
-{
-}
+template class ISOMODEL_API BasicPhysicalQuantities<double>;
 
 } // isomodel
 } // openstudio
@@ -20,44 +20,59 @@
 #define ISOMODEL_PHYSICALQUANTITIES_HPP
 
 #include "ISOModelAPI.hpp"
+#include "Dual.hpp"
 
 namespace openstudio {
 namespace isomodel {
-class ISOMODEL_API PhysicalQuantities
+template<typename T>
+class BasicPhysicalQuantities
 {
 public:
-  PhysicalQuantities(void);
-  ~PhysicalQuantities(void);
+  BasicPhysicalQuantities() {}
+
+  /** Converts the parameters from another scalar type. */
+  template<typename U>
+  explicit BasicPhysicalQuantities(const BasicPhysicalQuantities<U>& other) :
+      m_rhoCpAir(other.m_rhoCpAir),
+      m_rhoCpWater(other.m_rhoCpWater)
+  {
+  }
 
   /**
   * Specific heat of air in terms of volume (MJ/m3/K). Different parts of the simulation
   * use different units of rhoCpAir. Multiply by 277.777778 to convert to watt-hr/m3/K.
   * Multiply by 1000000.0 to covert to W/m3/K.
   */
-  double rhoCpAir() const {
+  T rhoCpAir() const {
     return m_rhoCpAir;
   }
 
-  void setRhoCpAir(double rhoCpAir) {
+  void setRhoCpAir(T rhoCpAir) {
     m_rhoCpAir = rhoCpAir;
   }
 
   /**
   * Specific heat of water in terms of volume (MJ/m3/K).
   */
-  double rhoCpWater() const {
+  T rhoCpWater() const {
     return m_rhoCpWater;
   }
 
-  void setRhoCpWater(double rhoCpWater) {
+  void setRhoCpWater(T rhoCpWater) {
     m_rhoCpWater = rhoCpWater;
   }
 
 private:
-  double m_rhoCpAir = 1.22521 * 0.001012;
-  double m_rhoCpWater = 4.1813; 
+  template<typename>
+  friend class BasicPhysicalQuantities;
+
+  T m_rhoCpAir = 1.22521 * 0.001012;
+  T m_rhoCpWater = 4.1813; 
 };
 
+extern template class ISOMODEL_API BasicPhysicalQuantities<double>;
+typedef BasicPhysicalQuantities<double> PhysicalQuantities;
+
 } // isomodel
 } // openstudio
 #endif // ISOMODEL_PHYSICALQUANTITIES_HPP
@@ -0,0 +1,334 @@
+#include "PipelinedBatchRunner.hpp"
+#include "BoundedQueue.hpp"
+#include "UserModel.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace openstudio {
+namespace isomodel {
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+// A stage's counters, in nanoseconds, updated as it goes.
+struct StageCounters
+{
+  std::size_t threads = 0;
+  std::atomic<std::uint64_t> items;
+  std::atomic<std::uint64_t> busy;
+  std::atomic<std::uint64_t> starved;
+  std::atomic<std::uint64_t> blocked;
+
+  StageCounters() : items(0), busy(0), starved(0), blocked(0)
+  {
+  }
+
+  void reset(std::size_t stageThreads)
+  {
+    threads = stageThreads;
+    items = 0;
+    busy = 0;
+    starved = 0;
+    blocked = 0;
+  }
+
+  StageStats stats() const
+  {
+    StageStats stats;
+    stats.threads = threads;
+    stats.items = items;
+    stats.busySeconds = busy * 1e-9;
+    stats.starvedSeconds = starved * 1e-9;
+    stats.blockedSeconds = blocked * 1e-9;
+    return stats;
+  }
+};
+
+// Adds the time since the last call (or construction) to a counter.
+class Stopwatch
+{
+public:
+  Stopwatch() : m_last(Clock::now())
+  {
+  }
+
+  void lap(std::atomic<std::uint64_t>& counter)
+  {
+    auto now = Clock::now();
+    counter += std::chrono::duration_cast<std::chrono::nanoseconds>(now - m_last).count();
+    m_last = now;
+  }
+
+private:
+  Clock::time_point m_last;
+};
+
+// Joins the stage threads when it goes out of scope, after calling stop to
+// wake any that are waiting, so that an exception on the writing thread
+// doesn't leave them running.
+class StageThreads
+{
+public:
+  explicit StageThreads(std::function<void()> stop) : m_stop(std::move(stop))
+  {
+  }
+
+  ~StageThreads()
+  {
+    join();
+  }
+
+  template<typename F>
+  void start(F stage)
+  {
+    m_threads.emplace_back(stage);
+  }
+
+  void join()
+  {
+    m_stop();
+    for (auto& thread : m_threads) {
+      if (thread.joinable()) {
+        thread.join();
+      }
+    }
+  }
+
+private:
+  std::function<void()> m_stop;
+  std::vector<std::thread> m_threads;
+};
+
+void writeStage(std::ostream& out, const char* name, const StageStats& stage)
+{
+  out << name << "," << stage.threads << "," << stage.items << "," << stage.busySeconds << "," << stage.starvedSeconds << ","
+      << stage.blockedSeconds << "," << stage.capacity() << "\n";
+}
+
+} // namespace
+
+struct PipelinedBatchRunner::Counters
+{
+  StageCounters load;
+  StageCounters simulate;
+  StageCounters write;
+};
+
+void PipelineStats::write(std::ostream& out) const
+{
+  out << "Stage,Threads,Items,BusySeconds,StarvedSeconds,BlockedSeconds,Capacity\n";
+  writeStage(out, "load", loading);
+  writeStage(out, "simulate", simulating);
+  writeStage(out, "write", writing);
+}
+
+PipelinedBatchRunner::PipelinedBatchRunner(PipelineSettings settings)
+  : m_settings(settings), m_weatherCache(std::make_shared<WeatherCache>()), m_counters(new Counters())
+{
+  if (m_settings.loaders == 0) {
+    m_settings.loaders = 1;
+  }
+  if (m_settings.simulators == 0) {
+    m_settings.simulators = std::max(1u, std::thread::hardware_concurrency());
+  }
+  if (m_settings.window == 0) {
+    m_settings.window = 1;
+  }
+}
+
+PipelinedBatchRunner::~PipelinedBatchRunner()
+{
+}
+
+PipelineStats PipelinedBatchRunner::stats() const
+{
+  PipelineStats stats;
+  stats.loading = m_counters->load.stats();
+  stats.simulating = m_counters->simulate.stats();
+  stats.writing = m_counters->write.stats();
+  return stats;
+}
+
+BatchReport PipelinedBatchRunner::run(const std::vector<BatchJob>& jobs, std::ostream& out)
+{
+  auto start = Clock::now();
+  auto& counters = *m_counters;
+  counters.load.reset(m_settings.loaders);
+  counters.simulate.reset(m_settings.simulators);
+  counters.write.reset(1);
+
+  struct Loaded
+  {
+    std::size_t index;
+    std::shared_ptr<UserModel> model;
+    std::string error;
+    bool cancelled = false;
+  };
+  struct Simulated
+  {
+    std::size_t index;
+    std::vector<EndUses> results;
+    std::string error;
+    bool cancelled = false;
+  };
+  BoundedQueue<Loaded> loaded(m_settings.queueCapacity);
+  BoundedQueue<Simulated> simulated(m_settings.queueCapacity);
+
+  // The loaders take jobs in order but don't start one more than window
+  // ahead of the next to be written.
+  std::atomic<std::size_t> nextJob(0);
+  std::mutex windowMutex;
+  std::condition_variable windowOpen;
+  std::size_t written = 0;
+  bool stopped = false;
+
+  std::atomic<std::size_t> activeLoaders(m_settings.loaders);
+  auto load = [&]() {
+    Stopwatch watch;
+    for (;;) {
+      auto index = nextJob++;
+      if (index >= jobs.size()) {
+        break;
+      }
+      {
+        std::unique_lock<std::mutex> lock(windowMutex);
+        windowOpen.wait(lock, [&]() { return stopped || index < written + m_settings.window; });
+        if (stopped) {
+          break;
+        }
+      }
+      watch.lap(counters.load.blocked);
+
+      Loaded item;
+      item.index = index;
+      try {
+        m_settings.cancellation.throwIfCancelled();
+        item.model = BatchRunner::load(jobs[index], m_weatherCache);
+      } catch (const SimulationCancelled& e) {
+        item.error = e.what();
+        item.cancelled = true;
+      } catch (const std::exception& e) {
+        item.error = e.what();
+      }
+      ++counters.load.items;
+      watch.lap(counters.load.busy);
+
+      loaded.push(std::move(item));
+      watch.lap(counters.load.blocked);
+    }
+    if (--activeLoaders == 0) {
+      loaded.close();
+    }
+  };
+
+  std::atomic<std::size_t> activeSimulators(m_settings.simulators);
+  auto simulate = [&]() {
+    Stopwatch watch;
+    Loaded item;
+    while (loaded.pop(item)) {
+      watch.lap(counters.simulate.starved);
+
+      Simulated result;
+      result.index = item.index;
+      result.error = item.error;
+      result.cancelled = item.cancelled;
+      if (item.model) {
+        try {
+          result.results = BatchRunner::simulate(jobs[item.index], *item.model, m_settings.cancellation, m_settings.resultCache.get());
+        } catch (const SimulationCancelled& e) {
+          result.error = e.what();
+          result.cancelled = true;
+        } catch (const std::exception& e) {
+          result.error = e.what();
+        }
+        item.model.reset();
+      }
+      ++counters.simulate.items;
+      watch.lap(counters.simulate.busy);
+
+      simulated.push(std::move(result));
+      watch.lap(counters.simulate.blocked);
+    }
+    if (--activeSimulators == 0) {
+      simulated.close();
+    }
+  };
+
+  // Once the writer is done, or has thrown, the queues are closed and the
+  // loaders' window opened, so every stage runs out of work and returns.
+  StageThreads threads([&]() {
+    {
+      std::lock_guard<std::mutex> lock(windowMutex);
+      stopped = true;
+    }
+    windowOpen.notify_all();
+    loaded.close();
+    simulated.close();
+  });
+  for (std::size_t i = 0; i < m_settings.loaders; ++i) {
+    threads.start(load);
+  }
+  for (std::size_t i = 0; i < m_settings.simulators; ++i) {
+    threads.start(simulate);
+  }
+
+  // Write on this thread, in job order.
+  std::vector<std::string> errors(jobs.size());
+  std::vector<char> cancelled(jobs.size(), false);
+  std::map<std::size_t, Simulated> pending;
+  Stopwatch watch;
+  Simulated result;
+  while (simulated.pop(result)) {
+    watch.lap(counters.write.starved);
+    auto index = result.index;
+    pending[index] = std::move(result);
+    for (auto iter = pending.begin(); iter != pending.end() && iter->first == written; iter = pending.erase(iter)) {
+      if (iter->second.error.empty()) {
+        out << BatchRunner::formatRows(jobs[written], iter->second.results);
+      } else {
+        errors[written] = iter->second.error;
+        cancelled[written] = iter->second.cancelled;
+      }
+      ++counters.write.items;
+      {
+        std::lock_guard<std::mutex> lock(windowMutex);
+        ++written;
+      }
+      windowOpen.notify_all();
+    }
+    watch.lap(counters.write.busy);
+  }
+  out.flush();
+  watch.lap(counters.write.busy);
+
+  threads.join();
+
+  BatchReport report;
+  for (std::size_t i = 0; i < jobs.size(); ++i) {
+    if (errors[i].empty()) {
+      ++report.succeeded;
+    } else {
+      report.failures.push_back(std::make_pair(jobs[i].ismPath, errors[i]));
+      report.cancelled += cancelled[i];
+    }
+  }
+  report.weatherFiles = m_weatherCache->size();
+  report.wallSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+  return report;
+}
+
+} // isomodel
+} // openstudio
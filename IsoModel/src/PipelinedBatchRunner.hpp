@@ -0,0 +1,101 @@
+#ifndef ISOMODEL_PIPELINED_BATCH_RUNNER_HPP
+#define ISOMODEL_PIPELINED_BATCH_RUNNER_HPP
+
+#include "BatchRunner.hpp"
+#include "ISOModelAPI.hpp"
+#include "WeatherCache.hpp"
+
+#include <cstddef>
+#include <iosfwd>
+#include <memory>
+#include <vector>
+
+namespace openstudio {
+namespace isomodel {
+
+// Settings for PipelinedBatchRunner.
+struct PipelineSettings
+{
+  // Threads reading .ism files and loading weather.
+  std::size_t loaders = 2;
+  // Threads simulating, or 0 for one per hardware thread.
+  std::size_t simulators = 0;
+  // Buildings held in each queue between two stages.
+  std::size_t queueCapacity = 32;
+  // The most buildings between starting to load and being written. Results
+  // that finish ahead of an earlier building wait to be written in order, so
+  // this bounds how many are held.
+  std::size_t window = 256;
+  // As BatchSettings::cancellation. Skipped jobs still pass through the
+  // stages, but without being loaded or simulated.
+  CancellationToken cancellation;
+  // As BatchSettings::resultCache.
+  std::shared_ptr<ResultCache> resultCache;
+};
+
+// What one stage of a PipelinedBatchRunner has done. Times are summed over
+// the stage's threads.
+struct StageStats
+{
+  std::size_t threads = 0;
+  std::size_t items = 0;
+  double busySeconds = 0; // Doing the stage's work.
+  double starvedSeconds = 0; // Waiting for the stage before.
+  double blockedSeconds = 0; // Waiting for room in the stage after.
+
+  /** Items per second the stage could sustain if its threads never waited. */
+  double capacity() const {
+    return busySeconds > 0 ? items * threads / busySeconds : 0.0;
+  }
+};
+
+struct PipelineStats
+{
+  StageStats loading;
+  StageStats simulating;
+  StageStats writing;
+
+  /** Writes a CSV header and a row per stage. */
+  void write(std::ostream& out) const;
+};
+
+/**
+ * Runs the same jobs as BatchRunner, with the same output, as a pipeline of
+ * three stages joined by BoundedQueues: loader threads parse the .ism files
+ * and load their weather, simulator threads run the models, and the calling
+ * thread formats and writes the results in job order. When disk or
+ * formatting is the bottleneck the simulators keep working on the buildings
+ * already loaded, and when they are, full queues stop the loaders from
+ * reading ahead. The per-stage counters show which stage limits the run.
+ */
+class ISOMODEL_API PipelinedBatchRunner
+{
+public:
+  explicit PipelinedBatchRunner(PipelineSettings settings = PipelineSettings());
+  ~PipelinedBatchRunner();
+
+  PipelinedBatchRunner(const PipelinedBatchRunner&) = delete;
+  PipelinedBatchRunner& operator=(const PipelinedBatchRunner&) = delete;
+
+  /** Runs the jobs, writing the rows BatchRunner::run() would. */
+  BatchReport run(const std::vector<BatchJob>& jobs, std::ostream& out);
+
+  /** The counters of the current or last run. Safe to call from any thread during a run. */
+  PipelineStats stats() const;
+
+  /** The weather shared by the runs. Kept between calls to run(). */
+  std::shared_ptr<WeatherCache> weatherCache() const {
+    return m_weatherCache;
+  }
+
+private:
+  struct Counters;
+
+  PipelineSettings m_settings;
+  std::shared_ptr<WeatherCache> m_weatherCache;
+  std::unique_ptr<Counters> m_counters;
+};
+
+} // isomodel
+} // openstudio
+#endif // ISOMODEL_PIPELINED_BATCH_RUNNER_HPP
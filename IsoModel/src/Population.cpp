@@ -3,13 +3,7 @@
 namespace openstudio {
 namespace isomodel {
 
-Population::Population(void)
-{
-}
-
-Population::~Population(void)
-{
-}
+template class ISOMODEL_API BasicPopulation<double>;
 
 } // isomodel
 } // openstudio
@@ -20,26 +20,41 @@
 #define ISOMODEL_POPULATION_HPP
 
 #include "ISOModelAPI.hpp"
+#include "Dual.hpp"
 
 #include <string>
 
 namespace openstudio {
 namespace isomodel {
-class ISOMODEL_API Population
+template<typename T>
+class BasicPopulation
 {
 public:
-  Population(void);
-  ~Population(void);
+  BasicPopulation() {}
+
+  /** Converts the parameters from another scalar type. */
+  template<typename U>
+  explicit BasicPopulation(const BasicPopulation<U>& other) :
+      m_hoursEnd(other.m_hoursEnd),
+      m_hoursStart(other.m_hoursStart),
+      m_daysEnd(other.m_daysEnd),
+      m_daysStart(other.m_daysStart),
+      m_densityOccupied(other.m_densityOccupied),
+      m_densityUnoccupied(other.m_densityUnoccupied),
+      m_heatGainPerPerson(other.m_heatGainPerPerson),
+      m_scheduleFilePath(other.m_scheduleFilePath)
+  {
+  }
 
   /**
   * First occupied hour (0-23). Note that hoursStart() and hoursEnd() form a closed interval.
   * For example, a "nine to five" eight hour day would have hoursStart() == 9 and hoursEnd() == 16.
   */
-  double hoursStart() const {
+  T hoursStart() const {
     return m_hoursStart;
   }
 
-  void setHoursStart(double value) {
+  void setHoursStart(T value) {
     m_hoursStart = value;
   }
 
@@ -47,11 +62,11 @@ public:
   * Last occupied hour (0-23). Note that hoursStart() and hoursEnd() form a closed interval.
   * For example, a "nine to five" eight hour day would have hoursStart() == 9 and hoursEnd() == 16.
   */
-  double hoursEnd() const {
+  T hoursEnd() const {
     return m_hoursEnd;
   }
 
-  void setHoursEnd(double value) {
+  void setHoursEnd(T value) {
     m_hoursEnd = value;
   }
 
@@ -60,11 +75,11 @@ public:
   * For example, a "mondey to friday" five day work week would have daysStart() == 1 and
   * daysEnd() == 5.
   */
-  double daysStart() const {
+  T daysStart() const {
     return m_daysStart;
   }
 
-  void setDaysStart(double value) {
+  void setDaysStart(T value) {
     m_daysStart = value;
   }
 
@@ -73,44 +88,44 @@ public:
   * For example, a "mondey to friday" five day work week would have daysStart() == 1 and
   * daysEnd() == 5.
   */
-  double daysEnd() const {
+  T daysEnd() const {
     return m_daysEnd;
   }
 
-  void setDaysEnd(double value) {
+  void setDaysEnd(T value) {
     m_daysEnd = value;
   }
 
   /**
   * People density occupied (m2/person).
   */
-  double densityOccupied() const {
+  T densityOccupied() const {
     return m_densityOccupied;
   }
 
-  void setDensityOccupied(double value) {
+  void setDensityOccupied(T value) {
     m_densityOccupied = value;
   }
 
   /**
   * People density unoccupied (m2/person).
   */
-  double densityUnoccupied() const {
+  T densityUnoccupied() const {
     return m_densityUnoccupied;
   }
 
-  void setDensityUnoccupied(double value) {
+  void setDensityUnoccupied(T value) {
     m_densityUnoccupied = value;
   }
 
   /**
   * Heat gain per person (W/m2).
   */
-  double heatGainPerPerson() const {
+  T heatGainPerPerson() const {
     return m_heatGainPerPerson;
   }
 
-  void setHeatGainPerPerson(double value) {
+  void setHeatGainPerPerson(T value) {
     m_heatGainPerPerson = value;
   }
 
@@ -127,18 +142,24 @@ public:
   }
 
 private:
-  double m_hoursEnd;
-  double m_hoursStart;
-  double m_daysEnd;
-  double m_daysStart;
-  double m_densityOccupied;
-  double m_densityUnoccupied;
-  double m_heatGainPerPerson;
+  template<typename>
+  friend class BasicPopulation;
+
+  T m_hoursEnd;
+  T m_hoursStart;
+  T m_daysEnd;
+  T m_daysStart;
+  T m_densityOccupied;
+  T m_densityUnoccupied;
+  T m_heatGainPerPerson;
 
   // TODO: These properties aren't used by the simulations yet -BAA@2015-06-18
   std::string m_scheduleFilePath;
 };
 
+extern template class ISOMODEL_API BasicPopulation<double>;
+typedef BasicPopulation<double> Population;
+
 } // isomodel
 } // openstudio
 #endif // ISOMODEL_POPULATION_HPP
@@ -0,0 +1,282 @@
+#include "Portfolio.hpp"
+#include "ISOResults.hpp"
+
+#include <algorithm>
+#include <iomanip>
+#include <ostream>
+#include <stdexcept>
+
+namespace openstudio {
+namespace isomodel {
+
+namespace {
+
+const int hoursInYear = 8760;
+// The first hour of each month, and the end of the year.
+const int monthStarts[13] = { 0, 744, 1416, 2160, 2880, 3624, 4344, 5088, 5832, 6552, 7296, 8016, 8760 };
+
+const char* endUseColumns = "ElecHeat,ElecCool,ElecIntLights,ElecExtLights,ElecFans,ElecPump,ElecEquipInt,ElecEquipExt,ElectDHW,"
+                            "GasHeat,GasCool,GasEquip,GasDHW,Electricity,Gas";
+
+double endUse(EndUses& result, int use)
+{
+#ifdef ISOMODEL_STANDALONE
+  return result.getEndUse(use);
+#else
+  return result.getEndUse(isoResultsEndUseTypes[use].first, isoResultsEndUseTypes[use].second);
+#endif
+}
+
+std::string groupName(const std::vector<std::string>& dimensions, const std::vector<std::string>& values)
+{
+  std::string name;
+  for (std::size_t i = 0; i < dimensions.size(); ++i) {
+    name += (i > 0 ? ";" : "") + dimensions[i] + "=" + values[i];
+  }
+  return name;
+}
+
+void writeTotals(std::ostream& out, const std::string& group, const PortfolioTotals& totals)
+{
+  for (int month = 0; month <= 12; ++month) {
+    out << group << "," << totals.buildings << "," << totals.floorArea << ",";
+    if (month < 12) {
+      out << month + 1;
+    } else {
+      out << "year";
+    }
+    for (int use = 0; use < PortfolioTotals::endUses; ++use) {
+      out << "," << (month < 12 ? totals.endUse(month, use) : totals.annual(use));
+    }
+    if (month < 12) {
+      out << "," << totals.electricity(month) << "," << totals.gas(month) << "\n";
+    } else {
+      double electricity = 0.0, gas = 0.0;
+      for (int i = 0; i < 12; ++i) {
+        electricity += totals.electricity(i);
+        gas += totals.gas(i);
+      }
+      out << "," << electricity << "," << gas << "\n";
+    }
+  }
+}
+
+// Each thread remembers its accumulator for the last rollup it added to. The
+// ids tell rollups apart, since one may be destroyed and another made at the
+// same address. A thread that goes back to an earlier rollup starts another
+// accumulator in it, which costs memory but not correctness.
+std::atomic<std::uint64_t> nextRollupId(1);
+
+struct ThreadAccumulator
+{
+  std::uint64_t rollup = 0;
+  PortfolioAccumulator* accumulator = nullptr;
+};
+
+thread_local ThreadAccumulator threadAccumulator;
+
+} // namespace
+
+double PortfolioTotals::electricity(int month) const
+{
+  double sum = 0.0;
+  for (int use = 0; use < firstGasEndUse; ++use) {
+    sum += endUse(month, use);
+  }
+  return sum;
+}
+
+double PortfolioTotals::gas(int month) const
+{
+  double sum = 0.0;
+  for (int use = firstGasEndUse; use < endUses; ++use) {
+    sum += endUse(month, use);
+  }
+  return sum;
+}
+
+double PortfolioTotals::annual(int use) const
+{
+  double sum = 0.0;
+  for (int month = 0; month < 12; ++month) {
+    sum += endUse(month, use);
+  }
+  return sum;
+}
+
+void PortfolioTotals::merge(const PortfolioTotals& other)
+{
+  buildings += other.buildings;
+  floorArea += other.floorArea;
+  for (std::size_t i = 0; i < energy.size(); ++i) {
+    energy[i] += other.energy[i];
+  }
+}
+
+PortfolioAccumulator::PortfolioAccumulator(const std::vector<std::string>& dimensions, bool coincident)
+  : m_dimensions(dimensions), m_coincident(coincident)
+{
+  if (coincident) {
+    m_hourly.assign(hoursInYear * PortfolioTotals::endUses, 0.0);
+  }
+}
+
+void PortfolioAccumulator::add(const BatchJob& job, double floorArea, std::vector<EndUses>& results)
+{
+  if (results.size() != 12 && results.size() != hoursInYear) {
+    throw std::invalid_argument("A portfolio needs 12 monthly or 8760 hourly results per building, not " + std::to_string(results.size()));
+  }
+
+  std::vector<std::string> key;
+  for (const auto& dimension : m_dimensions) {
+    auto iter = job.groups.find(dimension);
+    key.push_back(iter == job.groups.end() ? std::string() : iter->second);
+  }
+  auto& totals = m_groups[key];
+  auto weight = floorArea * job.count;
+  totals.buildings += job.count;
+  totals.floorArea += weight;
+
+  if (results.size() == 12) {
+    for (int month = 0; month < 12; ++month) {
+      for (int use = 0; use < PortfolioTotals::endUses; ++use) {
+        totals.energy[month * PortfolioTotals::endUses + use] += weight * endUse(results[month], use);
+      }
+    }
+    return;
+  }
+
+  for (int month = 0; month < 12; ++month) {
+    for (int hour = monthStarts[month]; hour < monthStarts[month + 1]; ++hour) {
+      for (int use = 0; use < PortfolioTotals::endUses; ++use) {
+        auto energy = weight * endUse(results[hour], use);
+        totals.energy[month * PortfolioTotals::endUses + use] += energy;
+        if (m_coincident) {
+          m_hourly[hour * PortfolioTotals::endUses + use] += energy;
+        }
+      }
+    }
+  }
+  m_hourlyBuildings += job.count;
+}
+
+void PortfolioAccumulator::merge(const PortfolioAccumulator& other)
+{
+  if (other.m_dimensions != m_dimensions || other.m_coincident != m_coincident) {
+    throw std::invalid_argument("Can't merge portfolio totals with different dimensions");
+  }
+  for (const auto& group : other.m_groups) {
+    m_groups[group.first].merge(group.second);
+  }
+  for (std::size_t i = 0; i < m_hourly.size(); ++i) {
+    m_hourly[i] += other.m_hourly[i];
+  }
+  m_hourlyBuildings += other.m_hourlyBuildings;
+}
+
+PortfolioTotals PortfolioAccumulator::total() const
+{
+  PortfolioTotals total;
+  for (const auto& group : m_groups) {
+    total.merge(group.second);
+  }
+  return total;
+}
+
+std::map<std::string, PortfolioTotals> PortfolioAccumulator::by(const std::string& dimension) const
+{
+  auto iter = std::find(m_dimensions.begin(), m_dimensions.end(), dimension);
+  if (iter == m_dimensions.end()) {
+    throw std::invalid_argument("The portfolio has no dimension " + dimension);
+  }
+  auto index = iter - m_dimensions.begin();
+  std::map<std::string, PortfolioTotals> totals;
+  for (const auto& group : m_groups) {
+    totals[group.first[index]].merge(group.second);
+  }
+  return totals;
+}
+
+std::pair<int, double> PortfolioAccumulator::peak(bool gas) const
+{
+  std::pair<int, double> peak(0, 0.0);
+  auto first = gas ? PortfolioTotals::firstGasEndUse : 0;
+  auto last = gas ? PortfolioTotals::endUses : PortfolioTotals::firstGasEndUse;
+  for (int hour = 0; hour * PortfolioTotals::endUses < static_cast<int>(m_hourly.size()); ++hour) {
+    double load = 0.0;
+    for (int use = first; use < last; ++use) {
+      load += m_hourly[hour * PortfolioTotals::endUses + use];
+    }
+    if (load > peak.second) {
+      peak = std::make_pair(hour, load);
+    }
+  }
+  return peak;
+}
+
+void PortfolioAccumulator::write(std::ostream& out) const
+{
+  out << std::setprecision(10);
+  out << "Group,Buildings,FloorArea,Month," << endUseColumns << "\n";
+  writeTotals(out, "all", total());
+  for (const auto& dimension : m_dimensions) {
+    for (const auto& group : by(dimension)) {
+      writeTotals(out, dimension + "=" + group.first, group.second);
+    }
+  }
+  if (m_dimensions.size() > 1) {
+    for (const auto& group : m_groups) {
+      writeTotals(out, groupName(m_dimensions, group.first), group.second);
+    }
+  }
+}
+
+void PortfolioAccumulator::writeHourly(std::ostream& out) const
+{
+  out << std::setprecision(10);
+  out << "Hour," << endUseColumns << "\n";
+  for (int hour = 0; hour * PortfolioTotals::endUses < static_cast<int>(m_hourly.size()); ++hour) {
+    out << hour + 1;
+    double electricity = 0.0, gas = 0.0;
+    for (int use = 0; use < PortfolioTotals::endUses; ++use) {
+      auto load = m_hourly[hour * PortfolioTotals::endUses + use];
+      out << "," << load;
+      (use < PortfolioTotals::firstGasEndUse ? electricity : gas) += load;
+    }
+    out << "," << electricity << "," << gas << "\n";
+  }
+}
+
+PortfolioRollup::PortfolioRollup(const std::vector<std::string>& dimensions, bool coincident)
+  : m_dimensions(dimensions), m_coincident(coincident), m_id(nextRollupId++)
+{
+}
+
+PortfolioAccumulator& PortfolioRollup::accumulator()
+{
+  if (threadAccumulator.rollup != m_id) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_accumulators.push_back(std::unique_ptr<PortfolioAccumulator>(new PortfolioAccumulator(m_dimensions, m_coincident)));
+    threadAccumulator.rollup = m_id;
+    threadAccumulator.accumulator = m_accumulators.back().get();
+  }
+  return *threadAccumulator.accumulator;
+}
+
+void PortfolioRollup::add(const BatchJob& job, double floorArea, std::vector<EndUses>& results)
+{
+  accumulator().add(job, floorArea, results);
+}
+
+PortfolioAccumulator PortfolioRollup::merged() const
+{
+  PortfolioAccumulator merged(m_dimensions, m_coincident);
+  std::lock_guard<std::mutex> lock(m_mutex);
+  for (const auto& accumulator : m_accumulators) {
+    merged.merge(*accumulator);
+  }
+  return merged;
+}
+
+} // isomodel
+} // openstudio
@@ -0,0 +1,175 @@
+#ifndef ISOMODEL_PORTFOLIO_HPP
+#define ISOMODEL_PORTFOLIO_HPP
+
+#include "BatchRunner.hpp"
+#include "ISOModelAPI.hpp"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#ifdef ISOMODEL_STANDALONE
+#include "EndUses.hpp"
+#else
+#include "../utilities/data/EndUses.hpp"
+#endif
+
+namespace openstudio {
+namespace isomodel {
+
+/**
+ * Energy use summed over a set of buildings, in kWh: each building's results
+ * (kWh/m2) times its floor area times its stock count.
+ */
+struct ISOMODEL_API PortfolioTotals
+{
+  static const int endUses = 13;
+  // End uses 0 to 8 are electricity, 9 to 12 gas.
+  static const int firstGasEndUse = 9;
+
+  double buildings = 0.0; // The sum of the stock counts.
+  double floorArea = 0.0; // m2, times the stock counts.
+  std::array<double, 12 * endUses> energy {}; // [month * endUses + end use]
+
+  double endUse(int month, int use) const {
+    return energy[month * endUses + use];
+  }
+  double electricity(int month) const;
+  double gas(int month) const;
+  /** The year's total of one end use. */
+  double annual(int use) const;
+
+  void merge(const PortfolioTotals& other);
+};
+
+/**
+ * Streaming totals of building results for a portfolio: for every group of
+ * buildings sharing the same values of the portfolio's dimensions (a
+ * BatchJob's groups, such as building type or climate zone), and, if
+ * coincident is set, the portfolio's hourly load summed across the
+ * buildings given hourly results, so that coincident peaks can be found.
+ * Results are added and dropped, so memory doesn't grow with the number of
+ * buildings. Not safe to use from several threads; see PortfolioRollup.
+ */
+class ISOMODEL_API PortfolioAccumulator
+{
+public:
+  explicit PortfolioAccumulator(const std::vector<std::string>& dimensions = std::vector<std::string>(), bool coincident = false);
+
+  /**
+   * Adds one building's results, 12 months or 8760 hours of end uses in
+   * kWh/m2, weighted by floorArea and job.count. Throws
+   * std::invalid_argument for any other number of results.
+   */
+  void add(const BatchJob& job, double floorArea, std::vector<EndUses>& results);
+
+  /** Adds another accumulator's totals for the same dimensions. */
+  void merge(const PortfolioAccumulator& other);
+
+  const std::vector<std::string>& dimensions() const {
+    return m_dimensions;
+  }
+
+  bool coincident() const {
+    return m_coincident;
+  }
+
+  /** The totals over every building. */
+  PortfolioTotals total() const;
+
+  /** The totals for each combination of dimension values, in dimension order. */
+  const std::map<std::vector<std::string>, PortfolioTotals>& groups() const {
+    return m_groups;
+  }
+
+  /**
+   * The totals for each value of one dimension. Throws std::invalid_argument
+   * if it isn't one of the dimensions.
+   */
+  std::map<std::string, PortfolioTotals> by(const std::string& dimension) const;
+
+  /**
+   * With coincident set, the portfolio's load in each of the 8760 hours, in
+   * kWh: [hour * PortfolioTotals::endUses + end use]. Only buildings added
+   * with hourly results contribute.
+   */
+  const std::vector<double>& hourly() const {
+    return m_hourly;
+  }
+
+  /** The sum of the stock counts of the buildings added with hourly results. */
+  double hourlyBuildings() const {
+    return m_hourlyBuildings;
+  }
+
+  /**
+   * The hour (0 to 8759) of the portfolio's highest coincident load of
+   * electricity, or of gas if gas is true, with the load in kWh.
+   */
+  std::pair<int, double> peak(bool gas = false) const;
+
+  /**
+   * Writes the totals as CSV, in kWh: a row per month and a year row for the
+   * whole portfolio ("all"), for each value of each dimension ("type=office")
+   * and, with more than one dimension, for each combination of values
+   * ("type=office;climate=4A").
+   */
+  void write(std::ostream& out) const;
+
+  /** Writes the coincident hourly loads as CSV, a row per hour, in kWh. */
+  void writeHourly(std::ostream& out) const;
+
+private:
+  std::vector<std::string> m_dimensions;
+  bool m_coincident;
+  std::map<std::vector<std::string>, PortfolioTotals> m_groups;
+  std::vector<double> m_hourly;
+  double m_hourlyBuildings = 0.0;
+};
+
+/**
+ * A PortfolioAccumulator that many threads can add to at once. Each thread
+ * adds to its own accumulator, so adding takes no locks after a thread's
+ * first result, and the threads' totals are merged when they're asked for.
+ */
+class ISOMODEL_API PortfolioRollup
+{
+public:
+  explicit PortfolioRollup(const std::vector<std::string>& dimensions = std::vector<std::string>(), bool coincident = false);
+
+  PortfolioRollup(const PortfolioRollup&) = delete;
+  PortfolioRollup& operator=(const PortfolioRollup&) = delete;
+
+  /** As PortfolioAccumulator::add(); safe to call from several threads. */
+  void add(const BatchJob& job, double floorArea, std::vector<EndUses>& results);
+
+  bool coincident() const {
+    return m_coincident;
+  }
+
+  /**
+   * Merges the threads' totals. Call once the threads have stopped adding
+   * results.
+   */
+  PortfolioAccumulator merged() const;
+
+private:
+  PortfolioAccumulator& accumulator();
+
+  std::vector<std::string> m_dimensions;
+  bool m_coincident;
+  std::uint64_t m_id;
+  mutable std::mutex m_mutex;
+  std::vector<std::unique_ptr<PortfolioAccumulator> > m_accumulators;
+};
+
+} // isomodel
+} // openstudio
+#endif // ISOMODEL_PORTFOLIO_HPP
@@ -184,39 +184,44 @@ void Properties::readFile(const std::string& file)
 {
   ifstream in_file(file.c_str(), ios_base::in);
   if (in_file.is_open()) {
-    std::string line;
-    int line_num = 0;
-    while (std::getline(in_file, line)) {
-      ++line_num;
-      str_trim(line);
-      if (line.length() > 0 && line[0] != '#') {
-
-        size_t pos = line.find_first_of("=");
-        if (pos == string::npos)
-          throw new domain_error("Invalid format in file '" + file + "' on line " + std::to_string(line_num));
-        string key = line.substr(0, pos);
-        str_trim(key);
-        if (key.length() == 0)
-          throw new domain_error("Missing property key in properties file '" + file + "'on line " + std::to_string(line_num));
-        string value = "";
-        if (line.length() > pos) {
-          // this makes sure we only try to get value if it exists
-          value = line.substr(pos + 1, line.length());
-        }
-        str_trim(value);
-        if (value.length() == 0)
-          throw new domain_error("Missing property value in properties file '" + file + "'on line " + std::to_string(line_num));
-
-        std::transform(key.begin(), key.end(), key.begin(), ::tolower);
-        map.insert(std::make_pair(key, value));
-      }
-    }
+    read(in_file, file);
     in_file.close();
   } else {
     throw new domain_error("Error opening properties file '" + file + "'");
   }
 }
 
+void Properties::read(std::istream& in, const std::string& source)
+{
+  std::string line;
+  int line_num = 0;
+  while (std::getline(in, line)) {
+    ++line_num;
+    str_trim(line);
+    if (line.length() > 0 && line[0] != '#') {
+
+      size_t pos = line.find_first_of("=");
+      if (pos == string::npos)
+        throw new domain_error("Invalid format in file '" + source + "' on line " + std::to_string(line_num));
+      string key = line.substr(0, pos);
+      str_trim(key);
+      if (key.length() == 0)
+        throw new domain_error("Missing property key in properties file '" + source + "'on line " + std::to_string(line_num));
+      string value = "";
+      if (line.length() > pos) {
+        // this makes sure we only try to get value if it exists
+        value = line.substr(pos + 1, line.length());
+      }
+      str_trim(value);
+      if (value.length() == 0)
+        throw new domain_error("Missing property value in properties file '" + source + "'on line " + std::to_string(line_num));
+
+      std::transform(key.begin(), key.end(), key.begin(), ::tolower);
+      map.insert(std::make_pair(key, value));
+    }
+  }
+}
+
 }
 
 }
@@ -78,6 +78,13 @@ public:
   */
   Properties(const std::string& buildingFile, const std::string& defaultFile);
 
+  /**
+   * Adds the properties read from a stream in the file format, e.g. an .ism
+   * file received over a socket. Properties already present keep their
+   * values. source names the stream in error messages.
+   */
+  void read(std::istream& in, const std::string& source);
+
   virtual ~Properties()
   {
   }
@@ -0,0 +1,217 @@
+#include "ResultCache.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <tuple>
+
+#include <boost/filesystem.hpp>
+
+namespace openstudio {
+namespace isomodel {
+
+namespace {
+
+const char entryMagic[8] = { 'I', 'S', 'O', 'R', 'E', 'S', '0', '1' };
+const std::string entryExtension = ".result";
+const int endUseCount = 13;
+// Temporary files older than this were left by a writer that died.
+const std::time_t abandonedSeconds = 3600;
+
+std::size_t entrySize(std::uint64_t results)
+{
+  return sizeof(entryMagic) + 3 * sizeof(std::uint64_t) + results * endUseCount * sizeof(double);
+}
+
+template<typename T>
+void append(std::string& buffer, const T& value)
+{
+  buffer.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+template<typename T>
+T extract(const std::string& buffer, std::size_t& offset)
+{
+  T value;
+  std::memcpy(&value, buffer.data() + offset, sizeof(value));
+  offset += sizeof(value);
+  return value;
+}
+
+void subtract(std::atomic<std::uint64_t>& bytes, std::uint64_t amount)
+{
+  auto current = bytes.load();
+  while (!bytes.compare_exchange_weak(current, current - std::min(current, amount))) {
+  }
+}
+
+} // namespace
+
+ResultCache::ResultCache(const std::string& directory, std::uint64_t maxBytes)
+  : m_directory(directory), m_maxBytes(maxBytes), m_bytes(0), m_hits(0), m_misses(0), m_evictions(0)
+{
+  boost::system::error_code error;
+  boost::filesystem::create_directories(directory, error);
+  if (!boost::filesystem::is_directory(directory)) {
+    throw std::runtime_error("Could not create the result cache " + directory);
+  }
+  std::uint64_t bytes = 0;
+  for (boost::filesystem::directory_iterator iter(directory), end; iter != end; ++iter) {
+    if (iter->path().extension() == entryExtension) {
+      bytes += boost::filesystem::file_size(iter->path(), error);
+    }
+  }
+  m_bytes = bytes;
+}
+
+std::string ResultCache::path(const ModelHash& key) const
+{
+  return (boost::filesystem::path(m_directory) / (key.toString() + entryExtension)).string();
+}
+
+bool ResultCache::get(const ModelHash& key, std::vector<EndUses>& results)
+{
+  auto entryPath = path(key);
+  std::string buffer;
+  {
+    std::ifstream in(entryPath, std::ios::binary);
+    if (!in) {
+      ++m_misses;
+      return false;
+    }
+    std::stringstream contents;
+    contents << in.rdbuf();
+    buffer = contents.str();
+  }
+
+  std::size_t offset = sizeof(entryMagic);
+  auto valid = buffer.size() >= entrySize(0) && std::memcmp(buffer.data(), entryMagic, sizeof(entryMagic)) == 0;
+  if (valid) {
+    ModelHash stored;
+    stored.high = extract<std::uint64_t>(buffer, offset);
+    stored.low = extract<std::uint64_t>(buffer, offset);
+    auto count = extract<std::uint64_t>(buffer, offset);
+    valid = stored == key && buffer.size() == entrySize(count);
+    if (valid) {
+      results.assign(count, EndUses());
+      for (auto& result : results) {
+        for (int i = 0; i < endUseCount; ++i) {
+#ifdef ISOMODEL_STANDALONE
+          result.addEndUse(i, extract<double>(buffer, offset));
+#else
+          result.addEndUse(extract<double>(buffer, offset), isoResultsEndUseTypes[i].first, isoResultsEndUseTypes[i].second);
+#endif
+        }
+      }
+    }
+  }
+  boost::system::error_code error;
+  if (!valid) {
+    if (boost::filesystem::remove(entryPath, error)) {
+      subtract(m_bytes, buffer.size());
+    }
+    ++m_misses;
+    return false;
+  }
+
+  boost::filesystem::last_write_time(entryPath, std::time(nullptr), error);
+  ++m_hits;
+  return true;
+}
+
+bool ResultCache::put(const ModelHash& key, std::vector<EndUses>& results)
+{
+  std::string buffer(entryMagic, sizeof(entryMagic));
+  append(buffer, key.high);
+  append(buffer, key.low);
+  append(buffer, static_cast<std::uint64_t>(results.size()));
+  for (auto& result : results) {
+    for (int i = 0; i < endUseCount; ++i) {
+#ifdef ISOMODEL_STANDALONE
+      append(buffer, result.getEndUse(i));
+#else
+      append(buffer, result.getEndUse(isoResultsEndUseTypes[i].first, isoResultsEndUseTypes[i].second));
+#endif
+    }
+  }
+
+  auto entryPath = path(key);
+  auto temporary = entryPath + boost::filesystem::unique_path(".tmp-%%%%-%%%%-%%%%").string();
+  {
+    std::ofstream out(temporary, std::ios::binary);
+    out.write(buffer.data(), buffer.size());
+    out.close();
+    if (!out) {
+      boost::system::error_code error;
+      boost::filesystem::remove(temporary, error);
+      return false;
+    }
+  }
+  // Overwriting an entry, say one another process wrote first, replaces its
+  // bytes rather than adding to them.
+  boost::system::error_code error;
+  auto replaced = boost::filesystem::file_size(entryPath, error);
+  if (error) {
+    replaced = 0;
+  }
+  boost::filesystem::rename(temporary, entryPath, error);
+  if (error) {
+    boost::filesystem::remove(temporary, error);
+    return false;
+  }
+
+  subtract(m_bytes, replaced);
+  if ((m_bytes += buffer.size()) > m_maxBytes) {
+    evict();
+  }
+  return true;
+}
+
+void ResultCache::evict()
+{
+  // One thread evicts at a time; the others carry on.
+  std::unique_lock<std::mutex> lock(m_evictMutex, std::try_to_lock);
+  if (!lock.owns_lock()) {
+    return;
+  }
+
+  boost::system::error_code error;
+  auto now = std::time(nullptr);
+  std::vector<std::tuple<std::time_t, std::uint64_t, boost::filesystem::path> > entries;
+  std::uint64_t bytes = 0;
+  for (boost::filesystem::directory_iterator iter(m_directory, error), end; !error && iter != end; iter.increment(error)) {
+    auto modified = boost::filesystem::last_write_time(iter->path(), error);
+    if (error) {
+      continue;
+    }
+    if (iter->path().extension() == entryExtension) {
+      auto size = boost::filesystem::file_size(iter->path(), error);
+      if (!error) {
+        entries.push_back(std::make_tuple(modified, size, iter->path()));
+        bytes += size;
+      }
+    } else if (iter->path().filename().string().find(".tmp-") != std::string::npos && now - modified > abandonedSeconds) {
+      boost::filesystem::remove(iter->path(), error);
+    }
+  }
+
+  std::sort(entries.begin(), entries.end());
+  auto target = m_maxBytes / 4 * 3;
+  for (const auto& entry : entries) {
+    if (bytes <= target) {
+      break;
+    }
+    // Another process may have removed it already.
+    if (boost::filesystem::remove(std::get<2>(entry), error)) {
+      ++m_evictions;
+    }
+    bytes -= std::get<1>(entry);
+  }
+  m_bytes = bytes;
+}
+
+} // isomodel
+} // openstudio
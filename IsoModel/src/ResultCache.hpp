@@ -0,0 +1,102 @@
+#ifndef ISOMODEL_RESULT_CACHE_HPP
+#define ISOMODEL_RESULT_CACHE_HPP
+
+#include "ISOModelAPI.hpp"
+#include "ModelHash.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#ifdef ISOMODEL_STANDALONE
+#include "EndUses.hpp"
+#else
+#include "../utilities/data/EndUses.hpp"
+#endif
+
+namespace openstudio {
+namespace isomodel {
+
+/**
+ * Simulation results stored on disk, keyed by UserModel::stateHash(), so a
+ * model simulated before, by this process or another, is answered without
+ * simulating it again. Each entry is a file in the cache directory named
+ * after its key, holding the key and the 13 end uses of each result. An
+ * entry is written to a temporary file and renamed into place, so a reader
+ * sees either all of it or none, and any number of threads and processes
+ * can share a directory.
+ *
+ * When the entries written by this process take the directory past maxBytes,
+ * the least recently used entries (a hit updates its file's modification
+ * time) are removed until the directory is back under three quarters of it.
+ * Other processes' entries are only counted when the directory is scanned,
+ * on construction and on eviction, so a directory shared by several
+ * processes can briefly go over the limit.
+ */
+class ISOMODEL_API ResultCache
+{
+public:
+  /**
+   * Opens the cache in directory, creating it if it doesn't exist. Throws
+   * std::runtime_error if it can't be created.
+   */
+  explicit ResultCache(const std::string& directory, std::uint64_t maxBytes = 256ull << 20);
+
+  ResultCache(const ResultCache&) = delete;
+  ResultCache& operator=(const ResultCache&) = delete;
+
+  /**
+   * Reads the results stored under key into results and returns true, or
+   * returns false if there are none. An unreadable or corrupt entry counts as
+   * a miss and is removed.
+   */
+  bool get(const ModelHash& key, std::vector<EndUses>& results);
+
+  /**
+   * Stores results under key, evicting entries if the cache is over its
+   * limit. Returns false, leaving the cache as it was, if the entry can't be
+   * written; a cache is an optimization, so that isn't an error.
+   */
+  bool put(const ModelHash& key, std::vector<EndUses>& results);
+
+  const std::string& directory() const {
+    return m_directory;
+  }
+
+  /** The bytes of entries in the directory, as far as this process knows. */
+  std::uint64_t bytes() const {
+    return m_bytes;
+  }
+
+  std::size_t hits() const {
+    return m_hits;
+  }
+
+  std::size_t misses() const {
+    return m_misses;
+  }
+
+  /** The entries this process has removed to stay under the limit. */
+  std::size_t evictions() const {
+    return m_evictions;
+  }
+
+private:
+  std::string path(const ModelHash& key) const;
+  void evict();
+
+  std::string m_directory;
+  std::uint64_t m_maxBytes;
+  std::atomic<std::uint64_t> m_bytes;
+  std::atomic<std::size_t> m_hits;
+  std::atomic<std::size_t> m_misses;
+  std::atomic<std::size_t> m_evictions;
+  std::mutex m_evictMutex;
+};
+
+} // isomodel
+} // openstudio
+#endif // ISOMODEL_RESULT_CACHE_HPP
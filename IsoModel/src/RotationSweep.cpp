@@ -0,0 +1,113 @@
+#include "RotationSweep.hpp"
+#include "UserModel.hpp"
+#include "WorkStealingPool.hpp"
+
+#include <functional>
+#include <iomanip>
+#include <numeric>
+#include <ostream>
+#include <stdexcept>
+
+namespace openstudio {
+namespace isomodel {
+
+RotationSweep::RotationSweep(const std::string& ismPath, const std::string& defaultsPath, double binDegrees)
+{
+  auto model = std::make_shared<UserModel>();
+  if (defaultsPath.empty()) {
+    model->load(ismPath);
+  } else {
+    model->load(ismPath, defaultsPath);
+  }
+  if (!model->valid()) {
+    throw std::runtime_error("Invalid model");
+  }
+  m_irradiance = std::make_shared<IrradianceCache>(*model->epwData(), binDegrees);
+  m_model = model;
+}
+
+std::vector<EndUses> RotationSweep::simulate(double rotation, bool hourly) const
+{
+  if (hourly) {
+    auto model = m_model->toHourlyModel();
+    model.setWallIrradiance(std::make_shared<const std::vector<std::vector<double> > >(m_irradiance->hourly(rotation)));
+    return model.simulate(true);
+  }
+
+  // The base building's weather may be shared, so rotate a copy of it.
+  auto umodel = *m_model;
+  auto weather = std::make_shared<WeatherData>(*umodel.weatherData());
+  weather->setMsolar(m_irradiance->monthly(rotation));
+  umodel.setWeatherData(weather);
+  return umodel.toMonthlyModel().simulate();
+}
+
+std::vector<double> RotationSweep::evaluate(double rotation, bool hourly) const
+{
+  auto results = simulate(rotation, hourly);
+  std::vector<double> totals(13, 0.0);
+  for (auto& month : results) {
+    for (int i = 0; i < 13; ++i) {
+#ifdef ISOMODEL_STANDALONE
+      totals[i] += month.getEndUse(i);
+#else
+      totals[i] += month.getEndUse(isoResultsEndUseTypes[i].first, isoResultsEndUseTypes[i].second);
+#endif
+    }
+  }
+  return totals;
+}
+
+std::vector<RotationResult> RotationSweep::run(const std::vector<double>& rotations, bool hourly, std::size_t threads) const
+{
+  std::vector<RotationResult> results(rotations.size());
+  std::vector<std::function<void()> > tasks;
+  for (std::size_t i = 0; i < rotations.size(); ++i) {
+    tasks.push_back([&, i]() {
+      results[i].rotation = rotations[i];
+      try {
+        results[i].endUses = evaluate(rotations[i], hourly);
+      } catch (const std::exception& e) {
+        results[i].error = e.what();
+      }
+    });
+  }
+
+  WorkStealingPool pool(threads);
+  pool.run(tasks);
+  return results;
+}
+
+void RotationSweep::run(const std::vector<double>& rotations, bool hourly, std::size_t threads, std::ostream& out) const
+{
+  out << "Rotation,ElecHeat,ElecCool,ElecIntLights,ElecExtLights,ElecFans,ElecPump,ElecEquipInt,ElecEquipExt,ElectDHW,GasHeat,GasCool,GasEquip,GasDHW,Total,Error\n"
+      << std::setprecision(10);
+  for (const auto& result : run(rotations, hourly, threads)) {
+    out << result.rotation;
+    if (result.error.empty()) {
+      for (auto endUse : result.endUses) {
+        out << "," << endUse;
+      }
+      out << "," << std::accumulate(result.endUses.begin(), result.endUses.end(), 0.0) << ",";
+    } else {
+      out << std::string(14, ',') << ",\"" << result.error << "\"";
+    }
+    out << "\n";
+  }
+  out.flush();
+}
+
+std::vector<double> RotationSweep::rotations(double step)
+{
+  if (!(step > 0)) {
+    throw std::invalid_argument("The rotation step must be positive");
+  }
+  std::vector<double> result;
+  for (std::size_t k = 0; k * step < 360.0 - 1e-9; ++k) {
+    result.push_back(k * step);
+  }
+  return result;
+}
+
+} // isomodel
+} // openstudio
@@ -0,0 +1,74 @@
+#ifndef ISOMODEL_ROTATION_SWEEP_HPP
+#define ISOMODEL_ROTATION_SWEEP_HPP
+
+#include "ISOModelAPI.hpp"
+#include "IrradianceCache.hpp"
+
+#include <cstddef>
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <vector>
+
+#ifdef ISOMODEL_STANDALONE
+#include "EndUses.hpp"
+#else
+#include "../utilities/data/EndUses.hpp"
+#endif
+
+namespace openstudio {
+namespace isomodel {
+
+class UserModel;
+
+// The building at one orientation of a rotation sweep.
+struct RotationResult
+{
+  double rotation = 0; // Degrees clockwise.
+  std::vector<double> endUses; // Annual totals of the 13 end uses (kWh/m2), empty if the run failed.
+  std::string error; // Why the run failed, if it did.
+};
+
+/**
+ * Runs a building turned to different orientations. The irradiance on the
+ * walls at every orientation is interpolated from an IrradianceCache
+ * computed once from the building's weather file, so a study of hundreds of
+ * orientations does one solar calculation rather than one per orientation.
+ * Rotations are in degrees, clockwise seen from above (see IrradianceCache).
+ * The monthly model's solar radiation is replaced by the rotated monthly
+ * means and the hourly model's by the rotated hourly values; the roof is
+ * unaffected.
+ */
+class ISOMODEL_API RotationSweep
+{
+public:
+  /** Loads the building and computes its irradiance cache with bins binDegrees apart. */
+  explicit RotationSweep(const std::string& ismPath, const std::string& defaultsPath = std::string(), double binDegrees = 5.0);
+
+  const IrradianceCache& irradiance() const {
+    return *m_irradiance;
+  }
+
+  /** Runs the building rotated by rotation degrees and returns its monthly results. Safe to call from several threads. */
+  std::vector<EndUses> simulate(double rotation, bool hourly) const;
+
+  /** Runs the building rotated by rotation degrees and returns the annual totals of the 13 end uses. */
+  std::vector<double> evaluate(double rotation, bool hourly) const;
+
+  /** Runs every rotation in parallel on threads workers (0 for one per hardware thread), returning the results in order. */
+  std::vector<RotationResult> run(const std::vector<double>& rotations, bool hourly, std::size_t threads = 0) const;
+
+  /** Runs every rotation and writes a CSV row of its end uses and their total, or its error. */
+  void run(const std::vector<double>& rotations, bool hourly, std::size_t threads, std::ostream& out) const;
+
+  /** Returns the rotations 0, step, 2 step, ... below 360. */
+  static std::vector<double> rotations(double step);
+
+private:
+  std::shared_ptr<const UserModel> m_model;
+  std::shared_ptr<const IrradianceCache> m_irradiance;
+};
+
+} // isomodel
+} // openstudio
+#endif // ISOMODEL_ROTATION_SWEEP_HPP
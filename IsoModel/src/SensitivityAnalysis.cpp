@@ -0,0 +1,298 @@
+#include "SensitivityAnalysis.hpp"
+#include "CounterRng.hpp"
+#include "WorkStealingPool.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <numeric>
+#include <ostream>
+#include <stdexcept>
+
+namespace openstudio {
+namespace isomodel {
+
+namespace {
+
+const char* const outputNames[] = { "ElecHeat", "ElecCool", "ElecIntLights", "ElecExtLights", "ElecFans", "ElecPump", "ElecEquipInt",
+                                    "ElecEquipExt", "ElectDHW", "GasHeat", "GasCool", "GasEquip", "GasDHW", "Total" };
+
+const std::size_t outputCount = 14;
+
+// Inverts the Poisson(1) CDF.
+int poissonWeight(double u)
+{
+  auto probability = std::exp(-1.0);
+  auto cumulative = probability;
+  int k = 0;
+  while (u > cumulative && k < 20) {
+    ++k;
+    probability /= k;
+    cumulative += probability;
+  }
+  return k;
+}
+
+// The value below which the given fraction of the sorted values lie.
+double percentile(const std::vector<double>& sorted, double fraction)
+{
+  auto position = fraction * (sorted.size() - 1);
+  auto below = static_cast<std::size_t>(position);
+  if (below + 1 >= sorted.size()) {
+    return sorted.back();
+  }
+  return sorted[below] + (position - below) * (sorted[below + 1] - sorted[below]);
+}
+
+} // namespace
+
+SensitivitySpec SensitivitySpec::read(const std::string& path)
+{
+  try {
+    return read(Properties(path));
+  } catch (std::domain_error* e) {
+    // Properties throws pointers.
+    std::string message = e->what();
+    delete e;
+    throw std::invalid_argument(message);
+  }
+}
+
+SensitivitySpec SensitivitySpec::read(const Properties& props)
+{
+  SensitivitySpec spec;
+  Properties sampling;
+  for (auto key = props.keys_begin(); key != props.keys_end(); ++key) {
+    if (*key == "bootstrap") {
+      auto value = props.getPropertyAsInt(*key);
+      if (!value || *value < 0) {
+        throw std::invalid_argument("Sensitivity bootstrap must be a non-negative integer");
+      }
+      spec.bootstrap = static_cast<std::size_t>(*value);
+    } else if (*key == "confidence") {
+      auto value = props.getPropertyAsDouble(*key);
+      if (!value || !(*value > 0.0 && *value < 1.0)) {
+        throw std::invalid_argument("Sensitivity confidence must be between 0 and 1");
+      }
+      spec.confidence = *value;
+    } else {
+      sampling.putProperty(*key, *props.getProperty(*key));
+    }
+  }
+  spec.sampling = MonteCarloSpec::read(sampling);
+  return spec;
+}
+
+SobolEstimator::SobolEstimator(std::size_t parameters, std::size_t outputs, std::size_t bootstrap, std::uint64_t seed) :
+    m_parameters(parameters), m_outputs(outputs), m_bootstrap(bootstrap), m_seed(seed), m_shift(outputs, 0.0)
+{
+  Sums empty;
+  empty.firstOrder.assign(parameters, 0.0);
+  empty.total.assign(parameters, 0.0);
+  m_sums.assign((bootstrap + 1) * outputs, empty);
+}
+
+void SobolEstimator::add(const std::vector<double>& a, const std::vector<double>& b, const std::vector<std::vector<double> >& ab)
+{
+  if (a.size() != m_outputs || b.size() != m_outputs || ab.size() != m_parameters) {
+    throw std::invalid_argument("SobolEstimator::add expects one output vector per matrix and parameter");
+  }
+  if (m_rows == 0) {
+    // Shifting the outputs by a typical value keeps the sums of squares from
+    // cancelling when the mean is large compared to the spread.
+    for (std::size_t o = 0; o < m_outputs; ++o) {
+      m_shift[o] = (a[o] + b[o]) / 2;
+    }
+  }
+
+  CounterRng rng(m_seed);
+  for (std::size_t r = 0; r <= m_bootstrap; ++r) {
+    double weight = r == 0 ? 1.0 : poissonWeight(rng.uniform(m_rows, r - 1));
+    if (weight == 0.0) {
+      continue;
+    }
+    for (std::size_t o = 0; o < m_outputs; ++o) {
+      auto& s = sums(r, o);
+      auto ya = a[o] - m_shift[o];
+      auto yb = b[o] - m_shift[o];
+      s.weight += weight;
+      s.y += weight * (ya + yb);
+      s.y2 += weight * (ya * ya + yb * yb);
+      for (std::size_t i = 0; i < m_parameters; ++i) {
+        auto difference = ab[i][o] - a[o];
+        s.firstOrder[i] += weight * yb * difference;
+        s.total[i] += weight * difference * difference;
+      }
+    }
+  }
+  ++m_rows;
+}
+
+double SobolEstimator::mean(std::size_t output) const
+{
+  const auto& s = sums(0, output);
+  return s.weight > 0 ? s.y / (2 * s.weight) + m_shift[output] : 0.0;
+}
+
+double SobolEstimator::variance(std::size_t output) const
+{
+  const auto& s = sums(0, output);
+  if (s.weight == 0) {
+    return 0.0;
+  }
+  auto mean = s.y / (2 * s.weight);
+  return std::max(0.0, s.y2 / (2 * s.weight) - mean * mean);
+}
+
+void SobolEstimator::estimate(const Sums& s, std::size_t parameter, double& firstOrder, double& total) const
+{
+  firstOrder = total = 0.0;
+  if (s.weight == 0) {
+    return;
+  }
+  auto mean = s.y / (2 * s.weight);
+  auto variance = s.y2 / (2 * s.weight) - mean * mean;
+  if (variance <= 0) {
+    return;
+  }
+  firstOrder = s.firstOrder[parameter] / s.weight / variance;
+  total = s.total[parameter] / (2 * s.weight) / variance;
+}
+
+SobolIndex SobolEstimator::index(std::size_t output, std::size_t parameter, double confidence) const
+{
+  SobolIndex index;
+  estimate(sums(0, output), parameter, index.firstOrder, index.total);
+  index.firstOrderLow = index.firstOrderHigh = index.firstOrder;
+  index.totalLow = index.totalHigh = index.total;
+  if (m_bootstrap == 0) {
+    return index;
+  }
+
+  std::vector<double> firstOrders(m_bootstrap), totals(m_bootstrap);
+  for (std::size_t r = 0; r < m_bootstrap; ++r) {
+    estimate(sums(r + 1, output), parameter, firstOrders[r], totals[r]);
+  }
+  std::sort(firstOrders.begin(), firstOrders.end());
+  std::sort(totals.begin(), totals.end());
+  auto tail = (1.0 - confidence) / 2;
+  index.firstOrderLow = percentile(firstOrders, tail);
+  index.firstOrderHigh = percentile(firstOrders, 1.0 - tail);
+  index.totalLow = percentile(totals, tail);
+  index.totalHigh = percentile(totals, 1.0 - tail);
+  return index;
+}
+
+void SensitivityResults::write(std::ostream& out) const
+{
+  out << "Output,Parameter,Mean,Variance,S1,S1Low,S1High,ST,STLow,STHigh\n" << std::setprecision(10);
+  for (std::size_t o = 0; o < outputs.size(); ++o) {
+    for (std::size_t i = 0; i < parameters.size(); ++i) {
+      const auto& index = indices[o][i];
+      out << outputs[o] << "," << parameters[i] << "," << means[o] << "," << variances[o] << "," << index.firstOrder << ","
+          << index.firstOrderLow << "," << index.firstOrderHigh << "," << index.total << "," << index.totalLow << ","
+          << index.totalHigh << "\n";
+    }
+  }
+  out.flush();
+}
+
+SensitivityAnalysis::SensitivityAnalysis(const std::string& baseIsmPath, const std::string& defaultsPath) :
+    m_sweep(baseIsmPath, defaultsPath)
+{
+}
+
+SensitivityResults SensitivityAnalysis::run(const SensitivitySpec& spec) const
+{
+  const auto& sampling = spec.sampling;
+  auto k = sampling.parameters.size();
+  if (k == 0) {
+    throw std::invalid_argument("A sensitivity analysis needs at least one uncertain property");
+  }
+  if (sampling.chunk == 0) {
+    throw std::invalid_argument("Sensitivity chunk must be positive");
+  }
+
+  SensitivityResults results;
+  for (const auto& parameter : sampling.parameters) {
+    results.parameters.push_back(parameter.property);
+  }
+  results.outputs.assign(outputNames, outputNames + outputCount);
+
+  auto annual = [&](const std::vector<double>& values) {
+    auto totals = m_sweep.evaluate(results.parameters, values, sampling.hourly, &sampling.cancellation);
+    totals.push_back(std::accumulate(totals.begin(), totals.end(), 0.0));
+    return totals;
+  };
+
+  // The bootstrap weights use a different key from the samples.
+  SobolEstimator estimator(k, outputCount, spec.bootstrap, ~sampling.seed);
+  WorkStealingPool pool(sampling.threads);
+
+  // The outputs of each row of the chunk: A, B, then AB_1..AB_k. Empty if
+  // any of the row's simulations failed.
+  std::vector<std::vector<std::vector<double> > > rows;
+  std::vector<std::string> errors;
+  std::vector<char> cancelled;
+  for (std::size_t first = 0; first < sampling.samples && !results.cancelled; first += sampling.chunk) {
+    auto size = std::min(sampling.chunk, sampling.samples - first);
+    rows.assign(size, std::vector<std::vector<double> >());
+    errors.assign(size, std::string());
+    cancelled.assign(size, false);
+
+    std::vector<std::function<void()> > tasks;
+    for (std::size_t j = 0; j < size; ++j) {
+      tasks.push_back([&, j]() {
+        // Rows of A and B are independent samples.
+        auto a = sampling.sample(2 * (first + j));
+        auto b = sampling.sample(2 * (first + j) + 1);
+        try {
+          std::vector<std::vector<double> > outputs;
+          outputs.push_back(annual(a));
+          outputs.push_back(annual(b));
+          for (std::size_t i = 0; i < k; ++i) {
+            auto ab = a;
+            ab[i] = b[i];
+            outputs.push_back(annual(ab));
+          }
+          rows[j] = std::move(outputs);
+        } catch (const SimulationCancelled&) {
+          cancelled[j] = true;
+        } catch (const std::exception& e) {
+          errors[j] = e.what();
+        }
+      });
+    }
+    pool.run(tasks);
+    results.cancelled = sampling.cancellation.cancelled();
+
+    for (std::size_t j = 0; j < size; ++j) {
+      if (cancelled[j]) {
+        continue;
+      }
+      if (rows[j].empty()) {
+        if (results.failures++ == 0) {
+          results.firstError = errors[j];
+        }
+        continue;
+      }
+      std::vector<std::vector<double> > ab(rows[j].begin() + 2, rows[j].end());
+      estimator.add(rows[j][0], rows[j][1], ab);
+    }
+  }
+
+  results.rows = estimator.rows();
+  for (std::size_t o = 0; o < outputCount; ++o) {
+    results.means.push_back(estimator.mean(o));
+    results.variances.push_back(estimator.variance(o));
+    std::vector<SobolIndex> indices;
+    for (std::size_t i = 0; i < k; ++i) {
+      indices.push_back(estimator.index(o, i, spec.confidence));
+    }
+    results.indices.push_back(indices);
+  }
+  return results;
+}
+
+} // isomodel
+} // openstudio
@@ -0,0 +1,158 @@
+#ifndef ISOMODEL_SENSITIVITY_ANALYSIS_HPP
+#define ISOMODEL_SENSITIVITY_ANALYSIS_HPP
+
+#include "ISOModelAPI.hpp"
+#include "MonteCarlo.hpp"
+#include "ParametricSweep.hpp"
+#include "Properties.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace openstudio {
+namespace isomodel {
+
+/**
+ * What a sensitivity analysis varies and how. Read from a file in the
+ * MonteCarloSpec format: the uncertain properties and their distributions,
+ * and the keys samples (the base sample size N), seed, engine, threads and
+ * chunk (rows of the sample matrices evaluated at a time). Two more keys
+ * configure the confidence intervals: bootstrap (the number of resamples,
+ * 100 by default) and confidence (0.95 by default). The analysis runs
+ * N * (k + 2) simulations for k properties.
+ */
+struct ISOMODEL_API SensitivitySpec
+{
+  MonteCarloSpec sampling;
+  std::size_t bootstrap = 100;
+  double confidence = 0.95;
+
+  /** Reads a spec from a file. Throws std::invalid_argument if it is malformed. */
+  static SensitivitySpec read(const std::string& path);
+
+  /** Reads a spec from parsed properties. Throws std::invalid_argument if it is malformed. */
+  static SensitivitySpec read(const Properties& props);
+};
+
+// The Sobol indices of one parameter for one output, with the bounds of
+// their bootstrap confidence intervals.
+struct SobolIndex
+{
+  double firstOrder = 0;
+  double firstOrderLow = 0;
+  double firstOrderHigh = 0;
+  double total = 0;
+  double totalLow = 0;
+  double totalHigh = 0;
+};
+
+/**
+ * Estimates first-order and total Sobol indices from the rows of Saltelli's
+ * sample matrices as they are evaluated: the first-order index with
+ * Saltelli's (2010) estimator and the total index with Jansen's. Only running
+ * sums are kept, so memory does not grow with the number of rows. The
+ * confidence intervals come from a Poisson bootstrap: each row is given a
+ * Poisson(1) weight in each resample, drawn from a counter-based stream, so
+ * the resamples are also updated row by row.
+ */
+class ISOMODEL_API SobolEstimator
+{
+public:
+  SobolEstimator(std::size_t parameters, std::size_t outputs, std::size_t bootstrap, std::uint64_t seed);
+
+  /**
+   * Adds one row: the outputs for row j of matrix A, of matrix B, and for
+   * each parameter i the outputs for row j of A with column i taken from B.
+   */
+  void add(const std::vector<double>& a, const std::vector<double>& b, const std::vector<std::vector<double> >& ab);
+
+  std::size_t rows() const {
+    return m_rows;
+  }
+  double mean(std::size_t output) const;
+  double variance(std::size_t output) const;
+
+  /**
+   * The indices of parameter for output, with intervals holding the given
+   * fraction of the bootstrap estimates. Outputs that do not vary have
+   * indices of 0.
+   */
+  SobolIndex index(std::size_t output, std::size_t parameter, double confidence) const;
+
+private:
+  // Weighted sums of one resample (the first is the unweighted sample) for
+  // one output, of values shifted by the first row's mean.
+  struct Sums
+  {
+    double weight = 0;
+    double y = 0;
+    double y2 = 0;
+    std::vector<double> firstOrder;
+    std::vector<double> total;
+  };
+
+  Sums& sums(std::size_t resample, std::size_t output) {
+    return m_sums[resample * m_outputs + output];
+  }
+  const Sums& sums(std::size_t resample, std::size_t output) const {
+    return m_sums[resample * m_outputs + output];
+  }
+  void estimate(const Sums& sums, std::size_t parameter, double& firstOrder, double& total) const;
+
+  std::size_t m_parameters;
+  std::size_t m_outputs;
+  std::size_t m_bootstrap;
+  std::uint64_t m_seed;
+  std::size_t m_rows = 0;
+  std::vector<double> m_shift;
+  std::vector<Sums> m_sums;
+};
+
+// The result of a sensitivity analysis of the annual end uses.
+struct ISOMODEL_API SensitivityResults
+{
+  std::vector<std::string> parameters;
+  std::vector<std::string> outputs; // The 13 end uses, then their total.
+  std::vector<std::vector<SobolIndex> > indices; // By output, then parameter.
+  std::vector<double> means;
+  std::vector<double> variances;
+  std::size_t rows = 0; // Rows of the sample matrices that ran.
+  std::size_t failures = 0; // Rows skipped because a simulation failed.
+  std::string firstError;
+  bool cancelled = false; // The run was cancelled, so the indices cover only the rows that finished first.
+
+  /** Writes a CSV row per output and parameter with the indices and their intervals. */
+  void write(std::ostream& out) const;
+};
+
+/**
+ * Global sensitivity analysis of a building's annual energy use to its
+ * properties. Builds Saltelli's A, B and AB_i sample matrices from the spec's
+ * distributions and evaluates them as variants of the base building (see
+ * ParametricSweep), a chunk of rows at a time. Each row's k + 2 simulations
+ * run as one task on a WorkStealingPool, and the rows are added to a
+ * SobolEstimator in order, so a seed gives the same indices for any number
+ * of threads.
+ */
+class ISOMODEL_API SensitivityAnalysis
+{
+public:
+  explicit SensitivityAnalysis(const std::string& baseIsmPath, const std::string& defaultsPath = std::string());
+
+  /**
+   * Runs the analysis. A row whose simulations fail is counted and skipped.
+   * If spec.sampling.cancellation is cancelled, the run stops and the indices
+   * are estimated from the rows that finished.
+   */
+  SensitivityResults run(const SensitivitySpec& spec) const;
+
+private:
+  ParametricSweep m_sweep;
+};
+
+} // isomodel
+} // openstudio
+#endif // ISOMODEL_SENSITIVITY_ANALYSIS_HPP
@@ -0,0 +1,648 @@
+#include "ShardedBatchRunner.hpp"
+#include "EpwData.hpp"
+#include "Properties.hpp"
+#include "UserModel.hpp"
+#include "WeatherData.hpp"
+#include "WorkStealingPool.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+#include <boost/filesystem.hpp>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <fcntl.h>
+#include <spawn.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char** environ;
+#endif
+
+namespace openstudio {
+namespace isomodel {
+
+ShardedBatchRunner::ShardedBatchRunner(ShardedBatchSettings settings) : m_settings(settings)
+{
+  if (m_settings.workers == 0) {
+    m_settings.workers = 1;
+  }
+  if (m_settings.range == 0) {
+    m_settings.range = 1;
+  }
+  if (m_settings.threads == 0) {
+    m_settings.threads = std::max<std::size_t>(1, std::thread::hardware_concurrency() / m_settings.workers);
+  }
+}
+
+#ifndef _WIN32
+
+namespace {
+
+const char segmentMagic[8] = { 'I', 'S', 'O', 'B', 'A', 'T', 'C', '1' };
+
+const int hours = 8760;
+// The layout EpwData::loadData() reads: latitude, longitude, time zone, then
+// the 7 hourly columns.
+const std::size_t epwDoubles = 3 + 7 * hours;
+// WeatherData's msolar (12 x 8), mhdbt and mhEgh (12 x 24), and mEgh, mdbt
+// and mwind (12).
+const std::size_t summaryDoubles = 12 * 8 + 2 * 12 * 24 + 3 * 12;
+
+// The start of the read-only segment. Strings are stored as an offset and a
+// length; weather arrays as the offset of their first double.
+struct SegmentHeader
+{
+  char magic[8];
+  std::uint64_t size;
+  std::uint64_t jobCount;
+  std::uint64_t weatherCount;
+  std::uint64_t range;
+  std::uint64_t threads;
+};
+
+struct JobRecord
+{
+  std::uint64_t ismPath, ismPathLength;
+  std::uint64_t defaultsPath, defaultsPathLength;
+  std::uint64_t hourly;
+};
+
+struct WeatherRecord
+{
+  std::uint64_t path, pathLength; // The WeatherCache key.
+  std::uint64_t epw;
+  std::uint64_t summary;
+};
+
+// The writable segment is just the index of the next job to hand out.
+typedef std::atomic<std::uint64_t> QueueCounter;
+
+// A mapped POSIX shared memory object, unlinked by the process that created it.
+class SharedMemory
+{
+public:
+  // Creates a zero-filled segment of the given size.
+  SharedMemory(const std::string& name, std::size_t size) : m_name(name), m_size(size), m_owner(true)
+  {
+    int fd = ::shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0) {
+      fail("create");
+    }
+    if (::ftruncate(fd, static_cast<off_t>(size)) != 0) {
+      int error = errno;
+      ::close(fd);
+      ::shm_unlink(name.c_str());
+      errno = error;
+      fail("size");
+    }
+    map(fd, PROT_READ | PROT_WRITE);
+  }
+
+  // Maps an existing segment.
+  SharedMemory(const std::string& name, bool writable) : m_name(name), m_size(0), m_owner(false)
+  {
+    int fd = ::shm_open(name.c_str(), writable ? O_RDWR : O_RDONLY, 0);
+    if (fd < 0) {
+      fail("open");
+    }
+    struct stat info;
+    if (::fstat(fd, &info) != 0 || info.st_size == 0) {
+      ::close(fd);
+      fail("open");
+    }
+    m_size = static_cast<std::size_t>(info.st_size);
+    map(fd, writable ? PROT_READ | PROT_WRITE : PROT_READ);
+  }
+
+  ~SharedMemory()
+  {
+    ::munmap(m_data, m_size);
+    if (m_owner) {
+      ::shm_unlink(m_name.c_str());
+    }
+  }
+
+  SharedMemory(const SharedMemory&) = delete;
+  SharedMemory& operator=(const SharedMemory&) = delete;
+
+  char* data() const {
+    return m_data;
+  }
+
+  std::size_t size() const {
+    return m_size;
+  }
+
+  const std::string& name() const {
+    return m_name;
+  }
+
+private:
+  void map(int fd, int protection)
+  {
+    void* data = ::mmap(nullptr, m_size, protection, MAP_SHARED, fd, 0);
+    int error = errno;
+    ::close(fd);
+    if (data == MAP_FAILED) {
+      if (m_owner) {
+        ::shm_unlink(m_name.c_str());
+      }
+      errno = error;
+      fail("map");
+    }
+    m_data = static_cast<char*>(data);
+  }
+
+  void fail(const std::string& action) const
+  {
+    throw std::runtime_error("Could not " + action + " shared memory " + m_name + ": " + std::strerror(errno));
+  }
+
+  std::string m_name;
+  std::size_t m_size;
+  bool m_owner;
+  char* m_data = nullptr;
+};
+
+// Bounds-checked reads from a mapped segment.
+class SegmentReader
+{
+public:
+  explicit SegmentReader(const SharedMemory& memory) : m_memory(memory)
+  {
+  }
+
+  const char* at(std::uint64_t offset, std::uint64_t length) const
+  {
+    if (offset > m_memory.size() || length > m_memory.size() - offset) {
+      throw std::runtime_error("Shared memory " + m_memory.name() + " is corrupt");
+    }
+    return m_memory.data() + offset;
+  }
+
+  std::string string(std::uint64_t offset, std::uint64_t length) const
+  {
+    return std::string(at(offset, length), length);
+  }
+
+  const double* doubles(std::uint64_t offset, std::size_t count) const
+  {
+    return reinterpret_cast<const double*>(at(offset, count * sizeof(double)));
+  }
+
+private:
+  const SharedMemory& m_memory;
+};
+
+void writeMatrix(const Matrix& matrix, double*& out)
+{
+  for (std::size_t i = 0; i < matrix.size1(); ++i) {
+    for (std::size_t j = 0; j < matrix.size2(); ++j) {
+      *out++ = matrix(i, j);
+    }
+  }
+}
+
+void writeVector(const Vector& vector, double*& out)
+{
+  for (std::size_t i = 0; i < vector.size(); ++i) {
+    *out++ = vector(i);
+  }
+}
+
+Matrix readMatrix(std::size_t rows, std::size_t columns, const double*& in)
+{
+  Matrix matrix(rows, columns);
+  for (std::size_t i = 0; i < rows; ++i) {
+    for (std::size_t j = 0; j < columns; ++j) {
+      matrix(i, j) = *in++;
+    }
+  }
+  return matrix;
+}
+
+Vector readVector(std::size_t size, const double*& in)
+{
+  Vector vector(size);
+  for (std::size_t i = 0; i < size; ++i) {
+    vector(i) = *in++;
+  }
+  return vector;
+}
+
+void writeWeather(const WeatherCache::Entry& entry, double* epw, double* summary)
+{
+  auto& epwData = *entry.epwData;
+  *epw++ = epwData.latitude();
+  *epw++ = epwData.longitude();
+  *epw++ = epwData.timezone();
+  auto columns = epwData.data();
+  for (int c = 0; c < 7; ++c) {
+    std::copy(columns[c].begin(), columns[c].begin() + hours, epw + c * hours);
+  }
+
+  auto& weather = *entry.weatherData;
+  writeMatrix(weather.msolar(), summary);
+  writeMatrix(weather.mhdbt(), summary);
+  writeMatrix(weather.mhEgh(), summary);
+  writeVector(weather.mEgh(), summary);
+  writeVector(weather.mdbt(), summary);
+  writeVector(weather.mwind(), summary);
+}
+
+WeatherCache::Entry readWeather(const double* epw, const double* summary)
+{
+  WeatherCache::Entry entry;
+  entry.epwData = std::make_shared<EpwData>();
+  entry.epwData->loadData(hours, epw);
+
+  entry.weatherData = std::make_shared<WeatherData>();
+  entry.weatherData->setMsolar(readMatrix(12, 8, summary));
+  entry.weatherData->setMhdbt(readMatrix(12, 24, summary));
+  entry.weatherData->setMhEgh(readMatrix(12, 24, summary));
+  entry.weatherData->setMEgh(readVector(12, summary));
+  entry.weatherData->setMdbt(readVector(12, summary));
+  entry.weatherData->setMwind(readVector(12, summary));
+  return entry;
+}
+
+// The WeatherCache key of a job's weather file, or "" if it can't be found,
+// in which case the worker reports why.
+std::string weatherFileFor(const BatchJob& job)
+{
+  if (!boost::filesystem::exists(job.ismPath) || (!job.defaultsPath.empty() && !boost::filesystem::exists(job.defaultsPath))) {
+    return "";
+  }
+  try {
+    auto props = job.defaultsPath.empty() ? Properties(job.ismPath) : Properties(job.ismPath, job.defaultsPath);
+    auto path = props.getProperty("weatherfilepath");
+    if (path) {
+      auto file = UserModel::resolveWeatherFile(job.ismPath, *path);
+      if (boost::filesystem::exists(file)) {
+        return boost::filesystem::absolute(file).string();
+      }
+    }
+  } catch (std::domain_error* e) {
+    // Properties throws pointers.
+    delete e;
+  } catch (const std::exception&) {
+  }
+  return "";
+}
+
+std::uint64_t aligned(std::uint64_t offset)
+{
+  return (offset + sizeof(double) - 1) / sizeof(double) * sizeof(double);
+}
+
+// Publishes the jobs and the weather in a new read-only segment.
+std::unique_ptr<SharedMemory> publish(const std::string& name, const std::vector<BatchJob>& jobs,
+                                      const std::map<std::string, WeatherCache::Entry>& weather,
+                                      std::size_t range, std::size_t threads)
+{
+  std::uint64_t jobsOffset = sizeof(SegmentHeader);
+  std::uint64_t weatherOffset = jobsOffset + jobs.size() * sizeof(JobRecord);
+  std::uint64_t arraysOffset = aligned(weatherOffset + weather.size() * sizeof(WeatherRecord));
+  std::uint64_t stringsOffset = arraysOffset + weather.size() * (epwDoubles + summaryDoubles) * sizeof(double);
+  std::uint64_t size = stringsOffset;
+  for (const auto& job : jobs) {
+    size += job.ismPath.size() + job.defaultsPath.size();
+  }
+  for (const auto& file : weather) {
+    size += file.first.size();
+  }
+
+  std::unique_ptr<SharedMemory> memory(new SharedMemory(name, size));
+  char* base = memory->data();
+  auto strings = stringsOffset;
+  auto putString = [base, &strings](const std::string& value, std::uint64_t& offset, std::uint64_t& length) {
+    offset = strings;
+    length = value.size();
+    std::memcpy(base + strings, value.data(), value.size());
+    strings += value.size();
+  };
+
+  auto header = reinterpret_cast<SegmentHeader*>(base);
+  std::memcpy(header->magic, segmentMagic, sizeof(segmentMagic));
+  header->size = size;
+  header->jobCount = jobs.size();
+  header->weatherCount = weather.size();
+  header->range = range;
+  header->threads = threads;
+
+  auto jobRecords = reinterpret_cast<JobRecord*>(base + jobsOffset);
+  for (std::size_t i = 0; i < jobs.size(); ++i) {
+    putString(jobs[i].ismPath, jobRecords[i].ismPath, jobRecords[i].ismPathLength);
+    putString(jobs[i].defaultsPath, jobRecords[i].defaultsPath, jobRecords[i].defaultsPathLength);
+    jobRecords[i].hourly = jobs[i].hourly ? 1 : 0;
+  }
+
+  auto weatherRecords = reinterpret_cast<WeatherRecord*>(base + weatherOffset);
+  auto arrays = arraysOffset;
+  for (const auto& file : weather) {
+    putString(file.first, weatherRecords->path, weatherRecords->pathLength);
+    weatherRecords->epw = arrays;
+    weatherRecords->summary = arrays + epwDoubles * sizeof(double);
+    writeWeather(file.second, reinterpret_cast<double*>(base + weatherRecords->epw), reinterpret_cast<double*>(base + weatherRecords->summary));
+    arrays += (epwDoubles + summaryDoubles) * sizeof(double);
+    ++weatherRecords;
+  }
+  return memory;
+}
+
+std::string oneLine(std::string text)
+{
+  std::replace(text.begin(), text.end(), '\n', ' ');
+  std::replace(text.begin(), text.end(), '\t', ' ');
+  return text;
+}
+
+// A range of jobs in a shard: a header line "range first count bytes
+// failures", the rows, then one "path<tab>error" line per failure.
+struct ShardBlock
+{
+  std::size_t shard;
+  std::streamoff offset;
+  std::size_t bytes;
+  std::size_t count;
+  std::vector<std::pair<std::string, std::string> > failures;
+};
+
+// Reads the complete blocks of a shard, stopping at the first one a worker
+// didn't finish writing.
+void readShard(std::size_t shard, const std::string& path, std::map<std::size_t, ShardBlock>& blocks)
+{
+  boost::system::error_code error;
+  auto fileSize = boost::filesystem::file_size(path, error);
+  std::ifstream in(path, std::ios::binary);
+  if (error || !in) {
+    return;
+  }
+
+  std::string line;
+  while (std::getline(in, line) && !in.eof()) {
+    std::istringstream header(line);
+    std::string tag;
+    std::size_t first, failures;
+    ShardBlock block;
+    block.shard = shard;
+    if (!(header >> tag >> first >> block.count >> block.bytes >> failures) || tag != "range") {
+      return;
+    }
+    block.offset = in.tellg();
+    if (block.offset < 0 || static_cast<std::uintmax_t>(block.offset) + block.bytes > fileSize) {
+      return;
+    }
+    in.seekg(block.bytes, std::ios::cur);
+    for (std::size_t f = 0; f < failures; ++f) {
+      if (!std::getline(in, line) || in.eof()) {
+        return;
+      }
+      auto tab = line.find('\t');
+      block.failures.push_back(std::make_pair(line.substr(0, tab), tab == std::string::npos ? std::string() : line.substr(tab + 1)));
+    }
+    blocks[first] = block;
+  }
+}
+
+// Removes the shard files when the run ends, however it ends.
+struct ShardFiles
+{
+  std::vector<std::string> paths;
+
+  ~ShardFiles()
+  {
+    for (const auto& path : paths) {
+      boost::system::error_code error;
+      boost::filesystem::remove(path, error);
+    }
+  }
+};
+
+} // namespace
+
+BatchReport ShardedBatchRunner::run(const std::vector<BatchJob>& jobs, std::ostream& out)
+{
+  auto start = std::chrono::steady_clock::now();
+  if (m_settings.executable.empty()) {
+    throw std::invalid_argument("No worker executable");
+  }
+  QueueCounter lockFreeCheck(0);
+  if (!lockFreeCheck.is_lock_free()) {
+    throw std::runtime_error("Sharing a job queue between processes needs lock-free 64 bit atomics");
+  }
+
+  BatchReport report;
+  if (jobs.empty()) {
+    return report;
+  }
+
+  // Find and parse the weather files, each once, on this process's threads.
+  std::vector<std::string> weatherPaths(jobs.size());
+  std::vector<std::function<void()> > tasks;
+  for (std::size_t i = 0; i < jobs.size(); ++i) {
+    tasks.push_back([&jobs, &weatherPaths, i]() { weatherPaths[i] = weatherFileFor(jobs[i]); });
+  }
+  WorkStealingPool pool;
+  pool.run(tasks);
+
+  std::map<std::string, WeatherCache::Entry> weather;
+  for (const auto& path : weatherPaths) {
+    if (!path.empty()) {
+      weather[path];
+    }
+  }
+  tasks.clear();
+  for (auto& file : weather) {
+    auto entry = &file;
+    tasks.push_back([entry]() {
+      try {
+        entry->second = UserModel::loadWeatherFile(entry->first);
+      } catch (const std::exception&) {
+        // Left to the worker to report.
+      }
+    });
+  }
+  pool.run(tasks);
+  for (auto iter = weather.begin(); iter != weather.end();) {
+    iter = iter->second.epwData ? std::next(iter) : weather.erase(iter);
+  }
+
+  static std::atomic<unsigned> runs(0);
+  auto name = "/isomodel." + std::to_string(::getpid()) + "." + std::to_string(runs++);
+  auto segment = publish(name, jobs, weather, m_settings.range, m_settings.threads);
+  SharedMemory queue(name + ".queue", sizeof(QueueCounter));
+  new (queue.data()) QueueCounter(0);
+
+  auto directory = m_settings.shardDirectory.empty() ? boost::filesystem::temp_directory_path() : boost::filesystem::path(m_settings.shardDirectory);
+  ShardFiles shards;
+  std::vector<pid_t> workers;
+  std::vector<std::string> problems;
+  for (std::size_t w = 0; w < m_settings.workers; ++w) {
+    shards.paths.push_back((directory / (name.substr(1) + ".shard" + std::to_string(w) + ".csv")).string());
+    std::vector<std::string> args = { m_settings.executable, "--worker", name, "--output", shards.paths.back() };
+    std::vector<char*> argv;
+    for (auto& arg : args) {
+      argv.push_back(&arg[0]);
+    }
+    argv.push_back(nullptr);
+
+    pid_t pid = -1;
+    int error = ::posix_spawnp(&pid, m_settings.executable.c_str(), nullptr, nullptr, argv.data(), environ);
+    if (error != 0) {
+      problems.push_back("worker " + std::to_string(w) + " could not start: " + std::strerror(error));
+      pid = -1;
+    }
+    workers.push_back(pid);
+  }
+
+  for (std::size_t w = 0; w < workers.size(); ++w) {
+    int status = 0;
+    if (workers[w] < 0) {
+      continue;
+    }
+    while (::waitpid(workers[w], &status, 0) < 0 && errno == EINTR) {
+    }
+    if (WIFEXITED(status) && WEXITSTATUS(status) != 0) {
+      problems.push_back("worker " + std::to_string(w) + " exited with status " + std::to_string(WEXITSTATUS(status)));
+    } else if (WIFSIGNALED(status)) {
+      problems.push_back("worker " + std::to_string(w) + " was killed by signal " + std::to_string(WTERMSIG(status)));
+    }
+  }
+
+  // Merge the shards in job order.
+  std::map<std::size_t, ShardBlock> blocks;
+  for (std::size_t s = 0; s < shards.paths.size(); ++s) {
+    readShard(s, shards.paths[s], blocks);
+  }
+  std::string lost = "No results";
+  for (std::size_t p = 0; p < problems.size(); ++p) {
+    lost += (p == 0 ? ": " : "; ") + problems[p];
+  }
+  std::vector<std::unique_ptr<std::ifstream> > inputs;
+  for (const auto& path : shards.paths) {
+    inputs.emplace_back(new std::ifstream(path, std::ios::binary));
+  }
+  std::vector<char> buffer(1 << 16);
+  for (std::size_t first = 0; first < jobs.size(); first += m_settings.range) {
+    auto iter = blocks.find(first);
+    if (iter == blocks.end()) {
+      for (std::size_t j = first; j < std::min(first + m_settings.range, jobs.size()); ++j) {
+        report.failures.push_back(std::make_pair(jobs[j].ismPath, lost));
+      }
+      continue;
+    }
+    const auto& block = iter->second;
+    auto& in = *inputs[block.shard];
+    in.seekg(block.offset);
+    for (auto remaining = block.bytes; remaining > 0;) {
+      auto chunk = std::min(remaining, buffer.size());
+      if (!in.read(buffer.data(), chunk)) {
+        throw std::runtime_error("Could not read " + shards.paths[block.shard]);
+      }
+      out.write(buffer.data(), chunk);
+      remaining -= chunk;
+    }
+    report.failures.insert(report.failures.end(), block.failures.begin(), block.failures.end());
+    report.succeeded += block.count - block.failures.size();
+  }
+  out.flush();
+
+  report.weatherFiles = weather.size();
+  report.wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  return report;
+}
+
+void ShardedBatchRunner::work(const std::string& segment, const std::string& shardPath)
+{
+  SharedMemory data(segment, false);
+  SharedMemory queue(segment + ".queue", true);
+  SegmentReader reader(data);
+  auto& header = *reinterpret_cast<const SegmentHeader*>(reader.at(0, sizeof(SegmentHeader)));
+  if (std::memcmp(header.magic, segmentMagic, sizeof(segmentMagic)) != 0 || header.size != data.size() || header.range == 0) {
+    throw std::runtime_error(segment + " is not a batch segment");
+  }
+  if (queue.size() < sizeof(QueueCounter)) {
+    throw std::runtime_error(segment + ".queue is not a batch queue");
+  }
+  auto& next = *reinterpret_cast<QueueCounter*>(queue.data());
+
+  std::vector<BatchJob> jobs(header.jobCount);
+  auto jobRecords = reinterpret_cast<const JobRecord*>(reader.at(sizeof(SegmentHeader), header.jobCount * sizeof(JobRecord)));
+  for (std::size_t i = 0; i < jobs.size(); ++i) {
+    jobs[i].ismPath = reader.string(jobRecords[i].ismPath, jobRecords[i].ismPathLength);
+    jobs[i].defaultsPath = reader.string(jobRecords[i].defaultsPath, jobRecords[i].defaultsPathLength);
+    jobs[i].hourly = jobRecords[i].hourly != 0;
+  }
+
+  BatchSettings settings;
+  settings.threads = header.threads;
+  BatchRunner runner(settings);
+  auto weatherRecords = reinterpret_cast<const WeatherRecord*>(
+    reader.at(sizeof(SegmentHeader) + header.jobCount * sizeof(JobRecord), header.weatherCount * sizeof(WeatherRecord)));
+  for (std::size_t w = 0; w < header.weatherCount; ++w) {
+    const auto& record = weatherRecords[w];
+    auto epw = reader.doubles(record.epw, epwDoubles);
+    auto summary = reader.doubles(record.summary, summaryDoubles);
+    runner.weatherCache()->get(reader.string(record.path, record.pathLength), [epw, summary]() { return readWeather(epw, summary); });
+  }
+
+  std::ofstream shard(shardPath, std::ios::binary);
+  if (!shard) {
+    throw std::runtime_error("Could not open " + shardPath);
+  }
+  for (;;) {
+    std::uint64_t first = next.fetch_add(header.range);
+    if (first >= jobs.size()) {
+      break;
+    }
+    auto last = std::min<std::uint64_t>(first + header.range, jobs.size());
+    std::vector<BatchJob> range(jobs.begin() + first, jobs.begin() + last);
+    std::ostringstream rows;
+    auto report = runner.run(range, rows);
+
+    // Write each block whole, so a crash leaves at most one partial block.
+    std::ostringstream block;
+    block << "range " << first << " " << last - first << " " << rows.str().size() << " " << report.failures.size() << "\n" << rows.str();
+    for (const auto& failure : report.failures) {
+      block << oneLine(failure.first) << "\t" << oneLine(failure.second) << "\n";
+    }
+    shard << block.str();
+    shard.flush();
+    if (!shard) {
+      throw std::runtime_error("Could not write " + shardPath);
+    }
+  }
+}
+
+#else
+
+BatchReport ShardedBatchRunner::run(const std::vector<BatchJob>&, std::ostream&)
+{
+  throw std::runtime_error("Sharded batch runs are not available on Windows");
+}
+
+void ShardedBatchRunner::work(const std::string&, const std::string&)
+{
+  throw std::runtime_error("Sharded batch runs are not available on Windows");
+}
+
+#endif
+
+} // isomodel
+} // openstudio
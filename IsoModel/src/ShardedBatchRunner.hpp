@@ -0,0 +1,71 @@
+#ifndef ISOMODEL_SHARDED_BATCH_RUNNER_HPP
+#define ISOMODEL_SHARDED_BATCH_RUNNER_HPP
+
+#include "BatchRunner.hpp"
+#include "ISOModelAPI.hpp"
+
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace openstudio {
+namespace isomodel {
+
+// Settings for ShardedBatchRunner.
+struct ShardedBatchSettings
+{
+  // Worker processes.
+  std::size_t workers = 2;
+  // Threads in each worker, or 0 to divide the hardware threads between them.
+  std::size_t threads = 1;
+  // Jobs a worker takes from the queue at a time.
+  std::size_t range = 16;
+  // The program each worker runs, as "executable --worker segment --output
+  // shard"; isomodel_batch answers this. Searched for on the PATH if it has
+  // no directory.
+  std::string executable;
+  // Where the workers write their shards. Defaults to the temporary directory.
+  std::string shardDirectory;
+};
+
+/**
+ * Simulates many buildings in several worker processes, so that a crash or a
+ * leak in one building's run is confined to one worker. The coordinator
+ * parses each distinct weather file once and publishes the parsed data and
+ * its monthly summaries, along with the jobs, in a POSIX shared memory
+ * segment that the workers map read-only; the workers fill their
+ * WeatherCaches from it instead of parsing. A second, writable segment holds
+ * a lock-free counter the workers take ranges of jobs from. Each worker runs
+ * its ranges with a BatchRunner and appends the rows to its own shard file,
+ * and the coordinator merges the shards in job order. Jobs in ranges that a
+ * worker took but never finished are reported as failures. Not available on
+ * Windows.
+ */
+class ISOMODEL_API ShardedBatchRunner
+{
+public:
+  explicit ShardedBatchRunner(ShardedBatchSettings settings);
+
+  /**
+   * Runs the jobs in the worker processes and writes the same rows, in the
+   * same order, as BatchRunner::run(). Throws std::runtime_error if the
+   * shared memory can't be set up.
+   */
+  BatchReport run(const std::vector<BatchJob>& jobs, std::ostream& out);
+
+  /**
+   * The worker side: maps the segment a coordinator published, runs ranges
+   * of jobs from its queue until none are left and appends them to the
+   * shard at shardPath. Throws std::runtime_error if the segment or the shard
+   * can't be opened.
+   */
+  static void work(const std::string& segment, const std::string& shardPath);
+
+private:
+  ShardedBatchSettings m_settings;
+};
+
+} // isomodel
+} // openstudio
+#endif // ISOMODEL_SHARDED_BATCH_RUNNER_HPP
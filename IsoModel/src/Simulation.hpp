@@ -2,6 +2,7 @@
 #define ISOMODEL_SIMULATION_HPP
 
 #include "ISOModelAPI.hpp"
+#include "Dual.hpp"
 
 #include "Population.hpp"
 #include "Location.hpp"
@@ -14,45 +15,56 @@
 #include "EpwData.hpp"
 #include "PhysicalQuantities.hpp"
 #include "SimulationSettings.hpp"
+#include "SimulationTrace.hpp"
+
+#include <memory>
 
 namespace openstudio {
 namespace isomodel {
 
-class ISOMODEL_API Simulation
+/**
+ * The parameters and trace shared by the models. T is the scalar type the
+ * parameters and calculations use: double, or Dual to differentiate the
+ * results with respect to some of the parameters.
+ */
+template<typename T>
+class BasicSimulation
 {
 public:
-  virtual ~Simulation() {}
+  typedef T Scalar;
+
+  virtual ~BasicSimulation() {}
 
   // Setters for the pointers to the classes that store the .ism parameters.
-  void setPop(Population value) {
+  void setPop(BasicPopulation<T> value) {
     pop = value;
   }
 
-  void setLocation(Location value) {
+  void setLocation(BasicLocation<T> value) {
     location = value;
   }
 
-  void setLights(Lighting value) {
+  void setLights(BasicLighting<T> value) {
     lights = value;
   }
 
-  void setBuilding(Building value) {
+  void setBuilding(BasicBuilding<T> value) {
     building = value;
   }
 
-  void setStructure(Structure value) {
+  void setStructure(BasicStructure<T> value) {
     structure = value;
   }
 
-  void setHeating(Heating value) {
+  void setHeating(BasicHeating<T> value) {
     heating = value;
   }
 
-  void setCooling(Cooling value) {
+  void setCooling(BasicCooling<T> value) {
     cooling = value;
   }
 
-  void setVentilation(Ventilation value) {
+  void setVentilation(BasicVentilation<T> value) {
     ventilation = value;
   }
   
@@ -60,28 +72,62 @@ public:
     epwData = value;
   }
 
-  void setPhysicalQuantities(PhysicalQuantities value) {
+  void setPhysicalQuantities(BasicPhysicalQuantities<T> value) {
     phys = value;
   }
 
-  void setSimulationSettings(SimulationSettings value) {
+  void setSimulationSettings(BasicSimulationSettings<T> value) {
     simSettings = value;
   }
 
+  /**
+   * Attaches a trace that captures named intermediate values while the
+   * simulation runs. Pass an empty pointer to turn tracing off (the default).
+   */
+  void setTrace(std::shared_ptr<SimulationTrace> value) {
+    trace = value;
+  }
+
 protected:
+  // Trace helpers. These only test the trace pointer when tracing is off.
+  // Traces hold the values of dual numbers, without the derivatives.
+  template<typename V>
+  void traceValue(const char* name, const V& value) const {
+    if (trace) {
+      trace->record(name, scalarValue(value));
+    }
+  }
+
+  template<typename V>
+  void traceVector(const char* name, const V& vec) const {
+    if (trace) {
+      trace->record(name, scalarValues(vec));
+    }
+  }
+
+  template<typename M>
+  void traceMatrix(const char* name, const M& mat) const {
+    if (trace) {
+      trace->record(name, scalarValues(mat));
+    }
+  }
+
   // Pointers to classes that store the .ism parameters.
-  Population pop;
-  Location location;
-  Lighting lights;
-  Building building;
-  Structure structure;
-  Heating heating;
-  Cooling cooling;
-  Ventilation ventilation;
+  BasicPopulation<T> pop;
+  BasicLocation<T> location;
+  BasicLighting<T> lights;
+  BasicBuilding<T> building;
+  BasicStructure<T> structure;
+  BasicHeating<T> heating;
+  BasicCooling<T> cooling;
+  BasicVentilation<T> ventilation;
   std::shared_ptr<EpwData> epwData;
-  PhysicalQuantities phys;
-  SimulationSettings simSettings;
+  BasicPhysicalQuantities<T> phys;
+  BasicSimulationSettings<T> simSettings;
+  std::shared_ptr<SimulationTrace> trace;
 };
+
+typedef BasicSimulation<double> Simulation;
 } // isomodel
 } // openstudio
 #endif // ISOMODEL_SIMULATION_HPP
@@ -0,0 +1,555 @@
+#include "SimulationServer.hpp"
+#include "Cancellation.hpp"
+#include "SolarRadiation.hpp"
+#include "TimeFrame.hpp"
+#include "UserModel.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+#include <boost/filesystem.hpp>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace openstudio {
+namespace isomodel {
+
+namespace {
+
+// The largest request body accepted. A complete building is a few kB.
+const std::size_t maxRequestBytes = 1 << 20;
+// The longest timeout accepted, well short of overflowing the deadline.
+const double maxTimeoutSeconds = 86400.0;
+
+#ifndef _WIN32
+// A stream buffer reading from or writing to a file descriptor.
+class DescriptorBuffer : public std::streambuf
+{
+public:
+  DescriptorBuffer(int in, int out) : m_in(in), m_out(out)
+  {
+    setg(m_input, m_input, m_input);
+    setp(m_output, m_output + sizeof(m_output));
+  }
+
+  ~DescriptorBuffer()
+  {
+    flush();
+  }
+
+protected:
+  int_type underflow() override
+  {
+    ssize_t count;
+    do {
+      count = ::read(m_in, m_input, sizeof(m_input));
+    } while (count < 0 && errno == EINTR);
+    if (count <= 0) {
+      return traits_type::eof();
+    }
+    setg(m_input, m_input, m_input + count);
+    return traits_type::to_int_type(*gptr());
+  }
+
+  int_type overflow(int_type c) override
+  {
+    if (flush() < 0) {
+      return traits_type::eof();
+    }
+    if (!traits_type::eq_int_type(c, traits_type::eof())) {
+      *pptr() = traits_type::to_char_type(c);
+      pbump(1);
+    }
+    return traits_type::not_eof(c);
+  }
+
+  int sync() override
+  {
+    return flush();
+  }
+
+private:
+  int flush()
+  {
+    for (auto p = pbase(); p < pptr();) {
+      auto count = ::write(m_out, p, pptr() - p);
+      if (count < 0 && errno == EINTR) {
+        continue;
+      }
+      if (count <= 0) {
+        return -1;
+      }
+      p += count;
+    }
+    setp(m_output, m_output + sizeof(m_output));
+    return 0;
+  }
+
+  int m_in;
+  int m_out;
+  char m_input[16384];
+  char m_output[16384];
+};
+#endif
+
+const char* const endUseHeader =
+    "Month,ElecHeat,ElecCool,ElecIntLights,ElecExtLights,ElecFans,ElecPump,ElecEquipInt,ElecEquipExt,ElectDHW,GasHeat,GasCool,GasEquip,GasDHW\n";
+
+double endUse(EndUses& month, int i)
+{
+#ifdef ISOMODEL_STANDALONE
+  return month.getEndUse(i);
+#else
+  return month.getEndUse(isoResultsEndUseTypes[i].first, isoResultsEndUseTypes[i].second);
+#endif
+}
+
+// Drops the least recently used entries of cache beyond limit.
+template<typename Key, typename Entry>
+void evict(std::map<Key, Entry>& cache, std::size_t limit, std::size_t& evictions)
+{
+  typedef typename std::map<Key, Entry>::value_type Item;
+  while (cache.size() > limit) {
+    cache.erase(std::min_element(cache.begin(), cache.end(), [](const Item& a, const Item& b) {
+      return a.second.lastUsed < b.second.lastUsed;
+    }));
+    ++evictions;
+  }
+}
+
+} // namespace
+
+void ServerStats::write(std::ostream& out) const
+{
+  out << "Requests,Failures,MeanMs,P50Ms,P99Ms,MaxMs,WeatherFiles,Buildings,Evictions\n"
+      << requests << "," << failures << "," << meanMilliseconds << "," << p50Milliseconds << "," << p99Milliseconds << ","
+      << maxMilliseconds << "," << weatherFiles << "," << buildings << "," << evictions << "\n";
+}
+
+SimulationServer::SimulationServer(std::size_t threads, std::size_t maxBuildings, std::size_t maxWeatherFiles, std::size_t maxConnections) :
+    m_pool(threads), m_weatherCache(std::make_shared<WeatherCache>()), m_maxBuildings(maxBuildings),
+    m_maxWeatherFiles(maxWeatherFiles), m_p50(0.5), m_p99(0.99), m_stopping(false), m_listener(-1), m_maxConnections(maxConnections)
+{
+  if (!maxBuildings || !maxWeatherFiles) {
+    throw std::invalid_argument("The server must be able to cache at least one building and weather file");
+  }
+  if (!maxConnections) {
+    throw std::invalid_argument("The server must be able to serve at least one connection");
+  }
+}
+
+SimulationServer::~SimulationServer()
+{
+}
+
+std::shared_ptr<const SimulationServer::Base> SimulationServer::base(const std::string& path, const std::string& defaultsPath)
+{
+  auto key = path + "\n" + defaultsPath;
+  {
+    std::lock_guard<std::mutex> lock(m_cacheMutex);
+    auto iter = m_bases.find(key);
+    if (iter != m_bases.end()) {
+      iter->second.lastUsed = ++m_lookups;
+      return iter->second.value;
+    }
+  }
+
+  // UserModel reports missing files on stdout, so check first.
+  if (!boost::filesystem::exists(path)) {
+    throw std::runtime_error("ISO Model File Not Found: " + path);
+  }
+  if (!defaultsPath.empty() && !boost::filesystem::exists(defaultsPath)) {
+    throw std::runtime_error("Defaults File Not Found: " + defaultsPath);
+  }
+
+  auto loaded = std::make_shared<Base>();
+  loaded->path = path;
+  loaded->properties = defaultsPath.empty() ? Properties(path) : Properties(path, defaultsPath);
+  auto model = std::make_shared<UserModel>();
+  model->setWeatherCache(m_weatherCache);
+  model->loadProperties(loaded->properties, path);
+  if (!model->valid()) {
+    throw std::runtime_error("Invalid model: " + path);
+  }
+  loaded->model = model;
+
+  // Another request may have loaded it meanwhile; keep the first.
+  std::lock_guard<std::mutex> lock(m_cacheMutex);
+  Cached<Base> entry = { loaded, ++m_lookups };
+  auto kept = m_bases.insert(std::make_pair(key, entry)).first->second.value;
+  evict(m_bases, m_maxBuildings, m_evictions);
+  return kept;
+}
+
+std::shared_ptr<const std::vector<std::vector<double> > > SimulationServer::wallIrradiance(const std::shared_ptr<EpwData>& weather)
+{
+  {
+    std::lock_guard<std::mutex> lock(m_cacheMutex);
+    auto iter = m_irradiance.find(weather);
+    if (iter != m_irradiance.end()) {
+      iter->second.lastUsed = ++m_lookups;
+      return iter->second.value;
+    }
+  }
+
+  // The same calculation as HourlyModel does for each run.
+  TimeFrame frame;
+  SolarRadiation solar(&frame, weather.get());
+  solar.calculateSurfaceSolarRadiation();
+  auto irradiance = std::make_shared<const std::vector<std::vector<double> > >(solar.eglobe());
+
+  std::lock_guard<std::mutex> lock(m_cacheMutex);
+  Cached<std::vector<std::vector<double> > > entry = { irradiance, ++m_lookups };
+  auto kept = m_irradiance.insert(std::make_pair(weather, entry)).first->second.value;
+  evict(m_irradiance, m_maxWeatherFiles, m_evictions);
+  return kept;
+}
+
+ServerResponse SimulationServer::handle(const std::string& body)
+{
+  ServerResponse response;
+  try {
+    Properties request;
+    std::istringstream in(body);
+    request.read(in, "request");
+
+    std::string engine = "monthly", format = "csv", basePath, defaultsPath;
+    Properties building;
+    std::size_t changes = 0;
+    CancellationToken deadline;
+    for (auto key = request.keys_begin(); key != request.keys_end(); ++key) {
+      auto value = *request.getProperty(*key);
+      if (*key == "timeout") {
+        std::size_t end = 0;
+        double seconds = 0.0;
+        try {
+          seconds = std::stod(value, &end);
+        } catch (const std::exception&) {
+        }
+        if (end != value.size() || !(seconds > 0.0) || seconds > maxTimeoutSeconds) {
+          throw std::invalid_argument("The timeout must be a positive number of seconds, at most a day, not '" + value + "'");
+        }
+        deadline.cancelAfter(seconds);
+      } else if (*key == "engine" || *key == "format") {
+        std::transform(value.begin(), value.end(), value.begin(), ::tolower);
+        (*key == "engine" ? engine : format) = value;
+      } else if (*key == "base") {
+        basePath = value;
+      } else if (*key == "defaults") {
+        defaultsPath = value;
+      } else {
+        building.putProperty(*key, value);
+        ++changes;
+      }
+    }
+    if (engine != "monthly" && engine != "hourly") {
+      throw std::invalid_argument("Unknown engine '" + engine + "', expected monthly or hourly");
+    }
+    if (format != "csv" && format != "binary") {
+      throw std::invalid_argument("Unknown format '" + format + "', expected csv or binary");
+    }
+
+    std::shared_ptr<const UserModel> model;
+    if (!basePath.empty()) {
+      auto loaded = base(basePath, defaultsPath);
+      if (changes == 0) {
+        model = loaded->model;
+      } else {
+        auto props = loaded->properties;
+        for (auto key = building.keys_begin(); key != building.keys_end(); ++key) {
+          props.putProperty(*key, *building.getProperty(*key));
+        }
+        auto variant = std::make_shared<UserModel>();
+        variant->setWeatherCache(m_weatherCache);
+        variant->loadProperties(props, loaded->path);
+        model = variant;
+      }
+    } else {
+      auto complete = std::make_shared<UserModel>();
+      complete->setWeatherCache(m_weatherCache);
+      complete->loadProperties(building, std::string());
+      model = complete;
+    }
+    if (!model->valid()) {
+      throw std::runtime_error("Invalid model");
+    }
+
+    std::vector<EndUses> results;
+    deadline.throwIfCancelled();
+    if (engine == "hourly") {
+      auto hourly = model->toHourlyModel();
+      hourly.setWallIrradiance(wallIrradiance(model->epwData()));
+      hourly.setCancellation(deadline);
+      results = hourly.simulate(true);
+    } else {
+      results = model->toMonthlyModel().simulate();
+    }
+
+    response.format = format;
+    if (format == "binary") {
+      std::vector<double> values;
+      for (auto& month : results) {
+        for (int i = 0; i < 13; ++i) {
+          values.push_back(endUse(month, i));
+        }
+      }
+      response.body.assign(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(double));
+    } else {
+      std::ostringstream csv;
+      csv << endUseHeader << std::setprecision(10);
+      for (std::size_t m = 0; m < results.size(); ++m) {
+        csv << m + 1;
+        for (int i = 0; i < 13; ++i) {
+          csv << "," << endUse(results[m], i);
+        }
+        csv << "\n";
+      }
+      response.body = csv.str();
+    }
+    response.ok = true;
+  } catch (std::domain_error* e) {
+    // Properties throws pointers.
+    response.body = e->what();
+    delete e;
+  } catch (const std::exception& e) {
+    response.body = e.what();
+  }
+  if (!response.ok) {
+    response.format.clear();
+  }
+  return response;
+}
+
+void SimulationServer::record(double milliseconds, bool ok)
+{
+  std::lock_guard<std::mutex> lock(m_statsMutex);
+  m_latency.add(milliseconds);
+  m_p50.add(milliseconds);
+  m_p99.add(milliseconds);
+  if (!ok) {
+    ++m_failures;
+  }
+}
+
+ServerStats SimulationServer::stats() const
+{
+  ServerStats stats;
+  {
+    std::lock_guard<std::mutex> lock(m_statsMutex);
+    stats.requests = m_latency.count();
+    stats.failures = m_failures;
+    stats.meanMilliseconds = m_latency.mean();
+    stats.p50Milliseconds = m_p50.value();
+    stats.p99Milliseconds = m_p99.value();
+    stats.maxMilliseconds = m_latency.count() ? m_latency.max() : 0.0;
+  }
+  stats.weatherFiles = m_weatherCache->size();
+  std::lock_guard<std::mutex> lock(m_cacheMutex);
+  stats.buildings = m_bases.size();
+  stats.evictions = m_evictions;
+  return stats;
+}
+
+void SimulationServer::serve(std::istream& in, std::ostream& out)
+{
+  std::mutex outMutex;
+  auto respond = [&out, &outMutex](const std::string& header, const std::string& body) {
+    std::lock_guard<std::mutex> lock(outMutex);
+    out << header << " " << body.size() << "\n" << body;
+    out.flush();
+  };
+
+  std::mutex pendingMutex;
+  std::condition_variable finished;
+  std::size_t pending = 0;
+
+  std::string line;
+  while (std::getline(in, line)) {
+    if (!line.empty() && line.back() == '\r') {
+      line.pop_back();
+    }
+    if (line.empty()) {
+      continue;
+    }
+
+    std::istringstream header(line);
+    std::string command, id;
+    std::size_t length = 0;
+    if (!(header >> command >> id >> length) || (command != "run" && command != "stats")) {
+      // The rest of the stream can't be framed.
+      respond("error -", "Malformed request header: " + line);
+      break;
+    }
+    if (length > maxRequestBytes) {
+      // Skipping the body would mean reading it all, so drop the stream.
+      respond("error " + id, "The request body of " + std::to_string(length) + " bytes is larger than the limit of " +
+                               std::to_string(maxRequestBytes));
+      break;
+    }
+    std::string body(length, '\0');
+    if (length > 0 && !in.read(&body[0], length)) {
+      respond("error " + id, "The request ended early");
+      break;
+    }
+
+    if (command == "stats") {
+      std::ostringstream csv;
+      stats().write(csv);
+      respond("ok " + id + " csv", csv.str());
+      continue;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    {
+      std::lock_guard<std::mutex> lock(pendingMutex);
+      ++pending;
+    }
+    m_pool.submit([this, id, body, start, &respond, &pendingMutex, &pending, &finished]() {
+      auto response = handle(body);
+      if (response.ok) {
+        respond("ok " + id + " " + response.format, response.body);
+      } else {
+        respond("error " + id, response.body);
+      }
+      record(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count(), response.ok);
+
+      std::lock_guard<std::mutex> lock(pendingMutex);
+      --pending;
+      finished.notify_all();
+    });
+  }
+
+  std::unique_lock<std::mutex> lock(pendingMutex);
+  finished.wait(lock, [&pending]() { return pending == 0; });
+}
+
+#ifndef _WIN32
+
+void SimulationServer::serve(int in, int out)
+{
+  DescriptorBuffer input(in, -1), output(-1, out);
+  std::istream inStream(&input);
+  std::ostream outStream(&output);
+  serve(inStream, outStream);
+}
+
+void SimulationServer::listen(const std::string& path)
+{
+  sockaddr_un address;
+  std::memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  if (path.size() >= sizeof(address.sun_path)) {
+    throw std::invalid_argument("Socket path too long: " + path);
+  }
+  std::strcpy(address.sun_path, path.c_str());
+
+  int listener = ::socket(AF_UNIX, SOCK_STREAM, 0);
+  if (listener < 0) {
+    throw std::runtime_error("Could not create a socket: " + std::string(std::strerror(errno)));
+  }
+  ::unlink(path.c_str());
+  if (::bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 || ::listen(listener, 64) < 0) {
+    auto error = std::string(std::strerror(errno));
+    ::close(listener);
+    throw std::runtime_error("Could not listen on " + path + ": " + error);
+  }
+
+  m_listener = listener;
+  for (;;) {
+    {
+      std::unique_lock<std::mutex> lock(m_connectionsMutex);
+      m_connectionsChanged.wait(lock, [this]() { return m_stopping || m_connections.size() < m_maxConnections; });
+    }
+    if (m_stopping) {
+      break;
+    }
+    int connection = ::accept(listener, nullptr, nullptr);
+    if (connection < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      break;
+    }
+    {
+      std::lock_guard<std::mutex> lock(m_connectionsMutex);
+      m_connections.insert(connection);
+      // stop() may have run since the check above.
+      if (m_stopping) {
+        ::shutdown(connection, SHUT_RD);
+      }
+    }
+    std::thread([this, connection]() {
+      try {
+        serve(connection, connection);
+      } catch (const std::exception& e) {
+        // One bad connection mustn't take the server down with it.
+        std::cerr << "Connection failed: " << e.what() << std::endl;
+      }
+      // Closed under the lock so stop() can't shut down a reused descriptor.
+      std::lock_guard<std::mutex> lock(m_connectionsMutex);
+      ::close(connection);
+      m_connections.erase(connection);
+      m_connectionsChanged.notify_all();
+    }).detach();
+  }
+  m_listener = -1;
+  ::close(listener);
+  ::unlink(path.c_str());
+
+  std::unique_lock<std::mutex> lock(m_connectionsMutex);
+  m_connectionsChanged.wait(lock, [this]() { return m_connections.empty(); });
+  // Ready for the next listen(). Resetting here rather than on entry keeps a
+  // stop() that comes before this listen() got going.
+  m_stopping = false;
+}
+
+void SimulationServer::stop()
+{
+  m_stopping = true;
+  int listener = m_listener;
+  if (listener >= 0) {
+    // Wakes the accept() in listen().
+    ::shutdown(listener, SHUT_RDWR);
+  }
+  // Ends the reads of the open connections, which still write the responses
+  // to the requests they have read.
+  std::lock_guard<std::mutex> lock(m_connectionsMutex);
+  for (auto connection : m_connections) {
+    ::shutdown(connection, SHUT_RD);
+  }
+  m_connectionsChanged.notify_all();
+}
+
+#else
+
+void SimulationServer::serve(int, int)
+{
+  throw std::runtime_error("Serving file descriptors is not available on Windows");
+}
+
+void SimulationServer::listen(const std::string&)
+{
+  throw std::runtime_error("Unix domain sockets are not available on Windows");
+}
+
+void SimulationServer::stop()
+{
+  m_stopping = true;
+}
+
+#endif
+
+} // isomodel
+} // openstudio
@@ -0,0 +1,188 @@
+#ifndef ISOMODEL_SIMULATION_SERVER_HPP
+#define ISOMODEL_SIMULATION_SERVER_HPP
+
+#include "ISOModelAPI.hpp"
+#include "OnlineStatistics.hpp"
+#include "Properties.hpp"
+#include "ThreadPool.hpp"
+#include "WeatherCache.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace openstudio {
+namespace isomodel {
+
+class EpwData;
+class UserModel;
+
+// The answer to one request.
+struct ServerResponse
+{
+  bool ok = false;
+  std::string format; // "csv" or "binary", if ok.
+  std::string body; // The results, or the error message.
+};
+
+// What a SimulationServer has done so far.
+struct ServerStats
+{
+  std::size_t requests = 0;
+  std::size_t failures = 0;
+  double meanMilliseconds = 0; // Latency from a request being read to its response being written.
+  double p50Milliseconds = 0;
+  double p99Milliseconds = 0;
+  double maxMilliseconds = 0;
+  std::size_t weatherFiles = 0; // Parsed weather files kept warm.
+  std::size_t buildings = 0; // Base buildings kept warm.
+  std::size_t evictions = 0; // Base buildings and wall irradiances dropped to stay within the limits.
+
+  /** Writes a CSV header and row. */
+  void write(std::ostream& out) const;
+};
+
+/**
+ * A long-running simulation service that keeps parsed weather files, the
+ * hourly solar radiation on the walls for each weather file and loaded base
+ * buildings between requests, so that a request pays for its simulation and
+ * not for process startup, weather parsing or solar calculations.
+ *
+ * Requests and responses are a header line followed by a body of the
+ * length the header gives. A request header is
+ *
+ * run id length<br>
+ * stats id 0
+ *
+ * where id is any token without spaces that the response repeats. The body
+ * of run is in the .ism key = value format. If it has the key base, the path
+ * of an .ism file (and optionally defaults, the path of a defaults file), its
+ * other keys are a delta applied to that building. Otherwise it is a
+ * complete building whose relative weather file path is resolved against
+ * the server's working directory. The keys engine ("monthly", the default,
+ * or "hourly") and format ("csv", the default, or "binary") choose how it is
+ * run and returned, and timeout (seconds, at most a day) bounds how long it
+ * may take: an hourly request still running when its timeout passes stops
+ * within a simulated day and answers with an error saying how far it got.
+ * A monthly request, which takes about a millisecond, is only checked
+ * before it starts. A response header is
+ *
+ * ok id format length<br>
+ * error id length
+ *
+ * followed by the results or the error message.
+ * The results are the 13 end uses (kWh/m2) of each of the 12 months: CSV
+ * with a header row, or 156 doubles in the host's byte order, month by
+ * month. stats answers with ServerStats as CSV. Requests on a connection run
+ * concurrently on the server's thread pool, so their responses can arrive in
+ * any order. Changes to base files are not noticed until the server restarts
+ * or drops the building from its cache: it keeps at most maxBuildings base
+ * buildings and the wall irradiance of at most maxWeatherFiles weather
+ * files, dropping the least recently used beyond that.
+ */
+class ISOMODEL_API SimulationServer
+{
+public:
+  /**
+   * Runs requests on the given number of threads, or one per hardware thread
+   * if threads is 0. listen() serves at most maxConnections connections at a
+   * time. Throws std::invalid_argument if any limit is 0.
+   */
+  explicit SimulationServer(std::size_t threads = 0,
+                            std::size_t maxBuildings = 64,
+                            std::size_t maxWeatherFiles = 16,
+                            std::size_t maxConnections = 64);
+  ~SimulationServer();
+
+  SimulationServer(const SimulationServer&) = delete;
+  SimulationServer& operator=(const SimulationServer&) = delete;
+
+  /** Runs the body of a run request on the calling thread. Doesn't count towards the stats. */
+  ServerResponse handle(const std::string& body);
+
+  /**
+   * Reads requests from in until it ends, a header is malformed or a body is
+   * larger than 1 MiB, runs them on the thread pool and writes the responses
+   * to out. Returns once every response has been written. Streams may be
+   * served concurrently.
+   */
+  void serve(std::istream& in, std::ostream& out);
+
+  /** Serves the file descriptors in and out, e.g. stdin and stdout or a socket. Not available on Windows. */
+  void serve(int in, int out);
+
+  /**
+   * Listens on a Unix domain socket at path, replacing any file there, and
+   * serves each connection on its own thread until stop() is called. Past
+   * maxConnections open connections, new ones wait to be accepted until one
+   * closes. Throws std::runtime_error if the socket can't be created. Once it
+   * returns it can be called again. Not available on Windows.
+   */
+  void listen(const std::string& path);
+
+  /**
+   * Makes listen() return, or the next listen() return at once if none is
+   * running. The connections it has accepted stop reading requests, and
+   * listen() returns once the requests already read have been answered.
+   * Safe to call from any thread.
+   */
+  void stop();
+
+  ServerStats stats() const;
+
+private:
+  struct Base
+  {
+    std::string path;
+    Properties properties;
+    std::shared_ptr<const UserModel> model;
+  };
+
+  // A cache entry and when it was last used, in lookups.
+  template<typename T>
+  struct Cached
+  {
+    std::shared_ptr<const T> value;
+    std::uint64_t lastUsed;
+  };
+
+  std::shared_ptr<const Base> base(const std::string& path, const std::string& defaultsPath);
+  std::shared_ptr<const std::vector<std::vector<double> > > wallIrradiance(const std::shared_ptr<EpwData>& weather);
+  void record(double milliseconds, bool ok);
+
+  ThreadPool m_pool;
+  std::shared_ptr<WeatherCache> m_weatherCache;
+
+  mutable std::mutex m_cacheMutex;
+  std::size_t m_maxBuildings;
+  std::size_t m_maxWeatherFiles;
+  std::uint64_t m_lookups = 0;
+  std::size_t m_evictions = 0;
+  std::map<std::string, Cached<Base> > m_bases;
+  std::map<std::shared_ptr<EpwData>, Cached<std::vector<std::vector<double> > > > m_irradiance;
+
+  mutable std::mutex m_statsMutex;
+  std::size_t m_failures = 0;
+  RunningStats m_latency;
+  P2Quantile m_p50;
+  P2Quantile m_p99;
+
+  std::atomic<bool> m_stopping;
+  std::atomic<int> m_listener;
+  std::size_t m_maxConnections;
+  std::mutex m_connectionsMutex;
+  std::condition_variable m_connectionsChanged;
+  std::set<int> m_connections;
+};
+
+} // isomodel
+} // openstudio
+#endif // ISOMODEL_SIMULATION_SERVER_HPP
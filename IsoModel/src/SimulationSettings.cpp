@@ -3,13 +3,7 @@
 namespace openstudio {
 namespace isomodel {
 
-SimulationSettings::SimulationSettings(void)
-{
-}
-
-SimulationSettings::~SimulationSettings(void)
-{
-}
+template class ISOMODEL_API BasicSimulationSettings<double>;
 
 } // isomodel
 } // openstudio
@@ -20,14 +20,25 @@
 #define ISOMODEL_SIMULATIONSETTINGS_HPP
 
 #include "ISOModelAPI.hpp"
+#include "Dual.hpp"
 
 namespace openstudio {
 namespace isomodel {
-class ISOMODEL_API SimulationSettings
+template<typename T>
+class BasicSimulationSettings
 {
 public:
-  SimulationSettings(void);
-  ~SimulationSettings(void);
+  BasicSimulationSettings() {}
+
+  /** Converts the parameters from another scalar type. */
+  template<typename U>
+  explicit BasicSimulationSettings(const BasicSimulationSettings<U>& other) :
+      m_phiIntFractionToAirNode(other.m_phiIntFractionToAirNode),
+      m_phiSolFractionToAirNode(other.m_phiSolFractionToAirNode),
+      m_hci(other.m_hci),
+      m_hri(other.m_hri)
+  {
+  }
 
   /**
   * Fraction of heat flow rate from interior sources that goes to the air node. ISO 13790 C.2 eq C.1
@@ -37,11 +48,11 @@ public:
   * heat gain that heats the air. These variables are used in those
   * calculations.
   */
-  double phiIntFractionToAirNode() const {
+  T phiIntFractionToAirNode() const {
     return m_phiIntFractionToAirNode;
   }
 
-  void setPhiIntFractionToAirNode(double phiIntFractionToAirNode) {
+  void setPhiIntFractionToAirNode(T phiIntFractionToAirNode) {
     m_phiIntFractionToAirNode = phiIntFractionToAirNode;
   }
 
@@ -53,43 +64,49 @@ public:
   * heat gain that heats the air. These variables are used in those
   * calculations.
   */
-  double phiSolFractionToAirNode() const {
+  T phiSolFractionToAirNode() const {
     return m_phiSolFractionToAirNode;
   }
 
-  void setPhiSolFractionToAirNode(double phiSolFractionToAirNode) {
+  void setPhiSolFractionToAirNode(T phiSolFractionToAirNode) {
     m_phiSolFractionToAirNode = phiSolFractionToAirNode;
   }
 
   /**
   * Default of 2.5 is used to generate the default values of h_is and h_ms found in ISO 13790.
   */
-  double hci() const {
+  T hci() const {
     return m_hci;
   }
 
-  void setHci(double hci) {
+  void setHci(T hci) {
     m_hci = hci;
   }
 
   /**
   * Default of 5.5 is used to generate the default values of h_is and h_ms found in ISO 13790.
   */
-  double hri() const {
+  T hri() const {
     return m_hri;
   }
 
-  void setHri(double hri) {
+  void setHri(T hri) {
     m_hri = hri;
   }
 
 private:
-  double m_phiIntFractionToAirNode = 0.5; // Default value is the "0.5" from ISO 13790 C.2 eq C.1.
-  double m_phiSolFractionToAirNode = 0; // Default is that no solar heat flows directly to air node per ISO 13790 C.2 eq C.1.
-  double m_hci = 2.5; // Default of 2.5 is used to generate the default values of h_is and h_ms found in ISO 13790.
-  double m_hri = 5.5; // Default of 5.5 is used to generate the default values of h_is and h_ms found in ISO 13790.
+  template<typename>
+  friend class BasicSimulationSettings;
+
+  T m_phiIntFractionToAirNode = 0.5; // Default value is the "0.5" from ISO 13790 C.2 eq C.1.
+  T m_phiSolFractionToAirNode = 0; // Default is that no solar heat flows directly to air node per ISO 13790 C.2 eq C.1.
+  T m_hci = 2.5; // Default of 2.5 is used to generate the default values of h_is and h_ms found in ISO 13790.
+  T m_hri = 5.5; // Default of 5.5 is used to generate the default values of h_is and h_ms found in ISO 13790.
 };
 
+extern template class ISOMODEL_API BasicSimulationSettings<double>;
+typedef BasicSimulationSettings<double> SimulationSettings;
+
 } // isomodel
 } // openstudio
 #endif // ISOMODEL_SIMULATIONSETTINGS_HPP
@@ -0,0 +1,233 @@
+#include "SimulationTrace.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+
+namespace openstudio {
+namespace isomodel {
+
+namespace {
+const char traceMagic[8] = { 'I', 'S', 'O', 'T', 'R', 'A', 'C', 'E' };
+const std::uint32_t traceVersion = 1;
+
+template<typename T>
+void writeRaw(std::ostream& out, T value)
+{
+  out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template<typename T>
+T readRaw(std::istream& in)
+{
+  T value;
+  if (!in.read(reinterpret_cast<char*>(&value), sizeof(T))) {
+    throw std::runtime_error("Unexpected end of trace file");
+  }
+  return value;
+}
+}
+
+SimulationTrace::SimulationTrace() : m_cursor(0) {}
+
+void SimulationTrace::record(const char* name, double value)
+{
+  findOrAdd(name, 1, 1).values.push_back(value);
+}
+
+void SimulationTrace::record(const char* name, const Vector& vec)
+{
+  Column& col = findOrAdd(name, 1, vec.size());
+  col.values.insert(col.values.end(), vec.begin(), vec.end());
+}
+
+void SimulationTrace::record(const char* name, const Matrix& mat)
+{
+  Column& col = findOrAdd(name, mat.size1(), mat.size2());
+  for (std::size_t i = 0; i < mat.size1(); ++i) {
+    for (std::size_t j = 0; j < mat.size2(); ++j) {
+      col.values.push_back(mat(i, j));
+    }
+  }
+}
+
+void SimulationTrace::record(const char* name, const double* values, std::size_t rows, std::size_t cols)
+{
+  Column& col = findOrAdd(name, rows, cols);
+  col.values.insert(col.values.end(), values, values + rows * cols);
+}
+
+SimulationTrace::Column& SimulationTrace::findOrAdd(const char* name, std::size_t rows, std::size_t cols)
+{
+  std::size_t index = m_columns.size();
+  std::size_t next = m_cursor + 1 < m_columns.size() ? m_cursor + 1 : 0;
+  if (next < m_columns.size() && m_columns[next].name == name) {
+    index = next;
+  } else {
+    for (std::size_t i = 0; i < m_columns.size(); ++i) {
+      if (m_columns[i].name == name) {
+        index = i;
+        break;
+      }
+    }
+  }
+
+  if (index == m_columns.size()) {
+    Column col;
+    col.name = name;
+    col.rows = rows;
+    col.cols = cols;
+    m_columns.push_back(col);
+  } else if (m_columns[index].width() != rows * cols) {
+    throw std::invalid_argument("Trace column " + m_columns[index].name + " recorded with a different size");
+  }
+  m_cursor = index;
+  return m_columns[index];
+}
+
+bool SimulationTrace::contains(const std::string& name) const
+{
+  for (const auto& col : m_columns) {
+    if (col.name == name) {
+      return true;
+    }
+  }
+  return false;
+}
+
+const SimulationTrace::Column& SimulationTrace::column(const std::string& name) const
+{
+  for (const auto& col : m_columns) {
+    if (col.name == name) {
+      return col;
+    }
+  }
+  throw std::out_of_range("No trace column named " + name);
+}
+
+void SimulationTrace::clear()
+{
+  m_columns.clear();
+  m_cursor = 0;
+}
+
+void SimulationTrace::writeCsv(std::ostream& out) const
+{
+  std::size_t records = 0;
+  bool first = true;
+  for (const auto& col : m_columns) {
+    records = std::max(records, col.records());
+    for (std::size_t r = 0; r < col.rows; ++r) {
+      for (std::size_t c = 0; c < col.cols; ++c) {
+        out << (first ? "" : ",") << col.name;
+        if (col.rows > 1) {
+          out << "[" << r << "]";
+        }
+        if (col.rows > 1 || col.cols > 1) {
+          out << "[" << c << "]";
+        }
+        first = false;
+      }
+    }
+  }
+  out << std::endl;
+
+  auto precision = out.precision(std::numeric_limits<double>::digits10 + 2);
+  for (std::size_t i = 0; i < records; ++i) {
+    first = true;
+    for (const auto& col : m_columns) {
+      auto width = col.width();
+      for (std::size_t j = 0; j < width; ++j) {
+        out << (first ? "" : ",");
+        if (i < col.records()) {
+          out << col.values[i * width + j];
+        }
+        first = false;
+      }
+    }
+    out << std::endl;
+  }
+  out.precision(precision);
+}
+
+void SimulationTrace::writeCsv(const std::string& path) const
+{
+  std::ofstream out(path.c_str());
+  if (!out) {
+    throw std::runtime_error("Could not open trace file " + path);
+  }
+  writeCsv(out);
+}
+
+void SimulationTrace::writeBinary(std::ostream& out) const
+{
+  out.write(traceMagic, sizeof(traceMagic));
+  writeRaw<std::uint32_t>(out, traceVersion);
+  writeRaw<std::uint32_t>(out, static_cast<std::uint32_t>(m_columns.size()));
+  for (const auto& col : m_columns) {
+    writeRaw<std::uint32_t>(out, static_cast<std::uint32_t>(col.name.size()));
+    out.write(col.name.data(), col.name.size());
+    writeRaw<std::uint64_t>(out, col.rows);
+    writeRaw<std::uint64_t>(out, col.cols);
+    writeRaw<std::uint64_t>(out, col.values.size());
+    if (!col.values.empty()) {
+      out.write(reinterpret_cast<const char*>(col.values.data()), col.values.size() * sizeof(double));
+    }
+  }
+}
+
+void SimulationTrace::writeBinary(const std::string& path) const
+{
+  std::ofstream out(path.c_str(), std::ios::binary);
+  if (!out) {
+    throw std::runtime_error("Could not open trace file " + path);
+  }
+  writeBinary(out);
+}
+
+SimulationTrace SimulationTrace::readBinary(std::istream& in)
+{
+  char magic[sizeof(traceMagic)];
+  if (!in.read(magic, sizeof(magic)) || std::memcmp(magic, traceMagic, sizeof(magic)) != 0) {
+    throw std::runtime_error("Not a trace file");
+  }
+  if (readRaw<std::uint32_t>(in) != traceVersion) {
+    throw std::runtime_error("Unsupported trace file version");
+  }
+
+  SimulationTrace trace;
+  auto columns = readRaw<std::uint32_t>(in);
+  for (std::uint32_t i = 0; i < columns; ++i) {
+    Column col;
+    col.name.resize(readRaw<std::uint32_t>(in));
+    if (!col.name.empty() && !in.read(&col.name[0], col.name.size())) {
+      throw std::runtime_error("Unexpected end of trace file");
+    }
+    col.rows = static_cast<std::size_t>(readRaw<std::uint64_t>(in));
+    col.cols = static_cast<std::size_t>(readRaw<std::uint64_t>(in));
+    col.values.resize(static_cast<std::size_t>(readRaw<std::uint64_t>(in)));
+    if (col.width() == 0 ? !col.values.empty() : col.values.size() % col.width() != 0) {
+      throw std::runtime_error("Malformed trace column " + col.name);
+    }
+    if (!col.values.empty() && !in.read(reinterpret_cast<char*>(col.values.data()), col.values.size() * sizeof(double))) {
+      throw std::runtime_error("Unexpected end of trace file");
+    }
+    trace.m_columns.push_back(col);
+  }
+  return trace;
+}
+
+SimulationTrace SimulationTrace::readBinary(const std::string& path)
+{
+  std::ifstream in(path.c_str(), std::ios::binary);
+  if (!in) {
+    throw std::runtime_error("Could not open trace file " + path);
+  }
+  return readBinary(in);
+}
+
+} // isomodel
+} // openstudio
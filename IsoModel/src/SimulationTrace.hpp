@@ -0,0 +1,106 @@
+#ifndef ISOMODEL_SIMULATION_TRACE_HPP
+#define ISOMODEL_SIMULATION_TRACE_HPP
+
+#include "ISOModelAPI.hpp"
+
+#ifdef ISOMODEL_STANDALONE
+#include "Vector.hpp"
+#include "Matrix.hpp"
+#else
+#include "../utilities/data/Vector.hpp"
+#include "../utilities/data/Matrix.hpp"
+#endif
+
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace openstudio {
+namespace isomodel {
+
+/**
+ * In-memory, columnar capture of named intermediate values from a simulation.
+ *
+ * Each name is a column. Every call to record() appends one record to the
+ * column: a scalar, or all the elements of a vector or (row-major) matrix.
+ * All records in a column must have the same number of elements; the shape of
+ * the first record is kept so the dump can be read back as a matrix.
+ *
+ * A trace is attached to a model with Simulation::setTrace(). When no trace
+ * is attached the models only test a null pointer, so production runs pay
+ * nothing for it.
+ */
+class ISOMODEL_API SimulationTrace
+{
+public:
+  struct Column
+  {
+    std::string name;
+    std::size_t rows; // Shape of one record (1x1 for scalars).
+    std::size_t cols;
+    std::vector<double> values; // All records, back to back.
+
+    std::size_t width() const {
+      return rows * cols;
+    }
+
+    std::size_t records() const {
+      return width() == 0 ? 0 : values.size() / width();
+    }
+  };
+
+  SimulationTrace();
+
+  void record(const char* name, double value);
+  void record(const char* name, const Vector& vec);
+  void record(const char* name, const Matrix& mat);
+  /** Records a row-major rows x cols block of values. */
+  void record(const char* name, const double* values, std::size_t rows, std::size_t cols);
+
+  /** Returns true if a column with the given name has been recorded. */
+  bool contains(const std::string& name) const;
+
+  /** Returns the column with the given name. Throws std::out_of_range if there isn't one. */
+  const Column& column(const std::string& name) const;
+
+  const std::vector<Column>& columns() const {
+    return m_columns;
+  }
+
+  /** Removes all the columns. */
+  void clear();
+
+  /**
+   * Writes the trace as CSV with one record per line. Columns with more than
+   * one element per record are expanded to name[i] (vectors) or name[r][c]
+   * (matrices). Columns with fewer records than others are left blank.
+   */
+  void writeCsv(std::ostream& out) const;
+  void writeCsv(const std::string& path) const;
+
+  /**
+   * Writes the trace in a compact binary format: the magic "ISOTRACE", a
+   * uint32 version and a uint32 column count, then for each column a uint32
+   * name length, the name, uint64 rows, cols and value count and the values
+   * as native doubles.
+   */
+  void writeBinary(std::ostream& out) const;
+  void writeBinary(const std::string& path) const;
+
+  /** Reads a trace written by writeBinary(). Throws std::runtime_error on malformed input. */
+  static SimulationTrace readBinary(std::istream& in);
+  static SimulationTrace readBinary(const std::string& path);
+
+private:
+  Column& findOrAdd(const char* name, std::size_t rows, std::size_t cols);
+
+  std::vector<Column> m_columns;
+  // Index of the last column touched. Traces are recorded in the same order
+  // every hour, so checking the next column first avoids most name lookups.
+  std::size_t m_cursor;
+};
+
+} // isomodel
+} // openstudio
+#endif // ISOMODEL_SIMULATION_TRACE_HPP
@@ -54,12 +54,20 @@ SolarRadiation::~SolarRadiation(void)
  * Wiley 2006
  */
 void SolarRadiation::calculateSurfaceSolarRadiation()
+{
+  std::vector<double> azimuths(SurfaceAzimuths, SurfaceAzimuths + NUM_SURFACES);
+  m_eglobe = calculateSurfaceSolarRadiation(azimuths);
+}
+
+std::vector<std::vector<double> > SolarRadiation::calculateSurfaceSolarRadiation(const std::vector<double>& surfaceAzimuths)
 {
   double GroundReflected = 0, SolarAzimuthSin = 0, SolarAzimuthCos = 0, SolarAzimuth = 0, Revolution, EquationOfTime, ApparentSolarTime,
       SolarDeclination, SolarHourAngles, SolarAltitudeAngles;
 
   double AngleOfIncidence, SurfaceSolarAzimuth, DirectBeam, diffuseAngleOfIncidenceFactor, DiffuseComponent;
 
+  std::vector<std::vector<double> > eglobe(TIMESLICES, std::vector<double>(surfaceAzimuths.size()));
+
   //avoid calling data() to reduce copy time
   std::vector<std::vector<double> > data = m_epwData->data();
   std::vector<double> vecEB = data[EB];
@@ -80,11 +88,11 @@ void SolarRadiation::calculateSurfaceSolarRadiation()
     SolarAzimuth = calculateSolarAzimuth(SolarAzimuthSin, SolarAzimuthCos);
 
     GroundReflected = calculateGroundReflectedIrradiance(vecEB[i], vecED[i], m_groundReflectance, SolarAltitudeAngles, m_surfaceTilt);
-    vecEGI = &(m_eglobe[i]);
+    vecEGI = &(eglobe[i]);
 
     //then compute the hourly radiation on each vertical surface given the solar azimuth for each hour
-    for (int s = 0; s < NUM_SURFACES; s++) {
-      SurfaceSolarAzimuth = calculateSurfaceSolarAzimuth(SolarAzimuth, SurfaceAzimuths[s]);
+    for (std::size_t s = 0; s < surfaceAzimuths.size(); s++) {
+      SurfaceSolarAzimuth = calculateSurfaceSolarAzimuth(SolarAzimuth, surfaceAzimuths[s]);
       AngleOfIncidence = calculateAngleOfIncidence(SolarAltitudeAngles, SurfaceSolarAzimuth, m_surfaceTilt);
 
       DirectBeam = calculateTotalDirectBeamIrradiance(vecEB[i], AngleOfIncidence);
@@ -95,6 +103,7 @@ void SolarRadiation::calculateSurfaceSolarRadiation()
       (*vecEGI)[s] = calculateTotalIrradiance(DirectBeam, DiffuseComponent, GroundReflected);
     }
   }
+  return eglobe;
 }
 
 //average the data in the bins over the count or days
@@ -68,6 +68,14 @@ public:
   ~SolarRadiation(void);
 
   void calculateSurfaceSolarRadiation();
+
+  /**
+  * Calculates the hourly total irradiance on surfaces with the given azimuths
+  * (radians, in the convention of the eight directions: south is 0 and west is
+  * pi/2) and this object's tilt. Returns one row per hour with one value per
+  * azimuth. Doesn't change the outputs.
+  */
+  std::vector<std::vector<double> > calculateSurfaceSolarRadiation(const std::vector<double>& surfaceAzimuths);
   void calculateAverages();
   void calculateMonthAvg(int midx, int cnt);
   void clearMonthlyAvg(int midx);
@@ -20,6 +20,7 @@
 #define ISOMODEL_STRUCTURE_HPP
 
 #include "ISOModelAPI.hpp"
+#include "Dual.hpp"
 
 #ifdef ISOMODEL_STANDALONE
 #include "Vector.hpp"
@@ -29,20 +30,51 @@
 
 namespace openstudio {
 namespace isomodel {
-class ISOMODEL_API Structure
+template<typename T>
+class BasicStructure
 {
 public:
-  Structure(void);
-  ~Structure(void);
+  BasicStructure() : m_wallArea(9, 0), m_windowArea(9, 0), m_wallUniform(9, 0), m_windowUniform(9, 0),
+      m_wallThermalEmissivity(9, 0), m_wallSolarAbsorbtion(9, 0), m_windowShadingDevice(9, 0),
+      m_windowNormalIncidenceSolarEnergyTransmittance(9, 0), m_windowShadingCorrectionFactor(9, 0)
+  {
+  }
+
+  /** Converts the parameters from another scalar type. */
+  template<typename U>
+  explicit BasicStructure(const BasicStructure<U>& other) :
+      m_floorArea(other.m_floorArea),
+      m_wallArea(other.m_wallArea),
+      m_windowArea(other.m_windowArea),
+      m_wallUniform(other.m_wallUniform),
+      m_windowUniform(other.m_windowUniform),
+      m_wallThermalEmissivity(other.m_wallThermalEmissivity),
+      m_wallSolarAbsorbtion(other.m_wallSolarAbsorbtion),
+      m_windowShadingDevice(other.m_windowShadingDevice),
+      m_windowNormalIncidenceSolarEnergyTransmittance(other.m_windowNormalIncidenceSolarEnergyTransmittance),
+      m_windowShadingCorrectionFactor(other.m_windowShadingCorrectionFactor),
+      m_interiorHeatCapacity(other.m_interiorHeatCapacity),
+      m_wallHeatCapacity(other.m_wallHeatCapacity),
+      m_buildingHeight(other.m_buildingHeight),
+      m_infiltrationRate(other.m_infiltrationRate),
+      m_R_se(other.m_R_se),
+      m_irradianceForMaxShadingUse(other.m_irradianceForMaxShadingUse),
+      m_shadingFactorAtMaxUse(other.m_shadingFactorAtMaxUse),
+      m_totalAreaPerFloorArea(other.m_totalAreaPerFloorArea),
+      m_win_ff(other.m_win_ff),
+      m_win_F_W(other.m_win_F_W),
+      m_R_sc_ext(other.m_R_sc_ext)
+  {
+  }
 
   /**
   * Floor area (m2).
   */
-  double floorArea() const {
+  T floorArea() const {
     return m_floorArea;
   }
 
-  void setFloorArea(double value) {
+  void setFloorArea(T value) {
     m_floorArea = value;
   }
 
@@ -50,15 +82,15 @@ public:
   * Wall and roof area (m2). The order is S, SE, E, NE, N, NW, W, SW, roof to match
   * conventions for sun angles where south is zero.
   */
-  Vector wallArea() const {
+  BasicVector<T> wallArea() const {
     return m_wallArea;
   }
 
-  void setWallArea(const Vector& value) {
+  void setWallArea(const BasicVector<T>& value) {
     m_wallArea = value;
   }
 
-  void setWallArea(int index, double value) {
+  void setWallArea(int index, T value) {
     m_wallArea[index] = value;
   }
 
@@ -66,15 +98,15 @@ public:
   * Window and skylight area (m2). The order is S, SE, E, NE, N, NW, W, SW, roof to match
   * conventions for sun angles where south is zero.
   */
-  Vector windowArea() const {
+  BasicVector<T> windowArea() const {
     return m_windowArea;
   }
 
-  void setWindowArea(const Vector& value) {
+  void setWindowArea(const BasicVector<T>& value) {
     m_windowArea = value;
   }
   
-  void setWindowArea(int index, double value) {
+  void setWindowArea(int index, T value) {
     m_windowArea[index] = value;
   }
 
@@ -82,15 +114,15 @@ public:
   * Wall and roof U-values (W/m2/K). The order is S, SE, E, NE, N, NW, W, SW, roof to match
   * conventions for sun angles where south is zero.
   */
-  Vector wallUniform() const {
+  BasicVector<T> wallUniform() const {
     return m_wallUniform;
   }
 
-  void setWallUniform(const Vector& value) {
+  void setWallUniform(const BasicVector<T>& value) {
     m_wallUniform = value;
   }
 
-  void setWallUniform(int index, double value) {
+  void setWallUniform(int index, T value) {
     m_wallUniform[index] = value;
   }
 
@@ -98,15 +130,15 @@ public:
   * Window and skylight U-values (W/m2/K). The order is S, SE, E, NE, N, NW, W, SW, roof to match
   * conventions for sun angles where south is zero.
   */
-  Vector windowUniform() const {
+  BasicVector<T> windowUniform() const {
     return m_windowUniform;
   }
 
-  void setWindowUniform(const Vector& value) {
+  void setWindowUniform(const BasicVector<T>& value) {
     m_windowUniform = value;
   }
 
-  void setWindowUniform(int index, double value) {
+  void setWindowUniform(int index, T value) {
     m_windowUniform[index] = value;
   }
 
@@ -115,15 +147,15 @@ public:
   * The order is S, SE, E, NE, N, NW, W, SW, roof to match conventions for sun
   * angles where south is zero.
   */
-  Vector wallThermalEmissivity() const {
+  BasicVector<T> wallThermalEmissivity() const {
     return m_wallThermalEmissivity;
   }
 
-  void setWallThermalEmissivity(const Vector& value) {
+  void setWallThermalEmissivity(const BasicVector<T>& value) {
     m_wallThermalEmissivity = value;
   }
 
-  void setWallThermalEmissivity(int index, double value) {
+  void setWallThermalEmissivity(int index, T value) {
     m_wallThermalEmissivity[index] = value;
   }
 
@@ -132,15 +164,15 @@ public:
   * The order is S, SE, E, NE, N, NW, W, SW, roof to match conventions for sun
   * angles where south is zero.
   */
-  Vector wallSolarAbsorption() const {
+  BasicVector<T> wallSolarAbsorption() const {
     return m_wallSolarAbsorbtion;
   }
 
-  void setWallSolarAbsorption(const Vector& value) {
+  void setWallSolarAbsorption(const BasicVector<T>& value) {
     m_wallSolarAbsorbtion = value;
   }
 
-  void setWallSolarAbsorption(int index, double value) {
+  void setWallSolarAbsorption(int index, T value) {
     m_wallSolarAbsorbtion[index] = value;
   }
 
@@ -149,15 +181,15 @@ public:
   * The order is S, SE, E, NE, N, NW, W, SW, roof to match conventions for sun
   * angles where south is zero.
   */
-  Vector windowShadingDevice() const {
+  BasicVector<T> windowShadingDevice() const {
     return m_windowShadingDevice;
   }
 
-  void setWindowShadingDevice(const Vector& value) {
+  void setWindowShadingDevice(const BasicVector<T>& value) {
     m_windowShadingDevice = value;
   }
 
-  void setWindowShadingDevice(int index, double value) {
+  void setWindowShadingDevice(int index, T value) {
     m_windowShadingDevice[index] = value;
   }
   /**
@@ -165,85 +197,85 @@ public:
   * The order is S, SE, E, NE, N, NW, W, SW, roof to match conventions for sun
   * angles where south is zero.
   */
-  Vector windowNormalIncidenceSolarEnergyTransmittance() const {
+  BasicVector<T> windowNormalIncidenceSolarEnergyTransmittance() const {
     return m_windowNormalIncidenceSolarEnergyTransmittance;
   }
 
-  void setWindowNormalIncidenceSolarEnergyTransmittance(const Vector& value) {
+  void setWindowNormalIncidenceSolarEnergyTransmittance(const BasicVector<T>& value) {
     m_windowNormalIncidenceSolarEnergyTransmittance = value;
   }
 
-  void setWindowNormalIncidenceSolarEnergyTransmittance(int index, double value) {
+  void setWindowNormalIncidenceSolarEnergyTransmittance(int index, T value) {
     m_windowNormalIncidenceSolarEnergyTransmittance[index] = value;
   }
 
   /**
   * Window solar control factor (external control) (0 to 1).
   */
-  Vector windowShadingCorrectionFactor() const {
+  BasicVector<T> windowShadingCorrectionFactor() const {
     return m_windowShadingCorrectionFactor;
   }
 
-  void setWindowShadingCorrectionFactor(const Vector& value) {
+  void setWindowShadingCorrectionFactor(const BasicVector<T>& value) {
     m_windowShadingCorrectionFactor = value;
   }
 
-  void setWindowShadingCorrectionFactor(int index, double value) {
+  void setWindowShadingCorrectionFactor(int index, T value) {
     m_windowShadingCorrectionFactor[index] = value;
   }
 
   /**
   * Interior surface heat capacity (J/K/m2).
   */
-  double interiorHeatCapacity() const {
+  T interiorHeatCapacity() const {
     return m_interiorHeatCapacity;
   }
 
-  void setInteriorHeatCapacity(double value) {
+  void setInteriorHeatCapacity(T value) {
     m_interiorHeatCapacity = value;
   }
 
   /**
   * Exterior surface (wall) heat capacity (J/K/m2).
   */
-  double wallHeatCapacity() const {
+  T wallHeatCapacity() const {
     return m_wallHeatCapacity;
   }
 
-  void setWallHeatCapacity(double value) {
+  void setWallHeatCapacity(T value) {
     m_wallHeatCapacity = value;
   }
 
   /**
   * Building height (m).
   */
-  double buildingHeight() const {
+  T buildingHeight() const {
     return m_buildingHeight;
   }
 
-  void setBuildingHeight(double value) {
+  void setBuildingHeight(T value) {
     m_buildingHeight = value;
   }
 
   /**
   * Infiltration rate occupied (m3/m2/hr, based on surface area).
   */
-  double infiltrationRate() const {
+  T infiltrationRate() const {
     return m_infiltrationRate;
   }
 
-  void setInfiltrationRate(double value) {
+  void setInfiltrationRate(T value) {
     m_infiltrationRate = value;
   }
 
   /**
   * External thermal surface resistance (m2*k/W).
   */
-  double R_se() const {
+  T R_se() const {
     return m_R_se;
   }
 
-  void setR_se(double R_se) {
+  void setR_se(T R_se) {
     m_R_se = R_se;
   }
 
@@ -252,11 +284,11 @@ public:
   * shading. ISO 13790 does it by switching between g_{gl} and g_{gl+sh}. The method here allows
   * varying degrees of shading rather than just on or off.
   */
-  double irradianceForMaxShadingUse() const {
+  T irradianceForMaxShadingUse() const {
     return m_irradianceForMaxShadingUse;
   }
 
-  void setIrradianceForMaxShadingUse(double irradianceForMaxShadingUse) {
+  void setIrradianceForMaxShadingUse(T irradianceForMaxShadingUse) {
     m_irradianceForMaxShadingUse = irradianceForMaxShadingUse;
   }
 
@@ -265,84 +297,90 @@ public:
   * shading. ISO 13790 does it by switching between g_{gl} and g_{gl+sh}. The method here allows
   * varying degrees of shading rather than just on or off.
   */
-  double shadingFactorAtMaxUse() const {
+  T shadingFactorAtMaxUse() const {
     return m_shadingFactorAtMaxUse;
   }
 
-  void setShadingFactorAtMaxUse(double shadingFactorAtMaxUse) {
+  void setShadingFactorAtMaxUse(T shadingFactorAtMaxUse) {
     m_shadingFactorAtMaxUse = shadingFactorAtMaxUse;
   }
 
   /**
   * Total interior surface area per floor area (m2/m2).
   */
-  double totalAreaPerFloorArea() const {
+  T totalAreaPerFloorArea() const {
     return m_totalAreaPerFloorArea;
   }
 
-  void setTotalAreaPerFloorArea(double totalAreaPerFloorArea) {
+  void setTotalAreaPerFloorArea(T totalAreaPerFloorArea) {
     m_totalAreaPerFloorArea = totalAreaPerFloorArea;
   }
 
   /**
   * Window frame factor.
   */
-  double win_ff() const {
+  T win_ff() const {
     return m_win_ff;
   }
 
-  void setWin_ff(double win_ff) {
+  void setWin_ff(T win_ff) {
     m_win_ff = win_ff;
   }
 
   /**
   * Correction factor for non-scattering window as per ISO 13790 11.4.2.
   */
-  double win_F_W() const {
+  T win_F_W() const {
     return m_win_F_W;
   }
 
-  void setWin_F_W(double win_F_W) {
+  void setWin_F_W(T win_F_W) {
     m_win_F_W = win_F_W;
   }
 
   /**
   * Vertical wall external convection surface heat resistance as per ISO 6946.
   */
-  double R_sc_ext() const {
+  T R_sc_ext() const {
     return m_R_sc_ext;
   }
 
-  void setR_sc_ext(double R_sc_ext) {
+  void setR_sc_ext(T R_sc_ext) {
     m_R_sc_ext = R_sc_ext;
   }
 
 private:
-  double m_floorArea;
-  Vector m_wallArea;
-  Vector m_windowArea;
-  Vector m_wallUniform;
-  Vector m_windowUniform;
-  Vector m_wallThermalEmissivity;
-  Vector m_wallSolarAbsorbtion;
-  Vector m_windowShadingDevice;
-  Vector m_windowNormalIncidenceSolarEnergyTransmittance;
-  Vector m_windowShadingCorrectionFactor;
-  double m_interiorHeatCapacity;
-  double m_wallHeatCapacity;
-  double m_buildingHeight;
-  double m_infiltrationRate;
+  template<typename>
+  friend class BasicStructure;
+
+  T m_floorArea;
+  BasicVector<T> m_wallArea;
+  BasicVector<T> m_windowArea;
+  BasicVector<T> m_wallUniform;
+  BasicVector<T> m_windowUniform;
+  BasicVector<T> m_wallThermalEmissivity;
+  BasicVector<T> m_wallSolarAbsorbtion;
+  BasicVector<T> m_windowShadingDevice;
+  BasicVector<T> m_windowNormalIncidenceSolarEnergyTransmittance;
+  BasicVector<T> m_windowShadingCorrectionFactor;
+  T m_interiorHeatCapacity;
+  T m_wallHeatCapacity;
+  T m_buildingHeight;
+  T m_infiltrationRate;
   // Members with default values:
-  double m_R_se = 0.04; // Exterior surface thermal resistance.
-  double m_irradianceForMaxShadingUse = 500; // The irradiance at which shading is in full use.
-  double m_shadingFactorAtMaxUse = 0.5; // Shading factor of moveable shading when in full use.
-  double m_totalAreaPerFloorArea = 4.5; // \Lambda_{at}. Ratio of total interior surface area to floor area.
-  double m_win_ff = 0.25; // Window frame factor.
-  double m_win_F_W = 0.9; // Correction factor for non-scattering window as per ISO 13790 11.4.2
-  double m_R_sc_ext = 0.04; // Vertical wall external convection surface heat resistance as per ISO 6946
+  T m_R_se = 0.04; // Exterior surface thermal resistance.
+  T m_irradianceForMaxShadingUse = 500; // The irradiance at which shading is in full use.
+  T m_shadingFactorAtMaxUse = 0.5; // Shading factor of moveable shading when in full use.
+  T m_totalAreaPerFloorArea = 4.5; // \Lambda_{at}. Ratio of total interior surface area to floor area.
+  T m_win_ff = 0.25; // Window frame factor.
+  T m_win_F_W = 0.9; // Correction factor for non-scattering window as per ISO 13790 11.4.2
+  T m_R_sc_ext = 0.04; // Vertical wall external convection surface heat resistance as per ISO 6946
 
 };
 
+extern template class ISOMODEL_API BasicStructure<double>;
+typedef BasicStructure<double> Structure;
+
 } // isomodel
 } // openstudio
 #endif // ISOMODEL_STRUCTURE_HPP
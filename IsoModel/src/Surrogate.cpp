@@ -0,0 +1,624 @@
+#include "Surrogate.hpp"
+#include "DesignOfExperiments.hpp"
+#include "WorkStealingPool.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <limits>
+#include <ostream>
+#include <stdexcept>
+
+namespace openstudio {
+namespace isomodel {
+
+namespace {
+
+const char surrogateMagic[8] = { 'I', 'S', 'O', 'S', 'U', 'R', 'R', 'O' };
+const std::uint32_t surrogateVersion = 1;
+// Property names are .ism keys; anything longer is a corrupt file.
+const std::uint32_t maxNameLength = 4096;
+
+const char* const endUseNames[] = { "ElecHeat", "ElecCool", "ElecIntLights", "ElecExtLights", "ElecFans", "ElecPump", "ElecEquipInt",
+                                    "ElecEquipExt", "ElectDHW", "GasHeat", "GasCool", "GasEquip", "GasDHW" };
+
+const std::size_t endUses = 13;
+
+// More polynomials than this are more than a surrogate is for.
+const std::size_t maxTerms = 5000;
+
+// The coefficients of each term are kept together, padded to a multiple of
+// four outputs so that predictions can sum four outputs at a time.
+const std::size_t coefficientStride = (Surrogate::outputs + 3) / 4 * 4;
+
+template<typename T>
+void writeRaw(std::ostream& out, T value)
+{
+  out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template<typename T>
+T readRaw(std::istream& in)
+{
+  T value;
+  if (!in.read(reinterpret_cast<char*>(&value), sizeof(T))) {
+    throw std::runtime_error("Unexpected end of surrogate file");
+  }
+  return value;
+}
+
+void writeDoubles(std::ostream& out, const std::vector<double>& values)
+{
+  out.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(double));
+}
+
+void readDoubles(std::istream& in, std::vector<double>& values, std::size_t count)
+{
+  values.resize(count);
+  if (count && !in.read(reinterpret_cast<char*>(values.data()), count * sizeof(double))) {
+    throw std::runtime_error("Unexpected end of surrogate file");
+  }
+}
+
+// The degrees of each polynomial of total degree at most degree in
+// dimensions variables, lowest total degree first.
+std::vector<unsigned> totalDegreeTerms(std::size_t dimensions, std::size_t degree)
+{
+  std::vector<unsigned> terms, term(dimensions, 0);
+  std::function<void(std::size_t, unsigned)> fill = [&](std::size_t d, unsigned left) {
+    if (d + 1 == dimensions) {
+      term[d] = left;
+      terms.insert(terms.end(), term.begin(), term.end());
+      if (terms.size() / dimensions > maxTerms) {
+        throw std::invalid_argument("A surrogate of this degree over this many properties has too many terms");
+      }
+      return;
+    }
+    for (unsigned k = left + 1; k-- > 0;) {
+      term[d] = k;
+      fill(d + 1, left - k);
+    }
+  };
+  for (unsigned total = 0; total <= degree; ++total) {
+    fill(0, total);
+  }
+  return terms;
+}
+
+// The run's monthly end uses followed by their year totals.
+std::vector<double> outputsOf(const std::vector<EndUses>& months)
+{
+  if (months.size() != 12) {
+    throw std::runtime_error("Expected 12 months of results");
+  }
+  std::vector<double> outputs(Surrogate::outputs, 0.0);
+  for (std::size_t month = 0; month < 12; ++month) {
+    auto results = months[month];
+    for (std::size_t i = 0; i < endUses; ++i) {
+#ifdef ISOMODEL_STANDALONE
+      auto value = results.getEndUse(i);
+#else
+      auto value = results.getEndUse(isoResultsEndUseTypes[i].first, isoResultsEndUseTypes[i].second);
+#endif
+      outputs[month * endUses + i] = value;
+      outputs[12 * endUses + i] += value;
+    }
+  }
+  return outputs;
+}
+
+void writeOutputName(std::ostream& out, std::size_t output)
+{
+  auto period = output / endUses;
+  if (period < 12) {
+    out << period + 1;
+  } else {
+    out << "year";
+  }
+  out << "," << endUseNames[output % endUses];
+}
+
+double seconds(std::chrono::steady_clock::time_point start)
+{
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace
+
+const std::size_t Surrogate::outputs;
+
+SurrogateSpec SurrogateSpec::read(const std::string& path)
+{
+  try {
+    return read(Properties(path));
+  } catch (std::domain_error* e) {
+    // Properties throws pointers.
+    std::string message = e->what();
+    delete e;
+    throw std::invalid_argument(message);
+  }
+}
+
+SurrogateSpec SurrogateSpec::read(const Properties& props)
+{
+  SurrogateSpec spec;
+  Properties sampling;
+  for (auto key = props.keys_begin(); key != props.keys_end(); ++key) {
+    if (*key == "degree") {
+      auto value = props.getPropertyAsInt(*key);
+      if (!value || *value < 0) {
+        throw std::invalid_argument("Surrogate degree must be a non-negative integer");
+      }
+      spec.degree = static_cast<std::size_t>(*value);
+    } else if (*key == "ridge") {
+      auto value = props.getPropertyAsDouble(*key);
+      if (!value || !(*value >= 0.0)) {
+        throw std::invalid_argument("Surrogate ridge must be a non-negative number");
+      }
+      spec.ridge = *value;
+    } else {
+      sampling.putProperty(*key, *props.getProperty(*key));
+    }
+  }
+  spec.sampling = SweepSpec::read(sampling);
+  if (spec.sampling.method == "factorial") {
+    throw std::invalid_argument("A surrogate samples the ranges of its properties; use lhs, sobol or halton");
+  }
+  return spec;
+}
+
+void SurrogatePrediction::write(std::ostream& out) const
+{
+  out << std::setprecision(10);
+  out << "Month,EndUse,Value,Error\n";
+  for (std::size_t output = 0; output < values.size(); ++output) {
+    writeOutputName(out, output);
+    out << "," << values[output] << "," << errors[output] << "\n";
+  }
+  out.flush();
+}
+
+void SurrogateValidation::write(std::ostream& out) const
+{
+  out << std::setprecision(10);
+  out << "Points," << points << "\n";
+  out << "Failures," << failures << "\n";
+  out << "SimulateSeconds," << simulateSeconds << "\n";
+  out << "PredictSeconds," << predictSeconds << "\n";
+  out << "PredictOutputSeconds," << predictOutputSeconds << "\n";
+  out << "Speedup," << (predictSeconds > 0 ? simulateSeconds / predictSeconds : 0.0) << "\n\n";
+  out << "Month,EndUse,Rmse,MaxError,Coverage\n";
+  for (std::size_t output = 0; output < rmse.size(); ++output) {
+    writeOutputName(out, output);
+    out << "," << rmse[output] << "," << maxError[output] << "," << coverage[output] << "\n";
+  }
+  out.flush();
+}
+
+Surrogate Surrogate::train(const ParametricSweep& sweep, const SurrogateSpec& spec)
+{
+  const auto& sampling = spec.sampling;
+  if (sampling.properties.empty()) {
+    throw std::invalid_argument("A surrogate needs at least one property to vary");
+  }
+  if (sampling.method == "factorial") {
+    throw std::invalid_argument("A surrogate samples the ranges of its properties; use lhs, sobol or halton");
+  }
+
+  Surrogate surrogate;
+  surrogate.m_properties = sampling.properties;
+  for (const auto& range : sampling.values) {
+    surrogate.m_low.push_back(range[0]);
+    surrogate.m_high.push_back(range[1]);
+  }
+  surrogate.m_hourly = sampling.hourly;
+  surrogate.m_degree = spec.degree;
+  surrogate.m_terms = totalDegreeTerms(sampling.properties.size(), spec.degree);
+  auto terms = surrogate.m_terms.size() / sampling.properties.size();
+
+  // Run the sample.
+  auto points = sampling.variants();
+  std::vector<std::vector<double> > results(points.size());
+  std::vector<std::function<void()> > tasks;
+  for (std::size_t i = 0; i < points.size(); ++i) {
+    tasks.push_back([&, i]() {
+      try {
+        results[i] = outputsOf(sweep.simulate(sampling.properties, points[i], sampling.hourly, &sampling.cancellation));
+      } catch (const std::exception&) {
+        // Failed runs are left out of the fit.
+      }
+    });
+  }
+  WorkStealingPool pool(sampling.threads);
+  pool.run(tasks);
+
+  // The design matrix of the runs that succeeded.
+  std::vector<double> design, scratch(2 * terms + sampling.properties.size() * (spec.degree + 1));
+  std::vector<std::size_t> kept;
+  for (std::size_t i = 0; i < points.size(); ++i) {
+    if (!results[i].empty()) {
+      kept.push_back(i);
+      surrogate.evaluateBasis(points[i].data(), scratch.data());
+      design.insert(design.end(), scratch.begin(), scratch.begin() + terms);
+    }
+  }
+  auto n = kept.size();
+  if (n <= terms) {
+    throw std::runtime_error("A surrogate with " + std::to_string(terms) + " terms needs more than " + std::to_string(terms) +
+                             " runs, and " + std::to_string(n) + " succeeded");
+  }
+  surrogate.m_samples = n;
+
+  // The normal equations, regularized, and their Cholesky factor.
+  std::vector<double> normal(terms * terms, 0.0);
+  for (std::size_t r = 0; r < n; ++r) {
+    const auto* row = &design[r * terms];
+    for (std::size_t a = 0; a < terms; ++a) {
+      for (std::size_t b = 0; b <= a; ++b) {
+        normal[a * terms + b] += row[a] * row[b];
+      }
+    }
+  }
+  auto trace = 0.0;
+  for (std::size_t a = 0; a < terms; ++a) {
+    trace += normal[a * terms + a];
+  }
+  for (std::size_t a = 0; a < terms; ++a) {
+    normal[a * terms + a] += spec.ridge * trace / terms;
+  }
+  auto& cholesky = surrogate.m_cholesky;
+  cholesky.assign(terms * (terms + 1) / 2, 0.0);
+  auto at = [](std::size_t a, std::size_t b) { return a * (a + 1) / 2 + b; };
+  for (std::size_t a = 0; a < terms; ++a) {
+    for (std::size_t b = 0; b <= a; ++b) {
+      auto sum = normal[a * terms + b];
+      for (std::size_t k = 0; k < b; ++k) {
+        sum -= cholesky[at(a, k)] * cholesky[at(b, k)];
+      }
+      if (a == b) {
+        if (!(sum > 0.0)) {
+          throw std::runtime_error("The surrogate's sample doesn't determine its polynomials; use more samples or a lower degree");
+        }
+        cholesky[at(a, a)] = std::sqrt(sum);
+      } else {
+        cholesky[at(a, b)] = sum / cholesky[at(b, b)];
+      }
+    }
+  }
+
+  // Solve for every output's coefficients with the one factor.
+  auto& coefficients = surrogate.m_coefficients;
+  coefficients.assign(terms * coefficientStride, 0.0);
+  std::vector<double> rhs(terms);
+  for (std::size_t output = 0; output < outputs; ++output) {
+    std::fill(rhs.begin(), rhs.end(), 0.0);
+    for (std::size_t r = 0; r < n; ++r) {
+      auto y = results[kept[r]][output];
+      for (std::size_t a = 0; a < terms; ++a) {
+        rhs[a] += design[r * terms + a] * y;
+      }
+    }
+    for (std::size_t a = 0; a < terms; ++a) {
+      for (std::size_t k = 0; k < a; ++k) {
+        rhs[a] -= cholesky[at(a, k)] * rhs[k];
+      }
+      rhs[a] /= cholesky[at(a, a)];
+    }
+    for (std::size_t a = terms; a-- > 0;) {
+      for (std::size_t k = a + 1; k < terms; ++k) {
+        rhs[a] -= cholesky[at(k, a)] * rhs[k];
+      }
+      rhs[a] /= cholesky[at(a, a)];
+    }
+    for (std::size_t a = 0; a < terms; ++a) {
+      coefficients[a * coefficientStride + output] = rhs[a];
+    }
+  }
+
+  // Residual and leave-one-out errors. Removing run r changes its residual
+  // to residual / (1 - h_r), with h_r its leverage.
+  std::vector<double> squares(outputs, 0.0), looSquares(outputs, 0.0);
+  for (std::size_t r = 0; r < n; ++r) {
+    const auto* row = &design[r * terms];
+    auto h = std::min(surrogate.leverage(row, scratch.data()), 1.0 - 1e-12);
+    for (std::size_t output = 0; output < outputs; ++output) {
+      auto fitted = 0.0;
+      for (std::size_t a = 0; a < terms; ++a) {
+        fitted += coefficients[a * coefficientStride + output] * row[a];
+      }
+      auto residual = results[kept[r]][output] - fitted;
+      squares[output] += residual * residual;
+      looSquares[output] += residual * residual / ((1 - h) * (1 - h));
+    }
+  }
+  for (std::size_t output = 0; output < outputs; ++output) {
+    surrogate.m_residualError.push_back(std::sqrt(squares[output] / (n - terms)));
+    surrogate.m_looRmse.push_back(std::sqrt(looSquares[output] / n));
+  }
+  return surrogate;
+}
+
+void Surrogate::evaluateBasis(const double* x, double* scratch) const
+{
+  auto dimensions = m_properties.size();
+  auto* legendre = scratch + terms();
+  auto stride = m_degree + 1;
+  for (std::size_t d = 0; d < dimensions; ++d) {
+    // Orthonormal Legendre polynomials of x mapped onto [-1, 1].
+    auto xi = 2.0 * (x[d] - m_low[d]) / (m_high[d] - m_low[d]) - 1.0;
+    auto* p = legendre + d * stride;
+    p[0] = 1.0;
+    if (m_degree > 0) {
+      p[1] = xi;
+    }
+    for (std::size_t k = 1; k < m_degree; ++k) {
+      p[k + 1] = ((2 * k + 1) * xi * p[k] - k * p[k - 1]) / (k + 1);
+    }
+    for (std::size_t k = 1; k <= m_degree; ++k) {
+      p[k] *= std::sqrt(2.0 * k + 1.0);
+    }
+  }
+  for (std::size_t t = 0; t < terms(); ++t) {
+    auto value = 1.0;
+    const auto* degrees = &m_terms[t * dimensions];
+    for (std::size_t d = 0; d < dimensions; ++d) {
+      value *= legendre[d * stride + degrees[d]];
+    }
+    scratch[t] = value;
+  }
+}
+
+double Surrogate::leverage(const double* basis, double* scratch) const
+{
+  // h = |L^-1 basis|^2
+  auto h = 0.0;
+  for (std::size_t a = 0, row = 0; a < terms(); row += ++a) {
+    auto z = basis[a];
+    for (std::size_t k = 0; k < a; ++k) {
+      z -= m_cholesky[row + k] * scratch[k];
+    }
+    z /= m_cholesky[row + a];
+    scratch[a] = z;
+    h += z * z;
+  }
+  return h;
+}
+
+void Surrogate::predict(const double* x, double* scratch, double* values, double* errors) const
+{
+  evaluateBasis(x, scratch);
+  auto n = terms();
+  // A block of outputs at a time, summed in registers over the terms; each
+  // term's coefficients for the block are contiguous, so this vectorizes.
+  for (std::size_t block = 0; block < coefficientStride; block += 4) {
+    double sums[4] = {};
+    for (std::size_t a = 0; a < n; ++a) {
+      const auto* coefficients = &m_coefficients[a * coefficientStride + block];
+      auto basis = scratch[a];
+      for (std::size_t j = 0; j < 4; ++j) {
+        sums[j] += coefficients[j] * basis;
+      }
+    }
+    for (std::size_t j = 0; j < 4 && block + j < outputs; ++j) {
+      values[block + j] = sums[j];
+    }
+  }
+  if (errors) {
+    auto spread = std::sqrt(1.0 + leverage(scratch, scratch + n));
+    for (std::size_t output = 0; output < outputs; ++output) {
+      errors[output] = m_residualError[output] * spread;
+    }
+  }
+}
+
+double Surrogate::predict(const double* x, double* scratch, std::size_t output) const
+{
+  evaluateBasis(x, scratch);
+  auto n = terms();
+  auto value = 0.0;
+  for (std::size_t a = 0; a < n; ++a) {
+    value += m_coefficients[a * coefficientStride + output] * scratch[a];
+  }
+  return value;
+}
+
+SurrogatePrediction Surrogate::predict(const std::vector<double>& x) const
+{
+  if (x.size() != m_properties.size()) {
+    throw std::invalid_argument("The surrogate needs a value for each of its " + std::to_string(m_properties.size()) + " properties");
+  }
+  SurrogatePrediction prediction;
+  prediction.values.resize(outputs);
+  prediction.errors.resize(outputs);
+  std::vector<double> scratch(scratchSize());
+  predict(x.data(), scratch.data(), prediction.values.data(), prediction.errors.data());
+  return prediction;
+}
+
+SurrogateValidation Surrogate::validate(const ParametricSweep& sweep, std::size_t points, unsigned seed, std::size_t threads) const
+{
+  auto sample = latinHypercube(points, m_properties.size(), seed);
+  for (auto& point : sample) {
+    for (std::size_t d = 0; d < point.size(); ++d) {
+      point[d] = m_low[d] + point[d] * (m_high[d] - m_low[d]);
+    }
+  }
+
+  std::vector<std::vector<double> > actual(points);
+  std::vector<double> runSeconds(points, 0.0);
+  std::vector<std::function<void()> > tasks;
+  for (std::size_t i = 0; i < points; ++i) {
+    tasks.push_back([&, i]() {
+      auto start = std::chrono::steady_clock::now();
+      try {
+        actual[i] = outputsOf(sweep.simulate(m_properties, sample[i], m_hourly));
+      } catch (const std::exception&) {
+        // Counted as failures below.
+      }
+      runSeconds[i] = seconds(start);
+    });
+  }
+  WorkStealingPool pool(threads);
+  pool.run(tasks);
+
+  SurrogateValidation validation;
+  validation.points = points;
+  validation.rmse.assign(outputs, 0.0);
+  validation.maxError.assign(outputs, 0.0);
+  validation.coverage.assign(outputs, 0.0);
+  std::vector<double> scratch(scratchSize()), values(outputs), errors(outputs);
+  std::size_t compared = 0;
+  for (std::size_t i = 0; i < points; ++i) {
+    if (actual[i].empty()) {
+      ++validation.failures;
+      continue;
+    }
+    ++compared;
+    validation.simulateSeconds += runSeconds[i];
+    predict(sample[i].data(), scratch.data(), values.data(), errors.data());
+    for (std::size_t output = 0; output < outputs; ++output) {
+      auto error = std::abs(values[output] - actual[i][output]);
+      validation.rmse[output] += error * error;
+      validation.maxError[output] = std::max(validation.maxError[output], error);
+      validation.coverage[output] += error <= 2 * errors[output] ? 1.0 : 0.0;
+    }
+  }
+  for (std::size_t output = 0; output < outputs; ++output) {
+    validation.rmse[output] = std::sqrt(validation.rmse[output] / std::max<std::size_t>(1, compared));
+    validation.coverage[output] /= std::max<std::size_t>(1, compared);
+  }
+  validation.simulateSeconds /= std::max<std::size_t>(1, compared);
+
+  // Time the compact paths, of every output and of one, without errors over
+  // enough repeats to measure.
+  const std::size_t repeats = 1000;
+  auto start = std::chrono::steady_clock::now();
+  volatile double sink = 0.0;
+  for (std::size_t r = 0; r < repeats; ++r) {
+    for (const auto& point : sample) {
+      predict(point.data(), scratch.data(), values.data());
+      sink = sink + values[0];
+    }
+  }
+  validation.predictSeconds = points ? seconds(start) / (repeats * points) : 0.0;
+  start = std::chrono::steady_clock::now();
+  for (std::size_t r = 0; r < repeats; ++r) {
+    for (std::size_t i = 0; i < points; ++i) {
+      sink = sink + predict(sample[i].data(), scratch.data(), (r + i) % outputs);
+    }
+  }
+  validation.predictOutputSeconds = points ? seconds(start) / (repeats * points) : 0.0;
+  return validation;
+}
+
+void Surrogate::write(std::ostream& out) const
+{
+  out.write(surrogateMagic, sizeof(surrogateMagic));
+  writeRaw<std::uint32_t>(out, surrogateVersion);
+  writeRaw<std::uint32_t>(out, m_hourly ? 1 : 0);
+  writeRaw<std::uint32_t>(out, static_cast<std::uint32_t>(m_degree));
+  writeRaw<std::uint64_t>(out, m_samples);
+  writeRaw<std::uint32_t>(out, static_cast<std::uint32_t>(m_properties.size()));
+  for (std::size_t d = 0; d < m_properties.size(); ++d) {
+    writeRaw<std::uint32_t>(out, static_cast<std::uint32_t>(m_properties[d].size()));
+    out.write(m_properties[d].data(), m_properties[d].size());
+    writeRaw<double>(out, m_low[d]);
+    writeRaw<double>(out, m_high[d]);
+  }
+  writeRaw<std::uint64_t>(out, terms());
+  // Saved output by output, as before they were kept term by term.
+  auto n = terms();
+  std::vector<double> coefficients(outputs * n);
+  for (std::size_t a = 0; a < n; ++a) {
+    for (std::size_t output = 0; output < outputs; ++output) {
+      coefficients[output * n + a] = m_coefficients[a * coefficientStride + output];
+    }
+  }
+  writeDoubles(out, coefficients);
+  writeDoubles(out, m_cholesky);
+  writeDoubles(out, m_residualError);
+  writeDoubles(out, m_looRmse);
+}
+
+void Surrogate::write(const std::string& path) const
+{
+  std::ofstream out(path.c_str(), std::ios::binary);
+  if (!out) {
+    throw std::runtime_error("Could not open surrogate file " + path);
+  }
+  write(out);
+  if (!out) {
+    throw std::runtime_error("Could not write surrogate file " + path);
+  }
+}
+
+Surrogate Surrogate::read(std::istream& in)
+{
+  char magic[sizeof(surrogateMagic)];
+  if (!in.read(magic, sizeof(magic)) || std::memcmp(magic, surrogateMagic, sizeof(magic)) != 0) {
+    throw std::runtime_error("Not a surrogate file");
+  }
+  if (readRaw<std::uint32_t>(in) != surrogateVersion) {
+    throw std::runtime_error("Unsupported surrogate file version");
+  }
+
+  Surrogate surrogate;
+  surrogate.m_hourly = readRaw<std::uint32_t>(in) != 0;
+  surrogate.m_degree = readRaw<std::uint32_t>(in);
+  surrogate.m_samples = static_cast<std::size_t>(readRaw<std::uint64_t>(in));
+  auto dimensions = readRaw<std::uint32_t>(in);
+  if (dimensions == 0) {
+    throw std::runtime_error("Malformed surrogate file");
+  }
+  for (std::uint32_t d = 0; d < dimensions; ++d) {
+    auto length = readRaw<std::uint32_t>(in);
+    if (length > maxNameLength) {
+      throw std::runtime_error("Malformed surrogate file");
+    }
+    std::string name(length, '\0');
+    if (!name.empty() && !in.read(&name[0], name.size())) {
+      throw std::runtime_error("Unexpected end of surrogate file");
+    }
+    surrogate.m_properties.push_back(name);
+    surrogate.m_low.push_back(readRaw<double>(in));
+    surrogate.m_high.push_back(readRaw<double>(in));
+  }
+  try {
+    surrogate.m_terms = totalDegreeTerms(dimensions, surrogate.m_degree);
+  } catch (const std::invalid_argument&) {
+    throw std::runtime_error("Malformed surrogate file");
+  }
+  auto terms = surrogate.m_terms.size() / dimensions;
+  if (readRaw<std::uint64_t>(in) != terms) {
+    throw std::runtime_error("Malformed surrogate file");
+  }
+  std::vector<double> coefficients;
+  readDoubles(in, coefficients, outputs * terms);
+  surrogate.m_coefficients.assign(terms * coefficientStride, 0.0);
+  for (std::size_t a = 0; a < terms; ++a) {
+    for (std::size_t output = 0; output < outputs; ++output) {
+      surrogate.m_coefficients[a * coefficientStride + output] = coefficients[output * terms + a];
+    }
+  }
+  readDoubles(in, surrogate.m_cholesky, terms * (terms + 1) / 2);
+  readDoubles(in, surrogate.m_residualError, outputs);
+  readDoubles(in, surrogate.m_looRmse, outputs);
+  return surrogate;
+}
+
+Surrogate Surrogate::read(const std::string& path)
+{
+  std::ifstream in(path.c_str(), std::ios::binary);
+  if (!in) {
+    throw std::runtime_error("Could not open surrogate file " + path);
+  }
+  return read(in);
+}
+
+} // isomodel
+} // openstudio
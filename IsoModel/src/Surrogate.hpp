@@ -0,0 +1,194 @@
+#ifndef ISOMODEL_SURROGATE_HPP
+#define ISOMODEL_SURROGATE_HPP
+
+#include "ISOModelAPI.hpp"
+#include "ParametricSweep.hpp"
+#include "Properties.hpp"
+
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace openstudio {
+namespace isomodel {
+
+/**
+ * How a surrogate is trained. Read from a file in the SweepSpec format: the
+ * sampling method ("lhs", "sobol" or "halton"), samples, seed, engine,
+ * threads and the range "low, high" of each property. Two more keys
+ * configure the fit: degree (the total degree of the polynomials, 3 by
+ * default) and ridge (the regularization, relative to the mean diagonal of
+ * the normal equations, 1e-10 by default).
+ */
+struct ISOMODEL_API SurrogateSpec
+{
+  SweepSpec sampling;
+  std::size_t degree = 3;
+  double ridge = 1e-10;
+
+  /** Reads a spec from a file. Throws std::invalid_argument if it is malformed. */
+  static SurrogateSpec read(const std::string& path);
+
+  /** Reads a spec from parsed properties. Throws std::invalid_argument if it is malformed. */
+  static SurrogateSpec read(const Properties& props);
+};
+
+// A surrogate's answer at one point: each month's end uses and their year
+// totals, in kWh/m2, with the standard error of each.
+struct ISOMODEL_API SurrogatePrediction
+{
+  std::vector<double> values; // [period * 13 + end use], periods 0 to 11 the months and 12 the year.
+  std::vector<double> errors;
+
+  double endUse(std::size_t period, std::size_t use) const {
+    return values[period * 13 + use];
+  }
+  double error(std::size_t period, std::size_t use) const {
+    return errors[period * 13 + use];
+  }
+
+  /** Writes a CSV row per month and end use, and for the year, with the value and its error. */
+  void write(std::ostream& out) const;
+};
+
+// How well a surrogate matched runs of the real model at fresh points.
+struct ISOMODEL_API SurrogateValidation
+{
+  std::size_t points = 0;
+  std::size_t failures = 0; // Runs of the real model that failed.
+  double simulateSeconds = 0; // Wall time of a run of the real model, on average.
+  double predictSeconds = 0; // Wall time of a prediction of every output without errors, on average.
+  double predictOutputSeconds = 0; // Wall time of a prediction of one output, on average.
+  // By output, in the order of SurrogatePrediction::values.
+  std::vector<double> rmse;
+  std::vector<double> maxError;
+  std::vector<double> coverage; // The fraction of points within two standard errors.
+
+  /** Writes a CSV report: the summary, then the errors of each output. */
+  void write(std::ostream& out) const;
+};
+
+/**
+ * A polynomial chaos expansion of a building's monthly end uses over a box of
+ * its properties, answering in microseconds what the engines take
+ * milliseconds to compute. With 4 properties at degree 3 (35 terms) one
+ * output takes about 0.2 microseconds and all 169 about 2, or about 3 with
+ * their errors, which need the leverage of the point, O(terms^2).
+ *
+ * Training runs the base building at a sample of the box in parallel (see
+ * ParametricSweep) and fits, by least squares, one expansion in orthonormal
+ * Legendre polynomials of total degree at most spec.degree for each end use
+ * of each month and of the year. The outputs share one design matrix, so a
+ * single Cholesky factorization fits them all. The standard error of a
+ * prediction is the output's residual standard error times
+ * sqrt(1 + h(x)), where h(x) is the leverage of the point; the leave-one-out
+ * error of each output is kept too. Points outside the box are extrapolated,
+ * and their errors mean little.
+ *
+ * A surrogate is saved as a small binary file: its properties and ranges,
+ * the coefficients and the Cholesky factor.
+ */
+class ISOMODEL_API Surrogate
+{
+public:
+  static const std::size_t outputs = 13 * 13; // 12 months and the year, 13 end uses each.
+
+  /**
+   * Fits a surrogate to runs of sweep's base building. Runs that fail, or are
+   * cancelled by spec.sampling.cancellation, are left out. Throws
+   * std::invalid_argument if the spec is malformed, or std::runtime_error if
+   * fewer runs succeed than the expansion has terms.
+   */
+  static Surrogate train(const ParametricSweep& sweep, const SurrogateSpec& spec);
+
+  /** Reads a surrogate written by write(). Throws std::runtime_error on malformed input. */
+  static Surrogate read(std::istream& in);
+  static Surrogate read(const std::string& path);
+
+  void write(std::ostream& out) const;
+  void write(const std::string& path) const;
+
+  const std::vector<std::string>& properties() const {
+    return m_properties;
+  }
+  const std::vector<double>& low() const {
+    return m_low;
+  }
+  const std::vector<double>& high() const {
+    return m_high;
+  }
+  bool hourly() const {
+    return m_hourly;
+  }
+  std::size_t degree() const {
+    return m_degree;
+  }
+  /** The number of polynomials in each expansion. */
+  std::size_t terms() const {
+    return m_properties.empty() ? 0 : m_terms.size() / m_properties.size();
+  }
+  /** The number of runs it was fitted to. */
+  std::size_t samples() const {
+    return m_samples;
+  }
+  /** The leave-one-out RMS error of each output over the training runs. */
+  const std::vector<double>& looRmse() const {
+    return m_looRmse;
+  }
+
+  /**
+   * Every output at the point x, one value per property, with standard
+   * errors. Throws std::invalid_argument if x has the wrong size.
+   */
+  SurrogatePrediction predict(const std::vector<double>& x) const;
+
+  /** The number of doubles of scratch space the compact inference path needs. */
+  std::size_t scratchSize() const {
+    return 2 * terms() + m_properties.size() * (m_degree + 1);
+  }
+
+  /**
+   * The compact inference path: writes every output at x, which holds
+   * properties().size() values, to values (outputs doubles), and their
+   * standard errors to errors (outputs doubles) unless it is null, which
+   * saves the leverage solve. scratch must hold scratchSize() doubles.
+   * Allocates nothing and is safe to call from several threads with their
+   * own buffers.
+   */
+  void predict(const double* x, double* scratch, double* values, double* errors = nullptr) const;
+
+  /** One output at x, without its error; scratch as above. */
+  double predict(const double* x, double* scratch, std::size_t output) const;
+
+  /**
+   * Compares the surrogate to runs of sweep's base building, which must be
+   * the building it was trained on, at points of a Latin hypercube sample of
+   * its box.
+   */
+  SurrogateValidation validate(const ParametricSweep& sweep, std::size_t points, unsigned seed, std::size_t threads = 0) const;
+
+private:
+  Surrogate() = default;
+
+  // Writes the terms() polynomials at x to scratch, using the scratch after them.
+  void evaluateBasis(const double* x, double* scratch) const;
+  // h(x) of the polynomials at x, using terms() doubles of scratch after them.
+  double leverage(const double* basis, double* scratch) const;
+
+  std::vector<std::string> m_properties;
+  std::vector<double> m_low;
+  std::vector<double> m_high;
+  bool m_hourly = false;
+  std::size_t m_degree = 0;
+  std::size_t m_samples = 0;
+  std::vector<unsigned> m_terms; // The degree of each property in each polynomial, [term * properties + property].
+  std::vector<double> m_coefficients; // [term * stride + output], the stride outputs rounded up to a multiple of 4.
+  std::vector<double> m_cholesky; // The lower triangle of the regularized normal matrix's factor, by rows.
+  std::vector<double> m_residualError; // By output.
+  std::vector<double> m_looRmse; // By output.
+};
+
+} // isomodel
+} // openstudio
+#endif // ISOMODEL_SURROGATE_HPP
@@ -0,0 +1,116 @@
+/*
+ * BatchJournal_GTest.cpp
+ */
+
+#include "gtest/gtest.h"
+
+#include "ISOModelFixture.hpp"
+
+#include "../BatchJournal.hpp"
+#include "../BatchRunner.hpp"
+
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#include <boost/filesystem.hpp>
+
+using namespace openstudio::isomodel;
+using namespace openstudio;
+
+namespace {
+
+std::string readFile(const std::string& path)
+{
+  std::ifstream in(path, std::ios::binary);
+  std::stringstream contents;
+  contents << in.rdbuf();
+  return contents.str();
+}
+
+} // namespace
+
+TEST_F(ISOModelFixture, BatchJournalResumesRuns)
+{
+  auto ismPath = test_data_path + "/SmallOffice_v2.ism";
+  std::vector<BatchJob> jobs(6);
+  for (auto& job : jobs) {
+    job.ismPath = ismPath;
+  }
+  jobs[1].hourly = true;
+  jobs[4].ismPath = test_data_path + "/missing.ism";
+
+  BatchSettings settings;
+  settings.threads = 2;
+  std::ostringstream expected;
+  BatchRunner::writeHeader(expected);
+  BatchRunner(settings).run(jobs, expected);
+
+  auto directory = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("isomodel-journal-%%%%-%%%%");
+  boost::filesystem::create_directories(directory);
+  auto outputPath = (directory / "results.csv").string();
+  auto journalPath = (directory / "results.journal").string();
+
+  auto report = BatchRunner(settings).run(jobs, outputPath, journalPath);
+  EXPECT_EQ(expected.str(), readFile(outputPath));
+  EXPECT_EQ(0u, report.resumed);
+  EXPECT_EQ(5u, report.succeeded);
+  ASSERT_EQ(1u, report.failures.size());
+
+  // Everything is recorded, so nothing is run again.
+  report = BatchRunner(settings).run(jobs, outputPath, journalPath);
+  EXPECT_EQ(expected.str(), readFile(outputPath));
+  EXPECT_EQ(6u, report.resumed);
+  EXPECT_EQ(5u, report.succeeded);
+  ASSERT_EQ(1u, report.failures.size());
+  EXPECT_EQ(jobs[4].ismPath, report.failures[0].first);
+
+  // A crash after three jobs, part way through writing the journal and the
+  // output.
+  std::istringstream journal(readFile(journalPath));
+  std::string line, kept;
+  for (int i = 0; i < 4 && std::getline(journal, line); ++i) {
+    kept += line + "\n";
+  }
+  std::getline(journal, line);
+  {
+    std::ofstream torn(journalPath, std::ios::binary | std::ios::trunc);
+    torn << kept << line.substr(0, line.size() / 2);
+    std::ofstream output(outputPath, std::ios::binary | std::ios::app);
+    output << "a partial row";
+  }
+  report = BatchRunner(settings).run(jobs, outputPath, journalPath);
+  EXPECT_EQ(expected.str(), readFile(outputPath));
+  EXPECT_EQ(3u, report.resumed);
+  EXPECT_EQ(5u, report.succeeded);
+  EXPECT_EQ(1u, report.failures.size());
+  // The torn entry was cut off before the rest were appended.
+  {
+    BatchJournal reopened(journalPath);
+    EXPECT_EQ(jobs.size(), reopened.resume(jobs).size());
+  }
+
+  // A cancelled run records nothing past the first cancelled job.
+  boost::filesystem::remove(journalPath);
+  // Copies of a token share its state, so give this run its own.
+  BatchSettings cancelled = settings;
+  cancelled.cancellation = CancellationToken();
+  cancelled.cancellation.cancel();
+  report = BatchRunner(cancelled).run(jobs, outputPath, journalPath);
+  EXPECT_EQ(6u, report.cancelled);
+  {
+    BatchJournal reopened(journalPath);
+    EXPECT_TRUE(reopened.resume(jobs).empty());
+  }
+  report = BatchRunner(settings).run(jobs, outputPath, journalPath);
+  EXPECT_EQ(expected.str(), readFile(outputPath));
+  EXPECT_EQ(0u, report.resumed);
+
+  // A journal for a different batch is refused.
+  std::swap(jobs[0], jobs[1]);
+  EXPECT_THROW(BatchRunner(settings).run(jobs, outputPath, journalPath), std::runtime_error);
+  std::ofstream(outputPath + ".other") << "not a journal\n";
+  EXPECT_THROW(BatchJournal(outputPath + ".other"), std::runtime_error);
+
+  boost::filesystem::remove_all(directory);
+}
@@ -0,0 +1,141 @@
+/*
+ * BatchRunner_GTest.cpp
+ */
+
+#include "gtest/gtest.h"
+
+#include "ISOModelFixture.hpp"
+
+#include "../BatchRunner.hpp"
+#include "../UserModel.hpp"
+#include "../WorkStealingPool.hpp"
+
+#include <atomic>
+#include <cmath>
+#include <functional>
+#include <sstream>
+#include <stdexcept>
+
+using namespace openstudio::isomodel;
+using namespace openstudio;
+
+TEST_F(ISOModelFixture, OrderedWriterWritesInIndexOrder)
+{
+  std::ostringstream out;
+  OrderedWriter writer(out);
+  writer.write(2, "c");
+  writer.write(1, "b");
+  EXPECT_EQ("", out.str());
+  writer.write(0, "a");
+  EXPECT_EQ("abc", out.str());
+  EXPECT_EQ(3u, writer.next());
+}
+
+TEST_F(ISOModelFixture, WorkStealingPoolRunsEveryTask)
+{
+  WorkStealingPool pool(3);
+  std::atomic<int> total(0);
+  std::vector<std::function<void()> > tasks;
+  for (int i = 1; i <= 100; ++i) {
+    tasks.push_back([&total, i]() { total += i; });
+  }
+  pool.run(tasks);
+  EXPECT_EQ(5050, total.load());
+
+  tasks.clear();
+  tasks.push_back([]() { throw std::runtime_error("failed"); });
+  tasks.push_back([&total]() { total = 0; });
+  EXPECT_THROW(pool.run(tasks), std::runtime_error);
+  EXPECT_EQ(0, total.load());
+}
+
+TEST_F(ISOModelFixture, BatchManifestAssignsEngines)
+{
+  std::istringstream manifest("# buildings\n\nSmallOffice_v2.ism hourly\n  SmallOffice_v2.ism\n");
+  auto jobs = readBatchManifest(manifest, test_data_path, false);
+  ASSERT_EQ(2u, jobs.size());
+  EXPECT_TRUE(jobs[0].hourly);
+  EXPECT_FALSE(jobs[1].hourly);
+
+  std::istringstream bad("SmallOffice_v2.ism daily\n");
+  EXPECT_THROW(readBatchManifest(bad, test_data_path, false), std::invalid_argument);
+
+  auto matches = expandIsmPaths(test_data_path + "/SmallOffice_v?.ism");
+  ASSERT_EQ(1u, matches.size());
+  EXPECT_EQ(test_data_path + "/SmallOffice_v2.ism", matches[0]);
+}
+
+TEST_F(ISOModelFixture, BatchRunnerMatchesSingleRuns)
+{
+  auto ismPath = test_data_path + "/SmallOffice_v2.ism";
+  std::vector<BatchJob> jobs(4);
+  jobs[0].ismPath = ismPath;
+  jobs[0].hourly = true;
+  jobs[1].ismPath = test_data_path + "/missing.ism";
+  jobs[2].ismPath = ismPath;
+  jobs[3].ismPath = ismPath;
+
+  BatchSettings settings;
+  settings.threads = 2;
+  settings.monthlyGrain = 1;
+  BatchRunner runner(settings);
+  std::ostringstream out;
+  auto report = runner.run(jobs, out);
+
+  EXPECT_EQ(3u, report.succeeded);
+  ASSERT_EQ(1u, report.failures.size());
+  EXPECT_EQ(jobs[1].ismPath, report.failures[0].first);
+  EXPECT_EQ(1u, report.weatherFiles);
+
+  UserModel userModel;
+  userModel.load(ismPath);
+  auto hourly = userModel.toHourlyModel().simulate(true);
+  auto monthly = userModel.toMonthlyModel().simulate();
+
+  std::istringstream rows(out.str());
+  std::string row;
+  for (int job = 0; job < 3; ++job) {
+    auto& expected = job == 0 ? hourly : monthly;
+    for (int month = 0; month < 12; ++month) {
+      ASSERT_TRUE(std::getline(rows, row).good());
+      std::istringstream fields(row);
+      std::string field;
+      std::getline(fields, field, ',');
+      EXPECT_EQ(ismPath, field);
+      std::getline(fields, field, ',');
+      EXPECT_EQ(job == 0 ? "hourly" : "monthly", field);
+      std::getline(fields, field, ',');
+      EXPECT_EQ(month + 1, std::stoi(field));
+      for (int i = 0; i < 13; ++i) {
+        std::getline(fields, field, ',');
+        EXPECT_NEAR(expected[month].getEndUse(i), std::stod(field), 1e-8 * (1.0 + std::fabs(expected[month].getEndUse(i))));
+      }
+    }
+  }
+  EXPECT_FALSE(std::getline(rows, row).good());
+}
+
+TEST_F(ISOModelFixture, WeatherCacheSharesWeather)
+{
+  auto cache = std::make_shared<WeatherCache>();
+  UserModel first;
+  first.setWeatherCache(cache);
+  first.load(test_data_path + "/SmallOffice_v2.ism");
+  UserModel second;
+  second.setWeatherCache(cache);
+  second.load(test_data_path + "/SmallOffice_v2.ism");
+
+  EXPECT_EQ(1u, cache->size());
+  EXPECT_EQ(first.weatherData(), second.weatherData());
+  EXPECT_EQ(first.epwData(), second.epwData());
+
+  UserModel uncached;
+  uncached.load(test_data_path + "/SmallOffice_v2.ism");
+  auto cachedResults = second.toMonthlyModel().simulate();
+  auto uncachedResults = uncached.toMonthlyModel().simulate();
+  for (int month = 0; month < 12; ++month) {
+    for (int i = 0; i < 13; ++i) {
+      EXPECT_EQ(uncachedResults[month].getEndUse(i), cachedResults[month].getEndUse(i));
+    }
+  }
+}
@@ -0,0 +1,136 @@
+/*
+ * Calibration_GTest.cpp
+ */
+
+#include "gtest/gtest.h"
+
+#include "ISOModelFixture.hpp"
+
+#include "../Calibration.hpp"
+#include "../ParametricSweep.hpp"
+
+#include <cmath>
+#include <sstream>
+#include <stdexcept>
+
+using namespace openstudio::isomodel;
+using namespace openstudio;
+
+namespace {
+
+// A spec fitting two properties to the base building's own results with
+// them set to the given values.
+CalibrationSpec syntheticSpec(const std::string& ismPath, double cop, double lighting)
+{
+  CalibrationSpec spec;
+  spec.properties = { "coolingsystemcop", "lightingpowerdensityoccupied" };
+  spec.low = { 2.0, 4.0 };
+  spec.high = { 5.0, 14.0 };
+
+  ParametricSweep sweep(ismPath);
+  Calibration::fuelTotals(sweep.simulate(spec.properties, { cop, lighting }, false), spec.electricity, spec.gas);
+  return spec;
+}
+
+} // namespace
+
+TEST_F(ISOModelFixture, FitStatisticsFollowGuideline14)
+{
+  std::vector<double> measured(12, 10.0), simulated(12, 10.0);
+  auto fit = FitStatistics::compute(measured, std::vector<double>(), simulated, std::vector<double>());
+  EXPECT_EQ(0.0, fit.objective);
+
+  simulated[0] = 8.0;
+  simulated[1] = 13.0;
+  fit = FitStatistics::compute(measured, std::vector<double>(), simulated, std::vector<double>());
+  EXPECT_NEAR(std::sqrt(13.0 / 11.0) / 10.0, fit.electricityCvRmse, 1e-12);
+  EXPECT_NEAR(-1.0 / 110.0, fit.electricityNmbe, 1e-12);
+  EXPECT_NEAR(fit.electricityCvRmse * fit.electricityCvRmse + fit.electricityNmbe * fit.electricityNmbe, fit.objective, 1e-15);
+  EXPECT_EQ(0.0, fit.gasCvRmse);
+
+  EXPECT_THROW(FitStatistics::compute(measured, std::vector<double>(), std::vector<double>(3, 1.0), std::vector<double>()),
+               std::invalid_argument);
+}
+
+TEST_F(ISOModelFixture, CalibrationSpecReadsMeteredData)
+{
+  Properties props;
+  props.putProperty("method", "MCMC");
+  props.putProperty("units", "kWh");
+  props.putProperty("chains", "3");
+  props.putProperty("electricity", "1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12");
+  props.putProperty("coolingSystemCOP", "2.5, 4");
+  auto spec = CalibrationSpec::read(props);
+  EXPECT_EQ("mcmc", spec.method);
+  EXPECT_FALSE(spec.perArea);
+  EXPECT_EQ(3u, spec.chains);
+  EXPECT_EQ(12u, spec.electricity.size());
+  EXPECT_TRUE(spec.gas.empty());
+  ASSERT_EQ(1u, spec.properties.size());
+  EXPECT_DOUBLE_EQ(4.0, spec.high[0]);
+
+  props.putProperty("gas", "1, 2, 3");
+  EXPECT_THROW(CalibrationSpec::read(props), std::invalid_argument);
+  props.putProperty("gas", "1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12");
+  props.putProperty("coolingSystemCOP", "4, 2.5");
+  EXPECT_THROW(CalibrationSpec::read(props), std::invalid_argument);
+}
+
+TEST_F(ISOModelFixture, NelderMeadCalibrationRecoversProperties)
+{
+  auto ismPath = test_data_path + "/SmallOffice_v2.ism";
+  auto spec = syntheticSpec(ismPath, 3.7, 9.0);
+  spec.threads = 2;
+  spec.tolerance = 1e-14;
+
+  Calibration calibration(ismPath);
+  auto before = calibration.evaluate(spec, { 3.0, 6.0 }, false);
+  EXPECT_GT(before.objective, 1e-4);
+
+  auto result = calibration.run(spec);
+  EXPECT_TRUE(result.converged);
+  EXPECT_LT(result.fit.objective, 1e-8);
+  EXPECT_NEAR(3.7, result.values[0], 0.05);
+  EXPECT_NEAR(9.0, result.values[1], 0.05);
+  ASSERT_FALSE(result.history.empty());
+  EXPECT_LE(result.history.back().objective, result.history.front().objective);
+  EXPECT_GT(result.evaluations, result.history.size());
+
+  std::ostringstream report;
+  result.write(report);
+  EXPECT_EQ(0u, report.str().find("Method,neldermead\nConverged,true\n"));
+}
+
+TEST_F(ISOModelFixture, McmcCalibrationReportsDiagnostics)
+{
+  auto ismPath = test_data_path + "/SmallOffice_v2.ism";
+  auto spec = syntheticSpec(ismPath, 3.7, 9.0);
+  spec.method = "mcmc";
+  spec.iterations = 1000;
+  spec.chains = 3;
+  spec.step = 0.05;
+  spec.noise = 0.01;
+  spec.seed = 4;
+
+  Calibration calibration(ismPath);
+  spec.threads = 1;
+  auto serial = calibration.run(spec);
+  spec.threads = 3;
+  auto parallel = calibration.run(spec);
+
+  EXPECT_EQ(serial.values, parallel.values);
+  EXPECT_EQ(serial.posteriorMean, parallel.posteriorMean);
+  ASSERT_EQ(3u, serial.acceptanceRates.size());
+  ASSERT_EQ(2u, serial.rHat.size());
+  for (auto rate : serial.acceptanceRates) {
+    EXPECT_GT(rate, 0.0);
+    EXPECT_LT(rate, 1.0);
+  }
+  EXPECT_GE(serial.rHat[1], 0.9);
+  EXPECT_GT(serial.secondsPerIteration, 0.0);
+
+  // The lighting power is well identified by the electricity use.
+  EXPECT_NEAR(9.0, serial.posteriorMean[1], 1.0);
+  EXPECT_LT(serial.posteriorStdDev[1], 0.5);
+  EXPECT_LT(serial.fit.objective, 1e-3);
+}
@@ -0,0 +1,243 @@
+/*
+ * Cancellation_GTest.cpp
+ */
+
+#include "gtest/gtest.h"
+
+#include "ISOModelFixture.hpp"
+
+#include "../BatchRunner.hpp"
+#include "../Calibration.hpp"
+#include "../Cancellation.hpp"
+#include "../MonteCarlo.hpp"
+#include "../ParametricSweep.hpp"
+#include "../PipelinedBatchRunner.hpp"
+#include "../SimulationServer.hpp"
+#include "../UserModel.hpp"
+
+#include <sstream>
+#include <stdexcept>
+
+using namespace openstudio::isomodel;
+using namespace openstudio;
+
+TEST_F(ISOModelFixture, CancellationTokenSharesItsState)
+{
+  CancellationToken token;
+  auto copy = token;
+  EXPECT_FALSE(token.cancelled());
+  EXPECT_NO_THROW(token.throwIfCancelled());
+  copy.cancel();
+  EXPECT_TRUE(token.cancelled());
+
+  try {
+    token.throwIfCancelled(48, 8760);
+    FAIL() << "Expected SimulationCancelled";
+  } catch (const SimulationCancelled& e) {
+    EXPECT_EQ(48u, e.completed());
+    EXPECT_EQ(8760u, e.total());
+    EXPECT_EQ(std::string("Cancelled after 48 of 8760 hours"), e.what());
+  }
+  EXPECT_EQ(std::string("Cancelled before starting"), SimulationCancelled().what());
+
+  CancellationToken deadline;
+  deadline.cancelAfter(3600);
+  EXPECT_FALSE(deadline.cancelled());
+  deadline.cancelAfter(0);
+  EXPECT_TRUE(deadline.cancelled());
+}
+
+namespace {
+// An HourlyModel that cancels its token, or expires its deadline, once the
+// run reaches a given hour. Its ventilation schedule is replaced, which
+// doesn't matter to where the run stops.
+class CancellingHourlyModel : public HourlyModel
+{
+public:
+  CancellingHourlyModel(const HourlyModel& model, int cancelAtHour) : HourlyModel(model), cancelAtHour(cancelAtHour) {}
+
+  CancellationToken token;
+  bool deadline = false;
+
+private:
+  double ventilationSchedule(int hourOfYear, int /*hourOfDay*/, int /*scheduleOffset*/) override {
+    if (hourOfYear == cancelAtHour) {
+      if (deadline) {
+        token.cancelAfter(0);
+      } else {
+        token.cancel();
+      }
+    }
+    return 0.0;
+  }
+
+  int cancelAtHour;
+};
+}
+
+TEST_F(ISOModelFixture, HourlyModelStopsWhenCancelled)
+{
+  UserModel umodel;
+  umodel.load(test_data_path + "/SmallOffice_v2.ism");
+  ASSERT_TRUE(umodel.valid());
+
+  auto model = umodel.toHourlyModel();
+  EXPECT_THROW(model.setCancellation(CancellationToken(), 0), std::invalid_argument);
+
+  // An uncancelled token doesn't change the results.
+  CancellationToken token;
+  model.setCancellation(token);
+  HourlyCheckpoints checkpoints;
+  auto results = model.simulate(true, checkpoints);
+  auto expected = umodel.toHourlyModel().simulate(true);
+  for (std::size_t month = 0; month < expected.size(); ++month) {
+    for (int i = 0; i < 13; ++i) {
+      EXPECT_EQ(expected[month].getEndUse(i), results[month].getEndUse(i));
+    }
+  }
+
+  // Cancelled partway through, the run stops at the next poll.
+  CancellingHourlyModel cancelling(umodel.toHourlyModel(), 1000);
+  for (auto interval : { 24, 100 }) {
+    cancelling.token = CancellationToken();
+    cancelling.setCancellation(cancelling.token, interval);
+    try {
+      cancelling.simulate(true);
+      FAIL() << "Expected SimulationCancelled";
+    } catch (const SimulationCancelled& e) {
+      // Hour 1000 is the 1000th hour, index 999. The polls are at the
+      // multiples of interval.
+      EXPECT_EQ(interval == 24 ? 1008u : 1000u, e.completed());
+      EXPECT_EQ(8760u, e.total());
+    }
+  }
+
+  // A deadline that passes partway through stops the run at the next poll
+  // the same way.
+  cancelling.token = CancellationToken();
+  cancelling.deadline = true;
+  cancelling.setCancellation(cancelling.token, 24);
+  try {
+    cancelling.simulate(true);
+    FAIL() << "Expected SimulationCancelled";
+  } catch (const SimulationCancelled& e) {
+    EXPECT_EQ(1008u, e.completed());
+  }
+
+  // A deadline that has already passed stops the run before its first hour.
+  CancellationToken expired;
+  expired.cancelAfter(0);
+  model.setCancellation(expired);
+  try {
+    model.simulate(true);
+    FAIL() << "Expected SimulationCancelled";
+  } catch (const SimulationCancelled& e) {
+    EXPECT_EQ(0u, e.completed());
+  }
+
+  // Cancelled before it starts, the run stops at once.
+  model.setCancellation(token);
+  token.cancel();
+  try {
+    model.simulate(true);
+    FAIL() << "Expected SimulationCancelled";
+  } catch (const SimulationCancelled& e) {
+    EXPECT_EQ(0u, e.completed());
+  }
+}
+
+TEST_F(ISOModelFixture, BatchRunnersSkipCancelledJobs)
+{
+  std::vector<BatchJob> jobs(3);
+  for (auto& job : jobs) {
+    job.ismPath = test_data_path + "/SmallOffice_v2.ism";
+  }
+  jobs[1].hourly = true;
+
+  BatchSettings settings;
+  settings.threads = 2;
+  settings.cancellation.cancel();
+  std::ostringstream out;
+  auto report = BatchRunner(settings).run(jobs, out);
+  EXPECT_EQ("", out.str());
+  EXPECT_EQ(0u, report.succeeded);
+  EXPECT_EQ(3u, report.cancelled);
+  ASSERT_EQ(3u, report.failures.size());
+  EXPECT_EQ("Cancelled before starting", report.failures[1].second);
+
+  PipelineSettings pipelineSettings;
+  pipelineSettings.cancellation = settings.cancellation;
+  std::ostringstream pipelined;
+  report = PipelinedBatchRunner(pipelineSettings).run(jobs, pipelined);
+  EXPECT_EQ("", pipelined.str());
+  EXPECT_EQ(3u, report.cancelled);
+}
+
+TEST_F(ISOModelFixture, SamplingDriversStopWhenCancelled)
+{
+  auto ismPath = test_data_path + "/SmallOffice_v2.ism";
+
+  SweepSpec sweepSpec;
+  sweepSpec.method = "factorial";
+  sweepSpec.properties = { "coolingsystemcop" };
+  sweepSpec.values = { { 2.5, 3, 4 } };
+  sweepSpec.cancellation.cancel();
+  auto results = ParametricSweep(ismPath).run(sweepSpec);
+  ASSERT_EQ(3u, results.size());
+  for (std::size_t i = 0; i < results.size(); ++i) {
+    EXPECT_EQ(i, results[i].variant);
+    EXPECT_TRUE(results[i].endUses.empty());
+    EXPECT_EQ("Cancelled before starting", results[i].error);
+  }
+
+  MonteCarloSpec monteCarloSpec;
+  monteCarloSpec.samples = 20;
+  monteCarloSpec.chunk = 8;
+  monteCarloSpec.parameters = { UncertainParameter::parse("coolingsystemcop", "uniform, 2.5, 4") };
+  monteCarloSpec.cancellation.cancel();
+  auto monteCarlo = MonteCarlo(ismPath).run(monteCarloSpec);
+  EXPECT_TRUE(monteCarlo.cancelled());
+  EXPECT_EQ(0u, monteCarlo.samples());
+  EXPECT_EQ(0u, monteCarlo.failures());
+
+  CalibrationSpec calibrationSpec;
+  calibrationSpec.properties = { "coolingsystemcop" };
+  calibrationSpec.low = { 2.5 };
+  calibrationSpec.high = { 4.0 };
+  calibrationSpec.electricity.assign(12, 10.0);
+  calibrationSpec.cancellation.cancel();
+  Calibration calibration(ismPath);
+  auto calibrated = calibration.run(calibrationSpec);
+  EXPECT_TRUE(calibrated.cancelled);
+  EXPECT_FALSE(calibrated.converged);
+  EXPECT_TRUE(calibrated.history.empty());
+  ASSERT_EQ(1u, calibrated.values.size());
+  EXPECT_GE(calibrated.values[0], calibrationSpec.low[0]);
+  EXPECT_LE(calibrated.values[0], calibrationSpec.high[0]);
+
+  calibrationSpec.method = "mcmc";
+  calibrated = calibration.run(calibrationSpec);
+  EXPECT_TRUE(calibrated.cancelled);
+  EXPECT_FALSE(calibrated.converged);
+  EXPECT_EQ(calibrationSpec.chains, calibrated.evaluations);
+  EXPECT_EQ(std::vector<double>(calibrationSpec.chains, 0.0), calibrated.acceptanceRates);
+}
+
+TEST_F(ISOModelFixture, SimulationServerTimesOutRequests)
+{
+  auto ismPath = test_data_path + "/SmallOffice_v2.ism";
+  SimulationServer server(1);
+
+  auto response = server.handle("base = " + ismPath + "\nengine = hourly\ntimeout = 1e-9\n");
+  EXPECT_FALSE(response.ok);
+  EXPECT_EQ("Cancelled before starting", response.body);
+
+  response = server.handle("base = " + ismPath + "\ntimeout = soon\n");
+  EXPECT_FALSE(response.ok);
+  response = server.handle("base = " + ismPath + "\ntimeout = 1e300\n");
+  EXPECT_FALSE(response.ok);
+  EXPECT_NE(std::string::npos, response.body.find("at most a day"));
+
+  response = server.handle("base = " + ismPath + "\nengine = hourly\ntimeout = 3600\n");
+  EXPECT_TRUE(response.ok) << response.body;
+}
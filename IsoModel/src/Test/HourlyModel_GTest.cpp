@@ -9,10 +9,14 @@
 
 #include "ISOModelFixture.hpp"
 
+#include "../Clustering.hpp"
 #include "../Properties.hpp"
 #include "../UserModel.hpp"
 #include "../ISOResults.hpp"
 
+#include <cmath>
+#include <numeric>
+
 using namespace openstudio::isomodel;
 
 TEST_F(ISOModelFixture, HourlyModelTests)
@@ -55,3 +59,557 @@ TEST_F(ISOModelFixture, HourlyModelTests)
     }
   }
 }
+
+TEST_F(ISOModelFixture, HourlyModelSpecializedKernelTests)
+{
+  openstudio::isomodel::UserModel userModel;
+  userModel.load(test_data_path + "/SmallOffice_v2.ism");
+
+  // Cover a specialized kernel with every flag set and one with every flag cleared.
+  for (int config = 0; config < 2; ++config) {
+    if (config == 1) {
+      userModel.setForcedAirHeating(false);
+      userModel.setForcedAirCooling(false);
+      userModel.setExteriorLightingPower(0.0);
+    }
+
+    HourlyModel generic = userModel.toHourlyModel();
+    generic.setSpecializedKernels(false);
+    auto expected = generic.simulate();
+
+    HourlyModel specialized = userModel.toHourlyModel();
+    ASSERT_TRUE(specialized.specializedKernels());
+    auto results = specialized.simulate();
+
+    ASSERT_EQ(expected.size(), results.size());
+    for (std::size_t i = 0; i < results.size(); ++i) {
+      for (int j = 0; j < 13; ++j) {
+#ifdef ISOMODEL_STANDALONE
+        ASSERT_EQ(expected[i].getEndUse(j), results[i].getEndUse(j)) << "Hour = " << i << ", End Use = " << endUseNames[j] << "\n";
+#else
+        ASSERT_EQ(expected[i].getEndUse(isoResultsEndUseTypes[j].first, isoResultsEndUseTypes[j].second),
+                  results[i].getEndUse(isoResultsEndUseTypes[j].first, isoResultsEndUseTypes[j].second))
+          << "Hour = " << i << ", End Use = " << endUseNames[j] << "\n";
+#endif
+      }
+    }
+  }
+}
+
+TEST_F(ISOModelFixture, HourlyModelAffineSolverTests)
+{
+  openstudio::isomodel::UserModel userModel;
+  userModel.load(test_data_path + "/SmallOffice_v2.ism");
+
+  HourlyModel reference = userModel.toHourlyModel();
+  reference.setAffineSolver(false);
+  auto expected = reference.simulate();
+
+  HourlyModel affine = userModel.toHourlyModel();
+  ASSERT_TRUE(affine.affineSolver());
+  auto results = affine.simulate();
+
+  // The two solvers only differ in the order of floating point operations.
+  ASSERT_EQ(expected.size(), results.size());
+  for (std::size_t i = 0; i < results.size(); ++i) {
+    for (int j = 0; j < 13; ++j) {
+#ifdef ISOMODEL_STANDALONE
+      auto expectedValue = expected[i].getEndUse(j);
+      auto value = results[i].getEndUse(j);
+#else
+      auto expectedValue = expected[i].getEndUse(isoResultsEndUseTypes[j].first, isoResultsEndUseTypes[j].second);
+      auto value = results[i].getEndUse(isoResultsEndUseTypes[j].first, isoResultsEndUseTypes[j].second);
+#endif
+      ASSERT_NEAR(expectedValue, value, 1e-9 * std::max(1.0, std::fabs(expectedValue)))
+        << "Hour = " << i << ", End Use = " << endUseNames[j] << "\n";
+    }
+  }
+}
+
+TEST_F(ISOModelFixture, HourlyModelPararealTests)
+{
+  openstudio::isomodel::UserModel userModel;
+  userModel.load(test_data_path + "/SmallOffice_v2.ism");
+
+  HourlyModel sequential = userModel.toHourlyModel();
+  auto expected = sequential.simulate(true);
+
+  // With no tolerance every boundary must match exactly, which makes every
+  // segment run from the state the sequential run reaches there.
+  HourlyModel parallel = userModel.toHourlyModel();
+  PararealSettings settings;
+  settings.threads = 4;
+  settings.tolerance = 0.0;
+  PararealReport report;
+  auto results = parallel.simulateParareal(true, settings, &report);
+
+  EXPECT_TRUE(report.converged);
+  EXPECT_GE(report.iterations, 1);
+  EXPECT_LE(report.iterations, settings.maxIterations);
+  EXPECT_EQ(0.0, report.maxJump);
+  EXPECT_GT(report.sequentialSeconds, 0.0);
+  EXPECT_GT(report.speedup, 0.0);
+  // Each sweep after the first skips the segments already settled.
+  EXPECT_EQ(report.iterations * 12 - report.iterations * (report.iterations - 1) / 2, report.segmentRuns);
+
+  ASSERT_EQ(expected.size(), results.size());
+  for (std::size_t i = 0; i < results.size(); ++i) {
+    for (int j = 0; j < 13; ++j) {
+#ifdef ISOMODEL_STANDALONE
+      EXPECT_EQ(expected[i].getEndUse(j), results[i].getEndUse(j))
+#else
+      EXPECT_EQ(expected[i].getEndUse(isoResultsEndUseTypes[j].first, isoResultsEndUseTypes[j].second),
+                results[i].getEndUse(isoResultsEndUseTypes[j].first, isoResultsEndUseTypes[j].second))
+#endif
+        << "Month = " << i << ", End Use = " << endUseNames[j] << "\n";
+    }
+  }
+
+  // The default tolerance, 1e-4 C on the boundary states, stops sooner.
+  // The boundary error decays within the first days of the segment, so the
+  // monthly totals stay within 1e-6 of the sequential run.
+  HourlyModel approximate = userModel.toHourlyModel();
+  settings = PararealSettings();
+  settings.threads = 4;
+  results = approximate.simulateParareal(true, settings, &report);
+  EXPECT_TRUE(report.converged);
+  EXPECT_LE(report.maxJump, settings.tolerance);
+
+  ASSERT_EQ(expected.size(), results.size());
+  for (std::size_t i = 0; i < results.size(); ++i) {
+    for (int j = 0; j < 13; ++j) {
+#ifdef ISOMODEL_STANDALONE
+      auto expectedValue = expected[i].getEndUse(j);
+      auto value = results[i].getEndUse(j);
+#else
+      auto expectedValue = expected[i].getEndUse(isoResultsEndUseTypes[j].first, isoResultsEndUseTypes[j].second);
+      auto value = results[i].getEndUse(isoResultsEndUseTypes[j].first, isoResultsEndUseTypes[j].second);
+#endif
+      ASSERT_NEAR(expectedValue, value, 1e-6 * std::max(1.0, std::fabs(expectedValue)))
+        << "Month = " << i << ", End Use = " << endUseNames[j] << "\n";
+    }
+  }
+}
+
+TEST_F(ISOModelFixture, KMedoidsTests)
+{
+  // Two tight groups and an outlier.
+  std::vector<std::vector<double> > points = { { 0.0, 0.0 }, { 10.0, 10.0 }, { 0.1, 0.0 }, { 10.2, 10.0 },
+                                               { 0.0, 0.2 }, { 10.0, 10.1 }, { 50.0, 50.0 } };
+  std::vector<std::size_t> assignment;
+  auto medoids = kMedoids(points, 3, &assignment);
+  ASSERT_EQ(3u, medoids.size());
+  EXPECT_EQ((std::vector<std::size_t> { 0, 1, 6 }), medoids);
+  EXPECT_EQ((std::vector<std::size_t> { 0, 1, 0, 1, 0, 1, 2 }), assignment);
+
+  // Every point its own cluster.
+  medoids = kMedoids(points, points.size(), &assignment);
+  for (std::size_t i = 0; i < points.size(); ++i) {
+    EXPECT_EQ(i, medoids[i]);
+    EXPECT_EQ(i, assignment[i]);
+  }
+
+  EXPECT_THROW(kMedoids(points, 0), std::invalid_argument);
+  EXPECT_THROW(kMedoids(points, 8), std::invalid_argument);
+  points[3].pop_back();
+  EXPECT_THROW(kMedoids(points, 2), std::invalid_argument);
+}
+
+TEST_F(ISOModelFixture, HourlyModelRepresentativeDayTests)
+{
+  openstudio::isomodel::UserModel userModel;
+  userModel.load(test_data_path + "/SmallOffice_v2.ism");
+
+  HourlyModel hourlyModel = userModel.toHourlyModel();
+  auto expected = hourlyModel.simulate(true);
+
+  RepresentativeDaySettings settings;
+  settings.compare = true;
+  RepresentativeDayReport report;
+  auto results = hourlyModel.simulateRepresentativeDays(true, settings, &report);
+  ASSERT_EQ(12u, results.size());
+
+  EXPECT_GE(report.dayTypes, 1);
+  ASSERT_EQ(static_cast<std::size_t>(settings.days), report.days.size());
+  EXPECT_EQ(365, std::accumulate(report.weights.begin(), report.weights.end(), 0));
+  ASSERT_EQ(365u, report.representatives.size());
+  for (auto day : report.days) {
+    EXPECT_EQ(day, report.representatives[day]);
+  }
+  EXPECT_LE(report.simulatedHours, settings.days * (settings.warmupDays + 1) * 24);
+  EXPECT_GT(report.hourSpeedup, 10.0);
+
+  // The report's errors are against the full run.
+  ASSERT_TRUE(report.compared);
+  ASSERT_EQ(13u, report.annualError.size());
+  auto fullTotal = 0.0, total = 0.0;
+  for (int j = 0; j < 13; ++j) {
+    auto fullUse = 0.0, use = 0.0;
+    for (int month = 0; month < 12; ++month) {
+#ifdef ISOMODEL_STANDALONE
+      fullUse += expected[month].getEndUse(j);
+      use += results[month].getEndUse(j);
+#else
+      fullUse += expected[month].getEndUse(isoResultsEndUseTypes[j].first, isoResultsEndUseTypes[j].second);
+      use += results[month].getEndUse(isoResultsEndUseTypes[j].first, isoResultsEndUseTypes[j].second);
+#endif
+    }
+    EXPECT_NEAR(use - fullUse, report.annualError[j], 1e-9 * std::max(1.0, fullUse)) << "End Use = " << endUseNames[j];
+    fullTotal += fullUse;
+    total += use;
+  }
+  EXPECT_NEAR((total - fullTotal) / fullTotal, report.totalError, 1e-12);
+  EXPECT_LT(std::abs(report.totalError), 0.05);
+  EXPECT_GT(report.monthlyRmse, 0.0);
+
+  // Reusing the clusters gives the same results.
+  auto clustered = report;
+  RepresentativeDaySettings reuse;
+  reuse.representatives = clustered.representatives;
+  auto reused = hourlyModel.simulateRepresentativeDays(true, reuse, &report);
+  EXPECT_EQ(clustered.days, report.days);
+  EXPECT_EQ(clustered.weights, report.weights);
+  for (int month = 0; month < 12; ++month) {
+    for (int j = 0; j < 13; ++j) {
+#ifdef ISOMODEL_STANDALONE
+      EXPECT_EQ(results[month].getEndUse(j), reused[month].getEndUse(j));
+#else
+      EXPECT_EQ(results[month].getEndUse(isoResultsEndUseTypes[j].first, isoResultsEndUseTypes[j].second),
+                reused[month].getEndUse(isoResultsEndUseTypes[j].first, isoResultsEndUseTypes[j].second));
+#endif
+    }
+  }
+  // Day 1 stands for day 0 but not for itself.
+  reuse.representatives.assign(365, 0);
+  reuse.representatives[0] = 1;
+  EXPECT_THROW(hourlyModel.simulateRepresentativeDays(true, reuse), std::invalid_argument);
+  reuse.representatives.pop_back();
+  EXPECT_THROW(hourlyModel.simulateRepresentativeDays(true, reuse), std::invalid_argument);
+
+  // With every day representing itself the run is the full year.
+  settings.days = 365;
+  results = hourlyModel.simulateRepresentativeDays(true, settings, &report);
+  EXPECT_EQ(TIMESLICES, report.simulatedHours);
+  EXPECT_NEAR(0.0, report.totalError, 1e-12);
+  EXPECT_NEAR(0.0, report.monthlyRmse, 1e-9);
+
+  settings.days = 366;
+  EXPECT_THROW(hourlyModel.simulateRepresentativeDays(true, settings), std::invalid_argument);
+  settings.days = 0;
+  EXPECT_THROW(hourlyModel.simulateRepresentativeDays(true, settings), std::invalid_argument);
+}
+
+TEST_F(ISOModelFixture, HourlyModelCheckpointTests)
+{
+  openstudio::isomodel::UserModel userModel;
+  userModel.load(test_data_path + "/SmallOffice_v2.ism");
+
+  HourlyModel hourlyModel = userModel.toHourlyModel();
+  auto expected = hourlyModel.simulate();
+
+  HourlyCheckpoints baseline;
+  auto results = hourlyModel.simulate(false, baseline, 168);
+  ASSERT_EQ(expected.size(), results.size());
+  for (std::size_t i = 0; i < results.size(); ++i) {
+    for (int j = 0; j < 13; ++j) {
+#ifdef ISOMODEL_STANDALONE
+      ASSERT_EQ(expected[i].getEndUse(j), results[i].getEndUse(j))
+#else
+      ASSERT_EQ(expected[i].getEndUse(isoResultsEndUseTypes[j].first, isoResultsEndUseTypes[j].second),
+                results[i].getEndUse(isoResultsEndUseTypes[j].first, isoResultsEndUseTypes[j].second))
+#endif
+        << "Hour = " << i << ", End Use = " << endUseNames[j] << "\n";
+    }
+  }
+  EXPECT_EQ(53u, baseline.TMT1.size());
+  EXPECT_EQ(8760, baseline.simulatedHours);
+
+  // A hot spell in July, rerun in full and from the checkpoints.
+  auto weather = std::make_shared<HourlyInputs>(*baseline.inputs);
+  for (int hour = 4400; hour < 4424; ++hour) {
+    weather->temperature[hour] += 5.0;
+  }
+  HourlyCheckpoints full = baseline;
+  full.inputs = weather;
+  expected = hourlyModel.resimulate(false, full, 0);
+  EXPECT_EQ(8760, full.simulatedHours);
+
+  HourlyCheckpoints partial = baseline;
+  partial.inputs = weather;
+  results = hourlyModel.resimulate(false, partial, 4400, 4423, 1e-9);
+  EXPECT_LT(partial.simulatedHours, 8760 - 4368);
+  for (std::size_t i = 0; i < results.size(); ++i) {
+    for (int j = 0; j < 13; ++j) {
+#ifdef ISOMODEL_STANDALONE
+      auto expectedValue = expected[i].getEndUse(j);
+      auto value = results[i].getEndUse(j);
+#else
+      auto expectedValue = expected[i].getEndUse(isoResultsEndUseTypes[j].first, isoResultsEndUseTypes[j].second);
+      auto value = results[i].getEndUse(isoResultsEndUseTypes[j].first, isoResultsEndUseTypes[j].second);
+#endif
+      ASSERT_NEAR(expectedValue, value, 1e-6 * std::max(1.0, std::fabs(expectedValue)))
+        << "Hour = " << i << ", End Use = " << endUseNames[j] << "\n";
+    }
+  }
+
+  // A summer cooling setpoint change, found by comparing the inputs, reruns
+  // only from the week it starts in.
+  auto summer = std::make_shared<HourlyInputs>(*baseline.inputs);
+  for (int hour = 4344; hour < 5088; ++hour) {
+    summer->scheduleOverrides[hour].coolingSetpoint = 24.0;
+  }
+  full = baseline;
+  full.inputs = summer;
+  expected = hourlyModel.resimulate(false, full, 0);
+  partial = baseline;
+  results = hourlyModel.resimulate(false, partial, summer, 1e-9);
+  EXPECT_LT(partial.simulatedHours, 8760 - 4200);
+  EXPECT_EQ(summer, partial.inputs);
+  auto cooling = 0.0;
+  auto baselineCooling = 0.0;
+  for (std::size_t i = 0; i < results.size(); ++i) {
+    for (int j = 0; j < 13; ++j) {
+#ifdef ISOMODEL_STANDALONE
+      auto expectedValue = expected[i].getEndUse(j);
+      auto value = results[i].getEndUse(j);
+#else
+      auto expectedValue = expected[i].getEndUse(isoResultsEndUseTypes[j].first, isoResultsEndUseTypes[j].second);
+      auto value = results[i].getEndUse(isoResultsEndUseTypes[j].first, isoResultsEndUseTypes[j].second);
+#endif
+      ASSERT_NEAR(expectedValue, value, 1e-6 * std::max(1.0, std::fabs(expectedValue)))
+        << "Hour = " << i << ", End Use = " << endUseNames[j] << "\n";
+    }
+    cooling += partial.results.Qneed_cl[i];
+    baselineCooling += baseline.results.Qneed_cl[i];
+  }
+  EXPECT_NE(baselineCooling, cooling);
+
+  // Unchanged inputs rerun nothing.
+  hourlyModel.resimulate(false, partial, std::make_shared<HourlyInputs>(*summer));
+  EXPECT_EQ(0, partial.simulatedHours);
+
+  EXPECT_THROW(hourlyModel.resimulate(false, partial, 9000), std::out_of_range);
+  EXPECT_THROW(hourlyModel.resimulate(false, partial, std::make_shared<HourlyInputs>()), std::invalid_argument);
+  HourlyCheckpoints empty;
+  EXPECT_THROW(hourlyModel.resimulate(false, empty, 0), std::invalid_argument);
+  EXPECT_THROW(hourlyModel.resimulate(false, empty, summer), std::invalid_argument);
+}
+
+namespace {
+// An HourlyModel whose parameters can be edited in place, as a long-lived
+// model's would be.
+class EditableHourlyModel : public HourlyModel
+{
+public:
+  explicit EditableHourlyModel(const HourlyModel& model) : HourlyModel(model) {}
+
+  Structure& editStructure() {
+    return structure;
+  }
+};
+}
+
+TEST_F(ISOModelFixture, HourlyModelResimulatesParameterChanges)
+{
+  openstudio::isomodel::UserModel userModel;
+  userModel.load(test_data_path + "/SmallOffice_v2.ism");
+
+  EditableHourlyModel hourlyModel(userModel.toHourlyModel());
+  HourlyCheckpoints checkpoints;
+  hourlyModel.simulate(false, checkpoints);
+  auto baselineCooling = checkpoints.results.Qneed_cl;
+
+  // Each window change, rerun from the start, matches a model built with it.
+  userModel.setWindowSCFS(0.3);
+  hourlyModel.editStructure().setWindowShadingCorrectionFactor(0, 0.3);
+  auto results = hourlyModel.resimulate(false, checkpoints, 0);
+  auto expected = userModel.toHourlyModel().simulate(false);
+  for (std::size_t i = 0; i < results.size(); ++i) {
+    for (int j = 0; j < 13; ++j) {
+#ifdef ISOMODEL_STANDALONE
+      ASSERT_EQ(expected[i].getEndUse(j), results[i].getEndUse(j))
+#else
+      ASSERT_EQ(expected[i].getEndUse(isoResultsEndUseTypes[j].first, isoResultsEndUseTypes[j].second),
+                results[i].getEndUse(isoResultsEndUseTypes[j].first, isoResultsEndUseTypes[j].second))
+#endif
+        << "Hour = " << i << ", End Use = " << endUseNames[j] << "\n";
+    }
+  }
+
+  userModel.setWindowSDFS(0.2);
+  hourlyModel.editStructure().setWindowShadingDevice(0, 0.2);
+  results = hourlyModel.resimulate(false, checkpoints, 0);
+  expected = userModel.toHourlyModel().simulate(false);
+  for (std::size_t i = 0; i < results.size(); ++i) {
+    for (int j = 0; j < 13; ++j) {
+#ifdef ISOMODEL_STANDALONE
+      ASSERT_EQ(expected[i].getEndUse(j), results[i].getEndUse(j))
+#else
+      ASSERT_EQ(expected[i].getEndUse(isoResultsEndUseTypes[j].first, isoResultsEndUseTypes[j].second),
+                results[i].getEndUse(isoResultsEndUseTypes[j].first, isoResultsEndUseTypes[j].second))
+#endif
+        << "Hour = " << i << ", End Use = " << endUseNames[j] << "\n";
+    }
+  }
+  EXPECT_NE(baselineCooling, checkpoints.results.Qneed_cl);
+}
+
+TEST_F(ISOModelFixture, HourlyModelStepTests)
+{
+  openstudio::isomodel::UserModel userModel;
+  userModel.load(test_data_path + "/SmallOffice_v2.ism");
+
+  HourlyModel hourlyModel = userModel.toHourlyModel();
+  HourlyCheckpoints checkpoints;
+  auto expected = hourlyModel.simulate(false, checkpoints);
+  const auto& inputs = *checkpoints.inputs;
+
+  hourlyModel.prepareSteps();
+  HourInput input;
+  for (int i = 0; i < 8760; ++i) {
+    input.hourOfDay = inputs.frame.Hour[i];
+    input.dayOfWeek = inputs.frame.DayOfWeek[i];
+    input.temperature = inputs.temperature[i];
+    input.windMps = inputs.wind[i];
+    std::copy(inputs.radiation[i].begin(), inputs.radiation[i].end(), input.solarRadiation);
+    auto results = hourlyModel.step(input);
+
+    // Everything but heating and cooling is independent of the distribution
+    // efficiencies, so matches exactly.
+    for (int j = 2; j < 9; ++j) {
+#ifdef ISOMODEL_STANDALONE
+      ASSERT_EQ(expected[i].getEndUse(j), results.getEndUse(j))
+#else
+      ASSERT_EQ(expected[i].getEndUse(isoResultsEndUseTypes[j].first, isoResultsEndUseTypes[j].second), results.getEndUse(j))
+#endif
+        << "Hour = " << i << ", End Use = " << endUseNames[j] << "\n";
+    }
+  }
+  EXPECT_EQ(8760, hourlyModel.state().hours);
+  EXPECT_DOUBLE_EQ(std::accumulate(checkpoints.results.Qneed_ht.begin(), checkpoints.results.Qneed_ht.end(), 0.0),
+                   hourlyModel.state().heatingNeed);
+  EXPECT_DOUBLE_EQ(std::accumulate(checkpoints.results.Qneed_cl.begin(), checkpoints.results.Qneed_cl.end(), 0.0),
+                   hourlyModel.state().coolingNeed);
+
+  // A hot afternoon with the cooling turned off.
+  HourlyState state;
+  state.TMT1 = 26.0;
+  state.tiHeatCool = 26.0;
+  hourlyModel.setState(state);
+  input.hourOfDay = 14;
+  input.dayOfWeek = 2;
+  input.temperature = 35.0;
+  auto cooled = hourlyModel.step(input);
+  EXPECT_GT(cooled.getEndUse(1), 0.0);
+  hourlyModel.setState(state);
+  input.coolingSetpoint = 100.0;
+  auto uncooled = hourlyModel.step(input);
+  EXPECT_EQ(0.0, uncooled.getEndUse(1));
+  EXPECT_GT(hourlyModel.state().tiHeatCool, 26.0);
+}
+
+TEST_F(ISOModelFixture, HourlyModelBranchTests)
+{
+  openstudio::isomodel::UserModel userModel;
+  userModel.load(test_data_path + "/SmallOffice_v2.ism");
+
+  HourlyModel hourlyModel = userModel.toHourlyModel();
+  HourlyCheckpoints checkpoints;
+  hourlyModel.simulate(false, checkpoints);
+  const auto& inputs = *checkpoints.inputs;
+  auto hourInput = [&](int i) -> HourInput {
+    HourInput input;
+    input.hourOfDay = inputs.frame.Hour[i];
+    input.dayOfWeek = inputs.frame.DayOfWeek[i];
+    input.temperature = inputs.temperature[i];
+    input.windMps = inputs.wind[i];
+    std::copy(inputs.radiation[i].begin(), inputs.radiation[i].end(), input.solarRadiation);
+    return input;
+  };
+
+  // Run to noon on a July day and fork a 48 hour forecast for each of four
+  // cooling setpoints.
+  hourlyModel.prepareSteps();
+  auto start = 4380;
+  for (int i = 0; i < start; ++i) {
+    hourlyModel.step(hourInput(i));
+  }
+  auto now = hourlyModel.state();
+  EXPECT_EQ(0.0, now.fork().totals.getEndUse(1));
+  EXPECT_EQ(now.TMT1, now.fork().TMT1);
+
+  const std::size_t branches = 4;
+  double coolingSetpoints[branches] = { 22.0, 24.0, 26.0, 28.0 };
+  std::vector<HourlyState> states(branches, now.fork());
+  std::vector<HourEndUses> results(branches);
+  for (int i = start; i < start + 48; ++i) {
+    hourlyModel.stepBranches(hourInput(i), nullptr, coolingSetpoints, states.data(), results.data(), branches);
+  }
+  EXPECT_EQ(start, hourlyModel.state().hours);
+
+  // Each branch matches stepping it on its own.
+  for (std::size_t k = 0; k < branches; ++k) {
+    hourlyModel.setState(now.fork());
+    for (int i = start; i < start + 48; ++i) {
+      auto input = hourInput(i);
+      input.coolingSetpoint = coolingSetpoints[k];
+      hourlyModel.step(input);
+    }
+    EXPECT_EQ(hourlyModel.state().TMT1, states[k].TMT1);
+    EXPECT_EQ(hourlyModel.state().tiHeatCool, states[k].tiHeatCool);
+    for (int j = 0; j < 13; ++j) {
+      EXPECT_EQ(hourlyModel.state().totals.getEndUse(j), states[k].totals.getEndUse(j)) << "Branch = " << k << ", End Use = " << endUseNames[j];
+    }
+  }
+
+  // Higher cooling setpoints use less cooling.
+  for (std::size_t k = 1; k < branches; ++k) {
+    EXPECT_LT(states[k].totals.getEndUse(1), states[k - 1].totals.getEndUse(1));
+  }
+
+  // Branches at different hours would need different schedules.
+  states[1] = now.fork();
+  EXPECT_THROW(hourlyModel.stepBranches(hourInput(start), nullptr, coolingSetpoints, states.data(), results.data(), branches),
+               std::invalid_argument);
+}
+
+TEST_F(ISOModelFixture, HourlyModelStepsAfterParameterChanges)
+{
+  openstudio::isomodel::UserModel userModel;
+  userModel.load(test_data_path + "/SmallOffice_v2.ism");
+
+  EditableHourlyModel hourlyModel(userModel.toHourlyModel());
+  HourlyCheckpoints checkpoints;
+  hourlyModel.simulate(false, checkpoints);
+  const auto& inputs = *checkpoints.inputs;
+  auto stepDay = [&](HourlyModel& model) {
+    model.prepareSteps();
+    for (int i = 4368; i < 4392; ++i) {
+      HourInput input;
+      input.hourOfDay = inputs.frame.Hour[i];
+      input.dayOfWeek = inputs.frame.DayOfWeek[i];
+      input.temperature = inputs.temperature[i];
+      input.windMps = inputs.wind[i];
+      std::copy(inputs.radiation[i].begin(), inputs.radiation[i].end(), input.solarRadiation);
+      model.step(input);
+    }
+    return model.state();
+  };
+  auto before = stepDay(hourlyModel);
+
+  // Prepared again after a window change, a long-lived model steps like a
+  // new one.
+  userModel.setWindowSCFS(0.3);
+  userModel.setWindowSDFS(0.2);
+  hourlyModel.editStructure().setWindowShadingCorrectionFactor(0, 0.3);
+  hourlyModel.editStructure().setWindowShadingDevice(0, 0.2);
+  auto edited = userModel.toHourlyModel();
+  auto after = stepDay(hourlyModel);
+  auto expected = stepDay(edited);
+  EXPECT_NE(before.TMT1, after.TMT1);
+  EXPECT_EQ(expected.TMT1, after.TMT1);
+  EXPECT_EQ(expected.tiHeatCool, after.tiHeatCool);
+  for (int j = 0; j < 13; ++j) {
+    EXPECT_EQ(expected.totals.getEndUse(j), after.totals.getEndUse(j)) << "End Use = " << endUseNames[j];
+  }
+}
@@ -0,0 +1,133 @@
+/*
+ * ISOModelC_GTest.cpp
+ */
+
+#include "gtest/gtest.h"
+
+#include "ISOModelFixture.hpp"
+
+#include "../ISOModelC.h"
+#include "../ParametricSweep.hpp"
+
+#include <cmath>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace openstudio::isomodel;
+using namespace openstudio;
+
+namespace {
+
+std::vector<double> flatten(std::vector<EndUses> periods)
+{
+  std::vector<double> values;
+  for (auto& period : periods) {
+    for (int i = 0; i < 13; ++i) {
+#ifdef ISOMODEL_STANDALONE
+      values.push_back(period.getEndUse(i));
+#else
+      values.push_back(period.getEndUse(isoResultsEndUseTypes[i].first, isoResultsEndUseTypes[i].second));
+#endif
+    }
+  }
+  return values;
+}
+
+typedef std::unique_ptr<isomodel_model, void (*)(isomodel_model*)> ModelHandle;
+
+ModelHandle create(const std::string& ismPath)
+{
+  return ModelHandle(isomodel_model_create(ismPath.c_str(), nullptr), isomodel_model_destroy);
+}
+
+} // namespace
+
+TEST_F(ISOModelFixture, CApiLooksUpParameters)
+{
+  EXPECT_EQ(ISOMODEL_ABI_VERSION, isomodel_abi_version());
+  ASSERT_GT(isomodel_parameter_count(), 0);
+  for (int id = 0; id < isomodel_parameter_count(); ++id) {
+    EXPECT_EQ(id, isomodel_parameter_id(isomodel_parameter_name(id)));
+  }
+  EXPECT_EQ(isomodel_parameter_id("coolingsystemcop"), isomodel_parameter_id("coolingSystemCOP"));
+  EXPECT_EQ(-1, isomodel_parameter_id("nosuchparameter"));
+  EXPECT_EQ(nullptr, isomodel_parameter_name(isomodel_parameter_count()));
+  EXPECT_EQ(156u, isomodel_result_size(ISOMODEL_ENGINE_HOURLY));
+  EXPECT_EQ(8760u * 13u, isomodel_result_size(ISOMODEL_ENGINE_HOURLY_BY_HOUR));
+  EXPECT_EQ(0u, isomodel_result_size(7));
+
+  EXPECT_EQ(nullptr, isomodel_model_create((test_data_path + "/missing.ism").c_str(), nullptr));
+  EXPECT_NE(std::string::npos, std::string(isomodel_last_error()).find("missing.ism"));
+}
+
+TEST_F(ISOModelFixture, CApiSimulatesIntoCallerBuffers)
+{
+  auto ismPath = test_data_path + "/SmallOffice_v2.ism";
+  auto model = create(ismPath);
+  ASSERT_NE(nullptr, model.get()) << isomodel_last_error();
+  ParametricSweep sweep(ismPath);
+
+  int ids[] = { isomodel_parameter_id("coolingsystemcop"), isomodel_parameter_id("lightingpowerdensityoccupied") };
+  double values[] = { 3.7, 9.0 };
+  ASSERT_EQ(ISOMODEL_OK, isomodel_set_parameters(model.get(), ids, values, 2));
+  double read[2] = { 0, 0 };
+  ASSERT_EQ(ISOMODEL_OK, isomodel_get_parameters(model.get(), ids, read, 2));
+  EXPECT_EQ(3.7, read[0]);
+  EXPECT_EQ(9.0, read[1]);
+
+  // Setting parameters directly gives the same results as loading them.
+  std::vector<double> monthly(156);
+  ASSERT_EQ(ISOMODEL_OK, isomodel_simulate(model.get(), ISOMODEL_ENGINE_MONTHLY, monthly.data()));
+  EXPECT_EQ(flatten(sweep.simulate({ "coolingsystemcop", "lightingpowerdensityoccupied" }, { 3.7, 9.0 }, false)), monthly);
+
+  std::vector<double> hourly(8760 * 13);
+  ASSERT_EQ(ISOMODEL_OK, isomodel_simulate(model.get(), ISOMODEL_ENGINE_HOURLY_BY_HOUR, hourly.data()));
+  std::vector<double> byMonth(156);
+  ASSERT_EQ(ISOMODEL_OK, isomodel_simulate(model.get(), ISOMODEL_ENGINE_HOURLY, byMonth.data()));
+  EXPECT_EQ(flatten(sweep.simulate({ "coolingsystemcop", "lightingpowerdensityoccupied" }, { 3.7, 9.0 }, true)), byMonth);
+
+  int bad[] = { ids[0], isomodel_parameter_count() };
+  values[0] = 5.0;
+  EXPECT_EQ(ISOMODEL_ERROR_ARGUMENT, isomodel_set_parameters(model.get(), bad, values, 2));
+  ASSERT_EQ(ISOMODEL_OK, isomodel_get_parameters(model.get(), ids, read, 1));
+  EXPECT_EQ(3.7, read[0]);
+  EXPECT_EQ(ISOMODEL_ERROR_ARGUMENT, isomodel_simulate(model.get(), 7, monthly.data()));
+  EXPECT_EQ(ISOMODEL_ERROR_ARGUMENT, isomodel_simulate(model.get(), ISOMODEL_ENGINE_MONTHLY, nullptr));
+}
+
+TEST_F(ISOModelFixture, CApiRunsBatches)
+{
+  auto model = create(test_data_path + "/SmallOffice_v2.ism");
+  ASSERT_NE(nullptr, model.get()) << isomodel_last_error();
+  ModelHandle clone(isomodel_model_clone(model.get()), isomodel_model_destroy);
+  ASSERT_NE(nullptr, clone.get());
+
+  int ids[] = { isomodel_parameter_id("coolingsystemcop"), isomodel_parameter_id("heatingsystemefficiency") };
+  std::vector<double> rows = { 2.5, 0.8, 3.0, 0.85, 3.5, 0.9, 4.0, 0.95, 4.5, 1.0 };
+  std::size_t rowCount = rows.size() / 2;
+
+  for (int engine : { ISOMODEL_ENGINE_MONTHLY, ISOMODEL_ENGINE_HOURLY }) {
+    std::vector<double> results(rowCount * 156);
+    std::vector<int> statuses(rowCount, -1);
+    ASSERT_EQ(ISOMODEL_OK, isomodel_simulate_batch(model.get(), engine, ids, 2, rows.data(), rowCount, results.data(), statuses.data(), 3))
+      << isomodel_last_error();
+    for (std::size_t r = 0; r < rowCount; ++r) {
+      EXPECT_EQ(ISOMODEL_OK, statuses[r]);
+      ASSERT_EQ(ISOMODEL_OK, isomodel_set_parameters(clone.get(), ids, &rows[r * 2], 2));
+      std::vector<double> single(156);
+      ASSERT_EQ(ISOMODEL_OK, isomodel_simulate(clone.get(), engine, single.data()));
+      EXPECT_EQ(single, std::vector<double>(results.begin() + r * 156, results.begin() + (r + 1) * 156));
+    }
+  }
+
+  // The batch leaves the model's own parameters alone.
+  double cop = 0;
+  ASSERT_EQ(ISOMODEL_OK, isomodel_get_parameters(model.get(), ids, &cop, 1));
+  EXPECT_NE(4.5, cop);
+
+  int bad[] = { -1 };
+  std::vector<double> results(156);
+  EXPECT_EQ(ISOMODEL_ERROR_ARGUMENT, isomodel_simulate_batch(model.get(), ISOMODEL_ENGINE_MONTHLY, bad, 1, rows.data(), 1, results.data(), nullptr, 1));
+  EXPECT_EQ(ISOMODEL_OK, isomodel_simulate_batch(model.get(), ISOMODEL_ENGINE_MONTHLY, nullptr, 0, nullptr, 0, nullptr, nullptr, 1));
+}
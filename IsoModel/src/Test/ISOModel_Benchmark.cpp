@@ -1,6 +1,8 @@
 #include "../UserModel.hpp"
 #include <iostream>
+#include <algorithm>
 #include <chrono>
+#include <vector>
 
 using namespace openstudio::isomodel;
 
@@ -84,6 +86,60 @@ int main(int argc, char** argv)
 
     std::cout << "Benchmarking monthly simulation with reloading the ism file each run (weather is cached).\n";
 
+    std::cout << "Benchmark: Stepping the hourly model one hour at a time. Timing just the steps.\n";
+
+    auto hourlyModel = userModel.toHourlyModel();
+    HourlyCheckpoints checkpoints;
+    hourlyModel.simulate(false, checkpoints);
+    const auto& inputs = *checkpoints.inputs;
+    std::vector<HourInput> hourInputs(TIMESLICES);
+    for (int i = 0; i != TIMESLICES; ++i) {
+      hourInputs[i].hourOfDay = inputs.frame.Hour[i];
+      hourInputs[i].dayOfWeek = inputs.frame.DayOfWeek[i];
+      hourInputs[i].temperature = inputs.temperature[i];
+      hourInputs[i].windMps = inputs.wind[i];
+      std::copy(inputs.radiation[i].begin(), inputs.radiation[i].end(), hourInputs[i].solarRadiation);
+    }
+
+    hourlyModel.prepareSteps();
+    auto years = 100;
+    auto cooling = 0.0;
+    auto stepStart = std::chrono::steady_clock::now();
+    for (int year = 0; year != years; ++year) {
+      for (const auto& hourInput : hourInputs) {
+        cooling += hourlyModel.step(hourInput).getEndUse(1);
+      }
+    }
+    auto stepEnd = std::chrono::steady_clock::now();
+
+    double stepTime = std::chrono::duration<double, std::nano>(stepEnd - stepStart).count() / (years * TIMESLICES);
+    std::cout << "Hourly step ran in " << stepTime << " ns, average over " << years * TIMESLICES << " steps (cooling "
+              << cooling << ")." << std::endl;
+
+    std::cout << "Benchmark: Stepping 32 forked 72 hour forecasts together, one per cooling setpoint.\n";
+
+    const std::size_t branches = 32;
+    std::vector<double> coolingSetpoints(branches);
+    for (std::size_t k = 0; k != branches; ++k) {
+      coolingSetpoints[k] = 22.0 + 0.25 * k;
+    }
+    std::vector<HourlyState> states(branches);
+    std::vector<HourEndUses> branchResults(branches);
+    auto forecasts = 1000;
+    auto forecastStart = std::chrono::steady_clock::now();
+    for (int forecast = 0; forecast != forecasts; ++forecast) {
+      std::fill(states.begin(), states.end(), hourlyModel.state().fork());
+      for (int i = 4380; i != 4380 + 72; ++i) {
+        hourlyModel.stepBranches(hourInputs[i], nullptr, coolingSetpoints.data(), states.data(), branchResults.data(), branches);
+      }
+      cooling += states[0].totals.getEndUse(1);
+    }
+    auto forecastEnd = std::chrono::steady_clock::now();
+
+    double forecastTime = std::chrono::duration<double, std::micro>(forecastEnd - forecastStart).count() / forecasts;
+    std::cout << "Forecast set ran in " << forecastTime << " us (" << forecastTime * 1000.0 / (72 * branches)
+              << " ns per branch hour), average over " << forecasts << " sets (cooling " << cooling << ")." << std::endl;
+
     std::cout << "Done!" << std::endl;
   }
 }
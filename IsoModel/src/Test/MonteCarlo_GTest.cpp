@@ -0,0 +1,167 @@
+/*
+ * MonteCarlo_GTest.cpp
+ */
+
+#include "gtest/gtest.h"
+
+#include "ISOModelFixture.hpp"
+
+#include "../CounterRng.hpp"
+#include "../MonteCarlo.hpp"
+#include "../OnlineStatistics.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+#include <stdexcept>
+
+using namespace openstudio::isomodel;
+using namespace openstudio;
+
+TEST_F(ISOModelFixture, OnlineStatisticsMatchStoredValues)
+{
+  CounterRng rng(3);
+  std::vector<double> values;
+  RunningStats stats;
+  P2Quantile median(0.5), p90(0.9);
+  Histogram histogram(0.0, 1.0, 10);
+  for (std::uint64_t i = 0; i < 20000; ++i) {
+    auto x = 1e6 + rng.uniform(0, i);
+    values.push_back(x);
+    stats.add(x);
+    median.add(x);
+    p90.add(x);
+    histogram.add(x - 1e6);
+  }
+
+  auto mean = 0.0;
+  for (auto x : values) {
+    mean += x / values.size();
+  }
+  auto variance = 0.0;
+  for (auto x : values) {
+    variance += (x - mean) * (x - mean) / (values.size() - 1);
+  }
+  EXPECT_EQ(values.size(), stats.count());
+  EXPECT_NEAR(mean, stats.mean(), 1e-8);
+  EXPECT_NEAR(variance, stats.variance(), 1e-9);
+  EXPECT_NEAR(1.0 / 12.0, stats.variance(), 2e-3);
+  EXPECT_EQ(*std::min_element(values.begin(), values.end()), stats.min());
+  EXPECT_EQ(*std::max_element(values.begin(), values.end()), stats.max());
+
+  std::sort(values.begin(), values.end());
+  EXPECT_NEAR(values[10000], median.value(), 0.01);
+  EXPECT_NEAR(values[18000], p90.value(), 0.01);
+
+  std::size_t total = 0;
+  for (auto count : histogram.counts()) {
+    EXPECT_NEAR(2000.0, count, 150.0);
+    total += count;
+  }
+  EXPECT_EQ(values.size(), total);
+  histogram.add(-0.5);
+  histogram.add(1.5);
+  EXPECT_EQ(1u, histogram.underflow());
+  EXPECT_EQ(1u, histogram.overflow());
+
+  // Exact for the first few values.
+  P2Quantile few(0.5);
+  few.add(3.0);
+  few.add(1.0);
+  few.add(2.0);
+  EXPECT_DOUBLE_EQ(2.0, few.value());
+}
+
+TEST_F(ISOModelFixture, MonteCarloSpecDrawsFromDistributions)
+{
+  Properties props;
+  props.putProperty("samples", "4000");
+  props.putProperty("seed", "11");
+  props.putProperty("quantiles", "0.1, 0.9");
+  props.putProperty("lightingPowerDensityOccupied", "normal, 10, 2");
+  props.putProperty("coolingSystemCOP", "triangular, 2, 3, 5");
+  props.putProperty("infiltrationRateOccupied", "lognormal, 1, 0.5");
+  props.putProperty("heatingSystemEfficiency", "uniform, 0.8, 0.9");
+  auto spec = MonteCarloSpec::read(props);
+  EXPECT_EQ(4000u, spec.samples);
+  EXPECT_EQ((std::vector<double> { 0.1, 0.9 }), spec.quantiles);
+  ASSERT_EQ(4u, spec.parameters.size());
+  // Properties are kept in alphabetical order.
+  EXPECT_EQ("coolingsystemcop", spec.parameters[0].property);
+  EXPECT_EQ("triangular", spec.parameters[0].distribution);
+
+  std::vector<RunningStats> stats(4);
+  for (std::size_t i = 0; i < spec.samples; ++i) {
+    auto values = spec.sample(i);
+    for (std::size_t d = 0; d < values.size(); ++d) {
+      stats[d].add(values[d]);
+    }
+  }
+  EXPECT_EQ(spec.sample(17), spec.sample(17));
+  EXPECT_NE(spec.sample(17), spec.sample(18));
+
+  EXPECT_NEAR(10.0 / 3.0, stats[0].mean(), 0.05);
+  EXPECT_GE(stats[0].min(), 2.0);
+  EXPECT_LE(stats[0].max(), 5.0);
+  EXPECT_NEAR(0.85, stats[1].mean(), 0.005);
+  EXPECT_NEAR(std::exp(1.0 + 0.125), stats[2].mean(), 0.1);
+  EXPECT_NEAR(10.0, stats[3].mean(), 0.1);
+  EXPECT_NEAR(2.0, stats[3].standardDeviation(), 0.1);
+
+  props.putProperty("coolingSystemCOP", "gamma, 2, 3");
+  EXPECT_THROW(MonteCarloSpec::read(props), std::invalid_argument);
+  props.putProperty("coolingSystemCOP", "triangular, 3, 2, 5");
+  EXPECT_THROW(MonteCarloSpec::read(props), std::invalid_argument);
+  props.putProperty("coolingSystemCOP", "normal, 3");
+  EXPECT_THROW(MonteCarloSpec::read(props), std::invalid_argument);
+}
+
+TEST_F(ISOModelFixture, MonteCarloIsReproducibleAcrossThreadCounts)
+{
+  MonteCarloSpec spec;
+  spec.samples = 40;
+  spec.seed = 5;
+  spec.chunk = 16;
+  spec.parameters = { UncertainParameter::parse("coolingsystemcop", "uniform, 2.5, 4"),
+                      UncertainParameter::parse("lightingpowerdensityoccupied", "normal, 8, 1") };
+
+  MonteCarlo monteCarlo(test_data_path + "/SmallOffice_v2.ism");
+  spec.threads = 1;
+  auto serial = monteCarlo.run(spec);
+  spec.threads = 3;
+  auto parallel = monteCarlo.run(spec);
+
+  EXPECT_EQ(40u, serial.samples());
+  EXPECT_EQ(0u, serial.failures());
+  for (int endUse = 0; endUse < 13; ++endUse) {
+    auto monthlyMeans = 0.0;
+    for (int period = 0; period < MonteCarloResults::periods; ++period) {
+      const auto& a = serial.statistics(endUse, period);
+      const auto& b = parallel.statistics(endUse, period);
+      EXPECT_EQ(a.stats.mean(), b.stats.mean());
+      EXPECT_EQ(a.stats.variance(), b.stats.variance());
+      ASSERT_EQ(3u, a.quantiles.size());
+      EXPECT_EQ(a.quantiles[1].value(), b.quantiles[1].value());
+      EXPECT_EQ(a.histogram.counts(), b.histogram.counts());
+      EXPECT_LE(a.quantiles[0].value(), a.quantiles[2].value());
+      EXPECT_LE(a.stats.min(), a.quantiles[0].value());
+      EXPECT_GE(a.stats.max(), a.quantiles[2].value());
+      if (period < 12) {
+        monthlyMeans += a.stats.mean();
+      }
+    }
+    EXPECT_NEAR(monthlyMeans, serial.statistics(endUse, 12).stats.mean(), 1e-9 * (1.0 + monthlyMeans));
+  }
+
+  // Uncertain lighting power spreads the lighting end use.
+  EXPECT_GT(serial.statistics(2, 12).stats.standardDeviation(), 0.0);
+
+  std::ostringstream summary;
+  serial.writeSummary(summary);
+  std::istringstream rows(summary.str());
+  std::string row;
+  std::getline(rows, row);
+  EXPECT_EQ("EndUse,Period,Count,Mean,StdDev,Min,Max,P5,P50,P95", row);
+  std::getline(rows, row);
+  EXPECT_EQ(0u, row.find("ElecHeat,1,40,"));
+}
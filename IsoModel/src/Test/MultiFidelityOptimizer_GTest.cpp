@@ -0,0 +1,112 @@
+/*
+ * MultiFidelityOptimizer_GTest.cpp
+ */
+
+#include "gtest/gtest.h"
+
+#include "ISOModelFixture.hpp"
+
+#include "../MultiFidelityOptimizer.hpp"
+
+#include <cmath>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+
+using namespace openstudio::isomodel;
+using namespace openstudio;
+
+TEST_F(ISOModelFixture, OptimizationSpecReadsTheSearch)
+{
+  Properties props;
+  props.putProperty("method", "sobol");
+  props.putProperty("samples", "64");
+  props.putProperty("objective", "ElecCool");
+  props.putProperty("pairs", "8");
+  props.putProperty("confidence", "1.5");
+  props.putProperty("verify", "true");
+  props.putProperty("coolingSystemCOP", "2.5, 4");
+  auto spec = OptimizationSpec::read(props);
+  EXPECT_EQ("sobol", spec.candidates.method);
+  EXPECT_EQ(64u, spec.candidates.samples);
+  ASSERT_EQ(1u, spec.candidates.properties.size());
+  EXPECT_EQ(8u, spec.pairs);
+  EXPECT_EQ(4u, spec.regions);
+  EXPECT_DOUBLE_EQ(1.5, spec.confidence);
+  EXPECT_TRUE(spec.verify);
+  auto weights = spec.objectiveWeights();
+  ASSERT_EQ(13u, weights.size());
+  EXPECT_EQ(1.0, weights[1]);
+  EXPECT_EQ(1.0, std::accumulate(weights.begin(), weights.end(), 0.0));
+
+  spec.objective = "gas";
+  weights = spec.objectiveWeights();
+  EXPECT_EQ(0.0, weights[8]);
+  EXPECT_EQ(1.0, weights[9]);
+
+  props.putProperty("objective", "comfort");
+  EXPECT_THROW(OptimizationSpec::read(props), std::invalid_argument);
+  props.putProperty("objective", "total");
+  props.putProperty("engine", "hourly");
+  EXPECT_THROW(OptimizationSpec::read(props), std::invalid_argument);
+}
+
+TEST_F(ISOModelFixture, MultiFidelityOptimizerAvoidsHourlyRuns)
+{
+  auto ismPath = test_data_path + "/SmallOffice_v2.ism";
+  OptimizationSpec spec;
+  spec.candidates.method = "sobol";
+  spec.candidates.samples = 32;
+  spec.candidates.threads = 2;
+  spec.candidates.properties = { "coolingsystemcop", "lightingpowerdensityoccupied" };
+  spec.candidates.values = { { 2.5, 4 }, { 5, 15 } };
+  spec.pairs = 4;
+  spec.regions = 2;
+  spec.batch = 2;
+  spec.verify = true;
+
+  MultiFidelityOptimizer optimizer(ismPath);
+  auto result = optimizer.run(spec);
+  EXPECT_EQ(32u, result.candidates);
+  EXPECT_EQ(0u, result.failures);
+  EXPECT_EQ(32u, result.monthlyRuns);
+  EXPECT_EQ(4u, result.pairedRuns);
+  EXPECT_EQ(result.pairedRuns + result.promotedRuns, result.hourlyRuns);
+  EXPECT_LT(result.hourlyRuns, 32u);
+  EXPECT_DOUBLE_EQ(1.0 - result.hourlyRuns / 32.0, result.hourlyRunsAvoided);
+  ASSERT_EQ(2u, result.regions.size());
+  EXPECT_EQ(32u, result.regions[0].candidates + result.regions[1].candidates);
+
+  // Verifying runs every candidate hourly: the search found the best, and
+  // the correction predicts the hourly objective better than the monthly
+  // model alone.
+  ASSERT_TRUE(result.verified);
+  EXPECT_EQ(0u, result.verificationFailures);
+  EXPECT_LT(result.optimalityGap, 0.01);
+  EXPECT_LT(result.correctedRmse, result.monthlyRmse);
+  EXPECT_LT(std::abs(result.objectiveError), 0.1);
+
+  std::ostringstream report;
+  result.write(report);
+  EXPECT_EQ(0u, report.str().find("Objective,total\nCandidates,32\n"));
+
+  // A wider margin promotes candidates the correction says can't win.
+  auto best = result.hourlyObjective;
+  spec.verify = false;
+  spec.confidence = 50;
+  result = optimizer.run(spec);
+  EXPECT_GT(result.promotedRuns, 0u);
+  EXPECT_GT(result.rounds, 0u);
+  EXPECT_EQ(best, result.hourlyObjective);
+
+  // A budget of hourly runs stops the search.
+  spec.confidence = 2;
+  spec.maxHourly = 3;
+  result = optimizer.run(spec);
+  EXPECT_EQ(3u, result.hourlyRuns);
+  EXPECT_EQ(0u, result.promotedRuns);
+  EXPECT_FALSE(result.verified);
+
+  spec.pairs = 1;
+  EXPECT_THROW(optimizer.run(spec), std::invalid_argument);
+}
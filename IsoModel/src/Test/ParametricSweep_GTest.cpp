@@ -0,0 +1,179 @@
+/*
+ * ParametricSweep_GTest.cpp
+ */
+
+#include "gtest/gtest.h"
+
+#include "ISOModelFixture.hpp"
+
+#include "../DesignOfExperiments.hpp"
+#include "../ParametricSweep.hpp"
+#include "../UserModel.hpp"
+
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+
+using namespace openstudio::isomodel;
+using namespace openstudio;
+
+TEST_F(ISOModelFixture, DesignOfExperimentsGenerators)
+{
+  std::vector<std::vector<double> > levels = { { 1.0, 2.0 }, { 10.0, 20.0, 30.0 } };
+  auto factorial = fullFactorial(levels);
+  ASSERT_EQ(6u, factorial.size());
+  EXPECT_EQ((std::vector<double> { 1.0, 10.0 }), factorial[0]);
+  EXPECT_EQ((std::vector<double> { 1.0, 20.0 }), factorial[1]);
+  EXPECT_EQ((std::vector<double> { 2.0, 30.0 }), factorial[5]);
+
+  // Each of the 16 strata of each dimension holds exactly one point.
+  for (auto design : { latinHypercube(16, 3, 7), sobolSequence(16, maxSobolDimensions()) }) {
+    ASSERT_EQ(16u, design.size());
+    for (std::size_t d = 0; d < design[0].size(); ++d) {
+      std::vector<int> counts(16, 0);
+      for (const auto& point : design) {
+        ASSERT_GE(point[d], 0.0);
+        ASSERT_LT(point[d], 1.0);
+        ++counts[static_cast<int>(point[d] * 16)];
+      }
+      EXPECT_EQ(16, std::count(counts.begin(), counts.end(), 1));
+    }
+  }
+  EXPECT_EQ(latinHypercube(8, 2, 1), latinHypercube(8, 2, 1));
+
+  auto sobol = sobolSequence(4, 2);
+  EXPECT_EQ((std::vector<double> { 0.0, 0.0 }), sobol[0]);
+  EXPECT_EQ((std::vector<double> { 0.5, 0.5 }), sobol[1]);
+  EXPECT_EQ((std::vector<double> { 0.75, 0.25 }), sobol[2]);
+  EXPECT_EQ((std::vector<double> { 0.25, 0.75 }), sobol[3]);
+  EXPECT_THROW(sobolSequence(4, maxSobolDimensions() + 1), std::invalid_argument);
+
+  auto halton = haltonSequence(3, 2);
+  EXPECT_DOUBLE_EQ(0.5, halton[0][0]);
+  EXPECT_DOUBLE_EQ(1.0 / 3.0, halton[0][1]);
+  EXPECT_DOUBLE_EQ(0.25, halton[1][0]);
+  EXPECT_DOUBLE_EQ(2.0 / 3.0, halton[1][1]);
+  EXPECT_DOUBLE_EQ(0.75, halton[2][0]);
+  EXPECT_DOUBLE_EQ(1.0 / 9.0, halton[2][1]);
+}
+
+TEST_F(ISOModelFixture, SweepSpecReadsProperties)
+{
+  Properties props;
+  props.putProperty("method", "sobol");
+  props.putProperty("samples", "8");
+  props.putProperty("engine", "hourly");
+  props.putProperty("coolingSystemCOP", "2, 4");
+  auto spec = SweepSpec::read(props);
+  EXPECT_TRUE(spec.hourly);
+  ASSERT_EQ(1u, spec.properties.size());
+  EXPECT_EQ("coolingsystemcop", spec.properties[0]);
+
+  auto variants = spec.variants();
+  ASSERT_EQ(8u, variants.size());
+  EXPECT_DOUBLE_EQ(2.0, variants[0][0]);
+  EXPECT_DOUBLE_EQ(3.0, variants[1][0]);
+
+  props.putProperty("coolingSystemCOP", "2, 3, 4");
+  EXPECT_THROW(SweepSpec::read(props), std::invalid_argument);
+  props.putProperty("method", "factorial");
+  EXPECT_EQ(3u, SweepSpec::read(props).variants().size());
+  props.putProperty("method", "grid");
+  EXPECT_THROW(SweepSpec::read(props), std::invalid_argument);
+
+  // Misspelt properties and whole nine-value properties are rejected; single values of the latter are not.
+  Properties nineValues;
+  nineValues.putProperty("method", "factorial");
+  nineValues.putProperty("wallArea[2]", "100, 200");
+  EXPECT_EQ((std::vector<std::string> { "wallarea[2]" }), SweepSpec::read(nineValues).properties);
+  for (auto key : { "coolingSystemCOPP", "wallU", "wallU[9]", "wallU[]", "coolingSystemCOP[0]" }) {
+    Properties bad = nineValues;
+    bad.putProperty(key, "1, 2");
+    EXPECT_THROW(SweepSpec::read(bad), std::invalid_argument) << key;
+  }
+  EXPECT_EQ(9u, UserModel::propertyNames().at("windowshgc"));
+  EXPECT_EQ(1u, UserModel::propertyNames().at("weatherfilepath"));
+}
+
+TEST_F(ISOModelFixture, ParametricSweepVariesOneOrientation)
+{
+  SweepSpec spec;
+  spec.method = "factorial";
+  spec.threads = 1;
+  spec.properties = { "windowarea[4]" };
+  spec.values = { { 0.0, 60.0 } };
+
+  ParametricSweep sweep(test_data_path + "/SmallOffice_v2.ism");
+  auto results = sweep.run(spec);
+  ASSERT_EQ(2u, results.size());
+
+  for (const auto& result : results) {
+    ASSERT_TRUE(result.error.empty()) << result.error;
+
+    // The .ism order is N, NE, E, SE, S, SW, W, NW, Roof, so 4 is the south window.
+    Properties props(test_data_path + "/SmallOffice_v2.ism");
+    std::vector<double> windowArea;
+    ASSERT_TRUE(props.getPropertyAsDoubleVector("windowarea", windowArea));
+    windowArea[4] = result.parameters[0];
+    std::ostringstream value;
+    for (std::size_t i = 0; i < windowArea.size(); ++i) {
+      value << (i ? ", " : "") << windowArea[i];
+    }
+    props.putProperty("windowarea", value.str());
+
+    UserModel userModel;
+    userModel.loadProperties(props, test_data_path + "/SmallOffice_v2.ism");
+    auto monthly = userModel.toMonthlyModel().simulate();
+    for (int j = 0; j < 13; ++j) {
+      auto total = 0.0;
+      for (auto& month : monthly) {
+        total += month.getEndUse(j);
+      }
+      EXPECT_NEAR(total, result.endUses[j], 1e-9 * (1.0 + total));
+    }
+  }
+  EXPECT_NE(results[0].endUses, results[1].endUses);
+}
+
+TEST_F(ISOModelFixture, ParametricSweepMatchesEditedModels)
+{
+  SweepSpec spec;
+  spec.method = "factorial";
+  spec.threads = 2;
+  spec.properties = { "coolingsystemcop", "lightingpowerdensityoccupied" };
+  spec.values = { { 2.5, 3.5 }, { 8.0, 12.0 } };
+
+  ParametricSweep sweep(test_data_path + "/SmallOffice_v2.ism");
+  auto results = sweep.run(spec);
+  ASSERT_EQ(4u, results.size());
+
+  for (std::size_t i = 0; i < results.size(); ++i) {
+    EXPECT_EQ(i, results[i].variant);
+    EXPECT_TRUE(results[i].error.empty());
+
+    UserModel userModel;
+    userModel.load(test_data_path + "/SmallOffice_v2.ism");
+    userModel.setCoolingSystemCOP(results[i].parameters[0]);
+    userModel.setLightingPowerIntensityOccupied(results[i].parameters[1]);
+    auto monthly = userModel.toMonthlyModel().simulate();
+    for (int j = 0; j < 13; ++j) {
+      auto total = 0.0;
+      for (auto& month : monthly) {
+        total += month.getEndUse(j);
+      }
+      EXPECT_NEAR(total, results[i].endUses[j], 1e-9 * (1.0 + total));
+    }
+  }
+
+  // Lighting power is the fastest varying property and adds to the lighting end use.
+  EXPECT_LT(results[0].endUses[2], results[1].endUses[2]);
+
+  std::ostringstream csv;
+  sweep.run(spec, csv);
+  std::istringstream rows(csv.str());
+  std::string row;
+  std::getline(rows, row);
+  EXPECT_EQ(0u, row.find("Variant,coolingsystemcop,lightingpowerdensityoccupied,ElecHeat"));
+  std::getline(rows, row);
+  EXPECT_EQ(0u, row.find("0,2.5,8,"));
+}
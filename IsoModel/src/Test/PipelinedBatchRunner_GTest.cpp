@@ -0,0 +1,119 @@
+/*
+ * PipelinedBatchRunner_GTest.cpp
+ */
+
+#include "gtest/gtest.h"
+
+#include "ISOModelFixture.hpp"
+
+#include "../BoundedQueue.hpp"
+#include "../PipelinedBatchRunner.hpp"
+
+#include <atomic>
+#include <ios>
+#include <sstream>
+#include <streambuf>
+#include <thread>
+
+using namespace openstudio::isomodel;
+using namespace openstudio;
+
+namespace {
+// A stream buffer that refuses every write.
+class FullBuffer : public std::streambuf
+{
+protected:
+  int_type overflow(int_type) override {
+    return traits_type::eof();
+  }
+};
+}
+
+TEST_F(ISOModelFixture, BoundedQueueAppliesBackpressure)
+{
+  BoundedQueue<int> queue(2);
+  std::atomic<int> pushed(0);
+  std::thread producer([&queue, &pushed]() {
+    for (int i = 0; i < 100; ++i) {
+      queue.push(i);
+      ++pushed;
+    }
+    queue.close();
+  });
+
+  int item = -1;
+  for (int i = 0; i < 100; ++i) {
+    ASSERT_TRUE(queue.pop(item));
+    EXPECT_EQ(i, item);
+    // The producer can never be more than the capacity ahead.
+    EXPECT_LE(pushed.load(), i + 1 + 2);
+    EXPECT_LE(queue.size(), 2u);
+  }
+  EXPECT_FALSE(queue.pop(item));
+  producer.join();
+  EXPECT_FALSE(queue.push(1));
+}
+
+TEST_F(ISOModelFixture, PipelinedBatchRunnerMatchesBatchRunner)
+{
+  auto ismPath = test_data_path + "/SmallOffice_v2.ism";
+  std::vector<BatchJob> jobs(9);
+  for (auto& job : jobs) {
+    job.ismPath = ismPath;
+  }
+  jobs[0].hourly = true;
+  jobs[3].ismPath = test_data_path + "/missing.ism";
+  jobs[6].hourly = true;
+
+  BatchSettings batchSettings;
+  batchSettings.threads = 1;
+  std::ostringstream expected;
+  auto expectedReport = BatchRunner(batchSettings).run(jobs, expected);
+
+  // Small queues and window so the stages wait on each other.
+  PipelineSettings settings;
+  settings.loaders = 2;
+  settings.simulators = 3;
+  settings.queueCapacity = 1;
+  settings.window = 3;
+  PipelinedBatchRunner runner(settings);
+  std::ostringstream out;
+  auto report = runner.run(jobs, out);
+
+  EXPECT_EQ(expected.str(), out.str());
+  EXPECT_EQ(expectedReport.succeeded, report.succeeded);
+  EXPECT_EQ(expectedReport.failures, report.failures);
+  EXPECT_EQ(1u, report.weatherFiles);
+
+  auto stats = runner.stats();
+  EXPECT_EQ(jobs.size(), stats.loading.items);
+  EXPECT_EQ(jobs.size(), stats.simulating.items);
+  EXPECT_EQ(jobs.size(), stats.writing.items);
+  EXPECT_EQ(3u, stats.simulating.threads);
+  EXPECT_GT(stats.simulating.busySeconds, 0.0);
+  EXPECT_GT(stats.simulating.capacity(), 0.0);
+
+  std::ostringstream csv;
+  stats.write(csv);
+  EXPECT_EQ(0u, csv.str().find("Stage,Threads,Items,BusySeconds,StarvedSeconds,BlockedSeconds,Capacity\nload,2,9,"));
+}
+
+TEST_F(ISOModelFixture, PipelinedBatchRunnerStopsWhenWritingFails)
+{
+  std::vector<BatchJob> jobs(12);
+  for (auto& job : jobs) {
+    job.ismPath = test_data_path + "/SmallOffice_v2.ism";
+  }
+
+  // The stages are left blocked on full queues and a closed window when the
+  // first write throws; they must still be stopped and joined.
+  PipelineSettings settings;
+  settings.loaders = 2;
+  settings.simulators = 2;
+  settings.queueCapacity = 1;
+  settings.window = 4;
+  FullBuffer full;
+  std::ostream out(&full);
+  out.exceptions(std::ios::badbit);
+  EXPECT_THROW(PipelinedBatchRunner(settings).run(jobs, out), std::ios_base::failure);
+}
@@ -0,0 +1,151 @@
+/*
+ * Portfolio_GTest.cpp
+ */
+
+#include "gtest/gtest.h"
+
+#include "ISOModelFixture.hpp"
+
+#include "../BatchRunner.hpp"
+#include "../Portfolio.hpp"
+#include "../UserModel.hpp"
+
+#include <cmath>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+using namespace openstudio::isomodel;
+using namespace openstudio;
+
+namespace {
+
+// Results whose every end use is value in every period.
+std::vector<EndUses> constantResults(std::size_t periods, double value)
+{
+  std::vector<EndUses> results(periods);
+  for (auto& result : results) {
+    for (int use = 0; use < 13; ++use) {
+      result.addEndUse(use, value);
+    }
+  }
+  return results;
+}
+
+BatchJob portfolioJob(double count, const std::string& type, const std::string& climate)
+{
+  BatchJob job;
+  job.count = count;
+  job.groups["type"] = type;
+  job.groups["climate"] = climate;
+  return job;
+}
+
+} // namespace
+
+TEST_F(ISOModelFixture, PortfolioAccumulatesWeightedTotals)
+{
+  std::vector<std::string> dimensions = { "type", "climate" };
+  PortfolioAccumulator first(dimensions, true), second(dimensions, true);
+  auto monthly = constantResults(12, 1.0);
+  auto hourly = constantResults(8760, 0.01);
+  first.add(portfolioJob(2, "office", "4A"), 100.0, monthly);
+  first.add(portfolioJob(1, "retail", "4A"), 50.0, monthly);
+  second.add(portfolioJob(3, "office", "5B"), 10.0, hourly);
+  auto truncated = constantResults(11, 1.0);
+  EXPECT_THROW(second.add(portfolioJob(1, "office", "5B"), 10.0, truncated), std::invalid_argument);
+  first.merge(second);
+
+  auto total = first.total();
+  EXPECT_DOUBLE_EQ(6.0, total.buildings);
+  EXPECT_DOUBLE_EQ(280.0, total.floorArea);
+  // 250 m2 at 1 kWh/m2 in each month, plus 30 m2 at 0.01 kWh/m2 in each hour.
+  EXPECT_NEAR(250.0 + 30 * 0.01 * 744, total.endUse(0, 0), 1e-9);
+  EXPECT_NEAR(9 * (250.0 + 30 * 0.01 * 744), total.electricity(0), 1e-8);
+  EXPECT_NEAR(4 * 12 * 250.0 + 4 * 30 * 0.01 * 8760, total.annual(9) + total.annual(10) + total.annual(11) + total.annual(12), 1e-7);
+
+  auto byType = first.by("type");
+  ASSERT_EQ(2u, byType.size());
+  EXPECT_DOUBLE_EQ(5.0, byType["office"].buildings);
+  EXPECT_DOUBLE_EQ(50.0, byType["retail"].endUse(5, 3));
+  EXPECT_EQ(3u, first.groups().size());
+  EXPECT_THROW(first.by("vintage"), std::invalid_argument);
+
+  // Only the hourly building is in the coincident load.
+  EXPECT_DOUBLE_EQ(3.0, first.hourlyBuildings());
+  ASSERT_EQ(8760u * 13, first.hourly().size());
+  EXPECT_NEAR(30 * 0.01, first.hourly()[100 * 13 + 4], 1e-12);
+  EXPECT_NEAR(9 * 30 * 0.01, first.peak().second, 1e-12);
+
+  std::ostringstream out;
+  first.write(out);
+  std::string header, line;
+  std::istringstream rows(out.str());
+  std::getline(rows, header);
+  std::size_t count = 0;
+  while (std::getline(rows, line)) {
+    ++count;
+  }
+  // All, two types, two climates and three combinations, 13 rows each.
+  EXPECT_EQ(8u * 13, count);
+}
+
+TEST_F(ISOModelFixture, PortfolioRollupMergesThreads)
+{
+  PortfolioRollup rollup({ "type" });
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.push_back(std::thread([&rollup, t]() {
+      auto results = constantResults(12, 1.0);
+      for (int i = 0; i < 100; ++i) {
+        BatchJob job;
+        job.groups["type"] = t % 2 ? "office" : "retail";
+        rollup.add(job, 1.0, results);
+      }
+    }));
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  auto merged = rollup.merged();
+  EXPECT_DOUBLE_EQ(400.0, merged.total().buildings);
+  EXPECT_DOUBLE_EQ(200.0, merged.by("type")["office"].annual(2) / 12);
+}
+
+TEST_F(ISOModelFixture, BatchRunnerRollsUpAPortfolio)
+{
+  std::istringstream manifest("SmallOffice_v2.ism count=2 type=office\nSmallOffice_v2.ism hourly type=school climate=4A\n");
+  auto jobs = readBatchManifest(manifest, test_data_path, false);
+  ASSERT_EQ(2u, jobs.size());
+  EXPECT_DOUBLE_EQ(2.0, jobs[0].count);
+  EXPECT_EQ("office", jobs[0].groups["type"]);
+  EXPECT_TRUE(jobs[1].hourly);
+  EXPECT_EQ(2u, jobs[1].groups.size());
+  for (auto bad : { "SmallOffice_v2.ism count=0\n", "SmallOffice_v2.ism count=many\n", "SmallOffice_v2.ism type=office hourly\n" }) {
+    std::istringstream badManifest(bad);
+    EXPECT_THROW(readBatchManifest(badManifest, test_data_path, false), std::invalid_argument) << bad;
+  }
+
+  PortfolioRollup rollup({ "climate", "type" }, true);
+  BatchSettings settings;
+  settings.threads = 2;
+  auto report = BatchRunner(settings).run(jobs, rollup);
+  EXPECT_EQ(2u, report.succeeded);
+  auto portfolio = rollup.merged();
+
+  UserModel umodel;
+  umodel.load(jobs[0].ismPath);
+  auto monthly = umodel.toMonthlyModel().simulate();
+  auto hourly = umodel.toHourlyModel().simulate(true);
+  auto total = portfolio.total();
+  EXPECT_DOUBLE_EQ(3 * umodel.floorArea(), total.floorArea);
+  for (int month = 0; month < 12; ++month) {
+    for (int use = 0; use < 13; ++use) {
+      auto expected = umodel.floorArea() * (2 * monthly[month].getEndUse(use) + hourly[month].getEndUse(use));
+      EXPECT_NEAR(expected, total.endUse(month, use), 1e-9 * (1 + std::abs(expected)));
+    }
+  }
+  EXPECT_DOUBLE_EQ(1.0, portfolio.hourlyBuildings());
+  EXPECT_GT(portfolio.peak().second, 0.0);
+  EXPECT_EQ(1u, portfolio.by("climate").count(""));
+}
@@ -0,0 +1,186 @@
+/*
+ * ResultCache_GTest.cpp
+ */
+
+#include "gtest/gtest.h"
+
+#include "ISOModelFixture.hpp"
+
+#include "../BatchRunner.hpp"
+#include "../ModelHash.hpp"
+#include "../ResultCache.hpp"
+#include "../UserModel.hpp"
+
+#include <ctime>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+#include <boost/filesystem.hpp>
+
+using namespace openstudio::isomodel;
+using namespace openstudio;
+
+TEST_F(ISOModelFixture, StateHashCoversTheModel)
+{
+  auto ismPath = test_data_path + "/SmallOffice_v2.ism";
+  UserModel umodel;
+  umodel.load(ismPath);
+  ASSERT_TRUE(umodel.valid());
+  auto monthly = umodel.stateHash("monthly");
+  EXPECT_EQ(32u, monthly.toString().size());
+  EXPECT_NE(monthly, umodel.stateHash("hourly"));
+
+  UserModel reloaded;
+  reloaded.load(ismPath);
+  EXPECT_EQ(monthly, reloaded.stateHash("monthly"));
+
+  // A scalar, an element of a vector parameter and a flag.
+  auto cop = umodel.coolingSystemCOP();
+  umodel.setCoolingSystemCOP(cop + 0.5);
+  EXPECT_NE(monthly, umodel.stateHash("monthly"));
+  umodel.setCoolingSystemCOP(cop);
+  EXPECT_EQ(monthly, umodel.stateHash("monthly"));
+
+  auto area = umodel.wallAreaN();
+  umodel.setWallAreaN(area + 1);
+  EXPECT_NE(monthly, umodel.stateHash("monthly"));
+  umodel.setWallAreaN(area);
+
+  umodel.setForcedAirCooling(!umodel.forcedAirCooling());
+  EXPECT_NE(monthly, umodel.stateHash("monthly"));
+
+  ModelHasher zero, negativeZero;
+  zero.add(0.0);
+  negativeZero.add(-0.0);
+  EXPECT_EQ(zero.digest(), negativeZero.digest());
+}
+
+TEST_F(ISOModelFixture, ResultCacheStoresAndEvicts)
+{
+  auto directory = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("isomodel-cache-%%%%-%%%%");
+  UserModel umodel;
+  umodel.load(test_data_path + "/SmallOffice_v2.ism");
+  auto results = umodel.toMonthlyModel().simulate();
+  auto key = umodel.stateHash("monthly");
+
+  {
+    ResultCache cache(directory.string());
+    std::vector<EndUses> cached;
+    EXPECT_FALSE(cache.get(key, cached));
+    EXPECT_TRUE(cache.put(key, results));
+    ASSERT_TRUE(cache.get(key, cached));
+    ASSERT_EQ(results.size(), cached.size());
+    for (std::size_t month = 0; month < results.size(); ++month) {
+      for (int i = 0; i < 13; ++i) {
+        EXPECT_EQ(results[month].getEndUse(i), cached[month].getEndUse(i));
+      }
+    }
+    EXPECT_EQ(1u, cache.hits());
+    EXPECT_EQ(1u, cache.misses());
+
+    // Rewriting an entry replaces its bytes.
+    auto bytes = cache.bytes();
+    EXPECT_TRUE(cache.put(key, results));
+    EXPECT_EQ(bytes, cache.bytes());
+  }
+
+  // Another cache on the directory sees the entry, and a corrupt entry is a
+  // miss.
+  ResultCache reopened(directory.string());
+  auto entrySize = reopened.bytes();
+  EXPECT_GT(entrySize, 0u);
+  std::vector<EndUses> cached;
+  EXPECT_TRUE(reopened.get(key, cached));
+  auto entryPath = directory / (key.toString() + ".result");
+  {
+    // Overwrite the stored key.
+    std::fstream corrupt(entryPath.string(), std::ios::in | std::ios::out | std::ios::binary);
+    corrupt.seekp(8);
+    corrupt.write("corrupt!", 8);
+  }
+  EXPECT_FALSE(reopened.get(key, cached));
+  EXPECT_FALSE(boost::filesystem::exists(entryPath));
+  EXPECT_EQ(0u, reopened.bytes());
+
+  // Threads reading and writing the same entries.
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.push_back(std::thread([&reopened, &results, t]() {
+      for (std::uint64_t i = 0; i < 50; ++i) {
+        ModelHash shared;
+        shared.low = (i + t) % 8;
+        std::vector<EndUses> read;
+        if (reopened.get(shared, read)) {
+          EXPECT_EQ(results.size(), read.size());
+        } else {
+          EXPECT_TRUE(reopened.put(shared, results));
+        }
+      }
+    }));
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  std::size_t entries = 0;
+  for (boost::filesystem::directory_iterator iter(directory), end; iter != end; ++iter) {
+    EXPECT_EQ(entrySize, boost::filesystem::file_size(iter->path()));
+    ++entries;
+  }
+  EXPECT_EQ(8u, entries);
+
+  // Past the limit, the least recently used entries go.
+  ResultCache small(directory.string(), 8 * entrySize);
+  auto now = std::time(nullptr);
+  for (std::uint64_t i = 0; i < 8; ++i) {
+    ModelHash entry;
+    entry.low = i;
+    boost::filesystem::last_write_time(directory / (entry.toString() + ".result"), now - 100 + (i == 0 ? 50 : i));
+  }
+  ModelHash extra;
+  extra.high = 1;
+  EXPECT_TRUE(small.put(extra, results));
+  EXPECT_LE(small.bytes(), 6 * entrySize);
+  EXPECT_EQ(3u, small.evictions());
+  ModelHash entry;
+  entry.low = 0;
+  EXPECT_TRUE(small.get(entry, cached));
+  entry.low = 1;
+  EXPECT_FALSE(small.get(entry, cached));
+  EXPECT_TRUE(small.get(extra, cached));
+
+  boost::filesystem::remove_all(directory);
+}
+
+TEST_F(ISOModelFixture, BatchRunnerUsesTheResultCache)
+{
+  auto directory = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("isomodel-cache-%%%%-%%%%");
+  std::vector<BatchJob> jobs(3);
+  for (auto& job : jobs) {
+    job.ismPath = test_data_path + "/SmallOffice_v2.ism";
+  }
+  jobs[1].hourly = true;
+
+  std::ostringstream expected;
+  BatchRunner().run(jobs, expected);
+
+  BatchSettings settings;
+  settings.threads = 2;
+  settings.resultCache = std::make_shared<ResultCache>(directory.string());
+  std::ostringstream first, second;
+  auto report = BatchRunner(settings).run(jobs, first);
+  EXPECT_EQ(expected.str(), first.str());
+  EXPECT_EQ(3u, report.succeeded);
+  // The two monthly jobs are the same building.
+  std::size_t entries = 0;
+  for (boost::filesystem::directory_iterator iter(directory), end; iter != end; ++iter) {
+    ++entries;
+  }
+  EXPECT_EQ(2u, entries);
+
+  report = BatchRunner(settings).run(jobs, second);
+  EXPECT_EQ(expected.str(), second.str());
+  EXPECT_EQ(3u, report.cacheHits);
+
+  boost::filesystem::remove_all(directory);
+}
@@ -0,0 +1,115 @@
+/*
+ * RotationSweep_GTest.cpp
+ */
+
+#include "gtest/gtest.h"
+
+#include "ISOModelFixture.hpp"
+
+#include "../IrradianceCache.hpp"
+#include "../ParametricSweep.hpp"
+#include "../RotationSweep.hpp"
+#include "../SolarRadiation.hpp"
+#include "../UserModel.hpp"
+
+#include <sstream>
+#include <stdexcept>
+
+using namespace openstudio::isomodel;
+using namespace openstudio;
+
+TEST_F(ISOModelFixture, IrradianceCacheMatchesSolarRadiationAtTheBins)
+{
+  UserModel userModel;
+  userModel.load(test_data_path + "/SmallOffice_v2.ism");
+  IrradianceCache cache(*userModel.epwData());
+  EXPECT_EQ(72u, cache.bins());
+
+  TimeFrame frame;
+  SolarRadiation solar(&frame, userModel.epwData().get());
+  solar.Calculate();
+  auto expected = solar.eglobe();
+  auto hourly = cache.hourly(0);
+  ASSERT_EQ(expected.size(), hourly.size());
+  for (std::size_t i = 0; i < hourly.size(); ++i) {
+    for (int s = 0; s < NUM_SURFACES; ++s) {
+      EXPECT_NEAR(expected[i][s], hourly[i][s], 1e-9);
+    }
+  }
+
+  auto monthly = cache.monthly(360);
+  for (int m = 0; m < MONTHS; ++m) {
+    for (int s = 0; s < NUM_SURFACES; ++s) {
+      EXPECT_NEAR(solar.monthlySolarRadiation()[m][s], monthly(m, s), 1e-9);
+    }
+  }
+
+  EXPECT_THROW(IrradianceCache(*userModel.epwData(), 7), std::invalid_argument);
+}
+
+TEST_F(ISOModelFixture, IrradianceCacheRotatesTheWalls)
+{
+  UserModel userModel;
+  userModel.load(test_data_path + "/SmallOffice_v2.ism");
+  IrradianceCache cache(*userModel.epwData(), 5);
+
+  // A quarter turn clockwise moves each wall two directions along S, SE, E, ...
+  auto base = cache.monthly(0);
+  auto quarter = cache.monthly(90);
+  auto backwards = cache.monthly(-270);
+  auto between = cache.monthly(2.5);
+  auto next = cache.monthly(5);
+  for (int m = 0; m < MONTHS; ++m) {
+    for (int s = 0; s < NUM_SURFACES; ++s) {
+      EXPECT_NEAR(base(m, (s + 6) % NUM_SURFACES), quarter(m, s), 1e-9);
+      EXPECT_NEAR(quarter(m, s), backwards(m, s), 1e-9);
+      EXPECT_NEAR((base(m, s) + next(m, s)) / 2, between(m, s), 1e-9);
+    }
+  }
+}
+
+TEST_F(ISOModelFixture, RotationSweepMatchesTheUnrotatedBuilding)
+{
+  auto ismPath = test_data_path + "/SmallOffice_v2.ism";
+  RotationSweep sweep(ismPath);
+  ParametricSweep unrotated(ismPath);
+
+  // The monthly weather file data is rounded to six digits.
+  auto monthly = sweep.evaluate(0, false);
+  auto expected = unrotated.evaluate({}, {}, false);
+  for (int i = 0; i < 13; ++i) {
+    EXPECT_NEAR(expected[i], monthly[i], 1e-4 * (1 + expected[i]));
+  }
+
+  auto hourly = sweep.evaluate(0, true);
+  expected = unrotated.evaluate({}, {}, true);
+  for (int i = 0; i < 13; ++i) {
+    EXPECT_NEAR(expected[i], hourly[i], 1e-9 * (1 + expected[i]));
+  }
+
+  auto rotations = RotationSweep::rotations(45);
+  ASSERT_EQ(8u, rotations.size());
+  EXPECT_DOUBLE_EQ(315.0, rotations.back());
+  auto serial = sweep.run(rotations, false, 1);
+  auto parallel = sweep.run(rotations, false, 3);
+  ASSERT_EQ(8u, serial.size());
+  for (std::size_t i = 0; i < serial.size(); ++i) {
+    EXPECT_TRUE(serial[i].error.empty());
+    EXPECT_EQ(rotations[i], serial[i].rotation);
+    EXPECT_EQ(serial[i].endUses, parallel[i].endUses);
+  }
+  EXPECT_EQ(monthly, serial[0].endUses);
+  // Turning the windows on the long sides to face east and west changes the cooling.
+  EXPECT_NE(serial[0].endUses[1], serial[2].endUses[1]);
+
+  std::ostringstream csv;
+  sweep.run({ 0, 180 }, false, 1, csv);
+  std::istringstream rows(csv.str());
+  std::string row;
+  std::getline(rows, row);
+  EXPECT_EQ(0u, row.find("Rotation,ElecHeat,"));
+  std::getline(rows, row);
+  EXPECT_EQ(0u, row.find("0,"));
+  std::getline(rows, row);
+  EXPECT_EQ(0u, row.find("180,"));
+}
@@ -0,0 +1,130 @@
+/*
+ * SensitivityAnalysis_GTest.cpp
+ */
+
+#include "gtest/gtest.h"
+
+#include "ISOModelFixture.hpp"
+
+#include "../CounterRng.hpp"
+#include "../SensitivityAnalysis.hpp"
+
+#include <cmath>
+#include <sstream>
+#include <stdexcept>
+
+using namespace openstudio::isomodel;
+using namespace openstudio;
+
+namespace {
+
+double ishigami(const std::vector<double>& x)
+{
+  return std::sin(x[0]) + 7 * std::pow(std::sin(x[1]), 2) + 0.1 * std::pow(x[2], 4) * std::sin(x[0]);
+}
+
+} // namespace
+
+TEST_F(ISOModelFixture, SobolEstimatorRecoversIshigamiIndices)
+{
+  const double pi = 3.14159265358979323846;
+  CounterRng rng(1);
+  SobolEstimator estimator(3, 1, 50, 2);
+  for (std::uint64_t j = 0; j < 20000; ++j) {
+    std::vector<double> a(3), b(3);
+    for (int i = 0; i < 3; ++i) {
+      a[i] = -pi + 2 * pi * rng.uniform(j, i);
+      b[i] = -pi + 2 * pi * rng.uniform(j, 3 + i);
+    }
+    std::vector<std::vector<double> > ab;
+    for (int i = 0; i < 3; ++i) {
+      auto x = a;
+      x[i] = b[i];
+      ab.push_back({ ishigami(x) });
+    }
+    estimator.add({ ishigami(a) }, { ishigami(b) }, ab);
+  }
+  EXPECT_EQ(20000u, estimator.rows());
+  EXPECT_NEAR(3.5, estimator.mean(0), 0.1);
+
+  // Analytic values for a = 7, b = 0.1.
+  const double firstOrder[] = { 0.3139, 0.4424, 0.0 };
+  const double total[] = { 0.5576, 0.4424, 0.2437 };
+  for (int i = 0; i < 3; ++i) {
+    auto index = estimator.index(0, i, 0.95);
+    EXPECT_NEAR(firstOrder[i], index.firstOrder, 0.04);
+    EXPECT_NEAR(total[i], index.total, 0.04);
+    EXPECT_LE(index.firstOrderLow, index.firstOrder);
+    EXPECT_GE(index.firstOrderHigh, index.firstOrder);
+    EXPECT_LE(index.totalLow, index.total);
+    EXPECT_GE(index.totalHigh, index.total);
+    EXPECT_LT(index.totalHigh - index.totalLow, 0.1);
+  }
+}
+
+TEST_F(ISOModelFixture, SensitivitySpecReadsBootstrapSettings)
+{
+  Properties props;
+  props.putProperty("samples", "64");
+  props.putProperty("bootstrap", "20");
+  props.putProperty("confidence", "0.9");
+  props.putProperty("coolingSystemCOP", "uniform, 2.5, 4");
+  auto spec = SensitivitySpec::read(props);
+  EXPECT_EQ(64u, spec.sampling.samples);
+  EXPECT_EQ(20u, spec.bootstrap);
+  EXPECT_DOUBLE_EQ(0.9, spec.confidence);
+  ASSERT_EQ(1u, spec.sampling.parameters.size());
+
+  props.putProperty("confidence", "1.5");
+  EXPECT_THROW(SensitivitySpec::read(props), std::invalid_argument);
+}
+
+TEST_F(ISOModelFixture, SensitivityAnalysisRanksBuildingProperties)
+{
+  SensitivitySpec spec;
+  spec.sampling.samples = 24;
+  spec.sampling.seed = 3;
+  spec.sampling.chunk = 10;
+  spec.bootstrap = 20;
+  spec.sampling.parameters = { UncertainParameter::parse("coolingsystemcop", "uniform, 2.5, 4"),
+                               UncertainParameter::parse("lightingpowerdensityoccupied", "uniform, 5, 12") };
+
+  SensitivityAnalysis analysis(test_data_path + "/SmallOffice_v2.ism");
+  spec.sampling.threads = 1;
+  auto serial = analysis.run(spec);
+  spec.sampling.threads = 3;
+  auto parallel = analysis.run(spec);
+
+  EXPECT_EQ(24u, serial.rows);
+  EXPECT_EQ(0u, serial.failures);
+  ASSERT_EQ(14u, serial.outputs.size());
+  EXPECT_EQ("Total", serial.outputs[13]);
+  for (std::size_t o = 0; o < serial.outputs.size(); ++o) {
+    for (std::size_t i = 0; i < 2; ++i) {
+      EXPECT_EQ(serial.indices[o][i].firstOrder, parallel.indices[o][i].firstOrder);
+      EXPECT_EQ(serial.indices[o][i].totalHigh, parallel.indices[o][i].totalHigh);
+    }
+  }
+
+  // Interior lighting depends only on the lighting power, and linearly.
+  const auto& cop = serial.indices[2][0];
+  const auto& lighting = serial.indices[2][1];
+  EXPECT_EQ(0.0, cop.firstOrder);
+  EXPECT_EQ(0.0, cop.total);
+  EXPECT_NEAR(1.0, lighting.total, 0.5);
+  EXPECT_NEAR(1.0, lighting.firstOrder, 0.5);
+  EXPECT_GT(serial.variances[2], 0.0);
+
+  // Cooling depends on both.
+  EXPECT_GT(serial.indices[1][0].total, 0.0);
+  EXPECT_GT(serial.indices[1][1].total, 0.0);
+
+  std::ostringstream csv;
+  serial.write(csv);
+  std::istringstream rows(csv.str());
+  std::string row;
+  std::getline(rows, row);
+  EXPECT_EQ("Output,Parameter,Mean,Variance,S1,S1Low,S1High,ST,STLow,STHigh", row);
+  std::getline(rows, row);
+  EXPECT_EQ(0u, row.find("ElecHeat,coolingsystemcop,"));
+}
@@ -0,0 +1,81 @@
+/*
+ * ShardedBatchRunner_GTest.cpp
+ */
+
+#include "gtest/gtest.h"
+
+#include "ISOModelFixture.hpp"
+
+#include "../ShardedBatchRunner.hpp"
+
+#include <sstream>
+#include <stdexcept>
+
+#include <boost/filesystem.hpp>
+
+using namespace openstudio::isomodel;
+using namespace openstudio;
+
+#ifndef _WIN32
+namespace {
+
+std::vector<BatchJob> mixedJobs(const std::string& test_data_path)
+{
+  auto ismPath = test_data_path + "/SmallOffice_v2.ism";
+  std::vector<BatchJob> jobs(7);
+  for (auto& job : jobs) {
+    job.ismPath = ismPath;
+  }
+  jobs[1].hourly = true;
+  jobs[4].ismPath = test_data_path + "/missing.ism";
+  return jobs;
+}
+
+} // namespace
+
+TEST_F(ISOModelFixture, ShardedBatchRunnerMatchesBatchRunner)
+{
+  // The workers are isomodel_batch processes, built next to the tests.
+  auto executable = boost::filesystem::read_symlink("/proc/self/exe").parent_path() / "isomodel_batch";
+  if (!boost::filesystem::exists(executable)) {
+    GTEST_SKIP() << executable.string() << " not found";
+  }
+
+  auto jobs = mixedJobs(test_data_path);
+  BatchSettings batchSettings;
+  batchSettings.threads = 1;
+  std::ostringstream expected;
+  auto expectedReport = BatchRunner(batchSettings).run(jobs, expected);
+
+  ShardedBatchSettings settings;
+  settings.workers = 3;
+  settings.range = 2;
+  settings.executable = executable.string();
+  std::ostringstream out;
+  auto report = ShardedBatchRunner(settings).run(jobs, out);
+
+  EXPECT_EQ(expected.str(), out.str());
+  EXPECT_EQ(expectedReport.succeeded, report.succeeded);
+  EXPECT_EQ(expectedReport.failures, report.failures);
+  EXPECT_EQ(1u, report.weatherFiles);
+}
+
+TEST_F(ISOModelFixture, ShardedBatchRunnerReportsLostWorkers)
+{
+  auto jobs = mixedJobs(test_data_path);
+  ShardedBatchSettings settings;
+  settings.workers = 2;
+  settings.executable = "false";
+  std::ostringstream out;
+  auto report = ShardedBatchRunner(settings).run(jobs, out);
+
+  EXPECT_EQ("", out.str());
+  EXPECT_EQ(0u, report.succeeded);
+  ASSERT_EQ(jobs.size(), report.failures.size());
+  EXPECT_NE(std::string::npos, report.failures[0].second.find("worker 1 exited with status 1"));
+
+  settings.executable.clear();
+  EXPECT_THROW(ShardedBatchRunner(settings).run(jobs, out), std::invalid_argument);
+  EXPECT_THROW(ShardedBatchRunner::work("/isomodel.missing", "unused.csv"), std::runtime_error);
+}
+#endif
@@ -0,0 +1,290 @@
+/*
+ * SimulationServer_GTest.cpp
+ */
+
+#include "gtest/gtest.h"
+
+#include "ISOModelFixture.hpp"
+
+#include "../ParametricSweep.hpp"
+#include "../SimulationServer.hpp"
+
+#include <cstring>
+#include <fstream>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+#ifndef _WIN32
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+using namespace openstudio::isomodel;
+using namespace openstudio;
+
+namespace {
+
+std::vector<double> decode(const std::string& body)
+{
+  std::vector<double> values(body.size() / sizeof(double));
+  std::memcpy(values.data(), body.data(), values.size() * sizeof(double));
+  return values;
+}
+
+std::vector<double> flatten(std::vector<EndUses> months)
+{
+  std::vector<double> values;
+  for (auto& month : months) {
+    for (int i = 0; i < 13; ++i) {
+#ifdef ISOMODEL_STANDALONE
+      values.push_back(month.getEndUse(i));
+#else
+      values.push_back(month.getEndUse(isoResultsEndUseTypes[i].first, isoResultsEndUseTypes[i].second));
+#endif
+    }
+  }
+  return values;
+}
+
+std::string frame(const std::string& command, const std::string& id, const std::string& body)
+{
+  return command + " " + id + " " + std::to_string(body.size()) + "\n" + body;
+}
+
+} // namespace
+
+TEST_F(ISOModelFixture, SimulationServerRunsDeltasAndCompleteBuildings)
+{
+  auto ismPath = test_data_path + "/SmallOffice_v2.ism";
+  SimulationServer server(2);
+  ParametricSweep sweep(ismPath);
+
+  auto response = server.handle("base = " + ismPath + "\nformat = binary\nlightingPowerDensityOccupied = 9\n");
+  ASSERT_TRUE(response.ok) << response.body;
+  EXPECT_EQ("binary", response.format);
+  ASSERT_EQ(156 * sizeof(double), response.body.size());
+  EXPECT_EQ(flatten(sweep.simulate({ "lightingpowerdensityoccupied" }, { 9 }, false)), decode(response.body));
+
+  // The hourly model uses the cached solar radiation.
+  response = server.handle("base = " + ismPath + "\nformat = Binary\nengine = hourly\n");
+  ASSERT_TRUE(response.ok) << response.body;
+  EXPECT_EQ(flatten(sweep.simulate({}, {}, true)), decode(response.body));
+  response = server.handle("base = " + ismPath + "\nformat = binary\nengine = hourly\n");
+  EXPECT_EQ(flatten(sweep.simulate({}, {}, true)), decode(response.body));
+
+  // A complete building, with the weather file made absolute.
+  std::ifstream file(ismPath);
+  std::stringstream building;
+  building << "weatherFilePath = " << test_data_path << "/ORD.epw\n" << file.rdbuf();
+  response = server.handle(building.str());
+  ASSERT_TRUE(response.ok) << response.body;
+  EXPECT_EQ("csv", response.format);
+  std::istringstream rows(response.body);
+  std::string row;
+  std::getline(rows, row);
+  EXPECT_EQ(0u, row.find("Month,ElecHeat,"));
+  int count = 0;
+  while (std::getline(rows, row)) {
+    ++count;
+  }
+  EXPECT_EQ(12, count);
+
+  EXPECT_FALSE(server.handle("base = " + ismPath + "\nengine = daily\n").ok);
+  response = server.handle("base = " + test_data_path + "/missing.ism\n");
+  EXPECT_FALSE(response.ok);
+  EXPECT_NE(std::string::npos, response.body.find("missing.ism"));
+  EXPECT_FALSE(server.handle("not a property\n").ok);
+
+  auto stats = server.stats();
+  EXPECT_EQ(0u, stats.requests);
+  EXPECT_EQ(1u, stats.weatherFiles);
+  EXPECT_EQ(1u, stats.buildings);
+  EXPECT_EQ(0u, stats.evictions);
+}
+
+TEST_F(ISOModelFixture, SimulationServerBoundsItsCaches)
+{
+  EXPECT_THROW(SimulationServer(1, 0), std::invalid_argument);
+
+  // The same building with and without a defaults file is two bases.
+  auto ismPath = test_data_path + "/SmallOffice_v2.ism";
+  auto withDefaults = "base = " + ismPath + "\ndefaults = " + test_data_path + "/defaults_test_defaults.ism\n";
+  SimulationServer server(1, 1, 1);
+  EXPECT_TRUE(server.handle("base = " + ismPath + "\nengine = hourly\n").ok);
+  auto response = server.handle(withDefaults);
+  EXPECT_TRUE(response.ok) << response.body;
+  auto stats = server.stats();
+  EXPECT_EQ(1u, stats.buildings);
+  EXPECT_EQ(1u, stats.evictions);
+
+  // Reloading the dropped building drops the other.
+  EXPECT_TRUE(server.handle("base = " + ismPath + "\n").ok);
+  stats = server.stats();
+  EXPECT_EQ(1u, stats.buildings);
+  EXPECT_EQ(2u, stats.evictions);
+}
+
+TEST_F(ISOModelFixture, SimulationServerAnswersPipelinedRequests)
+{
+  auto ismPath = test_data_path + "/SmallOffice_v2.ism";
+  SimulationServer server(3);
+
+  std::string requests;
+  for (int i = 0; i < 6; ++i) {
+    std::ostringstream body;
+    body << "base = " << ismPath << "\ncoolingSystemCOP = " << 2.5 + 0.2 * i << "\n";
+    requests += frame("run", "r" + std::to_string(i), body.str());
+  }
+  requests += frame("run", "bad", "engine = daily\n");
+  std::istringstream in(requests);
+  std::ostringstream out;
+  server.serve(in, out);
+
+  std::istringstream responses(out.str());
+  std::set<std::string> ids;
+  std::string status, id;
+  while (responses >> status >> id) {
+    std::string format;
+    if (status == "ok") {
+      responses >> format;
+      EXPECT_EQ("csv", format);
+    } else {
+      EXPECT_EQ("bad", id);
+    }
+    std::size_t length = 0;
+    responses >> length;
+    responses.ignore(1);
+    std::string body(length, '\0');
+    responses.read(&body[0], length);
+    ids.insert(id);
+  }
+  EXPECT_EQ(7u, ids.size());
+
+  auto stats = server.stats();
+  EXPECT_EQ(7u, stats.requests);
+  EXPECT_EQ(1u, stats.failures);
+  EXPECT_GT(stats.p50Milliseconds, 0.0);
+  EXPECT_LE(stats.p50Milliseconds, stats.p99Milliseconds);
+  EXPECT_LE(stats.p99Milliseconds, stats.maxMilliseconds);
+
+  // A malformed header ends the stream.
+  std::istringstream malformed(frame("simulate", "x", "") + frame("stats", "s", ""));
+  std::ostringstream answer;
+  server.serve(malformed, answer);
+  EXPECT_EQ(0u, answer.str().find("error - "));
+  EXPECT_EQ(std::string::npos, answer.str().find("ok s"));
+
+  // So does a body too large to accept, without trying to allocate it.
+  std::istringstream huge("run big 99999999999999\n" + frame("stats", "s", ""));
+  std::ostringstream refused;
+  server.serve(huge, refused);
+  EXPECT_EQ(0u, refused.str().find("error big "));
+  EXPECT_EQ(std::string::npos, refused.str().find("ok s"));
+}
+
+#ifndef _WIN32
+namespace {
+
+// Connects to the socket at path once the server is listening, or returns -1.
+int connectTo(const std::string& path)
+{
+  sockaddr_un address;
+  std::memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  std::strcpy(address.sun_path, path.c_str());
+  for (int attempt = 0; attempt < 500; ++attempt) {
+    int client = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (client < 0) {
+      return -1;
+    }
+    if (::connect(client, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0) {
+      return client;
+    }
+    ::close(client);
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  return -1;
+}
+
+std::string readAll(int client)
+{
+  std::string received;
+  char buffer[4096];
+  ssize_t count;
+  while ((count = ::read(client, buffer, sizeof(buffer))) > 0) {
+    received.append(buffer, count);
+  }
+  return received;
+}
+
+} // namespace
+
+TEST_F(ISOModelFixture, SimulationServerListensOnUnixSocket)
+{
+  auto path = "/tmp/isomodel_server_test_" + std::to_string(::getpid()) + ".sock";
+  SimulationServer server(1);
+
+  // The server listens again after it has been stopped.
+  for (int round = 0; round < 2; ++round) {
+    std::thread listener([&server, &path]() { server.listen(path); });
+
+    int client = connectTo(path);
+    if (client < 0) {
+      server.stop();
+      listener.join();
+      FAIL() << "Could not connect to " << path << " in round " << round;
+    }
+    auto request = frame("run", "1", "base = " + test_data_path + "/SmallOffice_v2.ism\nformat = binary\n") + frame("stats", "2", "");
+    ASSERT_EQ(static_cast<ssize_t>(request.size()), ::write(client, request.data(), request.size()));
+    ::shutdown(client, SHUT_WR);
+    auto received = readAll(client);
+    ::close(client);
+
+    // A client that stays connected without sending anything doesn't keep
+    // the server from stopping.
+    int idle = connectTo(path);
+    EXPECT_GE(idle, 0);
+    server.stop();
+    listener.join();
+    if (idle >= 0) {
+      EXPECT_EQ("", readAll(idle));
+      ::close(idle);
+    }
+
+    EXPECT_NE(std::string::npos, received.find("ok 1 binary 1248\n"));
+    EXPECT_NE(std::string::npos, received.find("ok 2 csv "));
+  }
+}
+
+TEST_F(ISOModelFixture, SimulationServerLimitsItsConnections)
+{
+  auto path = "/tmp/isomodel_server_limit_" + std::to_string(::getpid()) + ".sock";
+  SimulationServer server(1, 64, 16, 1);
+  std::thread listener([&server, &path]() { server.listen(path); });
+
+  int first = connectTo(path);
+  int second = connectTo(path);
+  if (first < 0 || second < 0) {
+    server.stop();
+    listener.join();
+    FAIL() << "Could not connect to " << path;
+  }
+  auto request = frame("stats", "s", "");
+  ASSERT_EQ(static_cast<ssize_t>(request.size()), ::write(second, request.data(), request.size()));
+  ::shutdown(second, SHUT_WR);
+
+  // The second connection waits until the first closes.
+  pollfd waiting = { second, POLLIN, 0 };
+  EXPECT_EQ(0, ::poll(&waiting, 1, 200));
+  ::close(first);
+  EXPECT_EQ(0u, readAll(second).find("ok s csv "));
+  ::close(second);
+
+  server.stop();
+  listener.join();
+}
+#endif
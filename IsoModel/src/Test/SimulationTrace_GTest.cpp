@@ -0,0 +1,84 @@
+/*
+ * SimulationTrace_GTest.cpp
+ */
+
+#include "gtest/gtest.h"
+
+#include "ISOModelFixture.hpp"
+
+#include "../SimulationTrace.hpp"
+#include "../UserModel.hpp"
+
+#include <memory>
+#include <sstream>
+
+using namespace openstudio::isomodel;
+using namespace openstudio;
+
+TEST_F(ISOModelFixture, SimulationTraceRecordsColumns)
+{
+  SimulationTrace trace;
+  trace.record("a", 1.0);
+  trace.record("b", 2.0);
+  trace.record("a", 3.0);
+
+  Vector vec(3);
+  vec[0] = 4.0;
+  vec[1] = 5.0;
+  vec[2] = 6.0;
+  trace.record("vec", vec);
+
+  ASSERT_EQ(3u, trace.columns().size());
+  EXPECT_EQ(2u, trace.column("a").records());
+  EXPECT_DOUBLE_EQ(3.0, trace.column("a").values[1]);
+  EXPECT_EQ(3u, trace.column("vec").width());
+  EXPECT_FALSE(trace.contains("c"));
+  EXPECT_THROW(trace.column("c"), std::out_of_range);
+  EXPECT_THROW(trace.record("vec", 1.0), std::invalid_argument);
+
+  std::ostringstream csv;
+  trace.writeCsv(csv);
+  EXPECT_EQ("a,b,vec[0],vec[1],vec[2]\n1,2,4,5,6\n3,,,,\n", csv.str());
+
+  std::stringstream binary;
+  trace.writeBinary(binary);
+  auto copy = SimulationTrace::readBinary(binary);
+  ASSERT_EQ(trace.columns().size(), copy.columns().size());
+  for (std::size_t i = 0; i < trace.columns().size(); ++i) {
+    EXPECT_EQ(trace.columns()[i].name, copy.columns()[i].name);
+    EXPECT_EQ(trace.columns()[i].values, copy.columns()[i].values);
+  }
+}
+
+TEST_F(ISOModelFixture, SimulationTraceCapturesModels)
+{
+  openstudio::isomodel::UserModel userModel;
+  userModel.load(test_data_path + "/SmallOffice_v2.ism");
+
+  auto trace = std::make_shared<SimulationTrace>();
+
+  MonthlyModel monthlyModel = userModel.toMonthlyModel();
+  auto untraced = monthlyModel.simulate();
+  monthlyModel.setTrace(trace);
+  auto traced = monthlyModel.simulate();
+  for (int i = 0; i < 12; ++i) {
+    for (int j = 0; j < 13; ++j) {
+#ifdef ISOMODEL_STANDALONE
+      EXPECT_EQ(untraced[i].getEndUse(j), traced[i].getEndUse(j));
+#else
+      EXPECT_EQ(untraced[i].getEndUse(isoResultsEndUseTypes[j].first, isoResultsEndUseTypes[j].second),
+                traced[i].getEndUse(isoResultsEndUseTypes[j].first, isoResultsEndUseTypes[j].second));
+#endif
+    }
+  }
+  ASSERT_TRUE(trace->contains("v_Th_avg"));
+  EXPECT_EQ(12u, trace->column("v_Th_avg").width());
+
+  trace->clear();
+  HourlyModel hourlyModel = userModel.toHourlyModel();
+  hourlyModel.setTrace(trace);
+  hourlyModel.simulate();
+  EXPECT_EQ(8760u, trace->column("TMT1").records());
+  EXPECT_EQ(8760u, trace->column("phiActual").records());
+  EXPECT_DOUBLE_EQ(8760.0, trace->column("hourOfYear").values.back());
+}
@@ -0,0 +1,105 @@
+/*
+ * Surrogate_GTest.cpp
+ */
+
+#include "gtest/gtest.h"
+
+#include "ISOModelFixture.hpp"
+
+#include "../ParametricSweep.hpp"
+#include "../Surrogate.hpp"
+
+#include <cmath>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+
+using namespace openstudio::isomodel;
+using namespace openstudio;
+
+TEST_F(ISOModelFixture, SurrogateSpecReadsTheFit)
+{
+  Properties props;
+  props.putProperty("method", "halton");
+  props.putProperty("samples", "50");
+  props.putProperty("degree", "2");
+  props.putProperty("ridge", "1e-6");
+  props.putProperty("coolingSystemCOP", "2.5, 4");
+  auto spec = SurrogateSpec::read(props);
+  EXPECT_EQ("halton", spec.sampling.method);
+  EXPECT_EQ(50u, spec.sampling.samples);
+  EXPECT_EQ(2u, spec.degree);
+  EXPECT_DOUBLE_EQ(1e-6, spec.ridge);
+
+  props.putProperty("degree", "-1");
+  EXPECT_THROW(SurrogateSpec::read(props), std::invalid_argument);
+  props.putProperty("degree", "2");
+  props.putProperty("method", "factorial");
+  EXPECT_THROW(SurrogateSpec::read(props), std::invalid_argument);
+}
+
+TEST_F(ISOModelFixture, SurrogatePredictsTheModel)
+{
+  ParametricSweep sweep(test_data_path + "/SmallOffice_v2.ism");
+  SurrogateSpec spec;
+  spec.sampling.method = "sobol";
+  spec.sampling.samples = 40;
+  spec.sampling.threads = 2;
+  spec.sampling.properties = { "coolingsystemcop", "lightingpowerdensityoccupied" };
+  spec.sampling.values = { { 2.5, 4 }, { 5, 15 } };
+  auto surrogate = Surrogate::train(sweep, spec);
+  EXPECT_EQ(10u, surrogate.terms());
+  EXPECT_EQ(40u, surrogate.samples());
+  EXPECT_EQ(Surrogate::outputs, surrogate.looRmse().size());
+
+  std::vector<double> x = { 3.3, 7.7 };
+  auto prediction = surrogate.predict(x);
+  auto actual = sweep.evaluate(spec.sampling.properties, x, false);
+  auto total = std::accumulate(actual.begin(), actual.end(), 0.0), predictedTotal = 0.0;
+  for (std::size_t use = 0; use < 13; ++use) {
+    predictedTotal += prediction.endUse(12, use);
+    EXPECT_GE(prediction.error(12, use), 0.0);
+  }
+  EXPECT_NEAR(total, predictedTotal, 0.01 * total);
+  // Interior lighting is linear in the lighting power density.
+  EXPECT_NEAR(actual[2], prediction.endUse(12, 2), 1e-6 * actual[2]);
+  EXPECT_THROW(surrogate.predict(std::vector<double>(3, 1.0)), std::invalid_argument);
+
+  // The compact path gives the same answers.
+  std::vector<double> scratch(surrogate.scratchSize()), values(Surrogate::outputs);
+  surrogate.predict(x.data(), scratch.data(), values.data());
+  EXPECT_EQ(prediction.values, values);
+  EXPECT_EQ(prediction.values[12 * 13 + 1], surrogate.predict(x.data(), scratch.data(), 12 * 13 + 1));
+
+  // A saved surrogate predicts the same.
+  std::stringstream file;
+  surrogate.write(file);
+  auto reloaded = Surrogate::read(file);
+  EXPECT_EQ(surrogate.properties(), reloaded.properties());
+  auto reloadedPrediction = reloaded.predict(x);
+  EXPECT_EQ(prediction.values, reloadedPrediction.values);
+  EXPECT_EQ(prediction.errors, reloadedPrediction.errors);
+  std::istringstream truncated(file.str().substr(0, file.str().size() - 8));
+  EXPECT_THROW(Surrogate::read(truncated), std::runtime_error);
+  std::istringstream garbage("not a surrogate");
+  EXPECT_THROW(Surrogate::read(garbage), std::runtime_error);
+  // A name length far past the end of the file.
+  auto corrupt = file.str();
+  auto nameLength = corrupt.find(surrogate.properties()[0]) - 4;
+  corrupt.replace(nameLength, 4, "\xff\xff\xff\xff");
+  std::istringstream huge(corrupt);
+  EXPECT_THROW(Surrogate::read(huge), std::runtime_error);
+
+  auto validation = surrogate.validate(sweep, 8, 1, 2);
+  EXPECT_EQ(8u, validation.points);
+  EXPECT_EQ(0u, validation.failures);
+  ASSERT_EQ(Surrogate::outputs, validation.rmse.size());
+  EXPECT_LT(validation.rmse[12 * 13 + 2], 1e-6 * actual[2]);
+  EXPECT_LT(validation.predictSeconds, validation.simulateSeconds);
+  EXPECT_GT(validation.predictOutputSeconds, 0.0);
+  EXPECT_LT(validation.predictOutputSeconds, validation.simulateSeconds);
+
+  // Too few runs for the terms.
+  spec.sampling.samples = 10;
+  EXPECT_THROW(Surrogate::train(sweep, spec), std::runtime_error);
+}
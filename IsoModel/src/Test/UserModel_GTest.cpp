@@ -12,6 +12,9 @@
 #include "../Properties.hpp"
 #include "../UserModel.hpp"
 
+#include <cmath>
+#include <stdexcept>
+
 using namespace openstudio::isomodel;
 
 TEST_F(ISOModelFixture, UserModelInitializationTests)
@@ -478,3 +481,68 @@ TEST_F(ISOModelFixture, UserModelOptionalPropertiesOverrideTests) {
   EXPECT_EQ(2, userModel.vent_rate_flag());
   EXPECT_DOUBLE_EQ(1.0, userModel.H_ve());
 }
+
+namespace {
+
+double annualEui(std::vector<openstudio::EndUses> results)
+{
+  auto eui = 0.0;
+  for (auto& month : results) {
+    for (int i = 0; i < 13; ++i) {
+#ifdef ISOMODEL_STANDALONE
+      eui += month.getEndUse(i);
+#else
+      eui += month.getEndUse(openstudio::isomodel::isoResultsEndUseTypes[i].first,
+                             openstudio::isomodel::isoResultsEndUseTypes[i].second);
+#endif
+    }
+  }
+  return eui;
+}
+
+double annualEui(const UserModel& userModel, bool hourly)
+{
+  return hourly ? annualEui(userModel.toHourlyModel().simulate(true)) : annualEui(userModel.toMonthlyModel().simulate());
+}
+
+} // namespace
+
+TEST_F(ISOModelFixture, UserModelGradientMatchesFiniteDifferences)
+{
+  UserModel userModel;
+  userModel.load(test_data_path + "/SmallOffice_v2.ism");
+
+  std::vector<std::string> parameters = { "lightingpowerdensityoccupied", "coolingsystemcop", "heatingsystemefficiency",
+    "infiltrationrateoccupied", "wallheatcapacity" };
+  EXPECT_THROW(userModel.gradient(parameters), std::invalid_argument);
+  parameters.back() = "interiorheatcapacity";
+
+  typedef double (UserModel::*Getter)() const;
+  typedef void (UserModel::*Setter)(double);
+  std::vector<std::pair<Getter, Setter>> accessors = {
+    { &UserModel::lightingPowerIntensityOccupied, &UserModel::setLightingPowerIntensityOccupied },
+    { &UserModel::coolingSystemCOP, &UserModel::setCoolingSystemCOP },
+    { &UserModel::heatingSystemEfficiency, &UserModel::setHeatingSystemEfficiency },
+    { &UserModel::buildingAirLeakage, &UserModel::setBuildingAirLeakage },
+    { &UserModel::interiorHeatCapacity, &UserModel::setInteriorHeatCapacity }
+  };
+
+  for (auto hourly : { false, true }) {
+    auto gradient = userModel.gradient(parameters, hourly);
+    ASSERT_EQ(parameters.size(), gradient.size());
+
+    for (std::size_t i = 0; i < parameters.size(); ++i) {
+      auto copy = userModel;
+      auto value = (copy.*accessors[i].first)();
+      // The hourly model switches between control branches from hour to hour,
+      // so keep the step small enough not to move any of the switches.
+      auto step = 1e-6 * value;
+      (copy.*accessors[i].second)(value + step);
+      auto above = annualEui(copy, hourly);
+      (copy.*accessors[i].second)(value - step);
+      auto below = annualEui(copy, hourly);
+      auto finiteDifference = (above - below) / (2.0 * step);
+      EXPECT_NEAR(finiteDifference, gradient[i], 1e-3 * std::fabs(finiteDifference) + 1e-6) << parameters[i] << (hourly ? " (hourly)" : " (monthly)");
+    }
+  }
+}
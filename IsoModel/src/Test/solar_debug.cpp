@@ -7,6 +7,7 @@
 
 #include "../UserModel.hpp"
 #include "../MonthlyModel.hpp"
+#include "../SimulationTrace.hpp"
 #include <iostream>
 
 #include <boost/program_options.hpp>
@@ -17,12 +18,11 @@ using namespace openstudio;
 void printMonthlySolar(UserModel umodel) {
     umodel.loadWeather();
     WeatherData wd = *umodel.weatherData();
-    Matrix msolar = wd.msolar();
-    Matrix mhEgh = wd.mhEgh();
-    Vector mEgh = wd.mEgh();
-    printMatrix("msolar", msolar);
-    printMatrix("mhEgh", mhEgh);
-    printVector("mEgh", mEgh);
+    SimulationTrace trace;
+    trace.record("msolar", wd.msolar());
+    trace.record("mhEgh", wd.mhEgh());
+    trace.record("mEgh", wd.mEgh());
+    trace.writeCsv(std::cout);
     std::cout << std::endl;
 }
 
@@ -86,10 +86,6 @@ int main(int argc, char* argv[])
     return 1; 
   } 
 
-  if (DEBUG_ISO_MODEL_SIMULATION) {
-    std::cout << "Loading User Model..." << std::endl;
-  }
-
   // Load the .ism file.
   openstudio::isomodel::UserModel umodel;
   umodel.load(vm["ismfilepath"].as<std::string>());
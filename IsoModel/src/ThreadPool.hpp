@@ -0,0 +1,67 @@
+#ifndef ISOMODEL_THREAD_POOL_HPP
+#define ISOMODEL_THREAD_POOL_HPP
+
+#include "ISOModelAPI.hpp"
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace openstudio {
+namespace isomodel {
+
+/**
+ * A fixed set of worker threads that run submitted tasks in submission order.
+ * The destructor finishes the queued tasks and joins the workers.
+ */
+class ISOMODEL_API ThreadPool
+{
+public:
+  /** Starts the given number of workers, or one per hardware thread if threads is 0. */
+  explicit ThreadPool(std::size_t threads = 0);
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  std::size_t size() const {
+    return m_workers.size();
+  }
+
+  /**
+   * Queues task to run on a worker. The returned future holds the task's
+   * result, or rethrows the exception it threw.
+   */
+  template<typename F>
+  auto submit(F task) -> std::future<decltype(task())>
+  {
+    typedef decltype(task()) Result;
+    auto packaged = std::make_shared<std::packaged_task<Result()> >(task);
+    auto result = packaged->get_future();
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_tasks.push_back([packaged]() { (*packaged)(); });
+    }
+    m_ready.notify_one();
+    return result;
+  }
+
+private:
+  void work();
+
+  std::vector<std::thread> m_workers;
+  std::deque<std::function<void()> > m_tasks;
+  std::mutex m_mutex;
+  std::condition_variable m_ready;
+  bool m_stopping;
+};
+
+} // isomodel
+} // openstudio
+#endif // ISOMODEL_THREAD_POOL_HPP
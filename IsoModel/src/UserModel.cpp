@@ -19,6 +19,10 @@
 
 #include "UserModel.hpp"
 
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+
 using namespace std;
 namespace openstudio {
 namespace isomodel {
@@ -71,6 +75,261 @@ MonthlyModel UserModel::toMonthlyModel() const
 
   return sim;
 }
+namespace {
+
+// The UserModel's parameters, converted to dual numbers for gradient().
+struct GradientParameters
+{
+  BasicPopulation<GradientDual> pop;
+  BasicLocation<GradientDual> location;
+  BasicLighting<GradientDual> lights;
+  BasicBuilding<GradientDual> building;
+  BasicStructure<GradientDual> structure;
+  BasicHeating<GradientDual> heating;
+  BasicCooling<GradientDual> cooling;
+  BasicVentilation<GradientDual> ventilation;
+  BasicPhysicalQuantities<GradientDual> phys;
+  BasicSimulationSettings<GradientDual> simSettings;
+};
+
+// Makes a parameter the independent variable with the given index.
+GradientDual seeded(const GradientDual& value, std::size_t index)
+{
+  return GradientDual::variable(value.value(), index);
+}
+
+struct DifferentiableParameter
+{
+  const char* name;
+  void (*seed)(GradientParameters& params, std::size_t index);
+};
+
+// The scalar parameters gradient() differentiates with respect to, by .ism
+// property name.
+const DifferentiableParameter differentiableParameterTable[] = {
+  { "floorarea", [](GradientParameters& p, std::size_t i) { p.structure.setFloorArea(seeded(p.structure.floorArea(), i)); } },
+  { "buildingheight", [](GradientParameters& p, std::size_t i) { p.structure.setBuildingHeight(seeded(p.structure.buildingHeight(), i)); } },
+  { "infiltrationrateoccupied", [](GradientParameters& p, std::size_t i) { p.structure.setInfiltrationRate(seeded(p.structure.infiltrationRate(), i)); } },
+  { "exteriorheatcapacity", [](GradientParameters& p, std::size_t i) { p.structure.setWallHeatCapacity(seeded(p.structure.wallHeatCapacity(), i)); } },
+  { "interiorheatcapacity", [](GradientParameters& p, std::size_t i) { p.structure.setInteriorHeatCapacity(seeded(p.structure.interiorHeatCapacity(), i)); } },
+  { "peopledensityoccupied", [](GradientParameters& p, std::size_t i) { p.pop.setDensityOccupied(seeded(p.pop.densityOccupied(), i)); } },
+  { "peopledensityunoccupied", [](GradientParameters& p, std::size_t i) { p.pop.setDensityUnoccupied(seeded(p.pop.densityUnoccupied(), i)); } },
+  { "heatgainperperson", [](GradientParameters& p, std::size_t i) { p.pop.setHeatGainPerPerson(seeded(p.pop.heatGainPerPerson(), i)); } },
+  { "lightingpowerdensityoccupied", [](GradientParameters& p, std::size_t i) { p.lights.setPowerDensityOccupied(seeded(p.lights.powerDensityOccupied(), i)); } },
+  { "lightingpowerdensityunoccupied", [](GradientParameters& p, std::size_t i) { p.lights.setPowerDensityUnoccupied(seeded(p.lights.powerDensityUnoccupied(), i)); } },
+  { "daylightsensordimmingfraction", [](GradientParameters& p, std::size_t i) { p.lights.setDimmingFraction(seeded(p.lights.dimmingFraction(), i)); } },
+  { "exteriorlightingpower", [](GradientParameters& p, std::size_t i) { p.lights.setExteriorEnergy(seeded(p.lights.exteriorEnergy(), i)); } },
+  { "electricappliancepowerdensityoccupied", [](GradientParameters& p, std::size_t i) { p.building.setElectricApplianceHeatGainOccupied(seeded(p.building.electricApplianceHeatGainOccupied(), i)); } },
+  { "electricappliancepowerdensityunoccupied", [](GradientParameters& p, std::size_t i) { p.building.setElectricApplianceHeatGainUnoccupied(seeded(p.building.electricApplianceHeatGainUnoccupied(), i)); } },
+  { "gasappliancepowerdensityoccupied", [](GradientParameters& p, std::size_t i) { p.building.setGasApplianceHeatGainOccupied(seeded(p.building.gasApplianceHeatGainOccupied(), i)); } },
+  { "gasappliancepowerdensityunoccupied", [](GradientParameters& p, std::size_t i) { p.building.setGasApplianceHeatGainUnoccupied(seeded(p.building.gasApplianceHeatGainUnoccupied(), i)); } },
+  { "coolingsetpointoccupied", [](GradientParameters& p, std::size_t i) { p.cooling.setTemperatureSetPointOccupied(seeded(p.cooling.temperatureSetPointOccupied(), i)); } },
+  { "coolingsetpointunoccupied", [](GradientParameters& p, std::size_t i) { p.cooling.setTemperatureSetPointUnoccupied(seeded(p.cooling.temperatureSetPointUnoccupied(), i)); } },
+  { "coolingsystemcop", [](GradientParameters& p, std::size_t i) { p.cooling.setCop(seeded(p.cooling.cop(), i)); } },
+  { "hvaccoolinglossfactor", [](GradientParameters& p, std::size_t i) { p.cooling.setHvacLossFactor(seeded(p.cooling.hvacLossFactor(), i)); } },
+  { "heatingsetpointoccupied", [](GradientParameters& p, std::size_t i) { p.heating.setTemperatureSetPointOccupied(seeded(p.heating.temperatureSetPointOccupied(), i)); } },
+  { "heatingsetpointunoccupied", [](GradientParameters& p, std::size_t i) { p.heating.setTemperatureSetPointUnoccupied(seeded(p.heating.temperatureSetPointUnoccupied(), i)); } },
+  { "heatingsystemefficiency", [](GradientParameters& p, std::size_t i) { p.heating.setEfficiency(seeded(p.heating.efficiency(), i)); } },
+  { "hvacheatinglossfactor", [](GradientParameters& p, std::size_t i) { p.heating.setHvacLossFactor(seeded(p.heating.hvacLossFactor(), i)); } },
+  { "hvacwastefactor", [](GradientParameters& p, std::size_t i) { p.heating.setHotcoldWasteFactor(seeded(p.heating.hotcoldWasteFactor(), i)); } },
+  { "dhwdemand", [](GradientParameters& p, std::size_t i) { p.heating.setHotWaterDemand(seeded(p.heating.hotWaterDemand(), i)); } },
+  { "dhwsystemefficiency", [](GradientParameters& p, std::size_t i) { p.heating.setHotWaterSystemEfficiency(seeded(p.heating.hotWaterSystemEfficiency(), i)); } },
+  { "ventilationintakerateoccupied", [](GradientParameters& p, std::size_t i) { p.ventilation.setSupplyRate(seeded(p.ventilation.supplyRate(), i)); } },
+  { "heatrecovery", [](GradientParameters& p, std::size_t i) { p.ventilation.setHeatRecoveryEfficiency(seeded(p.ventilation.heatRecoveryEfficiency(), i)); } },
+  { "specificfanpower", [](GradientParameters& p, std::size_t i) { p.ventilation.setFanPower(seeded(p.ventilation.fanPower(), i)); } },
+};
+
+const DifferentiableParameter& differentiableParameter(const std::string& name)
+{
+  for (const auto& parameter : differentiableParameterTable) {
+    if (name == parameter.name) {
+      return parameter;
+    }
+  }
+  throw std::invalid_argument("UserModel::gradient(): cannot differentiate with respect to '" + name + "'");
+}
+
+} // namespace
+
+std::vector<std::string> UserModel::differentiableParameters()
+{
+  std::vector<std::string> names;
+  for (const auto& parameter : differentiableParameterTable) {
+    names.push_back(parameter.name);
+  }
+  return names;
+}
+
+const std::map<std::string, std::size_t>& UserModel::propertyNames()
+{
+  // Collected from the loaders themselves, so the list can't drift from them.
+  static const std::map<std::string, std::size_t> names = []() {
+    std::map<std::string, std::size_t> recorded;
+    UserModel model;
+    model._recordedProperties = &recorded;
+    Properties none;
+    model.initializeParameters(none);
+    model.initializeStructure(none);
+    return recorded;
+  }();
+  return names;
+}
+
+bool UserModel::recordProperty(const std::string& propertyName, std::size_t values)
+{
+  if (!_recordedProperties) {
+    return false;
+  }
+  auto name = propertyName;
+  std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+  (*_recordedProperties)[name] = values;
+  return true;
+}
+
+std::vector<double> UserModel::gradient(const std::vector<std::string>& parameters, bool hourly) const
+{
+  // Check every name before running anything.
+  for (const auto& name : parameters) {
+    differentiableParameter(name);
+  }
+
+  std::vector<double> result;
+  for (std::size_t first = 0; first < parameters.size(); first += GradientDual::size) {
+    auto last = std::min(first + GradientDual::size, parameters.size());
+    std::vector<std::string> chunk(parameters.begin() + first, parameters.begin() + last);
+    auto derivatives = hourly ? gradientChunk<BasicHourlyModel<GradientDual>>(chunk)
+                              : gradientChunk<BasicMonthlyModel<GradientDual>>(chunk);
+    result.insert(result.end(), derivatives.begin(), derivatives.end());
+  }
+  return result;
+}
+
+namespace {
+
+// The hasher of this thread's stateHash() call.
+thread_local ModelHasher* currentHasher = nullptr;
+
+// A scalar that adds every value it is converted from to currentHasher.
+// Converting a component to its HashedScalar form hashes each of its
+// parameters in declaration order, through the converting constructor that
+// gradient() relies on to copy all of them.
+struct HashedScalar
+{
+  HashedScalar() {
+  }
+
+  HashedScalar(double value) {
+    currentHasher->add(value);
+  }
+};
+
+template<template<typename> class Component>
+void hashComponent(ModelHasher& hasher, const Component<double>& component)
+{
+  currentHasher = &hasher;
+  Component<HashedScalar> hashed(component);
+  currentHasher = nullptr;
+}
+
+void hashMatrix(ModelHasher& hasher, const Matrix& matrix)
+{
+  hasher.add(static_cast<std::uint64_t>(matrix.size1()));
+  hasher.add(static_cast<std::uint64_t>(matrix.size2()));
+  for (std::size_t i = 0; i < matrix.size1(); ++i) {
+    for (std::size_t j = 0; j < matrix.size2(); ++j) {
+      hasher.add(matrix(i, j));
+    }
+  }
+}
+
+void hashVector(ModelHasher& hasher, const Vector& vector)
+{
+  hasher.add(static_cast<std::uint64_t>(vector.size()));
+  for (auto value : vector) {
+    hasher.add(value);
+  }
+}
+
+} // namespace
+
+ModelHash UserModel::stateHash(const std::string& engine) const
+{
+  ModelHasher hasher;
+  hasher.add(engine);
+
+  hashComponent(hasher, pop);
+  hashComponent(hasher, location);
+  hashComponent(hasher, lights);
+  hashComponent(hasher, building);
+  hashComponent(hasher, structure);
+  hashComponent(hasher, heating);
+  hashComponent(hasher, cooling);
+  hashComponent(hasher, ventilation);
+  hashComponent(hasher, phys);
+  hashComponent(hasher, simSettings);
+  // The parameters that aren't scalars.
+  hasher.add(pop.scheduleFilePath());
+  hasher.add(static_cast<std::uint64_t>(heating.forcedAirHeating()));
+  hasher.add(static_cast<std::uint64_t>(cooling.forcedAirCooling()));
+  hasher.add(static_cast<std::uint64_t>(ventilation.vent_rate_flag()));
+
+  auto epwHash = _edata->contentHash();
+  hasher.add(epwHash.high);
+  hasher.add(epwHash.low);
+  auto weather = location.weather();
+  if (weather) {
+    hashMatrix(hasher, weather->msolar());
+    hashMatrix(hasher, weather->mhdbt());
+    hashMatrix(hasher, weather->mhEgh());
+    hashVector(hasher, weather->mEgh());
+    hashVector(hasher, weather->mdbt());
+    hashVector(hasher, weather->mwind());
+  }
+  return hasher.digest();
+}
+
+template<typename Model>
+std::vector<double> UserModel::gradientChunk(const std::vector<std::string>& parameters) const
+{
+  GradientParameters params;
+  params.pop = BasicPopulation<GradientDual>(pop);
+  params.location = BasicLocation<GradientDual>(location);
+  params.lights = BasicLighting<GradientDual>(lights);
+  params.building = BasicBuilding<GradientDual>(building);
+  params.structure = BasicStructure<GradientDual>(structure);
+  params.heating = BasicHeating<GradientDual>(heating);
+  params.cooling = BasicCooling<GradientDual>(cooling);
+  params.ventilation = BasicVentilation<GradientDual>(ventilation);
+  params.phys = BasicPhysicalQuantities<GradientDual>(phys);
+  params.simSettings = BasicSimulationSettings<GradientDual>(simSettings);
+
+  for (std::size_t i = 0; i < parameters.size(); ++i) {
+    differentiableParameter(parameters[i]).seed(params, i);
+  }
+
+  Model sim;
+  sim.setPop(params.pop);
+  sim.setBuilding(params.building);
+  sim.setCooling(params.cooling);
+  sim.setHeating(params.heating);
+  sim.setLights(params.lights);
+  sim.setStructure(params.structure);
+  sim.setVentilation(params.ventilation);
+  sim.setLocation(params.location);
+  sim.setEpwData(_edata);
+  sim.setSimulationSettings(params.simSettings);
+  sim.setPhysicalQuantities(params.phys);
+
+  auto endUses = sim.annualEndUses();
+  auto eui = std::accumulate(endUses.begin(), endUses.end(), GradientDual(0.0));
+
+  std::vector<double> derivatives;
+  for (std::size_t i = 0; i < parameters.size(); ++i) {
+    derivatives.push_back(eui.partial(i));
+  }
+  return derivatives;
+}
+
 //http://stackoverflow.com/questions/10051679/c-tokenize-string
 std::vector<std::string> inline stringSplit(const std::string &source, char delimiter = ' ', bool keepEmpty = false)
 {
@@ -255,6 +514,9 @@ void UserModel::initializeParameters(const Properties& buildingParams)
 }
 
 void UserModel::initializeParameter(void(UserModel::*setProp)(double), const Properties& props, std::string propertyName, bool required) {
+  if (recordProperty(propertyName, 1)) {
+    return;
+  }
   if (auto prop = props.getPropertyAsDouble(propertyName)) {
     (this->*setProp)(*prop);
   } else if (required) {
@@ -263,6 +525,9 @@ void UserModel::initializeParameter(void(UserModel::*setProp)(double), const Pro
 }
 
 void UserModel::initializeParameter(void(UserModel::*setProp)(int), const Properties& props, std::string propertyName, bool required) {
+  if (recordProperty(propertyName, 1)) {
+    return;
+  }
   if (auto prop = props.getPropertyAsInt(propertyName)) {
     (this->*setProp)(*prop);
   } else if (required) {
@@ -271,6 +536,9 @@ void UserModel::initializeParameter(void(UserModel::*setProp)(int), const Proper
 }
 
 void UserModel::initializeParameter(void(UserModel::*setProp)(bool), const Properties& props, std::string propertyName, bool required) {
+  if (recordProperty(propertyName, 1)) {
+    return;
+  }
   if (auto prop = props.getPropertyAsBool(propertyName)) {
     (this->*setProp)(*prop);
   } else if (required) {
@@ -279,8 +547,14 @@ void UserModel::initializeParameter(void(UserModel::*setProp)(bool), const Prope
 }
 
 void UserModel::initializeParameter(void(UserModel::*setProp)(const Vector&), const Properties& props, std::string propertyName, bool required) {
+  if (recordProperty(propertyName, 9)) {
+    return;
+  }
   Vector vec;
   if (props.getPropertyAsDoubleVector(propertyName, vec)) {
+    if (vec.size() != 9) {
+      throw std::invalid_argument("Property " + propertyName + " must have 9 values (N, NE, E, SE, S, SW, W, NW, Roof).");
+    }
     // TODO: Update the .ism format order to match the order used internall so we don't
     // have to do this reordering. BAA@2015-06-24.
     northToSouth(vec);
@@ -291,6 +565,9 @@ void UserModel::initializeParameter(void(UserModel::*setProp)(const Vector&), co
 }
 
 void UserModel::initializeParameter(void(UserModel::*setProp)(std::string), const Properties& props, std::string propertyName, bool required) {
+  if (recordProperty(propertyName, 1)) {
+    return;
+  }
   if (auto prop = props.getProperty(propertyName)) {
     (this->*setProp)(*prop);
   } else if (required) {
@@ -378,22 +655,46 @@ std::string UserModel::resolveFilename(std::string baseFile, std::string relativ
 
 void UserModel::loadWeather()
 {
-  std::string weatherFilename;
+  std::string weatherFilename = resolveWeatherFile(dataFile, _weatherFilePath);
+  bool found = true;
+  if (!boost::filesystem::exists(weatherFilename)) {
+    std::cout << "Weather File Not Found: " << _weatherFilePath << std::endl;
+    _valid = false;
+    found = false;
+  }
+
+  if (_weatherCache && found) {
+    // Parse the file into fresh objects, since the cached ones are shared
+    // with other models.
+    auto entry = _weatherCache->get(boost::filesystem::absolute(weatherFilename).string(), [&weatherFilename]() {
+      return loadWeatherFile(weatherFilename);
+    });
+    _edata = entry.epwData;
+    _weather = entry.weatherData;
+  } else {
+    _edata->loadData(weatherFilename);
+    initializeSolar();
+  }
+  location.setWeatherData(_weather);
+}
+
+std::string UserModel::resolveWeatherFile(const std::string& buildingFile, const std::string& weatherFilePath)
+{
   //see if weather file path is absolute path
   //if so, use it, else assemble relative path
-  if (boost::filesystem::exists(_weatherFilePath)) {
-    weatherFilename = _weatherFilePath;
-  } else {
-    weatherFilename = resolveFilename(dataFile, _weatherFilePath);
-    if (!boost::filesystem::exists(weatherFilename)) {
-      std::cout << "Weather File Not Found: " << _weatherFilePath << std::endl;
-      _valid = false;
-    }
+  if (boost::filesystem::exists(weatherFilePath)) {
+    return weatherFilePath;
   }
+  return resolveFilename(buildingFile, weatherFilePath);
+}
 
-  _edata->loadData(weatherFilename);
-  initializeSolar();
-  location.setWeatherData(_weather);
+WeatherCache::Entry UserModel::loadWeatherFile(const std::string& weatherFile)
+{
+  UserModel model;
+  model._edata->loadData(weatherFile);
+  model.initializeSolar();
+  WeatherCache::Entry loaded = { model._edata, model._weather };
+  return loaded;
 }
 
 void UserModel::loadAndSetWeather()
@@ -509,14 +810,8 @@ void UserModel::load(std::string buildingFile)
     _valid = false;
     return;
   }
-  if (DEBUG_ISO_MODEL_SIMULATION)
-    std::cout << "Loading Building File: " << buildingFile << std::endl;
   loadBuilding(buildingFile);
-  if (DEBUG_ISO_MODEL_SIMULATION)
-    std::cout << "Loading Weather File: " << weatherFilePath() << std::endl;
   loadWeather();
-  if (DEBUG_ISO_MODEL_SIMULATION)
-    std::cout << "Weather File Loaded" << std::endl;
 }
 
 void UserModel::load(std::string buildingFile, std::string defaultsFile)
@@ -538,18 +833,18 @@ void UserModel::load(std::string buildingFile, std::string defaultsFile)
     return;
   }
 
-  if (DEBUG_ISO_MODEL_SIMULATION)
-    std::cout << "Loading Building File: " << buildingFile << std::endl;
-
   loadBuilding(buildingFile, defaultsFile);
 
-  if (DEBUG_ISO_MODEL_SIMULATION)
-    std::cout << "Loading Weather File: " << weatherFilePath() << std::endl;
-
   loadWeather();
+}
 
-  if (DEBUG_ISO_MODEL_SIMULATION)
-    std::cout << "Weather File Loaded" << std::endl;
+void UserModel::loadProperties(const Properties& buildingParams, std::string buildingFile)
+{
+  dataFile = buildingFile;
+  _valid = true;
+  initializeParameters(buildingParams);
+  initializeStructure(buildingParams);
+  loadWeather();
 }
 } // isomodel
 } // openstudio
@@ -22,18 +22,21 @@
 
 #include "ISOModelAPI.hpp"
 #include "EpwData.hpp"
+#include "ModelHash.hpp"
 #include "MonthlyModel.hpp"
 #include "HourlyModel.hpp"
 #include "Properties.hpp"
+#include "WeatherCache.hpp"
 
 #include <boost/algorithm/string/predicate.hpp>
 #include <boost/filesystem.hpp>
 
+#include <map>
+
 namespace openstudio {
 
 namespace isomodel {
 
-class MonthlyModel;
 class WeatherData;
 
 const std::string GAS = "gas";
@@ -70,6 +73,13 @@ public:
   */
   void load(std::string buildingFile, std::string defaultsFile);
 
+  /**
+   * Loads an ISO model from properties already in memory, such as an .ism file
+   * read into a Properties and then modified. buildingFile is not read; a
+   * relative weather file path is resolved against it.
+   */
+  void loadProperties(const Properties& buildingParams, std::string buildingFile);
+
   /**
    * Loads the specified weather data from disk.
    * Exposed to allow for separate loading from Ruby Scripts
@@ -85,6 +95,28 @@ public:
 
   void loadAndSetWeather();
 
+  /**
+   * Shares parsed weather files with the other UserModels using the same cache.
+   * Set before load(); loadWeather() then parses each weather file only once
+   * across all of them. Pass an empty pointer to stop sharing (the default).
+   */
+  void setWeatherCache(std::shared_ptr<WeatherCache> cache) {
+    _weatherCache = cache;
+  }
+
+  /**
+   * The weather file loadWeather() reads for a building: weatherFilePath if
+   * it exists, otherwise weatherFilePath relative to the building file.
+   */
+  static std::string resolveWeatherFile(const std::string& buildingFile, const std::string& weatherFilePath);
+
+  /**
+   * Parses a weather file and summarizes it the way loadWeather() does,
+   * without a building. The result can be put in a WeatherCache ahead of the
+   * models that use it.
+   */
+  static WeatherCache::Entry loadWeatherFile(const std::string& weatherFile);
+
   /**
    * Generates a MonthlyModel from the properties of the UserModel.
    */
@@ -95,6 +127,39 @@ public:
    */
   HourlyModel toHourlyModel() const;
 
+  /**
+   * Returns the derivatives of the building's annual energy use intensity (the
+   * sum of the annual end uses, in kWh/m2) with respect to each of the named
+   * parameters, in order. The derivatives are exact, computed alongside the
+   * results by running the model with dual numbers, one run per
+   * GradientDual::size parameters. Runs the monthly model, or the hourly model
+   * if hourly is true. Parameters use their .ism property names; see
+   * differentiableParameters(). Throws std::invalid_argument for any other name.
+   */
+  std::vector<double> gradient(const std::vector<std::string>& parameters, bool hourly = false) const;
+
+  /**
+   * The names of the parameters gradient() accepts.
+   */
+  static std::vector<std::string> differentiableParameters();
+
+  /**
+   * The .ism properties a building is loaded from, by lowercase name, with
+   * the number of values each takes: 1, or 9 for the per-orientation ones
+   * such as wallArea.
+   */
+  static const std::map<std::string, std::size_t>& propertyNames();
+
+  /**
+   * Returns a hash of everything a simulation of the model depends on: every
+   * parameter of every component, the weather (the hourly data and the
+   * monthly summary the monthly model uses) and engine, which should name the
+   * engine and any options that change its results, e.g. "monthly" or
+   * "hourly". Models with equal hashes give the same results, so the hash
+   * can key a ResultCache.
+   */
+  ModelHash stateHash(const std::string& engine) const;
+
   /**
    * Indicates whether or not the user model loaded in correctly
    * If either the ISO file or the Weather File cannot be found
@@ -119,15 +184,25 @@ public:
   // ------------------------------------------------ //
 
   /// Gets a EpwData property.
-  const std::shared_ptr<EpwData> epwData() {
+  const std::shared_ptr<EpwData> epwData() const {
     return _edata;
   }
 
   /// Gets a WeatherData property.
-  const std::shared_ptr<WeatherData> weatherData() {
+  const std::shared_ptr<WeatherData> weatherData() const {
     return _weather;
   }
 
+  /**
+   * Replaces the monthly weather the models are built with, e.g. with a copy
+   * whose solar radiation is that of a rotated building. The hourly weather
+   * still comes from epwData().
+   */
+  void setWeatherData(std::shared_ptr<WeatherData> val) {
+    _weather = val;
+    location.setWeatherData(val);
+  }
+
   /// Gets a WeatherData property. Property name in .ism file: "weatherfilepath". Property is required.
   std::string weatherFilePath() const {
     return _weatherFilePath;
@@ -2259,13 +2334,17 @@ private:
 
   void setCoreSimulationProperties(Simulation& sim) const;
 
-  std::string resolveFilename(std::string baseFile, std::string relativeFile);
+  template<typename Model>
+  std::vector<double> gradientChunk(const std::vector<std::string>& parameters) const;
+
+  static std::string resolveFilename(std::string baseFile, std::string relativeFile);
   void initializeStructure(const Properties& buildingParams);
 
   std::map<LatLon, std::shared_ptr<WeatherData>> _weather_cache;
 
   std::shared_ptr<WeatherData> _weather;
   std::shared_ptr<EpwData> _edata;
+  std::shared_ptr<WeatherCache> _weatherCache;
 
   Population pop;
   Location location;
@@ -2303,6 +2382,13 @@ private:
   void initializeParameter(void(UserModel::*setProp)(const Vector&), const Properties& props, std::string propertyName, bool required);
   void initializeParameter(void(UserModel::*setProp)(std::string), const Properties& props, std::string propertyName, bool required);
 
+  /**
+   * While propertyNames() is collecting the names, records propertyName and
+   * its number of values and returns true so initializeParameter reads nothing.
+   */
+  bool recordProperty(const std::string& propertyName, std::size_t values);
+  std::map<std::string, std::size_t>* _recordedProperties = nullptr;
+
   /**
    * .ism file is N, NE, E, SE, S, SW, W, NW, Roof.
    * Structure is S, SE, E, NE, N, NW, W, SW, Roof.
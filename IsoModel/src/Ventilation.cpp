@@ -3,13 +3,7 @@
 namespace openstudio {
 namespace isomodel {
 
-Ventilation::Ventilation(void)
-{
-}
-
-Ventilation::~Ventilation(void)
-{
-}
+template class ISOMODEL_API BasicVentilation<double>;
 
 } // isomodel
 } // openstudio
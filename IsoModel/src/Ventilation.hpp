@@ -20,56 +20,85 @@
 #define ISOMODEL_VENTILATION_HPP
 
 #include "ISOModelAPI.hpp"
+#include "Dual.hpp"
 
 namespace openstudio {
 namespace isomodel {
-class ISOMODEL_API Ventilation
+template<typename T>
+class BasicVentilation
 {
 public:
-  Ventilation(void);
-  ~Ventilation(void);
+  BasicVentilation() {}
+
+  /** Converts the parameters from another scalar type. */
+  template<typename U>
+  explicit BasicVentilation(const BasicVentilation<U>& other) :
+      m_supplyRate(other.m_supplyRate),
+      m_supplyDifference(other.m_supplyDifference),
+      m_heatRecoveryEfficiency(other.m_heatRecoveryEfficiency),
+      m_exhaustAirRecirculated(other.m_exhaustAirRecirculated),
+      m_ventType(other.m_ventType),
+      m_fanPower(other.m_fanPower),
+      m_fanControlFactor(other.m_fanControlFactor),
+      m_ventPreheatDegC(other.m_ventPreheatDegC),
+      m_n50(other.m_n50),
+      m_hzone(other.m_hzone),
+      m_p_exp(other.m_p_exp),
+      m_zone_frac(other.m_zone_frac),
+      m_stack_exp(other.m_stack_exp),
+      m_stack_coeff(other.m_stack_coeff),
+      m_wind_exp(other.m_wind_exp),
+      m_wind_coeff(other.m_wind_coeff),
+      m_dCp(other.m_dCp),
+      m_vent_rate_flag(other.m_vent_rate_flag),
+      m_H_ve(other.m_H_ve),
+      m_infiltrationRateUnoccupied(other.m_infiltrationRateUnoccupied),
+      m_ventilationExhaustRateUnoccupied(other.m_ventilationExhaustRateUnoccupied),
+      m_ventilationIntakeRateUnoccupied(other.m_ventilationIntakeRateUnoccupied)
+  {
+  }
 
   /**
   * Ventilation intake rate occupied (L/s). Use 10 L/s/person as a default.
   */
-  double supplyRate() const {
+  T supplyRate() const {
     return m_supplyRate;
   }
 
-  void setSupplyRate(double value) {
+  void setSupplyRate(T value) {
     m_supplyRate = value;
   }
 
   /**
   * Ventilation exhaust rate occupied (L/s).
   */
-  double supplyDifference() const {
+  T supplyDifference() const {
     return m_supplyDifference;
   }
 
-  void setSupplyDifference(double value) {
+  void setSupplyDifference(T value) {
     m_supplyDifference = value;
   }
 
   /**
   * Efficiency of heat recovery (unitless. Use 0.0 for no heat recovery).
   */
-  double heatRecoveryEfficiency() const {
+  T heatRecoveryEfficiency() const {
     return m_heatRecoveryEfficiency;
   }
 
-  void setHeatRecoveryEfficiency(double value) {
+  void setHeatRecoveryEfficiency(T value) {
     m_heatRecoveryEfficiency = value;
   }
 
   /**
   * Fraction of supply air recirculated (unitless).
   */
-  double exhaustAirRecirculated() const {
+  T exhaustAirRecirculated() const {
     return m_exhaustAirRecirculated;
   }
 
-  void setExhaustAirRecirculated(double value) {
+  void setExhaustAirRecirculated(T value) {
     m_exhaustAirRecirculated = value;
   }
 
@@ -77,22 +106,22 @@ public:
   * Ventilation type (mechanical = 1.0, natural = 2.0, combined = 3.0).
   * XXX TODO: change this to an enum.
   */
-  double ventType() const {
+  T ventType() const {
     return m_ventType;
   }
 
-  void setVentType(double value) {
+  void setVentType(T value) {
     m_ventType = value;
   }
 
   /**
   * Specific fan power (W/(L/s)).
   */
-  double fanPower() const {
+  T fanPower() const {
     return m_fanPower;
   }
 
-  void setFanPower(double value) {
+  void setFanPower(T value) {
     m_fanPower = value;
   }
 
@@ -100,44 +129,44 @@ public:
   * Fan flow control factor (unitless). This is the energy reduction from fan control measures.
   * 1 = no control, 0.75 = inlet blade adjuct, 0.65 = variable speed see NEN 2916 7.3.3.4.
   */
-  double fanControlFactor() const {
+  T fanControlFactor() const {
     return m_fanControlFactor;
   }
 
-  void setFanControlFactor(double value) {
+  void setFanControlFactor(T value) {
     m_fanControlFactor = value;
   }
 
   /**
   * Ventilation preheat (C).
   */
-  double ventPreheatDegC() const {
+  T ventPreheatDegC() const {
     return m_ventPreheatDegC;
   }
 
-  void setVentPreheatDegC(double ventPreheatDegC) {
+  void setVentPreheatDegC(T ventPreheatDegC) {
     m_ventPreheatDegC = ventPreheatDegC;
   }
 
   /**
   * Air leakage at 50 Pa (air-changes/hr). See ISO 15242.
   */
-  double n50() const {
+  T n50() const {
     return m_n50;
   }
 
-  void setN50(double n50) {
+  void setN50(T n50) {
     m_n50 = n50;
   }
 
   /**
   * XXX: What is this variable? Wind related, see ISO 15242.
   */
-  double hzone() const {
+  T hzone() const {
     return m_hzone;
   }
 
-  void setHzone(double hzone) {
+  void setHzone(T hzone) {
     m_hzone = hzone;
   }
 
@@ -155,11 +184,11 @@ public:
   * Orm (1998), AIVC TN44: Numerical data for air infiltration and natural ventilation calculations, Air Infiltration and Ventilation Centre.
   * Emmerich, (2005), Investigation of the Impact of Commercial Building Envelope Airtightness on HVAC Energy Use.
   */
-  double p_exp() const {
+  T p_exp() const {
     return m_p_exp;
   }
 
-  void setP_exp(double p_exp) {
+  void setP_exp(T p_exp) {
     m_p_exp = p_exp;
   }
 
@@ -169,11 +198,11 @@ public:
   * Orm (1998), AIVC TN44: Numerical data for air infiltration and natural ventilation calculations, Air Infiltration and Ventilation Centre.
   * Emmerich, (2005), Investigation of the Impact of Commercial Building Envelope Airtightness on HVAC Energy Use.
   */
-  double zone_frac() const {
+  T zone_frac() const {
     return m_zone_frac;
   }
 
-  void setZone_frac(double zone_frac) {
+  void setZone_frac(T zone_frac) {
     m_zone_frac = zone_frac;
   }
 
@@ -183,11 +212,11 @@ public:
   * Orm (1998), AIVC TN44: Numerical data for air infiltration and natural ventilation calculations, Air Infiltration and Ventilation Centre.
   * Emmerich, (2005), Investigation of the Impact of Commercial Building Envelope Airtightness on HVAC Energy Use.
   */
-  double stack_exp() const {
+  T stack_exp() const {
     return m_stack_exp;
   }
 
-  void setStack_exp(double stack_exp) {
+  void setStack_exp(T stack_exp) {
     m_stack_exp = stack_exp;
   }
 
@@ -197,11 +226,11 @@ public:
   * Orm (1998), AIVC TN44: Numerical data for air infiltration and natural ventilation calculations, Air Infiltration and Ventilation Centre.
   * Emmerich, (2005), Investigation of the Impact of Commercial Building Envelope Airtightness on HVAC Energy Use.
   */
-  double stack_coeff() const {
+  T stack_coeff() const {
     return m_stack_coeff;
   }
 
-  void setStack_coeff(double stack_coeff) {
+  void setStack_coeff(T stack_coeff) {
     m_stack_coeff = stack_coeff;
   }
 
@@ -211,11 +240,11 @@ public:
   * Orm (1998), AIVC TN44: Numerical data for air infiltration and natural ventilation calculations, Air Infiltration and Ventilation Centre.
   * Emmerich, (2005), Investigation of the Impact of Commercial Building Envelope Airtightness on HVAC Energy Use.
   */
-  double wind_exp() const {
+  T wind_exp() const {
     return m_wind_exp;
   }
 
-  void setWind_exp(double wind_exp) {
+  void setWind_exp(T wind_exp) {
     m_wind_exp = wind_exp;
   }
 
@@ -225,11 +254,11 @@ public:
   * Orm (1998), AIVC TN44: Numerical data for air infiltration and natural ventilation calculations, Air Infiltration and Ventilation Centre.
   * Emmerich, (2005), Investigation of the Impact of Commercial Building Envelope Airtightness on HVAC Energy Use.
   */
-  double wind_coeff() const {
+  T wind_coeff() const {
     return m_wind_coeff;
   }
 
-  void setWind_coeff(double wind_coeff) {
+  void setWind_coeff(T wind_coeff) {
     m_wind_coeff = wind_coeff;
   }
 
@@ -239,11 +268,11 @@ public:
   * Orm (1998), AIVC TN44: Numerical data for air infiltration and natural ventilation calculations, Air Infiltration and Ventilation Centre.
   * Emmerich, (2005), Investigation of the Impact of Commercial Building Envelope Airtightness on HVAC Energy Use.
   */
-  double dCp() const {
+  T dCp() const {
     return m_dCp;
   }
 
-  void setDCp(double dCp) {
+  void setDCp(T dCp) {
     m_dCp = dCp;
   }
 
@@ -261,11 +290,11 @@ public:
   /**
   * Overall heat transfer coefficient by ventilation as per ISO 13790 9.3.
   */
-  double H_ve() const {
+  T H_ve() const {
     return m_H_ve;
   }
 
-  void setH_ve(double H_ve) {
+  void setH_ve(T H_ve) {
     m_H_ve = H_ve;
   }
 
@@ -273,63 +302,69 @@ public:
   /**
   *
   */
-  double infiltrationRateUnoccupied() const {
+  T infiltrationRateUnoccupied() const {
     return m_infiltrationRateUnoccupied;
   }
 
-  void setInfiltrationRateUnoccupied(double infiltrationRateUnoccupied) {
+  void setInfiltrationRateUnoccupied(T infiltrationRateUnoccupied) {
     m_infiltrationRateUnoccupied = infiltrationRateUnoccupied;
   }
 
   /**
   *
   */
-  double ventilationExhaustRateUnoccupied() const {
+  T ventilationExhaustRateUnoccupied() const {
     return m_ventilationExhaustRateUnoccupied;
   }
 
-  void setVentilationExhaustRateUnoccupied(double ventilationExhaustRateUnoccupied) {
+  void setVentilationExhaustRateUnoccupied(T ventilationExhaustRateUnoccupied) {
     m_ventilationExhaustRateUnoccupied = ventilationExhaustRateUnoccupied;
   }
 
   /**
   *
   */
-  double ventilationIntakeRateUnoccupied() const {
+  T ventilationIntakeRateUnoccupied() const {
     return m_ventilationIntakeRateUnoccupied;
   }
 
-  void setVentilationIntakeRateUnoccupied(double ventilationIntakeRateUnoccupied) {
+  void setVentilationIntakeRateUnoccupied(T ventilationIntakeRateUnoccupied) {
     m_ventilationIntakeRateUnoccupied = ventilationIntakeRateUnoccupied;
   }
 
 private:
-  double m_supplyRate;
-  double m_supplyDifference;
-  double m_heatRecoveryEfficiency;
-  double m_exhaustAirRecirculated;
-  double m_ventType;
-  double m_fanPower;
-  double m_fanControlFactor;
+  template<typename>
+  friend class BasicVentilation;
+
+  T m_supplyRate;
+  T m_supplyDifference;
+  T m_heatRecoveryEfficiency;
+  T m_exhaustAirRecirculated;
+  T m_ventType;
+  T m_fanPower;
+  T m_fanControlFactor;
   // Members with default values.
-  double m_ventPreheatDegC = -50.0;
-  double m_n50 = 2.0;
-  double m_hzone = 39.0;
-  double m_p_exp = 0.65;
-  double m_zone_frac = 0.7;
-  double m_stack_exp = 0.667;
-  double m_stack_coeff = 0.0146;
-  double m_wind_exp = 0.667;
-  double m_wind_coeff = 0.0769;
-  double m_dCp = 0.75;
+  T m_ventPreheatDegC = -50.0;
+  T m_n50 = 2.0;
+  T m_hzone = 39.0;
+  T m_p_exp = 0.65;
+  T m_zone_frac = 0.7;
+  T m_stack_exp = 0.667;
+  T m_stack_coeff = 0.0146;
+  T m_wind_exp = 0.667;
+  T m_wind_coeff = 0.0769;
+  T m_dCp = 0.75;
   int m_vent_rate_flag = 1;
-  double m_H_ve = 0.0;
+  T m_H_ve = 0.0;
 
   // TODO: These properties aren't used by the simulations yet -BAA@2015-06-18
-  double m_infiltrationRateUnoccupied;
-  double m_ventilationExhaustRateUnoccupied;
-  double m_ventilationIntakeRateUnoccupied;
+  T m_infiltrationRateUnoccupied = 0.0;
+  T m_ventilationExhaustRateUnoccupied = 0.0;
+  T m_ventilationIntakeRateUnoccupied = 0.0;
 };
+
+extern template class ISOMODEL_API BasicVentilation<double>;
+typedef BasicVentilation<double> Ventilation;
 } // isomodel
 } // openstudio
 #endif // ISOMODEL_VENTILATION_HPP
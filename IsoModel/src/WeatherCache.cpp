@@ -0,0 +1,53 @@
+#include "WeatherCache.hpp"
+
+namespace openstudio {
+namespace isomodel {
+
+WeatherCache::Entry WeatherCache::get(const std::string& path, const std::function<Entry()>& load)
+{
+  std::promise<Entry> promise;
+  std::shared_future<Entry> entry;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto iter = m_entries.find(path);
+    if (iter != m_entries.end()) {
+      entry = iter->second;
+    } else {
+      m_entries[path] = promise.get_future().share();
+    }
+  }
+
+  if (entry.valid()) {
+    return entry.get();
+  }
+
+  // This caller loads the file. Parse it outside the lock so other files can
+  // load at the same time.
+  try {
+    auto loaded = load();
+    promise.set_value(loaded);
+    return loaded;
+  } catch (...) {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_entries.erase(path);
+    }
+    promise.set_exception(std::current_exception());
+    throw;
+  }
+}
+
+std::size_t WeatherCache::size() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_entries.size();
+}
+
+void WeatherCache::clear()
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_entries.clear();
+}
+
+} // isomodel
+} // openstudio
@@ -0,0 +1,55 @@
+#ifndef ISOMODEL_WEATHER_CACHE_HPP
+#define ISOMODEL_WEATHER_CACHE_HPP
+
+#include "ISOModelAPI.hpp"
+
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace openstudio {
+namespace isomodel {
+
+class EpwData;
+class WeatherData;
+
+/**
+ * Parsed weather files shared between UserModels, keyed by the weather file
+ * path. Each file is parsed once, by the first model that asks for it; models
+ * asking for the same file at the same time wait for that parse rather than
+ * repeating it. Safe to use from several threads. The cached data is shared,
+ * so it must not be modified after it is loaded.
+ */
+class ISOMODEL_API WeatherCache
+{
+public:
+  struct Entry
+  {
+    std::shared_ptr<EpwData> epwData;
+    std::shared_ptr<WeatherData> weatherData;
+  };
+
+  /**
+   * Returns the cached entry for path, calling load to create it if this is
+   * the first request. If load throws, the exception is passed to every caller
+   * waiting on it, and the next request for path tries again.
+   */
+  Entry get(const std::string& path, const std::function<Entry()>& load);
+
+  /** The number of files loaded so far. */
+  std::size_t size() const;
+
+  void clear();
+
+private:
+  mutable std::mutex m_mutex;
+  std::map<std::string, std::shared_future<Entry> > m_entries;
+};
+
+} // isomodel
+} // openstudio
+#endif // ISOMODEL_WEATHER_CACHE_HPP
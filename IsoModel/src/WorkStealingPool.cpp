@@ -0,0 +1,87 @@
+#include "WorkStealingPool.hpp"
+
+#include <algorithm>
+#include <exception>
+#include <thread>
+
+namespace openstudio {
+namespace isomodel {
+
+WorkStealingPool::WorkStealingPool(std::size_t threads) : m_threads(threads), m_steals(0)
+{
+  if (m_threads == 0) {
+    m_threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  for (std::size_t i = 0; i < m_threads; ++i) {
+    m_queues.push_back(std::unique_ptr<Queue>(new Queue()));
+  }
+}
+
+bool WorkStealingPool::take(std::size_t worker, std::function<void()>& task)
+{
+  {
+    auto& own = *m_queues[worker];
+    std::lock_guard<std::mutex> lock(own.mutex);
+    if (!own.tasks.empty()) {
+      task = std::move(own.tasks.front());
+      own.tasks.pop_front();
+      return true;
+    }
+  }
+
+  // Steal from the back of the other queues, starting with the next worker's
+  // so the thieves spread out.
+  for (std::size_t offset = 1; offset < m_threads; ++offset) {
+    auto& other = *m_queues[(worker + offset) % m_threads];
+    std::lock_guard<std::mutex> lock(other.mutex);
+    if (!other.tasks.empty()) {
+      task = std::move(other.tasks.back());
+      other.tasks.pop_back();
+      ++m_steals;
+      return true;
+    }
+  }
+  return false;
+}
+
+void WorkStealingPool::run(std::vector<std::function<void()> > tasks)
+{
+  m_steals = 0;
+  for (std::size_t i = 0; i < tasks.size(); ++i) {
+    m_queues[i % m_threads]->tasks.push_back(std::move(tasks[i]));
+  }
+
+  // No tasks are added once the workers start, so a worker that finds every
+  // queue empty is done.
+  std::mutex errorMutex;
+  std::exception_ptr error;
+  auto work = [&](std::size_t worker) {
+    std::function<void()> task;
+    while (take(worker, task)) {
+      try {
+        task();
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(errorMutex);
+        if (!error) {
+          error = std::current_exception();
+        }
+      }
+    }
+  };
+
+  std::vector<std::thread> workers;
+  for (std::size_t i = 1; i < m_threads; ++i) {
+    workers.push_back(std::thread(work, i));
+  }
+  work(0);
+  for (auto& worker : workers) {
+    worker.join();
+  }
+
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
+} // isomodel
+} // openstudio
@@ -0,0 +1,67 @@
+#ifndef ISOMODEL_WORK_STEALING_POOL_HPP
+#define ISOMODEL_WORK_STEALING_POOL_HPP
+
+#include "ISOModelAPI.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace openstudio {
+namespace isomodel {
+
+/**
+ * Runs a set of tasks of uneven cost over a fixed number of threads. Each
+ * worker has its own queue and takes tasks from the front of it; a worker
+ * whose queue is empty steals from the back of another's. Unlike ThreadPool,
+ * which hands out tasks from one shared queue in submission order, workers
+ * only contend for a lock when they steal, so many tiny tasks stay cheap and
+ * a few long ones still spread across the threads.
+ */
+class ISOMODEL_API WorkStealingPool
+{
+public:
+  /** Uses the given number of workers, or one per hardware thread if threads is 0. */
+  explicit WorkStealingPool(std::size_t threads = 0);
+
+  WorkStealingPool(const WorkStealingPool&) = delete;
+  WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+  std::size_t size() const {
+    return m_threads;
+  }
+
+  /**
+   * Runs every task and returns when they have all finished. Task i starts on
+   * worker i % size(), so put the most expensive tasks first to start them
+   * early on separate workers. If any task throws, the remaining tasks still
+   * run and the first exception is rethrown here.
+   */
+  void run(std::vector<std::function<void()> > tasks);
+
+  /** The number of tasks run by a worker other than the one they were queued on, in the last run(). */
+  std::size_t steals() const {
+    return m_steals;
+  }
+
+private:
+  struct Queue
+  {
+    std::mutex mutex;
+    std::deque<std::function<void()> > tasks;
+  };
+
+  bool take(std::size_t worker, std::function<void()>& task);
+
+  std::size_t m_threads;
+  std::vector<std::unique_ptr<Queue> > m_queues;
+  std::atomic<std::size_t> m_steals;
+};
+
+} // isomodel
+} // openstudio
+#endif // ISOMODEL_WORK_STEALING_POOL_HPP
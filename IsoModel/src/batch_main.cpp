@@ -0,0 +1,258 @@
+/*
+ * batch_main.cpp
+ *
+ * Simulates many .ism files in one process (see BatchRunner and
+ * PipelinedBatchRunner), or in several worker processes started from this
+ * one (see ShardedBatchRunner).
+ */
+
+#include "BatchRunner.hpp"
+#include "PipelinedBatchRunner.hpp"
+#include "Portfolio.hpp"
+#include "ShardedBatchRunner.hpp"
+
+#include <csignal>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <boost/program_options.hpp>
+
+using namespace openstudio::isomodel;
+
+namespace {
+
+// The run's token, cancelled by the first Ctrl-C so the buildings already
+// simulated are still written. A second Ctrl-C kills the process.
+CancellationToken* interruption = nullptr;
+
+void interrupt(int)
+{
+  if (interruption) {
+    interruption->cancel();
+  }
+  std::signal(SIGINT, SIG_DFL);
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+  namespace po = boost::program_options;
+  po::options_description desc("Options");
+  desc.add_options()
+    ("input,i", po::value<std::vector<std::string> >(), "Manifest files, .ism files, directories or wildcard patterns (e.g. 'buildings/*.ism').")
+    ("monthly,m", "Run the monthly simulation (default).")
+    ("hourlyByMonth,h", "Run the hourly simulation (results aggregated by month).")
+    ("threads,t", po::value<std::size_t>()->default_value(0), "Worker threads (0 for one per hardware thread), or with --workers, threads per worker process (0 to share the hardware threads between them).")
+    ("grain,g", po::value<std::size_t>()->default_value(64), "Monthly runs per scheduled task.")
+    ("workers,w", po::value<std::size_t>()->default_value(0), "Run the buildings in this many worker processes sharing the parsed weather (0 to run them in this process).")
+    ("range,r", po::value<std::size_t>()->default_value(16), "With --workers, buildings a worker takes at a time.")
+    ("pipeline,p", "Load, simulate and write the buildings in separate stages; --threads sets the simulating threads.")
+    ("loaders,l", po::value<std::size_t>()->default_value(2), "With --pipeline, threads loading .ism and weather files.")
+    ("journal,j", po::value<std::string>(), "Record the finished buildings in the given journal file and, if it already records some, resume after them. Needs --output.")
+    ("cache,c", po::value<std::string>(), "Keep the results in this directory and reuse them for buildings simulated before, by any run using it.")
+    ("cache-size", po::value<double>()->default_value(1024), "With --cache, the megabytes of results to keep before the least recently used are removed.")
+    ("rollup", "Write portfolio totals by group and month, weighted by floor area and the manifest's count=N, instead of rows for each building.")
+    ("coincident", po::value<std::string>(), "With --rollup, also write the portfolio's hourly load, summed over the hourly buildings, to the given file.")
+    ("timeout", po::value<double>()->default_value(0), "Stop after this many seconds (0 for no limit), reporting the unfinished buildings as failures.")
+    ("output,o", po::value<std::string>(), "Write the results to the given file instead of stdout.");
+
+  po::options_description hidden;
+  hidden.add_options()
+    ("worker", po::value<std::string>(), "Run as a worker of the given shared memory segment, writing to --output.");
+  po::options_description all;
+  all.add(desc).add(hidden);
+
+  po::positional_options_description positionalOptions;
+  positionalOptions.add("input", -1);
+
+  po::variables_map vm;
+
+  try {
+    po::store(po::command_line_parser(argc, argv).options(all).positional(positionalOptions).run(), vm);
+    po::notify(vm);
+    if (!vm.count("input") && !vm.count("worker")) {
+      throw po::required_option("input");
+    }
+    if (vm.count("pipeline") && vm["workers"].as<std::size_t>() > 0) {
+      throw po::error("--pipeline and --workers can't be used together");
+    }
+    if (vm.count("journal") && !vm.count("output")) {
+      throw po::error("--journal needs --output");
+    }
+    if (vm.count("journal") && (vm.count("pipeline") || vm["workers"].as<std::size_t>() > 0)) {
+      throw po::error("--journal can't be used with --pipeline or --workers");
+    }
+    if (vm.count("cache") && vm["workers"].as<std::size_t>() > 0) {
+      throw po::error("--cache and --workers can't be used together");
+    }
+    if (vm["cache-size"].as<double>() <= 0) {
+      throw po::error("--cache-size must be positive");
+    }
+    if (vm.count("rollup") && (vm.count("pipeline") || vm.count("journal") || vm["workers"].as<std::size_t>() > 0)) {
+      throw po::error("--rollup can't be used with --pipeline, --journal or --workers");
+    }
+    if (vm.count("coincident") && !vm.count("rollup")) {
+      throw po::error("--coincident needs --rollup");
+    }
+    if (vm["timeout"].as<double>() < 0) {
+      throw po::error("--timeout can't be negative");
+    }
+    if (vm["timeout"].as<double>() > 0 && vm["workers"].as<std::size_t>() > 0) {
+      throw po::error("--timeout and --workers can't be used together");
+    }
+  }
+  catch (boost::program_options::error& e)
+  {
+    std::cerr << "ERROR: " << e.what() << std::endl << std::endl;
+    std::cerr << desc << std::endl;
+    return 1;
+  }
+
+  if (vm.count("worker")) {
+    try {
+      ShardedBatchRunner::work(vm["worker"].as<std::string>(), vm.count("output") ? vm["output"].as<std::string>() : std::string());
+    } catch (const std::exception& e) {
+      std::cerr << "ERROR: " << e.what() << std::endl;
+      return 1;
+    }
+    return 0;
+  }
+
+  std::vector<BatchJob> jobs;
+  try {
+    jobs = batchJobs(vm["input"].as<std::vector<std::string> >(), vm.count("hourlyByMonth") > 0);
+  } catch (const std::exception& e) {
+    std::cerr << "ERROR: " << e.what() << std::endl;
+    return 1;
+  }
+
+  std::ofstream file;
+  if (vm.count("output") && !vm.count("journal")) {
+    file.open(vm["output"].as<std::string>());
+    if (!file) {
+      std::cerr << "ERROR: Could not open " << vm["output"].as<std::string>() << std::endl;
+      return 1;
+    }
+  }
+  std::ostream& out = file.is_open() ? file : std::cout;
+
+  CancellationToken cancellation;
+  if (vm["timeout"].as<double>() > 0) {
+    cancellation.cancelAfter(vm["timeout"].as<double>());
+  }
+  if (vm["workers"].as<std::size_t>() == 0) {
+    interruption = &cancellation;
+    std::signal(SIGINT, interrupt);
+  }
+
+  std::shared_ptr<ResultCache> resultCache;
+  if (vm.count("cache")) {
+    try {
+      resultCache = std::make_shared<ResultCache>(vm["cache"].as<std::string>(),
+                                                  static_cast<std::uint64_t>(vm["cache-size"].as<double>() * 1024 * 1024));
+    } catch (const std::exception& e) {
+      std::cerr << "ERROR: " << e.what() << std::endl;
+      return 1;
+    }
+  }
+
+  // With a journal, the runner writes the output file itself.
+  if (!vm.count("journal") && !vm.count("rollup")) {
+    BatchRunner::writeHeader(out);
+  }
+  BatchReport report;
+  if (vm.count("rollup")) {
+    // Every attribute named in the manifests is a dimension.
+    std::set<std::string> names;
+    for (const auto& job : jobs) {
+      for (const auto& group : job.groups) {
+        names.insert(group.first);
+      }
+    }
+    PortfolioRollup rollup(std::vector<std::string>(names.begin(), names.end()), vm.count("coincident") > 0);
+    BatchSettings settings;
+    settings.threads = vm["threads"].as<std::size_t>();
+    settings.monthlyGrain = vm["grain"].as<std::size_t>();
+    settings.cancellation = cancellation;
+    settings.resultCache = resultCache;
+    report = BatchRunner(settings).run(jobs, rollup);
+
+    auto portfolio = rollup.merged();
+    portfolio.write(out);
+    if (vm.count("coincident")) {
+      std::ofstream hourly(vm["coincident"].as<std::string>());
+      if (!hourly) {
+        std::cerr << "ERROR: Could not open " << vm["coincident"].as<std::string>() << std::endl;
+        return 1;
+      }
+      portfolio.writeHourly(hourly);
+      auto electricity = portfolio.peak();
+      auto gas = portfolio.peak(true);
+      std::cerr << "Portfolio: " << portfolio.hourlyBuildings() << " buildings with hourly loads, electricity peaks at hour " << electricity.first + 1
+                << " (" << electricity.second << " kWh), gas at hour " << gas.first + 1 << " (" << gas.second << " kWh)" << std::endl;
+    }
+  } else if (vm.count("journal")) {
+    BatchSettings settings;
+    settings.threads = vm["threads"].as<std::size_t>();
+    settings.monthlyGrain = vm["grain"].as<std::size_t>();
+    settings.cancellation = cancellation;
+    settings.resultCache = resultCache;
+    try {
+      report = BatchRunner(settings).run(jobs, vm["output"].as<std::string>(), vm["journal"].as<std::string>());
+    } catch (const std::exception& e) {
+      std::cerr << "ERROR: " << e.what() << std::endl;
+      return 1;
+    }
+    if (report.resumed > 0) {
+      std::cerr << "Batch: resumed after " << report.resumed << " buildings recorded in the journal" << std::endl;
+    }
+  } else if (vm["workers"].as<std::size_t>() > 0) {
+    ShardedBatchSettings settings;
+    settings.workers = vm["workers"].as<std::size_t>();
+    settings.threads = vm["threads"].as<std::size_t>();
+    settings.range = vm["range"].as<std::size_t>();
+    settings.executable = argv[0];
+    try {
+      report = ShardedBatchRunner(settings).run(jobs, out);
+    } catch (const std::exception& e) {
+      std::cerr << "ERROR: " << e.what() << std::endl;
+      return 1;
+    }
+  } else if (vm.count("pipeline")) {
+    PipelineSettings settings;
+    settings.loaders = vm["loaders"].as<std::size_t>();
+    settings.simulators = vm["threads"].as<std::size_t>();
+    settings.cancellation = cancellation;
+    settings.resultCache = resultCache;
+    PipelinedBatchRunner runner(settings);
+    report = runner.run(jobs, out);
+    runner.stats().write(std::cerr);
+  } else {
+    BatchSettings settings;
+    settings.threads = vm["threads"].as<std::size_t>();
+    settings.monthlyGrain = vm["grain"].as<std::size_t>();
+    settings.cancellation = cancellation;
+    settings.resultCache = resultCache;
+    report = BatchRunner(settings).run(jobs, out);
+  }
+
+  for (const auto& failure : report.failures) {
+    std::cerr << "ERROR: " << failure.first << ": " << failure.second << std::endl;
+  }
+  std::cerr << "Batch: " << report.succeeded << " of " << jobs.size() << " buildings simulated in " << report.wallSeconds
+            << " s (" << report.weatherFiles << " weather files, " << report.steals << " tasks stolen)" << std::endl;
+  if (resultCache) {
+    std::cerr << "Batch: " << resultCache->hits() << " buildings from the result cache, " << resultCache->misses() << " simulated" << std::endl;
+  }
+  if (report.cancelled > 0) {
+    std::cerr << "Batch: cancelled, " << report.cancelled << " buildings stopped or skipped" << std::endl;
+  }
+
+  return report.failures.empty() ? 0 : 1;
+}
@@ -0,0 +1,96 @@
+/*
+ * server_main.cpp
+ *
+ * Serves simulation requests from stdin or a Unix domain socket, keeping
+ * weather and buildings loaded between them. See SimulationServer.
+ */
+
+#include "SimulationServer.hpp"
+
+#include <csignal>
+#include <iostream>
+#include <string>
+
+#include <boost/program_options.hpp>
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+using namespace openstudio::isomodel;
+
+namespace {
+
+SimulationServer* server = nullptr;
+
+extern "C" void stopServer(int)
+{
+  if (server) {
+    server->stop();
+  }
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+  namespace po = boost::program_options;
+  po::options_description desc("Options");
+  desc.add_options()
+    ("socket,s", po::value<std::string>(), "Listen on the Unix domain socket at the given path instead of reading requests from stdin.")
+    ("threads,t", po::value<std::size_t>()->default_value(0), "Worker threads (0 for one per hardware thread).")
+    ("buildings,b", po::value<std::size_t>()->default_value(64), "Base buildings to keep loaded, least recently used dropped first.")
+    ("weather,w", po::value<std::size_t>()->default_value(16), "Weather files to keep the wall solar radiation of, least recently used dropped first.")
+    ("connections,c", po::value<std::size_t>()->default_value(64), "With --socket, connections to serve at a time; more wait to be accepted.");
+
+  po::variables_map vm;
+
+  try {
+    po::store(po::command_line_parser(argc, argv).options(desc).run(), vm);
+    po::notify(vm);
+  }
+  catch (boost::program_options::error& e)
+  {
+    std::cerr << "ERROR: " << e.what() << std::endl << std::endl;
+    std::cerr << desc << std::endl;
+    return 1;
+  }
+
+  if (!vm["buildings"].as<std::size_t>() || !vm["weather"].as<std::size_t>() || !vm["connections"].as<std::size_t>()) {
+    std::cerr << "ERROR: --buildings, --weather and --connections must be at least 1" << std::endl;
+    return 1;
+  }
+
+  SimulationServer simulationServer(vm["threads"].as<std::size_t>(), vm["buildings"].as<std::size_t>(), vm["weather"].as<std::size_t>(),
+                                    vm["connections"].as<std::size_t>());
+  server = &simulationServer;
+
+  try {
+#ifdef _WIN32
+    simulationServer.serve(std::cin, std::cout);
+#else
+    // A client that goes away shouldn't take the server with it.
+    std::signal(SIGPIPE, SIG_IGN);
+    if (vm.count("socket")) {
+      std::signal(SIGINT, stopServer);
+      std::signal(SIGTERM, stopServer);
+      simulationServer.listen(vm["socket"].as<std::string>());
+    } else {
+      // UserModel reports some problems on stdout, so keep stdout for the
+      // responses and send everything else to stderr.
+      int responses = ::dup(STDOUT_FILENO);
+      ::dup2(STDERR_FILENO, STDOUT_FILENO);
+      simulationServer.serve(STDIN_FILENO, responses);
+      ::close(responses);
+    }
+#endif
+  } catch (const std::exception& e) {
+    std::cerr << "ERROR: " << e.what() << std::endl;
+    return 1;
+  }
+
+  auto stats = simulationServer.stats();
+  std::cerr << "Server: " << stats.requests << " requests (" << stats.failures << " failed), latency p50 " << stats.p50Milliseconds
+            << " ms, p99 " << stats.p99Milliseconds << " ms, max " << stats.maxMilliseconds << " ms" << std::endl;
+  return 0;
+}
@@ -5,19 +5,31 @@
  *      Author: nick
  */
 
+#include "Calibration.hpp"
 #include "UserModel.hpp"
 #include "MonthlyModel.hpp"
+#include "MonteCarlo.hpp"
+#include "MultiFidelityOptimizer.hpp"
+#include "ParametricSweep.hpp"
+#include "RotationSweep.hpp"
+#include "SensitivityAnalysis.hpp"
+#include "SimulationTrace.hpp"
+#include "Surrogate.hpp"
+#include <fstream>
 #include <iostream>
 #include <iomanip>
+#include <memory>
+#include <sstream>
 
 #include <boost/program_options.hpp>
 
 using namespace openstudio::isomodel;
 using namespace openstudio;
 
-void runMonthlySimulation(const UserModel& umodel) {
+void runMonthlySimulation(const UserModel& umodel, std::shared_ptr<SimulationTrace> trace) {
   // Run the monthly simulation.
   openstudio::isomodel::MonthlyModel monthlyModel = umodel.toMonthlyModel();
+  monthlyModel.setTrace(trace);
   auto monthlyResults = monthlyModel.simulate();
 
   std::cout << "Monthly Results:" << std::endl;
@@ -51,10 +63,32 @@ void runMonthlySimulation(const UserModel& umodel) {
   }
 }
 
-void runHourlySimulation(const UserModel& umodel, bool aggregateByMonth) {
+void runHourlySimulation(const UserModel& umodel, bool aggregateByMonth, std::shared_ptr<SimulationTrace> trace,
+                         const PararealSettings* parareal, const RepresentativeDaySettings* representative) {
   // Run the hourly simulation (with results aggregated by month).
   openstudio::isomodel::HourlyModel hourly = umodel.toHourlyModel();
-  auto hourlyResults = hourly.simulate(aggregateByMonth);
+  hourly.setTrace(trace);
+  std::vector<EndUses> hourlyResults;
+  if (parareal) {
+    PararealReport report;
+    hourlyResults = hourly.simulateParareal(aggregateByMonth, *parareal, &report);
+    std::cerr << "Parareal: " << report.iterations << " iterations, " << (report.converged ? "converged" : "not converged")
+              << " (max jump " << report.maxJump << " C), speedup " << report.speedup << "x ("
+              << report.sequentialSeconds << " s sequential, " << report.wallSeconds << " s wall)" << std::endl;
+  } else if (representative) {
+    RepresentativeDayReport report;
+    hourlyResults = hourly.simulateRepresentativeDays(aggregateByMonth, *representative, &report);
+    std::cerr << "Representative days: " << report.days.size() << " of 365 (" << report.dayTypes << " day types), "
+              << report.simulatedHours << " hours simulated (" << report.hourSpeedup << "x fewer), " << report.wallSeconds << " s"
+              << std::endl;
+    if (report.compared) {
+      std::cerr << "Against the full year: total error " << 100.0 * report.totalError << "%, monthly RMSE " << report.monthlyRmse
+                << " kWh/m2, worst month " << 100.0 * report.maxMonthlyError << "%, speedup " << report.speedup << "x ("
+                << report.fullSeconds << " s full)" << std::endl;
+    }
+  } else {
+    hourlyResults = hourly.simulate(aggregateByMonth);
+  }
 
   std::string monthOrHour = aggregateByMonth ? "month" : "hour";
   int numberOfResults = aggregateByMonth ? 12 : 8760;
@@ -135,7 +169,23 @@ int main(int argc, char* argv[])
     ("monthly,m", "Run the monthly simulation (default).")
     ("hourlyByMonth,h", "Run the hourly simulation (results aggregated by month.")
     ("hourlyByHour,H", "Run the hourly simulation (results for each hour).")
-    ("compare,c", po::value<std::string>(), "Run the monthly and hourly simulations and compare the results. Use 'md' for markdown and 'csv' for csv.");
+    ("compare,c", po::value<std::string>(), "Run the monthly and hourly simulations and compare the results. Use 'md' for markdown and 'csv' for csv.")
+    ("trace,t", po::value<std::string>(), "Capture intermediate values and write them to the given file. Files ending in .csv are written as CSV, others in the binary trace format.")
+    ("parareal,p", po::value<std::size_t>(), "Run the hourly simulation in parallel over the given number of threads (0 for all) with the Parareal method.")
+    ("representative", po::value<int>(), "Approximate the hourly simulation by simulating the given number of representative days of the year.")
+    ("representativeError", "With --representative, also run the full hourly simulation and print the error of the approximation.")
+    ("sweep,s", po::value<std::string>(), "Run variants of the building described by the given sweep spec file and write a CSV row per variant.")
+    ("montecarlo,u", po::value<std::string>(), "Propagate the uncertain properties declared in the given Monte Carlo spec file and write summary statistics of each end use by month.")
+    ("histograms", po::value<std::string>(), "With --montecarlo, also write the histograms to the given CSV file.")
+    ("sensitivity,y", po::value<std::string>(), "Compute first-order and total Sobol indices of the annual end uses for the uncertain properties declared in the given spec file.")
+    ("timeout", po::value<double>(), "With --sweep, --montecarlo, --sensitivity, --calibrate or --optimize, stop after this many seconds and write the results of the runs that finished.")
+    ("calibrate,k", po::value<std::string>(), "Fit the properties listed in the given calibration spec file to metered monthly electricity and gas use and write a report.")
+    ("optimize,o", po::value<std::string>(), "Search the candidates described by the given optimization spec file for the lowest hourly objective, screening them with the monthly simulation, and write a report.")
+    ("train", po::value<std::string>(), "Fit a surrogate to runs of the building sampled as described by the given surrogate spec file and write it to the --surrogate file.")
+    ("surrogate", po::value<std::string>(), "The surrogate file written by --train, or read by --predict and --validate.")
+    ("predict", po::value<std::string>(), "With --surrogate, write the surrogate's monthly and annual end uses, with their errors, at the given comma-separated property values.")
+    ("validate", po::value<std::size_t>(), "With --surrogate, compare the surrogate to this many runs of the building at random points in its ranges and write the errors.")
+    ("rotate,r", po::value<double>(), "Run the building turned clockwise through a full circle in steps of the given number of degrees and write a CSV row of annual end uses per orientation. Use with -h for the hourly simulation.");
 
   po::positional_options_description positionalOptions; 
   positionalOptions.add("ismfilepath", 1); 
@@ -160,8 +210,166 @@ int main(int argc, char* argv[])
     return 1; 
   } 
 
-  if (DEBUG_ISO_MODEL_SIMULATION) {
-    std::cout << "Loading User Model..." << std::endl;
+  if (vm.count("sweep")) {
+    try {
+      auto spec = SweepSpec::read(vm["sweep"].as<std::string>());
+      if (vm.count("timeout")) {
+        spec.cancellation.cancelAfter(vm["timeout"].as<double>());
+      }
+      auto defaults = vm.count("defaultsfilepath") ? vm["defaultsfilepath"].as<std::string>() : std::string();
+      ParametricSweep sweep(vm["ismfilepath"].as<std::string>(), defaults);
+      sweep.run(spec, std::cout);
+    } catch (const std::exception& e) {
+      std::cerr << "ERROR: " << e.what() << std::endl;
+      return 1;
+    }
+    return 0;
+  }
+
+  if (vm.count("montecarlo")) {
+    try {
+      auto spec = MonteCarloSpec::read(vm["montecarlo"].as<std::string>());
+      if (vm.count("timeout")) {
+        spec.cancellation.cancelAfter(vm["timeout"].as<double>());
+      }
+      auto defaults = vm.count("defaultsfilepath") ? vm["defaultsfilepath"].as<std::string>() : std::string();
+      MonteCarlo monteCarlo(vm["ismfilepath"].as<std::string>(), defaults);
+      auto results = monteCarlo.run(spec);
+      results.writeSummary(std::cout);
+      if (vm.count("histograms")) {
+        std::ofstream histograms(vm["histograms"].as<std::string>());
+        results.writeHistograms(histograms);
+      }
+      if (results.failures()) {
+        std::cerr << results.failures() << " samples failed. First error: " << results.firstError() << std::endl;
+      }
+      if (results.cancelled()) {
+        std::cerr << "Timed out after " << results.samples() << " samples" << std::endl;
+      }
+    } catch (const std::exception& e) {
+      std::cerr << "ERROR: " << e.what() << std::endl;
+      return 1;
+    }
+    return 0;
+  }
+
+  if (vm.count("rotate")) {
+    try {
+      auto defaults = vm.count("defaultsfilepath") ? vm["defaultsfilepath"].as<std::string>() : std::string();
+      RotationSweep sweep(vm["ismfilepath"].as<std::string>(), defaults);
+      sweep.run(RotationSweep::rotations(vm["rotate"].as<double>()), vm.count("hourlyByMonth") > 0, 0, std::cout);
+    } catch (const std::exception& e) {
+      std::cerr << "ERROR: " << e.what() << std::endl;
+      return 1;
+    }
+    return 0;
+  }
+
+  if (vm.count("calibrate")) {
+    try {
+      auto spec = CalibrationSpec::read(vm["calibrate"].as<std::string>());
+      if (vm.count("timeout")) {
+        spec.cancellation.cancelAfter(vm["timeout"].as<double>());
+      }
+      auto defaults = vm.count("defaultsfilepath") ? vm["defaultsfilepath"].as<std::string>() : std::string();
+      Calibration calibration(vm["ismfilepath"].as<std::string>(), defaults);
+      auto result = calibration.run(spec);
+      result.write(std::cout);
+      if (result.cancelled) {
+        std::cerr << "Timed out after " << result.evaluations << " evaluations" << std::endl;
+      }
+    } catch (const std::exception& e) {
+      std::cerr << "ERROR: " << e.what() << std::endl;
+      return 1;
+    }
+    return 0;
+  }
+
+  if (vm.count("optimize")) {
+    try {
+      auto spec = OptimizationSpec::read(vm["optimize"].as<std::string>());
+      if (vm.count("timeout")) {
+        spec.candidates.cancellation.cancelAfter(vm["timeout"].as<double>());
+      }
+      auto defaults = vm.count("defaultsfilepath") ? vm["defaultsfilepath"].as<std::string>() : std::string();
+      MultiFidelityOptimizer optimizer(vm["ismfilepath"].as<std::string>(), defaults);
+      auto result = optimizer.run(spec);
+      result.write(std::cout);
+      if (result.failures) {
+        std::cerr << result.failures << " candidates failed" << std::endl;
+      }
+      if (result.cancelled) {
+        std::cerr << "Timed out after " << result.hourlyRuns << " hourly runs" << std::endl;
+      }
+    } catch (const std::exception& e) {
+      std::cerr << "ERROR: " << e.what() << std::endl;
+      return 1;
+    }
+    return 0;
+  }
+
+  if (vm.count("train") || vm.count("predict") || vm.count("validate")) {
+    try {
+      if (!vm.count("surrogate")) {
+        throw std::invalid_argument("--train, --predict and --validate need a --surrogate file");
+      }
+      auto surrogatePath = vm["surrogate"].as<std::string>();
+      auto defaults = vm.count("defaultsfilepath") ? vm["defaultsfilepath"].as<std::string>() : std::string();
+      std::unique_ptr<ParametricSweep> sweep;
+      if (vm.count("train") || vm.count("validate")) {
+        sweep.reset(new ParametricSweep(vm["ismfilepath"].as<std::string>(), defaults));
+      }
+      if (vm.count("train")) {
+        auto spec = SurrogateSpec::read(vm["train"].as<std::string>());
+        auto surrogate = Surrogate::train(*sweep, spec);
+        surrogate.write(surrogatePath);
+        std::cerr << "Surrogate: " << surrogate.terms() << " terms fitted to " << surrogate.samples() << " runs" << std::endl;
+      }
+      auto surrogate = Surrogate::read(surrogatePath);
+      if (vm.count("predict")) {
+        std::vector<double> x;
+        std::istringstream values(vm["predict"].as<std::string>());
+        for (std::string value; std::getline(values, value, ',');) {
+          std::istringstream number(value);
+          double parsed;
+          if (!(number >> parsed) || !(number >> std::ws).eof()) {
+            throw std::invalid_argument("--predict needs comma-separated numbers, not '" + value + "'");
+          }
+          x.push_back(parsed);
+        }
+        surrogate.predict(x).write(std::cout);
+      }
+      if (vm.count("validate")) {
+        surrogate.validate(*sweep, vm["validate"].as<std::size_t>(), 1).write(std::cout);
+      }
+    } catch (const std::exception& e) {
+      std::cerr << "ERROR: " << e.what() << std::endl;
+      return 1;
+    }
+    return 0;
+  }
+
+  if (vm.count("sensitivity")) {
+    try {
+      auto spec = SensitivitySpec::read(vm["sensitivity"].as<std::string>());
+      if (vm.count("timeout")) {
+        spec.sampling.cancellation.cancelAfter(vm["timeout"].as<double>());
+      }
+      auto defaults = vm.count("defaultsfilepath") ? vm["defaultsfilepath"].as<std::string>() : std::string();
+      SensitivityAnalysis analysis(vm["ismfilepath"].as<std::string>(), defaults);
+      auto results = analysis.run(spec);
+      results.write(std::cout);
+      if (results.failures) {
+        std::cerr << results.failures << " rows failed. First error: " << results.firstError << std::endl;
+      }
+      if (results.cancelled) {
+        std::cerr << "Timed out after " << results.rows << " rows" << std::endl;
+      }
+    } catch (const std::exception& e) {
+      std::cerr << "ERROR: " << e.what() << std::endl;
+      return 1;
+    }
+    return 0;
   }
 
   // Load the .ism file.
@@ -175,25 +383,31 @@ int main(int argc, char* argv[])
     umodel.load(vm["ismfilepath"].as<std::string>());
   }
 
-  if (DEBUG_ISO_MODEL_SIMULATION)
-    std::cout << "User Model Loaded" << std::endl;
-
-  if (DEBUG_ISO_MODEL_SIMULATION) {
-    umodel.loadWeather();
-    WeatherData wd = *umodel.weatherData();
-    Matrix msolar = wd.msolar();
-    Matrix mhdbt = wd.mhdbt();
-    Matrix mhEgh = wd.mhEgh();
-    Vector mEgh = wd.mEgh();
-    Vector mdbt = wd.mdbt();
-    Vector mwind = wd.mwind();
-    printMatrix("msolar", msolar);
-    printMatrix("mhdbt", mhdbt);
-    printMatrix("mhEgh", mhEgh);
-    printVector("mEgh", mEgh);
-    printVector("mdbt", mdbt);
-    printVector("mwind", mwind);
-    std::cout << std::endl;
+  std::shared_ptr<SimulationTrace> trace;
+  if (vm.count("trace")) {
+    trace = std::make_shared<SimulationTrace>();
+    std::shared_ptr<WeatherData> wd = umodel.weatherData();
+    if (wd) {
+      trace->record("msolar", wd->msolar());
+      trace->record("mhdbt", wd->mhdbt());
+      trace->record("mhEgh", wd->mhEgh());
+      trace->record("mEgh", wd->mEgh());
+      trace->record("mdbt", wd->mdbt());
+      trace->record("mwind", wd->mwind());
+    }
+  }
+
+  std::unique_ptr<PararealSettings> parareal;
+  if (vm.count("parareal")) {
+    parareal.reset(new PararealSettings());
+    parareal->threads = vm["parareal"].as<std::size_t>();
+  }
+
+  std::unique_ptr<RepresentativeDaySettings> representative;
+  if (vm.count("representative")) {
+    representative.reset(new RepresentativeDaySettings());
+    representative->days = vm["representative"].as<int>();
+    representative->compare = vm.count("representativeError") > 0;
   }
 
   bool simulationRan = false;
@@ -209,23 +423,42 @@ int main(int argc, char* argv[])
     simulationRan = true;
   }
   if (vm.count("monthly")) {
-    runMonthlySimulation(umodel);
+    runMonthlySimulation(umodel, trace);
     simulationRan = true;
   }
 
   if (vm.count("hourlyByMonth")) {
-    runHourlySimulation(umodel, true);
+    try {
+      runHourlySimulation(umodel, true, trace, parareal.get(), representative.get());
+    } catch (const std::exception& e) {
+      std::cerr << "ERROR: " << e.what() << std::endl;
+      return 1;
+    }
     simulationRan = true;
   }
 
   if (vm.count("hourlyByHour")) {
-    runHourlySimulation(umodel, false);
+    try {
+      runHourlySimulation(umodel, false, trace, parareal.get(), representative.get());
+    } catch (const std::exception& e) {
+      std::cerr << "ERROR: " << e.what() << std::endl;
+      return 1;
+    }
     simulationRan = true;
   }
 
   if (!simulationRan) {
     // Monthly simulation is default and will run if no other simulations did.
-    runMonthlySimulation(umodel);
+    runMonthlySimulation(umodel, trace);
+  }
+
+  if (trace) {
+    auto tracePath = vm["trace"].as<std::string>();
+    if (tracePath.size() >= 4 && tracePath.compare(tracePath.size() - 4, 4, ".csv") == 0) {
+      trace->writeCsv(tracePath);
+    } else {
+      trace->writeBinary(tracePath);
+    }
   }
 
 }